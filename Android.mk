@@ -81,21 +81,28 @@ LOCAL_SRC_FILES += \
 	src/DBusCookieSHA1.cc \
 	src/DBusStd.cc \
 	src/EndpointAuth.cc \
+	src/EndpointStats.cc \
 	src/InterfaceDescription.cc \
+	src/IntrospectionCache.cc \
 	src/KeyStore.cc \
 	src/LocalTransport.cc \
+	src/LZCodec.cc \
+	src/MarshalPlan.cc \
 	src/Message.cc \
 	src/Message_Gen.cc \
 	src/Message_Parse.cc \
+	src/MessageTrace.cc \
 	src/MethodTable.cc \
 	src/MsgArg.cc \
 	src/NullTransport.cc \
 	src/PeerState.cc \
+	src/PropertyCache.cc \
 	src/ProtectedBusListener.cc \
 	src/ProtectedSessionListener.cc \
 	src/ProtectedSessionPortListener.cc \
 	src/ProxyBusObject.cc \
 	src/RemoteEndpoint.cc \
+	src/ReplyTable.cc \
 	src/SASLEngine.cc \
 	src/SessionOpts.cc \
 	src/SignalTable.cc \
@@ -103,8 +110,10 @@ LOCAL_SRC_FILES += \
 	src/SimpleBusListener.cc \
 	src/Transport.cc \
 	src/TransportList.cc \
+	src/TxLaneQueue.cc \
 	src/XmlHelper.cc \
 	src/posix/ClientTransport.cc \
+	src/posix/SharedMemoryStream.cc \
 	src/posix/android/PermissionDB.cc
 
 
@@ -164,6 +173,7 @@ LOCAL_SRC_FILES := \
 	daemon/DaemonConfig.cc \
 	daemon/DaemonRouter.cc \
 	daemon/DaemonTransport.cc \
+	daemon/MessageTraceDump.cc \
 	daemon/NameService.cc \
 	daemon/NameTable.cc \
 	daemon/NetworkInterface.cc \
@@ -175,6 +185,7 @@ LOCAL_SRC_FILES := \
 	daemon/RuleTable.cc \
 	daemon/TCPTransport.cc \
 	daemon/VirtualEndpoint.cc \
+	daemon/compatibilty/PolicyDB.cc \
 	daemon/bt_bluez/AdapterObject.cc \
 	daemon/bt_bluez/BlueZHCIUtils.cc \
 	daemon/bt_bluez/BlueZIfc.cc \
@@ -187,8 +198,10 @@ LOCAL_SRC_FILES := \
 	daemon/ice/ICECandidate.cc \
 	daemon/ice/ICECandidatePair.cc \
 	daemon/ice/ICEManager.cc \
+	daemon/ice/ICEScheduler.cc \
 	daemon/ice/ICESession.cc \
 	daemon/ice/ICEStream.cc \
+	daemon/ice/JsonPullParser.cc \
 	daemon/ice/PersistGUID.cc \
 	daemon/ice/ProximityScanEngine.cc \
 	daemon/ice/RendezvousServerConnection.cc \
@@ -211,6 +224,7 @@ LOCAL_SRC_FILES := \
 	daemon/ice/StunAttributeXorMappedAddress.cc \
 	daemon/ice/StunCredential.cc \
 	daemon/ice/StunMessage.cc \
+	daemon/ice/StunMessageView.cc \
 	daemon/ice/StunRetry.cc \
 	daemon/ice/StunTransactionID.cc \
 	daemon/JSON/json_reader.cc \
@@ -220,6 +234,7 @@ LOCAL_SRC_FILES := \
 	daemon/posix/DaemonTransport.cc \
 	daemon/posix/ICEPacketStream.cc \
 	daemon/posix/ProximityScanner.cc \
+	daemon/posix/RawRelay.cc \
 	daemon/posix/UDPPacketStream.cc
 
 LOCAL_SRC_FILES += \
@@ -52,6 +52,10 @@
 #include "BusUtil.h"
 #include "SessionInternal.h"
 #include "BusController.h"
+#include "DaemonConfig.h"
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+#include "RawRelay.h"
+#endif
 
 #define QCC_MODULE "ALLJOYN_OBJ"
 
@@ -74,6 +78,7 @@ void AllJoynObj::AcquireLocks()
 
 void AllJoynObj::ReleaseLocks()
 {
+    sessionMapCount = (uint32_t)sessionMap.size();
     stateLock.Unlock(MUTEX_CONTEXT);
     router.UnlockNameTable();
 }
@@ -91,7 +96,10 @@ AllJoynObj::AllJoynObj(Bus& bus, BusController* busController) :
     detachSessionSignal(NULL),
     nameMapReaper(this),
     isStopping(false),
-    busController(busController)
+    busController(busController),
+    rawRelay(NULL),
+    sessionMapCount(0),
+    joinSessionThreadCount(0)
 {
 }
 
@@ -113,6 +121,10 @@ AllJoynObj::~AllJoynObj()
         joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+    delete rawRelay;
+#endif
 }
 
 QStatus AllJoynObj::Init()
@@ -591,7 +603,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                             /* Add (local) joiner to list of session members since no AttachSession will be sent */
                             SessionMapEntry* smEntry = ajObj.SessionMapFind(sme.endpointName, newSessionId);
                             if (smEntry) {
-                                smEntry->memberNames.push_back(sender);
+                                smEntry->memberNames.push_back(ajObj.router.InternUniqueName(sender));
                                 sme = *smEntry;
                             } else {
                                 replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
@@ -623,7 +635,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                             SessionMapEntry* smEntry = ajObj.SessionMapFind(sme.endpointName, sme.id);
                             if (smEntry) {
                                 smEntry->fd = fds[0];
-                                smEntry->memberNames.push_back(sender);
+                                smEntry->memberNames.push_back(ajObj.router.InternUniqueName(sender));
 
                                 /* Create a joiner side entry in sessionMap */
                                 SessionMapEntry sme2 = sme;
@@ -681,6 +693,17 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                 }
             }
 
+            /* Message based sessions share an existing connection to the session host's daemon if there is one */
+            if (!b2bEp && vSessionEp && (replyCode == ALLJOYN_JOINSESSION_REPLY_SUCCESS)) {
+                TransportMask transport;
+                b2bEp = ajObj.FindPooledB2BEndpoint(*vSessionEp, optsIn, transport);
+                if (b2bEp) {
+                    b2bEp->IncrementRef();
+                    b2bEpName = b2bEp->GetUniqueName();
+                    optsIn.transports = transport;
+                }
+            }
+
             String busAddr;
             if (!b2bEp) {
                 /* Step 1: If there is a busAddr from advertisement use it to (possibly) create a physical connection */
@@ -951,7 +974,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                 /* Add joiner to any local member's sessionMap entry  since no AttachSession is sent */
                 SessionMapEntry* smEntry = ajObj.SessionMapFind(member, id);
                 if (smEntry) {
-                    smEntry->memberNames.push_back(sender);
+                    smEntry->memberNames.push_back(ajObj.router.InternUniqueName(sender));
                 }
 
                 /* Multipoint session member is local to this daemon. Send MPSessionChanged */
@@ -1021,6 +1044,7 @@ void AllJoynObj::JoinSessionThread::ThreadExit(Thread* thread)
         if (*it == thread) {
             deleteMe = *it;
             ajObj.joinSessionThreads.erase(it);
+            ajObj.joinSessionThreadCount = (uint32_t)ajObj.joinSessionThreads.size();
             break;
         }
         ++it;
@@ -1042,6 +1066,7 @@ void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message
         QStatus status = jst->Start(NULL, jst);
         if (status == ER_OK) {
             joinSessionThreads.push_back(jst);
+            joinSessionThreadCount = (uint32_t)joinSessionThreads.size();
         } else {
             QCC_LogError(status, ("Join: Failed to start JoinSessionThread"));
         }
@@ -1058,6 +1083,7 @@ void AllJoynObj::AttachSession(const InterfaceDescription::Member* member, Messa
         QStatus status = jst->Start(NULL, jst);
         if (status == ER_OK) {
             joinSessionThreads.push_back(jst);
+            joinSessionThreadCount = (uint32_t)joinSessionThreads.size();
         } else {
             QCC_LogError(status, ("Attach: Failed to start JoinSessionThread"));
         }
@@ -1294,7 +1320,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                             SessionMapEntry* smEntry = ajObj.SessionMapFind(sme.endpointName, sme.id);
                             /* Update sessionMap */
                             if (smEntry) {
-                                smEntry->memberNames.push_back(srcStr);
+                                smEntry->memberNames.push_back(ajObj.router.InternUniqueName(srcStr));
                                 id = smEntry->id;
                                 destIsLocal = true;
                                 creatorName = creatorEp->GetUniqueName();
@@ -1342,10 +1368,18 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                     b2bEp->IncrementRef();
                 }
             } else if (busAddr[0] != '\0') {
-                /* Ask the transport for an endpoint */
+                /* Message based sessions share an existing connection to dest's daemon if there is one */
+                if (destEp && (destEp->GetEndpointType() == BusEndpoint::ENDPOINT_TYPE_VIRTUAL)) {
+                    TransportMask transport;
+                    b2bEp = ajObj.FindPooledB2BEndpoint(*static_cast<VirtualEndpoint*>(destEp), optsIn, transport);
+                }
+                /* Otherwise ask the transport for an endpoint */
                 TransportList& transList = ajObj.bus.GetInternal().GetTransportList();
                 Transport* trans = transList.GetTransport(busAddr);
-                if (trans == NULL) {
+                if (b2bEp) {
+                    b2bEp->IncrementRef();
+                    b2bEpName = b2bEp->GetUniqueName();
+                } else if (trans == NULL) {
                     replyCode = ALLJOYN_JOINSESSION_REPLY_UNREACHABLE;
                 } else {
                     ajObj.ReleaseLocks();
@@ -1488,15 +1522,31 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 }
             }
         } else {
-            /* Indirect raw route (middle-man). Create a pump to copy raw data between endpoints */
+            /* Indirect raw route (middle-man). Relay the raw data between the endpoints' sockets */
             BusEndpoint* ep = ajObj.router.FindEndpoint(b2bEpName);
             RemoteEndpoint* b2bEp = ep ? static_cast<RemoteEndpoint*>(ep) : NULL;
             if (b2bEp) {
                 QStatus tStatus;
-                SocketFd srcB2bFd, b2bFd;
+                SocketFd srcB2bFd = -1, b2bFd = -1;
                 status = ajObj.ShutdownEndpoint(*srcB2BEp, srcB2bFd);
                 tStatus = ajObj.ShutdownEndpoint(*b2bEp, b2bFd);
                 status = (status == ER_OK) ? tStatus : status;
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+                /* Splice the sockets together in the kernel so the raw data never enters user space */
+                if (status == ER_OK) {
+                    if (!ajObj.rawRelay) {
+                        ajObj.rawRelay = new RawRelay();
+                    }
+                    status = ajObj.rawRelay->AddRelay(id, srcB2bFd, b2bFd);
+                } else {
+                    if (srcB2bFd != -1) {
+                        qcc::Close(srcB2bFd);
+                    }
+                    if (b2bFd != -1) {
+                        qcc::Close(b2bFd);
+                    }
+                }
+#else
                 if (status == ER_OK) {
                     SocketStream* ss1 = new SocketStream(srcB2bFd);
                     SocketStream* ss2 = new SocketStream(b2bFd);
@@ -1508,6 +1558,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                     ManagedObj<StreamPump> pump(ss1, ss2, chunkSize, threadName, isManaged);
                     status = pump->Start();
                 }
+#endif
                 if (status != ER_OK) {
                     QCC_LogError(status, ("Raw relay creation failed"));
                 }
@@ -1925,6 +1976,53 @@ QStatus AllJoynObj::SendGetSessionInfo(const char* creatorName,
     return status;
 }
 
+size_t AllJoynObj::SelectPooledB2BEndpoint(const vector<PooledB2BCandidate>& candidates, const SessionOpts& opts, uint32_t maxDepth)
+{
+    size_t best = candidates.size();
+    if ((maxDepth == 0) || (opts.traffic != SessionOpts::TRAFFIC_MESSAGES)) {
+        return best;
+    }
+    size_t bestDepth = maxDepth;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const PooledB2BCandidate& c = candidates[i];
+        if (c.direct && (c.transport & opts.transports) && (c.txQueueDepth < bestDepth)) {
+            best = i;
+            bestDepth = c.txQueueDepth;
+        }
+    }
+    return best;
+}
+
+RemoteEndpoint* AllJoynObj::FindPooledB2BEndpoint(VirtualEndpoint& vep, const SessionOpts& opts, TransportMask& transport)
+{
+    uint32_t maxDepth = DaemonConfig::Access()->Get("limit@b2b_pool_max_queue_depth", ALLJOYN_B2B_POOL_MAX_QUEUE_DEPTH_DEFAULT);
+
+    vector<RemoteEndpoint*> b2bEps;
+    vep.GetBusToBusEndpoints(b2bEps);
+
+    vector<PooledB2BCandidate> candidates(b2bEps.size());
+    TransportList& transList = bus.GetInternal().GetTransportList();
+    for (size_t i = 0; i < b2bEps.size(); ++i) {
+        RemoteEndpoint* ep = b2bEps[i];
+        /* Only share direct connections, the unique names of the remote daemon's endpoints start with its short GUID */
+        candidates[i].direct = (::strncmp(ep->GetRemoteGUID().ToShortString().c_str(), vep.GetUniqueName().c_str() + 1, qcc::GUID128::SHORT_SIZE) == 0);
+        Transport* trans = transList.GetTransport(ep->GetTransportName());
+        candidates[i].transport = trans ? trans->GetTransportMask() : 0;
+        candidates[i].txQueueDepth = ep->GetTxQueueDepth();
+    }
+
+    size_t best = SelectPooledB2BEndpoint(candidates, opts, maxDepth);
+    if (best < b2bEps.size()) {
+        transport = candidates[best].transport;
+        QCC_DbgPrintf(("Sharing b2b endpoint %s (tx queue depth %u) to reach %s", b2bEps[best]->GetUniqueName().c_str(), (uint32_t)candidates[best].txQueueDepth, vep.GetUniqueName().c_str()));
+        return b2bEps[best];
+    }
+    if (!b2bEps.empty()) {
+        QCC_DbgPrintf(("No b2b endpoint to %s can be shared, a new connection is needed", vep.GetUniqueName().c_str()));
+    }
+    return NULL;
+}
+
 QStatus AllJoynObj::ShutdownEndpoint(RemoteEndpoint& b2bEp, SocketFd& sockFd)
 {
     SocketStream& ss = static_cast<SocketStream&>(b2bEp.GetStream());
@@ -2047,6 +2145,12 @@ AllJoynObj::SessionMapType::iterator AllJoynObj::SessionMapLowerBound(const qcc:
 
 void AllJoynObj::SessionMapInsert(SessionMapEntry& sme)
 {
+    /* Share the name strings with the name table instead of keeping a copy for each session */
+    sme.endpointName = router.InternUniqueName(sme.endpointName);
+    sme.sessionHost = router.InternUniqueName(sme.sessionHost);
+    for (size_t i = 0; i < sme.memberNames.size(); ++i) {
+        sme.memberNames[i] = router.InternUniqueName(sme.memberNames[i]);
+    }
     pair<String, SessionId> key(sme.endpointName, sme.id);
     sessionMap.insert(pair<pair<String, SessionId>, SessionMapEntry>(key, sme));
 }
@@ -2922,12 +3026,9 @@ VirtualEndpoint& AllJoynObj::AddVirtualEndpoint(const qcc::String& uniqueName, R
     AcquireLocks();
     map<qcc::String, VirtualEndpoint*>::iterator it = virtualEndpoints.find(uniqueName);
     if (it == virtualEndpoints.end()) {
-        /* Add new virtual endpoint */
-        pair<map<qcc::String, VirtualEndpoint*>::iterator, bool> ret =
-
-            virtualEndpoints.insert(pair<qcc::String, VirtualEndpoint*>(uniqueName,
-                                                                        new VirtualEndpoint(uniqueName.c_str(), busToBusEndpoint)));
-        vep = ret.first->second;
+        /* Add new virtual endpoint. The map key shares the endpoint's copy of the name. */
+        vep = new VirtualEndpoint(uniqueName.c_str(), busToBusEndpoint);
+        virtualEndpoints.insert(pair<qcc::String, VirtualEndpoint*>(vep->GetUniqueName(), vep));
         added = true;
 
         /* Register the endpoint with the router */
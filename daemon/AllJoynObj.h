@@ -49,6 +49,7 @@ namespace ajn {
 
 /** Forward Declaration */
 class BusController;
+class RawRelay;
 
 /**
  * BusObject responsible for implementing the standard AllJoyn methods at org.alljoyn.Bus
@@ -84,6 +85,21 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void ObjectRegistered(void);
 
+    /**
+     * Get the number of session map entries, one for each endpoint in each session. The count is
+     * refreshed whenever the locks are released so reading it does not need the locks.
+     *
+     * @return  The number of session map entries.
+     */
+    uint32_t GetSessionMapCount() const { return sessionMapCount; }
+
+    /**
+     * Get the number of JoinSession and AttachSession requests being handled.
+     *
+     * @return  The number of join session threads.
+     */
+    uint32_t GetJoinSessionThreadCount() const { return joinSessionThreadCount; }
+
     /**
      * Respond to a bus request to bind a SessionPort.
      *
@@ -361,6 +377,28 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     DaemonRouter& GetDaemonRouter() { return router; }
 
+    /**
+     * A bus-to-bus connection that a new session might share.
+     */
+    struct PooledB2BCandidate {
+        bool direct;                  /**< true if the connection goes straight to the daemon serving the session */
+        TransportMask transport;      /**< Transport of the connection or 0 if the transport is gone */
+        size_t txQueueDepth;          /**< Number of messages waiting to be sent on the connection */
+    };
+
+    /**
+     * Choose the bus-to-bus connection a new session shares. Only message based
+     * sessions share connections. A connection is shared if it is direct, uses one
+     * of the session's transports and has fewer than maxDepth messages queued; the
+     * one with the fewest queued messages is chosen.
+     *
+     * @param candidates  The connections to the daemon serving the session.
+     * @param opts        Requested session options.
+     * @param maxDepth    Queue depth at which a connection is no longer shared, 0 turns sharing off.
+     * @return  Index of the chosen candidate or candidates.size() if a new connection should be made.
+     */
+    static size_t SelectPooledB2BEndpoint(const std::vector<PooledB2BCandidate>& candidates, const SessionOpts& opts, uint32_t maxDepth);
+
   private:
     Bus& bus;                             /**< The bus */
     DaemonRouter& router;                 /**< The router */
@@ -496,6 +534,9 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
     qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects joinSessionThreads */
     bool isStopping;                                     /**< True while waiting for threads to exit */
     BusController* busController;                        /**< BusController that created this BusObject */
+    RawRelay* rawRelay;                                  /**< Relays raw sessions for which this daemon is the middle-man */
+    uint32_t sessionMapCount;                            /**< Number of entries in sessionMap */
+    uint32_t joinSessionThreadCount;                     /**< Number of entries in joinSessionThreads */
 
     /**
      * Acquire AllJoynObj locks.
@@ -618,6 +659,31 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
                                const SessionOpts& opts,
                                std::vector<qcc::String>& busAddrs);
 
+    /**
+     * @brief The default value for the transmit queue depth above which a
+     * bus-to-bus connection is no longer shared by new sessions.
+     *
+     * New message based sessions with a remote daemon reuse an existing
+     * authenticated bus-to-bus connection to that daemon rather than paying
+     * for another connect, authentication and name exchange. Once every
+     * connection has at least this many messages waiting to be sent, another
+     * connection is opened. To override this value, change the limit,
+     * "b2b_pool_max_queue_depth". A value of zero turns sharing off.
+     */
+    static const uint32_t ALLJOYN_B2B_POOL_MAX_QUEUE_DEPTH_DEFAULT = 8;
+
+    /**
+     * Find an existing bus-to-bus connection to the daemon behind a virtual
+     * endpoint that can carry another message based session.
+     * Must be called with the AllJoynObj locks held.
+     *
+     * @param       vep         Virtual endpoint served by the remote daemon.
+     * @param       opts        Requested session options.
+     * @param[out]  transport   Transport of the returned connection.
+     * @return  The connection chosen by SelectPooledB2BEndpoint() or NULL if a new connection should be made.
+     */
+    RemoteEndpoint* FindPooledB2BEndpoint(VirtualEndpoint& vep, const SessionOpts& opts, TransportMask& transport);
+
     /**
      * Add a virtual endpoint with a given unique name.
      *
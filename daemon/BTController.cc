@@ -269,7 +269,7 @@ BTController::~BTController()
 
 void BTController::ObjectRegistered() {
     // Set our unique name now that we know it.
-    self->SetUniqueName(bus.GetUniqueName());
+    nodeDB.SetUniqueName(self, bus.GetUniqueName());
 }
 
 
@@ -763,7 +763,9 @@ void BTController::PostConnect(QStatus status, BTNodeInfo& node, const String& r
         QCC_DEBUG_ONLY(connectTimer.RecordTime(node->GetBusAddress().addr, connectStartTimes[node->GetBusAddress().addr]));
         assert(!remoteName.empty());
         if (node->GetUniqueName().empty() || (node->GetUniqueName() != remoteName)) {
-            node->SetUniqueName(remoteName);
+            // The node may be in either DB.
+            foundNodeDB.SetUniqueName(node, remoteName);
+            nodeDB.SetUniqueName(node, remoteName);
         }
 
         bool inNodeDB = nodeDB.FindNode(node->GetBusAddress())->IsValid();
@@ -1310,7 +1312,7 @@ void BTController::HandleSetState(const InterfaceDescription::Member* member, Me
     BTNodeInfo connectingNode = foundNodeDB.FindNode(addr);
 
     if (connectingNode->IsValid()) {
-        connectingNode->SetUniqueName(sender);
+        foundNodeDB.SetUniqueName(connectingNode, sender);
         if (connectingNode != connectingNode->GetConnectNode()) {
             foundNodeDB.RemoveNode(connectingNode);
             connectingNode->SetConnectNode(connectingNode);
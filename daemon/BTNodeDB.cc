@@ -43,61 +43,13 @@ using namespace qcc;
 namespace ajn {
 
 
-static set<BTNodeInfo>::const_iterator findNode(const set<BTNodeInfo>& nodes, const BTBusAddress& addr)
-{
-    set<BTNodeInfo>::const_iterator it;
-    for (it = nodes.begin(); it != nodes.end(); ++it) {
-        if ((*it)->GetBusAddress() == addr) {
-            break;
-        }
-    }
-    return it;
-}
-
-
-static set<BTNodeInfo>::iterator findNode(set<BTNodeInfo>& nodes, const BTBusAddress& addr)
-{
-    set<BTNodeInfo>::iterator it;
-    for (it = nodes.begin(); it != nodes.end(); ++it) {
-        if ((*it)->GetBusAddress() == addr) {
-            break;
-        }
-    }
-    return it;
-}
-
-
-static set<BTNodeInfo>::const_iterator findNode(const set<BTNodeInfo>& nodes, const BDAddress& addr)
-{
-    set<BTNodeInfo>::const_iterator it;
-    for (it = nodes.begin(); it != nodes.end(); ++it) {
-        if ((*it)->GetBusAddress().addr == addr) {
-            break;
-        }
-    }
-    return it;
-}
-
-
-static set<BTNodeInfo>::const_iterator findNode(const set<BTNodeInfo>& nodes, const String& uniqueName)
-{
-    set<BTNodeInfo>::const_iterator it;
-    for (it = nodes.begin(); it != nodes.end(); ++it) {
-        if (!(*it)->GetUniqueName().empty() && ((*it)->GetUniqueName() == uniqueName)) {
-            break;
-        }
-    }
-    return it;
-}
-
-
 const BTNodeInfo BTNodeDB::FindNode(const BTBusAddress& addr) const
 {
     BTNodeInfo node;
     Lock(MUTEX_CONTEXT);
-    set<BTNodeInfo>::const_iterator it = findNode(nodes, addr);
-    if (it != nodes.end()) {
-        node = *it;
+    AddrIndex::const_iterator it = addrIndex.find(addr);
+    if (it != addrIndex.end()) {
+        node = it->second.node;
     }
     Unlock(MUTEX_CONTEXT);
     return node;
@@ -108,9 +60,10 @@ const BTNodeInfo BTNodeDB::FindNode(const BDAddress& addr) const
 {
     BTNodeInfo node;
     Lock(MUTEX_CONTEXT);
-    set<BTNodeInfo>::const_iterator it = findNode(nodes, addr);
-    if (it != nodes.end()) {
-        node = *it;
+    // Bus addresses are ordered by BD address first so the lowest PSM for addr is the first match.
+    AddrIndex::const_iterator it = addrIndex.lower_bound(BTBusAddress(addr, 0x0000));
+    if ((it != addrIndex.end()) && (it->first.addr == addr)) {
+        node = it->second.node;
     }
     Unlock(MUTEX_CONTEXT);
     return node;
@@ -120,10 +73,13 @@ const BTNodeInfo BTNodeDB::FindNode(const BDAddress& addr) const
 const BTNodeInfo BTNodeDB::FindNode(const String& uniqueName) const
 {
     BTNodeInfo node;
+    if (uniqueName.empty()) {
+        return node;
+    }
     Lock(MUTEX_CONTEXT);
-    set<BTNodeInfo>::const_iterator it = findNode(nodes, uniqueName);
-    if (it != nodes.end()) {
-        node = *it;
+    NameIndex::const_iterator it = nameIndex.find(uniqueName);
+    if ((it != nameIndex.end()) && (it->second->GetUniqueName() == uniqueName)) {
+        node = it->second;
     }
     Unlock(MUTEX_CONTEXT);
     return node;
@@ -173,6 +129,7 @@ void BTNodeDB::AddNode(const BTNodeInfo& node)
 
     // Add to the master set
     nodes.insert(node);
+    IndexNode(node);
 
     Unlock(MUTEX_CONTEXT);
 }
@@ -181,13 +138,118 @@ void BTNodeDB::AddNode(const BTNodeInfo& node)
 void BTNodeDB::RemoveNode(const BTNodeInfo& node)
 {
     Lock(MUTEX_CONTEXT);
-    set<BTNodeInfo>::iterator it = findNode(nodes, node->GetBusAddress());
-    if (it != nodes.end()) {
+    AddrIndex::iterator it = addrIndex.find(node->GetBusAddress());
+    if (it != addrIndex.end()) {
         // Remove from the master set
-        nodes.erase(it);
+        nodes.erase(it->second.node);
+        UnindexNode(it);
+    }
+
+    Unlock(MUTEX_CONTEXT);
+}
+
+
+void BTNodeDB::SetUniqueName(const BTNodeInfo& node, const String& uniqueName)
+{
+    Lock(MUTEX_CONTEXT);
+    BTNodeInfo lnode = node;
+    lnode->SetUniqueName(uniqueName);
+    ReindexNode(lnode);
+    Unlock(MUTEX_CONTEXT);
+}
+
+
+void BTNodeDB::IndexNode(const BTNodeInfo& node)
+{
+    IndexEntry& entry = addrIndex[node->GetBusAddress()];
+    entry.node = node;
+    entry.uniqueName = node->GetUniqueName();
+    entry.expireTime = node->GetExpireTime();
+    if (!entry.uniqueName.empty()) {
+        nameIndex[entry.uniqueName] = node;
+    }
+    expireIndex.insert(pair<uint64_t, BTBusAddress>(entry.expireTime, node->GetBusAddress()));
+}
+
+
+void BTNodeDB::UnindexNode(AddrIndex::iterator it)
+{
+    const IndexEntry& entry = it->second;
+    if (!entry.uniqueName.empty()) {
+        NameIndex::iterator nit = nameIndex.find(entry.uniqueName);
+        // Another node may have taken over the name since this node was indexed.
+        if ((nit != nameIndex.end()) && (nit->second->GetBusAddress() == it->first)) {
+            nameIndex.erase(nit);
+        }
+    }
+    pair<ExpireIndex::iterator, ExpireIndex::iterator> range = expireIndex.equal_range(entry.expireTime);
+    for (ExpireIndex::iterator eit = range.first; eit != range.second; ++eit) {
+        if (eit->second == it->first) {
+            expireIndex.erase(eit);
+            break;
+        }
     }
+    addrIndex.erase(it);
+}
+
+
+void BTNodeDB::ReindexNode(const BTNodeInfo& node)
+{
+    AddrIndex::iterator it = addrIndex.find(node->GetBusAddress());
+    if (it != addrIndex.end()) {
+        const IndexEntry& entry = it->second;
+        if ((entry.uniqueName != entry.node->GetUniqueName()) || (entry.expireTime != entry.node->GetExpireTime())) {
+            BTNodeInfo indexed = entry.node;
+            UnindexNode(it);
+            IndexNode(indexed);
+        }
+    }
+}
+
+
+bool BTNodeDB::FixFirstExpiration()
+{
+    ExpireIndex::iterator eit = expireIndex.begin();
+    AddrIndex::iterator it = addrIndex.find(eit->second);
+    assert(it != addrIndex.end());
+    if (it->second.node->GetExpireTime() == eit->first) {
+        return false;
+    }
+    ReindexNode(it->second.node);
+    return true;
+}
 
+
+void BTNodeDB::PopExpiredNodes(BTNodeDB& expiredDB)
+{
+    Lock(MUTEX_CONTEXT);
+    qcc::Timespec now;
+    qcc::GetTimeNow(&now);
+    while (!expireIndex.empty() && (expireIndex.begin()->first <= now.GetAbsoluteMillis())) {
+        if (FixFirstExpiration()) {
+            continue;
+        }
+        AddrIndex::iterator it = addrIndex.find(expireIndex.begin()->second);
+        BTNodeInfo node = it->second.node;
+        nodes.erase(node);
+        UnindexNode(it);
+        expiredDB.AddNode(node);
+    }
+    Unlock(MUTEX_CONTEXT);
+}
+
+
+uint64_t BTNodeDB::NextNodeExpiration()
+{
+    uint64_t next = numeric_limits<uint64_t>::max();
+    Lock(MUTEX_CONTEXT);
+    while (!expireIndex.empty() && FixFirstExpiration()) {
+    }
+    if (!expireIndex.empty()) {
+        next = expireIndex.begin()->first;
+    }
     Unlock(MUTEX_CONTEXT);
+    return next;
 }
 
 
@@ -203,19 +265,19 @@ void BTNodeDB::Diff(const BTNodeDB& other, BTNodeDB* added, BTNodeDB* removed) c
     }
 
     const_iterator nodeit;
-    set<BTNodeInfo>::const_iterator addrit;
+    AddrIndex::const_iterator addrit;
 
     // Find removed names/nodes
     if (removed) {
         for (nodeit = Begin(); nodeit != End(); ++nodeit) {
             const BTNodeInfo& node = *nodeit;
-            addrit = findNode(other.nodes, node->GetBusAddress());
-            if (addrit == other.nodes.end()) {
+            addrit = other.addrIndex.find(node->GetBusAddress());
+            if (addrit == other.addrIndex.end()) {
                 removed->AddNode(node);
             } else {
                 BTNodeInfo diffNode = node->Clone();
                 bool include = false;
-                const BTNodeInfo& onode = *addrit;
+                const BTNodeInfo& onode = addrit->second.node;
                 NameSet::const_iterator nameit;
                 NameSet::const_iterator onameit;
                 for (nameit = node->GetAdvertiseNamesBegin(); nameit != node->GetAdvertiseNamesEnd(); ++nameit) {
@@ -237,13 +299,13 @@ void BTNodeDB::Diff(const BTNodeDB& other, BTNodeDB* added, BTNodeDB* removed) c
     if (added) {
         for (nodeit = other.Begin(); nodeit != other.End(); ++nodeit) {
             const BTNodeInfo& onode = *nodeit;
-            addrit = findNode(nodes, onode->GetBusAddress());
-            if (addrit == nodes.end()) {
+            addrit = addrIndex.find(onode->GetBusAddress());
+            if (addrit == addrIndex.end()) {
                 added->AddNode(onode);
             } else {
                 BTNodeInfo diffNode = onode->Clone();
                 bool include = false;
-                const BTNodeInfo& node = *addrit;
+                const BTNodeInfo& node = addrit->second.node;
                 NameSet::const_iterator nameit;
                 NameSet::const_iterator onameit;
                 for (onameit = onode->GetAdvertiseNamesBegin(); onameit != onode->GetAdvertiseNamesEnd(); ++onameit) {
@@ -284,14 +346,14 @@ void BTNodeDB::NodeDiff(const BTNodeDB& other, BTNodeDB* added, BTNodeDB* remove
     }
 
     const_iterator nodeit;
-    set<BTNodeInfo>::const_iterator addrit;
+    AddrIndex::const_iterator addrit;
 
     // Find removed names/nodes
     if (removed) {
         for (nodeit = Begin(); nodeit != End(); ++nodeit) {
             const BTNodeInfo& node = *nodeit;
-            addrit = findNode(other.nodes, node->GetBusAddress());
-            if (addrit == other.nodes.end()) {
+            addrit = other.addrIndex.find(node->GetBusAddress());
+            if (addrit == other.addrIndex.end()) {
                 removed->AddNode(node);
             }
         }
@@ -301,8 +363,8 @@ void BTNodeDB::NodeDiff(const BTNodeDB& other, BTNodeDB* added, BTNodeDB* remove
     if (added) {
         for (nodeit = other.Begin(); nodeit != other.End(); ++nodeit) {
             const BTNodeInfo& onode = *nodeit;
-            addrit = findNode(nodes, onode->GetBusAddress());
-            if (addrit == nodes.end()) {
+            addrit = addrIndex.find(onode->GetBusAddress());
+            if (addrit == addrIndex.end()) {
                 added->AddNode(onode);
             }
         }
@@ -327,10 +389,10 @@ void BTNodeDB::UpdateDB(const BTNodeDB* added, const BTNodeDB* removed, bool rem
         const_iterator rit;
         for (rit = removed->Begin(); rit != removed->End(); ++rit) {
             BTNodeInfo rnode = *rit;
-            set<BTNodeInfo>::const_iterator it = findNode(nodes, rnode->GetBusAddress());
-            if (it != nodes.end()) {
+            AddrIndex::const_iterator it = addrIndex.find(rnode->GetBusAddress());
+            if (it != addrIndex.end()) {
                 // Remove names from node
-                BTNodeInfo node = *it;
+                BTNodeInfo node = it->second.node;
                 if (&(*node) == &(*rnode)) {
                     // The exact same instance of node is in the removed DB so
                     // just remove the node so that the names don't get
@@ -359,8 +421,8 @@ void BTNodeDB::UpdateDB(const BTNodeDB* added, const BTNodeDB* removed, bool rem
         const_iterator ait;
         for (ait = added->Begin(); ait != added->End(); ++ait) {
             BTNodeInfo anode = *ait;
-            set<BTNodeInfo>::const_iterator it = findNode(nodes, anode->GetBusAddress());
-            if (it == nodes.end()) {
+            AddrIndex::const_iterator it = addrIndex.find(anode->GetBusAddress());
+            if (it == addrIndex.end()) {
                 // New node
                 BTNodeInfo connNode = FindNode(anode->GetConnectNode()->GetBusAddress());
                 if (connNode->IsValid()) {
@@ -370,7 +432,7 @@ void BTNodeDB::UpdateDB(const BTNodeDB* added, const BTNodeDB* removed, bool rem
                 AddNode(anode);
             } else {
                 // Add names to existing node
-                BTNodeInfo node = *it;
+                BTNodeInfo node = it->second.node;
                 NameSet::const_iterator anameit;
                 for (anameit = anode->GetAdvertiseNamesBegin(); anameit != anode->GetAdvertiseNamesEnd(); ++anameit) {
                     const String& aname = *anameit;
@@ -391,6 +453,7 @@ void BTNodeDB::UpdateDB(const BTNodeDB* added, const BTNodeDB* removed, bool rem
                 if ((node->GetUniqueName() != anode->GetUniqueName()) && !anode->GetUniqueName().empty()) {
                     node->SetUniqueName(anode->GetUniqueName());
                 }
+                ReindexNode(node);
             }
         }
     }
@@ -404,12 +467,7 @@ void BTNodeDB::RemoveExpiration()
     if (useExpirations) {
         Lock(MUTEX_CONTEXT);
         uint64_t expireTime = numeric_limits<uint64_t>::max();
-        iterator it = nodes.begin();
-        while (it != nodes.end()) {
-            BTNodeInfo node = *it;
-            node->SetExpireTime(expireTime);
-            ++it;
-        }
+        SetAllExpirations(expireTime);
         Unlock(MUTEX_CONTEXT);
     } else {
         QCC_LogError(ER_FAIL, ("Called RemoveExpiration on BTNodeDB instance initialized without expiration support."));
@@ -425,12 +483,7 @@ void BTNodeDB::RefreshExpiration(uint32_t expireDelta)
         Timespec now;
         GetTimeNow(&now);
         uint64_t expireTime = now.GetAbsoluteMillis() + expireDelta;
-        iterator it = nodes.begin();
-        while (it != nodes.end()) {
-            BTNodeInfo node = *it;
-            node->SetExpireTime(expireTime);
-            ++it;
-        }
+        SetAllExpirations(expireTime);
         Unlock(MUTEX_CONTEXT);
     } else {
         QCC_LogError(ER_FAIL, ("Called RefreshExpiration on BTNodeDB instance initialized without expiration support."));
@@ -453,6 +506,7 @@ void BTNodeDB::RefreshExpiration(const BTNodeInfo& connNode, uint32_t expireDelt
                 BTNodeInfo node = *it;
                 node->SetExpireTime(expireTime);
                 node->SetUUIDRev(connNode->GetUUIDRev());
+                ReindexNode(node);
             }
         }
 
@@ -464,6 +518,18 @@ void BTNodeDB::RefreshExpiration(const BTNodeInfo& connNode, uint32_t expireDelt
 }
 
 
+void BTNodeDB::SetAllExpirations(uint64_t expireTime)
+{
+    // Every node gets the same expire time so the index is simply rebuilt.
+    expireIndex.clear();
+    for (AddrIndex::iterator it = addrIndex.begin(); it != addrIndex.end(); ++it) {
+        it->second.node->SetExpireTime(expireTime);
+        it->second.expireTime = expireTime;
+        expireIndex.insert(expireIndex.end(), pair<uint64_t, BTBusAddress>(expireTime, it->first));
+    }
+}
+
+
 void BTNodeDB::NodeSessionLost(SessionId sessionID)
 {
     Lock(MUTEX_CONTEXT);
@@ -486,9 +552,9 @@ void BTNodeDB::NodeSessionLost(SessionId sessionID)
 void BTNodeDB::UpdateNodeSessionID(SessionId sessionID, const BTNodeInfo& node)
 {
     Lock(MUTEX_CONTEXT);
-    set<BTNodeInfo>::const_iterator it = findNode(nodes, node->GetBusAddress());
-    if (it != nodes.end()) {
-        BTNodeInfo lnode = *it;
+    AddrIndex::const_iterator it = addrIndex.find(node->GetBusAddress());
+    if (it != addrIndex.end()) {
+        BTNodeInfo lnode = it->second.node;
 
         lnode->SetSessionID(sessionID);
         lnode->SetSessionState(_BTNodeInfo::SESSION_UP);
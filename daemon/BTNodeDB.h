@@ -24,6 +24,7 @@
 #include <qcc/platform.h>
 
 #include <limits>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -132,6 +133,17 @@ class BTNodeDB {
      */
     void RemoveNode(const BTNodeInfo& node);
 
+    /**
+     * Set the unique name of a node.  If the node is in the DB the index of
+     * nodes by unique name is updated so FindNode() will find the node under
+     * its new name.  Unique names must be set through this rather than
+     * directly on nodes in the DB.
+     *
+     * @param node          Node to be updated.
+     * @param uniqueName    New unique name of the node.
+     */
+    void SetUniqueName(const BTNodeInfo& node, const qcc::String& uniqueName);
+
     /**
      * Determine the difference between this DB and another DB.  Nodes that
      * appear in only one or the other DB will be copied (i.e., share the same
@@ -218,36 +230,19 @@ class BTNodeDB {
         Unlock(MUTEX_CONTEXT);
     }
 
-    void PopExpiredNodes(BTNodeDB& expiredDB)
-    {
-        Lock(MUTEX_CONTEXT);
-        qcc::Timespec now;
-        qcc::GetTimeNow(&now);
-        std::set<BTNodeInfo>::iterator it = nodes.begin();
-        while (it != nodes.end()) {
-            BTNodeInfo node = *it;
-            if (node->GetExpireTime() <= now.GetAbsoluteMillis()) {
-                nodes.erase(node);
-                expiredDB.AddNode(node);
-                it = nodes.begin();
-            } else {
-                ++it;
-            }
-        }
-        Unlock(MUTEX_CONTEXT);
-    }
+    /**
+     * Remove all nodes that have expired from the DB and put them in expiredDB.
+     *
+     * @param expiredDB     DB to receive the expired nodes.
+     */
+    void PopExpiredNodes(BTNodeDB& expiredDB);
 
-    uint64_t NextNodeExpiration()
-    {
-        uint64_t next = std::numeric_limits<uint64_t>::max();
-        for (std::set<BTNodeInfo>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
-            BTNodeInfo node = *it;
-            if (node->GetExpireTime() < next) {
-                next = node->GetExpireTime();
-            }
-        }
-        return next;
-    }
+    /**
+     * Get the absolute time in milliseconds of the next node to expire.
+     *
+     * @return  Expire time of the next node to expire or numeric_limits<uint64_t>::max() if none.
+     */
+    uint64_t NextNodeExpiration();
 
 
     void NodeSessionLost(SessionId sessionID);
@@ -295,7 +290,15 @@ class BTNodeDB {
     /**
      * Clear out the DB.
      */
-    void Clear() { nodes.clear(); }
+    void Clear()
+    {
+        Lock(MUTEX_CONTEXT);
+        nodes.clear();
+        addrIndex.clear();
+        nameIndex.clear();
+        expireIndex.clear();
+        Unlock(MUTEX_CONTEXT);
+    }
 
 #ifndef NDEBUG
     void DumpTable(const char* info) const;
@@ -309,7 +312,64 @@ class BTNodeDB {
     BTNodeDB(const BTNodeDB& other) : useExpirations(false) { }
     BTNodeDB& operator=(const BTNodeDB& other) { return *this; }
 
+    /**
+     * Index entry for a node.  The unique name and expire time the node was
+     * indexed under are recorded since they may be changed on the node
+     * directly and are needed to find the node's entries in the other indexes.
+     */
+    struct IndexEntry {
+        BTNodeInfo node;            /**< The indexed node. */
+        qcc::String uniqueName;     /**< Unique name the node is indexed under in nameIndex. */
+        uint64_t expireTime;        /**< Expire time the node is indexed under in expireIndex. */
+    };
+
+    typedef std::map<BTBusAddress, IndexEntry> AddrIndex;           /**< Nodes by bus address (and BD address). */
+    typedef std::map<qcc::String, BTNodeInfo> NameIndex;            /**< Nodes by unique name. */
+    typedef std::multimap<uint64_t, BTBusAddress> ExpireIndex;      /**< Bus addresses by expire time. */
+
+    /**
+     * Add a node to the secondary indexes.  Must be called with the lock held.
+     *
+     * @param node  Node to index.
+     */
+    void IndexNode(const BTNodeInfo& node);
+
+    /**
+     * Remove a node from the secondary indexes.  Must be called with the lock held.
+     *
+     * @param it    Entry in addrIndex for the node.
+     */
+    void UnindexNode(AddrIndex::iterator it);
+
+    /**
+     * Update the secondary indexes after the unique name or expire time of a
+     * node in the DB was changed.  Must be called with the lock held.
+     *
+     * @param node  Node that changed.
+     */
+    void ReindexNode(const BTNodeInfo& node);
+
+    /**
+     * Check if the first entry in expireIndex is stale because the node's
+     * expire time was changed directly and if so reindex the node.  Must be
+     * called with the lock held and expireIndex not empty.
+     *
+     * @return  true if the first entry in expireIndex was stale and was fixed.
+     */
+    bool FixFirstExpiration();
+
+    /**
+     * Set the expire time of all nodes and rebuild expireIndex.  Must be
+     * called with the lock held.
+     *
+     * @param expireTime    Absolute expiration time in milliseconds.
+     */
+    void SetAllExpirations(uint64_t expireTime);
+
     std::set<BTNodeInfo> nodes;     /**< The node DB storage. */
+    AddrIndex addrIndex;            /**< Index of nodes by bus address. */
+    NameIndex nameIndex;            /**< Index of nodes by unique name. */
+    ExpireIndex expireIndex;        /**< Index of nodes by expire time. */
 
     mutable qcc::Mutex lock;        /**< Mutext to protect the DB. */
 
@@ -169,6 +169,7 @@ void* BTTransport::Run(void* arg)
                 conn->GetFeatures().isBusToBus = false;
                 conn->GetFeatures().allowRemote = false;
                 conn->GetFeatures().handlePassing = false;
+                conn->GetFeatures().bodyCompression = true;
 
                 threadListLock.Lock(MUTEX_CONTEXT);
                 threadList.insert(conn);
@@ -590,6 +591,7 @@ redirect:
     conn->GetFeatures().isBusToBus = true;
     conn->GetFeatures().allowRemote = bus.GetInternal().AllowRemoteMessages();
     conn->GetFeatures().handlePassing = false;
+    conn->GetFeatures().bodyCompression = true;
 
     threadListLock.Lock(MUTEX_CONTEXT);
     threadList.insert(conn);
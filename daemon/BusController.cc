@@ -26,6 +26,7 @@
 #include <qcc/platform.h>
 
 #include "BusController.h"
+#include "DaemonConfig.h"
 #include "DaemonRouter.h"
 #include "BusInternal.h"
 
@@ -41,7 +42,9 @@ BusController::BusController(Bus& alljoynBus) :
     alljoynObj(bus, this),
 #ifndef NDEBUG
     alljoynDebugObj(bus, this),
+    endpointStatsDebugObj(reinterpret_cast<DaemonRouter&>(bus.GetInternal().GetRouter()), alljoynObj),
 #endif
+    messageTraceDump(NULL),
     initComplete(NULL)
 
 {
@@ -51,6 +54,11 @@ BusController::BusController(Bus& alljoynBus) :
 
 BusController::~BusController()
 {
+    if (messageTraceDump) {
+        messageTraceDump->Stop();
+        messageTraceDump->Join();
+        delete messageTraceDump;
+    }
     DaemonRouter& router(reinterpret_cast<DaemonRouter&>(bus.GetInternal().GetRouter()));
     router.SetBusController(NULL);
 }
@@ -62,6 +70,38 @@ QStatus BusController::Init(const qcc::String& listenSpecs)
 
     initComplete = &initEvent;
 
+    /*
+     * Load the policy before any endpoints can connect. An invalid policy must not be
+     * silently ignored since that would allow everything the policy was meant to deny.
+     */
+    DaemonConfig* config = DaemonConfig::Access();
+    if (config) {
+        DaemonRouter& router(reinterpret_cast<DaemonRouter&>(bus.GetInternal().GetRouter()));
+        if (!router.LoadPolicy(*config)) {
+            initComplete = NULL;
+            status = ER_BUS_POLICY_VIOLATION;
+            QCC_LogError(status, ("Invalid policy in configuration"));
+            return status;
+        }
+
+        /*
+         * Message latency tracing can be enabled from the start and the histograms dumped
+         * periodically to a file for offline analysis.
+         */
+        if (config->Get("message_trace/property@enable") == "true") {
+            MessageTrace::Enable(true);
+        }
+        qcc::String dumpFile = config->Get("message_trace/property@dump_file");
+        if (!dumpFile.empty() && !messageTraceDump) {
+            uint32_t intervalSecs = config->Get("message_trace/property@dump_interval", 60);
+            messageTraceDump = new MessageTraceDump(dumpFile, 1000 * (intervalSecs ? intervalSecs : 60));
+            status = messageTraceDump->Start();
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Failed to start message trace dump to %s", dumpFile.c_str()));
+            }
+        }
+    }
+
     /*
      * Start the object initialization chain (see ObjectRegistered callback below)
      */
@@ -34,6 +34,9 @@
 #include "DBusObj.h"
 #include "AllJoynObj.h"
 #include "AllJoynDebugObj.h"
+#include "EndpointStatsDebug.h"
+#include "MessageTraceDebug.h"
+#include "MessageTraceDump.h"
 
 namespace ajn {
 
@@ -109,8 +112,17 @@ class BusController {
 #ifndef NDEBUG
     /** Bus object responsible for org.alljoyn.Debug */
     debug::AllJoynDebugObj alljoynDebugObj;
+
+    /** Addon to alljoynDebugObj for org.alljoyn.Bus.Debug.MessageTrace */
+    debug::MessageTraceDebugObj messageTraceDebugObj;
+
+    /** Addon to alljoynDebugObj for org.alljoyn.Bus.Debug.Stats */
+    debug::EndpointStatsDebugObj endpointStatsDebugObj;
 #endif
 
+    /** Periodic dump of the message latency histograms or NULL if not configured */
+    MessageTraceDump* messageTraceDump;
+
     /** Event to wait on while initialization completes */
     qcc::Event* initComplete;
 };
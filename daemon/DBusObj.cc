@@ -211,7 +211,14 @@ void DBusObj::RequestName(const InterfaceDescription::Member* member, Message& m
     const char* nameArg = msg->GetArg(0)->v_string.str;
     const uint32_t flagsArg = msg->GetArg(1)->v_uint32;
 
-    if (*nameArg != ':' && IsLegalBusName(nameArg)) {
+    if (*nameArg != ':' && IsLegalBusName(nameArg) && !router.OKToOwn(nameArg, msg->GetSender())) {
+        qcc::String errMsg("Connection \"");
+        errMsg += msg->GetSender();
+        errMsg += "\" is not allowed to own the service \"";
+        errMsg += nameArg;
+        errMsg += "\" due to security policies in the configuration file";
+        MethodReply(msg, "org.freedesktop.DBus.Error.AccessDenied", errMsg.c_str());
+    } else if (*nameArg != ':' && IsLegalBusName(nameArg)) {
         /* Attempt to add the alias */
         /* Response will be handled in AddAliasCB */
         uint32_t disposition;
@@ -100,6 +100,14 @@ class DaemonConfig {
      */
     std::vector<qcc::String> GetList(const char* key);
 
+    /**
+     * Get the configuration elements that share the same key. This is for configuration such as
+     * <policy> blocks where the interesting values are in nested tags and their attributes.
+     *
+     * @param key   The key is a dotted path to the elements in the XML
+     */
+    std::vector<const qcc::XmlElement*> GetElements(const char* key) { return config->GetPath(key); }
+
     /**
      * Check if the configuration has a specific key.
      */
@@ -33,7 +33,9 @@
 
 #include "BusController.h"
 #include "BusEndpoint.h"
+#include "DaemonConfig.h"
 #include "DaemonRouter.h"
+#include "MessageTrace.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -44,8 +46,97 @@ using namespace qcc;
 namespace ajn {
 
 
-DaemonRouter::DaemonRouter() : localEndpoint(NULL), ruleTable(), nameTable(), busController(NULL)
+DaemonRouter::DaemonRouter() : localEndpoint(NULL), ruleTable(), nameTable(), busController(NULL), enforcePolicy(false)
 {
+    nameTable.AddListener(this);
+}
+
+bool DaemonRouter::LoadPolicy(DaemonConfig& config)
+{
+    std::vector<const XmlElement*> policies = config.GetElements("policy");
+    PolicyDB policy;
+
+    for (size_t i = 0; i < policies.size(); ++i) {
+        if (!policy->AddPolicy(*policies[i])) {
+            Log(LOG_ERR, "Invalid policy in configuration, keeping previous policy.\n");
+            return false;
+        }
+    }
+
+    /*
+     * Tell the new policy who currently owns the well-known names. The name table is locked so
+     * ownership changes are either seen here or reported to the new policy by NameOwnerChanged.
+     */
+    nameTable.Lock();
+    vector<pair<qcc::String, vector<qcc::String> > > names;
+    nameTable.GetUniqueNamesAndAliases(names);
+    for (size_t i = 0; i < names.size(); ++i) {
+        for (size_t j = 0; j < names[i].second.size(); ++j) {
+            policy->NameOwnerChanged(names[i].second[j], NULL, &names[i].first);
+        }
+    }
+    policyLock.Lock(MUTEX_CONTEXT);
+    policyDB = policy;
+    enforcePolicy = !policies.empty();
+    policyLock.Unlock(MUTEX_CONTEXT);
+    nameTable.Unlock();
+
+    QCC_DbgPrintf(("DaemonRouter::LoadPolicy %s policy", enforcePolicy ? "enforcing" : "no"));
+    return true;
+}
+
+/*
+ * Get the user and group the policy checks an endpoint as. Endpoints for off-device peers have no
+ * local user or group, whatever GetUserId() returns they are checked as _PolicyDB::NO_IDENTITY so
+ * rules for a local user (root in particular) never apply to them.
+ */
+static inline void GetPolicyIds(BusEndpoint& ep, uint32_t& uid, uint32_t& gid)
+{
+    BusEndpoint::EndpointType epType = ep.GetEndpointType();
+    if ((epType == BusEndpoint::ENDPOINT_TYPE_VIRTUAL) || (epType == BusEndpoint::ENDPOINT_TYPE_BUS2BUS)) {
+        uid = _PolicyDB::NO_IDENTITY;
+        gid = _PolicyDB::NO_IDENTITY;
+    } else {
+        uid = ep.GetUserId();
+        gid = ep.GetGroupId();
+    }
+}
+
+bool DaemonRouter::OKToOwn(const qcc::String& aliasName, const qcc::String& uniqueName)
+{
+    bool enforce;
+    PolicyDB policy = GetPolicy(enforce);
+    if (!enforce) {
+        return true;
+    }
+    BusEndpoint* ep = nameTable.FindEndpoint(uniqueName);
+    if (!ep || (ep == localEndpoint)) {
+        return true;
+    }
+    uint32_t uid;
+    uint32_t gid;
+    GetPolicyIds(*ep, uid, gid);
+    return policy->OKToOwn(policy->LookupStringID(aliasName), uid, gid);
+}
+
+void DaemonRouter::NameOwnerChanged(const qcc::String& alias, const qcc::String* oldOwner, const qcc::String* newOwner)
+{
+    bool enforce;
+    PolicyDB policy = GetPolicy(enforce);
+    if (enforce) {
+        policy->NameOwnerChanged(alias, oldOwner, newOwner);
+    }
+}
+
+/*
+ * Check if the policy allows a message to be routed from the sender to the destination.
+ */
+static inline bool OKToRoute(const PolicyDB& policy, const Message& msg, BusEndpoint& sender, BusEndpoint& dest)
+{
+    uint32_t suid, sgid, duid, dgid;
+    GetPolicyIds(sender, suid, sgid);
+    GetPolicyIds(dest, duid, dgid);
+    return policy->OKToRoute(msg, suid, sgid, duid, dgid);
 }
 
 static QStatus SendThroughEndpoint(Message& msg, BusEndpoint& ep, SessionId sessionId)
@@ -64,6 +155,10 @@ static QStatus SendThroughEndpoint(Message& msg, BusEndpoint& ep, SessionId sess
 
 QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
 {
+    if (MessageTrace::IsEnabled()) {
+        msg->routeTraceTime = MessageTrace::Now();
+    }
+
     QStatus status = ER_OK;
     BusEndpoint* sender = &origSender;
     bool replyExpected = (msg->GetType() == MESSAGE_METHOD_CALL) && ((msg->GetFlags() & ALLJOYN_FLAG_NO_REPLY_EXPECTED) == 0);
@@ -71,6 +166,11 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
     const char* destination = msg->GetDestination();
     SessionId sessionId = msg->GetSessionId();
 
+    /* Messages from the daemon itself are not subject to policy */
+    bool checkPolicy;
+    PolicyDB policy = GetPolicy(checkPolicy);
+    checkPolicy = checkPolicy && (sender != localEndpoint);
+
     bool destinationEmpty = destination[0] == '\0';
     if (!destinationEmpty) {
         nameTable.Lock();
@@ -90,6 +190,17 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                                    msg->GetCallSerial()));
                     msg->ErrorMsg(msg, "org.alljoyn.Bus.Blocked", "Method reply would be blocked because caller does not allow remote messages");
                     PushMessage(msg, *localEndpoint);
+                } else if (checkPolicy && !OKToRoute(policy, msg, *sender, *destEndpoint)) {
+                    QCC_DbgPrintf(("Blocking %s from %s to %s (serial=%d) because policy denies it",
+                                   msg->Description().c_str(),
+                                   msg->GetSender(),
+                                   destEndpoint->GetUniqueName().c_str(),
+                                   msg->GetCallSerial()));
+                    status = ER_BUS_POLICY_VIOLATION;
+                    if (replyExpected) {
+                        msg->ErrorMsg(msg, "org.freedesktop.DBus.Error.AccessDenied", "Message rejected by policy");
+                        PushMessage(msg, *localEndpoint);
+                    }
                 } else {
                     BusEndpoint::EndpointType epType = destEndpoint->GetEndpointType();
                     RemoteEndpoint* protectEp = (epType == BusEndpoint::ENDPOINT_TYPE_REMOTE) || (epType == BusEndpoint::ENDPOINT_TYPE_BUS2BUS) ? static_cast<RemoteEndpoint*>(destEndpoint) : NULL;
@@ -116,7 +227,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                     PushMessage(msg, *localEndpoint);
                 }
             }
-            if ((ER_OK != status) && (ER_BUS_ENDPOINT_CLOSING != status)) {
+            if ((ER_OK != status) && (ER_BUS_ENDPOINT_CLOSING != status) && (ER_BUS_POLICY_VIOLATION != status)) {
                 QCC_LogError(status, ("BusEndpoint::PushMessage failed"));
             }
             nameTable.Unlock();
@@ -157,9 +268,11 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                 QCC_DbgPrintf(("Routing %s (%d) to %s", msg->Description().c_str(), msg->GetCallSerial(), dest->GetUniqueName().c_str()));
                 /*
                  * If the message originated locally or the destination allows remote messages
-                 * forward the message, otherwise silently ignore it.
+                 * forward the message, otherwise silently ignore it. Messages the policy denies
+                 * are also silently ignored.
                  */
-                if (!((sender->GetEndpointType() == BusEndpoint::ENDPOINT_TYPE_BUS2BUS) && !dest->AllowRemoteMessages())) {
+                if (!((sender->GetEndpointType() == BusEndpoint::ENDPOINT_TYPE_BUS2BUS) && !dest->AllowRemoteMessages()) &&
+                    (!checkPolicy || OKToRoute(policy, msg, *sender, *dest))) {
                     BusEndpoint::EndpointType epType = dest->GetEndpointType();
                     RemoteEndpoint* protectEp = (epType == BusEndpoint::ENDPOINT_TYPE_REMOTE) || (epType == BusEndpoint::ENDPOINT_TYPE_BUS2BUS) ? static_cast<RemoteEndpoint*>(dest) : NULL;
                     if (protectEp) {
@@ -221,7 +334,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
         SessionCastEntry sce(sessionId, msg->GetSender(), NULL, NULL);
         set<SessionCastEntry>::iterator sit = sessionCastSet.lower_bound(sce);
         while ((sit != sessionCastSet.end()) && (sit->id == sce.id) && (sit->src == sce.src)) {
-            if (!sit->b2bEp || (sit->b2bEp != lastB2b)) {
+            if ((!sit->b2bEp || (sit->b2bEp != lastB2b)) && (!checkPolicy || OKToRoute(policy, msg, *sender, *sit->destEp))) {
                 lastB2b = sit->b2bEp;
                 SessionCastEntry entry = *sit;
                 BusEndpoint::EndpointType epType = sit->destEp->GetEndpointType();
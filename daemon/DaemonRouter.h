@@ -24,6 +24,7 @@
 
 #include <qcc/platform.h>
 
+#include <qcc/Mutex.h>
 #include <qcc/Thread.h>
 
 #include "Transport.h"
@@ -34,6 +35,7 @@
 #include "Router.h"
 #include "NameTable.h"
 #include "RuleTable.h"
+#include "compatibilty/PolicyDB.h"
 
 namespace ajn {
 
@@ -41,12 +43,13 @@ namespace ajn {
  * @internal Forward delcarations
  */
 class BusController;
+class DaemonConfig;
 
 /**
  * DaemonRouter is a "full-featured" router responsible for routing Bus messages
  * between one or more remote endpoints and a single local endpoint.
  */
-class DaemonRouter : public Router {
+class DaemonRouter : public Router, public NameListener {
 
     friend class TCPEndpoint;
     friend class UnixEndpoint;
@@ -65,6 +68,37 @@ class DaemonRouter : public Router {
      */
     void SetBusController(BusController* busController) { this->busController = busController; }
 
+    /**
+     * Load the send, receive and own policy from the <policy> elements of the daemon
+     * configuration, replacing the previously loaded policy and its cached decisions. If the
+     * configuration has no <policy> elements the policy is not enforced. If the configuration has
+     * an invalid policy the previously loaded policy stays in effect.
+     *
+     * @param config   The daemon configuration.
+     *
+     * @return  true if the policy was loaded, false if the policy is invalid.
+     */
+    bool LoadPolicy(DaemonConfig& config);
+
+    /**
+     * Check if the policy allows the owner of a unique name to own a well-known name.
+     *
+     * @param aliasName    Well-known name being requested.
+     * @param uniqueName   Unique name of endpoint attempting to own aliasName.
+     *
+     * @return  true if ownership is allowed or no policy is being enforced.
+     */
+    bool OKToOwn(const qcc::String& aliasName, const qcc::String& uniqueName);
+
+    /**
+     * NameListener implementation that keeps the policy's view of bus name ownership current.
+     *
+     * @param alias     Well-known bus name now owned by newOwner.
+     * @param oldOwner  Unique name of old owner of alias or NULL if none existed.
+     * @param newOwner  Unique name of new owner of alias or NULL if none (now) exists.
+     */
+    void NameOwnerChanged(const qcc::String& alias, const qcc::String* oldOwner, const qcc::String* newOwner);
+
     /**
      * Add a bus name listener.
      *
@@ -93,6 +127,14 @@ class DaemonRouter : public Router {
      */
     qcc::String GenerateUniqueName(void) { return nameTable.GenerateUniqueName(); }
 
+    /**
+     * Get a copy of a unique name that shares its storage with the name table.
+     *
+     * @param uniqueName  The unique name.
+     * @return  The shared copy of the name.
+     */
+    qcc::String InternUniqueName(const qcc::String& uniqueName) const { return nameTable.InternUniqueName(uniqueName); }
+
     /**
      * Add a well-known (alias) bus name.
      *
@@ -224,6 +266,20 @@ class DaemonRouter : public Router {
      */
     void UnlockNameTable() { nameTable.Unlock(); }
 
+    /**
+     * Get the number of names in the name table without locking it.
+     *
+     * @return  The number of unique, alias and virtual alias names.
+     */
+    uint32_t GetNameCount() const { return nameTable.GetNameCount(); }
+
+    /**
+     * Get the number of routing rules without locking the rule table.
+     *
+     * @return  The number of rules.
+     */
+    uint32_t GetRuleCount() const { return ruleTable.GetRuleCount(); }
+
     /**
      * Get all unique names and their exportable alias (well-known) names.
      *
@@ -314,6 +370,26 @@ class DaemonRouter : public Router {
     std::set<RemoteEndpoint*> m_b2bEndpoints;  /**< Collection of Bus-to-bus endpoints */
     qcc::Mutex m_b2bEndpointsLock;       /**< Lock that protects m_b2bEndpoints */
 
+    PolicyDB policyDB;                   /**< Send, receive and own policy */
+    bool enforcePolicy;                  /**< true if the configuration has a policy */
+    qcc::Mutex policyLock;               /**< Lock that protects policyDB and enforcePolicy */
+
+    /**
+     * Get the current policy.
+     *
+     * @param enforce  [OUT] true if the policy is being enforced.
+     *
+     * @return  The current policy.
+     */
+    PolicyDB GetPolicy(bool& enforce)
+    {
+        policyLock.Lock(MUTEX_CONTEXT);
+        PolicyDB policy(policyDB);
+        enforce = enforcePolicy;
+        policyLock.Unlock(MUTEX_CONTEXT);
+        return policy;
+    }
+
     /** Session multicast destination map */
     struct SessionCastEntry {
         SessionId id;
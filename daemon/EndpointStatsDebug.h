@@ -0,0 +1,134 @@
+/**
+ * @file
+ * AllJoynDebugObj addon implementing org.alljoyn.Bus.Debug.Stats for getting the traffic and
+ * resource counters of the daemon and of each remote endpoint.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_ENDPOINTSTATSDEBUG_H
+#define _ALLJOYN_ENDPOINTSTATSDEBUG_H
+
+// Include contents in debug builds only.
+#ifndef NDEBUG
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <alljoyn/MsgArg.h>
+
+#include "AllJoynDebugObj.h"
+#include "AllJoynObj.h"
+#include "DaemonRouter.h"
+#include "EndpointStats.h"
+
+
+namespace ajn {
+
+namespace debug {
+
+/**
+ * Addon for org.alljoyn.Bus.Debug.Stats.
+ *
+ * GetStats() returns an a{sv} snapshot of the counters. The entry with an empty key holds the
+ * daemon wide counters as (uuuu):
+ *
+ * - number of names in the name table
+ * - number of routing rules
+ * - number of session map entries (one for each endpoint in each session)
+ * - number of JoinSession threads
+ *
+ * Each remote endpoint has an entry keyed by its unique name holding the struct described by
+ * EndpointStats::ToMsgArg().
+ *
+ * The snapshot is taken without holding the router or name table locks.
+ *
+ * @cond ALLJOYN_DEV
+ *
+ * This is implemented entirely in the header file for the same reasons as BTDebugObj.
+ *
+ * @endcond
+ */
+class EndpointStatsDebugObj : public AllJoynDebugObjAddon {
+  public:
+    class StatsProperties : public AllJoynDebugObj::Properties {
+      public:
+        void GetProperyInfo(const AllJoynDebugObj::Properties::Info*& info, size_t& infoSize)
+        {
+            info = NULL;
+            infoSize = 0;
+        }
+    };
+
+    EndpointStatsDebugObj(DaemonRouter& router, AllJoynObj& ajObj) : router(router), ajObj(ajObj)
+    {
+        AllJoynDebugObj* dbg = AllJoynDebugObj::GetAllJoynDebugObj();
+
+#define _MethodHandler(_a) static_cast<AllJoynDebugObjAddon::MethodHandler>(_a)
+        AllJoynDebugObj::MethodInfo methodInfo[] = {
+            { "GetStats",  NULL,   "a{sv}",  "stats",
+              _MethodHandler(&EndpointStatsDebugObj::GetStatsHandler) },
+        };
+#undef _MethodHandler
+
+        dbg->AddDebugInterface(this,
+                               "org.alljoyn.Bus.Debug.Stats",
+                               methodInfo, ArraySize(methodInfo),
+                               properties);
+    }
+
+  private:
+
+    QStatus GetStatsHandler(Message& msg, std::vector<MsgArg>& replyArgs)
+    {
+        std::vector<EndpointStats::Snapshot> endpoints;
+        EndpointStats::GetSnapshots(endpoints);
+
+        std::vector<MsgArg> vals(endpoints.size() + 1);
+        std::vector<MsgArg> entries(endpoints.size() + 1);
+        QStatus status = vals[0].Set("(uuuu)",
+                                     router.GetNameCount(),
+                                     router.GetRuleCount(),
+                                     ajObj.GetSessionMapCount(),
+                                     ajObj.GetJoinSessionThreadCount());
+        if (status == ER_OK) {
+            status = entries[0].Set("{sv}", "", &vals[0]);
+        }
+        for (size_t i = 0; (status == ER_OK) && (i < endpoints.size()); ++i) {
+            status = EndpointStats::ToMsgArg(endpoints[i], vals[i + 1]);
+            if (status == ER_OK) {
+                status = entries[i + 1].Set("{sv}", endpoints[i].name.c_str(), &vals[i + 1]);
+            }
+        }
+        if (status == ER_OK) {
+            replyArgs.resize(1);
+            status = replyArgs[0].Set("a{sv}", entries.size(), &entries[0]);
+            replyArgs[0].Stabilize();
+        }
+        return status;
+    }
+
+    DaemonRouter& router;
+    AllJoynObj& ajObj;
+    StatsProperties properties;
+};
+
+} // namespace debug
+} // namespace ajn
+
+#endif
+#endif
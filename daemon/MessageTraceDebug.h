@@ -0,0 +1,190 @@
+/**
+ * @file
+ * AllJoynDebugObj addon implementing org.alljoyn.Bus.Debug.MessageTrace for controlling message
+ * tracing and getting the message latency histograms.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_MESSAGETRACEDEBUG_H
+#define _ALLJOYN_MESSAGETRACEDEBUG_H
+
+// Include contents in debug builds only.
+#ifndef NDEBUG
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <alljoyn/MsgArg.h>
+
+#include "AllJoynDebugObj.h"
+#include "MessageTrace.h"
+
+
+namespace ajn {
+
+namespace debug {
+
+/**
+ * Addon for org.alljoyn.Bus.Debug.MessageTrace.
+ *
+ * - Enable(b) turns message tracing on or off.
+ * - Reset() clears all the histograms.
+ * - GetHistograms() returns a(sa(ya(uu))): for the whole bus (empty name) and then for each
+ *   endpoint, for each stage the non-empty buckets as (lower bound in microseconds, count).
+ * - GetPercentiles() returns a(sa(yuuuu)): for the whole bus and each endpoint, for each stage the
+ *   count and the 50th, 90th and 99th percentile latencies in microseconds.
+ * - The Enabled property tells if tracing is on.
+ *
+ * @cond ALLJOYN_DEV
+ *
+ * This is implemented entirely in the header file for the same reasons as BTDebugObj.
+ *
+ * @endcond
+ */
+class MessageTraceDebugObj : public AllJoynDebugObjAddon {
+  public:
+    class MessageTraceProperties : public AllJoynDebugObj::Properties {
+      public:
+        QStatus Get(const char* propName, MsgArg& val) const
+        {
+            if (::strcmp(propName, "Enabled") == 0) {
+                return val.Set("b", MessageTrace::IsEnabled());
+            }
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+
+        QStatus Set(const char* propName, MsgArg& val)
+        {
+            if (::strcmp(propName, "Enabled") == 0) {
+                return ER_BUS_PROPERTY_ACCESS_DENIED;
+            }
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+
+        void GetProperyInfo(const AllJoynDebugObj::Properties::Info*& info, size_t& infoSize)
+        {
+            static const AllJoynDebugObj::Properties::Info ourInfo[] = {
+                { "Enabled", "b", PROP_ACCESS_READ },
+            };
+            info = ourInfo;
+            infoSize = ArraySize(ourInfo);
+        }
+    };
+
+    MessageTraceDebugObj()
+    {
+        AllJoynDebugObj* dbg = AllJoynDebugObj::GetAllJoynDebugObj();
+
+#define _MethodHandler(_a) static_cast<AllJoynDebugObjAddon::MethodHandler>(_a)
+        AllJoynDebugObj::MethodInfo methodInfo[] = {
+            { "Enable",          "b",    NULL,             "enable",
+              _MethodHandler(&MessageTraceDebugObj::EnableHandler) },
+            { "Reset",           NULL,   NULL,             NULL,
+              _MethodHandler(&MessageTraceDebugObj::ResetHandler) },
+            { "GetHistograms",   NULL,   "a(sa(ya(uu)))",  "histograms",
+              _MethodHandler(&MessageTraceDebugObj::GetHistogramsHandler) },
+            { "GetPercentiles",  NULL,   "a(sa(yuuuu))",   "percentiles",
+              _MethodHandler(&MessageTraceDebugObj::GetPercentilesHandler) },
+        };
+#undef _MethodHandler
+
+        dbg->AddDebugInterface(this,
+                               "org.alljoyn.Bus.Debug.MessageTrace",
+                               methodInfo, ArraySize(methodInfo),
+                               properties);
+    }
+
+  private:
+
+    QStatus EnableHandler(Message& msg, std::vector<MsgArg>& replyArgs)
+    {
+        bool enable;
+        QStatus status = msg->GetArgs("b", &enable);
+        if (status == ER_OK) {
+            MessageTrace::Enable(enable);
+        }
+        return status;
+    }
+
+    QStatus ResetHandler(Message& msg, std::vector<MsgArg>& replyArgs)
+    {
+        MessageTrace::Reset();
+        return ER_OK;
+    }
+
+    QStatus GetHistogramsHandler(Message& msg, std::vector<MsgArg>& replyArgs)
+    {
+        return Report(false, replyArgs);
+    }
+
+    QStatus GetPercentilesHandler(Message& msg, std::vector<MsgArg>& replyArgs)
+    {
+        return Report(true, replyArgs);
+    }
+
+    /* Build the reply for GetHistograms or GetPercentiles */
+    QStatus Report(bool percentiles, std::vector<MsgArg>& replyArgs)
+    {
+        std::vector<MessageTrace::EndpointHistograms> endpoints(1);
+        endpoints[0].histograms = MessageTrace::GetBusHistograms();
+        std::vector<MessageTrace::EndpointHistograms> remotes;
+        MessageTrace::GetEndpointHistograms(remotes);
+        endpoints.insert(endpoints.end(), remotes.begin(), remotes.end());
+
+        QStatus status = ER_OK;
+        std::vector<MsgArg> sets(endpoints.size());
+        for (size_t i = 0; (status == ER_OK) && (i < endpoints.size()); ++i) {
+            std::vector<MsgArg> stages(MessageTrace::NUM_STAGES);
+            for (uint8_t s = 0; (status == ER_OK) && (s < MessageTrace::NUM_STAGES); ++s) {
+                const LatencyHistogram& h = endpoints[i].histograms.stage[s];
+                if (percentiles) {
+                    status = stages[s].Set("(yuuuu)", s, h.GetTotal(),
+                                           (uint32_t)h.GetPercentile(50), (uint32_t)h.GetPercentile(90), (uint32_t)h.GetPercentile(99));
+                } else {
+                    std::vector<MsgArg> buckets;
+                    for (size_t b = 0; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+                        uint32_t count = h.GetCount(b);
+                        if (count) {
+                            buckets.push_back(MsgArg("(uu)", (uint32_t)LatencyHistogram::BucketLowerBound(b), count));
+                        }
+                    }
+                    status = stages[s].Set("(ya(uu))", s, buckets.size(), buckets.empty() ? NULL : &buckets[0]);
+                }
+                stages[s].Stabilize();
+            }
+            if (status == ER_OK) {
+                status = sets[i].Set(percentiles ? "(sa(yuuuu))" : "(sa(ya(uu)))", endpoints[i].name.c_str(), stages.size(), &stages[0]);
+                sets[i].Stabilize();
+            }
+        }
+        if (status == ER_OK) {
+            replyArgs.resize(1);
+            status = replyArgs[0].Set(percentiles ? "a(sa(yuuuu))" : "a(sa(ya(uu)))", sets.size(), &sets[0]);
+            replyArgs[0].Stabilize();
+        }
+        return status;
+    }
+
+    MessageTraceProperties properties;
+};
+
+} // namespace debug
+} // namespace ajn
+
+#endif
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * Thread that periodically appends the message latency histograms to a binary file
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+#include <qcc/time.h>
+
+#include "MessageTrace.h"
+#include "MessageTraceDump.h"
+
+#define QCC_MODULE "ALLJOYN_DAEMON"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+static void Put16(vector<uint8_t>& buf, uint16_t v)
+{
+    buf.push_back((uint8_t)v);
+    buf.push_back((uint8_t)(v >> 8));
+}
+
+static void Put32(vector<uint8_t>& buf, uint32_t v)
+{
+    Put16(buf, (uint16_t)v);
+    Put16(buf, (uint16_t)(v >> 16));
+}
+
+static void Put64(vector<uint8_t>& buf, uint64_t v)
+{
+    Put32(buf, (uint32_t)v);
+    Put32(buf, (uint32_t)(v >> 32));
+}
+
+static void PutHistograms(vector<uint8_t>& buf, const qcc::String& name, const MessageTrace::Histograms& histograms)
+{
+    size_t nameLen = (name.size() < 0xFFFF) ? name.size() : 0xFFFF;
+    Put16(buf, (uint16_t)nameLen);
+    buf.insert(buf.end(), name.data(), name.data() + nameLen);
+    buf.push_back((uint8_t)MessageTrace::NUM_STAGES);
+    for (size_t s = 0; s < MessageTrace::NUM_STAGES; ++s) {
+        const LatencyHistogram& h = histograms.stage[s];
+        /* Take the counts once so the bucket count matches the buckets written */
+        uint32_t counts[LatencyHistogram::NUM_BUCKETS];
+        uint16_t used = 0;
+        for (size_t b = 0; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+            counts[b] = h.GetCount(b);
+            if (counts[b]) {
+                ++used;
+            }
+        }
+        Put16(buf, used);
+        for (size_t b = 0; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+            if (counts[b]) {
+                Put16(buf, (uint16_t)b);
+                Put32(buf, counts[b]);
+            }
+        }
+    }
+}
+
+MessageTraceDump::MessageTraceDump(const qcc::String& fileName, uint32_t intervalMs) :
+    Thread("MessageTraceDump"),
+    fileName(fileName),
+    intervalMs(intervalMs)
+{
+}
+
+void MessageTraceDump::Snapshot(std::vector<uint8_t>& buf)
+{
+    vector<MessageTrace::EndpointHistograms> endpoints;
+    MessageTrace::GetEndpointHistograms(endpoints);
+
+    buf.clear();
+    Put32(buf, MAGIC);
+    Put16(buf, VERSION);
+    Put16(buf, (uint16_t)LatencyHistogram::NUM_BUCKETS);
+    Put64(buf, GetTimestamp64());
+    Put32(buf, (uint32_t)(endpoints.size() + 1));
+    PutHistograms(buf, qcc::String(), MessageTrace::GetBusHistograms());
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        PutHistograms(buf, endpoints[i].name, endpoints[i].histograms);
+    }
+}
+
+QStatus MessageTraceDump::Dump()
+{
+    QStatus status = ER_OK;
+    vector<uint8_t> buf;
+    Snapshot(buf);
+
+    FILE* fp = fopen(fileName.c_str(), "ab");
+    if (fp) {
+        if ((fwrite(&buf[0], 1, buf.size(), fp) != buf.size()) || (fflush(fp) != 0)) {
+            status = ER_BUS_WRITE_ERROR;
+        }
+        fclose(fp);
+    } else {
+        status = ER_BUS_WRITE_ERROR;
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Cannot write message trace to %s", fileName.c_str()));
+    }
+    return status;
+}
+
+qcc::ThreadReturn STDCALL MessageTraceDump::Run(void* arg)
+{
+    while (!IsStopping()) {
+        QStatus status = Event::Wait(Event::neverSet, intervalMs);
+        if (status == ER_TIMEOUT) {
+            Dump();
+        } else if (status == ER_ALERTED_THREAD) {
+            stopEvent.ResetEvent();
+        }
+    }
+    /* Keep the final counts */
+    Dump();
+    return (qcc::ThreadReturn) 0;
+}
+
+}
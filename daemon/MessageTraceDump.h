@@ -0,0 +1,98 @@
+/**
+ * @file
+ * Thread that periodically appends the message latency histograms to a binary file
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_MESSAGETRACEDUMP_H
+#define _ALLJOYN_MESSAGETRACEDUMP_H
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/Thread.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * %MessageTraceDump appends a snapshot of the MessageTrace histograms to a file at a fixed
+ * interval and once more when it is stopped. Counts are cumulative so the difference between two
+ * snapshots gives the latencies recorded in between.
+ *
+ * Each snapshot is a record of little endian values:
+ *
+ * @code
+ *   uint32  magic "AJLT" (0x544c4a41)
+ *   uint16  format version (1)
+ *   uint16  number of buckets per histogram (LatencyHistogram::NUM_BUCKETS)
+ *   uint64  snapshot time in milliseconds
+ *   uint32  number of histogram sets, the first is for the whole bus
+ *   then for each histogram set
+ *     uint16  length of the endpoint name, 0 for the whole bus
+ *     bytes   endpoint unique name
+ *     uint8   number of stages (MessageTrace::NUM_STAGES)
+ *     then for each stage
+ *       uint16  number of non-empty buckets
+ *       then for each non-empty bucket
+ *         uint16  bucket index, see LatencyHistogram::BucketLowerBound()
+ *         uint32  count
+ * @endcode
+ */
+class MessageTraceDump : public qcc::Thread {
+  public:
+
+    /** Snapshot record magic number */
+    static const uint32_t MAGIC = 0x544c4a41;
+
+    /** Snapshot record format version */
+    static const uint16_t VERSION = 1;
+
+    /**
+     * Constructor
+     *
+     * @param fileName    File the snapshots are appended to.
+     * @param intervalMs  Milliseconds between snapshots.
+     */
+    MessageTraceDump(const qcc::String& fileName, uint32_t intervalMs);
+
+    /**
+     * Serialize a snapshot of the current histograms.
+     *
+     * @param buf  [OUT] The snapshot record.
+     */
+    static void Snapshot(std::vector<uint8_t>& buf);
+
+  protected:
+
+    qcc::ThreadReturn STDCALL Run(void* arg);
+
+  private:
+
+    /** Append a snapshot to the file */
+    QStatus Dump();
+
+    qcc::String fileName;       /**< File the snapshots are appended to */
+    uint32_t intervalMs;        /**< Milliseconds between snapshots */
+};
+
+}
+
+#endif
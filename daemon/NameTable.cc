@@ -64,12 +64,23 @@ void NameTable::AddUniqueName(BusEndpoint& endpoint)
     QCC_DbgPrintf(("Add unique name %s", uniqueName.c_str()));
     lock.Lock(MUTEX_CONTEXT);
     uniqueNames[uniqueName] = &endpoint;
+    UpdateNameCount();
     lock.Unlock(MUTEX_CONTEXT);
 
     /* Notify listeners */
     CallListeners(uniqueName, NULL, &uniqueName);
 }
 
+qcc::String NameTable::InternUniqueName(const qcc::String& uniqueName) const
+{
+    qcc::String ret;
+    lock.Lock(MUTEX_CONTEXT);
+    hash_map<qcc::String, BusEndpoint*, Hash, Equal>::const_iterator it = uniqueNames.find(uniqueName);
+    ret = (it != uniqueNames.end()) ? it->first : uniqueName;
+    lock.Unlock(MUTEX_CONTEXT);
+    return ret;
+}
+
 void NameTable::RemoveUniqueName(const qcc::String& uniqueName)
 {
     QCC_DbgTrace(("RemoveUniqueName %s", uniqueName.c_str()));
@@ -118,6 +129,7 @@ void NameTable::RemoveUniqueName(const qcc::String& uniqueName)
 
         QCC_DbgPrintf(("Removing ep=%s from name table", uniqueName.c_str()));
         uniqueNames.erase(it);
+        UpdateNameCount();
 
     }
     lock.Unlock(MUTEX_CONTEXT);
@@ -138,7 +150,8 @@ QStatus NameTable::AddAlias(const qcc::String& aliasName,
     hash_map<qcc::String, BusEndpoint*, Hash, Equal>::const_iterator it = uniqueNames.find(uniqueName);
     if (it != uniqueNames.end()) {
         hash_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::iterator wasIt = aliasNames.find(aliasName);
-        NameQueueEntry entry = { uniqueName, flags };
+        /* Queue entries share the unique name table's copy of the name */
+        NameQueueEntry entry = { it->first, flags };
         const qcc::String* origOwner = NULL;
         const qcc::String* newOwner = NULL;
 
@@ -167,6 +180,7 @@ QStatus NameTable::AddAlias(const qcc::String& aliasName,
         } else {
             /* No pre-existing queue for this name */
             aliasNames[aliasName] = deque<NameQueueEntry>(1, entry);
+            UpdateNameCount();
             disposition = DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER;
             newOwner = &uniqueName;
 
@@ -226,6 +240,7 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
                     newOwner = &vit->second->GetUniqueName();
                 }
                 aliasNames.erase(it);
+                UpdateNameCount();
             }
             oldOwner = &ownerName;
             disposition = DBUS_RELEASE_NAME_REPLY_RELEASED;
@@ -376,6 +391,7 @@ void NameTable::RemoveVirtualAliases(VirtualEndpoint& ep)
             ++vit;
         }
     }
+    UpdateNameCount();
     lock.Unlock(MUTEX_CONTEXT);
 }
 
@@ -415,6 +431,7 @@ bool NameTable::SetVirtualAlias(const qcc::String& alias,
     } else {
         virtualAliasNames.erase(StringMapKey(alias));
     }
+    UpdateNameCount();
     lock.Unlock(MUTEX_CONTEXT);
 
     /* Virtual aliases cannot override locally requested aliases */
@@ -73,7 +73,7 @@ class NameTable {
     /**
      * Constructor
      */
-    NameTable() : uniqueId(0), uniquePrefix(":1.") { }
+    NameTable() : uniqueId(0), uniquePrefix(":1."), nameCount(0) { }
 
     /**
      * Set the GUID of the bus.
@@ -205,6 +205,24 @@ class NameTable {
      */
     void GetQueuedNames(const qcc::String& busName, std::vector<qcc::String>& names);
 
+    /**
+     * Get a copy of a unique name that shares its storage with the name table entry. Tables that
+     * keep a unique name for each session or alias use this so that every copy of the name refers
+     * to a single buffer.
+     *
+     * @param uniqueName  The unique name.
+     * @return  The shared copy of the name or a plain copy if uniqueName is not in the table.
+     */
+    qcc::String InternUniqueName(const qcc::String& uniqueName) const;
+
+    /**
+     * Get the number of unique, alias and virtual alias names in the table. The count is kept
+     * up to date as names are added and removed so reading it does not need the lock.
+     *
+     * @return  The number of names.
+     */
+    uint32_t GetNameCount() const { return nameCount; }
+
     /**
      * Lock table.
      */
@@ -240,6 +258,12 @@ class NameTable {
     qcc::String uniquePrefix;
     std::vector<NameListener*> listeners;                              /**< Listeners regsitered with name table */
     std::map<qcc::StringMapKey, VirtualEndpoint*> virtualAliasNames;   /**< map of virtual aliases to virtual endpts */
+    uint32_t nameCount;                                                /**< Total number of names in the tables */
+
+    /**
+     * Helper to refresh nameCount. Must be called with the lock held after changing the tables.
+     */
+    void UpdateNameCount() { nameCount = (uint32_t)(uniqueNames.size() + aliasNames.size() + virtualAliasNames.size()); }
 
     /**
      * Helper used to call the listners
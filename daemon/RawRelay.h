@@ -0,0 +1,111 @@
+/**
+ * @file
+ * RawRelay joins pairs of raw session sockets in the daemon
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_RAWRELAY_H
+#define _ALLJOYN_RAWRELAY_H
+
+#ifndef __cplusplus
+#error Only include RawRelay.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <set>
+
+#include <qcc/Mutex.h>
+#include <qcc/SocketTypes.h>
+#include <qcc/Thread.h>
+
+#include <alljoyn/Session.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * %RawRelay copies raw session traffic between the two bus-to-bus sockets of a daemon that is
+ * the middle-man for a raw session.
+ *
+ * The bytes are moved with splice() through a kernel pipe in each direction so they are never
+ * copied into user space. All the relayed sessions share a single thread that waits for the
+ * sockets to become ready with epoll. A relay ends when both directions have reached end of file
+ * or when either socket fails.
+ */
+class RawRelay : public qcc::Thread {
+  public:
+
+    /**
+     * Constructor
+     */
+    RawRelay();
+
+    /**
+     * Destructor, stops the relay thread and closes any sockets still being relayed.
+     */
+    ~RawRelay();
+
+    /**
+     * Start relaying between two connected stream sockets. The relay thread is started on first use.
+     *
+     * @param id     The session being relayed, used for logging.
+     * @param sock1  One socket, ownership is transferred to the relay even on failure.
+     * @param sock2  The other socket, ownership is transferred to the relay even on failure.
+     *
+     * @return  ER_OK if the sockets are being relayed.
+     */
+    QStatus AddRelay(SessionId id, qcc::SocketFd sock1, qcc::SocketFd sock2);
+
+    /**
+     * Get the number of sessions currently being relayed.
+     *
+     * @return  The number of sessions.
+     */
+    size_t GetNumRelays();
+
+  protected:
+
+    /**
+     * Thread entry point, waits for socket activity and moves data.
+     */
+    qcc::ThreadReturn STDCALL Run(void* arg);
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    RawRelay(const RawRelay& other);
+    RawRelay& operator=(const RawRelay& other);
+
+    struct Relay;
+    struct Side;
+
+    /** Move as much data as possible in both directions, returns false when the relay is finished */
+    bool Pump(Relay* relay);
+
+    /** Close a relay's sockets and pipes and free it */
+    void Close(Relay* relay);
+
+    int epollFd;                /**< epoll fd for all the relayed sockets */
+    qcc::Mutex lock;            /**< Protects relays */
+    std::set<Relay*> relays;    /**< The sessions being relayed */
+};
+
+}
+
+#endif
@@ -102,6 +102,9 @@ typedef std::multimap<BusEndpoint*, Rule>::iterator RuleIterator;
 class RuleTable {
   public:
 
+    /** Constructor */
+    RuleTable() : ruleCount(0) { }
+
     /**
      * Add a rule for an endpoint.
      *
@@ -113,6 +116,7 @@ class RuleTable {
     {
         Lock();
         rules.insert(std::pair<BusEndpoint*, Rule>(&endpoint, rule));
+        ruleCount = (uint32_t)rules.size();
         Unlock();
         return ER_OK;
     }
@@ -135,6 +139,7 @@ class RuleTable {
             }
             range.first++;
         }
+        ruleCount = (uint32_t)rules.size();
         Unlock();
         return ER_OK;
     }
@@ -152,6 +157,7 @@ class RuleTable {
         if (range.first != rules.end()) {
             rules.erase(range.first, range.second);
         }
+        ruleCount = (uint32_t)rules.size();
         Unlock();
         return ER_OK;
     }
@@ -217,9 +223,17 @@ class RuleTable {
         return ret;
     }
 
+    /**
+     * Get the number of rules in the table. Reading the count does not need the lock.
+     *
+     * @return  The number of rules.
+     */
+    uint32_t GetRuleCount() const { return ruleCount; }
+
   private:
     qcc::Mutex lock;                            /**< Lock protecting rule table */
     std::multimap<BusEndpoint*, Rule> rules;    /**< Rule table */
+    uint32_t ruleCount;                         /**< Number of rules in the rule table */
 };
 
 }
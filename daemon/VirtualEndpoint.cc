@@ -100,6 +100,17 @@ RemoteEndpoint* VirtualEndpoint::GetBusToBusEndpoint(SessionId sessionId, int* b
     return ret;
 }
 
+void VirtualEndpoint::GetBusToBusEndpoints(vector<RemoteEndpoint*>& endpoints) const
+{
+    m_b2bEndpointsLock.Lock(MUTEX_CONTEXT);
+    multimap<SessionId, RemoteEndpoint*>::const_iterator it = m_b2bEndpoints.begin();
+    while ((it != m_b2bEndpoints.end()) && (it->first == 0)) {
+        endpoints.push_back(it->second);
+        ++it;
+    }
+    m_b2bEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
 bool VirtualEndpoint::AddBusToBusEndpoint(RemoteEndpoint& endpoint)
 {
     QCC_DbgTrace(("VirtualEndpoint::AddBusToBusEndpoint(this=%s, b2b=%s)", GetUniqueName().c_str(), endpoint.GetUniqueName().c_str()));
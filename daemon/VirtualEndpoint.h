@@ -81,18 +81,20 @@ class VirtualEndpoint : public BusEndpoint {
     const qcc::String& GetUniqueName() const { return m_uniqueName; }
 
     /**
-     * Return the user id of the endpoint.
+     * Return the user id of the endpoint. Virtual endpoints are applications on other devices and
+     * have no local user id.
      *
-     * @return  User ID number.
+     * @return  -1 (no user id).
      */
-    uint32_t GetUserId() const { return 0; };
+    uint32_t GetUserId() const { return -1; }
 
     /**
-     * Return the group id of the endpoint.
+     * Return the group id of the endpoint. Virtual endpoints are applications on other devices and
+     * have no local group id.
      *
-     * @return  Group ID number.
+     * @return  -1 (no group id).
      */
-    uint32_t GetGroupId() const { return 0; }
+    uint32_t GetGroupId() const { return -1; }
 
     /**
      * Return the process id of the endpoint.
@@ -117,6 +119,13 @@ class VirtualEndpoint : public BusEndpoint {
      */
     RemoteEndpoint* GetBusToBusEndpoint(SessionId sessionId = 0, int* b2bCount = NULL) const;
 
+    /**
+     * Get all the bus-to-bus endpoints that can route for this virtual endpoint independent of any session.
+     *
+     * @param[OUT] endpoints   The bus-to-bus endpoints.
+     */
+    void GetBusToBusEndpoints(std::vector<RemoteEndpoint*>& endpoints) const;
+
     /**
      * Add an alternate bus-to-bus endpoint that can route for this endpoint.
      *
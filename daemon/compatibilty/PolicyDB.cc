@@ -122,7 +122,10 @@ bool _PolicyDB::TrueFalseStrToBool(const qcc::String& str, bool& b)
 }
 
 
-_PolicyDB::_PolicyDB() : eavesdrop(false)
+_PolicyDB::_PolicyDB() :
+    eavesdrop(false),
+    nextSetID(FIRST_NAME_SET_ID),
+    keyFields(0)
 {
     stringIDs[""] = WILDCARD;
     stringIDs["*"] = WILDCARD;
@@ -228,7 +231,7 @@ bool _PolicyDB::AddRule(PolicyRuleList& ownList,
         } else if (attr->first.compare("group") == 0) {
             success = !(policyGroup & (SEND | RECEIVE | OWN));
             policyGroup |= CONNECT;
-            rule.user = GetUsersGid(attr->second.c_str());
+            rule.group = GetUsersGid(attr->second.c_str());
             rule.groupSet = true;
 
         } else {
@@ -252,6 +255,10 @@ bool _PolicyDB::AddRule(PolicyRuleList& ownList,
             receiveList.push_back(rule);
         }
 
+        if (policyGroup & (SEND | RECEIVE)) {
+            UpdateKeyFields(rule);
+        }
+
         if (policyGroup & CONNECT) {
             connectList.push_back(rule);
         }
@@ -288,7 +295,16 @@ bool _PolicyDB::AddRule(policydb::PolicyCategory cat,
         break;
 
     case policydb::POLICY_USER: {
+        /*
+         * Rules for a user that does not exist must not end up as rules for
+         * NO_IDENTITY, that would apply them to every off-device peer.
+         */
         uint32_t uid = GetUsersUid(catValue.c_str());
+        if (uid == NO_IDENTITY) {
+            Log(LOG_WARNING, "Ignoring policy for unknown user \"%s\"\n", catValue.c_str());
+            success = true;
+            break;
+        }
         success = AddRule(ownRS.userRules[uid], sendRS.userRules[uid],
                           receiveRS.userRules[uid], connectRS.userRules[uid],
                           permission, ruleAttrs);
@@ -297,6 +313,11 @@ bool _PolicyDB::AddRule(policydb::PolicyCategory cat,
 
     case policydb::POLICY_GROUP: {
         uint32_t gid = GetUsersGid(catValue.c_str());
+        if (gid == NO_IDENTITY) {
+            Log(LOG_WARNING, "Ignoring policy for unknown group \"%s\"\n", catValue.c_str());
+            success = true;
+            break;
+        }
         success = AddRule(ownRS.groupRules[gid], sendRS.groupRules[gid],
                           receiveRS.groupRules[gid], connectRS.groupRules[gid],
                           permission, ruleAttrs);
@@ -319,6 +340,68 @@ bool _PolicyDB::AddRule(policydb::PolicyCategory cat,
 }
 
 
+bool _PolicyDB::AddPolicy(const XmlElement& policy)
+{
+    const vector<XmlElement*>& elements = policy.GetChildren();
+    const map<qcc::String, qcc::String>& attrs(policy.GetAttributes());
+    policydb::PolicyCategory cat;
+    qcc::String catValue;
+
+    if (attrs.size() != 1) {
+        Log(LOG_ERR, "Exactly one policy category must be specified.\n");
+        return false;
+    }
+
+    map<qcc::String, qcc::String>::const_iterator ait(attrs.begin());
+    catValue = ait->second;
+    if (ait->first.compare("context") == 0) {
+        if ((catValue.compare("default") != 0) && (catValue.compare("mandatory") != 0)) {
+            Log(LOG_ERR, "Invalid context attribute for <%s> (must either be \"default\" or \"mandatory\"): \"%s\"\n",
+                policy.GetName().c_str(), catValue.c_str());
+            return false;
+        }
+        cat = policydb::POLICY_CONTEXT;
+    } else if (ait->first.compare("user") == 0) {
+        cat = policydb::POLICY_USER;
+    } else if (ait->first.compare("group") == 0) {
+        cat = policydb::POLICY_GROUP;
+    } else if (ait->first.compare("at_console") == 0) {
+        cat = policydb::POLICY_AT_CONSOLE;
+    } else {
+        Log(LOG_ERR, "Unknown policy category: \"%s\"\n", ait->first.c_str());
+        return false;
+    }
+
+    bool success = true;
+    for (vector<XmlElement*>::const_iterator it = elements.begin(); success && (it != elements.end()); ++it) {
+        if ((*it)->GetName().compare("allow") == 0) {
+            success = AddRule(cat, catValue, policydb::POLICY_ALLOW, (*it)->GetAttributes());
+        } else if ((*it)->GetName().compare("deny") == 0) {
+            success = AddRule(cat, catValue, policydb::POLICY_DENY, (*it)->GetAttributes());
+        } else {
+            Log(LOG_ERR, "Unknown tag found in <%s> block: <%s>\n",
+                policy.GetName().c_str(), (*it)->GetName().c_str());
+            success = false;
+        }
+    }
+    return success;
+}
+
+
+void _PolicyDB::UpdateKeyFields(const PolicyRule& rule)
+{
+    if (rule.path != WILDCARD) {
+        keyFields |= KEY_PATH;
+    }
+    if (rule.error != WILDCARD) {
+        keyFields |= KEY_ERROR;
+    }
+    if (rule.busName != WILDCARD) {
+        keyFields |= KEY_NAMES;
+    }
+}
+
+
 void _PolicyDB::NameOwnerChanged(const qcc::String& alias,
                                  const qcc::String* oldOwner,
                                  const qcc::String* newOwner)
@@ -326,25 +409,48 @@ void _PolicyDB::NameOwnerChanged(const qcc::String& alias,
     StringIDMap::const_iterator bnit(busNameMap.find(alias));
 
     if (bnit != busNameMap.end()) {
+        /*
+         * Every change to a unique name's set of bus names gets a new set id
+         * so decisions cached for the old set can never be found again.
+         */
+        bnLock.Lock(MUTEX_CONTEXT);
         if (oldOwner) {
             UniqueNameIDMap::iterator unit = uniqueNameMap.find(*oldOwner);
             if (unit != uniqueNameMap.end()) {
-                bnLock.Lock(MUTEX_CONTEXT);
-                unit->second.erase(bnit->second);
-                if (unit->second.empty()) {
+                unit->second.names.erase(bnit->second);
+                if (unit->second.names.empty()) {
                     uniqueNameMap.erase(unit);
+                } else {
+                    unit->second.setID = nextSetID++;
                 }
-                bnLock.Unlock(MUTEX_CONTEXT);
             }
         }
         if (newOwner) {
-            if (bnit != busNameMap.end()) {
-                bnLock.Lock(MUTEX_CONTEXT);
-                uniqueNameMap[*newOwner].insert(bnit->second);
-                bnLock.Unlock(MUTEX_CONTEXT);
-            }
+            UniqueNameEntry& entry = uniqueNameMap[*newOwner];
+            entry.names.insert(bnit->second);
+            entry.setID = nextSetID++;
         }
+        bnLock.Unlock(MUTEX_CONTEXT);
+        FlushDecisionCache();
+    }
+}
+
+
+uint32_t _PolicyDB::LookupBusNameSetID(const char* bnStr) const
+{
+    if (bnStr && (bnStr[0] == ':')) {
+        UniqueNameIDMap::const_iterator unit(uniqueNameMap.find(bnStr));
+        return (unit == uniqueNameMap.end()) ? NIL_MATCH : unit->second.setID;
     }
+    return LookupStringID(bnStr);
+}
+
+
+void _PolicyDB::FlushDecisionCache()
+{
+    cacheLock.Lock(MUTEX_CONTEXT);
+    decisionCache.clear();
+    cacheLock.Unlock(MUTEX_CONTEXT);
 }
 
 
@@ -698,3 +804,60 @@ bool _PolicyDB::OKToEavesdrop(const NormalizedMsgHdr& nmh,
 
     return allow;
 }
+
+
+bool _PolicyDB::OKToRoute(const Message& msg,
+                          uint32_t suid,
+                          uint32_t sgid,
+                          uint32_t duid,
+                          uint32_t dgid) const
+{
+    DecisionKey key;
+
+    key.suid = suid;
+    key.sgid = sgid;
+    key.duid = duid;
+    key.dgid = dgid;
+    key.ifcID = LookupStringID(msg->GetInterface());
+    key.memberID = LookupStringID(msg->GetMemberName());
+    key.pathID = (keyFields & KEY_PATH) ? LookupStringID(msg->GetObjectPath()) : WILDCARD;
+    key.errorID = (keyFields & KEY_ERROR) ? LookupStringID(msg->GetErrorName()) : WILDCARD;
+    if (keyFields & KEY_NAMES) {
+        bnLock.Lock(MUTEX_CONTEXT);
+        key.senderNames = LookupBusNameSetID(msg->GetSender());
+        key.destNames = LookupBusNameSetID(msg->GetDestination());
+        bnLock.Unlock(MUTEX_CONTEXT);
+    } else {
+        key.senderNames = WILDCARD;
+        key.destNames = WILDCARD;
+    }
+    key.type = msg->GetType();
+
+    cacheLock.Lock(MUTEX_CONTEXT);
+    DecisionCache::const_iterator it(decisionCache.find(key));
+    if (it != decisionCache.end()) {
+        bool allow = it->second;
+        cacheLock.Unlock(MUTEX_CONTEXT);
+        return allow;
+    }
+    cacheLock.Unlock(MUTEX_CONTEXT);
+
+    /*
+     * Cache miss so walk the rules.  The key holds every field that the rules
+     * match on so the decision holds for every message with the same key.
+     */
+    NormalizedMsgHdr nmh(msg, *this);
+    bool allow = OKToSend(nmh, suid, sgid) && OKToReceive(nmh, duid, dgid);
+
+    ALLJOYN_POLICY_DEBUG(Log(LOG_DEBUG, "Policy %s %s from %s to %s\n", allow ? "allows" : "denies",
+                             msg->Description().c_str(), msg->GetSender(), msg->GetDestination()));
+
+    cacheLock.Lock(MUTEX_CONTEXT);
+    if (decisionCache.size() >= MAX_CACHED_DECISIONS) {
+        decisionCache.clear();
+    }
+    decisionCache[key] = allow;
+    cacheLock.Unlock(MUTEX_CONTEXT);
+
+    return allow;
+}
@@ -23,8 +23,10 @@
 
 #include <qcc/platform.h>
 #include <qcc/ManagedObj.h>
+#include <qcc/Mutex.h>
 #include <qcc/String.h>
 #include <qcc/StringMapKey.h>
+#include <qcc/XmlElement.h>
 
 #include <alljoyn/Message.h>
 
@@ -85,6 +87,14 @@ typedef qcc::ManagedObj<_PolicyDB> PolicyDB;
  */
 class _PolicyDB {
   public:
+    /**
+     * User and group id for senders and destinations that have no local
+     * identity such as endpoints for applications on other devices.  No
+     * user or group rule ever matches it, only the default, mandatory and
+     * at_console rules apply.
+     */
+    static const uint32_t NO_IDENTITY = 0xffffffff;
+
     /**
      * Constructor.
      */
@@ -160,6 +170,29 @@ class _PolicyDB {
                        uint32_t duid,
                        uint32_t dgid) const;
 
+    /**
+     * Determine if a message may be routed from the sender to the
+     * destination.  This combines OKToSend() for the sender with
+     * OKToReceive() for the destination.  Decisions are cached keyed on the
+     * user and group ids and the normalized header fields the rules refer
+     * to so that the rule lists are only walked the first time a
+     * combination is seen.  The cache is discarded whenever ownership of a
+     * bus name referenced by the rules changes.
+     *
+     * @param msg   The message to be routed
+     * @param suid  Numeric user id of the sender
+     * @param sgid  Numeric group id of the sender
+     * @param duid  Numeric user id of the destination
+     * @param dgid  Numeric group id of the destination
+     *
+     * @return true = routing allowed, false = routing denied.
+     */
+    bool OKToRoute(const ajn::Message& msg,
+                   uint32_t suid,
+                   uint32_t sgid,
+                   uint32_t duid,
+                   uint32_t dgid) const;
+
     /**
      * Convert a string to a normalized form.
      *
@@ -206,6 +239,16 @@ class _PolicyDB {
                  policydb::PolicyPermission permission,
                  const std::map<qcc::String, qcc::String>& ruleAttrs);
 
+    /**
+     * Adds the rules from a <policy> configuration element to the Policy
+     * database.
+     *
+     * @param policy    The <policy> element
+     *
+     * @return  true = rules added successfully, false = invalid policy element
+     */
+    bool AddPolicy(const qcc::XmlElement& policy);
+
     /**
      * Indicates if eavesdropping was enabled on any rule.
      *
@@ -222,6 +265,20 @@ class _PolicyDB {
 
     typedef std::hash_set<uint32_t> BusNameIDSet;
 
+    static const uint32_t FIRST_NAME_SET_ID = 0x80000000;  /**< first id assigned to a unique name's bus name set */
+
+    /**
+     * Header fields that send or receive rules match on in addition to the
+     * interface, member and message type.  Fields no rule refers to are left
+     * out of the decision cache key so more messages share a decision.
+     */
+    static const uint32_t KEY_PATH = 0x1;   /**< some rule matches on object path */
+    static const uint32_t KEY_ERROR = 0x2;  /**< some rule matches on error name */
+    static const uint32_t KEY_NAMES = 0x4;  /**< some rule matches on sender or destination bus name */
+
+    /** Maximum number of cached routing decisions before the cache is discarded */
+    static const size_t MAX_CACHED_DECISIONS = 4096;
+
     /**
      * Container for all the matching criteria for a rule.
      */
@@ -369,7 +426,7 @@ class _PolicyDB {
          */
         inline bool CheckUser(uint32_t other) const
         {
-            return (!userSet || (user == other));
+            return (!userSet || ((user == other) && (other != NO_IDENTITY)));
         }
 
         /**
@@ -381,7 +438,7 @@ class _PolicyDB {
          */
         inline bool CheckGroup(uint32_t other) const
         {
-            return (!groupSet || (group == other));
+            return (!groupSet || ((group == other) && (other != NO_IDENTITY)));
         }
 
         /**
@@ -423,8 +480,66 @@ class _PolicyDB {
     /** typedef for mapping a string to a numerical value for normalization */
     typedef std::hash_map<qcc::StringMapKey, uint32_t> StringIDMap;
 
+    /**
+     * The normalized well known bus names owned by a unique name along with
+     * an id identifying this particular set for the decision cache.
+     */
+    struct UniqueNameEntry {
+        BusNameIDSet names;     /**< set of normalized well known bus names */
+        uint32_t setID;         /**< id of the set, changes whenever the set changes */
+    };
+
     /** typedef for mapping a unique bus name to a set of normalized well known bus names */
-    typedef std::hash_map<qcc::StringMapKey, BusNameIDSet> UniqueNameIDMap;
+    typedef std::hash_map<qcc::StringMapKey, UniqueNameEntry> UniqueNameIDMap;
+
+    /**
+     * Key for the routing decision cache.
+     */
+    struct DecisionKey {
+        uint32_t suid;          /**< sender user id */
+        uint32_t sgid;          /**< sender group id */
+        uint32_t duid;          /**< destination user id */
+        uint32_t dgid;          /**< destination group id */
+        uint32_t ifcID;         /**< normalized interface name */
+        uint32_t memberID;      /**< normalized member name */
+        uint32_t pathID;        /**< normalized object path or WILDCARD if no rule matches on paths */
+        uint32_t errorID;       /**< normalized error name or WILDCARD if no rule matches on errors */
+        uint32_t senderNames;   /**< id of the sender's bus name set or WILDCARD if no rule matches on names */
+        uint32_t destNames;     /**< id of the destination's bus name set or WILDCARD if no rule matches on names */
+        uint32_t type;          /**< message type */
+
+        bool operator==(const DecisionKey& other) const
+        {
+            return (memberID == other.memberID) && (ifcID == other.ifcID) && (suid == other.suid) &&
+                   (duid == other.duid) && (sgid == other.sgid) && (dgid == other.dgid) &&
+                   (pathID == other.pathID) && (errorID == other.errorID) &&
+                   (senderNames == other.senderNames) && (destNames == other.destNames) &&
+                   (type == other.type);
+        }
+    };
+
+    /**
+     * Hash functor for DecisionKey.
+     */
+    struct DecisionKeyHash {
+        size_t operator()(const DecisionKey& k) const
+        {
+            size_t h = k.memberID;
+            h = h * 31 + k.ifcID;
+            h = h * 31 + k.suid;
+            h = h * 31 + k.duid;
+            h = h * 31 + k.sgid;
+            h = h * 31 + k.dgid;
+            h = h * 31 + k.pathID;
+            h = h * 31 + k.errorID;
+            h = h * 31 + k.senderNames;
+            h = h * 31 + k.destNames;
+            return h * 31 + k.type;
+        }
+    };
+
+    /** typedef for the routing decision cache */
+    typedef std::hash_map<DecisionKey, bool, DecisionKeyHash> DecisionCache;
 
     /**
      * Adds rules to specific rule sets.  Called by public AddRule to add
@@ -517,6 +632,29 @@ class _PolicyDB {
                       const BusNameIDSet& bnIDSet,
                       bool eavesdrop) const;
 
+    /**
+     * Get the id of the set of normalized bus names for a bus name.  Must
+     * be called with bnLock held.
+     *
+     * @param bnStr     String with either the well known or unique bus name
+     *
+     * @return  The normalized well known name or the id of the unique name's
+     *          set of normalized well known bus names.
+     */
+    uint32_t LookupBusNameSetID(const char* bnStr) const;
+
+    /**
+     * Discard all cached routing decisions.
+     */
+    void FlushDecisionCache();
+
+    /**
+     * Record which header fields a send or receive rule matches on.
+     *
+     * @param rule  The rule being added.
+     */
+    void UpdateKeyFields(const PolicyRule& rule);
+
     bool eavesdrop;     /**< indicated if there is a rule specifying eavesdropping */
 
     PolicyRuleListSet ownRS;        /**< bus name ownership policy rule sets */
@@ -528,6 +666,11 @@ class _PolicyDB {
     UniqueNameIDMap uniqueNameMap;  /**< mapping of unique bus names to normalized well known bus names */
     StringIDMap busNameMap;         /**< mapping of well known bus names to normalization IDs */
     mutable qcc::Mutex bnLock;      /**< mutex protecting access to uniqueNameMap and busNameMap when normalizing unique names to list of normalized well known bus names. */
+    uint32_t nextSetID;             /**< next id to assign to a unique name's set of bus names */
+
+    uint32_t keyFields;             /**< KEY_* flags for the header fields rules match on */
+    mutable DecisionCache decisionCache;    /**< cached routing decisions */
+    mutable qcc::Mutex cacheLock;           /**< mutex protecting decisionCache */
 
     friend class ajn::NormalizedMsgHdr;
 };
@@ -545,19 +688,19 @@ class NormalizedMsgHdr {
      * based on information in the policy rules for very fast lookup.
      *
      * @param msg       Reference to the message to be normalized
-     * @param policy    Pointer to the PolicyDB
+     * @param policy    Reference to the policy database
      */
-    NormalizedMsgHdr(const ajn::Message& msg, const PolicyDB& policy) :
-        ifcID(policy->LookupStringID(msg->GetInterface())),
-        memberID(policy->LookupStringID(msg->GetMemberName())),
-        errorID(policy->LookupStringID(msg->GetErrorName())),
-        pathID(policy->LookupStringID(msg->GetObjectPath())),
+    NormalizedMsgHdr(const ajn::Message& msg, const _PolicyDB& policy) :
+        ifcID(policy.LookupStringID(msg->GetInterface())),
+        memberID(policy.LookupStringID(msg->GetMemberName())),
+        errorID(policy.LookupStringID(msg->GetErrorName())),
+        pathID(policy.LookupStringID(msg->GetObjectPath())),
         type(msg->GetType())
     {
-        policy->bnLock.Lock(MUTEX_CONTEXT);
+        policy.bnLock.Lock(MUTEX_CONTEXT);
         InitBusNameID(policy, msg->GetSender(), senderIDList);
         InitBusNameID(policy, msg->GetDestination(), destIDList);
-        policy->bnLock.Unlock(MUTEX_CONTEXT);
+        policy.bnLock.Unlock(MUTEX_CONTEXT);
     }
 
   private:
@@ -570,21 +713,21 @@ class NormalizedMsgHdr {
      * name is a unique name, the the list will be for all well known
      * names assocated with that unique bus name.
      *
-     * @param policy    Pointer to the PolicyDB
+     * @param policy    Reference to the policy database
      * @param bnStr     String with either the well known or unique bus name
      * @param bnIDSet   The normalized bus name set being filled.
      */
-    static inline void InitBusNameID(const PolicyDB& policy,
+    static inline void InitBusNameID(const _PolicyDB& policy,
                                      const char* bnStr,
                                      _PolicyDB::BusNameIDSet& bnIDSet)
     {
         if (bnStr && (bnStr[0] == ':')) {
-            _PolicyDB::UniqueNameIDMap::const_iterator unit(policy->uniqueNameMap.find(bnStr));
-            if (unit != policy->uniqueNameMap.end()) {
-                bnIDSet.insert(unit->second.begin(), unit->second.end());
+            _PolicyDB::UniqueNameIDMap::const_iterator unit(policy.uniqueNameMap.find(bnStr));
+            if (unit != policy.uniqueNameMap.end()) {
+                bnIDSet.insert(unit->second.names.begin(), unit->second.names.end());
             }
         } else {
-            bnIDSet.insert(policy->LookupStringID(bnStr));
+            bnIDSet.insert(policy.LookupStringID(bnStr));
         }
     }
 
@@ -42,6 +42,7 @@
 #include "RendezvousServerInterface.h"
 #include "PacketEngine.h"
 #include "STUNSocketStream.h"
+#include "StunMessageView.h"
 
 #ifdef QCC_OS_GROUP_POSIX
 #include "posix/ICEPacketStream.h"
@@ -410,6 +411,7 @@ void* DaemonICEEndpoint::AuthThread::Run(void* arg)
     /* Initialized the features for this endpoint */
     conn->GetFeatures().isBusToBus = false;
     conn->GetFeatures().handlePassing = false;
+    conn->GetFeatures().bodyCompression = true;
 
     /* Run the actual connection authentication code. */
     qcc::String authName;
@@ -995,38 +997,32 @@ void DaemonICETransport::SendSTUNKeepAliveAndTURNRefreshRequest(ICEPacketStream&
 
     QStatus status = ER_OK;
 
-    ScatterGatherList rMsgSG;
-    uint8_t* rBuf;
-    uint8_t* rPos;
-    size_t rBufSize;
-    size_t expectedSent = 0;
-
-    /* Send NAT keep-alive */
-    StunMessage msg(STUN_MSG_INDICATION_CLASS, STUN_MSG_BINDING_METHOD,
-                    reinterpret_cast<const uint8_t*>(icePktStream.GetHmacKey().c_str()), icePktStream.GetHmacKey().size());
+    /* Send NAT keep-alive, a Binding indication without attributes */
+    uint8_t kaBuf[StunMessage::MIN_MSG_SIZE];
+    StunTransactionID tid;
+    tid.SetValue();
+    StunMessageBuilder msg(kaBuf, sizeof(kaBuf), STUN_MSG_INDICATION_CLASS, STUN_MSG_BINDING_METHOD, tid);
 
     PacketDest dest = icePktStream.GetICEDestination();
 
-    rBufSize = msg.RenderSize();
-    rBuf = new uint8_t[rBufSize];
-    rPos = rBuf;
-
-    expectedSent = msg.Size();
-
-    status = msg.RenderBinary(rPos, rBufSize, rMsgSG);
+    status = msg.Finish(NULL, 0, false);
     if (status == ER_OK) {
-        status = icePktStream.PushPacketBytes((const void*)rBuf, expectedSent, dest, true);
+        status = icePktStream.PushPacketBytes(msg.GetBuffer(), msg.Size(), dest, true);
     }
     if (status != ER_OK) {
         QCC_LogError(ER_FAIL, ("Failed to send NAT keep alive for icePktStream=%p", &icePktStream));
     }
-    delete[] rBuf;
 
     /* Send TURN refresh (if needed) at slower interval */
     if (icePktStream.GetCandidateType() == _ICECandidate::Relayed_Candidate) {
         if ((GetTimestamp64() - icePktStream.GetTurnRefreshTimestamp()) >= icePktStream.GetTurnRefreshPeriod()) {
             /* Send TURN refresh */
             String hmacKey = icePktStream.GetHmacKey();
+            ScatterGatherList rMsgSG;
+            uint8_t* rBuf;
+            uint8_t* rPos;
+            size_t rBufSize;
+            size_t expectedSent;
             StunMessage refreshMsg(STUN_MSG_REQUEST_CLASS, STUN_MSG_REFRESH_METHOD, reinterpret_cast<const uint8_t*>(hmacKey.c_str()), hmacKey.size());
 
             refreshMsg.AddAttribute(new StunAttributeSoftware("AllJoyn " + String(GetVersion())));
@@ -1998,6 +1994,7 @@ QStatus DaemonICETransport::Connect(const char* connectSpec, const SessionOpts&
             conn->GetFeatures().isBusToBus = true;
             conn->GetFeatures().allowRemote = m_bus.GetInternal().AllowRemoteMessages();
             conn->GetFeatures().handlePassing = false;
+            conn->GetFeatures().bodyCompression = true;
 
             String authName;
             String redirection;
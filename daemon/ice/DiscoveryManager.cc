@@ -108,6 +108,8 @@ DiscoveryManager::DiscoveryManager(BusAttachment& bus)
     PersistentMessageSentTimeStamp(0),
     OnDemandMessageSentTimeStamp(0),
     SentMessageOverOnDemandConnection(false),
+    MinSendInterval(MIN_SEND_INTERVAL_DEFAULT),
+    QueuedMessageSentTimeStamp(0),
     LastSentUpdateMessage(INVALID_MESSAGE),
     SCRAMAuthModule(),
     ProximityScanner(NULL),
@@ -133,6 +135,7 @@ DiscoveryManager::DiscoveryManager(BusAttachment& bus)
     //       <property WiFiPrefix="wlan"/>
     //       <property MobileNwPrefix="ppp"/>
     //       <property Protocol="HTTP"/>
+    //       <property min_send_interval="250"/>
     //     </ice_discovery_manager>
     //   </busconfig>
     //
@@ -153,6 +156,9 @@ DiscoveryManager::DiscoveryManager(BusAttachment& bus)
     wifiInterfaceName = config->Get("ice_discovery_manager/property@WiFiPrefix", "wlan");
     mobileNwInterfaceName = config->Get("ice_discovery_manager/property@MobileNwPrefix", "ppp");
 
+    /* Retrieve the minimum interval between messages sent to the Rendezvous Server */
+    MinSendInterval = config->Get("ice_discovery_manager/property@min_send_interval", MIN_SEND_INTERVAL_DEFAULT);
+
     QCC_DbgPrintf(("DiscoveryManager::DiscoveryManager(): RendezvousServer = %s\n", RendezvousServer.c_str()));
 
     /* Compose the GET message and the Rendezvous Session Delete messages */
@@ -1155,7 +1161,10 @@ void* DiscoveryManager::Run(void* arg)
                                     // If we have messages to send and we have a connection set up with the
                                     // Rendezvous Server, then send the messages.
                                     //
-                                    if (OutboundMessageQueue.size()) {
+                                    // Messages queued while the minimum send interval runs are coalesced so only the
+                                    // latest information is sent when it expires.
+                                    //
+                                    if (OutboundMessageQueue.size() && (GetSendDelay() == 0)) {
 
                                         QCC_DbgPrintf(("DiscoveryManager::Run(): Messages about to be sent to Rendezvous Server\n"));
 
@@ -1184,6 +1193,7 @@ void* DiscoveryManager::Run(void* arg)
                                                 // So we can discard it.
                                                 //
                                                 OutboundMessageQueue.pop_front();
+                                                QueuedMessageSentTimeStamp = GetTimestamp();
                                             }
                                         } else {
                                             //
@@ -1299,8 +1309,25 @@ void* DiscoveryManager::Run(void* arg)
             waitTimeout = Event::WAIT_FOREVER;
         }
 
+        /* Wake up when the minimum send interval expires if we are holding back queued messages */
+        bool waitForSendInterval = false;
+        if (Connection && !SentMessageOverOnDemandConnection) {
+            DiscoveryManagerMutex.Lock(MUTEX_CONTEXT);
+            uint32_t sendDelay = OutboundMessageQueue.empty() ? Event::WAIT_FOREVER : GetSendDelay();
+            DiscoveryManagerMutex.Unlock(MUTEX_CONTEXT);
+            if (sendDelay < waitTimeout) {
+                waitTimeout = sendDelay;
+                waitForSendInterval = true;
+            }
+        }
+
         status = Event::Wait(checkEvents, signaledEvents, waitTimeout);
 
+        if ((status == ER_TIMEOUT) && waitForSendInterval) {
+            /* The minimum send interval expired, go back and send the queued messages */
+            status = ER_OK;
+        }
+
         if (status != ER_OK) {
 
             QCC_DbgPrintf(("DiscoveryManager::Run(): Wait failed or timed out: waitTimeout = %d, status = %s \n", waitTimeout, QCC_StatusText(status)));
@@ -1443,12 +1470,104 @@ void DiscoveryManager::QueueMessage(RendezvousMessage message)
 
     if (message.messageType != INVALID_MESSAGE) {
 
-        OutboundMessageQueue.push_back(message);
+        if (CoalesceMessage(OutboundMessageQueue, message)) {
+            QCC_DbgPrintf(("DiscoveryManager::QueueMessage: Replaced a queued %s message\n", (PrintMessageType(message.messageType)).c_str()));
+        }
         QCC_DbgPrintf(("DiscoveryManager::QueueMessage: Set the wake event\n"));
         WakeEvent.SetEvent();
     }
 }
 
+void DiscoveryManager::DeleteInterfaceMessage(RendezvousMessage& message)
+{
+    switch (message.messageType) {
+    case ADVERTISEMENT:
+        delete static_cast<AdvertiseMessage*>(message.interfaceMessage);
+        break;
+
+    case SEARCH:
+        delete static_cast<SearchMessage*>(message.interfaceMessage);
+        break;
+
+    case PROXIMITY:
+        delete static_cast<ProximityMessage*>(message.interfaceMessage);
+        break;
+
+    case ADDRESS_CANDIDATES:
+        delete static_cast<ICECandidatesMessage*>(message.interfaceMessage);
+        break;
+
+    default:
+        delete message.interfaceMessage;
+        break;
+    }
+    message.interfaceMessage = NULL;
+}
+
+bool DiscoveryManager::CoalesceMessage(list<RendezvousMessage>& queue, RendezvousMessage& message)
+{
+    for (list<RendezvousMessage>::iterator it = queue.begin(); it != queue.end(); ++it) {
+        if (it->messageType != message.messageType) {
+            continue;
+        }
+
+        bool supersedes = false;
+
+        switch (message.messageType) {
+        case ADVERTISEMENT:
+        case SEARCH:
+        case PROXIMITY:
+            /* These carry the complete current list which replaces whatever was queued before */
+            supersedes = true;
+            break;
+
+        case ADDRESS_CANDIDATES:
+        {
+            /* Candidates for different sessions must all be delivered, even between the same pair of daemons */
+            ICECandidatesMessage* newer = static_cast<ICECandidatesMessage*>(message.interfaceMessage);
+            ICECandidatesMessage* older = static_cast<ICECandidatesMessage*>(it->interfaceMessage);
+            supersedes = newer && older &&
+                         (newer->source == older->source) &&
+                         (newer->destination == older->destination) &&
+                         (newer->destinationPeerID == older->destinationPeerID) &&
+                         (newer->ice_ufrag == older->ice_ufrag);
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        if (supersedes) {
+            DeleteInterfaceMessage(*it);
+            *it = message;
+            return true;
+        }
+    }
+
+    queue.push_back(message);
+    return false;
+}
+
+uint32_t DiscoveryManager::GetSendDelay(void)
+{
+    return GetSendDelay(QueuedMessageSentTimeStamp, GetTimestamp(), MinSendInterval);
+}
+
+uint32_t DiscoveryManager::GetSendDelay(uint32_t sentTimeStamp, uint32_t now, uint32_t minSendInterval)
+{
+    uint32_t delay = 0;
+
+    if (sentTimeStamp) {
+        uint32_t elapsed = now - sentTimeStamp;
+        if (elapsed < minSendInterval) {
+            delay = minSendInterval - elapsed;
+        }
+    }
+
+    return delay;
+}
+
 void DiscoveryManager::PurgeOutboundMessageQueue(MessageType messageType)
 {
     QCC_DbgPrintf(("DiscoveryManager::PurgeOutboundMessageQueue(): OutboundMessageQueue.size() = %d", OutboundMessageQueue.size()));
@@ -1881,7 +2000,7 @@ void DiscoveryManager::PurgeFindAndNameMap(String peerAddress)
     }
 }
 
-QStatus DiscoveryManager::HandlePersistentMessageResponse(Json::Value payload)
+QStatus DiscoveryManager::HandlePersistentMessageResponse(const String& payload)
 {
     QCC_DbgPrintf(("DiscoveryManager::HandlePersistentMessageResponse()\n"));
     QStatus status = ER_OK;
@@ -2246,7 +2365,7 @@ QStatus DiscoveryManager::UpdateInformationOnServer(MessageType messageType, boo
     return status;
 }
 
-QStatus DiscoveryManager::HandleOnDemandMessageResponse(Json::Value payload)
+QStatus DiscoveryManager::HandleOnDemandMessageResponse(const String& payload)
 {
     QStatus status = ER_OK;
 
@@ -2597,7 +2716,7 @@ void DiscoveryManager::HandleSuccessfulClientAuthentication(ClientLoginFinalResp
     SetTKeepAlive(response.configData.Tkeepalive);
 }
 
-QStatus DiscoveryManager::HandleClientLoginResponse(Json::Value payload)
+QStatus DiscoveryManager::HandleClientLoginResponse(const String& payload)
 {
     QStatus status = ER_OK;
 
@@ -2665,7 +2784,7 @@ QStatus DiscoveryManager::HandleClientLoginResponse(Json::Value payload)
     return status;
 }
 
-QStatus DiscoveryManager::HandleTokenRefreshResponse(Json::Value payload)
+QStatus DiscoveryManager::HandleTokenRefreshResponse(const String& payload)
 {
     QStatus status = ER_OK;
 
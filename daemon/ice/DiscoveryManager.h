@@ -482,7 +482,7 @@ class DiscoveryManager : public Thread, public AlarmListener {
      *
      * Ensure that the function invoking this function locks the DiscoveryManagerMutex.
      */
-    QStatus HandleOnDemandMessageResponse(Json::Value payload);
+    QStatus HandleOnDemandMessageResponse(const String& payload);
 
     /**
      * @internal
@@ -540,7 +540,7 @@ class DiscoveryManager : public Thread, public AlarmListener {
      *
      * Ensure that the function invoking this function locks the DiscoveryManagerMutex.
      */
-    QStatus HandleClientLoginResponse(Json::Value payload);
+    QStatus HandleClientLoginResponse(const String& payload);
 
     /**
      * @internal
@@ -548,7 +548,7 @@ class DiscoveryManager : public Thread, public AlarmListener {
      *
      * Ensure that the function invoking this function locks the DiscoveryManagerMutex.
      */
-    QStatus HandleTokenRefreshResponse(Json::Value payload);
+    QStatus HandleTokenRefreshResponse(const String& payload);
 
     /**
      * Main thread entry point.
@@ -565,12 +565,54 @@ class DiscoveryManager : public Thread, public AlarmListener {
      */
     void QueueMessage(RendezvousMessage message);
 
+    /**
+     * @internal
+     * @brief Add a message to a queue of messages waiting to be sent to the Rendezvous Server.
+     *
+     * Advertisement, Search and Proximity messages carry the complete current list so a newer
+     * one replaces a queued message of the same type in its place in the queue. An Address
+     * Candidates message replaces a queued one for the same ICE session. Any other message is
+     * appended to the queue.
+     *
+     * @param queue    The queue.
+     * @param message  The message, the queue takes ownership of its interfaceMessage.
+     *
+     * @return  true if the message replaced a queued message.
+     */
+    static bool CoalesceMessage(list<RendezvousMessage>& queue, RendezvousMessage& message);
+
+    /**
+     * @internal
+     * @brief Free the interfaceMessage of a message through its actual type.
+     */
+    static void DeleteInterfaceMessage(RendezvousMessage& message);
+
     /**
      * @internal
      * @brief Purge the OutboundMessageQueue to remove messages of the specified message type.
      */
     void PurgeOutboundMessageQueue(MessageType messageType);
 
+    /**
+     * @internal
+     * @brief Get the time in milliseconds until the next message in the OutboundMessageQueue may be
+     * sent without violating the minimum send interval.
+     *
+     * Ensure that the function invoking this function locks the DiscoveryManagerMutex.
+     */
+    uint32_t GetSendDelay(void);
+
+    /**
+     * @internal
+     * @brief Get the time in milliseconds until a message may be sent without violating the
+     * minimum send interval.
+     *
+     * @param sentTimeStamp    Time the last message was sent, 0 if none has been sent.
+     * @param now              Current time.
+     * @param minSendInterval  Minimum time between messages.
+     */
+    static uint32_t GetSendDelay(uint32_t sentTimeStamp, uint32_t now, uint32_t minSendInterval);
+
     /**
      * @internal
      * @brief Send a message to the Rendezvous Server.
@@ -613,7 +655,7 @@ class DiscoveryManager : public Thread, public AlarmListener {
      * @internal
      * @brief Handle the response received over the Persistent connection.
      */
-    QStatus HandlePersistentMessageResponse(Json::Value payload);
+    QStatus HandlePersistentMessageResponse(const String& payload);
 
     /**
      * @internal
@@ -735,6 +777,12 @@ class DiscoveryManager : public Thread, public AlarmListener {
     /*PPN - Review duration*/
     static const uint32_t INTERFACE_UPDATE_MIN_INTERVAL = 300000;
 
+    /**
+     * Default minimum time between messages sent from the OutboundMessageQueue. Updates queued
+     * in the meantime are coalesced. Units are milli seconds.
+     */
+    static const uint32_t MIN_SEND_INTERVAL_DEFAULT = 250;
+
     /**
      * The max number of times that a message is resent to the Rendezvous error on the
      * receipt of an error in the response.
@@ -1114,6 +1162,18 @@ class DiscoveryManager : public Thread, public AlarmListener {
      */
     bool SentMessageOverOnDemandConnection;
 
+    /**
+     * @internal
+     * @brief Minimum time in milli seconds between messages sent from the OutboundMessageQueue
+     */
+    uint32_t MinSendInterval;
+
+    /**
+     * @internal
+     * @brief Time stamp captured when the last message from the OutboundMessageQueue was sent
+     */
+    uint32_t QueuedMessageSentTimeStamp;
+
     /**
      * @internal
      * @brief Indicates the last message type (Advertisement/Search/Proximity) that was
@@ -31,9 +31,9 @@
 #include <qcc/String.h>
 #include <qcc/Stream.h>
 #include <qcc/StringUtil.h>
-#include <JSON/json.h>
 #include "Status.h"
 #include "HttpConnection.h"
+#include "JsonPullParser.h"
 
 using namespace std;
 using namespace qcc;
@@ -371,16 +371,15 @@ QStatus HttpConnection::ParseResponse(HTTPResponse& response)
                             status = httpSource.PullBytes(buf, reqBytes, actual);
 
                             if ((ER_OK == status) && (httpSource.GetContentLength() == actual)) {
-                                string responseStr = string(buf);
-
-                                // Parse the payload using the JSON parser only of the HTTP status code received is
-                                // HTTP_STATUS_OK.
+                                // Keep the payload only if the HTTP status code received is HTTP_STATUS_OK. The
+                                // payload is checked here without building a document; the handlers decode it
+                                // later with their own JsonPullParser.
                                 if (httpStatus == HTTP_STATUS_OK) {
-                                    Json::Reader reader;
-                                    if (!reader.parse(responseStr, response.payload)) {
+                                    if (ajn::JsonPullParser(buf, actual).SkipToEnd() != ER_OK) {
                                         status = ER_FAIL;
                                         QCC_LogError(status, ("HttpConnection::ParseResponse(): JSON payload parsing failed"));
                                     } else {
+                                        response.payload = String(buf, actual);
                                         response.payloadPresent = true;
                                     }
                                 }
@@ -388,6 +387,8 @@ QStatus HttpConnection::ParseResponse(HTTPResponse& response)
                                 status = ER_FAIL;
                                 QCC_LogError(status, ("HttpConnection::ParseResponse(): Payload parsing failed"));
                             }
+
+                            free(buf);
                         } else {
                             QCC_DbgPrintf(("HttpConnection::ParseResponse(): Received a response with no payload"));
                         }
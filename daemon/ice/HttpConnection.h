@@ -30,7 +30,7 @@
 #include <qcc/Socket.h>
 #include <qcc/SocketStream.h>
 #include <qcc/Event.h>
-#include <JSON/json.h>
+#include <qcc/String.h>
 #include "Status.h"
 
 using namespace qcc;
@@ -200,8 +200,8 @@ class HttpConnection {
         /* If set to true, valid payload is present */
         bool payloadPresent;
 
-        /* Received payload */
-        Json::Value payload;
+        /* Received payload, the JSON text of the response body */
+        String payload;
 
         HTTPResponse() : payloadPresent(false) { }
     };
@@ -28,6 +28,7 @@
 #include <StunActivity.h>
 #include <Component.h>
 #include <StunAttribute.h>
+#include <StunMessageView.h>
 #include <ICESession.h>
 
 #include <map>
@@ -262,7 +263,8 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
     IPEndpoint remote;
     bool receivedMsgWasRelayed;
 
-    StunMessage::const_iterator stunAttrIt;
+    StunMessageView msg;
+    uint8_t* msgBuf = NULL;
     StunTransactionID requestTransID;
     bool ICEcontrollingRequest = false;
     bool useCandidateRequest = false;
@@ -270,16 +272,7 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
     uint32_t requestPriority = 0;
     StunTransactionID tid;
 
-    ICESession* session = component->GetICEStream()->GetSession();
-    session->Lock();
-
-    StunMessage msg(session->GetRemoteInitiatedCheckUsername(),
-                    session->GetRemoteInitiatedCheckHmacKey(),
-                    session->GetRemoteInitiatedCheckHmacKeyLength());
-
-    session->Unlock();
-
-    status = stunActivity->stun->RecvStunMessage(msg, remote.addr, remote.port, receivedMsgWasRelayed, timeoutMsec);
+    status = stunActivity->stun->RecvStunMessage(msg, msgBuf, remote.addr, remote.port, receivedMsgWasRelayed, timeoutMsec);
 
     if (status != ER_OK) {
         if (status != ER_STOPPING_THREAD) {
@@ -289,7 +282,7 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
     }
 #if !defined(NDEBUG)
     QCC_DbgPrintf(("ReadRxMsg status=%d, class=%s,  base %s:%d %s from %s:%d",
-                   status, msg.MessageClassToString(msg.GetTypeClass()).c_str(),
+                   status, StunMessage::MessageClassToString(msg.GetTypeClass()).c_str(),
                    base.addr.ToString().c_str(), base.port,
                    receivedMsgWasRelayed ? "relayed" : "",
                    remote.addr.ToString().c_str(), remote.port));
@@ -312,7 +305,7 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
         if (msg.GetTypeClass() == STUN_MSG_RESPONSE_CLASS) {
             QCC_DbgPrintf(("TID: %s, Check Response matches", tid.ToString().c_str()));
         } else {
-            QCC_DbgPrintf(("TID: %s, Expected STUN Response to check but got %s with matching tid instead", tid.ToString().c_str(), msg.MessageClassToString(msg.GetTypeClass()).c_str()));
+            QCC_DbgPrintf(("TID: %s, Expected STUN Response to check but got %s with matching tid instead", tid.ToString().c_str(), StunMessage::MessageClassToString(msg.GetTypeClass()).c_str()));
             checkRetry = NULL;
         }
     }
@@ -322,15 +315,15 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
     Retransmit* retransmit = component->GetRetransmitByTransaction(tid);
     if (NULL != retransmit) {
         if ((msg.GetTypeClass() == STUN_MSG_RESPONSE_CLASS) || (msg.GetTypeClass() == STUN_MSG_ERROR_CLASS)) {
-            QCC_DbgPrintf(("TID: %s, Found matching NonCheck %s", tid.ToString().c_str(), msg.MessageClassToString(msg.GetTypeClass()).c_str()));
+            QCC_DbgPrintf(("TID: %s, Found matching NonCheck %s", tid.ToString().c_str(), StunMessage::MessageClassToString(msg.GetTypeClass()).c_str()));
         } else {
-            QCC_DbgPrintf(("TID: %s, Expected STUN Response to nonCheck but got %s with matching tid instead", tid.ToString().c_str(), msg.MessageClassToString(msg.GetTypeClass()).c_str()));
+            QCC_DbgPrintf(("TID: %s, Expected STUN Response to nonCheck but got %s with matching tid instead", tid.ToString().c_str(), StunMessage::MessageClassToString(msg.GetTypeClass()).c_str()));
             retransmit = NULL;
         }
     }
 
     if (NULL == checkRetry && NULL == retransmit) {
-        QCC_DbgPrintf(("TID: %s, Unknown %s", tid.ToString().c_str(), msg.MessageClassToString(msg.GetTypeClass()).c_str()));
+        QCC_DbgPrintf(("TID: %s, Unknown %s", tid.ToString().c_str(), StunMessage::MessageClassToString(msg.GetTypeClass()).c_str()));
     }
 
     ICECandidate relayedCandidate;
@@ -338,20 +331,22 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
     IPEndpoint relayed;
     uint32_t grantedAllocationLifetimeSecs = 0;
 
-    // iterate thru message looking for attributes
-    for (stunAttrIt = msg.Begin(); stunAttrIt != msg.End(); ++stunAttrIt) {
-        switch ((*stunAttrIt)->GetType()) {
-        case STUN_ATTR_XOR_MAPPED_ADDRESS: {
-            const StunAttributeXorMappedAddress& sa = *reinterpret_cast<StunAttributeXorMappedAddress*>(*stunAttrIt);
+    // iterate thru message looking for attributes, malformed ones are skipped
+    for (size_t i = 0; i < msg.GetAttributeCount(); ++i) {
+        const StunMessageView::Attribute& attr = msg.GetAttribute(i);
 
+        switch (attr.type) {
+        case STUN_ATTR_XOR_MAPPED_ADDRESS: {
             IPEndpoint base;
             stunActivity->stun->GetLocalAddress(base.addr, base.port);
 
             // Should only appear in a response to our earlier (outbound) check.
             // To later determine peer-reflexive candidate...
-            sa.GetAddress(mappedAddress.addr, mappedAddress.port);
-
-            sa.GetAddress(reflexive.addr, reflexive.port);
+            if (msg.GetXorAddress(attr, reflexive.addr, reflexive.port) != ER_OK) {
+                QCC_DbgRemoteError(("Malformed XOR-MAPPED-ADDRESS"));
+                break;
+            }
+            mappedAddress = reflexive;
 
             if (ICESession::ICEGatheringCandidates ==
                 component->GetICEStream()->GetSession()->GetState()) {
@@ -400,11 +395,12 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
         }
 
         case STUN_ATTR_XOR_RELAYED_ADDRESS: {
-            const StunAttributeXorRelayedAddress& sa = *reinterpret_cast<StunAttributeXorRelayedAddress*>(*stunAttrIt);
-
             IPEndpoint host;
             stunActivity->stun->GetLocalAddress(host.addr, host.port);
-            sa.GetAddress(relayed.addr, relayed.port);
+            if (msg.GetXorAddress(attr, relayed.addr, relayed.port) != ER_OK) {
+                QCC_DbgRemoteError(("Malformed XOR-RELAYED-ADDRESS"));
+                break;
+            }
 
             if (ICESession::ICEGatheringCandidates ==
                 component->GetICEStream()->GetSession()->GetState()) {
@@ -459,8 +455,10 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
         }
 
         case STUN_ATTR_LIFETIME: {
-            const StunAttributeLifetime& sa = *reinterpret_cast<StunAttributeLifetime*>(*stunAttrIt);
-            grantedAllocationLifetimeSecs = sa.GetLifetime();
+            if (StunMessageView::GetUInt32(attr, grantedAllocationLifetimeSecs) != ER_OK) {
+                QCC_DbgRemoteError(("Malformed LIFETIME"));
+                break;
+            }
             if (relayedCandidate->GetType() == _ICECandidate::Relayed_Candidate) {
                 relayedCandidate->SetAllocationLifetimeSeconds(grantedAllocationLifetimeSecs);
             }
@@ -469,8 +467,9 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
         }
 
         case STUN_ATTR_PRIORITY: {
-            const StunAttributePriority& sa = *reinterpret_cast<StunAttributePriority*>(*stunAttrIt);
-            requestPriority = sa.GetPriority();
+            if (StunMessageView::GetUInt32(attr, requestPriority) != ER_OK) {
+                QCC_DbgRemoteError(("Malformed PRIORITY"));
+            }
             break;
         }
 
@@ -479,14 +478,12 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
             break;
 
         case STUN_ATTR_ICE_CONTROLLING: {
-            //const StunAttributeIceControlling& sa = *reinterpret_cast<StunAttributeIceControlling*>(*stunAttrIt);
             ICEcontrollingRequest = true;
             //controlTieBreaker = sa.GetValue();
             break;
         }
 
         case STUN_ATTR_ICE_CONTROLLED: {
-            //const StunAttributeIceControlled& sa = *reinterpret_cast<StunAttributeIceControlled*>(*stunAttrIt);
             ICEcontrollingRequest = false;
             //controlTieBreaker = sa.GetValue();
             break;
@@ -494,10 +491,11 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
 
 
         case STUN_ATTR_ERROR_CODE: {
-            const StunAttributeErrorCode& sa = *reinterpret_cast<StunAttributeErrorCode*>(*stunAttrIt);
             StunErrorCodes error;
-            String reason;
-            sa.GetError(error, reason);
+            if (StunMessageView::GetErrorCode(attr, error) != ER_OK) {
+                QCC_DbgRemoteError(("Malformed ERROR-CODE"));
+                break;
+            }
 
             if (NULL != retransmit) {
                 retransmit->SetState(Retransmit::ReceivedErrorResponse);
@@ -538,11 +536,9 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
             break;
         }
 
-        case STUN_ATTR_USERNAME: {
-            const StunAttributeUsername& sa = *reinterpret_cast<StunAttributeUsername*>(*stunAttrIt);
-            sa.GetUsername(username);
+        case STUN_ATTR_USERNAME:
+            StunMessageView::GetString(attr, username);
             break;
-        }
 
         default:
             break;
@@ -772,6 +768,7 @@ QStatus _ICECandidate::ReadReceivedMessage(uint32_t timeoutMsec)
 
 exit:
     component->GetICEStream()->GetSession()->Unlock();
+    delete[] msgBuf;
 
     return status;
 }
@@ -790,35 +787,35 @@ QStatus _ICECandidate::SendResponse(uint16_t checkStatus, IPEndpoint& dest,
                                     bool usingTurn, StunTransactionID tid)
 {
     QStatus status = ER_OK;
-    StunMessage*msg = NULL;
-
-    if (checkStatus == ICECandidatePair::CheckRoleConflict) {
-        msg = new StunMessage(STUN_MSG_ERROR_CLASS,
-                              STUN_MSG_BINDING_METHOD,
-                              component->GetICEStream()->GetSession()->GetRemoteInitiatedCheckHmacKey(),
-                              component->GetICEStream()->GetSession()->GetRemoteInitiatedCheckHmacKeyLength(), tid);
-        msg->AddAttribute(new StunAttributeErrorCode(STUN_ERR_CODE_ROLE_CONFLICT, "Role Conflict"));
-    } else {
-        msg = new StunMessage(STUN_MSG_RESPONSE_CLASS,
-                              STUN_MSG_BINDING_METHOD,
-                              component->GetICEStream()->GetSession()->GetRemoteInitiatedCheckHmacKey(),
-                              component->GetICEStream()->GetSession()->GetRemoteInitiatedCheckHmacKeyLength(), tid);
-    }
+    uint8_t buf[StunMessageBuilder::MAX_UDP_MSG_SIZE];
+    ICESession* session = component->GetICEStream()->GetSession();
+    StunMsgTypeClass msgClass = ((checkStatus == ICECandidatePair::CheckRoleConflict) ?
+                                 STUN_MSG_ERROR_CLASS : STUN_MSG_RESPONSE_CLASS);
 
     QCC_DbgPrintf(("Send Response: class %s, TID %s dest %s:%d",
-                   msg->MessageClassToString(msg->GetTypeClass()).c_str(),
+                   StunMessage::MessageClassToString(msgClass).c_str(),
                    tid.ToString().c_str(),
                    dest.addr.ToString().c_str(), dest.port));
 
-    msg->AddAttribute(new StunAttributeXorMappedAddress(*msg, dest.addr, dest.port));
-    msg->AddAttribute(new StunAttributeRequestedTransport(REQUESTED_TRANSPORT_TYPE_UDP));
-    msg->AddAttribute(new StunAttributeMessageIntegrity(*msg));
-    msg->AddAttribute(new StunAttributeFingerprint(*msg));
+    StunMessageBuilder msg(buf, sizeof(buf), msgClass, STUN_MSG_BINDING_METHOD, tid);
 
-    // send our response
-    status = stunActivity->stun->SendStunMessage(*msg, dest.addr, dest.port, usingTurn);
+    if (checkStatus == ICECandidatePair::CheckRoleConflict) {
+        msg.AddErrorCode(STUN_ERR_CODE_ROLE_CONFLICT, "Role Conflict");
+    }
+    msg.AddXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, dest.addr, dest.port);
+    // The protocol number is followed by 3 reserved octets.
+    msg.AddUInt32(STUN_ATTR_REQUESTED_TRANSPORT, static_cast<uint32_t>(REQUESTED_TRANSPORT_TYPE_UDP) << 24);
+
+    // Finish() returns the first error from adding an attribute.
+    status = msg.Finish(session->GetRemoteInitiatedCheckHmacKey(),
+                        session->GetRemoteInitiatedCheckHmacKeyLength(), true);
 
-    delete msg;
+    // send our response
+    if (status == ER_OK) {
+        status = stunActivity->stun->SendStunMessage(msg, dest.addr, dest.port, usingTurn);
+    } else {
+        QCC_LogError(status, ("Building check response"));
+    }
 
     return status;
 }
@@ -25,6 +25,7 @@
 #include <ICECandidatePair.h>
 #include <Component.h>
 #include <StunAttribute.h>
+#include <StunMessageView.h>
 #include <ICESession.h>
 
 using namespace qcc;
@@ -193,7 +194,8 @@ void ICECandidatePair::UpdateNominatedFlag(void)
 void ICECandidatePair::Check(void)
 {
     StunTransactionID tid;
-    StunMessage* msg;
+    uint8_t buf[StunMessageBuilder::MAX_UDP_MSG_SIZE];
+    ICESession* session = local->GetComponent()->GetICEStream()->GetSession();
 
     QCC_DbgTrace(("ICECandidatePair::Check: [local=%s:%d (%s)] [remote=%s:%d (%s)] priority=%ld",
                   local->GetEndpoint().addr.ToString().c_str(),
@@ -206,18 +208,8 @@ void ICECandidatePair::Check(void)
 
     if (!checkRetry->GetTransactionID(tid)) {
         // New transaction
-        msg = new StunMessage(STUN_MSG_REQUEST_CLASS,
-                              STUN_MSG_BINDING_METHOD,
-                              local->GetComponent()->GetICEStream()->GetSession()->GetLocalInitiatedCheckHmacKey(),
-                              local->GetComponent()->GetICEStream()->GetSession()->GetLocalInitiatedCheckHmacKeyLength());
-        msg->GetTransactionID(tid);
+        tid.SetValue();
         checkRetry->SetTransactionID(tid);
-    } else {
-        msg = new StunMessage(STUN_MSG_REQUEST_CLASS,
-                              STUN_MSG_BINDING_METHOD,
-                              local->GetComponent()->GetICEStream()->GetSession()->GetLocalInitiatedCheckHmacKey(),
-                              local->GetComponent()->GetICEStream()->GetSession()->GetLocalInitiatedCheckHmacKeyLength(),
-                              tid);
     }
 
     QCC_DbgPrintf(("SndChk TID %s from %s:%d remote %s:%d",
@@ -227,22 +219,31 @@ void ICECandidatePair::Check(void)
                    remote->GetEndpoint().addr.ToString().c_str(),
                    remote->GetEndpoint().port));
 
-    msg->AddAttribute(new StunAttributeUsername(local->GetComponent()->GetICEStream()->GetSession()->GetLocalInitiatedCheckUsername()));
-    msg->AddAttribute(new StunAttributePriority(bindRequestPriority));
+    StunMessageBuilder msg(buf, sizeof(buf), STUN_MSG_REQUEST_CLASS, STUN_MSG_BINDING_METHOD, tid);
 
-    if (local->GetComponent()->GetICEStream()->GetSession()->IsControllingAgent()) {
-        msg->AddAttribute(new StunAttributeIceControlling(controlTieBreaker));
+    msg.AddString(STUN_ATTR_USERNAME, session->GetLocalInitiatedCheckUsername());
+    msg.AddUInt32(STUN_ATTR_PRIORITY, bindRequestPriority);
+
+    if (session->IsControllingAgent()) {
+        msg.AddUInt64(STUN_ATTR_ICE_CONTROLLING, controlTieBreaker);
 
         if (useAggressiveNomination || regularlyNominated) {
-            msg->AddAttribute(new StunAttributeUseCandidate());
+            msg.AddAttribute(STUN_ATTR_USE_CANDIDATE, NULL, 0);
         }
     } else {
-        msg->AddAttribute(new StunAttributeIceControlled(controlTieBreaker));
+        msg.AddUInt64(STUN_ATTR_ICE_CONTROLLED, controlTieBreaker);
     }
 
-    msg->AddAttribute(new StunAttributeRequestedTransport(REQUESTED_TRANSPORT_TYPE_UDP));
-    msg->AddAttribute(new StunAttributeMessageIntegrity(*msg));
-    msg->AddAttribute(new StunAttributeFingerprint(*msg));
+    // The protocol number is followed by 3 reserved octets.
+    msg.AddUInt32(STUN_ATTR_REQUESTED_TRANSPORT, static_cast<uint32_t>(REQUESTED_TRANSPORT_TYPE_UDP) << 24);
+
+    // Finish() returns the first error from adding an attribute.
+    QStatus status = msg.Finish(session->GetLocalInitiatedCheckHmacKey(),
+                                session->GetLocalInitiatedCheckHmacKeyLength(), true);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Building connectivity check"));
+        return;
+    }
 
     // immediately send our request (without enqueuing, because we have already paced ourselves
     // via the check dispatcher thread.)
@@ -250,21 +251,18 @@ void ICECandidatePair::Check(void)
     if (remote->GetType() == _ICECandidate::Relayed_Candidate) {
         local->GetStunActivity()->stun->SetTurnAddr(remote->GetEndpoint().addr);
         local->GetStunActivity()->stun->SetTurnPort(remote->GetEndpoint().port);
-        local->GetStunActivity()->stun->SendStunMessage(*msg,
+        local->GetStunActivity()->stun->SendStunMessage(msg,
                                                         local->GetEndpoint().addr,
                                                         local->GetEndpoint().port,
                                                         true);
     } else {
-        local->GetStunActivity()->stun->SendStunMessage(*msg,
+        local->GetStunActivity()->stun->SendStunMessage(msg,
                                                         remote->GetEndpoint().addr,
                                                         remote->GetEndpoint().port,
                                                         local->GetType() == _ICECandidate::Relayed_Candidate);
     }
 
     // PPN - may need to add case for server/peer reflexive candidate
-
-    delete msg;
-
 }
 
 
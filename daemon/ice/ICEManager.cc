@@ -45,11 +45,9 @@ ICEManager* ICEManager::GetInstance()
     if (0 == singleton) {
         singleton = new ICEManager();
 
-        // Feature: With current implementation, STUN request pacing is
-        // handled within each Session.  It would be more consistent with
-        // the spirit of ICE if pacing were a 'machine-wide' behavior instead.
-        // To make such a change, here would be a good place to start the
-        // thread which will perform keepalives, and periodic ICE-checks.
+        // STUN request pacing is a 'machine-wide' behavior in the spirit of ICE.
+        // All sessions share the manager's scheduler which performs keepalives,
+        // and periodic ICE-checks.
     }
     singletonLock.Unlock();
 
@@ -57,6 +55,7 @@ ICEManager* ICEManager::GetInstance()
 }
 
 ICEManager::ICEManager() :
+    scheduler(),
     ethernetInterfaceName(),
     wifiInterfaceName(),
     mobileNwInterfaceName()
@@ -86,7 +85,7 @@ QStatus ICEManager::AllocateSession(bool addHostCandidates,
     QStatus status = ER_OK;
 
     session = new ICESession(addHostCandidates, addRelayedCandidates, listener, stunInfo,
-                             ethernetInterfaceName, wifiInterfaceName, mobileNwInterfaceName);
+                             ethernetInterfaceName, wifiInterfaceName, mobileNwInterfaceName, scheduler);
 
     status = session->Init();
 
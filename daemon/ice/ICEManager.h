@@ -26,6 +26,7 @@
 #include <qcc/Mutex.h>
 #include "ICESession.h"
 #include "ICESessionListener.h"
+#include "ICEScheduler.h"
 #include "Status.h"
 #include "RendezvousServerInterface.h"
 
@@ -97,6 +98,8 @@ class ICEManager {
 
     list<ICESession*> sessions;     ///< List of allocated ICESessions.
 
+    ICEScheduler scheduler;         ///< Paces STUN transactions for all the sessions.
+
     Mutex lock;                    ///< Synchronizes multiple threads
 
     /** Private constructor */
@@ -0,0 +1,242 @@
+/**
+ * @file ICEScheduler.cc
+ *
+ * Implementation of the scheduler that paces the STUN transactions of all ICE sessions.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/Debug.h>
+#include <qcc/time.h>
+
+#include "ICEScheduler.h"
+
+using namespace std;
+using namespace qcc;
+
+/** @internal */
+#define QCC_MODULE "ICESCHEDULER"
+
+namespace ajn {
+
+const uint32_t ICEScheduler::PACING_INTERVAL_MS;
+const uint32_t ICEScheduler::NUM_WHEEL_SLOTS;
+
+ICEScheduler::ICEScheduler(uint32_t pacingInterval) :
+    Thread("ICEScheduler"),
+    pacingInterval(pacingInterval ? pacingInterval : 1),
+    wheel(this->pacingInterval, NUM_WHEEL_SLOTS),
+    lastSent(0),
+    running(NULL)
+{
+}
+
+ICEScheduler::~ICEScheduler()
+{
+    Stop();
+    Join();
+    lock.Lock(MUTEX_CONTEXT);
+    map<ICESchedulerListener*, Entry*>::iterator it;
+    for (it = entries.begin(); it != entries.end(); ++it) {
+        delete it->second;
+    }
+    entries.clear();
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void ICEScheduler::Link(Entry* entry, uint64_t now)
+{
+    entry->timer = wheel.Add(entry, entry->due, now);
+    entry->linked = true;
+    entry->ready = false;
+}
+
+void ICEScheduler::LinkReady(Entry* entry)
+{
+    entry->pos = readyList.insert(readyList.end(), entry);
+    entry->linked = true;
+    entry->ready = true;
+}
+
+void ICEScheduler::Unlink(Entry* entry)
+{
+    if (entry->ready) {
+        readyList.erase(entry->pos);
+    } else {
+        wheel.Remove(entry->timer);
+    }
+    entry->linked = false;
+}
+
+void ICEScheduler::Advance(uint64_t now)
+{
+    dueEntries.clear();
+    wheel.Expire(now, dueEntries);
+    for (size_t i = 0; i < dueEntries.size(); ++i) {
+        LinkReady(dueEntries[i]);
+    }
+}
+
+QStatus ICEScheduler::AddListener(ICESchedulerListener* listener, uint32_t interval)
+{
+    QStatus status = ER_OK;
+    lock.Lock(MUTEX_CONTEXT);
+    Entry* entry;
+    map<ICESchedulerListener*, Entry*>::iterator it = entries.find(listener);
+    if (it != entries.end()) {
+        entry = it->second;
+        if (entry->linked) {
+            Unlink(entry);
+        }
+    } else {
+        entry = new Entry();
+        entry->listener = listener;
+        entry->linked = false;
+        entry->removed = false;
+        entry->turnDone = NULL;
+        entries[listener] = entry;
+    }
+    entry->interval = interval;
+    entry->due = GetTimestamp64();
+    LinkReady(entry);
+    if (!IsRunning()) {
+        status = Start();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("ICEScheduler failed to start"));
+            Unlink(entry);
+            entries.erase(listener);
+            if (entry != running) {
+                delete entry;
+            } else {
+                entry->removed = true;
+            }
+        }
+    }
+    wakeEvent.SetEvent();
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+void ICEScheduler::RemoveListener(ICESchedulerListener* listener)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    map<ICESchedulerListener*, Entry*>::iterator it = entries.find(listener);
+    if (it != entries.end()) {
+        Entry* entry = it->second;
+        entries.erase(it);
+        if (entry->linked) {
+            Unlink(entry);
+        }
+        if (entry == running) {
+            /* The scheduler thread frees the entry and sets turnDone when the turn ends */
+            entry->removed = true;
+            if (Thread::GetThread() != this) {
+                Event turnDone;
+                entry->turnDone = &turnDone;
+                lock.Unlock(MUTEX_CONTEXT);
+                while (!turnDone.IsSet()) {
+                    Event::Wait(turnDone);
+                }
+                lock.Lock(MUTEX_CONTEXT);
+            }
+        } else {
+            delete entry;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+size_t ICEScheduler::GetNumListeners()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    size_t num = entries.size();
+    lock.Unlock(MUTEX_CONTEXT);
+    return num;
+}
+
+qcc::ThreadReturn STDCALL ICEScheduler::Run(void* arg)
+{
+    vector<Event*> checkEvents;
+    checkEvents.push_back(&stopEvent);
+    checkEvents.push_back(&wakeEvent);
+
+    lock.Lock(MUTEX_CONTEXT);
+    while (!IsStopping()) {
+        uint64_t now = GetTimestamp64();
+        Advance(now);
+
+        uint32_t waitMs;
+        if (!readyList.empty() && (now < (lastSent + pacingInterval))) {
+            waitMs = (uint32_t)(lastSent + pacingInterval - now);
+        } else {
+            /* Give the due listeners their turns until one of them uses up this pacing interval */
+            while (!readyList.empty()) {
+                Entry* entry = readyList.front();
+                Unlink(entry);
+                running = entry;
+                lock.Unlock(MUTEX_CONTEXT);
+                ICESchedulerListener::PacingResult result = entry->listener->PacingSlot();
+                lock.Lock(MUTEX_CONTEXT);
+                running = NULL;
+
+                /* The listener may have removed or rescheduled itself during its turn */
+                if (entry->removed) {
+                    if (entry->turnDone) {
+                        entry->turnDone->SetEvent();
+                    }
+                    delete entry;
+                } else if (!entry->linked) {
+                    if (result == ICESchedulerListener::PACING_FINISHED) {
+                        entries.erase(entry->listener);
+                        delete entry;
+                    } else {
+                        entry->due = now + entry->interval;
+                        Link(entry, now);
+                    }
+                }
+                if (result == ICESchedulerListener::PACING_SENT) {
+                    lastSent = GetTimestamp64();
+                    break;
+                }
+            }
+            if (!readyList.empty()) {
+                waitMs = pacingInterval;
+            } else if (wheel.Size() == 0) {
+                waitMs = Event::WAIT_FOREVER;
+            } else {
+                uint64_t next = wheel.NextDue();
+                waitMs = (next > now) ? (uint32_t)(next - now) : 0;
+            }
+        }
+
+        wakeEvent.ResetEvent();
+        lock.Unlock(MUTEX_CONTEXT);
+        vector<Event*> signaledEvents;
+        QStatus status = Event::Wait(checkEvents, signaledEvents, waitMs);
+        lock.Lock(MUTEX_CONTEXT);
+        if ((status != ER_OK) && (status != ER_TIMEOUT)) {
+            QCC_LogError(status, ("ICEScheduler Event::Wait failed"));
+            break;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return 0;
+}
+
+} //namespace ajn
@@ -0,0 +1,186 @@
+#ifndef _ICESCHEDULER_H
+#define _ICESCHEDULER_H
+/**
+ * @file ICEScheduler.h
+ *
+ * This file defines the scheduler that paces the STUN transactions of all ICE sessions.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include ICEScheduler.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <qcc/Event.h>
+#include <qcc/Mutex.h>
+#include <qcc/Thread.h>
+
+#include "Status.h"
+#include "TimingWheel.h"
+
+namespace ajn {
+
+/**
+ * Interface implemented by the users of the ICEScheduler, each one is given a turn to start a
+ * STUN transaction once per pacing interval.
+ */
+class ICESchedulerListener {
+  public:
+
+    /** What a listener did with its turn */
+    typedef enum {
+        PACING_IDLE,        /**< Nothing was sent, the slot can be given to another listener */
+        PACING_SENT,        /**< A STUN transaction was started */
+        PACING_FINISHED     /**< Nothing was sent and the listener has no more work to do */
+    } PacingResult;
+
+    /**
+     * Virtual destructor for derivable class.
+     */
+    virtual ~ICESchedulerListener() { }
+
+    /**
+     * Called on the scheduler thread when it is this listener's turn. The listener must start at
+     * most one STUN transaction. The scheduler does not hold any locks during the call so the
+     * listener may add or remove itself or other listeners.
+     *
+     * @return  What the listener did with its turn.
+     */
+    virtual PacingResult PacingSlot(void) = 0;
+};
+
+/**
+ * %ICEScheduler replaces a pacing thread per ICE session and a check list dispatcher thread per
+ * ICE stream with a single thread for all of them.
+ *
+ * Listeners are kept in a TimingWheel with one slot per pacing interval (Ta). Each time
+ * Ta elapses the listeners that are due are given a turn in the order they became due until one
+ * of them starts a STUN transaction, so no more than one transaction is started per Ta across
+ * all sessions no matter how many are running. A listener that is given a turn is due again
+ * after its own interval.
+ */
+class ICEScheduler : public qcc::Thread {
+  public:
+
+    /**
+     * Default global pacing interval (Ta) in milliseconds, RFC 5245 section 16.
+     */
+    static const uint32_t PACING_INTERVAL_MS = 20;
+
+    /**
+     * Number of slots in the timing wheel, must be a power of 2.
+     */
+    static const uint32_t NUM_WHEEL_SLOTS = 64;
+
+    /**
+     * Constructor
+     *
+     * @param pacingInterval  Minimum milliseconds between STUN transactions (Ta).
+     */
+    ICEScheduler(uint32_t pacingInterval = PACING_INTERVAL_MS);
+
+    /**
+     * Destructor, stops the scheduler thread.
+     */
+    ~ICEScheduler();
+
+    /**
+     * Add a listener or reschedule one that is already added. The listener is given its first
+     * turn as soon as the pacing allows. The scheduler thread is started on first use.
+     *
+     * @param listener  The listener.
+     * @param interval  Milliseconds from one of the listener's turns to the next.
+     *
+     * @return  ER_OK if the listener was added.
+     */
+    QStatus AddListener(ICESchedulerListener* listener, uint32_t interval);
+
+    /**
+     * Remove a listener. If the listener is taking its turn on another thread this waits for it
+     * to finish, so any lock the listener takes in PacingSlot() must not be held by the caller.
+     * Called from the scheduler thread this returns immediately.
+     *
+     * @param listener  The listener.
+     */
+    void RemoveListener(ICESchedulerListener* listener);
+
+    /**
+     * Get the number of listeners.
+     *
+     * @return  The number of listeners.
+     */
+    size_t GetNumListeners();
+
+  protected:
+
+    /**
+     * Thread entry point, gives the listeners their turns.
+     */
+    qcc::ThreadReturn STDCALL Run(void* arg);
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    ICEScheduler(const ICEScheduler& other);
+    ICEScheduler& operator=(const ICEScheduler& other);
+
+    /** A listener's place in the schedule */
+    struct Entry {
+        ICESchedulerListener* listener;            /**< The listener */
+        uint32_t interval;                         /**< Milliseconds between turns */
+        uint64_t due;                              /**< Time of the next turn */
+        bool linked;                               /**< true if in readyList or the wheel */
+        bool ready;                                /**< true if in readyList, false if in the wheel */
+        bool removed;                              /**< The listener was removed during its turn */
+        uint32_t timer;                            /**< The entry's timer in the wheel */
+        std::list<Entry*>::iterator pos;           /**< Position in readyList */
+        qcc::Event* turnDone;                      /**< Set when the turn ends or NULL */
+    };
+
+    /** Put an entry in the wheel for its due time */
+    void Link(Entry* entry, uint64_t now);
+
+    /** Put an entry at the end of readyList */
+    void LinkReady(Entry* entry);
+
+    /** Take an entry out of the wheel or readyList */
+    void Unlink(Entry* entry);
+
+    /** Move the entries that are due at or before now to readyList */
+    void Advance(uint64_t now);
+
+    const uint32_t pacingInterval;                              /**< Ta in milliseconds */
+    qcc::Mutex lock;                                            /**< Protects the members below */
+    qcc::Event wakeEvent;                                       /**< Set when a listener is added */
+    std::map<ICESchedulerListener*, Entry*> entries;            /**< All the listeners */
+    TimingWheel<Entry*> wheel;                                  /**< Entries by due time */
+    std::list<Entry*> readyList;                                /**< Entries that are due, oldest first */
+    std::vector<Entry*> dueEntries;                             /**< Entries taken from the wheel by Advance() */
+    uint64_t lastSent;                                          /**< Time the last transaction was started */
+    Entry* running;                                             /**< Entry taking its turn or NULL */
+};
+
+} //namespace ajn
+
+#endif
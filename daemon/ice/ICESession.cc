@@ -51,25 +51,21 @@ using namespace std;
 
 namespace ajn {
 
+/** Milliseconds between STUN/TURN requests for a session, the scheduler paces all sessions together */
+static const uint32_t STUN_TURN_PACING_INTERVAL_MS = 500;
+
 ICESession::~ICESession(void)
 {
     // ToDo... need to release any TURN allocations by using Refresh=0?
 
-    // Notify pacing thread to terminate
+    // Notify pacing to terminate
     terminating = true;
 
     // Ensure that it terminates
-    if (pacingThread) {
-        pacingThread->Stop();
-        pacingThread->Join();
-    }
+    scheduler.RemoveListener(this);
 
     Lock();
 
-    // Release resources
-    delete pacingThread;
-    pacingThread = NULL;
-
     // Empty queue of messages to send
     while (!stunQueue.empty()) {
         StunWork* stunWork = stunQueue.front();
@@ -94,7 +90,7 @@ void ICESession::StopPacingThreadAndClearStunQueue(void)
 {
     QCC_DbgPrintf(("ICESession::StopPacingThreadAndClearStunQueue()"));
 
-    // Notify pacing thread to terminate
+    // Notify pacing to terminate
     terminating = true;
 
 }
@@ -442,15 +438,15 @@ void ICESession::AssignPrioritiesPerICEStream(const ICEStream* stream)
     }
 }
 
-void ICESession::StunTurnPacingWork(void)
+ICESchedulerListener::PacingResult ICESession::PacingSlot(void)
 {
-    // Note: we enter this method holding the object lock!!!
-    // Therefore ensure that we are holding it when we exit.
+    PacingResult result = PACING_IDLE;
 
-    uint32_t pacingIntervalMsecs = 500;
+    Lock();
 
-    Thread* thisThread = Thread::GetThread();
-    while (!terminating && !thisThread->IsStopping()) {
+    if (terminating) {
+        result = PACING_FINISHED;
+    } else {
         // If any requests are to be sent, enqueue them. Check for timeouts.
         FindPendingWork();
 
@@ -463,19 +459,21 @@ void ICESession::StunTurnPacingWork(void)
                                                              stunWork->destination.port,
                                                              false); // not sending to peer
             if (ER_OK != status) {
-                QCC_LogError(status, ("StunTurnPacingWork"));
+                QCC_LogError(status, ("PacingSlot"));
                 terminating = true;
             }
 
             delete stunWork->msg;
             delete stunWork;
             stunQueue.pop_front();
-        }
 
-        Unlock();
-        qcc::Sleep(pacingIntervalMsecs);
-        Lock();
+            result = PACING_SENT;
+        }
     }
+
+    Unlock();
+
+    return result;
 }
 
 
@@ -972,24 +970,17 @@ void ICESession::FindPendingWork(void)
 }
 
 
-QStatus ICESession::StartStunTurnPacingThread(void)
+QStatus ICESession::StartStunTurnPacing(void)
 {
     QStatus status = ER_OK;
 
     SetState(ICEGatheringCandidates);
 
-    pacingThread = new Thread("GatheringKeepalivePacingThreadStub", GatheringKeepalivePacingThreadStub);
-
-    // Start the thread which will send STUN/TURN requests (and retries), at appropriate
+    // Have the scheduler send STUN/TURN requests (and retries), at appropriate
     // pace. Once candidates are gathered, it will perform periodic keepalives.
-
-    status = pacingThread->Start(this);
+    status = scheduler.AddListener(this, STUN_TURN_PACING_INTERVAL_MS);
     if (ER_OK != status) {
         SetState(ICEProcessingFailed);
-    } else {
-        // Try to mitigate the chance of memory corruption, should caller immediately delete this object
-        // upon return. (See comment at definition of 'GatheringKeepalivePacingThreadStub'
-        qcc::Sleep(1);
     }
 
     return status;
@@ -1072,13 +1063,13 @@ QStatus ICESession::Init(void)
         goto exit;
     }
 
-    // Gather server-reflexive (and relayed if requested) candidates,) by
-    // creating a new thread.  We will be notified asynchronously upon completion.
-    // This new thread observes proper pacing of STUN/TURN requests, and,
+    // Gather server-reflexive (and relayed if requested) candidates, using
+    // the scheduler.  We will be notified asynchronously upon completion.
+    // The scheduler observes proper pacing of STUN/TURN requests, and,
     // once candidates are gathered, performs keepalives until the session is ended.
-    status = StartStunTurnPacingThread();
+    status = StartStunTurnPacing();
     if (ER_OK != status) {
-        QCC_LogError(status, ("StartStunTurnPacingThread()"));
+        QCC_LogError(status, ("StartStunTurnPacing()"));
     }
 
 exit:
@@ -40,6 +40,7 @@
 #include "ICESessionListener.h"
 #include "Component.h"
 #include "ICEStream.h"
+#include "ICEScheduler.h"
 #include "StunRetry.h"
 #include "ICEManager.h"
 #include "RendezvousServerInterface.h"
@@ -91,7 +92,7 @@ const uint8_t REQUESTED_TRANSPORT_TYPE_TCP = 6;
  * ICESession contains the state for a single ICE session.
  * The session may contain one or more media streams (each of which may have several components.)
  */
-class ICESession {
+class ICESession : public ICESchedulerListener {
   public: ~ICESession(void);
 
     /** ICESession states */
@@ -205,6 +206,17 @@ class ICESession {
 
     void StopPacingThreadAndClearStunQueue(void);
 
+    /**
+     * Get the scheduler that paces STUN transactions for this session and its streams.
+     */
+    ICEScheduler& GetScheduler(void) { return scheduler; }
+
+    /**
+     * Called by the ICEScheduler to send the next queued STUN/TURN request.
+     * Gathers candidates observing the pacing throttling, then performs keepalives.
+     */
+    PacingResult PacingSlot(void);
+
     String GetusernameForShortTermCredential() { return usernameForShortTermCredential; };
 
   private:
@@ -276,7 +288,7 @@ class ICESession {
 
     bool addRelayedCandidates;
 
-    Thread* pacingThread;
+    ICEScheduler& scheduler;
 
     QStatus errorCode;
 
@@ -299,7 +311,8 @@ class ICESession {
                STUNServerInfo stunInfo,
                String ethPrefix,
                String wifiPrefix,
-               String mobileNwPrefix) :
+               String mobileNwPrefix,
+               ICEScheduler& scheduler) :
         hmacKeyLen(0),
         TurnServerAvailable(false),
         terminating(false),
@@ -311,7 +324,7 @@ class ICESession {
         sessionListener(listener),
         addHostCandidates(addHostCandidates),
         addRelayedCandidates(addRelayedCandidates),
-        pacingThread(),
+        scheduler(scheduler),
         errorCode(ER_OK),
         isControllingAgent(false),
         useAggressiveNomination(false),
@@ -366,10 +379,7 @@ class ICESession {
 
     QStatus GatherHostCandidates(void);
 
-    QStatus StartStunTurnPacingThread(void);
-
-    // Gather STUN/TURN candidates, observing the pacing throttling, then perform keepalives.
-    void StunTurnPacingWork(void);
+    QStatus StartStunTurnPacing(void);
 
     void FindPendingWork(void);
 
@@ -397,23 +407,6 @@ class ICESession {
 
     String GetTransport(const String& transport) const;
 
-    // Each "ICE app" thread will create a gatherKeepalivePacing thread with this
-    // function as its entry point.
-    static ThreadReturn STDCALL GatheringKeepalivePacingThreadStub(void* pThis)
-    {
-        ICESession* thisPtr = (ICESession*)pThis;
-
-        // There is a chance of memory corruption here in that if, by the time
-        // the following instruction gets a chance to run, this object's destructor
-        // has been called, 'thisPtr' will be invalid.  To mitigate the chances,
-        // the parent of this thread sleeps for a while immediately after giving birth.
-        thisPtr->Lock();
-        thisPtr->StunTurnPacingWork();
-        thisPtr->Unlock();
-
-        return 0;
-    }
-
     bool GetAddRelayedCandidates(void) const { return addRelayedCandidates; }
 
     void NotifyListenerIfNeeded(void);
@@ -25,6 +25,7 @@
 #include <qcc/String.h>
 #include <Component.h>
 #include <ICESession.h>
+#include <ICEScheduler.h>
 #include "RendezvousServerInterface.h"
 
 using namespace qcc;
@@ -34,6 +35,9 @@ using namespace qcc;
 
 namespace ajn {
 
+/** Milliseconds between checks for a check list, the scheduler paces all check lists together */
+static const uint32_t CHECK_PACING_INTERVAL_MS = 500;
+
 #ifndef NDEBUG
 void ICEStream::DumpChecklist(void)
 {
@@ -80,18 +84,15 @@ void ICEStream::CancelChecks(void)
 
     terminating = true;
 
-    // Wait on dispatcher thread
-    if (NULL != checkListDispatcherThread &&
-        Thread::GetThread() != checkListDispatcherThread) {
-
-        // Ensure that it terminates
-        checkListDispatcherThread->Stop();
+    // Stop dispatching checks. A turn in progress on the scheduler thread needs
+    // the session lock to finish, unless this is that turn.
+    ICEScheduler& scheduler = session->GetScheduler();
+    if (Thread::GetThread() == &scheduler) {
+        scheduler.RemoveListener(this);
+    } else {
         session->Unlock();
-        checkListDispatcherThread->Join();
+        scheduler.RemoveListener(this);
         session->Lock();
-
-        delete checkListDispatcherThread;
-        checkListDispatcherThread = NULL;
     }
 
     // In case we are asked to restart checks...
@@ -150,16 +151,12 @@ void ICEStream::SortAndPruneCandidatePairs(void)
     // candidates are identical to those of a higher priority pair.
     // With our implementation, 'local' implies if server-reflexive, use its base.
 
-    list<ICECandidatePair*> tempList;
-    list<ICECandidatePair*>::iterator iter;
-
-    tempList = checkList;   // work out of a temp list so as not to corrupt iterator
-
+    checkListIterator iter = checkList.begin();
     ICECandidatePair* prev = NULL;
 
-    for (iter = tempList.begin(); iter != tempList.end(); ++iter) {
+    while (iter != checkList.end()) {
         if (prev == NULL) {
-            prev = *iter;
+            prev = *iter++;
             continue;
         }
 
@@ -179,9 +176,9 @@ void ICEStream::SortAndPruneCandidatePairs(void)
 
             // This is guaranteed to be the lower priority candidate
             delete (*iter);
-            checkList.remove(*iter);        // Note we are playing with real list here, not our temp.
+            iter = checkList.erase(iter);
         } else {
-            prev = *iter;
+            prev = *iter++;
         }
     }
 
@@ -290,49 +287,16 @@ void ICEStream::AddCandidatePair(ICECandidatePair* checkPair)
 
 void ICEStream::AddCandidatePairByPriority(ICECandidatePair* checkPair)
 {
-    AddCandidatePair(checkPair);
-
-    // Sort the candidate pairs by priority
-    checkList.sort(compareCandidatePairsByPriority);
-}
-
-
-
-
-void ICEStream::GetAllReadyTriggeredCheckPairs(list<ICECandidatePair*>& foundList)
-{
-    checkListIterator it;
-    for (it = CheckListBegin(); it != CheckListEnd(); ++it) {
-        if ((*it)->IsTriggered() &&
-            (ICECandidatePair::Waiting == (*it)->state ||
-             (ICECandidatePair::InProgress == (*it)->state &&
-              // See if previous attempt timed out, and retry left
-              (*it)->RetryAvailable()))) {
-            foundList.push_back(*it);
-        }
+    // The check list is already sorted by priority so insert the pair after
+    // any pairs of equal or higher priority rather than sorting it again.
+    checkListIterator it = CheckListBegin();
+    while (it != CheckListEnd() && !compareCandidatePairsByPriority(checkPair, *it)) {
+        ++it;
     }
+    checkList.insert(it, checkPair);
 }
 
 
-void ICEStream::GetAllReadyOrdinaryCheckPairs(list<ICECandidatePair*>& foundList, bool& noWaitingPairs)
-{
-    noWaitingPairs = true;
-    checkListIterator it;
-    for (it = CheckListBegin(); it != CheckListEnd(); ++it) {
-        if (ICECandidatePair::Waiting == (*it)->state ||
-            ICECandidatePair::InProgress == (*it)->state) {
-            noWaitingPairs = false;
-
-            if (!(*it)->IsTriggered() &&
-                (ICECandidatePair::Waiting == (*it)->state ||
-                 (ICECandidatePair::InProgress == (*it)->state &&
-                  // See if previous attempt timed out, and any retry left.
-                  (*it)->RetryAvailable()))) {
-                foundList.push_back(*it);
-            }
-        }
-    }
-}
 
 
 // descending time since retransmit, descending priority
@@ -354,46 +318,46 @@ bool comparePairsByTransmitTimePriority(ICECandidatePair* first, ICECandidatePai
 ICECandidatePair* ICEStream::GetNextCheckPair(void)
 {
     ICECandidatePair* readyPair = NULL;
+    ICECandidatePair* triggeredPair = NULL;
+    ICECandidatePair* ordinaryPair = NULL;
+    ICECandidatePair* frozenPair = NULL;
+    bool noWaitingPairs = true;
 
+    // In one pass find the triggered and ordinary pairs that have waited longest
+    // to transmit (or retransmit), and the highest priority Frozen pair.
     checkListIterator it;
-    list<ICECandidatePair*> triggeredList;
-
-    // create list of all triggered pairs ready to transmit (or retransmit)
-    GetAllReadyTriggeredCheckPairs(triggeredList);
-
-    if (triggeredList.size() > 0) {
-
-        // sort the list by time waiting to transmit/retransmit
-        triggeredList.sort(comparePairsByTransmitTimePriority);
+    for (it = CheckListBegin(); it != CheckListEnd(); ++it) {
+        ICECandidatePair* pair = *it;
+        if (ICECandidatePair::Waiting == pair->state ||
+            ICECandidatePair::InProgress == pair->state) {
+            noWaitingPairs = false;
 
-        readyPair = triggeredList.front();
-        readyPair = readyPair->IncrementRetryAttempt();
+            // See if previous attempt timed out, and any retry left.
+            if (ICECandidatePair::Waiting == pair->state || pair->RetryAvailable()) {
+                ICECandidatePair*& best = pair->IsTriggered() ? triggeredPair : ordinaryPair;
+                if (!best || comparePairsByTransmitTimePriority(pair, best)) {
+                    best = pair;
+                }
+            }
+        } else if (ICECandidatePair::Frozen == pair->state && !frozenPair) {
+            // List is already sorted.
+            frozenPair = pair;
+        }
     }
 
+    if (triggeredPair) {
+        readyPair = triggeredPair->IncrementRetryAttempt();
+    }
 
     // If no ready triggered check exists, look for ordinary check.
     if (!readyPair) {
-        // Find non-Triggered pair ready to transmit (or retransmit)
-        bool noWaitingPairs = true;
-        list<ICECandidatePair*> ordinaryList;
-        GetAllReadyOrdinaryCheckPairs(ordinaryList, noWaitingPairs);
-        if (ordinaryList.size() > 0) {
-
-            ordinaryList.sort(comparePairsByTransmitTimePriority);
-
-            readyPair = ordinaryList.front();
-            readyPair = readyPair->IncrementRetryAttempt();
+        if (ordinaryPair) {
+            readyPair = ordinaryPair->IncrementRetryAttempt();
         }
 
         if (!readyPair && noWaitingPairs) {
             // No Waiting (or InProgress) pairs. See if anything to unfreeze.
-            for (it = CheckListBegin(); it != CheckListEnd(); ++it) {
-                // List is already sorted.
-                if (ICECandidatePair::Frozen == (*it)->state) {
-                    readyPair = (*it);
-                    break;
-                }
-            }
+            readyPair = frozenPair;
         }
     }
 
@@ -431,39 +395,30 @@ void ICEStream::SetTerminate(void)
 }
 
 // Section 5.8 draft-ietf-mmusic-ice-19
-void ICEStream::CheckListDispatcher(void)
+ICESchedulerListener::PacingResult ICEStream::PacingSlot(void)
 {
-    uint32_t activeCheckListCount;
-    uint32_t pacingIntervalMsecs = 500;
+    PacingResult result = PACING_IDLE;
 
     session->Lock();
 
     // Unless asynchronously told to terminate, see if there is more work
     // to do.  Implicitly process timeouts and notify app if necessary.
-    while (!terminating && !ChecksFinished()) {
+    if (terminating || ChecksFinished()) {
+        QCC_DbgPrintf(("CheckListDispatcher terminating"));
+        result = PACING_FINISHED;
+    } else {
         // Get next pair from triggered queue (or ordinary list)
         ICECandidatePair* pair = GetNextCheckPair();
         if (pair) {
             // Send pair check.  Any response is handled elsewhere.
             pair->Check();
+            result = PACING_SENT;
         }
-
-        activeCheckListCount = session->GetActiveCheckListCount();
-
-        // Pace ourselves
-        session->Unlock();
-        qcc::Sleep(pacingIntervalMsecs * max(1U, activeCheckListCount));
-        //ToDo: 'max' is to accommodate improper semantics
-        //of GetActiveCheckListCount
-        session->Lock();
     }
-    ;
 
     session->Unlock();
 
-    QCC_DbgPrintf(("CheckListDispatcher terminating"));
-
-    // Now CheckListDispatcher thread terminates
+    return result;
 }
 
 QStatus ICEStream::StartCheckListDispatcher(void)
@@ -472,12 +427,10 @@ QStatus ICEStream::StartCheckListDispatcher(void)
 
     checkListState = CheckStateRunning;
 
-    checkListDispatcherThread = new Thread("CheckListDispatcherThreadStub", CheckListDispatcherThreadStub);
-
-    // Start the thread which will dispatch ICE pair checkers, at appropriate pace
+    // Have the scheduler dispatch ICE pair checks, at appropriate pace
     terminating = false;
 
-    status = checkListDispatcherThread->Start(this);
+    status = session->GetScheduler().AddListener(this, CHECK_PACING_INTERVAL_MS);
     if (ER_OK != status) {
         checkListState = CheckStateFailed;
     }
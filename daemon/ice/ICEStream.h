@@ -30,6 +30,7 @@
 #include <qcc/Thread.h>
 #include <qcc/Mutex.h>
 #include "ICECandidatePair.h"
+#include "ICEScheduler.h"
 #include "Status.h"
 #include "RendezvousServerInterface.h"
 
@@ -45,7 +46,7 @@ namespace ajn {
 // Forward Declaration
 class ICESession;
 
-class ICEStream {
+class ICEStream : public ICESchedulerListener {
   public:
 
     /** ICE checks state for stream */
@@ -73,7 +74,6 @@ class ICEStream {
         bandwidthSpecifier(bwSpec),
         checkListState(CheckStateInitial),
         checkList(),
-        checkListDispatcherThread(NULL),
         terminating(false),
         STUNInfo(stunInfo),
         hmacKey(key),
@@ -149,6 +149,11 @@ class ICEStream {
     checkListIterator CheckListBegin(void) { return checkList.begin(); }
     checkListIterator CheckListEnd(void) { return checkList.end(); }
 
+    /**
+     * Called by the ICEScheduler to send the next check on this check list.
+     */
+    PacingResult PacingSlot(void);
+
   private:
 
     bool ChecksFinished(void);
@@ -157,18 +162,6 @@ class ICEStream {
 
     QStatus StartCheckListDispatcher(void);
 
-    void CheckListDispatcher(void);
-
-    // Each active check list will have a thread with this
-    // function as its entry point.
-    static ThreadReturn STDCALL CheckListDispatcherThreadStub(void* pThis)
-    {
-        ICEStream* thisPtr = (ICEStream*)pThis;
-        thisPtr->CheckListDispatcher();
-
-        return 0;
-    }
-
     ICECandidatePair* GetNextCheckPair(void);
 
     void UpdatePairStates(ICECandidatePair* pair);
@@ -183,10 +176,6 @@ class ICEStream {
 
     void SetPairsWaiting(void);
 
-    void GetAllReadyTriggeredCheckPairs(list<ICECandidatePair*>& foundList);
-
-    void GetAllReadyOrdinaryCheckPairs(list<ICECandidatePair*>& foundList, bool& noWaitingPairs);
-
 #ifndef NDEBUG
     void DumpChecklist(void);
 #endif
@@ -201,9 +190,7 @@ class ICEStream {
 
     ICEStreamCheckListState checkListState;
 
-    list<ICECandidatePair*> checkList;
-
-    Thread* checkListDispatcherThread;
+    list<ICECandidatePair*> checkList;     // Kept sorted by descending priority
 
     bool terminating;
 
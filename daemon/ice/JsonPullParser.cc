@@ -0,0 +1,720 @@
+/**
+ * @file JsonPullParser.cc
+ *
+ * Implementation of the incremental JSON parser used to decode the responses received from the
+ * Rendezvous Server.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <qcc/Debug.h>
+
+#include "JsonPullParser.h"
+
+using namespace std;
+using namespace qcc;
+
+/** @internal */
+#define QCC_MODULE "JSON_PULL_PARSER"
+
+namespace ajn {
+
+const size_t JsonPullParser::MAX_DEPTH;
+const size_t JsonPullParser::READ_SIZE;
+
+JsonPullParser::JsonPullParser(const char* json, size_t len) :
+    source(NULL),
+    timeout(0),
+    remaining(0),
+    status(ER_OK),
+    pos(json),
+    end(json + len),
+    text(""),
+    textLen(0),
+    token(JSON_NONE),
+    state(EXPECT_VALUE),
+    depth(0)
+{
+}
+
+JsonPullParser::JsonPullParser(Source& source, size_t len, uint32_t timeout) :
+    source(&source),
+    timeout(timeout),
+    remaining(len),
+    status(ER_OK),
+    pos(readBuf),
+    end(readBuf),
+    text(""),
+    textLen(0),
+    token(JSON_NONE),
+    state(EXPECT_VALUE),
+    depth(0)
+{
+}
+
+QStatus JsonPullParser::Fail(QStatus error)
+{
+    if (status == ER_OK) {
+        status = error;
+        QCC_DbgPrintf(("JsonPullParser failed at depth %u: %s", (unsigned int)depth, QCC_StatusText(status)));
+    }
+    return status;
+}
+
+bool JsonPullParser::Fill()
+{
+    if (pos < end) {
+        return true;
+    }
+    if (!source || (remaining == 0) || (status != ER_OK)) {
+        return false;
+    }
+    size_t actual = 0;
+    QStatus readStatus = source->PullBytes(readBuf, (remaining < READ_SIZE) ? remaining : READ_SIZE, actual, timeout);
+    if ((readStatus != ER_OK) || (actual == 0)) {
+        Fail((readStatus != ER_OK) ? readStatus : ER_JSON_PARSE_ERROR);
+        return false;
+    }
+    remaining -= actual;
+    pos = readBuf;
+    end = readBuf + actual;
+    return true;
+}
+
+int JsonPullParser::GetChar()
+{
+    return Fill() ? (uint8_t)*pos++ : -1;
+}
+
+int JsonPullParser::SkipWhitespace()
+{
+    while (Fill()) {
+        char c = *pos;
+        if ((c != ' ') && (c != '\t') && (c != '\n') && (c != '\r')) {
+            return (uint8_t)c;
+        }
+        ++pos;
+    }
+    return -1;
+}
+
+void JsonPullParser::SetScratchText()
+{
+    text = scratch.empty() ? "" : &scratch[0];
+    textLen = scratch.size();
+}
+
+bool JsonPullParser::TextEquals(const char* str) const
+{
+    return (strlen(str) == textLen) && (memcmp(str, text, textLen) == 0);
+}
+
+QStatus JsonPullParser::ReadHex4(uint32_t& value)
+{
+    value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        int c = GetChar();
+        if ((c >= '0') && (c <= '9')) {
+            value = (value << 4) | (c - '0');
+        } else if ((c >= 'a') && (c <= 'f')) {
+            value = (value << 4) | (c - 'a' + 10);
+        } else if ((c >= 'A') && (c <= 'F')) {
+            value = (value << 4) | (c - 'A' + 10);
+        } else {
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+    return ER_OK;
+}
+
+QStatus JsonPullParser::ReadStringText()
+{
+    bool copied = false;
+    scratch.clear();
+
+    while (true) {
+        /* Find the end of the run of characters that need no decoding */
+        const char* start = pos;
+        while ((pos < end) && (*pos != '"') && (*pos != '\\') && ((uint8_t)*pos >= 0x20)) {
+            ++pos;
+        }
+        if ((pos < end) && (*pos == '"')) {
+            if (copied) {
+                scratch.insert(scratch.end(), start, pos);
+                SetScratchText();
+            } else {
+                text = start;
+                textLen = pos - start;
+            }
+            ++pos;
+            return ER_OK;
+        }
+
+        /* The run ends in an escape sequence or at the end of the input read so far */
+        scratch.insert(scratch.end(), start, pos);
+        copied = true;
+        if (pos == end) {
+            if (!Fill()) {
+                return Fail(ER_JSON_PARSE_ERROR);
+            }
+            continue;
+        }
+        if (*pos != '\\') {
+            /* Unescaped control character */
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+        ++pos;
+
+        int c = GetChar();
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            scratch.push_back((char)c);
+            break;
+
+        case 'b':
+            scratch.push_back('\b');
+            break;
+
+        case 'f':
+            scratch.push_back('\f');
+            break;
+
+        case 'n':
+            scratch.push_back('\n');
+            break;
+
+        case 'r':
+            scratch.push_back('\r');
+            break;
+
+        case 't':
+            scratch.push_back('\t');
+            break;
+
+        case 'u':
+        {
+            uint32_t cp;
+            if (ReadHex4(cp) != ER_OK) {
+                return status;
+            }
+            if ((cp >= 0xD800) && (cp <= 0xDBFF)) {
+                /* The first half of a surrogate pair must be followed by the second half */
+                uint32_t low;
+                if ((GetChar() != '\\') || (GetChar() != 'u') || (ReadHex4(low) != ER_OK) ||
+                    (low < 0xDC00) || (low > 0xDFFF)) {
+                    return Fail(ER_JSON_PARSE_ERROR);
+                }
+                cp = 0x10000 + ((cp & 0x3FF) << 10) + (low & 0x3FF);
+            }
+            /* Encode as UTF-8 */
+            if (cp < 0x80) {
+                scratch.push_back((char)cp);
+            } else if (cp < 0x800) {
+                scratch.push_back((char)(0xC0 | (cp >> 6)));
+                scratch.push_back((char)(0x80 | (cp & 0x3F)));
+            } else if (cp < 0x10000) {
+                scratch.push_back((char)(0xE0 | (cp >> 12)));
+                scratch.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+                scratch.push_back((char)(0x80 | (cp & 0x3F)));
+            } else {
+                scratch.push_back((char)(0xF0 | (cp >> 18)));
+                scratch.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+                scratch.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+                scratch.push_back((char)(0x80 | (cp & 0x3F)));
+            }
+            break;
+        }
+
+        default:
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+}
+
+QStatus JsonPullParser::ReadNumberText()
+{
+    bool copied = false;
+    scratch.clear();
+
+    while (true) {
+        const char* start = pos;
+        while ((pos < end) && (((*pos >= '0') && (*pos <= '9')) || (*pos == '-') || (*pos == '+') ||
+                               (*pos == '.') || (*pos == 'e') || (*pos == 'E'))) {
+            ++pos;
+        }
+        if (pos < end) {
+            if (copied) {
+                scratch.insert(scratch.end(), start, pos);
+                SetScratchText();
+            } else {
+                text = start;
+                textLen = pos - start;
+            }
+            break;
+        }
+        /* The number may continue in the next read */
+        scratch.insert(scratch.end(), start, pos);
+        copied = true;
+        if (!Fill()) {
+            if (status != ER_OK) {
+                return status;
+            }
+            SetScratchText();
+            break;
+        }
+    }
+
+    /* Check the number against the JSON grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+    const char* p = text;
+    const char* e = text + textLen;
+    if ((p < e) && (*p == '-')) {
+        ++p;
+    }
+    if ((p < e) && (*p == '0')) {
+        ++p;
+    } else if ((p < e) && (*p >= '1') && (*p <= '9')) {
+        while ((p < e) && (*p >= '0') && (*p <= '9')) {
+            ++p;
+        }
+    } else {
+        return Fail(ER_JSON_PARSE_ERROR);
+    }
+    if ((p < e) && (*p == '.')) {
+        const char* digits = ++p;
+        while ((p < e) && (*p >= '0') && (*p <= '9')) {
+            ++p;
+        }
+        if (p == digits) {
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+    if ((p < e) && ((*p == 'e') || (*p == 'E'))) {
+        ++p;
+        if ((p < e) && ((*p == '+') || (*p == '-'))) {
+            ++p;
+        }
+        const char* digits = p;
+        while ((p < e) && (*p >= '0') && (*p <= '9')) {
+            ++p;
+        }
+        if (p == digits) {
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+    return (p == e) ? ER_OK : Fail(ER_JSON_PARSE_ERROR);
+}
+
+QStatus JsonPullParser::ReadLiteral(const char* literal)
+{
+    for (const char* l = literal; *l; ++l) {
+        if (GetChar() != (uint8_t)*l) {
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+    text = "";
+    textLen = 0;
+    return ER_OK;
+}
+
+QStatus JsonPullParser::ReadValue(Token& tok)
+{
+    QStatus readStatus = ER_OK;
+    int c = SkipWhitespace();
+
+    text = "";
+    textLen = 0;
+
+    switch (c) {
+    case '{':
+    case '[':
+        if (depth == MAX_DEPTH) {
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+        ++pos;
+        inObject[depth++] = (c == '{');
+        token = (c == '{') ? JSON_BEGIN_OBJECT : JSON_BEGIN_ARRAY;
+        state = (c == '{') ? EXPECT_FIRST_KEY : EXPECT_FIRST_ELEMENT;
+        tok = token;
+        return ER_OK;
+
+    case '"':
+        ++pos;
+        readStatus = ReadStringText();
+        token = JSON_STRING;
+        break;
+
+    case 't':
+        readStatus = ReadLiteral("true");
+        token = JSON_TRUE;
+        break;
+
+    case 'f':
+        readStatus = ReadLiteral("false");
+        token = JSON_FALSE;
+        break;
+
+    case 'n':
+        readStatus = ReadLiteral("null");
+        token = JSON_NULL;
+        break;
+
+    default:
+        if ((c == '-') || ((c >= '0') && (c <= '9'))) {
+            readStatus = ReadNumberText();
+            token = JSON_NUMBER;
+        } else {
+            readStatus = Fail(ER_JSON_PARSE_ERROR);
+        }
+        break;
+    }
+
+    if (readStatus == ER_OK) {
+        state = EXPECT_SEPARATOR;
+        tok = token;
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::Next(Token& tok)
+{
+    while (status == ER_OK) {
+        int c = SkipWhitespace();
+        if (status != ER_OK) {
+            break;
+        }
+
+        switch (state) {
+        case EXPECT_NOTHING:
+            if (c != -1) {
+                return Fail(ER_JSON_PARSE_ERROR);
+            }
+            text = "";
+            textLen = 0;
+            token = JSON_END;
+            tok = token;
+            return ER_OK;
+
+        case EXPECT_COLON:
+            if (c != ':') {
+                return Fail(ER_JSON_PARSE_ERROR);
+            }
+            ++pos;
+            state = EXPECT_VALUE;
+            continue;
+
+        case EXPECT_SEPARATOR:
+            if (depth == 0) {
+                state = EXPECT_NOTHING;
+                continue;
+            }
+            if (c == ',') {
+                ++pos;
+                state = inObject[depth - 1] ? EXPECT_KEY : EXPECT_VALUE;
+                continue;
+            }
+            if ((c == '}') && inObject[depth - 1]) {
+                token = JSON_END_OBJECT;
+            } else if ((c == ']') && !inObject[depth - 1]) {
+                token = JSON_END_ARRAY;
+            } else {
+                return Fail(ER_JSON_PARSE_ERROR);
+            }
+            ++pos;
+            --depth;
+            text = "";
+            textLen = 0;
+            tok = token;
+            return ER_OK;
+
+        case EXPECT_FIRST_KEY:
+            if (c == '}') {
+                ++pos;
+                --depth;
+                text = "";
+                textLen = 0;
+                token = JSON_END_OBJECT;
+                state = EXPECT_SEPARATOR;
+                tok = token;
+                return ER_OK;
+            }
+
+        /* Fall through */
+        case EXPECT_KEY:
+            if (c != '"') {
+                return Fail(ER_JSON_PARSE_ERROR);
+            }
+            ++pos;
+            if (ReadStringText() != ER_OK) {
+                return status;
+            }
+            /* The ':' is read with the next token so the name stays in the read buffer */
+            token = JSON_KEY;
+            state = EXPECT_COLON;
+            tok = token;
+            return ER_OK;
+
+        case EXPECT_FIRST_ELEMENT:
+            if (c == ']') {
+                ++pos;
+                --depth;
+                text = "";
+                textLen = 0;
+                token = JSON_END_ARRAY;
+                state = EXPECT_SEPARATOR;
+                tok = token;
+                return ER_OK;
+            }
+
+        /* Fall through */
+        case EXPECT_VALUE:
+            return ReadValue(tok);
+        }
+    }
+    return status;
+}
+
+QStatus JsonPullParser::EnterObject()
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if ((readStatus == ER_OK) && (tok != JSON_BEGIN_OBJECT)) {
+        readStatus = Fail(ER_JSON_PARSE_ERROR);
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::NextMember(bool& found)
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if (readStatus == ER_OK) {
+        if (tok == JSON_KEY) {
+            found = true;
+        } else if (tok == JSON_END_OBJECT) {
+            found = false;
+        } else {
+            readStatus = Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::EnterArray()
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if ((readStatus == ER_OK) && (tok != JSON_BEGIN_ARRAY)) {
+        readStatus = Fail(ER_JSON_PARSE_ERROR);
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::NextElement(bool& found)
+{
+    if ((status != ER_OK) || (depth == 0) || inObject[depth - 1]) {
+        return Fail(ER_JSON_PARSE_ERROR);
+    }
+    int c = SkipWhitespace();
+    if (status != ER_OK) {
+        return status;
+    }
+    if (c == ']') {
+        Token tok;
+        found = false;
+        return Next(tok);
+    }
+    if (state == EXPECT_SEPARATOR) {
+        if (c != ',') {
+            return Fail(ER_JSON_PARSE_ERROR);
+        }
+        ++pos;
+        state = EXPECT_VALUE;
+    } else if (state != EXPECT_FIRST_ELEMENT) {
+        return Fail(ER_JSON_PARSE_ERROR);
+    }
+    found = true;
+    return ER_OK;
+}
+
+QStatus JsonPullParser::ReadString(String& value)
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if (readStatus == ER_OK) {
+        if (tok == JSON_STRING) {
+            value = GetString();
+        } else {
+            readStatus = Fail(ER_JSON_PARSE_ERROR);
+        }
+    }
+    return readStatus;
+}
+
+int32_t JsonPullParser::TextToInt() const
+{
+    const char* p = text;
+    const char* e = text + textLen;
+    bool negative = false;
+    if ((p < e) && (*p == '-')) {
+        negative = true;
+        ++p;
+    }
+    for (const char* x = p; x < e; ++x) {
+        if ((*x == 'e') || (*x == 'E')) {
+            /* Exponents are rare enough to go through the C library */
+            char buf[64];
+            size_t len = (textLen < sizeof(buf)) ? textLen : sizeof(buf) - 1;
+            memcpy(buf, text, len);
+            buf[len] = 0;
+            double d = strtod(buf, NULL);
+            if (d >= 2147483647.0) {
+                return 2147483647;
+            } else if (d <= -2147483648.0) {
+                return (int32_t)(-2147483647 - 1);
+            }
+            return (int32_t)d;
+        }
+    }
+    int64_t value = 0;
+    while ((p < e) && (*p >= '0') && (*p <= '9')) {
+        if (value <= 2147483648LL) {
+            value = value * 10 + (*p - '0');
+        }
+        ++p;
+    }
+    if (negative) {
+        value = -value;
+    }
+    if (value > 2147483647LL) {
+        value = 2147483647LL;
+    } else if (value < -2147483648LL) {
+        value = -2147483648LL;
+    }
+    return (int32_t)value;
+}
+
+QStatus JsonPullParser::ReadInt(int32_t& value)
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if (readStatus == ER_OK) {
+        switch (tok) {
+        case JSON_NUMBER:
+            value = TextToInt();
+            break;
+
+        case JSON_TRUE:
+            value = 1;
+            break;
+
+        case JSON_FALSE:
+        case JSON_NULL:
+            value = 0;
+            break;
+
+        default:
+            readStatus = Fail(ER_JSON_PARSE_ERROR);
+            break;
+        }
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::ReadBool(bool& value)
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if (readStatus == ER_OK) {
+        switch (tok) {
+        case JSON_TRUE:
+            value = true;
+            break;
+
+        case JSON_FALSE:
+        case JSON_NULL:
+            value = false;
+            break;
+
+        case JSON_NUMBER:
+            /* Any non-zero digit before the exponent makes the number non-zero */
+            value = false;
+            for (size_t i = 0; (i < textLen) && (text[i] != 'e') && (text[i] != 'E'); ++i) {
+                if ((text[i] >= '1') && (text[i] <= '9')) {
+                    value = true;
+                    break;
+                }
+            }
+            break;
+
+        default:
+            readStatus = Fail(ER_JSON_PARSE_ERROR);
+            break;
+        }
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::SkipValue()
+{
+    Token tok;
+    QStatus readStatus = Next(tok);
+    if (readStatus != ER_OK) {
+        return readStatus;
+    }
+    switch (tok) {
+    case JSON_BEGIN_OBJECT:
+    case JSON_BEGIN_ARRAY:
+    {
+        size_t target = depth - 1;
+        while ((readStatus == ER_OK) && (depth > target)) {
+            readStatus = Next(tok);
+        }
+        break;
+    }
+
+    case JSON_STRING:
+    case JSON_NUMBER:
+    case JSON_TRUE:
+    case JSON_FALSE:
+    case JSON_NULL:
+        break;
+
+    default:
+        readStatus = Fail(ER_JSON_PARSE_ERROR);
+        break;
+    }
+    return readStatus;
+}
+
+QStatus JsonPullParser::SkipToEnd()
+{
+    Token tok = token;
+    QStatus readStatus = status;
+    while ((readStatus == ER_OK) && (tok != JSON_END)) {
+        readStatus = Next(tok);
+    }
+    return readStatus;
+}
+
+}
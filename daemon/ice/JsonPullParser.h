@@ -0,0 +1,284 @@
+#ifndef _JSONPULLPARSER_H
+#define _JSONPULLPARSER_H
+/**
+ * @file JsonPullParser.h
+ *
+ * This file defines an incremental JSON parser used to decode the responses received from the
+ * Rendezvous Server.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include JsonPullParser.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/Event.h>
+#include <qcc/Stream.h>
+#include <qcc/String.h>
+
+#include "Status.h"
+
+namespace ajn {
+
+/**
+ * %JsonPullParser reads JSON text one token at a time without building a document tree.
+ *
+ * The caller pulls tokens with Next() or with the helpers that expect a particular structure.
+ * Member names, strings and numbers are returned as text that points straight into the input
+ * whenever possible. The text is only copied into the parser's scratch buffer when it contains
+ * escape sequences or, for a parser reading from a Source, when it straddles two reads. The text
+ * is valid until the next token is pulled.
+ *
+ * The parser checks the complete JSON grammar so a document that has been read up to JSON_END
+ * is known to be well formed.
+ */
+class JsonPullParser {
+  public:
+
+    /** Token types */
+    typedef enum {
+        JSON_NONE,              /**< No token has been read yet */
+        JSON_BEGIN_OBJECT,      /**< '{' */
+        JSON_END_OBJECT,        /**< '}' */
+        JSON_BEGIN_ARRAY,       /**< '[' */
+        JSON_END_ARRAY,         /**< ']' */
+        JSON_KEY,               /**< An object member name, the name is the token text */
+        JSON_STRING,            /**< A string value, the decoded string is the token text */
+        JSON_NUMBER,            /**< A number value, the number is the token text */
+        JSON_TRUE,              /**< true */
+        JSON_FALSE,             /**< false */
+        JSON_NULL,              /**< null */
+        JSON_END                /**< The end of the document */
+    } Token;
+
+    /**
+     * Maximum nesting of objects and arrays.
+     */
+    static const size_t MAX_DEPTH = 32;
+
+    /**
+     * Number of bytes read from a Source at a time.
+     */
+    static const size_t READ_SIZE = 512;
+
+    /**
+     * Construct a parser for JSON text in memory. The text is not copied and must remain valid
+     * for the life of the parser.
+     *
+     * @param json  The JSON text.
+     * @param len   Length of the JSON text.
+     */
+    JsonPullParser(const char* json, size_t len);
+
+    /**
+     * Construct a parser that reads JSON text from a Source.
+     *
+     * @param source   The source, for example the response source of an HttpConnection.
+     * @param len      Number of bytes of JSON text to read from the source.
+     * @param timeout  Timeout in milliseconds for each read from the source.
+     */
+    JsonPullParser(qcc::Source& source, size_t len, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Read the next token.
+     *
+     * @param token  Returns the token.
+     *
+     * @return  ER_OK if a token was read, ER_JSON_PARSE_ERROR if the text is malformed or an error
+     *          status from the Source.
+     */
+    QStatus Next(Token& token);
+
+    /**
+     * Get the type of the last token read.
+     */
+    Token GetToken() const { return token; }
+
+    /**
+     * Get the text of the last JSON_KEY, JSON_STRING or JSON_NUMBER token. It is not nul
+     * terminated.
+     */
+    const char* GetText() const { return text; }
+
+    /**
+     * Get the length of the text of the last token.
+     */
+    size_t GetTextLength() const { return textLen; }
+
+    /**
+     * Compare the text of the last token with a nul terminated string.
+     *
+     * @param str  The string.
+     *
+     * @return  true if the text matches.
+     */
+    bool TextEquals(const char* str) const;
+
+    /**
+     * Get the text of the last token as a String.
+     */
+    qcc::String GetString() const { return qcc::String(text, textLen); }
+
+    /**
+     * Read the '{' that must start the next value.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR if the next value is not an object.
+     */
+    QStatus EnterObject();
+
+    /**
+     * Read the name of the next member of the object being read. The member name is the token
+     * text and the member value must be read or skipped before the next call.
+     *
+     * @param found  Returns true if there is a member, false if the end of the object was read.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR.
+     */
+    QStatus NextMember(bool& found);
+
+    /**
+     * Read the '[' that must start the next value.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR if the next value is not an array.
+     */
+    QStatus EnterArray();
+
+    /**
+     * Check for another element of the array being read. The element must be read or skipped
+     * before the next call.
+     *
+     * @param found  Returns true if there is an element, false if the end of the array was read.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR.
+     */
+    QStatus NextElement(bool& found);
+
+    /**
+     * Read a string value.
+     *
+     * @param value  Returns the string.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR if the next value is not a string.
+     */
+    QStatus ReadString(qcc::String& value);
+
+    /**
+     * Read an integer value. A fractional part is discarded and true and false read as 1 and 0.
+     *
+     * @param value  Returns the integer.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR if the next value is not a number or boolean.
+     */
+    QStatus ReadInt(int32_t& value);
+
+    /**
+     * Read a boolean value. A number reads as true if it is not zero.
+     *
+     * @param value  Returns the boolean.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR if the next value is not a boolean or number.
+     */
+    QStatus ReadBool(bool& value);
+
+    /**
+     * Skip the next value including everything nested in it.
+     *
+     * @return  ER_OK or ER_JSON_PARSE_ERROR.
+     */
+    QStatus SkipValue();
+
+    /**
+     * Read the remaining tokens to check that the rest of the document is well formed.
+     *
+     * @return  ER_OK if the document is well formed.
+     */
+    QStatus SkipToEnd();
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    JsonPullParser(const JsonPullParser& other);
+    JsonPullParser& operator=(const JsonPullParser& other);
+
+    /** What the grammar allows next */
+    typedef enum {
+        EXPECT_VALUE,           /**< A value */
+        EXPECT_FIRST_KEY,       /**< A member name or the end of an empty object */
+        EXPECT_KEY,             /**< A member name */
+        EXPECT_COLON,           /**< The ':' after a member name */
+        EXPECT_FIRST_ELEMENT,   /**< A value or the end of an empty array */
+        EXPECT_SEPARATOR,       /**< A ',' or the end of the enclosing object or array */
+        EXPECT_NOTHING          /**< The document has ended */
+    } State;
+
+    /** Record an error, returns the first error recorded */
+    QStatus Fail(QStatus error);
+
+    /** Make sure there is input to read, returns false at the end of the text */
+    bool Fill();
+
+    /** Read one character, returns -1 at the end of the text */
+    int GetChar();
+
+    /** Read the four hex digits of a \u escape */
+    QStatus ReadHex4(uint32_t& value);
+
+    /** Point the token text at the scratch buffer */
+    void SetScratchText();
+
+    /** Skip white space, returns the next character or -1 at the end of the text */
+    int SkipWhitespace();
+
+    /** Read a string, the opening quote has been read */
+    QStatus ReadStringText();
+
+    /** Read a number */
+    QStatus ReadNumberText();
+
+    /** Read the rest of a literal such as "true" */
+    QStatus ReadLiteral(const char* literal);
+
+    /** Read a value that starts with the character at the current position */
+    QStatus ReadValue(Token& token);
+
+    /** Parse the token text as an integer */
+    int32_t TextToInt() const;
+
+    qcc::Source* source;            /**< Source of the text or NULL if it is in memory */
+    uint32_t timeout;               /**< Timeout for reads from the source */
+    size_t remaining;               /**< Bytes still to be read from the source */
+    QStatus status;                 /**< ER_OK or the first error, which is returned from then on */
+    const char* pos;                /**< Next character to parse */
+    const char* end;                /**< End of the text that has been read */
+    char readBuf[READ_SIZE];        /**< Text read from the source */
+    std::vector<char> scratch;      /**< Token text that could not be returned in place */
+    const char* text;               /**< Text of the last token */
+    size_t textLen;                 /**< Length of the text of the last token */
+    Token token;                    /**< The last token */
+    State state;                    /**< What the grammar allows next */
+    size_t depth;                   /**< Number of open objects and arrays */
+    bool inObject[MAX_DEPTH];       /**< true for an open object, false for an open array */
+};
+
+}
+
+#endif
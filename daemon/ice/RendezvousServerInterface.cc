@@ -25,6 +25,7 @@
 #include <qcc/Crypto.h>
 #include <qcc/StringUtil.h>
 #include "RendezvousServerInterface.h"
+#include "JsonPullParser.h"
 
 using namespace std;
 
@@ -395,22 +396,33 @@ String GenerateJSONCandidates(ICECandidatesMessage message)
 /**
  * Worker function used to parse a generic response
  */
-QStatus ParseGenericResponse(Json::Value receivedResponse, GenericResponse& parsedResponse)
+QStatus ParseGenericResponse(const String& receivedResponse, GenericResponse& parsedResponse)
 {
-    QStatus status = ER_OK;
-
-    Json::StaticString peerID("peerID");
-
-    if (receivedResponse.isMember(peerID)) {
-
-        parsedResponse.peerID = String(receivedResponse[peerID].asCString());
-        QCC_DbgPrintf(("ParseGenericResponse(): peerID = %s", receivedResponse[peerID].asCString()));
-
-    } else {
+    JsonPullParser parser(receivedResponse.data(), receivedResponse.size());
+    bool peerIDFound = false;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("peerID")) {
+            peerIDFound = true;
+            status = parser.ReadString(parsedResponse.peerID);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
 
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ParseGenericResponse(): Unable to read the response"));
+    } else if (!peerIDFound) {
         status = ER_FAIL;
         QCC_LogError(status, ("ParseGenericResponse(): Message does not seem to be a generic response"));
-
+    } else {
+        QCC_DbgPrintf(("ParseGenericResponse(): peerID = %s", parsedResponse.peerID.c_str()));
     }
 
     return status;
@@ -419,38 +431,52 @@ QStatus ParseGenericResponse(Json::Value receivedResponse, GenericResponse& pars
 /**
  * Worker function used to parse a refresh token response
  */
-QStatus ParseTokenRefreshResponse(Json::Value receivedResponse, TokenRefreshResponse& parsedResponse)
+QStatus ParseTokenRefreshResponse(const String& receivedResponse, TokenRefreshResponse& parsedResponse)
 {
-    QStatus status = ER_OK;
-
-    Json::StaticString acct("acct");
-    Json::StaticString pwd("pwd");
-    Json::StaticString expiryTime("expiryTime");
-
-    if (receivedResponse.isMember(acct)) {
-        if (receivedResponse.isMember(pwd)) {
-            if (receivedResponse.isMember(expiryTime)) {
-                parsedResponse.acct = String(receivedResponse[acct].asCString());
-                QCC_DbgPrintf(("ParseTokenRefreshResponse(): acct = %s", receivedResponse[acct].asCString()));
-
-                parsedResponse.pwd = String(receivedResponse[pwd].asCString());
-                QCC_DbgPrintf(("ParseTokenRefreshResponse(): pwd = %s", receivedResponse[pwd].asCString()));
-
-                parsedResponse.expiryTime = receivedResponse[expiryTime].asInt();
-                QCC_DbgPrintf(("ParseTokenRefreshResponse(): expiryTime = %d", receivedResponse[expiryTime].asInt()));
-
-                parsedResponse.recvTime = GetTimestamp();;
-            } else {
-                status = ER_FAIL;
-                QCC_LogError(status, ("ParseTokenRefreshResponse(): Message does not seem to have a expiryTime token"));
-            }
+    JsonPullParser parser(receivedResponse.data(), receivedResponse.size());
+    bool acctFound = false;
+    bool pwdFound = false;
+    bool expiryTimeFound = false;
+    int32_t expiryTime = 0;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("acct")) {
+            acctFound = true;
+            status = parser.ReadString(parsedResponse.acct);
+        } else if (parser.TextEquals("pwd")) {
+            pwdFound = true;
+            status = parser.ReadString(parsedResponse.pwd);
+        } else if (parser.TextEquals("expiryTime")) {
+            expiryTimeFound = true;
+            status = parser.ReadInt(expiryTime);
         } else {
-            status = ER_FAIL;
-            QCC_LogError(status, ("ParseTokenRefreshResponse(): Message does not seem to have a pwd token"));
+            status = parser.SkipValue();
         }
-    } else {
+    }
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ParseTokenRefreshResponse(): Unable to read the response"));
+    } else if (!acctFound) {
         status = ER_FAIL;
         QCC_LogError(status, ("ParseTokenRefreshResponse(): Message does not seem to have a acct token"));
+    } else if (!pwdFound) {
+        status = ER_FAIL;
+        QCC_LogError(status, ("ParseTokenRefreshResponse(): Message does not seem to have a pwd token"));
+    } else if (!expiryTimeFound) {
+        status = ER_FAIL;
+        QCC_LogError(status, ("ParseTokenRefreshResponse(): Message does not seem to have a expiryTime token"));
+    } else {
+        QCC_DbgPrintf(("ParseTokenRefreshResponse(): acct = %s", parsedResponse.acct.c_str()));
+        QCC_DbgPrintf(("ParseTokenRefreshResponse(): pwd = %s", parsedResponse.pwd.c_str()));
+        QCC_DbgPrintf(("ParseTokenRefreshResponse(): expiryTime = %d", expiryTime));
+        parsedResponse.expiryTime = expiryTime;
+        parsedResponse.recvTime = GetTimestamp();
     }
 
     return status;
@@ -554,479 +580,710 @@ void PrintMessageResponse(Response msg)
 }
 
 
+/*
+ * The members of the objects in a messages response may arrive in any order. The objects are
+ * read into the structures below, unknown members are skipped, and the structures are checked
+ * once the enclosing message has been read.
+ */
+
 /**
- * Worker function used to parse a message response
+ * A STUNInfo object as read from a messages response.
+ */
+struct STUNInfoMembers {
+    bool found;
+    bool addressFound;
+    bool portFound;
+    bool acctFound;
+    bool pwdFound;
+    bool expiryTimeFound;
+    bool relayFound;
+    bool relayAddressFound;
+    bool relayPortFound;
+    String address;
+    String acct;
+    String pwd;
+    String relayAddress;
+    int32_t port;
+    int32_t expiryTime;
+    int32_t relayPort;
+
+    STUNInfoMembers() : found(false), addressFound(false), portFound(false), acctFound(false), pwdFound(false),
+        expiryTimeFound(false), relayFound(false), relayAddressFound(false), relayPortFound(false),
+        port(0), expiryTime(0), relayPort(0) { }
+};
+
+/**
+ * A match object as read from a messages response.
  */
-QStatus ParseMessagesResponse(Json::Value receivedResponse, ResponseMessage& parsedResponse)
+struct MatchMembers {
+    bool found;
+    bool matchIDFound;
+    bool serviceFound;
+    bool peerAddrFound;
+    SearchMatchResponse match;
+    STUNInfoMembers STUNInfo;
+
+    MatchMembers() : found(false), matchIDFound(false), serviceFound(false), peerAddrFound(false) { }
+};
+
+/**
+ * An addressCandidates object as read from a messages response. Only the candidates that have
+ * all the required members are kept.
+ */
+struct AddressCandidatesMembers {
+    bool found;
+    bool matchIDFound;
+    bool sourceFound;
+    bool destinationFound;
+    bool peerAddrFound;
+    bool ice_ufragFound;
+    bool ice_pwdFound;
+    bool candidatesFound;
+    bool invalidCandidateFound;
+    AddressCandidatesResponse addressCandidates;
+    STUNInfoMembers STUNInfo;
+
+    AddressCandidatesMembers() : found(false), matchIDFound(false), sourceFound(false), destinationFound(false),
+        peerAddrFound(false), ice_ufragFound(false), ice_pwdFound(false), candidatesFound(false),
+        invalidCandidateFound(false) { }
+};
+
+/**
+ * A matchRevoked object as read from a messages response.
+ */
+struct MatchRevokedMembers {
+    bool found;
+    bool peerAddrFound;
+    bool deleteAllFound;
+    bool servicesFound;
+    MatchRevokedResponse matchRevoked;
+
+    MatchRevokedMembers() : found(false), peerAddrFound(false), deleteAllFound(false), servicesFound(false) { }
+};
+
+/**
+ * A startICEChecks object as read from a messages response.
+ */
+struct StartICEChecksMembers {
+    bool found;
+    bool peerAddrFound;
+    StartICEChecksResponse startICEChecks;
+
+    StartICEChecksMembers() : found(false), peerAddrFound(false) { }
+};
+
+/**
+ * Worker function used to read the relay member of a STUNInfo object
+ */
+static QStatus ReadRelay(JsonPullParser& parser, STUNInfoMembers& members)
 {
-    QStatus status = ER_OK;
+    members.relayFound = true;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("address")) {
+            members.relayAddressFound = true;
+            status = parser.ReadString(members.relayAddress);
+        } else if (parser.TextEquals("port")) {
+            members.relayPortFound = true;
+            status = parser.ReadInt(members.relayPort);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    return status;
+}
 
-    Json::StaticString msgs("msgs");
-    Json::StaticString service("service");
-    Json::StaticString type("type");
-    Json::StaticString match("match");
-    Json::StaticString matchID("matchID");
-    Json::StaticString peerID("peerID");
-    Json::StaticString ice_ufrag("ice-ufrag");
-    Json::StaticString ice_pwd("ice-pwd");
-    Json::StaticString peerAddr("peerAddr");
-    Json::StaticString STUNInfo("STUNInfo");
-    Json::StaticString address("address");
-    Json::StaticString port("port");
-    Json::StaticString relay("relay");
-    Json::StaticString acct("acct");
-    Json::StaticString pwd("pwd");
-    Json::StaticString expiryTime("expiryTime");
-    Json::StaticString addressCandidates("addressCandidates");
-    Json::StaticString source("source");
-    Json::StaticString destination("destination");
-    Json::StaticString candidates("candidates");
-    Json::StaticString transport("transport");
-    Json::StaticString priority("priority");
-    Json::StaticString raddress("raddress");
-    Json::StaticString rport("rport");
-    Json::StaticString matchRevoked("matchRevoked");
-    Json::StaticString services("services");
-    Json::StaticString deleteAll("deleteAll");
-    Json::StaticString foundation("foundation");
-    Json::StaticString componentID("componentID");
-    Json::StaticString startICEChecks("startICEChecks");
+/**
+ * Worker function used to read a STUNInfo object
+ */
+static QStatus ReadSTUNInfo(JsonPullParser& parser, STUNInfoMembers& members)
+{
+    members.found = true;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("address")) {
+            members.addressFound = true;
+            status = parser.ReadString(members.address);
+        } else if (parser.TextEquals("port")) {
+            members.portFound = true;
+            status = parser.ReadInt(members.port);
+        } else if (parser.TextEquals("acct")) {
+            members.acctFound = true;
+            status = parser.ReadString(members.acct);
+        } else if (parser.TextEquals("pwd")) {
+            members.pwdFound = true;
+            status = parser.ReadString(members.pwd);
+        } else if (parser.TextEquals("expiryTime")) {
+            members.expiryTimeFound = true;
+            status = parser.ReadInt(members.expiryTime);
+        } else if (parser.TextEquals("relay")) {
+            status = ReadRelay(parser, members);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    return status;
+}
 
-    Response tempMsg;
+/**
+ * Worker function used to check a STUNInfo object that has been read and to
+ * fill in the STUN server info from it
+ */
+static QStatus SetSTUNInfo(const STUNInfoMembers& members, const char* context, const char* responseName,
+                           bool allowHostNames, STUNServerInfo& info)
+{
+    QStatus status = ER_FAIL;
+
+    if (!members.addressFound) {
+        QCC_LogError(status, ("ParseMessagesResponse(): %s[STUNInfo][address] member not found", context));
+    } else if (!members.acctFound) {
+        QCC_LogError(status, ("ParseMessagesResponse(): %s[STUNInfo][acct] member not found", context));
+    } else if (!members.pwdFound) {
+        QCC_LogError(status, ("ParseMessagesResponse(): %s[STUNInfo][pwd] member not found", context));
+    } else if (!members.expiryTimeFound) {
+        QCC_LogError(status, ("ParseMessagesResponse(): %s[STUNInfo][expiryTime] member not found", context));
+    } else if (members.relayFound && !members.relayAddressFound) {
+        QCC_LogError(status, ("ParseMessagesResponse(): %s[STUNInfo][relay][address] member not found", context));
+    } else if (members.relayFound && !members.relayPortFound) {
+        QCC_LogError(status, ("ParseMessagesResponse(): %s[STUNInfo][relay][port] member not found", context));
+    } else {
+        status = allowHostNames ? info.address.SetAddress(members.address, true) : info.address.SetAddress(members.address);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("ParseMessagesResponse(): Invalid STUN Server address specified in %s response", responseName));
+            return status;
+        }
 
-    if (receivedResponse.empty()) {
-        status = ER_FAIL;
-        QCC_LogError(status, ("ParseMessagesResponse(): Message is empty"));
-    } else if (receivedResponse.isMember(msgs)) {
-        Json::Value msgsObj = receivedResponse[msgs];
-        if (msgsObj.isArray()) {
-            if (!msgsObj.empty()) {
-                for (Json::UInt j = 0; j < msgsObj.size(); j++) {
-                    Json::Value msgsObjArrayMember = msgsObj[j];
-
-                    if (msgsObjArrayMember[type] == "match") {
-                        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Match Message", j));
-
-                        if (msgsObjArrayMember.isMember(match)) {
-
-                            Json::Value matchObj = msgsObjArrayMember[match];
-
-                            if (matchObj.isMember(matchID)) {
-                                if (matchObj.isMember(service)) {
-                                    if (matchObj.isMember(peerAddr)) {
-                                        if (matchObj.isMember(STUNInfo)) {
-
-                                            Json::Value STUNInfoObj = matchObj[STUNInfo];
-
-                                            if (STUNInfoObj.isMember(address)) {
-                                                if (STUNInfoObj.isMember(acct)) {
-                                                    if (STUNInfoObj.isMember(pwd)) {
-                                                        if (STUNInfoObj.isMember(expiryTime)) {
-                                                            tempMsg.type = SEARCH_MATCH_RESPONSE;
-                                                            SearchMatchResponse* SearchMatch = new SearchMatchResponse();
-                                                            SearchMatch->matchID = String(matchObj[matchID].asCString());
-                                                            SearchMatch->service = String(matchObj[service].asCString());
-                                                            SearchMatch->peerAddr = String(matchObj[peerAddr].asCString());
-                                                            status = SearchMatch->STUNInfo.address.SetAddress(String(STUNInfoObj[address].asCString()), true);
-                                                            if (status != ER_OK) {
-                                                                QCC_LogError(status, ("ParseMessagesResponse(): Invalid STUN Server address specified in Search Match response"));
-                                                                return status;
-                                                            }
-                                                            if (STUNInfoObj.isMember(port)) {
-                                                                SearchMatch->STUNInfo.port = STUNInfoObj[port].asInt();
-                                                            } else {
-                                                                QCC_DbgPrintf(("ParseMessagesResponse(): Setting the port to default value as match[STUNInfo][port] member was not found"));
-                                                            }
-                                                            SearchMatch->STUNInfo.acct = String(STUNInfoObj[acct].asCString());
-                                                            SearchMatch->STUNInfo.pwd = String(STUNInfoObj[pwd].asCString());
-                                                            SearchMatch->STUNInfo.expiryTime = ((STUNInfoObj[expiryTime].asInt()) - TURN_TOKEN_EXPIRY_TIME_BUFFER_IN_SECONDS) * 1000;
-                                                            SearchMatch->STUNInfo.recvTime = GetTimestamp();
-
-                                                            if (STUNInfoObj.isMember(relay)) {
-                                                                Json::Value relayObj = STUNInfoObj[relay];
-
-                                                                if (relayObj.isMember(address)) {
-                                                                    if (relayObj.isMember(port)) {
-                                                                        SearchMatch->STUNInfo.relayInfoPresent = true;
-                                                                        status = SearchMatch->STUNInfo.relay.address.SetAddress(String(relayObj[address].asCString()));
-                                                                        if (status != ER_OK) {
-                                                                            QCC_LogError(status, ("ParseMessagesResponse(): Invalid Relay Server address specified in Search Match response"));
-                                                                            return status;
-                                                                        }
-                                                                        SearchMatch->STUNInfo.relay.port = relayObj[port].asInt();
-
-                                                                        tempMsg.response = static_cast<SearchMatchResponse*>(SearchMatch);
-
-                                                                        parsedResponse.msgs.push_back(tempMsg);
-                                                                        PrintMessageResponse(tempMsg);
-                                                                    } else {
-                                                                        status = ER_FAIL;
-                                                                        QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo][relay][port] member not found"));
-                                                                    }
-                                                                } else {
-                                                                    status = ER_FAIL;
-                                                                    QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo][relay][address] member not found"));
-                                                                }
-                                                            } else {
-                                                                tempMsg.response = static_cast<SearchMatchResponse*>(SearchMatch);
-                                                                parsedResponse.msgs.push_back(tempMsg);
-                                                                PrintMessageResponse(tempMsg);
-                                                                QCC_DbgPrintf(("ParseMessagesResponse(): match[STUNInfo][relay] member not found"));
-                                                            }
-                                                        } else {
-                                                            status = ER_FAIL;
-                                                            QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo][expiryTime] member not found"));
-                                                        }
-                                                    } else {
-                                                        status = ER_FAIL;
-                                                        QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo][pwd] member not found"));
-                                                    }
-                                                } else {
-                                                    status = ER_FAIL;
-                                                    QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo][acct] member not found"));
-                                                }
-                                            } else {
-                                                status = ER_FAIL;
-                                                QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo][address] member not found"));
-                                            }
-                                        } else {
-                                            status = ER_FAIL;
-                                            QCC_LogError(status, ("ParseMessagesResponse(): match[STUNInfo] member not found"));
-                                        }
-                                    } else {
-                                        status = ER_FAIL;
-                                        QCC_LogError(status, ("ParseMessagesResponse(): match[peerAddr] member not found"));
-                                    }
-                                } else {
-                                    status = ER_FAIL;
-                                    QCC_LogError(status, ("ParseMessagesResponse(): match[service] member not found"));
-                                }
-                            } else {
-                                status = ER_FAIL;
-                                QCC_LogError(status, ("ParseMessagesResponse(): match[matchID] member not found"));
-                            }
-                        } else {
-                            status = ER_FAIL;
-                            QCC_LogError(status, ("ParseMessagesResponse(): match member not found"));
-                        }
-                    } else if (msgsObjArrayMember[type] == "addressCandidates") {
-                        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Address Candidates Message", j));
-
-                        if (msgsObjArrayMember.isMember(addressCandidates)) {
-                            Json::Value addressCandidatesObj = msgsObjArrayMember[addressCandidates];
-
-                            ICECandidates tempCandidateMsg;
-
-                            if (addressCandidatesObj.isMember(matchID)) {
-                                if (addressCandidatesObj.isMember(source)) {
-                                    if (addressCandidatesObj.isMember(destination)) {
-                                        if (addressCandidatesObj.isMember(peerAddr)) {
-                                            if (addressCandidatesObj.isMember(ice_ufrag)) {
-                                                if (addressCandidatesObj.isMember(ice_pwd)) {
-                                                    tempMsg.type = ADDRESS_CANDIDATES_RESPONSE;
-                                                    AddressCandidatesResponse* AddressCandidates = new AddressCandidatesResponse();
-                                                    AddressCandidates->source = String(addressCandidatesObj[source].asCString());
-                                                    AddressCandidates->destination = String(addressCandidatesObj[destination].asCString());
-                                                    AddressCandidates->peerAddr = String(addressCandidatesObj[peerAddr].asCString());
-                                                    AddressCandidates->matchID = String(addressCandidatesObj[matchID].asCString());
-                                                    AddressCandidates->ice_ufrag = String(addressCandidatesObj[ice_ufrag].asCString());
-                                                    AddressCandidates->ice_pwd = String(addressCandidatesObj[ice_pwd].asCString());
-
-                                                    if (addressCandidatesObj.isMember(candidates)) {
-                                                        Json::Value candidatesObj = addressCandidatesObj[candidates];
-
-                                                        if (candidatesObj.isArray()) {
-                                                            if (!candidatesObj.empty()) {
-                                                                for (Json::UInt k = 0; k < candidatesObj.size(); k++) {
-
-                                                                    Json::Value candidatesObjArrayMember = candidatesObj[k];
-
-                                                                    if (candidatesObjArrayMember.isMember(type)) {
-                                                                        if (candidatesObjArrayMember.isMember(foundation)) {
-                                                                            if (candidatesObjArrayMember.isMember(componentID)) {
-                                                                                if (candidatesObjArrayMember.isMember(transport)) {
-                                                                                    if (candidatesObjArrayMember.isMember(priority)) {
-                                                                                        if (candidatesObjArrayMember.isMember(address)) {
-                                                                                            if (candidatesObjArrayMember.isMember(port)) {
-                                                                                                tempCandidateMsg.type = GetICECandidateTypeValue(String(candidatesObjArrayMember[type].asCString()));
-                                                                                                tempCandidateMsg.foundation = String(candidatesObjArrayMember[foundation].asCString());
-                                                                                                tempCandidateMsg.componentID = candidatesObjArrayMember[componentID].asInt();
-                                                                                                tempCandidateMsg.transport = GetICETransportTypeValue(String(candidatesObjArrayMember[transport].asCString()));
-                                                                                                tempCandidateMsg.priority = candidatesObjArrayMember[priority].asInt();
-                                                                                                tempCandidateMsg.address = IPAddress(String(candidatesObjArrayMember[address].asCString()));
-                                                                                                tempCandidateMsg.port = candidatesObjArrayMember[port].asInt();
-
-                                                                                                if (tempCandidateMsg.type != HOST_CANDIDATE) {
-                                                                                                    if (candidatesObjArrayMember.isMember(raddress)) {
-                                                                                                        if (candidatesObjArrayMember.isMember(rport)) {
-                                                                                                            tempCandidateMsg.raddress = IPAddress(String(candidatesObjArrayMember[raddress].asCString()));
-                                                                                                            tempCandidateMsg.rport = candidatesObjArrayMember[rport].asInt();
-
-                                                                                                            AddressCandidates->candidates.push_back(tempCandidateMsg);
-                                                                                                        } else {
-                                                                                                            status = ER_FAIL;
-                                                                                                            QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][rport] member not found for "
-                                                                                                                                  "candidate type %s", candidatesObjArrayMember[type].asCString()));
-                                                                                                        }
-
-                                                                                                    } else {
-                                                                                                        status = ER_FAIL;
-                                                                                                        QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][raddress] member not found for "
-                                                                                                                              "candidate type %s", candidatesObjArrayMember[type].asCString()));
-                                                                                                    }
-                                                                                                } else {
-                                                                                                    AddressCandidates->candidates.push_back(tempCandidateMsg);
-                                                                                                }
-
-                                                                                            } else {
-                                                                                                status = ER_FAIL;
-                                                                                                QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][port] member not found"));
-                                                                                            }
-
-                                                                                        } else {
-                                                                                            status = ER_FAIL;
-                                                                                            QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][address] member not found"));
-                                                                                        }
-
-                                                                                    } else {
-                                                                                        status = ER_FAIL;
-                                                                                        QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][priority] member not found"));
-                                                                                    }
-
-                                                                                } else {
-                                                                                    status = ER_FAIL;
-                                                                                    QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][transport] member not found"));
-                                                                                }
-
-                                                                            } else {
-                                                                                status = ER_FAIL;
-                                                                                QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][componentID] member not found"));
-                                                                            }
-
-                                                                        } else {
-                                                                            status = ER_FAIL;
-                                                                            QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][foundation] member not found"));
-                                                                        }
-                                                                    } else {
-                                                                        status = ER_FAIL;
-                                                                        QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates][type] member not found"));
-                                                                    }
-                                                                }
-
-                                                                if (!AddressCandidates->candidates.empty()) {
-                                                                    if (addressCandidatesObj.isMember(STUNInfo)) {
-                                                                        Json::Value STUNInfoObj = addressCandidatesObj[STUNInfo];
-
-                                                                        if (STUNInfoObj.isMember(address)) {
-                                                                            if (STUNInfoObj.isMember(acct)) {
-                                                                                if (STUNInfoObj.isMember(pwd)) {
-                                                                                    if (STUNInfoObj.isMember(expiryTime)) {
-                                                                                        AddressCandidates->STUNInfoPresent = true;
-                                                                                        status = AddressCandidates->STUNInfo.address.SetAddress(String(STUNInfoObj[address].asCString()));
-
-                                                                                        if (status != ER_OK) {
-                                                                                            QCC_LogError(status, ("ParseMessagesResponse(): Invalid STUN Server address specified in Address Candidates response"));
-                                                                                            return status;
-                                                                                        }
-
-                                                                                        if (STUNInfoObj.isMember(port)) {
-                                                                                            AddressCandidates->STUNInfo.port = STUNInfoObj[port].asInt();
-                                                                                        } else {
-                                                                                            QCC_DbgPrintf(("ParseMessagesResponse(): Set port to the default value as the member addressCandidates[STUNInfo][port] was not found"));
-                                                                                        }
-
-                                                                                        AddressCandidates->STUNInfo.acct = String(STUNInfoObj[acct].asCString());
-                                                                                        AddressCandidates->STUNInfo.pwd = String(STUNInfoObj[pwd].asCString());
-                                                                                        AddressCandidates->STUNInfo.expiryTime = ((STUNInfoObj[expiryTime].asInt()) - TURN_TOKEN_EXPIRY_TIME_BUFFER_IN_SECONDS) * 1000;
-                                                                                        AddressCandidates->STUNInfo.recvTime = GetTimestamp();
-
-                                                                                        if (STUNInfoObj.isMember(relay)) {
-
-                                                                                            Json::Value relayObj = STUNInfoObj[relay];
-
-                                                                                            if (relayObj.isMember(address)) {
-                                                                                                if (relayObj.isMember(port)) {
-                                                                                                    AddressCandidates->STUNInfo.relayInfoPresent = true;
-                                                                                                    status = AddressCandidates->STUNInfo.relay.address.SetAddress(String(relayObj[address].asCString()));
-
-                                                                                                    if (status != ER_OK) {
-                                                                                                        QCC_LogError(status, ("ParseMessagesResponse(): Invalid Relay Server address specified in Address Candidates response"));
-                                                                                                        return status;
-                                                                                                    }
-
-                                                                                                    AddressCandidates->STUNInfo.relay.port = relayObj[port].asInt();
-
-                                                                                                    tempMsg.response = static_cast<AddressCandidatesResponse*>(AddressCandidates);
-                                                                                                    parsedResponse.msgs.push_back(tempMsg);
-                                                                                                    PrintMessageResponse(tempMsg);
-                                                                                                } else {
-                                                                                                    status = ER_FAIL;
-                                                                                                    QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[STUNInfo][relay][port] member not found"));
-                                                                                                }
-                                                                                            } else {
-                                                                                                status = ER_FAIL;
-                                                                                                QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[STUNInfo][relay][address] member not found"));
-                                                                                            }
-                                                                                        } else {
-                                                                                            tempMsg.response = static_cast<AddressCandidatesResponse*>(AddressCandidates);
-                                                                                            parsedResponse.msgs.push_back(tempMsg);
-                                                                                            PrintMessageResponse(tempMsg);
-                                                                                            QCC_DbgPrintf(("ParseMessagesResponse(): addressCandidates[STUNInfo][relay] member not found"));
-                                                                                        }
-                                                                                    } else {
-                                                                                        status = ER_FAIL;
-                                                                                        QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[STUNInfo][expiryTime] member not found"));
-                                                                                    }
-                                                                                } else {
-                                                                                    status = ER_FAIL;
-                                                                                    QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[STUNInfo][pwd] member not found"));
-                                                                                }
-                                                                            } else {
-                                                                                status = ER_FAIL;
-                                                                                QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[STUNInfo][acct] member not found"));
-                                                                            }
-                                                                        } else {
-                                                                            status = ER_FAIL;
-                                                                            QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[STUNInfo][address] member not found"));
-                                                                        }
-
-                                                                    } else {
-                                                                        tempMsg.response = static_cast<AddressCandidatesResponse*>(AddressCandidates);
-                                                                        parsedResponse.msgs.push_back(tempMsg);
-                                                                        PrintMessageResponse(tempMsg);
-                                                                        QCC_DbgPrintf(("ParseMessagesResponse(): addressCandidates[STUNInfo] member not found"));
-                                                                    }
-                                                                }
-                                                            }
-                                                        }
-                                                    } else {
-                                                        status = ER_FAIL;
-                                                        QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[candidates] member not found"));
-                                                    }
-                                                } else {
-                                                    status = ER_FAIL;
-                                                    QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[ice-pwd] member not found"));
-                                                }
-                                            } else {
-                                                status = ER_FAIL;
-                                                QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[ice-ufrag] member not found"));
-                                            }
-                                        } else {
-                                            status = ER_FAIL;
-                                            QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[peerAddr] member not found"));
-                                        }
-                                    } else {
-                                        status = ER_FAIL;
-                                        QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[destination] member not found"));
-                                    }
-                                } else {
-                                    status = ER_FAIL;
-                                    QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[source] member not found"));
-                                }
-                            } else {
-                                status = ER_FAIL;
-                                QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates[matchID] member not found"));
-                            }
-                        } else {
-                            status = ER_FAIL;
-                            QCC_LogError(status, ("ParseMessagesResponse(): addressCandidates member not found"));
-                        }
-                    } else if (msgsObjArrayMember[type] == "matchRevoked") {
-                        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Match Revoked Message", j));
-
-                        if (msgsObjArrayMember.isMember(matchRevoked)) {
-                            Json::Value revokeObj = msgsObjArrayMember[matchRevoked];
-
-                            if (revokeObj.isMember(peerAddr)) {
-                                tempMsg.type = MATCH_REVOKED_RESPONSE;
-                                MatchRevokedResponse* MatchRevoked = new MatchRevokedResponse();
-                                MatchRevoked->peerAddr = String(revokeObj[peerAddr].asCString());
-
-                                if (revokeObj.isMember(deleteAll)) {
-                                    MatchRevoked->deleteAll = revokeObj[deleteAll].asBool();
-
-                                    if (MatchRevoked->deleteAll) {
-                                        tempMsg.response = static_cast<MatchRevokedResponse*>(MatchRevoked);
-                                        parsedResponse.msgs.push_back(tempMsg);
-                                        PrintMessageResponse(tempMsg);
-                                    }
-                                }
-
-                                if ((!revokeObj.isMember(deleteAll)) || (!MatchRevoked->deleteAll)) {
-                                    if (revokeObj.isMember(services)) {
-                                        Json::Value servicesObj = revokeObj[services];
-
-                                        if (servicesObj.isArray()) {
-                                            if (!servicesObj.empty()) {
-                                                for (Json::UInt l = 0; l < servicesObj.size(); l++) {
-                                                    MatchRevoked->services.push_back(String(servicesObj[l].asCString()));
-                                                }
-                                                tempMsg.response = static_cast<MatchRevokedResponse*>(MatchRevoked);
-                                                parsedResponse.msgs.push_back(tempMsg);
-                                                PrintMessageResponse(tempMsg);
-                                            } else {
-                                                status = ER_FAIL;
-                                                QCC_LogError(status, ("ParseMessagesResponse(): matchRevoked[services] array empty"));
-                                            }
-                                        }
-                                    } else {
-                                        status = ER_FAIL;
-                                        QCC_LogError(status, ("ParseMessagesResponse(): Either matchRevoked[deleteAll] member not found or not set to true AND matchRevoked[services] member not found"));
-                                    }
-                                }
-                            } else {
-                                status = ER_FAIL;
-                                QCC_LogError(status, ("ParseMessagesResponse(): matchRevoked[peerAddr] member not found"));
-                            }
-
-                        } else {
-                            status = ER_FAIL;
-                            QCC_LogError(status, ("ParseMessagesResponse(): matchRevoked member not found"));
-                        }
-                    } else if (msgsObjArrayMember[type] == "startICEChecks") {
-                        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Start ICE Checks Message", j));
-
-                        if (msgsObjArrayMember.isMember(startICEChecks)) {
-                            Json::Value startICEChecksObj = msgsObjArrayMember[startICEChecks];
-
-                            if (startICEChecksObj.isMember(peerAddr)) {
-                                tempMsg.type = START_ICE_CHECKS_RESPONSE;
-                                StartICEChecksResponse* StartICEChecks = new StartICEChecksResponse();
-                                StartICEChecks->peerAddr = String(startICEChecksObj[peerAddr].asCString());
-
-                                tempMsg.response = static_cast<StartICEChecksResponse*>(StartICEChecks);
-                                parsedResponse.msgs.push_back(tempMsg);
-                                PrintMessageResponse(tempMsg);
-
-                            } else {
-                                status = ER_FAIL;
-                                QCC_LogError(status, ("ParseMessagesResponse(): startICEChecks[peerAddr] member not found"));
-                            }
-
-                        } else {
-                            status = ER_FAIL;
-                            QCC_LogError(status, ("ParseMessagesResponse(): startICEChecks member not found"));
-                        }
-                    } else {
-                        status = ER_FAIL;
-                        QCC_LogError(status, ("ParseMessagesResponse(): Unrecognized Message Response received from Rendezvous Server"));
-                    }
+        if (members.portFound) {
+            info.port = members.port;
+        } else {
+            QCC_DbgPrintf(("ParseMessagesResponse(): Set port to the default value as the member %s[STUNInfo][port] was not found", context));
+        }
+
+        info.acct = members.acct;
+        info.pwd = members.pwd;
+        info.expiryTime = (members.expiryTime - TURN_TOKEN_EXPIRY_TIME_BUFFER_IN_SECONDS) * 1000;
+        info.recvTime = GetTimestamp();
+
+        info.relayInfoPresent = members.relayFound;
+        if (members.relayFound) {
+            status = info.relay.address.SetAddress(members.relayAddress);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("ParseMessagesResponse(): Invalid Relay Server address specified in %s response", responseName));
+                return status;
+            }
+            info.relay.port = members.relayPort;
+        } else {
+            QCC_DbgPrintf(("ParseMessagesResponse(): %s[STUNInfo][relay] member not found", context));
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Worker function used to read the match member of a message
+ */
+static QStatus ReadMatch(JsonPullParser& parser, MatchMembers& members)
+{
+    members.found = true;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("matchID")) {
+            members.matchIDFound = true;
+            status = parser.ReadString(members.match.matchID);
+        } else if (parser.TextEquals("service")) {
+            members.serviceFound = true;
+            status = parser.ReadString(members.match.service);
+        } else if (parser.TextEquals("peerAddr")) {
+            members.peerAddrFound = true;
+            status = parser.ReadString(members.match.peerAddr);
+        } else if (parser.TextEquals("STUNInfo")) {
+            status = ReadSTUNInfo(parser, members.STUNInfo);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    return status;
+}
+
+/**
+ * Worker function used to read one element of the candidates array of an
+ * addressCandidates object
+ */
+static QStatus ReadCandidate(JsonPullParser& parser, AddressCandidatesMembers& members)
+{
+    ICECandidates candidate;
+    String type;
+    String transport;
+    String address;
+    String raddress;
+    int32_t componentID = 0;
+    int32_t priority = 0;
+    int32_t port = 0;
+    int32_t rport = 0;
+    bool typeFound = false;
+    bool foundationFound = false;
+    bool componentIDFound = false;
+    bool transportFound = false;
+    bool priorityFound = false;
+    bool addressFound = false;
+    bool portFound = false;
+    bool raddressFound = false;
+    bool rportFound = false;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("type")) {
+            typeFound = true;
+            status = parser.ReadString(type);
+        } else if (parser.TextEquals("foundation")) {
+            foundationFound = true;
+            status = parser.ReadString(candidate.foundation);
+        } else if (parser.TextEquals("componentID")) {
+            componentIDFound = true;
+            status = parser.ReadInt(componentID);
+        } else if (parser.TextEquals("transport")) {
+            transportFound = true;
+            status = parser.ReadString(transport);
+        } else if (parser.TextEquals("priority")) {
+            priorityFound = true;
+            status = parser.ReadInt(priority);
+        } else if (parser.TextEquals("address")) {
+            addressFound = true;
+            status = parser.ReadString(address);
+        } else if (parser.TextEquals("port")) {
+            portFound = true;
+            status = parser.ReadInt(port);
+        } else if (parser.TextEquals("raddress")) {
+            raddressFound = true;
+            status = parser.ReadString(raddress);
+        } else if (parser.TextEquals("rport")) {
+            rportFound = true;
+            status = parser.ReadInt(rport);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    if (status != ER_OK) {
+        return status;
+    }
+
+    if (typeFound) {
+        candidate.type = GetICECandidateTypeValue(type);
+    }
+
+    if (!typeFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][type] member not found"));
+    } else if (!foundationFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][foundation] member not found"));
+    } else if (!componentIDFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][componentID] member not found"));
+    } else if (!transportFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][transport] member not found"));
+    } else if (!priorityFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][priority] member not found"));
+    } else if (!addressFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][address] member not found"));
+    } else if (!portFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][port] member not found"));
+    } else if ((candidate.type != HOST_CANDIDATE) && !raddressFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][raddress] member not found for "
+                               "candidate type %s", type.c_str()));
+    } else if ((candidate.type != HOST_CANDIDATE) && !rportFound) {
+        QCC_LogError(ER_FAIL, ("ParseMessagesResponse(): addressCandidates[candidates][rport] member not found for "
+                               "candidate type %s", type.c_str()));
+    } else {
+        candidate.componentID = componentID;
+        candidate.transport = GetICETransportTypeValue(transport);
+        candidate.priority = priority;
+        candidate.address = IPAddress(address);
+        candidate.port = port;
+        if (candidate.type != HOST_CANDIDATE) {
+            candidate.raddress = IPAddress(raddress);
+            candidate.rport = rport;
+        }
+        members.addressCandidates.candidates.push_back(candidate);
+        return ER_OK;
+    }
+
+    members.invalidCandidateFound = true;
+    return ER_OK;
+}
+
+/**
+ * Worker function used to read the addressCandidates member of a message
+ */
+static QStatus ReadAddressCandidates(JsonPullParser& parser, AddressCandidatesMembers& members)
+{
+    AddressCandidatesResponse& addressCandidates = members.addressCandidates;
+
+    members.found = true;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("matchID")) {
+            members.matchIDFound = true;
+            status = parser.ReadString(addressCandidates.matchID);
+        } else if (parser.TextEquals("source")) {
+            members.sourceFound = true;
+            status = parser.ReadString(addressCandidates.source);
+        } else if (parser.TextEquals("destination")) {
+            members.destinationFound = true;
+            status = parser.ReadString(addressCandidates.destination);
+        } else if (parser.TextEquals("peerAddr")) {
+            members.peerAddrFound = true;
+            status = parser.ReadString(addressCandidates.peerAddr);
+        } else if (parser.TextEquals("ice-ufrag")) {
+            members.ice_ufragFound = true;
+            status = parser.ReadString(addressCandidates.ice_ufrag);
+        } else if (parser.TextEquals("ice-pwd")) {
+            members.ice_pwdFound = true;
+            status = parser.ReadString(addressCandidates.ice_pwd);
+        } else if (parser.TextEquals("candidates")) {
+            members.candidatesFound = true;
+            status = parser.EnterArray();
+            while (status == ER_OK) {
+                status = parser.NextElement(found);
+                if ((status != ER_OK) || !found) {
+                    break;
                 }
+                status = ReadCandidate(parser, members);
+            }
+        } else if (parser.TextEquals("STUNInfo")) {
+            status = ReadSTUNInfo(parser, members.STUNInfo);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    return status;
+}
+
+/**
+ * Worker function used to read the matchRevoked member of a message
+ */
+static QStatus ReadMatchRevoked(JsonPullParser& parser, MatchRevokedMembers& members)
+{
+    members.found = true;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("peerAddr")) {
+            members.peerAddrFound = true;
+            status = parser.ReadString(members.matchRevoked.peerAddr);
+        } else if (parser.TextEquals("deleteAll")) {
+            members.deleteAllFound = true;
+            status = parser.ReadBool(members.matchRevoked.deleteAll);
+        } else if (parser.TextEquals("services")) {
+            members.servicesFound = true;
+            status = parser.EnterArray();
+            while (status == ER_OK) {
+                status = parser.NextElement(found);
+                if ((status != ER_OK) || !found) {
+                    break;
+                }
+                String service;
+                status = parser.ReadString(service);
+                if (status == ER_OK) {
+                    members.matchRevoked.services.push_back(service);
+                }
+            }
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    return status;
+}
+
+/**
+ * Worker function used to read the startICEChecks member of a message
+ */
+static QStatus ReadStartICEChecks(JsonPullParser& parser, StartICEChecksMembers& members)
+{
+    members.found = true;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("peerAddr")) {
+            members.peerAddrFound = true;
+            status = parser.ReadString(members.startICEChecks.peerAddr);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    return status;
+}
+
+/**
+ * Worker function used to read one element of the msgs array of a messages
+ * response. The parsed message is added to parsedResponse if it is complete,
+ * otherwise checkStatus is set to ER_FAIL.
+ */
+static QStatus ReadMessage(JsonPullParser& parser, uint32_t index, ResponseMessage& parsedResponse, QStatus& checkStatus)
+{
+    String type;
+    MatchMembers match;
+    AddressCandidatesMembers addressCandidates;
+    MatchRevokedMembers matchRevoked;
+    StartICEChecksMembers startICEChecks;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("type")) {
+            status = parser.ReadString(type);
+        } else if (parser.TextEquals("match")) {
+            status = ReadMatch(parser, match);
+        } else if (parser.TextEquals("addressCandidates")) {
+            status = ReadAddressCandidates(parser, addressCandidates);
+        } else if (parser.TextEquals("matchRevoked")) {
+            status = ReadMatchRevoked(parser, matchRevoked);
+        } else if (parser.TextEquals("startICEChecks")) {
+            status = ReadStartICEChecks(parser, startICEChecks);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
+    if (status != ER_OK) {
+        return status;
+    }
+
+    Response tempMsg;
+
+    if (type == "match") {
+        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Match Message", index));
+
+        if (!match.found) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): match member not found"));
+        } else if (!match.matchIDFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): match[matchID] member not found"));
+        } else if (!match.serviceFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): match[service] member not found"));
+        } else if (!match.peerAddrFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): match[peerAddr] member not found"));
+        } else if (!match.STUNInfo.found) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): match[STUNInfo] member not found"));
+        } else {
+            QStatus stunStatus = SetSTUNInfo(match.STUNInfo, "match", "Search Match", true, match.match.STUNInfo);
+            if (stunStatus == ER_OK) {
+                tempMsg.type = SEARCH_MATCH_RESPONSE;
+                tempMsg.response = new SearchMatchResponse(match.match);
+                parsedResponse.msgs.push_back(tempMsg);
+                PrintMessageResponse(tempMsg);
             } else {
-                status = ER_FAIL;
-                QCC_LogError(status, ("ParseMessagesResponse(): msgs array is empty"));
+                checkStatus = stunStatus;
             }
+        }
+    } else if (type == "addressCandidates") {
+        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Address Candidates Message", index));
+
+        if (!addressCandidates.found) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates member not found"));
+        } else if (!addressCandidates.matchIDFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[matchID] member not found"));
+        } else if (!addressCandidates.sourceFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[source] member not found"));
+        } else if (!addressCandidates.destinationFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[destination] member not found"));
+        } else if (!addressCandidates.peerAddrFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[peerAddr] member not found"));
+        } else if (!addressCandidates.ice_ufragFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[ice-ufrag] member not found"));
+        } else if (!addressCandidates.ice_pwdFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[ice-pwd] member not found"));
+        } else if (!addressCandidates.candidatesFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): addressCandidates[candidates] member not found"));
         } else {
+            if (addressCandidates.invalidCandidateFound) {
+                checkStatus = ER_FAIL;
+            }
+
+            if (!addressCandidates.addressCandidates.candidates.empty()) {
+                QStatus stunStatus = ER_OK;
+                if (addressCandidates.STUNInfo.found) {
+                    stunStatus = SetSTUNInfo(addressCandidates.STUNInfo, "addressCandidates", "Address Candidates", false,
+                                             addressCandidates.addressCandidates.STUNInfo);
+                    addressCandidates.addressCandidates.STUNInfoPresent = (stunStatus == ER_OK);
+                } else {
+                    QCC_DbgPrintf(("ParseMessagesResponse(): addressCandidates[STUNInfo] member not found"));
+                }
+
+                if (stunStatus == ER_OK) {
+                    tempMsg.type = ADDRESS_CANDIDATES_RESPONSE;
+                    tempMsg.response = new AddressCandidatesResponse(addressCandidates.addressCandidates);
+                    parsedResponse.msgs.push_back(tempMsg);
+                    PrintMessageResponse(tempMsg);
+                } else {
+                    checkStatus = stunStatus;
+                }
+            }
+        }
+    } else if (type == "matchRevoked") {
+        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Match Revoked Message", index));
+
+        if (!matchRevoked.found) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): matchRevoked member not found"));
+        } else if (!matchRevoked.peerAddrFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): matchRevoked[peerAddr] member not found"));
+        } else if (matchRevoked.deleteAllFound && matchRevoked.matchRevoked.deleteAll) {
+            matchRevoked.matchRevoked.services.clear();
+            tempMsg.type = MATCH_REVOKED_RESPONSE;
+            tempMsg.response = new MatchRevokedResponse(matchRevoked.matchRevoked);
+            parsedResponse.msgs.push_back(tempMsg);
+            PrintMessageResponse(tempMsg);
+        } else if (!matchRevoked.servicesFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): Either matchRevoked[deleteAll] member not found or not set to true AND matchRevoked[services] member not found"));
+        } else if (matchRevoked.matchRevoked.services.empty()) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): matchRevoked[services] array empty"));
+        } else {
+            tempMsg.type = MATCH_REVOKED_RESPONSE;
+            tempMsg.response = new MatchRevokedResponse(matchRevoked.matchRevoked);
+            parsedResponse.msgs.push_back(tempMsg);
+            PrintMessageResponse(tempMsg);
+        }
+    } else if (type == "startICEChecks") {
+        QCC_DbgPrintf(("ParseMessagesResponse(): [%d] Start ICE Checks Message", index));
+
+        if (!startICEChecks.found) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): startICEChecks member not found"));
+        } else if (!startICEChecks.peerAddrFound) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): startICEChecks[peerAddr] member not found"));
+        } else {
+            tempMsg.type = START_ICE_CHECKS_RESPONSE;
+            tempMsg.response = new StartICEChecksResponse(startICEChecks.startICEChecks);
+            parsedResponse.msgs.push_back(tempMsg);
+            PrintMessageResponse(tempMsg);
+        }
+    } else {
+        checkStatus = ER_FAIL;
+        QCC_LogError(checkStatus, ("ParseMessagesResponse(): Unrecognized Message Response received from Rendezvous Server"));
+    }
+
+    return ER_OK;
+}
+
+/**
+ * Worker function used to parse a message response
+ */
+QStatus ParseMessagesResponse(const String& receivedResponse, ResponseMessage& parsedResponse)
+{
+    JsonPullParser parser(receivedResponse.data(), receivedResponse.size());
+    QStatus checkStatus = ER_OK;
+    bool empty = true;
+    bool msgsFound = false;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        empty = false;
+
+        if (!parser.TextEquals("msgs")) {
+            status = parser.SkipValue();
+            continue;
+        }
+
+        msgsFound = true;
+
+        JsonPullParser::Token token;
+        status = parser.Next(token);
+        if ((status == ER_OK) && (token != JsonPullParser::JSON_BEGIN_ARRAY)) {
             status = ER_FAIL;
             QCC_LogError(status, ("ParseMessagesResponse(): msgs is not an array"));
+            return status;
         }
-    } else {
+
+        uint32_t index = 0;
+        while (status == ER_OK) {
+            status = parser.NextElement(found);
+            if ((status != ER_OK) || !found) {
+                break;
+            }
+            status = ReadMessage(parser, index++, parsedResponse, checkStatus);
+        }
+
+        if ((status == ER_OK) && (index == 0)) {
+            checkStatus = ER_FAIL;
+            QCC_LogError(checkStatus, ("ParseMessagesResponse(): msgs array is empty"));
+        }
+    }
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ParseMessagesResponse(): Unable to read the response"));
+    } else if (empty) {
+        status = ER_FAIL;
+        QCC_LogError(status, ("ParseMessagesResponse(): Message is empty"));
+    } else if (!msgsFound) {
         status = ER_FAIL;
         QCC_LogError(status, ("ParseMessagesResponse(): No field named msgs in the response"));
+    } else {
+        status = checkStatus;
     }
 
     return status;
-
 }
 
 /**
@@ -1083,22 +1340,33 @@ String GenerateJSONClientLoginRequest(ClientLoginRequest request)
 /**
  * Worker function used to parse the client login first response
  */
-QStatus ParseClientLoginFirstResponse(Json::Value receivedResponse, ClientLoginFirstResponse& parsedResponse)
+QStatus ParseClientLoginFirstResponse(const String& receivedResponse, ClientLoginFirstResponse& parsedResponse)
 {
-    QStatus status = ER_OK;
-
-    Json::StaticString message("message");
-
-    if (receivedResponse.isMember(message)) {
-
-        parsedResponse.message = String(receivedResponse[message].asCString());
-        QCC_DbgPrintf(("ParseClientLoginFirstResponse(): message = %s", receivedResponse[message].asCString()));
-
-    } else {
+    JsonPullParser parser(receivedResponse.data(), receivedResponse.size());
+    bool messageFound = false;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("message")) {
+            messageFound = true;
+            status = parser.ReadString(parsedResponse.message);
+        } else {
+            status = parser.SkipValue();
+        }
+    }
 
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ParseClientLoginFirstResponse(): Unable to read the response"));
+    } else if (!messageFound) {
         status = ER_FAIL;
         QCC_LogError(status, ("ParseClientLoginFirstResponse(): Message does not seem to have a message field"));
-
+    } else {
+        QCC_DbgPrintf(("ParseClientLoginFirstResponse(): message = %s", parsedResponse.message.c_str()));
     }
 
     return status;
@@ -1107,86 +1375,121 @@ QStatus ParseClientLoginFirstResponse(Json::Value receivedResponse, ClientLoginF
 /**
  * Worker function used to parse a client login final response
  */
-QStatus ParseClientLoginFinalResponse(Json::Value receivedResponse, ClientLoginFinalResponse& parsedResponse)
+QStatus ParseClientLoginFinalResponse(const String& receivedResponse, ClientLoginFinalResponse& parsedResponse)
 {
-    QStatus status = ER_OK;
-
-    Json::StaticString message("message");
-    Json::StaticString peerID("peerID");
-    Json::StaticString peerAddr("peerAddr");
-    Json::StaticString daemonRegistrationRequired("daemonRegistrationRequired");
-    Json::StaticString sessionActive("sessionActive");
-    Json::StaticString configData("configData");
-    Json::StaticString Tkeepalive("Tkeepalive");
-
-    if (receivedResponse.isMember(message)) {
-
-        parsedResponse.message = String(receivedResponse[message].asCString());
-        QCC_DbgPrintf(("ParseClientLoginFinalResponse(): message = %s", receivedResponse[message].asCString()));
-
-
-        if (receivedResponse.isMember(peerID)) {
-            if (receivedResponse.isMember(peerAddr)) {
-                if (receivedResponse.isMember(configData)) {
-
-                    parsedResponse.SetpeerID(String(receivedResponse[peerID].asCString()));
-                    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): peerID = %s", receivedResponse[peerID].asCString()));
-
-                    parsedResponse.SetpeerAddr(String(receivedResponse[peerAddr].asCString()));
-                    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): peerAddr = %s", receivedResponse[peerAddr].asCString()));
-
-                    Json::Value configDataObj = receivedResponse[configData];
-
-                    if (configDataObj.isMember(Tkeepalive)) {
-
-                        ConfigData data;
-                        data.SetTkeepalive(configDataObj[Tkeepalive].asInt());
-                        parsedResponse.SetconfigData(data);
-                        QCC_DbgPrintf(("ParseClientLoginFinalResponse(): configData.Tkeepalive = %d", configDataObj[Tkeepalive].asInt()));
-
-                        if (receivedResponse.isMember(daemonRegistrationRequired)) {
-
-                            parsedResponse.SetdaemonRegistrationRequired(receivedResponse[daemonRegistrationRequired].asBool());
-                            QCC_DbgPrintf(("ParseClientLoginFinalResponse(): daemonRegistrationRequired = %d", receivedResponse[daemonRegistrationRequired].asBool()));
+    JsonPullParser parser(receivedResponse.data(), receivedResponse.size());
+    String message;
+    String peerID;
+    String peerAddr;
+    int32_t Tkeepalive = 0;
+    bool daemonRegistrationRequired = false;
+    bool sessionActive = false;
+    bool messageFound = false;
+    bool peerIDFound = false;
+    bool peerAddrFound = false;
+    bool configDataFound = false;
+    bool TkeepaliveFound = false;
+    bool daemonRegistrationRequiredFound = false;
+    bool sessionActiveFound = false;
+
+    QStatus status = parser.EnterObject();
+    while (status == ER_OK) {
+        bool found;
+        status = parser.NextMember(found);
+        if ((status != ER_OK) || !found) {
+            break;
+        }
+        if (parser.TextEquals("message")) {
+            messageFound = true;
+            status = parser.ReadString(message);
+        } else if (parser.TextEquals("peerID")) {
+            peerIDFound = true;
+            status = parser.ReadString(peerID);
+        } else if (parser.TextEquals("peerAddr")) {
+            peerAddrFound = true;
+            status = parser.ReadString(peerAddr);
+        } else if (parser.TextEquals("daemonRegistrationRequired")) {
+            daemonRegistrationRequiredFound = true;
+            status = parser.ReadBool(daemonRegistrationRequired);
+        } else if (parser.TextEquals("sessionActive")) {
+            sessionActiveFound = true;
+            status = parser.ReadBool(sessionActive);
+        } else if (parser.TextEquals("configData")) {
+            configDataFound = true;
+            status = parser.EnterObject();
+            while (status == ER_OK) {
+                status = parser.NextMember(found);
+                if ((status != ER_OK) || !found) {
+                    break;
+                }
+                if (parser.TextEquals("Tkeepalive")) {
+                    TkeepaliveFound = true;
+                    status = parser.ReadInt(Tkeepalive);
+                } else {
+                    status = parser.SkipValue();
+                }
+            }
+        } else {
+            status = parser.SkipValue();
+        }
+    }
 
-                        } else {
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ParseClientLoginFinalResponse(): Unable to read the response"));
+        return status;
+    }
 
-                            parsedResponse.SetdaemonRegistrationRequired(false);
-                            QCC_DbgPrintf(("ParseClientLoginFinalResponse(): Set daemonRegistrationRequired to false as Server did not send the field"));
+    if (!messageFound) {
+        status = ER_FAIL;
+        QCC_LogError(status, ("ParseClientLoginFinalResponse(): Message does not seem to have a message field"));
+        return status;
+    }
 
-                        }
+    parsedResponse.message = message;
+    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): message = %s", message.c_str()));
 
-                        if (receivedResponse.isMember(sessionActive)) {
+    if (peerIDFound) {
+        if (!peerAddrFound) {
+            status = ER_FAIL;
+            QCC_LogError(status, ("ParseClientLoginFinalResponse(): peerAddr member not found"));
+        } else if (!configDataFound) {
+            status = ER_FAIL;
+            QCC_LogError(status, ("ParseClientLoginFinalResponse(): configData member not found"));
+        } else {
+            parsedResponse.SetpeerID(peerID);
+            QCC_DbgPrintf(("ParseClientLoginFinalResponse(): peerID = %s", peerID.c_str()));
 
-                            parsedResponse.SetsessionActive(receivedResponse[sessionActive].asBool());
-                            QCC_DbgPrintf(("ParseClientLoginFinalResponse(): sessionActive = %d", receivedResponse[sessionActive].asBool()));
+            parsedResponse.SetpeerAddr(peerAddr);
+            QCC_DbgPrintf(("ParseClientLoginFinalResponse(): peerAddr = %s", peerAddr.c_str()));
 
-                        } else {
+            if (TkeepaliveFound) {
 
-                            parsedResponse.SetsessionActive(false);
-                            QCC_DbgPrintf(("ParseClientLoginFinalResponse(): Set sessionActive to false as Server did not send the field"));
+                ConfigData data;
+                data.SetTkeepalive(Tkeepalive);
+                parsedResponse.SetconfigData(data);
+                QCC_DbgPrintf(("ParseClientLoginFinalResponse(): configData.Tkeepalive = %d", Tkeepalive));
 
-                        }
+                if (daemonRegistrationRequiredFound) {
+                    parsedResponse.SetdaemonRegistrationRequired(daemonRegistrationRequired);
+                    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): daemonRegistrationRequired = %d", daemonRegistrationRequired));
+                } else {
+                    parsedResponse.SetdaemonRegistrationRequired(false);
+                    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): Set daemonRegistrationRequired to false as Server did not send the field"));
+                }
 
-                    } else {
-                        status = ER_FAIL;
-                        QCC_LogError(status, ("ParseClientLoginFinalResponse(): configData member in the message does not seem to have the Tkeepalive field"));
-                    }
+                if (sessionActiveFound) {
+                    parsedResponse.SetsessionActive(sessionActive);
+                    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): sessionActive = %d", sessionActive));
                 } else {
-                    status = ER_FAIL;
-                    QCC_LogError(status, ("ParseClientLoginFinalResponse(): configData member not found"));
+                    parsedResponse.SetsessionActive(false);
+                    QCC_DbgPrintf(("ParseClientLoginFinalResponse(): Set sessionActive to false as Server did not send the field"));
                 }
+
             } else {
                 status = ER_FAIL;
-                QCC_LogError(status, ("ParseClientLoginFinalResponse(): peerAddr member not found"));
+                QCC_LogError(status, ("ParseClientLoginFinalResponse(): configData member in the message does not seem to have the Tkeepalive field"));
             }
         }
-
-    } else {
-
-        status = ER_FAIL;
-        QCC_LogError(status, ("ParseClientLoginFinalResponse(): Message does not seem to have a message field"));
-
     }
 
     return status;
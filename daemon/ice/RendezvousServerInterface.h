@@ -1308,12 +1308,12 @@ String GenerateJSONCandidates(ICECandidatesMessage message);
 /**
  * Worker function used to parse a generic response
  */
-QStatus ParseGenericResponse(Json::Value receivedResponse, GenericResponse& parsedResponse);
+QStatus ParseGenericResponse(const String& receivedResponse, GenericResponse& parsedResponse);
 
 /**
  * Worker function used to parse a refresh token response
  */
-QStatus ParseTokenRefreshResponse(Json::Value receivedResponse, TokenRefreshResponse& parsedResponse);
+QStatus ParseTokenRefreshResponse(const String& receivedResponse, TokenRefreshResponse& parsedResponse);
 
 /**
  * Worker function used to print a parsed response
@@ -1323,7 +1323,7 @@ void PrintMessageResponse(Response response);
 /**
  * Worker function used to parse a messages response
  */
-QStatus ParseMessagesResponse(Json::Value receivedResponse, ResponseMessage& parsedResponse);
+QStatus ParseMessagesResponse(const String& receivedResponse, ResponseMessage& parsedResponse);
 
 /**
  * Worker function used to generate the string corresponding
@@ -1340,12 +1340,12 @@ String GenerateJSONClientLoginRequest(ClientLoginRequest request);
 /**
  * Worker function used to parse the client login first response
  */
-QStatus ParseClientLoginFirstResponse(Json::Value receivedResponse, ClientLoginFirstResponse& parsedResponse);
+QStatus ParseClientLoginFirstResponse(const String& receivedResponse, ClientLoginFirstResponse& parsedResponse);
 
 /**
  * Worker function used to parse the client login final response
  */
-QStatus ParseClientLoginFinalResponse(Json::Value receivedResponse, ClientLoginFinalResponse& parsedResponse);
+QStatus ParseClientLoginFinalResponse(const String& receivedResponse, ClientLoginFinalResponse& parsedResponse);
 
 /**
  * Worker function used to generate the enum corresponding
@@ -33,6 +33,7 @@
 #include <StunAttribute.h>
 #include <StunIOInterface.h>
 #include <StunMessage.h>
+#include <StunMessageView.h>
 #include <StunTransactionID.h>
 
 using namespace qcc;
@@ -391,39 +392,7 @@ QStatus Stun::SendStunMessage(const StunMessage& msg, IPAddress addr, uint16_t p
 #endif
     } else {
         if (relayMsg) {
-            // Relayed UDP messages must be wrapped in a STUN message.
-            ScatterGatherList rMsgSG;
-            StunMessage rMsg(STUN_MSG_INDICATION_CLASS, STUN_MSG_SEND_METHOD, hmacKey, hmacKeyLen);
-            uint8_t* rBuf;
-            uint8_t* rPos;
-            size_t rBufSize;
-
-            status = rMsg.AddAttribute(new StunAttributeUsername(STUNInfo.acct));
-            if (status == ER_OK) {
-                status = rMsg.AddAttribute(new StunAttributeXorPeerAddress(rMsg, addr, port));
-            }
-            if (status == ER_OK) {
-                status = rMsg.AddAttribute(new StunAttributeData(msgSG));
-            }
-            if (status == ER_OK) {
-                status = rMsg.AddAttribute(new StunAttributeMessageIntegrity(rMsg));
-            }
-            if (status == ER_OK) {
-                status = rMsg.AddAttribute(new StunAttributeFingerprint(rMsg));
-            }
-            if (status == ER_OK) {
-                rBufSize = rMsg.RenderSize();
-                rBuf = new uint8_t[rBufSize];
-                rPos = rBuf;
-
-                expectedSent = rMsg.Size();
-
-                status = rMsg.RenderBinary(rPos, rBufSize, rMsgSG);
-                if (status == ER_OK) {
-                    status = SendToSG(sockfd, turnAddr, turnPort, rMsgSG, sent);
-                }
-                delete[] rBuf;
-            }
+            status = SendRelayedStunMessage(&msgSG, NULL, msgSG.DataSize(), addr, port, sent, expectedSent);
         } else {
             expectedSent = msg.Size();
 
@@ -442,6 +411,91 @@ exit:
     return status;
 }
 
+QStatus Stun::SendStunMessage(const StunMessageBuilder& msg, IPAddress addr, uint16_t port, bool relayMsg)
+{
+    QCC_DbgTrace(("Stun::SendStunMessage(msg = <%u bytes>, addr = %s, port = %u, relayMsg = %s) [sockfd = %d]",
+                  msg.Size(),
+                  addr.ToString().c_str(),
+                  port,
+                  relayMsg ? "YES" : "NO",
+                  sockfd));
+
+    QStatus status;
+    size_t sent = 0;
+    size_t expectedSent = 0;
+
+    if (!opened) {
+        return ER_STUN_SOCKET_NOT_OPEN;
+    }
+
+    QCC_DbgPrintf(("TX: Sending %u byte STUN message", msg.Size()));
+    QCC_DbgLocalData(msg.GetBuffer(), msg.Size());
+
+    frameLock.Lock();
+    if (type == QCC_SOCK_STREAM) {
+        status = ER_NOT_IMPLEMENTED;
+        QCC_LogError(status, ("Sending STUN message"));
+    } else if (relayMsg) {
+        status = SendRelayedStunMessage(NULL, msg.GetBuffer(), msg.Size(), addr, port, sent, expectedSent);
+    } else {
+        expectedSent = msg.Size();
+        status = SendTo(sockfd, addr, port, msg.GetBuffer(), msg.Size(), sent);
+    }
+    frameLock.Unlock();
+
+    if ((status == ER_OK) && (sent != expectedSent)) {
+        status = ER_STUN_FAILED_TO_SEND_MSG;
+        QCC_LogError(status, ("Sent %u does not match expected (%u)", sent, expectedSent));
+    }
+    return status;
+}
+
+QStatus Stun::SendRelayedStunMessage(const ScatterGatherList* msgSG, const uint8_t* msgBuf, size_t msgSize,
+                                     IPAddress addr, uint16_t port, size_t& sent, size_t& expectedSent)
+{
+    // Relayed UDP messages must be wrapped in a STUN Send indication.
+    // It is built straight into the relay send buffer, which is
+    // reused for every relayed message and protected by frameLock.
+    QStatus status;
+    StunTransactionID tid;
+    size_t rMsgSize = (StunMessage::MIN_MSG_SIZE +
+                       StunAttribute::ATTR_HEADER_SIZE + ((STUNInfo.acct.size() + 3) & ~3) +
+                       StunAttributeXorPeerAddress::ATTR_SIZE_WITH_HEADER +
+                       StunAttribute::ATTR_HEADER_SIZE + ((msgSize + 3) & ~3) +
+                       StunAttributeMessageIntegrity::ATTR_SIZE_WITH_HEADER +
+                       StunAttributeFingerprint::ATTR_SIZE_WITH_HEADER);
+    uint8_t* data;
+
+    if (relayTxBuf.size() < rMsgSize) {
+        relayTxBuf.resize(rMsgSize);
+    }
+
+    tid.SetValue();
+    StunMessageBuilder rMsg(&relayTxBuf[0], relayTxBuf.size(),
+                            STUN_MSG_INDICATION_CLASS, STUN_MSG_SEND_METHOD, tid);
+
+    status = rMsg.AddString(STUN_ATTR_USERNAME, STUNInfo.acct);
+    if (status == ER_OK) {
+        status = rMsg.AddXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, addr, port);
+    }
+    if (status == ER_OK) {
+        status = rMsg.ReserveAttribute(STUN_ATTR_DATA, static_cast<uint16_t>(msgSize), data);
+    }
+    if (status == ER_OK) {
+        if (msgSG) {
+            msgSG->CopyToBuffer(data, msgSize);
+        } else {
+            memcpy(data, msgBuf, msgSize);
+        }
+        status = rMsg.Finish(hmacKey, hmacKeyLen, true);
+    }
+    if (status == ER_OK) {
+        expectedSent = rMsg.Size();
+        status = SendTo(sockfd, turnAddr, turnPort, rMsg.GetBuffer(), rMsg.Size(), sent);
+    }
+    return status;
+}
+
 void Stun::ReceiveTCP()
 {
     // To be implemented...
@@ -458,6 +512,7 @@ void Stun::ReceiveUDP()
     if (status == ER_OK) {
         bool isStunMsg = ((sb.len >= StunMessage::MIN_MSG_SIZE) &&
                           StunMessage::IsStunMessage(sb.buf, sb.len));
+        bool isData = false;
 
         if (isStunMsg) {
             const uint8_t* buf = sb.buf;
@@ -465,54 +520,45 @@ void Stun::ReceiveUDP()
             uint16_t rawMsgType = 0;
 
             StunIOInterface::ReadNetToHost(buf, bufSize, rawMsgType);
+            isData = (StunMessage::ExtractMessageMethod(rawMsgType) == STUN_MSG_DATA_METHOD);
+        }
 
-            // Reset buf and bufSize
-            buf = sb.buf;
-            bufSize = sb.len;
-
-            if (StunMessage::ExtractMessageMethod(rawMsgType) == STUN_MSG_DATA_METHOD) {
-                // parse message and extract DATA attribute contents.
-                uint8_t dummyHmac[hmacKeyLen];
-                StunMessage msg("", dummyHmac, hmacKeyLen);
-                QStatus status;
-
-                status = msg.Parse(buf, bufSize);
-                if (status == ER_OK) {
-                    StunMessage::const_iterator iter;
-
-                    for (iter = msg.Begin(); iter != msg.End(); ++iter) {
-                        if ((*iter)->GetType() == STUN_ATTR_DATA) {
-                            StunAttributeData* data = reinterpret_cast<StunAttributeData*>(*iter);
-                            ScatterGatherList::const_iterator sgiter = data->GetData().Begin();
-
-                            /*
-                             * Because the message was parsed, the data
-                             * SG-List in the DATA attribute is guaranteed to
-                             * be have only a single element.  Furthermore,
-                             * that element will refer to a region of memory
-                             * that is fully contained within the space
-                             * allocated for the StunBuffer that was allocated
-                             * above.  Therefore, we just point the sb.buf to
-                             * the data region instead of performing a data
-                             * copy that will involve overlapping memory
-                             * regions.
-                             */
-                            sb.buf = reinterpret_cast<uint8_t*>(sgiter->buf);
-                            sb.len = sgiter->len;
-
-                            // Now that STUN wrapped relayed msg is extracted,
-                            // need to determine if wrapped message is a STUN
-                            // message for ICE or not.
-                            isStunMsg = ((sb.len >= StunMessage::MIN_MSG_SIZE) &&
-                                         StunMessage::IsStunMessage(sb.buf, sb.len));
-                        }
-                        if ((*iter)->GetType() == STUN_ATTR_XOR_PEER_ADDRESS) {
-                            StunAttributeXorPeerAddress* sa = reinterpret_cast<StunAttributeXorPeerAddress*>(*iter);
-                            sa->GetAddress(sb.addr, sb.port);
-                        }
-                    }
-                    sb.relayed = true;
+        if (isData) {
+            // Unwrap the relayed message from the DATA attribute in place.
+            // Data indications from the TURN server carry no
+            // MESSAGE-INTEGRITY so only the FINGERPRINT is checked.
+            StunMessageView msg;
+            QStatus status;
+
+            status = msg.Parse(sb.buf, sb.len);
+            if (status == ER_OK) {
+                status = msg.Verify(NULL, 0);
+            }
+            if (status == ER_OK) {
+                const StunMessageView::Attribute* data = msg.FindAttribute(STUN_ATTR_DATA);
+                const StunMessageView::Attribute* peer = msg.FindAttribute(STUN_ATTR_XOR_PEER_ADDRESS);
+
+                if (peer != NULL) {
+                    msg.GetXorAddress(*peer, sb.addr, sb.port);
+                }
+                if (data != NULL) {
+                    /*
+                     * The DATA attribute value lies within the space
+                     * allocated for the StunBuffer above.  Therefore, we
+                     * just point the sb.buf to the data region instead of
+                     * performing a data copy that will involve overlapping
+                     * memory regions.
+                     */
+                    sb.buf = const_cast<uint8_t*>(data->value);
+                    sb.len = data->length;
+
+                    // Now that STUN wrapped relayed msg is extracted,
+                    // need to determine if wrapped message is a STUN
+                    // message for ICE or not.
+                    isStunMsg = ((sb.len >= StunMessage::MIN_MSG_SIZE) &&
+                                 StunMessage::IsStunMessage(sb.buf, sb.len));
                 }
+                sb.relayed = true;
             }
         }
 
@@ -710,29 +756,25 @@ exit:
 
 
 
-QStatus Stun::RecvStunMessage(StunMessage& msg, IPAddress& addr, uint16_t& port, bool& relayed, uint32_t maxMs)
+QStatus Stun::PopStunMessage(uint8_t*& storage, const uint8_t*& msg, size_t& msgSize,
+                             IPAddress& addr, uint16_t& port, bool& relayed, uint32_t maxMs)
 {
     Thread* selfThread = Thread::GetThread();
-
-    QCC_DbgTrace(("Stun::RecvStunMessage(msg = <>, addr = <>, port = <>, maxMs = %u) [sockfd = %d, therad = %s]",
-                  maxMs, sockfd, selfThread ? selfThread->GetName() : "<unknown>"));
-
     QStatus status = ER_OK;
-    uint8_t* buf = NULL;
-    const uint8_t* pos = NULL;
-    size_t parseSize = -1;
+
+    storage = NULL;
 
     if (!opened) {
         status = ER_STUN_SOCKET_NOT_OPEN;
         QCC_LogError(status, ("Receiving STUN message"));
-        goto exit;
+        return status;
     }
 
     if (type == QCC_SOCK_STREAM) {
         // TCP
         status = ER_NOT_IMPLEMENTED;
         QCC_LogError(status, ("Receiving STUN message"));
-        goto exit;
+        return status;
 #if 0
         if (!usingTurn) {
             // STUN messages are framed.
@@ -744,75 +786,132 @@ QStatus Stun::RecvStunMessage(StunMessage& msg, IPAddress& addr, uint16_t& port,
             goto exit;
         }
 #endif
-    } else {
-        // UDP
-        vector<Event*> waitEvents, signaledEvents;
-        uint8_t* storage = NULL;
-
-        waitEvents.push_back(&stunMsgQueueModified);
-        if (selfThread != NULL) {
-            Event& stopEvent = selfThread->GetStopEvent();
-            waitEvents.push_back(&stopEvent);
-        }
-
-        QCC_DbgPrintf(("Waiting up to %u ms for a STUN message...", maxMs));
-        status = Event::Wait(waitEvents, signaledEvents, maxMs);
-        if (status != ER_OK) {
-            if (status != ER_TIMEOUT) {
-                QCC_LogError(status, ("Waiting for a STUN message to arrive"));
-            }
-            goto exit;
-        }
+    }
 
-        if (find(signaledEvents.begin(),
-                 signaledEvents.end(),
-                 &stunMsgQueueModified) == signaledEvents.end()) {
-            QCC_DbgPrintf(("Aborting read on thread %s due to stop signal",
-                           selfThread ? selfThread->GetName() : "<unknown>"));
-            status = ER_STOPPING_THREAD;
-            goto exit;
-        }
+    // UDP
+    vector<Event*> waitEvents, signaledEvents;
 
-        stunMsgQueueLock.Lock();
-        assert(!stunMsgQueue.empty());
-        StunBuffer& sb(stunMsgQueue.front());
-        storage = sb.storage;
-        buf = sb.buf;
-        parseSize = sb.len;
-        addr = sb.addr;
-        port = sb.port;
-        relayed = sb.relayed;
-        stunMsgQueue.pop();
+    waitEvents.push_back(&stunMsgQueueModified);
+    if (selfThread != NULL) {
+        Event& stopEvent = selfThread->GetStopEvent();
+        waitEvents.push_back(&stopEvent);
+    }
 
-        if (stunMsgQueue.size() == 0) {
-            stunMsgQueueModified.ResetEvent();
+    QCC_DbgPrintf(("Waiting up to %u ms for a STUN message...", maxMs));
+    status = Event::Wait(waitEvents, signaledEvents, maxMs);
+    if (status != ER_OK) {
+        if (status != ER_TIMEOUT) {
+            QCC_LogError(status, ("Waiting for a STUN message to arrive"));
         }
-        stunMsgQueueLock.Unlock();
+        return status;
+    }
 
-        QCC_DbgPrintf(("Popped off %u byte STUN message (addr = %p)",
-                       parseSize, buf));
+    if (find(signaledEvents.begin(),
+             signaledEvents.end(),
+             &stunMsgQueueModified) == signaledEvents.end()) {
+        QCC_DbgPrintf(("Aborting read on thread %s due to stop signal",
+                       selfThread ? selfThread->GetName() : "<unknown>"));
+        return ER_STOPPING_THREAD;
+    }
 
-        pos = buf;
-        buf = storage;
+    stunMsgQueueLock.Lock();
+    assert(!stunMsgQueue.empty());
+    StunBuffer& sb(stunMsgQueue.front());
+    storage = sb.storage;
+    msg = sb.buf;
+    msgSize = sb.len;
+    addr = sb.addr;
+    port = sb.port;
+    relayed = sb.relayed;
+    stunMsgQueue.pop();
+
+    if (stunMsgQueue.size() == 0) {
+        stunMsgQueueModified.ResetEvent();
     }
+    stunMsgQueueLock.Unlock();
+
+    QCC_DbgPrintf(("Popped off %u byte STUN message (addr = %p)",
+                   msgSize, msg));
+
+    QCC_DbgPrintf(("RX: Received %u bytes", msgSize));
+    QCC_DbgRemoteData(msg, msgSize);
+
+    return status;
+}
 
-    QCC_DbgPrintf(("RX: Received %u bytes", parseSize));
-    QCC_DbgRemoteData(pos, parseSize);
+QStatus Stun::RecvStunMessage(StunMessage& msg, IPAddress& addr, uint16_t& port, bool& relayed, uint32_t maxMs)
+{
+    QCC_DbgTrace(("Stun::RecvStunMessage(msg = <>, addr = <>, port = <>, maxMs = %u) [sockfd = %d]",
+                  maxMs, sockfd));
 
-    status = msg.Parse(pos, parseSize, expectedResponses);
+    uint8_t* storage;
+    const uint8_t* pos = NULL;
+    size_t parseSize = 0;
+
+    QStatus status = PopStunMessage(storage, pos, parseSize, addr, port, relayed, maxMs);
+    if (status == ER_OK) {
+        status = msg.Parse(pos, parseSize, expectedResponses);
 
 #if !defined(NDEBUG)
-    if (parseSize > 0) {
-        QCC_DbgPrintf(("RX: Received %d extra bytes.", parseSize));
-    }
+        if (parseSize > 0) {
+            QCC_DbgPrintf(("RX: Received %d extra bytes.", parseSize));
+        }
 #endif
+    }
 
-exit:
-    //if (rxLeftoverBuf != buf) {
-    if (1) {
-        delete[] buf;
+    delete[] storage;
+    return status;
+}
+
+QStatus Stun::RecvStunMessage(StunMessageView& msg, uint8_t*& msgBuf, IPAddress& addr, uint16_t& port,
+                              bool& relayed, uint32_t maxMs)
+{
+    QCC_DbgTrace(("Stun::RecvStunMessage(msg = <view>, addr = <>, port = <>, maxMs = %u) [sockfd = %d]",
+                  maxMs, sockfd));
+
+    const uint8_t* pos = NULL;
+    size_t msgSize = 0;
+
+    QStatus status = PopStunMessage(msgBuf, pos, msgSize, addr, port, relayed, maxMs);
+    if (status == ER_OK) {
+        status = msg.Parse(pos, msgSize);
+    }
+    if (status == ER_OK) {
+        // MESSAGE-INTEGRITY is not enforced, same as StunMessage::Parse().
+        status = msg.Verify(NULL, 0);
+    }
+    if (status == ER_OK) {
+        bool hasUsername = (msg.FindAttribute(STUN_ATTR_USERNAME) != NULL);
+        bool hasIntegrity = (msg.FindAttribute(STUN_ATTR_MESSAGE_INTEGRITY) != NULL);
+
+        // Section 10.1.2 checks.
+        switch (msg.GetTypeClass()) {
+        case STUN_MSG_RESPONSE_CLASS:
+        case STUN_MSG_ERROR_CLASS: {
+            StunTransactionID tid;
+            msg.GetTransactionID(tid);
+            expectedResponses.erase(tid);
+            if (hasUsername) {
+                status = ER_STUN_RESPONSE_WITH_USERNAME;
+            }
+            break;
+        }
+
+        case STUN_MSG_REQUEST_CLASS:
+            if (hasUsername != hasIntegrity) {
+                status = ER_STUN_ERR400_BAD_REQUEST;
+            }
+            break;
+
+        default:
+            break;
+        }
     }
 
+    if (status != ER_OK) {
+        delete[] msgBuf;
+        msgBuf = NULL;
+    }
     return status;
 }
 
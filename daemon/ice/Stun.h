@@ -30,6 +30,7 @@
 #endif
 
 #include <queue>
+#include <vector>
 #include <qcc/Mutex.h>
 #include <qcc/Socket.h>
 #include <qcc/SocketTypes.h>
@@ -37,6 +38,7 @@
 #include <qcc/IPAddress.h>
 #include <qcc/Thread.h>
 #include <StunMessage.h>
+#include <StunMessageView.h>
 #include "RendezvousServerInterface.h"
 
 using namespace qcc;
@@ -232,6 +234,45 @@ class Stun {
                             bool& relayed,
                             uint32_t maxMs);
 
+    /**
+     * Send a STUN message rendered by a StunMessageBuilder.  Finish() must
+     * have been called on the message.
+     *
+     * @param msg       STUN Message to be sent.
+     * @param destAddr  Destination IP address
+     * @param destPort  Destination IP port number
+     * @param relayMsg  Set to "true" if message must be relayed via the TURN server.
+     * @return Indication of success or failure.
+     */
+    QStatus SendStunMessage(const StunMessageBuilder& msg,
+                            IPAddress destAddr,
+                            uint16_t destPort,
+                            bool relayMsg);
+
+    /**
+     * Receive a STUN message from any sender and parse it in place.  The
+     * FINGERPRINT, if present, is verified and a response is matched up
+     * with the request that was sent for it.
+     *
+     * @param msg           [OUT] View of the received message.
+     * @param msgBuf        [OUT] Buffer holding the message msg refers to.  The
+     *                      caller must delete[] it once it is done with msg.
+     * @param sourceAddr    [OUT] IP address of the sender
+     * @param sourcePort    [OUT] IP port number of the sender
+     * @param relayed       [OUT] Indicates if message was relay via the TURN server.
+     * @param maxMs         Timeout for maximum number of milliseconds to wait
+     *                      for a message.
+     *
+     * @return  Same as RecvStunMessage(StunMessage&, ...).  msgBuf is NULL
+     *          unless ER_OK is returned.
+     */
+    QStatus RecvStunMessage(StunMessageView& msg,
+                            uint8_t*& msgBuf,
+                            IPAddress& sourceAddr,
+                            uint16_t& sourcePort,
+                            bool& relayed,
+                            uint32_t maxMs);
+
 
     /**
      * Send application data over the STUN-socket.
@@ -434,6 +475,8 @@ class Stun {
 
     size_t maxMTU;          ///< Maximium MTU size of all interfaces.
 
+    std::vector<uint8_t> relayTxBuf;    ///< Send buffer for wrapping relayed messages (protected by frameLock).
+
     Component* component;   ///< FIXME: This should a void * and be made generic.
 
     /// Map of STUN Transaction IDs and HMAC-Keys and the length of the keys.
@@ -467,6 +510,42 @@ class Stun {
 
     static ThreadReturn STDCALL RxThread(void*arg);
 
+    /**
+     * Wait for a received STUN message and take it off the queue.
+     *
+     * @param storage   OUT: Buffer holding the message, to be released with
+     *                       delete[] by the caller.
+     * @param msg       OUT: Start of the STUN message in storage.
+     * @param msgSize   OUT: Number of octets in the message.
+     * @param addr      OUT: IP address of the sender.
+     * @param port      OUT: IP port number of the sender.
+     * @param relayed   OUT: Indicates if message was relay via the TURN server.
+     * @param maxMs     Timeout for maximum number of milliseconds to wait.
+     *
+     * @return  Same as RecvStunMessage().  storage is NULL unless ER_OK is
+     *          returned.
+     */
+    QStatus PopStunMessage(uint8_t*& storage, const uint8_t*& msg, size_t& msgSize,
+                           IPAddress& addr, uint16_t& port, bool& relayed, uint32_t maxMs);
+
+    /**
+     * Wrap a rendered STUN message in a Send indication and send it to the
+     * TURN server.  The message is taken from msgSG if it is not NULL and
+     * from msgBuf otherwise.  Must be called with frameLock held.
+     *
+     * @param msgSG         SG list of the rendered message or NULL.
+     * @param msgBuf        Rendered message if msgSG is NULL.
+     * @param msgSize       Number of octets in the message.
+     * @param addr          IP address of the peer.
+     * @param port          IP port number of the peer.
+     * @param sent          OUT: Number of octets sent.
+     * @param expectedSent  OUT: Size of the Send indication.
+     *
+     * @return  Indication of success or failure.
+     */
+    QStatus SendRelayedStunMessage(const ScatterGatherList* msgSG, const uint8_t* msgBuf, size_t msgSize,
+                                   IPAddress addr, uint16_t port, size_t& sent, size_t& expectedSent);
+
 
     /**
      * Received framed data from a TCP stream.  This can be either a STUN
@@ -46,6 +46,9 @@ class StunAttributeFingerprint : public StunAttribute {
     static const uint32_t CRC_TABLE[256];   ///< CRC look up table.
     const StunMessage& message;   ///< Reference to containing message.
     uint32_t fingerprint;         ///< CRC-32 value (XOR'd w/ 0x5354554e) for containing message.
+
+
+  public:
     static const uint32_t MAGIC_XOR = 0x5354554e;    ///< Magic XOR value (see RFC 5389 sec. 15.5).
 
     /**
@@ -59,8 +62,6 @@ class StunAttributeFingerprint : public StunAttribute {
      */
     static uint32_t ComputeCRC(const uint8_t* buf, size_t len, uint32_t crc = 0);
 
-
-  public:
     /**
      * StunAttributeFingerprint constructor.  Fingerprint only works for the
      * message this instance is contained in.  Therefore, the message this
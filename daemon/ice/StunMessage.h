@@ -245,6 +245,13 @@ class StunMessage : public StunIOInterface {
                                                                size_t& bufSize,
                                                                ScatterGatherList& sg) const;
 
+    /**
+     * StunMessageView checks the message type with IsTypeOK and
+     * StunMessageBuilder renders it with FormatMsgType.
+     */
+    friend class StunMessageView;
+    friend class StunMessageBuilder;
+
   public:
     /**
      * STUN Message constructor intended for receiving STUN messages.
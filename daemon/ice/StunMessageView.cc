@@ -0,0 +1,565 @@
+/**
+ * @file
+ *
+ * This file implements the allocation free STUN message parser and builder.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+#include <qcc/platform.h>
+#include <qcc/Crypto.h>
+#include <qcc/Debug.h>
+#include <StunAttributeBase.h>
+#include <StunAttributeFingerprint.h>
+#include <StunMessage.h>
+#include <StunMessageView.h>
+#include "Status.h"
+
+#define QCC_MODULE "STUN_MESSAGE"
+
+using namespace qcc;
+
+/*
+ * Number of octets hashed and CRC'd at a time when MESSAGE-INTEGRITY and
+ * FINGERPRINT are computed together.  This matches the SHA1 block size so
+ * each chunk is still in the cache when the CRC is computed over it.
+ */
+static const size_t DIGEST_CHUNK_SIZE = 64;
+
+/* Size of an XOR address attribute value without the address */
+static const size_t XOR_ADDR_HEADER_SIZE = 2 * sizeof(uint16_t);
+
+/* Address family values used in address attributes */
+static const uint8_t FAMILY_IPV4 = 0x01;
+static const uint8_t FAMILY_IPV6 = 0x02;
+
+/* Size of the MESSAGE-INTEGRITY attribute including the attribute header */
+static const size_t MI_ATTR_SIZE_WITH_HEADER = StunAttribute::ATTR_HEADER_SIZE + Crypto_SHA1::DIGEST_SIZE;
+
+static inline uint16_t GetUInt16(const uint8_t* buf)
+{
+    return (static_cast<uint16_t>(buf[0]) << 8) | static_cast<uint16_t>(buf[1]);
+}
+
+static inline void PutUInt16(uint8_t* buf, uint16_t value)
+{
+    buf[0] = static_cast<uint8_t>(value >> 8);
+    buf[1] = static_cast<uint8_t>(value & 0xff);
+}
+
+static inline void PutUInt32(uint8_t* buf, uint32_t value)
+{
+    PutUInt16(buf, static_cast<uint16_t>(value >> 16));
+    PutUInt16(buf + sizeof(uint16_t), static_cast<uint16_t>(value & 0xffff));
+}
+
+/* Padded size of an attribute value */
+static inline size_t PaddedSize(size_t length)
+{
+    return (length + 3) & ~static_cast<size_t>(3);
+}
+
+/*
+ * Feed the message from pos up to miStart to the HMAC and up to fpStart to
+ * the CRC in one pass.  The message header has been fed to both already.
+ * Passing NULL for one of the ends leaves that computation out.
+ */
+static void DigestBody(const uint8_t* pos, const uint8_t* miStart, Crypto_SHA1& sha1,
+                       const uint8_t* fpStart, uint32_t& crc)
+{
+    const uint8_t* stop = (fpStart != NULL) ? fpStart : miStart;
+
+    assert((miStart == NULL) || (fpStart == NULL) || (miStart <= fpStart));
+
+    while (pos < stop) {
+        size_t chunk = stop - pos;
+        if (chunk > DIGEST_CHUNK_SIZE) {
+            chunk = DIGEST_CHUNK_SIZE;
+        }
+        if ((miStart != NULL) && (pos < miStart)) {
+            size_t miChunk = miStart - pos;
+            sha1.Update(pos, (miChunk < chunk) ? miChunk : chunk);
+        }
+        if (fpStart != NULL) {
+            crc = StunAttributeFingerprint::ComputeCRC(pos, chunk, crc);
+        }
+        pos += chunk;
+    }
+}
+
+
+QStatus StunMessageView::Parse(const uint8_t* buf, size_t bufSize)
+{
+    QStatus status = ER_OK;
+    const uint8_t* pos;
+    const uint8_t* msgEnd;
+
+    QCC_DbgTrace(("StunMessageView::Parse(*buf, bufSize = %u)", bufSize));
+
+    assert(buf != NULL);
+
+    rawMsg = NULL;
+    msgSize = 0;
+    numAttrs = 0;
+    miAttr = NULL;
+    fpAttr = NULL;
+
+    if (bufSize < StunMessage::MIN_MSG_SIZE) {
+        status = ER_BUFFER_TOO_SMALL;
+        QCC_LogError(status, ("Checking header size"));
+        return status;
+    }
+
+    rawMsgType = GetUInt16(buf);
+    msgSize = StunMessage::MIN_MSG_SIZE + StunMessage::ParseMessageSize(buf);
+
+    if (!StunMessage::IsTypeOK(rawMsgType)) {
+        status = ER_STUN_INVALID_MSG_TYPE;
+        QCC_DbgRemoteError(("Invalid message type: %04x", rawMsgType));
+        return status;
+    }
+
+    if (msgSize > bufSize) {
+        status = ER_BUFFER_TOO_SMALL;
+        QCC_DbgRemoteError(("Checking message size (missing %u bytes)", msgSize - bufSize));
+        return status;
+    }
+
+    rawMsg = buf;
+    msgEnd = buf + msgSize;
+
+    for (pos = buf + StunMessage::MIN_MSG_SIZE; pos < msgEnd;) {
+        uint16_t type;
+        uint16_t length;
+
+        if (static_cast<size_t>(msgEnd - pos) < StunAttribute::ATTR_HEADER_SIZE) {
+            status = ER_STUN_ATTR_SIZE_MISMATCH;
+            break;
+        }
+        type = GetUInt16(pos);
+        length = GetUInt16(pos + sizeof(uint16_t));
+        pos += StunAttribute::ATTR_HEADER_SIZE;
+
+        if (static_cast<size_t>(msgEnd - pos) < length) {
+            status = ER_STUN_ATTR_SIZE_MISMATCH;
+            break;
+        }
+
+        /*
+         * Only FINGERPRINT may follow MESSAGE-INTEGRITY and nothing may
+         * follow FINGERPRINT.  Anything else is ignored rather than indexed.
+         */
+        if ((fpAttr == NULL) && ((miAttr == NULL) || (type == STUN_ATTR_FINGERPRINT))) {
+            if (numAttrs == MAX_ATTRIBUTES) {
+                status = ER_STUN_TOO_MANY_ATTRIBUTES;
+                break;
+            }
+            Attribute& attr = attrs[numAttrs++];
+            attr.type = type;
+            attr.length = length;
+            attr.value = pos;
+
+            if ((type == STUN_ATTR_MESSAGE_INTEGRITY) && (length == Crypto_SHA1::DIGEST_SIZE)) {
+                miAttr = &attr;
+            } else if ((type == STUN_ATTR_FINGERPRINT) && (length == StunAttributeFingerprint::ATTR_SIZE)) {
+                fpAttr = &attr;
+            }
+        }
+
+        pos += PaddedSize(length);
+    }
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Parsing attribute %u", numAttrs));
+        rawMsg = NULL;
+        numAttrs = 0;
+        miAttr = NULL;
+        fpAttr = NULL;
+    }
+    return status;
+}
+
+
+QStatus StunMessageView::Verify(const uint8_t* hmacKey, size_t keyLen) const
+{
+    QStatus status = ER_OK;
+    Crypto_SHA1 sha1;
+    uint32_t crc = 0;
+    const uint8_t* miStart = NULL;
+    const uint8_t* fpStart = NULL;
+
+    QCC_DbgTrace(("StunMessageView::Verify(hmacKey = %p, keyLen = %u)", hmacKey, keyLen));
+
+    assert(rawMsg != NULL);
+
+    if (hmacKey != NULL) {
+        if (miAttr == NULL) {
+            status = ER_STUN_INVALID_MESSAGE_INTEGRITY;
+            QCC_DbgRemoteError(("Message has no MESSAGE-INTEGRITY"));
+            return status;
+        }
+        miStart = miAttr->value - StunAttribute::ATTR_HEADER_SIZE;
+    }
+    if (fpAttr != NULL) {
+        fpStart = fpAttr->value - StunAttribute::ATTR_HEADER_SIZE;
+    }
+    if ((miStart == NULL) && (fpStart == NULL)) {
+        return status;
+    }
+
+    /*
+     * The HMAC is computed with the length field set as if the message ended
+     * with MESSAGE-INTEGRITY (RFC 5389 section 15.4) while the CRC uses the
+     * length field as received.
+     */
+    if (miStart != NULL) {
+        uint8_t lengthBuf[sizeof(uint16_t)];
+        PutUInt16(lengthBuf, static_cast<uint16_t>((miStart + MI_ATTR_SIZE_WITH_HEADER) -
+                                                   (rawMsg + StunMessage::MIN_MSG_SIZE)));
+        sha1.Init(hmacKey, keyLen);
+        sha1.Update(rawMsg, sizeof(uint16_t));
+        sha1.Update(lengthBuf, sizeof(lengthBuf));
+    }
+    if (fpStart != NULL) {
+        crc = StunAttributeFingerprint::ComputeCRC(rawMsg, 2 * sizeof(uint16_t), crc);
+    }
+
+    DigestBody(rawMsg + 2 * sizeof(uint16_t), miStart, sha1, fpStart, crc);
+
+    if (miStart != NULL) {
+        uint8_t digest[Crypto_SHA1::DIGEST_SIZE];
+        sha1.GetDigest(digest);
+        if (memcmp(digest, miAttr->value, sizeof(digest)) != 0) {
+            status = ER_STUN_INVALID_MESSAGE_INTEGRITY;
+            QCC_DbgRemoteError(("Verifying message integrity"));
+            return status;
+        }
+    }
+
+    if (fpStart != NULL) {
+        uint32_t fingerprint = (static_cast<uint32_t>(GetUInt16(fpAttr->value)) << 16) |
+                               GetUInt16(fpAttr->value + sizeof(uint16_t));
+        if ((fingerprint ^ StunAttributeFingerprint::MAGIC_XOR) != crc) {
+            status = ER_STUN_INVALID_FINGERPRINT;
+            QCC_DbgRemoteError(("Verifying STUN message fingerprint"));
+        }
+    }
+    return status;
+}
+
+
+const StunMessageView::Attribute* StunMessageView::FindAttribute(StunAttrType type) const
+{
+    for (size_t i = 0; i < numAttrs; ++i) {
+        if (attrs[i].type == type) {
+            return &attrs[i];
+        }
+    }
+    return NULL;
+}
+
+
+QStatus StunMessageView::GetXorAddress(const Attribute& attr, IPAddress& addr, uint16_t& port) const
+{
+    uint8_t xorAddr[IPAddress::IPv6_SIZE];
+    const uint8_t* xorBytes = rawMsg + 2 * sizeof(uint16_t);  // Magic cookie and transaction ID.
+    size_t addrLen;
+
+    if (attr.length < XOR_ADDR_HEADER_SIZE) {
+        return ER_STUN_ATTR_SIZE_MISMATCH;
+    }
+
+    switch (attr.value[1]) {
+    case FAMILY_IPV4:
+        addrLen = IPAddress::IPv4_SIZE;
+        break;
+
+    case FAMILY_IPV6:
+        addrLen = IPAddress::IPv6_SIZE;
+        break;
+
+    default:
+        return ER_STUN_INVALID_ADDR_FAMILY;
+    }
+
+    if (attr.length != XOR_ADDR_HEADER_SIZE + addrLen) {
+        return ER_STUN_ATTR_SIZE_MISMATCH;
+    }
+
+    for (size_t i = 0; i < addrLen; ++i) {
+        xorAddr[i] = attr.value[XOR_ADDR_HEADER_SIZE + i] ^ xorBytes[i];
+    }
+    addr = IPAddress(xorAddr, addrLen);
+    port = GetUInt16(attr.value + sizeof(uint16_t)) ^ static_cast<uint16_t>(StunMessage::MAGIC_COOKIE >> 16);
+
+    return ER_OK;
+}
+
+
+QStatus StunMessageView::GetUInt32(const Attribute& attr, uint32_t& value)
+{
+    if (attr.length != sizeof(value)) {
+        return ER_STUN_ATTR_SIZE_MISMATCH;
+    }
+    value = (static_cast<uint32_t>(GetUInt16(attr.value)) << 16) | GetUInt16(attr.value + sizeof(uint16_t));
+    return ER_OK;
+}
+
+
+void StunMessageView::GetString(const Attribute& attr, String& str)
+{
+    str = String(reinterpret_cast<const char*>(attr.value), attr.length);
+}
+
+
+QStatus StunMessageView::GetErrorCode(const Attribute& attr, StunErrorCodes& error)
+{
+    uint8_t errClass;
+    uint8_t errNum;
+
+    if (attr.length < sizeof(uint32_t)) {
+        return ER_STUN_ATTR_SIZE_MISMATCH;
+    }
+
+    errClass = attr.value[2] & 0x07;  // Ignore the upper bits per RFC 5389 sec. 15.6
+    errNum = attr.value[3];
+    if ((errClass < 3) || (errClass > 6) || (errNum > 99)) {
+        return ER_STUN_INVALID_ERROR_CODE;
+    }
+
+    error = static_cast<StunErrorCodes>(errClass * 100 + errNum);
+    return ER_OK;
+}
+
+
+void StunMessageView::GetTransactionID(StunTransactionID& tid) const
+{
+    const uint8_t* pos = rawMsg + StunMessage::HEADER_SIZE;
+    size_t size = StunTransactionID::SIZE;
+
+    assert(rawMsg != NULL);
+
+    tid.Parse(pos, size);
+}
+
+
+StunMessageBuilder::StunMessageBuilder(uint8_t* buf, size_t bufSize,
+                                       StunMsgTypeClass msgClass, StunMsgTypeMethod msgMethod,
+                                       const StunTransactionID& tid) :
+    buf(buf), end(buf + bufSize), pos(buf), status(ER_OK)
+{
+    assert(buf != NULL);
+
+    if (bufSize < StunMessage::MIN_MSG_SIZE) {
+        status = ER_BUFFER_TOO_SMALL;
+        QCC_LogError(status, ("Checking buffer size"));
+        return;
+    }
+
+    PutUInt16(pos, StunMessage::FormatMsgType(msgClass, msgMethod));
+    PutUInt16(pos + sizeof(uint16_t), 0);
+    PutUInt32(pos + 2 * sizeof(uint16_t), StunMessage::MAGIC_COOKIE);
+    memcpy(pos + StunMessage::HEADER_SIZE, tid.id, StunTransactionID::SIZE);
+    pos += StunMessage::MIN_MSG_SIZE;
+}
+
+
+void StunMessageBuilder::SetLength(size_t length)
+{
+    PutUInt16(buf + sizeof(uint16_t), static_cast<uint16_t>(length));
+}
+
+
+QStatus StunMessageBuilder::ReserveAttribute(StunAttrType type, uint16_t length, uint8_t*& value)
+{
+    size_t padded = PaddedSize(length);
+
+    if (status != ER_OK) {
+        return status;
+    }
+
+    if (static_cast<size_t>(end - pos) < (StunAttribute::ATTR_HEADER_SIZE + padded)) {
+        status = ER_BUFFER_TOO_SMALL;
+        QCC_LogError(status, ("Adding attribute %04x (%u bytes)", type, length));
+        return status;
+    }
+
+    PutUInt16(pos, static_cast<uint16_t>(type));
+    PutUInt16(pos + sizeof(uint16_t), length);
+    pos += StunAttribute::ATTR_HEADER_SIZE;
+    value = pos;
+    memset(pos + length, 0, padded - length);
+    pos += padded;
+    SetLength(pos - (buf + StunMessage::MIN_MSG_SIZE));
+
+    return status;
+}
+
+
+QStatus StunMessageBuilder::AddAttribute(StunAttrType type, const void* value, uint16_t length)
+{
+    uint8_t* dest;
+    QStatus result = ReserveAttribute(type, length, dest);
+    if ((result == ER_OK) && (length > 0)) {
+        memcpy(dest, value, length);
+    }
+    return result;
+}
+
+
+QStatus StunMessageBuilder::AddUInt32(StunAttrType type, uint32_t value)
+{
+    uint8_t* dest;
+    QStatus result = ReserveAttribute(type, sizeof(value), dest);
+    if (result == ER_OK) {
+        PutUInt32(dest, value);
+    }
+    return result;
+}
+
+
+QStatus StunMessageBuilder::AddUInt64(StunAttrType type, uint64_t value)
+{
+    uint8_t* dest;
+    QStatus result = ReserveAttribute(type, sizeof(value), dest);
+    if (result == ER_OK) {
+        PutUInt32(dest, static_cast<uint32_t>(value >> 32));
+        PutUInt32(dest + sizeof(uint32_t), static_cast<uint32_t>(value & 0xffffffff));
+    }
+    return result;
+}
+
+
+QStatus StunMessageBuilder::AddXorAddress(StunAttrType type, const IPAddress& addr, uint16_t port)
+{
+    uint8_t ipBuf[IPAddress::IPv6_SIZE];
+    const uint8_t* xorBytes = buf + 2 * sizeof(uint16_t);  // Magic cookie and transaction ID.
+    size_t addrLen = addr.Size();
+    uint8_t family;
+    uint8_t* dest;
+    QStatus result;
+
+    switch (addrLen) {
+    case IPAddress::IPv4_SIZE:
+        family = FAMILY_IPV4;
+        break;
+
+    case IPAddress::IPv6_SIZE:
+        family = FAMILY_IPV6;
+        break;
+
+    default:
+        result = ER_STUN_INVALID_ADDR_FAMILY;
+        QCC_LogError(result, ("Adding XOR address attribute %04x", type));
+        return result;
+    }
+
+    result = addr.RenderIPBinary(ipBuf, addrLen);
+    if (result != ER_OK) {
+        return result;
+    }
+
+    result = ReserveAttribute(type, static_cast<uint16_t>(XOR_ADDR_HEADER_SIZE + addrLen), dest);
+    if (result == ER_OK) {
+        dest[0] = 0;
+        dest[1] = family;
+        PutUInt16(dest + sizeof(uint16_t), port ^ static_cast<uint16_t>(StunMessage::MAGIC_COOKIE >> 16));
+        for (size_t i = 0; i < addrLen; ++i) {
+            dest[XOR_ADDR_HEADER_SIZE + i] = ipBuf[i] ^ xorBytes[i];
+        }
+    }
+    return result;
+}
+
+
+QStatus StunMessageBuilder::AddErrorCode(StunErrorCodes error, const String& reason)
+{
+    uint8_t* dest;
+    QStatus result = ReserveAttribute(STUN_ATTR_ERROR_CODE,
+                                      static_cast<uint16_t>(sizeof(uint32_t) + reason.size()), dest);
+    if (result == ER_OK) {
+        PutUInt16(dest, 0);
+        dest[2] = static_cast<uint8_t>(error / 100);
+        dest[3] = static_cast<uint8_t>(error % 100);
+        memcpy(dest + sizeof(uint32_t), reason.data(), reason.size());
+    }
+    return result;
+}
+
+
+QStatus StunMessageBuilder::Finish(const uint8_t* hmacKey, size_t keyLen, bool fingerprint)
+{
+    size_t miSize = (hmacKey != NULL) ? MI_ATTR_SIZE_WITH_HEADER : 0;
+    size_t fpSize = fingerprint ? StunAttributeFingerprint::ATTR_SIZE_WITH_HEADER : 0;
+    uint8_t* miStart = pos;
+    uint8_t* fpStart = pos + miSize;
+    uint8_t* msgEnd = fpStart + fpSize;
+    Crypto_SHA1 sha1;
+    uint32_t crc = 0;
+
+    if (status != ER_OK) {
+        return status;
+    }
+
+    if (static_cast<size_t>(end - pos) < (miSize + fpSize)) {
+        status = ER_BUFFER_TOO_SMALL;
+        QCC_LogError(status, ("Adding MESSAGE-INTEGRITY and FINGERPRINT"));
+        return status;
+    }
+
+    /*
+     * The header gets the final length, which is what the CRC covers.  The
+     * HMAC is computed with the length of the message ending with
+     * MESSAGE-INTEGRITY (RFC 5389 section 15.4).
+     */
+    SetLength(msgEnd - (buf + StunMessage::MIN_MSG_SIZE));
+
+    if (hmacKey != NULL) {
+        uint8_t lengthBuf[sizeof(uint16_t)];
+        PutUInt16(lengthBuf, static_cast<uint16_t>(fpStart - (buf + StunMessage::MIN_MSG_SIZE)));
+        sha1.Init(hmacKey, keyLen);
+        sha1.Update(buf, sizeof(uint16_t));
+        sha1.Update(lengthBuf, sizeof(lengthBuf));
+    }
+    if (fingerprint) {
+        crc = StunAttributeFingerprint::ComputeCRC(buf, 2 * sizeof(uint16_t), crc);
+    }
+
+    DigestBody(buf + 2 * sizeof(uint16_t),
+               (hmacKey != NULL) ? miStart : NULL, sha1,
+               fingerprint ? miStart : NULL, crc);
+
+    if (hmacKey != NULL) {
+        PutUInt16(miStart, STUN_ATTR_MESSAGE_INTEGRITY);
+        PutUInt16(miStart + sizeof(uint16_t), Crypto_SHA1::DIGEST_SIZE);
+        sha1.GetDigest(miStart + StunAttribute::ATTR_HEADER_SIZE);
+        if (fingerprint) {
+            crc = StunAttributeFingerprint::ComputeCRC(miStart, miSize, crc);
+        }
+    }
+
+    if (fingerprint) {
+        PutUInt16(fpStart, STUN_ATTR_FINGERPRINT);
+        PutUInt16(fpStart + sizeof(uint16_t), StunAttributeFingerprint::ATTR_SIZE);
+        PutUInt32(fpStart + StunAttribute::ATTR_HEADER_SIZE, crc ^ StunAttributeFingerprint::MAGIC_XOR);
+    }
+
+    pos = msgEnd;
+    return status;
+}
@@ -0,0 +1,354 @@
+#ifndef _STUNMESSAGEVIEW_H
+#define _STUNMESSAGEVIEW_H
+/**
+ * @file
+ *
+ * This file defines the allocation free STUN message parser and builder.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include StunMessageView.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <qcc/IPAddress.h>
+#include <qcc/String.h>
+#include <StunMessage.h>
+#include <StunTransactionID.h>
+#include <types.h>
+#include "Status.h"
+
+using namespace qcc;
+
+/** @internal */
+#define QCC_MODULE "STUN_MESSAGE"
+
+
+/**
+ * The StunMessageView class parses a STUN message in place.  Rather than
+ * creating a StunAttribute object for every attribute like StunMessage does,
+ * the attributes are recorded in a fixed size index of type, length and
+ * pointer into the received buffer.  Nothing is allocated or copied so the
+ * buffer must remain valid for as long as the view is used.
+ *
+ * This is intended for the high volume paths (connectivity checks,
+ * keepalives and TURN Data indications) that only need to look at a few
+ * attributes of each message.
+ */
+class StunMessageView {
+  public:
+
+    /**
+     * A STUN message attribute as found in the parsed buffer.
+     */
+    struct Attribute {
+        uint16_t type;          ///< STUN attribute type.
+        uint16_t length;        ///< Length of the attribute value without padding.
+        const uint8_t* value;   ///< Attribute value in the parsed buffer.
+    };
+
+    /// Maximum number of attributes recorded in the index.
+    static const size_t MAX_ATTRIBUTES = 32;
+
+    /**
+     * Construct an empty view.
+     */
+    StunMessageView(void) :
+        rawMsg(NULL), msgSize(0), rawMsgType(0), numAttrs(0), miAttr(NULL), fpAttr(NULL)
+    { }
+
+    /**
+     * Parse the STUN message at the beginning of a buffer.  The header and
+     * the attribute framing are checked but the attribute values are left
+     * for the caller to interpret.  Attributes following MESSAGE-INTEGRITY,
+     * other than FINGERPRINT, are ignored as required by RFC 5389 section
+     * 15.4.
+     *
+     * @param buf       Buffer containing the STUN message.
+     * @param bufSize   Number of octets in the buffer.
+     *
+     * @return  - ER_OK if the message is well formed.
+     *          - ER_BUFFER_TOO_SMALL if the buffer does not hold the whole message.
+     *          - ER_STUN_INVALID_MSG_TYPE if the message type is not valid.
+     *          - ER_STUN_ATTR_SIZE_MISMATCH if an attribute overruns the message.
+     *          - ER_STUN_TOO_MANY_ATTRIBUTES if the message has more than
+     *            MAX_ATTRIBUTES attributes.
+     */
+    QStatus Parse(const uint8_t* buf, size_t bufSize);
+
+    /**
+     * Check the MESSAGE-INTEGRITY and FINGERPRINT attributes of the parsed
+     * message.  The HMAC-SHA1 and the CRC-32 are computed together in a
+     * single pass over the message.  MESSAGE-INTEGRITY is only checked if a
+     * key is provided and FINGERPRINT only if the message has one.
+     *
+     * @param hmacKey   HMAC key for MESSAGE-INTEGRITY or NULL to skip the check.
+     * @param keyLen    Length of the HMAC key.
+     *
+     * @return  - ER_OK if the attributes that were checked are valid.
+     *          - ER_STUN_INVALID_MESSAGE_INTEGRITY if the HMAC does not match
+     *            or a key was provided and the message has no
+     *            MESSAGE-INTEGRITY.
+     *          - ER_STUN_INVALID_FINGERPRINT if the CRC does not match.
+     */
+    QStatus Verify(const uint8_t* hmacKey, size_t keyLen) const;
+
+    /**
+     * Find the first attribute of a given type.
+     *
+     * @param type  The STUN attribute type.
+     *
+     * @return  The attribute or NULL if the message does not have one.
+     */
+    const Attribute* FindAttribute(StunAttrType type) const;
+
+    /**
+     * Decode an XOR address attribute (XOR-MAPPED-ADDRESS, XOR-PEER-ADDRESS
+     * or XOR-RELAYED-ADDRESS).
+     *
+     * @param attr  The attribute.
+     * @param addr  OUT: The IP address.
+     * @param port  OUT: The port.
+     *
+     * @return  ER_OK, ER_STUN_ATTR_SIZE_MISMATCH or ER_STUN_INVALID_ADDR_FAMILY.
+     */
+    QStatus GetXorAddress(const Attribute& attr, IPAddress& addr, uint16_t& port) const;
+
+    /**
+     * Decode a 32 bit attribute such as PRIORITY or LIFETIME.
+     *
+     * @param attr  The attribute.
+     * @param value OUT: The attribute value.
+     *
+     * @return  ER_OK or ER_STUN_ATTR_SIZE_MISMATCH.
+     */
+    static QStatus GetUInt32(const Attribute& attr, uint32_t& value);
+
+    /**
+     * Decode a string attribute such as USERNAME or SOFTWARE.
+     *
+     * @param attr  The attribute.
+     * @param str   OUT: The attribute value.
+     */
+    static void GetString(const Attribute& attr, String& str);
+
+    /**
+     * Decode the error code number of an ERROR-CODE attribute.  The reason
+     * phrase is not decoded.
+     *
+     * @param attr  The attribute.
+     * @param error OUT: The error code.
+     *
+     * @return  ER_OK, ER_STUN_ATTR_SIZE_MISMATCH or ER_STUN_INVALID_ERROR_CODE.
+     */
+    static QStatus GetErrorCode(const Attribute& attr, StunErrorCodes& error);
+
+    /**
+     * Get the transaction ID of the message.
+     *
+     * @param tid   OUT: The transaction ID.
+     */
+    void GetTransactionID(StunTransactionID& tid) const;
+
+    /**
+     * Get the number of attributes in the index.
+     */
+    size_t GetAttributeCount(void) const { return numAttrs; }
+
+    /**
+     * Get an attribute from the index.
+     *
+     * @param index     Index of the attribute, less than GetAttributeCount().
+     */
+    const Attribute& GetAttribute(size_t index) const { return attrs[index]; }
+
+    StunMsgTypeClass GetTypeClass(void) const { return StunMessage::ExtractMessageClass(rawMsgType); }
+
+    StunMsgTypeMethod GetTypeMethod(void) const { return StunMessage::ExtractMessageMethod(rawMsgType); }
+
+    /**
+     * Get the size of the whole message including the header.
+     */
+    size_t Size(void) const { return msgSize; }
+
+  private:
+
+    /* Copying would leave the attribute index pointing into the original */
+    StunMessageView(const StunMessageView& other);
+    StunMessageView& operator=(const StunMessageView& other);
+
+    const uint8_t* rawMsg;          ///< Start of the parsed message.
+    size_t msgSize;                 ///< Size of the message including the header.
+    uint16_t rawMsgType;            ///< Message type field.
+    Attribute attrs[MAX_ATTRIBUTES]; ///< Attribute index.
+    size_t numAttrs;                ///< Number of attributes in the index.
+    const Attribute* miAttr;        ///< MESSAGE-INTEGRITY attribute or NULL.
+    const Attribute* fpAttr;        ///< FINGERPRINT attribute or NULL.
+};
+
+
+/**
+ * The StunMessageBuilder class renders a STUN message directly into a
+ * caller supplied buffer, typically a send buffer that is reused from one
+ * message to the next.  Attributes are written in the order they are added;
+ * Finish() appends MESSAGE-INTEGRITY and FINGERPRINT and fills in the
+ * message length.
+ */
+class StunMessageBuilder {
+  public:
+
+    /**
+     * Largest STUN message to send over UDP when the path MTU is not known
+     * (RFC 5389 section 7.1).  Connectivity checks and their responses are
+     * built in buffers of this size.
+     */
+    static const size_t MAX_UDP_MSG_SIZE = 548;
+
+    /**
+     * Start building a message.
+     *
+     * @param buf       Buffer where the message is rendered.
+     * @param bufSize   Size of the buffer.
+     * @param msgClass  STUN message class.
+     * @param msgMethod STUN message method.
+     * @param tid       Transaction ID of the message.
+     */
+    StunMessageBuilder(uint8_t* buf, size_t bufSize,
+                       StunMsgTypeClass msgClass, StunMsgTypeMethod msgMethod,
+                       const StunTransactionID& tid);
+
+    /**
+     * Append an attribute.  The value is padded to a multiple of 4 octets.
+     *
+     * @param type      STUN attribute type.
+     * @param value     Attribute value, may be NULL if length is 0.
+     * @param length    Length of the attribute value.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus AddAttribute(StunAttrType type, const void* value, uint16_t length);
+
+    /**
+     * Append an attribute whose value the caller writes in place.  The
+     * padding is cleared by the builder.
+     *
+     * @param type      STUN attribute type.
+     * @param length    Length of the attribute value.
+     * @param value     OUT: Where the caller must write the value.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus ReserveAttribute(StunAttrType type, uint16_t length, uint8_t*& value);
+
+    /**
+     * Append a string attribute such as USERNAME or SOFTWARE.
+     *
+     * @param type  STUN attribute type.
+     * @param str   Attribute value.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus AddString(StunAttrType type, const String& str)
+    {
+        return AddAttribute(type, str.data(), static_cast<uint16_t>(str.size()));
+    }
+
+    /**
+     * Append a 32 bit attribute such as PRIORITY or LIFETIME.
+     *
+     * @param type  STUN attribute type.
+     * @param value Attribute value.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus AddUInt32(StunAttrType type, uint32_t value);
+
+    /**
+     * Append a 64 bit attribute such as ICE-CONTROLLING.
+     *
+     * @param type  STUN attribute type.
+     * @param value Attribute value.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus AddUInt64(StunAttrType type, uint64_t value);
+
+    /**
+     * Append an XOR address attribute.
+     *
+     * @param type  STUN attribute type (XOR-MAPPED-ADDRESS, XOR-PEER-ADDRESS
+     *              or XOR-RELAYED-ADDRESS).
+     * @param addr  IP address.
+     * @param port  Port.
+     *
+     * @return  ER_OK, ER_BUFFER_TOO_SMALL or ER_STUN_INVALID_ADDR_FAMILY.
+     */
+    QStatus AddXorAddress(StunAttrType type, const IPAddress& addr, uint16_t port);
+
+    /**
+     * Append an ERROR-CODE attribute.
+     *
+     * @param error     Error code.
+     * @param reason    Reason phrase.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus AddErrorCode(StunErrorCodes error, const String& reason);
+
+    /**
+     * Complete the message.  MESSAGE-INTEGRITY is appended if a key is
+     * provided and FINGERPRINT if requested.  The HMAC-SHA1 and the CRC-32
+     * are computed together in a single pass over the message.  No
+     * attributes may be added afterwards.
+     *
+     * @param hmacKey       HMAC key for MESSAGE-INTEGRITY or NULL to omit it.
+     * @param keyLen        Length of the HMAC key.
+     * @param fingerprint   true to append FINGERPRINT.
+     *
+     * @return  ER_OK or ER_BUFFER_TOO_SMALL.
+     */
+    QStatus Finish(const uint8_t* hmacKey, size_t keyLen, bool fingerprint);
+
+    /**
+     * Get the start of the rendered message.
+     */
+    const uint8_t* GetBuffer(void) const { return buf; }
+
+    /**
+     * Get the number of octets rendered so far.
+     */
+    size_t Size(void) const { return pos - buf; }
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    StunMessageBuilder(const StunMessageBuilder& other);
+    StunMessageBuilder& operator=(const StunMessageBuilder& other);
+
+    /** Write the message length field */
+    void SetLength(size_t length);
+
+    uint8_t* const buf;     ///< Start of the message.
+    uint8_t* const end;     ///< End of the buffer.
+    uint8_t* pos;           ///< Where the next attribute is written.
+    QStatus status;         ///< ER_OK or the first error, which is returned from then on.
+};
+
+#undef QCC_MODULE
+#endif
@@ -102,6 +102,11 @@ class StunTransactionID : public StunIOInterface {
 
   private:
 
+    /**
+     * StunMessageBuilder copies the ID straight into the message header.
+     */
+    friend class StunMessageBuilder;
+
     uint8_t id[SIZE];      ///< The transaction ID
 
     mutable qcc::String value;
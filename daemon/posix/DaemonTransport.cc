@@ -35,6 +35,9 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "DaemonTransport.h"
+#if !defined(QCC_OS_DARWIN)
+#include "SharedMemoryStream.h"
+#endif
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -58,10 +61,26 @@ class DaemonEndpoint : public RemoteEndpoint {
         userId(-1),
         groupId(-1),
         processId(-1),
-        stream(sock)
+        stream(sock),
+        shmStream(NULL)
     {
     }
 
+    virtual ~DaemonEndpoint() { delete shmStream; }
+
+#if !defined(QCC_OS_DARWIN)
+    /**
+     * Move the endpoint onto shared memory. The socket stays open to detect the client going away.
+     *
+     * @param shmStream   The shared memory stream, this endpoint takes ownership of it.
+     */
+    void SetSharedMemoryStream(SharedMemoryStream* shmStream)
+    {
+        this->shmStream = shmStream;
+        SetStream(shmStream);
+    }
+#endif
+
     /**
      * Set the user id of the endpoint.
      *
@@ -116,6 +135,7 @@ class DaemonEndpoint : public RemoteEndpoint {
     uint32_t groupId;
     uint32_t processId;
     SocketStream stream;
+    qcc::Stream* shmStream;
 };
 
 static const int CRED_TIMEOUT = 5000;  /**< Times out credentials exchange to avoid denial of service attack */
@@ -235,11 +255,26 @@ void* DaemonTransport::Run(void* arg)
             conn->GetFeatures().isBusToBus = false;
             conn->GetFeatures().allowRemote = false;
             conn->GetFeatures().handlePassing = true;
+#if !defined(QCC_OS_DARWIN)
+            conn->GetFeatures().sharedMemory = SharedMemoryStream::IsSupported();
+#endif
 
             endpointListLock.Lock(MUTEX_CONTEXT);
             endpointList.push_back(conn);
             endpointListLock.Unlock(MUTEX_CONTEXT);
             status = conn->Establish("EXTERNAL", authName, redirection);
+#if !defined(QCC_OS_DARWIN)
+            if ((status == ER_OK) && conn->GetFeatures().sharedMemory) {
+                /*
+                 * The client agreed to use shared memory so it is going to send it to us now
+                 */
+                SharedMemoryStream* shmStream;
+                status = SharedMemoryStream::Accept(newSock, CRED_TIMEOUT, shmStream);
+                if (shmStream) {
+                    conn->SetSharedMemoryStream(shmStream);
+                }
+            }
+#endif
             if (status == ER_OK) {
                 conn->SetListener(this);
                 status = conn->Start();
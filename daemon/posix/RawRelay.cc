@@ -0,0 +1,304 @@
+/**
+ * @file
+ * Implementation of RawRelay for Linux using splice() and epoll
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+
+#include "RawRelay.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+/*
+ * Older C libraries don't define everything the kernel supports
+ */
+#ifndef EPOLLRDHUP
+#define EPOLLRDHUP 0x2000
+#endif
+#ifndef SPLICE_F_MOVE
+#define SPLICE_F_MOVE 1
+#define SPLICE_F_NONBLOCK 2
+extern "C" ssize_t splice(int fdIn, loff_t* offIn, int fdOut, loff_t* offOut, size_t len, unsigned int flags);
+#endif
+#ifndef F_SETPIPE_SZ
+#define F_SETPIPE_SZ (1024 + 7)
+#endif
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/** Size requested for the kernel pipes, the kernel default is used if this is not allowed */
+static const int PIPE_SIZE = 256 * 1024;
+
+/** Maximum number of bytes moved by a single splice() call */
+static const size_t SPLICE_CHUNK = 256 * 1024;
+
+/** Maximum number of epoll events handled per wakeup */
+static const int MAX_EVENTS = 32;
+
+/**
+ * One socket of a relayed session and the pipe holding data read from it that has not yet been
+ * written to the other socket.
+ */
+struct RawRelay::Side {
+    Relay* relay;       /**< The relay this side belongs to */
+    int sock;           /**< The socket */
+    int pipeFds[2];     /**< Read and write ends of the pipe */
+    size_t pending;     /**< Bytes in the pipe */
+    bool eof;           /**< The socket has reached end of file */
+    bool done;          /**< End of file has been passed on to the other socket */
+};
+
+/**
+ * A relayed session
+ */
+struct RawRelay::Relay {
+    SessionId id;       /**< The session */
+    Side side[2];       /**< The two sockets */
+    uint64_t bytes;     /**< Bytes relayed in both directions */
+};
+
+RawRelay::RawRelay() : qcc::Thread("RawRelay"), epollFd(-1)
+{
+    epollFd = epoll_create(MAX_EVENTS);
+    if (epollFd < 0) {
+        QCC_LogError(ER_OS_ERROR, ("RawRelay epoll_create failed: %s", strerror(errno)));
+    } else {
+        fcntl(epollFd, F_SETFD, FD_CLOEXEC);
+    }
+}
+
+RawRelay::~RawRelay()
+{
+    Stop();
+    Join();
+    lock.Lock(MUTEX_CONTEXT);
+    while (!relays.empty()) {
+        Relay* relay = *relays.begin();
+        lock.Unlock(MUTEX_CONTEXT);
+        Close(relay);
+        lock.Lock(MUTEX_CONTEXT);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+QStatus RawRelay::AddRelay(SessionId id, qcc::SocketFd sock1, qcc::SocketFd sock2)
+{
+    QStatus status = ER_OK;
+    Relay* relay = new Relay();
+    relay->id = id;
+    relay->bytes = 0;
+    for (size_t i = 0; i < 2; ++i) {
+        Side& side = relay->side[i];
+        side.relay = relay;
+        side.sock = (i == 0) ? sock1 : sock2;
+        side.pipeFds[0] = side.pipeFds[1] = -1;
+        side.pending = 0;
+        side.eof = false;
+        side.done = false;
+    }
+    /* Holding the lock keeps the relay thread away from the relay until it is set up */
+    lock.Lock(MUTEX_CONTEXT);
+    relays.insert(relay);
+
+    if (epollFd < 0) {
+        status = ER_OS_ERROR;
+    }
+    for (size_t i = 0; (status == ER_OK) && (i < 2); ++i) {
+        Side& side = relay->side[i];
+        if (pipe(side.pipeFds) != 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("RawRelay pipe failed: %s", strerror(errno)));
+            break;
+        }
+        fcntl(side.pipeFds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(side.pipeFds[1], F_SETFD, FD_CLOEXEC);
+        /* A bigger pipe means fewer wakeups, failure just leaves the default size */
+        fcntl(side.pipeFds[1], F_SETPIPE_SZ, PIPE_SIZE);
+        fcntl(side.sock, F_SETFL, fcntl(side.sock, F_GETFL) | O_NONBLOCK);
+    }
+    /*
+     * The sockets are edge triggered so their interest never needs to change, Pump() always
+     * moves data until the kernel says it would block.
+     */
+    for (size_t i = 0; (status == ER_OK) && (i < 2); ++i) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = &relay->side[i];
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, relay->side[i].sock, &ev) != 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("RawRelay epoll_ctl failed: %s", strerror(errno)));
+        }
+    }
+    if ((status == ER_OK) && !IsRunning()) {
+        status = Start();
+    }
+    if (status == ER_OK) {
+        QCC_DbgPrintf(("RawRelay relaying session %u between sockets %d and %d", id, sock1, sock2));
+    } else {
+        QCC_LogError(status, ("RawRelay failed to relay session %u", id));
+        Close(relay);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+size_t RawRelay::GetNumRelays()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    size_t num = relays.size();
+    lock.Unlock(MUTEX_CONTEXT);
+    return num;
+}
+
+bool RawRelay::Pump(Relay* relay)
+{
+    const unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < 2; ++i) {
+            Side& from = relay->side[i];
+            Side& to = relay->side[1 - i];
+            if (from.done) {
+                continue;
+            }
+            if (!from.eof) {
+                ssize_t ret = splice(from.sock, NULL, from.pipeFds[1], NULL, SPLICE_CHUNK, flags);
+                if (ret > 0) {
+                    from.pending += ret;
+                    progress = true;
+                } else if ((ret == 0) || (errno == EINTR)) {
+                    from.eof = (ret == 0);
+                    progress = true;
+                } else if (errno != EAGAIN) {
+                    QCC_DbgPrintf(("RawRelay session %u read failed: %s", relay->id, strerror(errno)));
+                    return false;
+                }
+            }
+            if (from.pending > 0) {
+                ssize_t ret = splice(from.pipeFds[0], NULL, to.sock, NULL, from.pending, flags);
+                if (ret > 0) {
+                    from.pending -= ret;
+                    relay->bytes += ret;
+                    progress = true;
+                } else if ((ret < 0) && (errno == EINTR)) {
+                    progress = true;
+                } else if ((ret == 0) || (errno != EAGAIN)) {
+                    QCC_DbgPrintf(("RawRelay session %u write failed: %s", relay->id, strerror(errno)));
+                    return false;
+                }
+            }
+            if (from.eof && (from.pending == 0)) {
+                /* Pass the half close on so the far end sees end of file too */
+                shutdown(to.sock, SHUT_WR);
+                from.done = true;
+            }
+        }
+    }
+    return !(relay->side[0].done && relay->side[1].done);
+}
+
+void RawRelay::Close(Relay* relay)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    relays.erase(relay);
+    lock.Unlock(MUTEX_CONTEXT);
+    QCC_DbgPrintf(("RawRelay session %u closed after %llu bytes", relay->id, (unsigned long long)relay->bytes));
+    for (size_t i = 0; i < 2; ++i) {
+        Side& side = relay->side[i];
+        /* Closing the socket removes it from the epoll set */
+        if (side.sock >= 0) {
+            close(side.sock);
+        }
+        if (side.pipeFds[0] >= 0) {
+            close(side.pipeFds[0]);
+            close(side.pipeFds[1]);
+        }
+    }
+    delete relay;
+}
+
+qcc::ThreadReturn STDCALL RawRelay::Run(void* arg)
+{
+    /* Writing to a socket that the peer has closed must fail with EPIPE rather than kill the daemon */
+    sigset_t sigPipe;
+    sigemptyset(&sigPipe);
+    sigaddset(&sigPipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigPipe, NULL);
+
+    qcc::Event epollEvent(epollFd, qcc::Event::IO_READ, false);
+    vector<qcc::Event*> checkEvents;
+    checkEvents.push_back(&stopEvent);
+    checkEvents.push_back(&epollEvent);
+
+    while (!IsStopping()) {
+        vector<qcc::Event*> signaledEvents;
+        QStatus status = qcc::Event::Wait(checkEvents, signaledEvents);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("RawRelay Event::Wait failed"));
+            break;
+        }
+        if (stopEvent.IsSet()) {
+            break;
+        }
+        struct epoll_event events[MAX_EVENTS];
+        int numEvents = epoll_wait(epollFd, events, MAX_EVENTS, 0);
+        for (int i = 0; i < numEvents; ++i) {
+            Side* side = static_cast<Side*>(events[i].data.ptr);
+            Relay* relay = side->relay;
+            lock.Lock(MUTEX_CONTEXT);
+            /* A relay closed earlier in this batch may still have a queued event */
+            if (relays.find(relay) != relays.end()) {
+                bool active = Pump(relay);
+                /* Nothing more can be written to a socket that has hung up once its data has been read */
+                if (active && (events[i].events & (EPOLLHUP | EPOLLERR)) && side->done) {
+                    active = false;
+                }
+                if (!active) {
+                    Close(relay);
+                }
+            }
+            lock.Unlock(MUTEX_CONTEXT);
+        }
+    }
+    return 0;
+}
+
+}
@@ -22,6 +22,8 @@
 #include <qcc/platform.h>
 
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 #ifndef QCC_OS_ANDROID
 #include <pwd.h>
 #endif
@@ -152,6 +154,32 @@ void SignalHandler(int sig) {
     }
 }
 
+/*
+ * Threads are created with the default pthread attributes so the only way to change their stack
+ * size without touching the thread library is to change the process wide default.
+ */
+static void SetDefaultThreadStackSize(uint32_t stackSize)
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 18))
+    pthread_attr_t attr;
+    if (stackSize < PTHREAD_STACK_MIN) {
+        stackSize = PTHREAD_STACK_MIN;
+    }
+    if (pthread_attr_init(&attr) == 0) {
+        int ret = pthread_attr_setstacksize(&attr, stackSize);
+        if (ret == 0) {
+            ret = pthread_setattr_default_np(&attr);
+        }
+        if (ret != 0) {
+            Log(LOG_WARNING, "Failed to set thread stack size to %u: %s\n", stackSize, strerror(ret));
+        }
+        pthread_attr_destroy(&attr);
+    }
+#else
+    Log(LOG_WARNING, "Setting the thread stack size is not supported on this platform\n");
+#endif
+}
+
 class OptParse {
   public:
     enum ParseResultCode {
@@ -548,6 +576,15 @@ int daemon(OptParse& opts) {
 #warning ICE transport factory is not operational yet for Windows and Darwin
 #endif
 
+    /*
+     * Daemons on memory constrained devices can shrink the stacks of the endpoint and transport
+     * threads. They must be sized before the bus creates any threads.
+     */
+    uint32_t stackSize = config->Get("limit@thread_stack_size", 0);
+    if (stackSize) {
+        SetDefaultThreadStackSize(stackSize);
+    }
+
     Bus ajBus("alljoyn-daemon", cntr, listenSpecs.c_str());
 
     /*
@@ -616,6 +653,9 @@ int daemon(OptParse& opts) {
             FileSource fs(opts.GetConfigFile());
             if (fs.IsValid()) {
                 config = DaemonConfig::Load(fs);
+                if (config) {
+                    reinterpret_cast<DaemonRouter&>(ajBus.GetInternal().GetRouter()).LoadPolicy(*config);
+                }
             }
         }
     }
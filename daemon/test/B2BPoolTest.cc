@@ -0,0 +1,141 @@
+/**
+ * @file
+ * Bus-to-bus connection pooling tester, checks which existing connection to a remote daemon a new
+ * session shares and when a new connection is made instead
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <alljoyn/Session.h>
+#include <alljoyn/TransportMask.h>
+
+#include <Status.h>
+
+#include "AllJoynObj.h"
+
+#define QCC_MODULE "B2BPOOLTEST"
+
+using namespace std;
+using namespace ajn;
+
+static uint32_t g_maxDepth = 8;
+
+static void Usage(void)
+{
+    printf("Usage: b2bpool [-h] [-d <depth>]\n\n");
+    printf("Options:\n");
+    printf("   -h              - Print this help message\n");
+    printf("   -d <depth>      - Queue depth at which a connection is no longer shared (default %u)\n", g_maxDepth);
+    printf("\n");
+}
+
+static AllJoynObj::PooledB2BCandidate Candidate(bool direct, TransportMask transport, size_t txQueueDepth)
+{
+    AllJoynObj::PooledB2BCandidate c = { direct, transport, txQueueDepth };
+    return c;
+}
+
+/** Check the candidate chosen for a session, expected is candidates.size() when a new connection is expected */
+static uint32_t Check(const char* what, const vector<AllJoynObj::PooledB2BCandidate>& candidates, const SessionOpts& opts, uint32_t maxDepth, size_t expected)
+{
+    size_t chosen = AllJoynObj::SelectPooledB2BEndpoint(candidates, opts, maxDepth);
+    if (chosen != expected) {
+        printf("%s: chose %u, expected %u\n", what, (uint32_t)chosen, (uint32_t)expected);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-d", argv[i])) && (++i < argc)) {
+            g_maxDepth = strtoul(argv[i], NULL, 10);
+        } else {
+            Usage();
+            exit(1);
+        }
+    }
+    if (g_maxDepth < 2) {
+        printf("The queue depth must be at least 2\n");
+        exit(1);
+    }
+
+    uint32_t numFailed = 0;
+    SessionOpts messages(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+    SessionOpts wlanOnly(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_WLAN);
+    vector<AllJoynObj::PooledB2BCandidate> candidates;
+
+    /* Without a connection to the remote daemon a new one is made */
+    numFailed += Check("No connection", candidates, messages, g_maxDepth, candidates.size());
+
+    /* An idle direct connection is reused */
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, 0));
+    numFailed += Check("Idle connection", candidates, messages, g_maxDepth, 0);
+
+    /* The least loaded connection below the limit is chosen */
+    candidates.clear();
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, g_maxDepth - 1));
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, 0));
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, g_maxDepth));
+    numFailed += Check("Least loaded connection", candidates, messages, g_maxDepth, 1);
+
+    /* Once every connection has maxDepth or more messages queued a new one is made */
+    candidates.clear();
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, g_maxDepth));
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, g_maxDepth + 10));
+    numFailed += Check("All connections full", candidates, messages, g_maxDepth, candidates.size());
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, g_maxDepth - 1));
+    numFailed += Check("One connection below the limit", candidates, messages, g_maxDepth, 2);
+
+    /* A depth of zero turns sharing off */
+    candidates.clear();
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, 0));
+    numFailed += Check("Sharing off", candidates, messages, 0, candidates.size());
+
+    /* Only connections on the session's transports are shared */
+    candidates.clear();
+    candidates.push_back(Candidate(true, TRANSPORT_BLUETOOTH, 0));
+    candidates.push_back(Candidate(true, TRANSPORT_NONE, 0));
+    numFailed += Check("Other transports", candidates, wlanOnly, g_maxDepth, candidates.size());
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, 1));
+    numFailed += Check("Session transport", candidates, wlanOnly, g_maxDepth, 2);
+    numFailed += Check("Any transport", candidates, messages, g_maxDepth, 0);
+
+    /* Connections routed through another daemon are not shared */
+    candidates.clear();
+    candidates.push_back(Candidate(false, TRANSPORT_WLAN, 0));
+    numFailed += Check("Indirect connection", candidates, messages, g_maxDepth, candidates.size());
+
+    /* Raw sessions always get a connection of their own */
+    candidates.clear();
+    candidates.push_back(Candidate(true, TRANSPORT_WLAN, 0));
+    SessionOpts rawReliable(SessionOpts::TRAFFIC_RAW_RELIABLE, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+    SessionOpts rawUnreliable(SessionOpts::TRAFFIC_RAW_UNRELIABLE, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+    numFailed += Check("Raw reliable session", candidates, rawReliable, g_maxDepth, candidates.size());
+    numFailed += Check("Raw unreliable session", candidates, rawUnreliable, g_maxDepth, candidates.size());
+
+    printf("%s\n", (numFailed == 0) ? "PASSED" : "FAILED");
+    return (numFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file
+ * Synthetic benchmark for the Bluetooth node database lookups.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+
+#include <alljoyn/version.h>
+
+#include "BDAddress.h"
+#include "BTBusAddress.h"
+#include "BTNodeDB.h"
+#include "BTNodeInfo.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const uint16_t PSM = 0x1001;
+
+static void usage(void)
+{
+    printf("Usage: btnodedbbench [-h] [-n <nodes>] [-l <lookups>]\n\n");
+    printf("Options:\n");
+    printf("   -h            - Print this help message\n");
+    printf("   -n <nodes>    - Number of nodes to put in the DB (default 20000)\n");
+    printf("   -l <lookups>  - Number of lookups of each kind to time (default 100000)\n");
+    printf("\n");
+}
+
+static String NodeName(uint32_t i)
+{
+    return ":node" + U32ToString(i) + ".1";
+}
+
+static BTBusAddress NodeAddr(uint32_t i)
+{
+    return BTBusAddress(BDAddress((uint64_t)0x001122000000ULL + i), PSM);
+}
+
+static void Report(const char* what, uint32_t count, uint64_t startMs)
+{
+    uint64_t elapsed = GetTimestamp64() - startMs;
+    printf("%-28s %8u ops %8llu ms  %10.3f us/op\n", what, count, (unsigned long long)elapsed,
+           count ? (1000.0 * elapsed) / count : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numNodes = 20000;
+    uint32_t numLookups = 100000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if (::strcmp("-h", argv[i]) == 0) {
+            usage();
+            exit(0);
+        } else if ((::strcmp("-n", argv[i]) == 0) && (i + 1 < argc)) {
+            numNodes = StringToU32(argv[++i], 10, numNodes);
+        } else if ((::strcmp("-l", argv[i]) == 0) && (i + 1 < argc)) {
+            numLookups = StringToU32(argv[++i], 10, numLookups);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+    if (numNodes == 0) {
+        usage();
+        exit(1);
+    }
+
+    BTNodeDB db(true);
+    Timespec now;
+    GetTimeNow(&now);
+    uint64_t base = now.GetAbsoluteMillis();
+
+    /* Nodes expire in a scrambled order over the next 100 seconds */
+    vector<BTNodeInfo> nodes;
+    nodes.reserve(numNodes);
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        BTNodeInfo node(NodeAddr(i), NodeName(i));
+        node->SetConnectNode(node);
+        node->SetExpireTime(base + 100000 + ((i * 7919) % numNodes));
+        nodes.push_back(node);
+    }
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        db.AddNode(nodes[i]);
+    }
+    Report("AddNode", numNodes, start);
+
+    uint32_t found = 0;
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < numLookups; ++i) {
+        found += db.FindNode(NodeAddr(i % numNodes))->IsValid() ? 1 : 0;
+    }
+    Report("FindNode(BTBusAddress)", numLookups, start);
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < numLookups; ++i) {
+        found += db.FindNode(NodeAddr(i % numNodes).addr)->IsValid() ? 1 : 0;
+    }
+    Report("FindNode(BDAddress)", numLookups, start);
+
+    vector<String> names;
+    names.reserve(numNodes);
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        names.push_back(NodeName(i));
+    }
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < numLookups; ++i) {
+        found += db.FindNode(names[i % numNodes])->IsValid() ? 1 : 0;
+    }
+    Report("FindNode(uniqueName)", numLookups, start);
+
+    if (found != (3 * numLookups)) {
+        printf("FAILED: expected %u lookups to succeed, %u did\n", 3 * numLookups, found);
+        return 1;
+    }
+
+    /* A node renamed after it was added is found under its new name only */
+    String renamed = NodeName(0) + ".renamed";
+    db.SetUniqueName(nodes[0], renamed);
+    if ((db.FindNode(renamed) != nodes[0]) || db.FindNode(names[0])->IsValid()) {
+        printf("FAILED: renamed node not found under its new name\n");
+        return 1;
+    }
+
+    start = GetTimestamp64();
+    uint64_t next = 0;
+    for (uint32_t i = 0; i < numLookups; ++i) {
+        next = db.NextNodeExpiration();
+    }
+    Report("NextNodeExpiration", numLookups, start);
+    if (next != (base + 100000)) {
+        printf("FAILED: unexpected next expiration\n");
+        return 1;
+    }
+
+    /* Expire half of the nodes */
+    for (uint32_t i = 0; i < numNodes; i += 2) {
+        nodes[i]->SetExpireTime(base);
+        db.AddNode(nodes[i]);
+    }
+    BTNodeDB expiredDB;
+    start = GetTimestamp64();
+    db.PopExpiredNodes(expiredDB);
+    Report("PopExpiredNodes", (uint32_t)expiredDB.Size(), start);
+    if ((expiredDB.Size() != ((numNodes + 1) / 2)) || (db.Size() != (numNodes / 2))) {
+        printf("FAILED: expected %u expired nodes got %u\n", (numNodes + 1) / 2, (uint32_t)expiredDB.Size());
+        return 1;
+    }
+
+    start = GetTimestamp64();
+    db.RefreshExpiration(60000);
+    Report("RefreshExpiration", (uint32_t)db.Size(), start);
+
+    start = GetTimestamp64();
+    for (uint32_t i = 1; i < numNodes; i += 2) {
+        db.RemoveNode(nodes[i]);
+    }
+    Report("RemoveNode", numNodes / 2, start);
+
+    if (db.Size() != 0) {
+        printf("FAILED: DB not empty after removing all nodes\n");
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file
+ * Discovery Manager outbound coalescing tester, queues a burst of updates and checks what is left
+ * to send and when it may be sent
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <list>
+#include <vector>
+
+#include <qcc/IPAddress.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+
+#include <Status.h>
+
+#include "DiscoveryManager.h"
+#include "HttpConnection.h"
+
+#define QCC_MODULE "DISCOVERYCOALESCETEST"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static uint32_t g_numUpdates = 400;
+static uint32_t g_numSessions = 3;
+static uint32_t g_sendInterval = 100;
+
+/** Compose the n'th update, cycling through the message types that are coalesced */
+static DiscoveryManager::RendezvousMessage ComposeUpdate(uint32_t n)
+{
+    DiscoveryManager::RendezvousMessage message;
+    message.httpMethod = HttpConnection::METHOD_POST;
+    uint32_t round = n / 4;
+
+    switch (n % 4) {
+    case 0:
+    {
+        /* Every advertisement carries all the names advertised so far */
+        AdvertiseMessage* advertise = new AdvertiseMessage();
+        for (uint32_t i = 0; i <= round; ++i) {
+            Advertisement adv;
+            adv.service = "org.alljoyn.coalesce.adv" + U32ToString(i);
+            advertise->ads.push_back(adv);
+        }
+        message.messageType = DiscoveryManager::ADVERTISEMENT;
+        message.interfaceMessage = advertise;
+        break;
+    }
+
+    case 1:
+    {
+        SearchMessage* searchMsg = new SearchMessage();
+        for (uint32_t i = 0; i <= round; ++i) {
+            Search search;
+            search.service = "org.alljoyn.coalesce.find" + U32ToString(i);
+            searchMsg->search.push_back(search);
+        }
+        message.messageType = DiscoveryManager::SEARCH;
+        message.interfaceMessage = searchMsg;
+        break;
+    }
+
+    case 2:
+    {
+        ProximityMessage* proximity = new ProximityMessage();
+        WiFiProximity wifi;
+        wifi.attached = true;
+        wifi.BSSID = "00:11:22:33:44:" + U32ToString(round % 100, 10, 2, '0');
+        wifi.SSID = "coalesce";
+        proximity->wifiaps.push_back(wifi);
+        message.messageType = DiscoveryManager::PROXIMITY;
+        message.interfaceMessage = proximity;
+        break;
+    }
+
+    default:
+    {
+        /* Each session keeps its credentials, only the candidates change */
+        uint32_t session = round % g_numSessions;
+        ICECandidatesMessage* candidates = new ICECandidatesMessage();
+        candidates->source = "org.alljoyn.coalesce.client";
+        candidates->destination = "org.alljoyn.coalesce.service";
+        candidates->destinationPeerID = "peer";
+        candidates->ice_ufrag = "ufrag" + U32ToString(session);
+        candidates->ice_pwd = "password" + U32ToString(session);
+        ICECandidates candidate;
+        candidate.type = HOST_CANDIDATE;
+        candidate.foundation = "1";
+        candidate.componentID = 1;
+        candidate.priority = 2130706431;
+        candidate.address = IPAddress("127.0.0.1");
+        candidate.port = (uint16_t)(10000 + round);
+        candidates->candidates.push_back(candidate);
+        message.messageType = DiscoveryManager::ADDRESS_CANDIDATES;
+        message.interfaceMessage = candidates;
+        break;
+    }
+    }
+    return message;
+}
+
+static void Usage(void)
+{
+    printf("Usage: discoverycoalesce [-h] [-n <updates>] [-s <sessions>] [-i <interval>]\n\n");
+    printf("Options:\n");
+    printf("   -h              - Print this help message\n");
+    printf("   -n <updates>    - Number of updates queued (default %u)\n", g_numUpdates);
+    printf("   -s <sessions>   - Number of ICE sessions sending candidates (default %u)\n", g_numSessions);
+    printf("   -i <interval>   - Minimum milliseconds between requests (default %u)\n", g_sendInterval);
+    printf("\n");
+}
+
+/** Check the delay before the next send at each point of the minimum send interval */
+static uint32_t CheckSendDelay(uint32_t sentTimeStamp)
+{
+    uint32_t numFailed = 0;
+    for (uint32_t elapsed = 0; elapsed <= g_sendInterval + 1; ++elapsed) {
+        uint32_t expected = (elapsed < g_sendInterval) ? (g_sendInterval - elapsed) : 0;
+        uint32_t delay = DiscoveryManager::GetSendDelay(sentTimeStamp, sentTimeStamp + elapsed, g_sendInterval);
+        if (delay != expected) {
+            printf("Sent at %u, %u ms later the delay is %u ms, expected %u ms\n", sentTimeStamp, elapsed, delay, expected);
+            ++numFailed;
+        }
+    }
+    return numFailed;
+}
+
+/**
+ * Check a queued message carries the last update composed for it, given the round of the last
+ * update of each list type and of each ICE session
+ */
+static bool IsLatest(const DiscoveryManager::RendezvousMessage& message, const uint32_t* lastRound, const vector<uint32_t>& lastSessionRound)
+{
+    switch (message.messageType) {
+    case DiscoveryManager::ADVERTISEMENT:
+        return static_cast<AdvertiseMessage*>(message.interfaceMessage)->ads.size() == (lastRound[0] + 1);
+
+    case DiscoveryManager::SEARCH:
+        return static_cast<SearchMessage*>(message.interfaceMessage)->search.size() == (lastRound[1] + 1);
+
+    case DiscoveryManager::PROXIMITY:
+        return static_cast<ProximityMessage*>(message.interfaceMessage)->wifiaps.front().BSSID ==
+               ("00:11:22:33:44:" + U32ToString(lastRound[2] % 100, 10, 2, '0'));
+
+    case DiscoveryManager::ADDRESS_CANDIDATES:
+    {
+        ICECandidatesMessage* candidates = static_cast<ICECandidatesMessage*>(message.interfaceMessage);
+        uint32_t session = StringToU32(candidates->ice_ufrag.substr(5), 10, 0);
+        return (session < lastSessionRound.size()) &&
+               (candidates->candidates.front().port == (uint16_t)(10000 + lastSessionRound[session]));
+    }
+
+    default:
+        return false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-n", argv[i])) && (++i < argc)) {
+            g_numUpdates = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-s", argv[i])) && (++i < argc)) {
+            g_numSessions = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-i", argv[i])) && (++i < argc)) {
+            g_sendInterval = strtoul(argv[i], NULL, 10);
+        } else {
+            Usage();
+            exit((0 == strcmp("-h", argv[i])) ? 0 : 1);
+        }
+    }
+    if (g_numSessions == 0) {
+        g_numSessions = 1;
+    }
+    if (g_numUpdates < 4 * g_numSessions) {
+        g_numUpdates = 4 * g_numSessions;
+    }
+
+    uint32_t numFailed = 0;
+
+    /* Nothing has been sent yet so there is nothing to wait for */
+    if (DiscoveryManager::GetSendDelay(0, 12345, g_sendInterval) != 0) {
+        printf("Delay before the first send\n");
+        ++numFailed;
+    }
+    numFailed += CheckSendDelay(1000);
+    /* The millisecond timestamp wraps */
+    numFailed += CheckSendDelay(0xFFFFFFFF - g_sendInterval / 2);
+
+    /* A burst of updates queued while the minimum send interval runs */
+    list<DiscoveryManager::RendezvousMessage> queue;
+    uint32_t numCoalesced = 0;
+    uint32_t lastRound[3] = { 0, 0, 0 };
+    vector<uint32_t> lastSessionRound(g_numSessions, 0);
+    for (uint32_t n = 0; n < g_numUpdates; ++n) {
+        if ((n % 4) < 3) {
+            lastRound[n % 4] = n / 4;
+        } else {
+            lastSessionRound[(n / 4) % g_numSessions] = n / 4;
+        }
+        DiscoveryManager::RendezvousMessage message = ComposeUpdate(n);
+        if (DiscoveryManager::CoalesceMessage(queue, message)) {
+            ++numCoalesced;
+        }
+    }
+
+    /* One message of each list type and one per ICE session is left, in the order first queued */
+    if (queue.size() != (3 + g_numSessions)) {
+        printf("%u messages queued, expected %u\n", (uint32_t)queue.size(), 3 + g_numSessions);
+        ++numFailed;
+    }
+    if (queue.size() + numCoalesced != g_numUpdates) {
+        printf("%u queued and %u coalesced from %u updates\n", (uint32_t)queue.size(), numCoalesced, g_numUpdates);
+        ++numFailed;
+    }
+    static const DiscoveryManager::MessageType listTypes[] = {
+        DiscoveryManager::ADVERTISEMENT, DiscoveryManager::SEARCH, DiscoveryManager::PROXIMITY
+    };
+    uint32_t position = 0;
+    for (list<DiscoveryManager::RendezvousMessage>::iterator it = queue.begin(); it != queue.end(); ++it, ++position) {
+        DiscoveryManager::MessageType expectedType = (position < 3) ? listTypes[position] : DiscoveryManager::ADDRESS_CANDIDATES;
+        if (it->messageType != expectedType) {
+            printf("Message %u has type %d\n", position, it->messageType);
+            ++numFailed;
+        } else if (!IsLatest(*it, lastRound, lastSessionRound)) {
+            printf("Message %u is stale\n", position);
+            ++numFailed;
+        }
+        DiscoveryManager::DeleteInterfaceMessage(*it);
+    }
+
+    printf("%u updates queued, %u coalesced, %u left to send\n", g_numUpdates, numCoalesced, (uint32_t)queue.size());
+    printf("%s\n", (numFailed == 0) ? "PASSED" : "FAILED");
+    return (numFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+/**
+ * @file
+ * ICEScheduler tester, paces STUN binding requests from many sessions to a loopback STUN responder
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <qcc/Event.h>
+#include <qcc/IPAddress.h>
+#include <qcc/Mutex.h>
+#include <qcc/ScatterGatherList.h>
+#include <qcc/Socket.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+
+#include <Status.h>
+
+#include "ICEScheduler.h"
+#include "StunAttribute.h"
+#include "StunMessage.h"
+
+#define QCC_MODULE "ICESCHEDULERTEST"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static uint32_t g_numSessions = 50;
+static uint32_t g_numRequests = 4;
+static uint32_t g_interval = 100;
+static uint32_t g_pacing = ICEScheduler::PACING_INTERVAL_MS;
+
+static const size_t MAX_STUN_MSG = 576;
+
+/** Open a UDP socket bound to an ephemeral loopback port */
+static QStatus OpenLoopbackSocket(SocketFd& sock, uint16_t& port)
+{
+    QStatus status = Socket(QCC_AF_INET, QCC_SOCK_DGRAM, sock);
+    if (status == ER_OK) {
+        status = Bind(sock, IPAddress("127.0.0.1"), 0);
+    }
+    if (status == ER_OK) {
+        IPAddress addr;
+        status = GetLocalAddress(sock, addr, port);
+    }
+    if (status == ER_OK) {
+        status = SetBlocking(sock, false);
+    }
+    return status;
+}
+
+/** Render a STUN message and send it */
+static QStatus SendStun(SocketFd sock, const StunMessage& msg, IPAddress addr, uint16_t port)
+{
+    uint8_t buf[MAX_STUN_MSG];
+    uint8_t* pos = buf;
+    size_t size = msg.RenderSize();
+    ScatterGatherList sg;
+    if (size > sizeof(buf)) {
+        return ER_BUFFER_TOO_SMALL;
+    }
+    QStatus status = msg.RenderBinary(pos, size, sg);
+    if (status == ER_OK) {
+        size_t sent;
+        status = SendTo(sock, addr, port, buf, sg.DataSize(), sent);
+    }
+    return status;
+}
+
+/**
+ * Answers every STUN binding request with a success response carrying the sender's address.
+ */
+class StunResponder : public Thread {
+  public:
+    StunResponder() : Thread("StunResponder"), sock(INVALID_SOCKET_FD), port(0), numRequests(0) { }
+
+    ~StunResponder()
+    {
+        Stop();
+        Join();
+        if (sock != INVALID_SOCKET_FD) {
+            Close(sock);
+        }
+    }
+
+    QStatus Open() { return OpenLoopbackSocket(sock, port); }
+
+    uint16_t GetPort() const { return port; }
+
+    uint32_t GetNumRequests() const { return numRequests; }
+
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        Event sockEvent(sock, Event::IO_READ, false);
+        vector<Event*> checkEvents;
+        checkEvents.push_back(&stopEvent);
+        checkEvents.push_back(&sockEvent);
+
+        while (!IsStopping()) {
+            vector<Event*> signaledEvents;
+            if (Event::Wait(checkEvents, signaledEvents) != ER_OK || stopEvent.IsSet()) {
+                break;
+            }
+            uint8_t buf[MAX_STUN_MSG];
+            IPAddress addr;
+            uint16_t remotePort;
+            size_t received;
+            while (RecvFrom(sock, addr, remotePort, buf, sizeof(buf), received) == ER_OK) {
+                const uint8_t* pos = buf;
+                StunMessage request("", NULL, 0);
+                if ((request.Parse(pos, received) != ER_OK) ||
+                    (request.GetTypeClass() != STUN_MSG_REQUEST_CLASS) ||
+                    (request.GetTypeMethod() != STUN_MSG_BINDING_METHOD)) {
+                    printf("StunResponder: ignoring %u byte message\n", (unsigned int)received);
+                    continue;
+                }
+                StunTransactionID tid;
+                request.GetTransactionID(tid);
+                StunMessage response(STUN_MSG_RESPONSE_CLASS, STUN_MSG_BINDING_METHOD, NULL, 0, tid);
+                response.AddAttribute(new StunAttributeXorMappedAddress(response, addr, remotePort));
+                if (SendStun(sock, response, addr, remotePort) == ER_OK) {
+                    ++numRequests;
+                }
+            }
+        }
+        return 0;
+    }
+
+  private:
+    SocketFd sock;
+    uint16_t port;
+    volatile uint32_t numRequests;
+};
+
+/**
+ * Stands in for an ICE session, sends one binding request per turn until it has sent them all.
+ */
+class TestSession : public ICESchedulerListener {
+  public:
+    TestSession(uint16_t responderPort, Mutex& sentLock, vector<uint64_t>& sentTimes) :
+        sock(INVALID_SOCKET_FD), port(0), responderPort(responderPort), numSent(0), numReceived(0),
+        numMismatched(0), sentLock(sentLock), sentTimes(sentTimes) { }
+
+    ~TestSession()
+    {
+        if (sock != INVALID_SOCKET_FD) {
+            Close(sock);
+        }
+    }
+
+    QStatus Open() { return OpenLoopbackSocket(sock, port); }
+
+    PacingResult PacingSlot(void)
+    {
+        Receive();
+        if (numSent == g_numRequests) {
+            return PACING_FINISHED;
+        }
+        StunMessage request(STUN_MSG_REQUEST_CLASS, STUN_MSG_BINDING_METHOD, NULL, 0);
+        QStatus status = SendStun(sock, request, IPAddress("127.0.0.1"), responderPort);
+        if (status != ER_OK) {
+            printf("TestSession: SendStun failed with %s\n", QCC_StatusText(status));
+            return PACING_IDLE;
+        }
+        ++numSent;
+        sentLock.Lock(MUTEX_CONTEXT);
+        sentTimes.push_back(GetTimestamp64());
+        sentLock.Unlock(MUTEX_CONTEXT);
+        return PACING_SENT;
+    }
+
+    /** Read any binding responses that have arrived and check the mapped address */
+    void Receive()
+    {
+        uint8_t buf[MAX_STUN_MSG];
+        IPAddress addr;
+        uint16_t remotePort;
+        size_t received;
+        while (RecvFrom(sock, addr, remotePort, buf, sizeof(buf), received) == ER_OK) {
+            const uint8_t* pos = buf;
+            StunMessage response("", NULL, 0);
+            if ((response.Parse(pos, received) != ER_OK) || (response.GetTypeClass() != STUN_MSG_RESPONSE_CLASS)) {
+                ++numMismatched;
+                continue;
+            }
+            bool matched = false;
+            for (StunMessage::const_iterator it = response.Begin(); it != response.End(); ++it) {
+                if ((*it)->GetType() == STUN_ATTR_XOR_MAPPED_ADDRESS) {
+                    IPAddress mappedAddr;
+                    uint16_t mappedPort;
+                    static_cast<StunAttributeXorMappedAddress*>(*it)->GetAddress(mappedAddr, mappedPort);
+                    matched = (mappedPort == port);
+                }
+            }
+            if (matched) {
+                ++numReceived;
+            } else {
+                ++numMismatched;
+            }
+        }
+    }
+
+    SocketFd GetSocket() const { return sock; }
+    uint32_t GetNumSent() const { return numSent; }
+    uint32_t GetNumReceived() const { return numReceived; }
+    uint32_t GetNumMismatched() const { return numMismatched; }
+
+  private:
+    SocketFd sock;
+    uint16_t port;
+    uint16_t responderPort;
+    uint32_t numSent;
+    uint32_t numReceived;
+    uint32_t numMismatched;
+    Mutex& sentLock;
+    vector<uint64_t>& sentTimes;
+};
+
+static void Usage(void)
+{
+    printf("Usage: icescheduler [-h] [-n <sessions>] [-r <requests>] [-i <interval>] [-t <pacing>]\n\n");
+    printf("Options:\n");
+    printf("   -h              - Print this help message\n");
+    printf("   -n <sessions>   - Number of concurrent sessions (default %u)\n", g_numSessions);
+    printf("   -r <requests>   - Binding requests sent by each session (default %u)\n", g_numRequests);
+    printf("   -i <interval>   - Milliseconds between a session's requests (default %u)\n", g_interval);
+    printf("   -t <pacing>     - Global pacing interval Ta in milliseconds (default %u)\n", g_pacing);
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-n", argv[i])) && (++i < argc)) {
+            g_numSessions = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-r", argv[i])) && (++i < argc)) {
+            g_numRequests = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-i", argv[i])) && (++i < argc)) {
+            g_interval = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-t", argv[i])) && (++i < argc)) {
+            g_pacing = strtoul(argv[i], NULL, 10);
+        } else {
+            Usage();
+            exit((0 == strcmp("-h", argv[i])) ? 0 : 1);
+        }
+    }
+
+    StunResponder responder;
+    QStatus status = responder.Open();
+    if (status == ER_OK) {
+        status = responder.Start();
+    }
+    if (status != ER_OK) {
+        printf("Failed to start STUN responder: %s\n", QCC_StatusText(status));
+        return 1;
+    }
+
+    Mutex sentLock;
+    vector<uint64_t> sentTimes;
+    vector<TestSession*> sessions;
+    ICEScheduler scheduler(g_pacing);
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; (status == ER_OK) && (i < g_numSessions); ++i) {
+        TestSession* session = new TestSession(responder.GetPort(), sentLock, sentTimes);
+        sessions.push_back(session);
+        status = session->Open();
+        if (status == ER_OK) {
+            status = scheduler.AddListener(session, g_interval);
+        }
+    }
+    if (status != ER_OK) {
+        printf("Failed to start sessions: %s\n", QCC_StatusText(status));
+    }
+
+    /* Every session removes itself from the scheduler once it has sent all its requests */
+    while ((status == ER_OK) && (scheduler.GetNumListeners() > 0)) {
+        qcc::Sleep(10);
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    /* Collect the responses still in flight */
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t mismatched = 0;
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        Event sockEvent(sessions[i]->GetSocket(), Event::IO_READ, false);
+        while (sessions[i]->GetNumReceived() + sessions[i]->GetNumMismatched() < sessions[i]->GetNumSent()) {
+            if (Event::Wait(sockEvent, 1000) != ER_OK) {
+                break;
+            }
+            sessions[i]->Receive();
+        }
+        sent += sessions[i]->GetNumSent();
+        received += sessions[i]->GetNumReceived();
+        mismatched += sessions[i]->GetNumMismatched();
+        delete sessions[i];
+    }
+
+    /* No two transactions may be closer together than Ta, allowing for timer granularity */
+    sort(sentTimes.begin(), sentTimes.end());
+    uint64_t minGap = 0;
+    for (size_t i = 1; i < sentTimes.size(); ++i) {
+        uint64_t gap = sentTimes[i] - sentTimes[i - 1];
+        if ((i == 1) || (gap < minGap)) {
+            minGap = gap;
+        }
+    }
+
+    printf("%u sessions sent %u requests in %u ms, %u responses (%u mismatched), responder saw %u\n",
+           g_numSessions, sent, (uint32_t)elapsed, received, mismatched, responder.GetNumRequests());
+    printf("Minimum gap between requests %u ms, pacing interval %u ms\n", (uint32_t)minGap, g_pacing);
+
+    bool ok = (status == ER_OK) &&
+              (sent == g_numSessions * g_numRequests) &&
+              (received == sent) &&
+              (mismatched == 0) &&
+              ((sentTimes.size() < 2) || ((minGap + 1) >= g_pacing));
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+/**
+ * @file
+ * Daemon policy tester, routes messages and checks name ownership through a DaemonRouter and checks
+ * that the configured send, receive and own policy is applied
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <qcc/String.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+
+#include <Status.h>
+
+#include "BusEndpoint.h"
+#include "DaemonConfig.h"
+#include "DaemonRouter.h"
+
+#define QCC_MODULE "POLICYTEST"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static uint32_t g_iterations = 100;
+
+/*
+ * Everybody may send to and own anything except the Locked and Reserved names, which only root
+ * may use.
+ */
+static const char policyConfig[] =
+    "<busconfig>"
+    "  <policy context=\"default\">"
+    "    <allow send_destination=\"*\"/>"
+    "    <allow receive_sender=\"*\"/>"
+    "    <deny send_destination=\"org.alljoyn.test.Locked\"/>"
+    "    <allow own=\"*\"/>"
+    "    <deny own=\"org.alljoyn.test.Reserved\"/>"
+    "  </policy>"
+    "  <policy user=\"root\">"
+    "    <allow send_destination=\"org.alljoyn.test.Locked\"/>"
+    "    <allow own=\"org.alljoyn.test.Reserved\"/>"
+    "  </policy>"
+    "</busconfig>";
+
+/* The same policy after the Locked name has been opened up */
+static const char reloadConfig[] =
+    "<busconfig>"
+    "  <policy context=\"default\">"
+    "    <allow send_destination=\"*\"/>"
+    "    <allow receive_sender=\"*\"/>"
+    "    <allow own=\"*\"/>"
+    "    <deny own=\"org.alljoyn.test.Reserved\"/>"
+    "  </policy>"
+    "</busconfig>";
+
+static const char noPolicyConfig[] = "<busconfig></busconfig>";
+
+/*
+ * Endpoint with a fixed identity that counts the messages routed to it. Local applications are
+ * ENDPOINT_TYPE_NULL endpoints so the router treats them as plain endpoints, off-device peers are
+ * ENDPOINT_TYPE_VIRTUAL endpoints that claim to be root.
+ */
+class TestEndpoint : public BusEndpoint {
+  public:
+    TestEndpoint(const char* uniqueName, EndpointType type, uint32_t uid, uint32_t gid) :
+        BusEndpoint(type), uniqueName(uniqueName), uid(uid), gid(gid), received(0) { }
+
+    QStatus PushMessage(Message& msg) { ++received; return ER_OK; }
+    const qcc::String& GetUniqueName() const { return uniqueName; }
+    uint32_t GetUserId() const { return uid; }
+    uint32_t GetGroupId() const { return gid; }
+    uint32_t GetProcessId() const { return -1; }
+    bool SupportsUnixIDs() const { return true; }
+    bool AllowRemoteMessages() { return true; }
+
+    qcc::String uniqueName;
+    uint32_t uid;
+    uint32_t gid;
+    size_t received;
+};
+
+/* A signal to a single destination, no reply is expected so a denied message is just dropped */
+class TestSignal : public _Message {
+  public:
+    TestSignal(BusAttachment& bus, const qcc::String& destination) : _Message(bus)
+    {
+        status = SignalMsg("", destination.c_str(), 0, "/org/alljoyn/test", "org.alljoyn.test.Policy", "Ping", NULL, 0, 0, 0);
+    }
+
+    QStatus status;
+};
+
+static bool LoadPolicy(DaemonRouter& router, const char* configXml)
+{
+    DaemonConfig* config = DaemonConfig::Load(configXml);
+    if (!config) {
+        printf("Failed to parse configuration\n");
+        return false;
+    }
+    return router.LoadPolicy(*config);
+}
+
+/*
+ * Route the same signal g_iterations times and check that every one was either delivered or
+ * dropped. All but the first use the cached decision.
+ */
+static bool CheckRoute(DaemonRouter& router, BusAttachment& bus, TestEndpoint& sender, TestEndpoint& dest, bool allowed, const char* what)
+{
+    TestSignal signal(bus, dest.GetUniqueName());
+    if (signal.status != ER_OK) {
+        printf("%s: failed to build signal %s\n", what, QCC_StatusText(signal.status));
+        return false;
+    }
+    size_t before = dest.received;
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        Message msg(static_cast<_Message&>(signal));
+        QStatus status = router.PushMessage(msg, sender);
+        QStatus expected = allowed ? ER_OK : ER_BUS_POLICY_VIOLATION;
+        if (status != expected) {
+            printf("%s: message %u from %s to %s returned %s expected %s\n", what, i,
+                   sender.GetUniqueName().c_str(), dest.GetUniqueName().c_str(), QCC_StatusText(status), QCC_StatusText(expected));
+            return false;
+        }
+    }
+    size_t delivered = dest.received - before;
+    if (delivered != (allowed ? g_iterations : 0)) {
+        printf("%s: %lu of %u messages from %s to %s delivered\n", what, (unsigned long)delivered, g_iterations,
+               sender.GetUniqueName().c_str(), dest.GetUniqueName().c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool CheckOwn(DaemonRouter& router, const char* alias, TestEndpoint& owner, bool allowed, const char* what)
+{
+    if (router.OKToOwn(alias, owner.GetUniqueName()) != allowed) {
+        printf("%s: %s %s be allowed to own %s\n", what, owner.GetUniqueName().c_str(), allowed ? "should" : "should not", alias);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Allow and deny decisions are the same every time they come from the cache, and are cached per
+ * sender identity.
+ */
+static bool TestCachedDecisions(DaemonRouter& router, BusAttachment& bus, TestEndpoint& user, TestEndpoint& root, TestEndpoint& open, TestEndpoint& locked)
+{
+    bool ok = CheckRoute(router, bus, user, open, true, "cached allow");
+    ok = CheckRoute(router, bus, user, locked, false, "cached deny") && ok;
+    ok = CheckRoute(router, bus, root, locked, true, "cached allow for root") && ok;
+    /* The deny for the user must not have been replaced by the allow for root */
+    ok = CheckRoute(router, bus, user, locked, false, "cached deny after allow for root") && ok;
+    return ok;
+}
+
+/*
+ * A destination that gains or loses a well-known name the rules refer to must not keep the decision
+ * cached for its old set of names.
+ */
+static bool TestNameOwnerChanged(DaemonRouter& router, BusAttachment& bus, TestEndpoint& user, TestEndpoint& open)
+{
+    bool ok = CheckRoute(router, bus, user, open, true, "before name change");
+    uint32_t disposition;
+    QStatus status = router.AddAlias("org.alljoyn.test.Locked.Too", open.GetUniqueName(), 0, disposition);
+    ok = (status == ER_OK) && ok;
+    /* A name no rule refers to makes no difference */
+    ok = CheckRoute(router, bus, user, open, true, "after unrelated name change") && ok;
+    router.RemoveAlias("org.alljoyn.test.Locked.Too", open.GetUniqueName(), disposition);
+
+    status = router.AddAlias("org.alljoyn.test.Locked", open.GetUniqueName(), 0, disposition);
+    if (status != ER_OK) {
+        printf("AddAlias failed %s\n", QCC_StatusText(status));
+        return false;
+    }
+    ok = CheckRoute(router, bus, user, open, false, "after name acquired") && ok;
+    router.RemoveAlias("org.alljoyn.test.Locked", open.GetUniqueName(), disposition);
+    ok = CheckRoute(router, bus, user, open, true, "after name released") && ok;
+    return ok;
+}
+
+/*
+ * Reloading the policy discards the decisions cached for the old policy, a configuration without a
+ * policy turns enforcement off.
+ */
+static bool TestReload(DaemonRouter& router, BusAttachment& bus, TestEndpoint& user, TestEndpoint& locked)
+{
+    bool ok = CheckRoute(router, bus, user, locked, false, "before reload");
+    ok = CheckOwn(router, "org.alljoyn.test.Reserved", user, false, "before reload") && ok;
+    if (!LoadPolicy(router, reloadConfig)) {
+        printf("Failed to reload policy\n");
+        return false;
+    }
+    ok = CheckRoute(router, bus, user, locked, true, "after reload") && ok;
+    ok = CheckOwn(router, "org.alljoyn.test.Reserved", user, false, "after reload") && ok;
+    if (!LoadPolicy(router, noPolicyConfig)) {
+        printf("Failed to load empty policy\n");
+        return false;
+    }
+    ok = CheckOwn(router, "org.alljoyn.test.Reserved", user, true, "without policy") && ok;
+    /* An invalid policy leaves the previous one in place */
+    if (!LoadPolicy(router, policyConfig)) {
+        printf("Failed to load policy\n");
+        return false;
+    }
+    if (LoadPolicy(router, "<busconfig><policy context=\"nonsense\"/></busconfig>")) {
+        printf("Invalid policy was loaded\n");
+        ok = false;
+    }
+    ok = CheckRoute(router, bus, user, locked, false, "after invalid reload") && ok;
+    return ok;
+}
+
+/*
+ * The own rules DBusObj::RequestName checks through DaemonRouter::OKToOwn.
+ */
+static bool TestOwn(DaemonRouter& router, TestEndpoint& user, TestEndpoint& root)
+{
+    bool ok = CheckOwn(router, "org.alljoyn.test.Other", user, true, "own");
+    ok = CheckOwn(router, "org.alljoyn.test.Reserved", user, false, "own") && ok;
+    ok = CheckOwn(router, "org.alljoyn.test.Reserved", root, true, "own") && ok;
+    return ok;
+}
+
+/*
+ * Off-device peers are not local users, a virtual endpoint that reports uid 0 must not get the
+ * rules for root.
+ */
+static bool TestRemoteIdentity(DaemonRouter& router, BusAttachment& bus, TestEndpoint& remote, TestEndpoint& open, TestEndpoint& locked)
+{
+    bool ok = CheckRoute(router, bus, remote, open, true, "remote sender");
+    ok = CheckRoute(router, bus, remote, locked, false, "remote sender to root only name") && ok;
+    ok = CheckOwn(router, "org.alljoyn.test.Reserved", remote, false, "remote owner") && ok;
+    return ok;
+}
+
+static void Usage()
+{
+    printf("Usage: policytest [-h] [-i <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h              - Display this help message\n");
+    printf("   -i <iterations> - Number of times each message is routed (default %u)\n", g_iterations);
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-i", argv[i])) && (++i < argc)) {
+            g_iterations = strtoul(argv[i], NULL, 10);
+        } else {
+            Usage();
+            exit((0 == strcmp("-h", argv[i])) ? 0 : 1);
+        }
+    }
+
+    BusAttachment bus("policytest", false);
+    DaemonRouter router;
+
+    TestEndpoint user(":policy.1", BusEndpoint::ENDPOINT_TYPE_NULL, 1000, 1000);
+    TestEndpoint root(":policy.2", BusEndpoint::ENDPOINT_TYPE_NULL, 0, 0);
+    TestEndpoint open(":policy.3", BusEndpoint::ENDPOINT_TYPE_NULL, 1000, 1000);
+    TestEndpoint locked(":policy.4", BusEndpoint::ENDPOINT_TYPE_NULL, 1000, 1000);
+    TestEndpoint remote(":remote.1", BusEndpoint::ENDPOINT_TYPE_VIRTUAL, 0, 0);
+    router.RegisterEndpoint(user, false);
+    router.RegisterEndpoint(root, false);
+    router.RegisterEndpoint(open, false);
+    router.RegisterEndpoint(locked, false);
+    router.RegisterEndpoint(remote, false);
+
+    bool ok = LoadPolicy(router, policyConfig);
+    uint32_t disposition;
+    ok = (router.AddAlias("org.alljoyn.test.Locked", locked.GetUniqueName(), 0, disposition) == ER_OK) && ok;
+    if (!ok) {
+        printf("Setup failed\n");
+    } else {
+        ok = TestCachedDecisions(router, bus, user, root, open, locked);
+        ok = TestOwn(router, user, root) && ok;
+        ok = TestRemoteIdentity(router, bus, remote, open, locked) && ok;
+        ok = TestReload(router, bus, user, locked) && ok;
+        /* The open endpoint takes the Locked name so its current owner has to give it up first */
+        router.RemoveAlias("org.alljoyn.test.Locked", locked.GetUniqueName(), disposition);
+        ok = TestNameOwnerChanged(router, bus, user, open) && ok;
+    }
+
+    router.UnregisterEndpoint(remote);
+    router.UnregisterEndpoint(locked);
+    router.UnregisterEndpoint(open);
+    router.UnregisterEndpoint(root);
+    router.UnregisterEndpoint(user);
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file
+ * Raw session relay tester, relays data between two socket pairs and checks that it arrives
+ * intact and that closes are passed through
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <vector>
+
+#include <qcc/time.h>
+
+#include <Status.h>
+
+#include "RawRelay.h"
+
+#define QCC_MODULE "RAWRELAYTEST"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static size_t g_numBytes = 4 * 1024 * 1024;
+static uint32_t g_timeout = 10000;
+
+/**
+ * Write all of data to one socket while reading from another until end of file, so neither
+ * side can fill up and stall the other. Returns false on error or timeout.
+ */
+static bool Transfer(int out, const vector<uint8_t>& data, int in, vector<uint8_t>& received)
+{
+    size_t sent = 0;
+    bool eof = false;
+    fcntl(out, F_SETFL, fcntl(out, F_GETFL) | O_NONBLOCK);
+    fcntl(in, F_SETFL, fcntl(in, F_GETFL) | O_NONBLOCK);
+    uint64_t stop = GetTimestamp64() + g_timeout;
+
+    while (!eof) {
+        if (GetTimestamp64() > stop) {
+            printf("Timed out after sending %lu and receiving %lu bytes\n", (unsigned long)sent, (unsigned long)received.size());
+            return false;
+        }
+        struct pollfd fds[2];
+        fds[0].fd = in;
+        fds[0].events = POLLIN;
+        fds[1].fd = out;
+        fds[1].events = (sent < data.size()) ? POLLOUT : 0;
+        poll(fds, 2, 100);
+
+        if (sent < data.size()) {
+            ssize_t ret = send(out, &data[sent], data.size() - sent, MSG_NOSIGNAL);
+            if (ret > 0) {
+                sent += ret;
+                if (sent == data.size()) {
+                    /* The relay must pass the half close on to the far end */
+                    shutdown(out, SHUT_WR);
+                }
+            } else if ((ret < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+                printf("send failed: %s\n", strerror(errno));
+                return false;
+            }
+        }
+        uint8_t buf[64 * 1024];
+        ssize_t ret = recv(in, buf, sizeof(buf), 0);
+        if (ret > 0) {
+            received.insert(received.end(), buf, buf + ret);
+        } else if (ret == 0) {
+            eof = true;
+        } else if ((errno != EAGAIN) && (errno != EINTR)) {
+            printf("recv failed: %s\n", strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Wait for the relay to drop to the expected number of sessions */
+static bool WaitForRelays(RawRelay& relay, size_t expected)
+{
+    for (uint32_t i = 0; i < g_timeout / 10; ++i) {
+        if (relay.GetNumRelays() == expected) {
+            return true;
+        }
+        qcc::Sleep(10);
+    }
+    return false;
+}
+
+/** Both directions are relayed intact and the relay ends once both sides have closed */
+static bool TestBothDirections(RawRelay& relay)
+{
+    int a[2], b[2];
+    if ((socketpair(AF_UNIX, SOCK_STREAM, 0, a) != 0) || (socketpair(AF_UNIX, SOCK_STREAM, 0, b) != 0)) {
+        printf("socketpair failed: %s\n", strerror(errno));
+        return false;
+    }
+    /* a[0] and b[0] are the two applications, a[1] and b[1] the daemon's bus-to-bus sockets */
+    QStatus status = relay.AddRelay(1, a[1], b[1]);
+    if (status != ER_OK) {
+        printf("AddRelay failed: %s\n", QCC_StatusText(status));
+        return false;
+    }
+
+    vector<uint8_t> forward(g_numBytes);
+    vector<uint8_t> backward(g_numBytes / 2 + 17);
+    for (size_t i = 0; i < forward.size(); ++i) {
+        forward[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    for (size_t i = 0; i < backward.size(); ++i) {
+        backward[i] = (uint8_t)(i * 13 + (i >> 12));
+    }
+
+    vector<uint8_t> received;
+    bool ok = Transfer(a[0], forward, b[0], received) && (received == forward);
+    if (!ok) {
+        printf("Forward data was not relayed intact\n");
+    }
+    /* One half is closed, the other direction must still work */
+    if (ok && (relay.GetNumRelays() != 1)) {
+        printf("Relay ended after a half close\n");
+        ok = false;
+    }
+    received.clear();
+    if (ok && !(Transfer(b[0], backward, a[0], received) && (received == backward))) {
+        printf("Backward data was not relayed intact\n");
+        ok = false;
+    }
+    if (ok && !WaitForRelays(relay, 0)) {
+        printf("Relay did not end after both halves closed\n");
+        ok = false;
+    }
+    close(a[0]);
+    close(b[0]);
+    return ok;
+}
+
+/** The relay ends when one application goes away without a clean shutdown */
+static bool TestPeerGone(RawRelay& relay)
+{
+    int a[2], b[2];
+    if ((socketpair(AF_UNIX, SOCK_STREAM, 0, a) != 0) || (socketpair(AF_UNIX, SOCK_STREAM, 0, b) != 0)) {
+        printf("socketpair failed: %s\n", strerror(errno));
+        return false;
+    }
+    QStatus status = relay.AddRelay(2, a[1], b[1]);
+    if (status != ER_OK) {
+        printf("AddRelay failed: %s\n", QCC_StatusText(status));
+        return false;
+    }
+    close(b[0]);
+
+    /* Writes toward the vanished peer must fail inside the relay, not raise SIGPIPE */
+    static const char data[] = "into the void";
+    send(a[0], data, sizeof(data), MSG_NOSIGNAL);
+
+    bool ok = WaitForRelays(relay, 0);
+    if (!ok) {
+        printf("Relay did not end after the peer went away\n");
+    } else {
+        /* The surviving application sees the session close */
+        char buf[16];
+        ok = (recv(a[0], buf, sizeof(buf), 0) <= 0);
+        if (!ok) {
+            printf("Surviving application was not closed\n");
+        }
+    }
+    close(a[0]);
+    return ok;
+}
+
+static void Usage(void)
+{
+    printf("Usage: rawrelay [-h] [-n <bytes>] [-t <timeout>]\n\n");
+    printf("Options:\n");
+    printf("   -h              - Print this help message\n");
+    printf("   -n <bytes>      - Number of bytes relayed (default %lu)\n", (unsigned long)g_numBytes);
+    printf("   -t <timeout>    - Milliseconds allowed for each transfer (default %u)\n", g_timeout);
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-n", argv[i])) && (++i < argc)) {
+            g_numBytes = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-t", argv[i])) && (++i < argc)) {
+            g_timeout = strtoul(argv[i], NULL, 10);
+        } else {
+            Usage();
+            exit((0 == strcmp("-h", argv[i])) ? 0 : 1);
+        }
+    }
+
+    RawRelay relay;
+    uint64_t start = GetTimestamp64();
+    bool ok = TestBothDirections(relay);
+    uint64_t elapsed = GetTimestamp64() - start;
+    printf("Relayed %lu bytes in both directions in %u ms\n", (unsigned long)(g_numBytes + g_numBytes / 2 + 17), (uint32_t)elapsed);
+    ok = TestPeerGone(relay) && ok;
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,453 @@
+/**
+ * @file
+ * Rendezvous Server response decoding benchmark, compares the JsonPullParser based decoders with
+ * decoding through a jsoncpp document
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <list>
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+
+#include <JSON/json.h>
+
+#include <Status.h>
+
+#include "RendezvousServerInterface.h"
+
+#define QCC_MODULE "RDVZJSONBENCH"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static uint32_t g_iterations = 2000;
+static uint32_t g_matches = 40;
+static uint32_t g_candidates = 8;
+
+/*
+ * Messages in the form the Rendezvous Server sends them. The numbered fields are filled in when
+ * the payloads are built so that each message of a response is distinct.
+ */
+static const char* MATCH_FORMAT =
+    "{\"type\":\"match\",\"match\":{\"service\":\"org.alljoyn.bus.samples.chat.s%u\",\"matchID\":\"%08x\","
+    "\"peerAddr\":\"a6f4%04x-62d1-4e67-9b50-7c1f1c2a%04x\",\"STUNInfo\":{\"address\":\"198.51.100.%u\","
+    "\"port\":3478,\"acct\":\"7f0e7c2b%04x\",\"pwd\":\"T4pVs9/Jq+Kx2eA1\\/%u==\",\"expiryTime\":3600,"
+    "\"relay\":{\"address\":\"198.51.100.%u\",\"port\":3479}}}}";
+
+static const char* CANDIDATES_HEAD_FORMAT =
+    "{\"type\":\"addressCandidates\",\"addressCandidates\":{\"source\":\"org.alljoyn.bus.samples.chat.s%u\","
+    "\"destination\":\":x%04x.2\",\"peerAddr\":\"a6f4%04x-62d1-4e67-9b50-7c1f1c2a0001\",\"matchID\":\"%08x\","
+    "\"ice-ufrag\":\"Jc%04xqP\",\"ice-pwd\":\"y8Qe0b%04xWn6Rk2ZpLtUvA5\",\"candidates\":[";
+
+static const char* HOST_CANDIDATE_FORMAT =
+    "{\"type\":\"host\",\"foundation\":\"%u\",\"componentID\":1,\"transport\":\"UDP\","
+    "\"priority\":%u,\"address\":\"192.168.%u.%u\",\"port\":%u}";
+
+static const char* SRFLX_CANDIDATE_FORMAT =
+    "{\"type\":\"srflx\",\"foundation\":\"%u\",\"componentID\":1,\"transport\":\"UDP\","
+    "\"priority\":%u,\"address\":\"203.0.113.%u\",\"port\":%u,\"raddress\":\"192.168.%u.%u\",\"rport\":%u}";
+
+static const char* CANDIDATES_TAIL =
+    "],\"STUNInfo\":{\"address\":\"198.51.100.7\",\"port\":3478,\"acct\":\"7f0e7c2b0001\","
+    "\"pwd\":\"T4pVs9/Jq+Kx2eA1\",\"expiryTime\":3600,\"relay\":{\"address\":\"198.51.100.8\",\"port\":3479}}}}";
+
+static const char* REVOKED_FORMAT =
+    "{\"type\":\"matchRevoked\",\"matchRevoked\":{\"peerAddr\":\"a6f4%04x-62d1-4e67-9b50-7c1f1c2a0001\","
+    "\"services\":[\"org.alljoyn.bus.samples.chat.s%u\",\"org.alljoyn.bus.samples.chat.s%u\"]}}";
+
+static const char* REVOKE_ALL_FORMAT =
+    "{\"type\":\"matchRevoked\",\"matchRevoked\":{\"peerAddr\":\"a6f4%04x-62d1-4e67-9b50-7c1f1c2a0001\","
+    "\"deleteAll\":true}}";
+
+static const char* START_CHECKS_FORMAT =
+    "{\"type\":\"startICEChecks\",\"startICEChecks\":{\"peerAddr\":\"a6f4%04x-62d1-4e67-9b50-7c1f1c2a0001\"}}";
+
+/** Append printf style output to a String */
+static void Append(String& out, const char* format, ...)
+{
+    char buf[1024];
+    va_list ap;
+    va_start(ap, format);
+    vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    out.append(buf);
+}
+
+/** Build a persistent connection response carrying a burst of search matches */
+static String BuildMatches(uint32_t count)
+{
+    String json("{\"msgs\":[");
+    for (uint32_t i = 0; i < count; ++i) {
+        if (i) {
+            json.append(",");
+        }
+        Append(json, MATCH_FORMAT, i, 0x5e000000 + i, i, i, 1 + (i % 250), i, i, 1 + ((i + 1) % 250));
+    }
+    json.append("]}");
+    return json;
+}
+
+/** Build a persistent connection response carrying address candidates from several peers */
+static String BuildCandidates(uint32_t peers, uint32_t candidates)
+{
+    String json("{\"msgs\":[");
+    for (uint32_t p = 0; p < peers; ++p) {
+        if (p) {
+            json.append(",");
+        }
+        Append(json, CANDIDATES_HEAD_FORMAT, p, p, p, 0x5e000000 + p, p, p);
+        for (uint32_t c = 0; c < candidates; ++c) {
+            if (c) {
+                json.append(",");
+            }
+            if (c & 1) {
+                Append(json, SRFLX_CANDIDATE_FORMAT, c + 1, 1694498815 - c, 1 + c, 40000 + c, p % 250, 10 + c, 9955 + c);
+            } else {
+                Append(json, HOST_CANDIDATE_FORMAT, c + 1, 2130706431 - c, p % 250, 10 + c, 9955 + c);
+            }
+        }
+        json.append(CANDIDATES_TAIL);
+    }
+    json.append("]}");
+    return json;
+}
+
+/** Build a persistent connection response mixing revocations and start ICE checks messages */
+static String BuildRevocations(uint32_t count)
+{
+    String json("{\"msgs\":[");
+    for (uint32_t i = 0; i < count; ++i) {
+        if (i) {
+            json.append(",");
+        }
+        switch (i % 3) {
+        case 0:
+            Append(json, REVOKED_FORMAT, i, 2 * i, 2 * i + 1);
+            break;
+
+        case 1:
+            Append(json, REVOKE_ALL_FORMAT, i);
+            break;
+
+        default:
+            Append(json, START_CHECKS_FORMAT, i);
+            break;
+        }
+    }
+    json.append("]}");
+    return json;
+}
+
+/** Read a payload recorded from a Rendezvous Server into a String */
+static bool ReadFile(const char* fileName, String& json)
+{
+    FILE* fp = fopen(fileName, "rb");
+    if (!fp) {
+        printf("Unable to open %s\n", fileName);
+        return false;
+    }
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        json.append(buf, len);
+    }
+    fclose(fp);
+    return true;
+}
+
+/** Decode a STUNInfo object from a jsoncpp document */
+static void ReferenceSTUNInfo(const Json::Value& obj, bool allowHostNames, STUNServerInfo& info)
+{
+    if (allowHostNames) {
+        info.address.SetAddress(String(obj["address"].asCString()), true);
+    } else {
+        info.address.SetAddress(String(obj["address"].asCString()));
+    }
+    if (obj.isMember("port")) {
+        info.port = obj["port"].asInt();
+    }
+    info.acct = String(obj["acct"].asCString());
+    info.pwd = String(obj["pwd"].asCString());
+    info.expiryTime = (obj["expiryTime"].asInt() - TURN_TOKEN_EXPIRY_TIME_BUFFER_IN_SECONDS) * 1000;
+    info.relayInfoPresent = obj.isMember("relay");
+    if (info.relayInfoPresent) {
+        info.relay.address.SetAddress(String(obj["relay"]["address"].asCString()));
+        info.relay.port = obj["relay"]["port"].asInt();
+    }
+}
+
+/**
+ * Decode a messages response the way the decoders did before JsonPullParser: parse the payload
+ * into a jsoncpp document and walk it.
+ */
+static bool ReferenceDecode(const String& json, ResponseMessage& parsed)
+{
+    Json::Reader reader;
+    Json::Value root;
+    if (!reader.parse(json.data(), json.data() + json.size(), root)) {
+        return false;
+    }
+    const Json::Value& msgs = root["msgs"];
+    if (!msgs.isArray() || msgs.empty()) {
+        return false;
+    }
+    for (Json::UInt i = 0; i < msgs.size(); ++i) {
+        const Json::Value& msg = msgs[i];
+        String type = String(msg["type"].asCString());
+        Response response;
+
+        if (type == "match") {
+            const Json::Value& obj = msg["match"];
+            SearchMatchResponse* match = new SearchMatchResponse();
+            match->matchID = String(obj["matchID"].asCString());
+            match->service = String(obj["service"].asCString());
+            match->peerAddr = String(obj["peerAddr"].asCString());
+            ReferenceSTUNInfo(obj["STUNInfo"], true, match->STUNInfo);
+            response.type = SEARCH_MATCH_RESPONSE;
+            response.response = match;
+        } else if (type == "addressCandidates") {
+            const Json::Value& obj = msg["addressCandidates"];
+            AddressCandidatesResponse* candidates = new AddressCandidatesResponse();
+            candidates->source = String(obj["source"].asCString());
+            candidates->destination = String(obj["destination"].asCString());
+            candidates->peerAddr = String(obj["peerAddr"].asCString());
+            candidates->matchID = String(obj["matchID"].asCString());
+            candidates->ice_ufrag = String(obj["ice-ufrag"].asCString());
+            candidates->ice_pwd = String(obj["ice-pwd"].asCString());
+            const Json::Value& list = obj["candidates"];
+            for (Json::UInt c = 0; c < list.size(); ++c) {
+                const Json::Value& cand = list[c];
+                ICECandidates candidate;
+                candidate.type = GetICECandidateTypeValue(String(cand["type"].asCString()));
+                candidate.foundation = String(cand["foundation"].asCString());
+                candidate.componentID = cand["componentID"].asInt();
+                candidate.transport = GetICETransportTypeValue(String(cand["transport"].asCString()));
+                candidate.priority = cand["priority"].asInt();
+                candidate.address = IPAddress(String(cand["address"].asCString()));
+                candidate.port = cand["port"].asInt();
+                if (candidate.type != HOST_CANDIDATE) {
+                    candidate.raddress = IPAddress(String(cand["raddress"].asCString()));
+                    candidate.rport = cand["rport"].asInt();
+                }
+                candidates->candidates.push_back(candidate);
+            }
+            candidates->STUNInfoPresent = obj.isMember("STUNInfo");
+            if (candidates->STUNInfoPresent) {
+                ReferenceSTUNInfo(obj["STUNInfo"], false, candidates->STUNInfo);
+            }
+            response.type = ADDRESS_CANDIDATES_RESPONSE;
+            response.response = candidates;
+        } else if (type == "matchRevoked") {
+            const Json::Value& obj = msg["matchRevoked"];
+            MatchRevokedResponse* revoked = new MatchRevokedResponse();
+            revoked->peerAddr = String(obj["peerAddr"].asCString());
+            revoked->deleteAll = obj.isMember("deleteAll") && obj["deleteAll"].asBool();
+            if (!revoked->deleteAll) {
+                const Json::Value& services = obj["services"];
+                for (Json::UInt s = 0; s < services.size(); ++s) {
+                    revoked->services.push_back(String(services[s].asCString()));
+                }
+            }
+            response.type = MATCH_REVOKED_RESPONSE;
+            response.response = revoked;
+        } else if (type == "startICEChecks") {
+            StartICEChecksResponse* startChecks = new StartICEChecksResponse();
+            startChecks->peerAddr = String(msg["startICEChecks"]["peerAddr"].asCString());
+            response.type = START_ICE_CHECKS_RESPONSE;
+            response.response = startChecks;
+        } else {
+            return false;
+        }
+        parsed.msgs.push_back(response);
+    }
+    return true;
+}
+
+/** Free the responses of a decoded message */
+static void FreeMessages(ResponseMessage& parsed)
+{
+    while (!parsed.msgs.empty()) {
+        Response& response = parsed.msgs.front();
+        switch (response.type) {
+        case SEARCH_MATCH_RESPONSE:
+            delete static_cast<SearchMatchResponse*>(response.response);
+            break;
+
+        case ADDRESS_CANDIDATES_RESPONSE:
+            delete static_cast<AddressCandidatesResponse*>(response.response);
+            break;
+
+        case MATCH_REVOKED_RESPONSE:
+            delete static_cast<MatchRevokedResponse*>(response.response);
+            break;
+
+        case START_ICE_CHECKS_RESPONSE:
+            delete static_cast<StartICEChecksResponse*>(response.response);
+            break;
+
+        default:
+            break;
+        }
+        parsed.msgs.pop_front();
+    }
+}
+
+/** Render the STUN server info into a digest */
+static void DigestSTUNInfo(const STUNServerInfo& info, String& out)
+{
+    out += info.address.ToString() + "|" + U32ToString(info.port) + "|" + info.acct + "|" + info.pwd + "|" +
+           U32ToString(info.expiryTime) + "|";
+    if (info.relayInfoPresent) {
+        out += info.relay.address.ToString() + "|" + U32ToString(info.relay.port) + "|";
+    }
+}
+
+/** Render every decoded field of a message into a string so two decodes can be compared */
+static String Digest(const ResponseMessage& parsed)
+{
+    String out;
+    for (list<Response>::const_iterator it = parsed.msgs.begin(); it != parsed.msgs.end(); ++it) {
+        out += U32ToString(it->type) + ":";
+        if (it->type == SEARCH_MATCH_RESPONSE) {
+            const SearchMatchResponse* match = static_cast<const SearchMatchResponse*>(it->response);
+            out += match->matchID + "|" + match->service + "|" + match->peerAddr + "|";
+            DigestSTUNInfo(match->STUNInfo, out);
+        } else if (it->type == ADDRESS_CANDIDATES_RESPONSE) {
+            const AddressCandidatesResponse* candidates = static_cast<const AddressCandidatesResponse*>(it->response);
+            out += candidates->source + "|" + candidates->destination + "|" + candidates->peerAddr + "|" +
+                   candidates->matchID + "|" + candidates->ice_ufrag + "|" + candidates->ice_pwd + "|";
+            for (list<ICECandidates>::const_iterator c = candidates->candidates.begin(); c != candidates->candidates.end(); ++c) {
+                out += U32ToString(c->type) + "|" + c->foundation + "|" + U32ToString(c->componentID) + "|" +
+                       U32ToString(c->transport) + "|" + U32ToString(c->priority) + "|" + c->address.ToString() + "|" +
+                       U32ToString(c->port) + "|";
+                if (c->type != HOST_CANDIDATE) {
+                    out += c->raddress.ToString() + "|" + U32ToString(c->rport) + "|";
+                }
+            }
+            if (candidates->STUNInfoPresent) {
+                DigestSTUNInfo(candidates->STUNInfo, out);
+            }
+        } else if (it->type == MATCH_REVOKED_RESPONSE) {
+            const MatchRevokedResponse* revoked = static_cast<const MatchRevokedResponse*>(it->response);
+            out += revoked->peerAddr + "|" + U32ToString(revoked->deleteAll) + "|";
+            for (list<String>::const_iterator s = revoked->services.begin(); s != revoked->services.end(); ++s) {
+                out += *s + "|";
+            }
+        } else if (it->type == START_ICE_CHECKS_RESPONSE) {
+            out += static_cast<const StartICEChecksResponse*>(it->response)->peerAddr + "|";
+        }
+        out += "\n";
+    }
+    return out;
+}
+
+/** Decode one payload both ways, check the results agree and time both decoders */
+static bool RunPayload(const char* name, const String& json)
+{
+    ResponseMessage reference;
+    ResponseMessage pulled;
+    bool referenceOk = ReferenceDecode(json, reference);
+    QStatus status = ParseMessagesResponse(json, pulled);
+
+    bool ok = referenceOk && (status == ER_OK) && (Digest(reference) == Digest(pulled));
+    size_t numMsgs = pulled.msgs.size();
+    FreeMessages(reference);
+    FreeMessages(pulled);
+    if (!ok) {
+        printf("%-14s decodes differ (jsoncpp %s, pull parser %s)\n", name, referenceOk ? "ok" : "failed", QCC_StatusText(status));
+        return false;
+    }
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        ResponseMessage parsed;
+        ReferenceDecode(json, parsed);
+        FreeMessages(parsed);
+    }
+    uint64_t referenceTime = GetTimestamp64() - start;
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        ResponseMessage parsed;
+        ParseMessagesResponse(json, parsed);
+        FreeMessages(parsed);
+    }
+    uint64_t pullTime = GetTimestamp64() - start;
+
+    printf("%-14s %7u bytes %4u msgs  jsoncpp %8.1f us  pull parser %8.1f us  (%.2fx)\n",
+           name, (uint32_t)json.size(), (uint32_t)numMsgs,
+           (1000.0 * referenceTime) / g_iterations, (1000.0 * pullTime) / g_iterations,
+           pullTime ? ((double)referenceTime / pullTime) : 0.0);
+    return true;
+}
+
+static void Usage(void)
+{
+    printf("Usage: rdvzjsonbench [-h] [-i <iterations>] [-m <matches>] [-c <candidates>] [<file> ...]\n\n");
+    printf("Options:\n");
+    printf("   -h                - Print this help message\n");
+    printf("   -i <iterations>   - Number of times each payload is decoded (default %u)\n", g_iterations);
+    printf("   -m <matches>      - Messages in each built payload (default %u)\n", g_matches);
+    printf("   -c <candidates>   - Candidates in each address candidates message (default %u)\n", g_candidates);
+    printf("   <file>            - Messages response recorded from a Rendezvous Server\n");
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    vector<const char*> files;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-i", argv[i])) && (++i < argc)) {
+            g_iterations = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-m", argv[i])) && (++i < argc)) {
+            g_matches = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-c", argv[i])) && (++i < argc)) {
+            g_candidates = strtoul(argv[i], NULL, 10);
+        } else if (argv[i][0] != '-') {
+            files.push_back(argv[i]);
+        } else {
+            Usage();
+            exit((0 == strcmp("-h", argv[i])) ? 0 : 1);
+        }
+    }
+
+    bool ok = true;
+    ok = RunPayload("searchMatch", BuildMatches(g_matches)) && ok;
+    ok = RunPayload("candidates", BuildCandidates(g_matches / 4 + 1, g_candidates)) && ok;
+    ok = RunPayload("matchRevoked", BuildRevocations(g_matches)) && ok;
+    ok = RunPayload("singleMatch", BuildMatches(1)) && ok;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        String json;
+        ok = ReadFile(files[i], json) && RunPayload(files[i], json) && ok;
+    }
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,366 @@
+/**
+ * @file
+ * STUN codec benchmark, compares StunMessageView and StunMessageBuilder with parsing and
+ * rendering through StunMessage
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <qcc/IPAddress.h>
+#include <qcc/ScatterGatherList.h>
+#include <qcc/String.h>
+#include <qcc/time.h>
+
+#include <ICESession.h>
+#include <StunAttribute.h>
+#include <StunMessage.h>
+#include <StunMessageView.h>
+#include <StunTransactionID.h>
+
+#include <Status.h>
+
+#define QCC_MODULE "STUNCODECBENCH"
+
+using namespace qcc;
+
+static uint32_t g_iterations = 100000;
+static uint32_t g_dataSize = 200;
+
+static const char USERNAME[] = "Jc7fqP:y8Qe0bWn";
+static const uint8_t HMAC_KEY[] = "T4pVs9Jq+Kx2eA1y8Qe0bWn6";
+static const size_t HMAC_KEY_LEN = sizeof(HMAC_KEY) - 1;
+static const uint32_t PRIORITY = 0x6e0001ff;
+static const uint64_t TIE_BREAKER = 0x0123456789abcdefULL;
+static const uint16_t PEER_PORT = 49152;
+
+static uint8_t g_data[2048];
+
+/*
+ * The messages the benchmark works with.  A connectivity check is what ICE
+ * sends and receives for every candidate pair and keepalive, a role conflict
+ * is the error response to a check, a Data indication is what the TURN
+ * server wraps relayed traffic in.
+ */
+typedef enum {
+    CONNECTIVITY_CHECK,
+    ROLE_CONFLICT,
+    DATA_INDICATION
+} MessageKind;
+
+static StunMsgTypeClass MessageClass(MessageKind kind)
+{
+    switch (kind) {
+    case CONNECTIVITY_CHECK:
+        return STUN_MSG_REQUEST_CLASS;
+
+    case ROLE_CONFLICT:
+        return STUN_MSG_ERROR_CLASS;
+
+    default:
+        return STUN_MSG_INDICATION_CLASS;
+    }
+}
+
+static IPAddress PeerAddress()
+{
+    static const uint8_t addr[] = { 203, 0, 113, 17 };
+    return IPAddress(addr, sizeof(addr));
+}
+
+/** Render a message with StunMessage into a contiguous buffer */
+static QStatus RenderReference(MessageKind kind, StunTransactionID& tid, uint8_t* buf, size_t bufSize, size_t& size)
+{
+    QStatus status;
+    bool binding = (kind != DATA_INDICATION);
+    StunMessage msg(MessageClass(kind),
+                    binding ? STUN_MSG_BINDING_METHOD : STUN_MSG_DATA_METHOD,
+                    binding ? HMAC_KEY : NULL, binding ? HMAC_KEY_LEN : 0, tid);
+
+    if (kind == CONNECTIVITY_CHECK) {
+        status = msg.AddAttribute(new StunAttributeUsername(String(USERNAME)));
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributePriority(PRIORITY));
+        }
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributeIceControlling(TIE_BREAKER));
+        }
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributeUseCandidate());
+        }
+    } else if (kind == ROLE_CONFLICT) {
+        status = msg.AddAttribute(new StunAttributeErrorCode(STUN_ERR_CODE_ROLE_CONFLICT, "Role Conflict"));
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributeXorMappedAddress(msg, PeerAddress(), PEER_PORT));
+        }
+    } else {
+        status = msg.AddAttribute(new StunAttributeXorPeerAddress(msg, PeerAddress(), PEER_PORT));
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributeData(g_data, g_dataSize));
+        }
+    }
+    if (binding) {
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributeRequestedTransport(ajn::REQUESTED_TRANSPORT_TYPE_UDP));
+        }
+        if (status == ER_OK) {
+            status = msg.AddAttribute(new StunAttributeMessageIntegrity(msg));
+        }
+    }
+    if (status == ER_OK) {
+        status = msg.AddAttribute(new StunAttributeFingerprint(msg));
+    }
+    if (status == ER_OK) {
+        ScatterGatherList sg;
+        size_t renderSize = msg.RenderSize();
+        uint8_t* renderBuf = new uint8_t[renderSize];
+        uint8_t* pos = renderBuf;
+
+        status = msg.RenderBinary(pos, renderSize, sg);
+        if (status == ER_OK) {
+            size = msg.Size();
+            if (size > bufSize) {
+                status = ER_BUFFER_TOO_SMALL;
+            } else {
+                sg.CopyToBuffer(buf, size);
+            }
+        }
+        delete [] renderBuf;
+    }
+    return status;
+}
+
+/** Render a message with StunMessageBuilder */
+static QStatus RenderBuilder(MessageKind kind, const StunTransactionID& tid, uint8_t* buf, size_t bufSize, size_t& size)
+{
+    QStatus status;
+    bool binding = (kind != DATA_INDICATION);
+    StunMessageBuilder msg(buf, bufSize, MessageClass(kind),
+                           binding ? STUN_MSG_BINDING_METHOD : STUN_MSG_DATA_METHOD,
+                           tid);
+
+    if (kind == CONNECTIVITY_CHECK) {
+        status = msg.AddAttribute(STUN_ATTR_USERNAME, USERNAME, sizeof(USERNAME) - 1);
+        if (status == ER_OK) {
+            status = msg.AddUInt32(STUN_ATTR_PRIORITY, PRIORITY);
+        }
+        if (status == ER_OK) {
+            status = msg.AddUInt64(STUN_ATTR_ICE_CONTROLLING, TIE_BREAKER);
+        }
+        if (status == ER_OK) {
+            status = msg.AddAttribute(STUN_ATTR_USE_CANDIDATE, NULL, 0);
+        }
+    } else if (kind == ROLE_CONFLICT) {
+        status = msg.AddErrorCode(STUN_ERR_CODE_ROLE_CONFLICT, "Role Conflict");
+        if (status == ER_OK) {
+            status = msg.AddXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, PeerAddress(), PEER_PORT);
+        }
+    } else {
+        status = msg.AddXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, PeerAddress(), PEER_PORT);
+        if (status == ER_OK) {
+            status = msg.AddAttribute(STUN_ATTR_DATA, g_data, g_dataSize);
+        }
+    }
+    if (binding && (status == ER_OK)) {
+        status = msg.AddUInt32(STUN_ATTR_REQUESTED_TRANSPORT, static_cast<uint32_t>(ajn::REQUESTED_TRANSPORT_TYPE_UDP) << 24);
+    }
+    if (status == ER_OK) {
+        status = msg.Finish(binding ? HMAC_KEY : NULL, HMAC_KEY_LEN, true);
+    }
+    size = msg.Size();
+    return status;
+}
+
+/** Parse a message with StunMessage and pull out the attributes the receive path uses */
+static QStatus ParseReference(MessageKind kind, const uint8_t* buf, size_t size, uint32_t& value)
+{
+    StunMessage msg(String(USERNAME), HMAC_KEY, HMAC_KEY_LEN);
+    const uint8_t* pos = buf;
+    QStatus status = msg.Parse(pos, size);
+
+    value = 0;
+    if (status == ER_OK) {
+        StunMessage::const_iterator iter;
+        for (iter = msg.Begin(); iter != msg.End(); ++iter) {
+            if ((*iter)->GetType() == STUN_ATTR_PRIORITY) {
+                value = reinterpret_cast<StunAttributePriority*>(*iter)->GetPriority();
+            } else if ((*iter)->GetType() == STUN_ATTR_DATA) {
+                value = reinterpret_cast<StunAttributeData*>(*iter)->GetData().DataSize();
+            } else if ((*iter)->GetType() == STUN_ATTR_ERROR_CODE) {
+                StunErrorCodes error;
+                String reason;
+                reinterpret_cast<StunAttributeErrorCode*>(*iter)->GetError(error, reason);
+                value = error;
+            }
+        }
+    }
+    return status;
+}
+
+/** Parse a message with StunMessageView and pull out the attributes the receive path uses */
+static QStatus ParseView(MessageKind kind, const uint8_t* buf, size_t size, uint32_t& value)
+{
+    StunMessageView msg;
+    QStatus status = msg.Parse(buf, size);
+
+    value = 0;
+    if (status == ER_OK) {
+        status = msg.Verify((kind != DATA_INDICATION) ? HMAC_KEY : NULL, HMAC_KEY_LEN);
+    }
+    if (status == ER_OK) {
+        const StunMessageView::Attribute* attr = msg.FindAttribute(STUN_ATTR_PRIORITY);
+        if (attr != NULL) {
+            status = StunMessageView::GetUInt32(*attr, value);
+        }
+        attr = msg.FindAttribute(STUN_ATTR_DATA);
+        if (attr != NULL) {
+            value = attr->length;
+        }
+        attr = msg.FindAttribute(STUN_ATTR_ERROR_CODE);
+        if ((attr != NULL) && (status == ER_OK)) {
+            StunErrorCodes error;
+            status = StunMessageView::GetErrorCode(*attr, error);
+            value = error;
+        }
+    }
+    return status;
+}
+
+static void Report(const char* name, const char* what, uint64_t referenceTime, uint64_t viewTime)
+{
+    printf("%-17s %-6s StunMessage %7.3f us  view/builder %7.3f us  (%.2fx)\n",
+           name, what,
+           (1000.0 * referenceTime) / g_iterations, (1000.0 * viewTime) / g_iterations,
+           viewTime ? ((double)referenceTime / viewTime) : 0.0);
+}
+
+static bool RunMessage(const char* name, MessageKind kind)
+{
+    uint8_t reference[2048];
+    uint8_t built[2048];
+    size_t referenceSize = 0;
+    size_t builtSize = 0;
+    uint32_t referenceValue;
+    uint32_t viewValue;
+    StunTransactionID tid;
+    QStatus status;
+
+    tid.SetValue();
+
+    /*
+     * Both renderings must be identical and each parser must accept the
+     * message and find the same attribute values.
+     */
+    status = RenderReference(kind, tid, reference, sizeof(reference), referenceSize);
+    if (status == ER_OK) {
+        status = RenderBuilder(kind, tid, built, sizeof(built), builtSize);
+    }
+    if (status != ER_OK) {
+        printf("%-17s rendering failed (%s)\n", name, QCC_StatusText(status));
+        return false;
+    }
+    if ((referenceSize != builtSize) || (memcmp(reference, built, builtSize) != 0)) {
+        printf("%-17s renderings differ (%u and %u bytes)\n", name, (uint32_t)referenceSize, (uint32_t)builtSize);
+        return false;
+    }
+    status = ParseReference(kind, built, builtSize, referenceValue);
+    if (status == ER_OK) {
+        status = ParseView(kind, built, builtSize, viewValue);
+    }
+    if ((status != ER_OK) || (referenceValue != viewValue)) {
+        printf("%-17s parses differ (%s)\n", name, QCC_StatusText(status));
+        return false;
+    }
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        RenderReference(kind, tid, reference, sizeof(reference), referenceSize);
+    }
+    uint64_t referenceTime = GetTimestamp64() - start;
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        RenderBuilder(kind, tid, built, sizeof(built), builtSize);
+    }
+    Report(name, "render", referenceTime, GetTimestamp64() - start);
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        ParseReference(kind, built, builtSize, referenceValue);
+    }
+    referenceTime = GetTimestamp64() - start;
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < g_iterations; ++i) {
+        ParseView(kind, built, builtSize, viewValue);
+    }
+    Report(name, "parse", referenceTime, GetTimestamp64() - start);
+
+    /*
+     * A corrupted message must be rejected by the view.
+     */
+    built[StunMessage::MIN_MSG_SIZE + 6] ^= 0x01;
+    status = ParseView(kind, built, builtSize, viewValue);
+    if (status == ER_OK) {
+        printf("%-17s corrupted message accepted\n", name);
+        return false;
+    }
+    return true;
+}
+
+static void Usage(void)
+{
+    printf("Usage: stuncodecbench [-h] [-i <iterations>] [-d <data size>]\n\n");
+    printf("Options:\n");
+    printf("   -h                - Print this help message\n");
+    printf("   -i <iterations>   - Number of times each message is rendered and parsed (default %u)\n", g_iterations);
+    printf("   -d <data size>    - Size of the relayed data in the Data indication (default %u)\n", g_dataSize);
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-i", argv[i])) && (++i < argc)) {
+            g_iterations = strtoul(argv[i], NULL, 10);
+        } else if ((0 == strcmp("-d", argv[i])) && (++i < argc)) {
+            g_dataSize = strtoul(argv[i], NULL, 10);
+            if (g_dataSize > 1400) {
+                g_dataSize = 1400;
+            }
+        } else {
+            Usage();
+            exit((0 == strcmp("-h", argv[i])) ? 0 : 1);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(g_data); ++i) {
+        g_data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    bool ok = true;
+    ok = RunMessage("connectivityCheck", CONNECTIVITY_CHECK) && ok;
+    ok = RunMessage("roleConflict", ROLE_CONFLICT) && ok;
+    ok = RunMessage("dataIndication", DATA_INDICATION) && ok;
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -32,7 +32,7 @@
 #define QCC_MODULE  "ALLJOYN"
 
 /** Daemon-to-daemon protocol version number */
-#define ALLJOYN_PROTOCOL_VERSION  3
+#define ALLJOYN_PROTOCOL_VERSION  5
 
 namespace ajn {
 
@@ -47,6 +47,7 @@ extern const char* ObjectPath;                    /**< Object path */
 extern const char* InterfaceName;                 /**< Interface name */
 extern const char* WellKnownName;                 /**< Well known bus name */
 extern const char* Secure;                        /**< Secure interface annotation */
+extern const char* AnnotateLastValue;             /**< Annotation for signals where only the most recent value matters */
 
 /** Interface definitions for org.alljoyn.Bus.Peer.* */
 namespace Peer {
@@ -61,6 +62,16 @@ namespace Session {
 extern const char* InterfaceName;                      /**<Interface name */
 }
 }
+
+/** Interface definitions for org.alljoyn.Bus.Properties */
+namespace Properties {
+extern const char* InterfaceName;                      /**< Interface name */
+}
+
+/** Interface definitions for org.alljoyn.Bus.Introspectable */
+namespace Introspectable {
+extern const char* InterfaceName;                      /**< Interface name */
+}
 }
 
 /** Interface definitions for org.alljoyn.Daemon */
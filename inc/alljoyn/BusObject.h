@@ -28,6 +28,7 @@
 #include <qcc/String.h>
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/MsgArg.h>
+#include <alljoyn/MsgArgCodec.h>
 #include <alljoyn/MessageReceiver.h>
 #include <alljoyn/Session.h>
 #include <Status.h>
@@ -145,6 +146,9 @@ class BusObject : public MessageReceiver {
      *                         - If ::ALLJOYN_FLAG_GLOBAL_BROADCAST is set broadcast signal (null destination) will be forwarded across bus-to-bus connections.
      *                         - If ::ALLJOYN_FLAG_COMPRESSED is set the header is compressed for destinations that can handle header compression.
      *                         - If ::ALLJOYN_FLAG_ENCRYPTED is set the message is authenticated and the payload if any is encrypted.
+     *                         - If ::ALLJOYN_FLAG_LAST_VALUE is set only the most recent value matters so a newer instance of the
+     *                           signal replaces an older one still waiting to be sent. The flag is set automatically for signals
+     *                           annotated with ::MEMBER_ANNOTATE_LAST_VALUE.
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
@@ -157,6 +161,54 @@ class BusObject : public MessageReceiver {
                    uint16_t timeToLive = 0,
                    uint8_t flags = 0);
 
+    /**
+     * Send a signal with typed arguments. The arguments are marshaled directly from the values
+     * without building MsgArgs. Use MakeArgs() to create the arguments.
+     *
+     * @param destination      The unique or well-known bus name or the signal recipient (NULL for broadcast signals)
+     * @param sessionId        A unique SessionId for this AllJoyn session instance
+     * @param signal           Interface member of signal being emitted.
+     * @param args             The typed arguments for the signal
+     * @param timeToLive       If non-zero this specifies in milliseconds the useful lifetime for this signal.
+     * @param flags            Logical OR of the message flags for this signals, see Signal() above.
+     * @return
+     *      - #ER_OK if successful
+     *      - #ER_BUS_UNEXPECTED_SIGNATURE if the types of the arguments do not match the signal's signature
+     *      - An error status otherwise
+     */
+    QStatus Signal(const char* destination,
+                   SessionId sessionId,
+                   const InterfaceDescription::Member& signal,
+                   const TypedMsgArgs& args,
+                   uint16_t timeToLive = 0,
+                   uint8_t flags = 0);
+
+    /**
+     * Emit an org.freedesktop.DBus.Properties.PropertiesChanged signal for a property. Proxies that
+     * cache property values use this signal to keep their caches up to date so an object that has
+     * properties that change should emit this signal whenever one changes.
+     *
+     * @param ifcName    The name of the interface the property belongs to.
+     * @param propName   The name of the property that changed.
+     * @param val        The new value of the property.
+     * @param sessionId  The session to send the signal on or 0 to broadcast it.
+     *
+     * @return
+     *      - #ER_OK if successful
+     *      - #ER_BUS_OBJECT_NO_SUCH_INTERFACE if this object doesn't implement the interface.
+     *      - #ER_BUS_NO_SUCH_PROPERTY if the interface doesn't have the property.
+     *      - An error status otherwise
+     */
+    QStatus EmitPropChanged(const char* ifcName, const char* propName, const MsgArg& val, SessionId sessionId);
+
+    /**
+     * Configure this object to emit a PropertiesChanged signal whenever a property is successfully
+     * set by a remote Properties.Set call. The signal is sent on the session the Set call came in on.
+     * Properties that change for other reasons must be reported by calling EmitPropChanged().
+     *
+     * @param emit  true to emit PropertiesChanged after each successful Properties.Set.
+     */
+    void SetEmitPropChangedOnSet(bool emit);
 
     /**
      * Add an interface to this object. If the interface has properties this will also add the
@@ -290,6 +342,18 @@ class BusObject : public MessageReceiver {
      */
     virtual void GetAllProps(const InterfaceDescription::Member* member, Message& msg);
 
+    /**
+     * Default handler for a bus attempt to read several properties in one method call.
+     * @remark
+     * A derived class can override this function to provide a custom handler for the GetMultiProps
+     * method call. If overridden the custom handler must compose a reply message with one status
+     * and value pair for each requested property, in the order they were requested.
+     *
+     * @param member   Identifies the org.alljoyn.Bus.Properties.GetMulti method.
+     * @param msg      The Properties.GetMulti request.
+     */
+    virtual void GetMultiProps(const InterfaceDescription::Member* member, Message& msg);
+
     /**
      * Default handler for a bus attempt to read the object's introspection data.
      * @remark
@@ -301,6 +365,19 @@ class BusObject : public MessageReceiver {
      */
     virtual void Introspect(const InterfaceDescription::Member* member, Message& msg);
 
+    /**
+     * Default handler for a bus attempt to get a hash of the object's introspection data. Proxy
+     * objects that have an introspection cache enabled use the hash to avoid transferring and
+     * parsing introspection data they have seen before.
+     * @remark
+     * A derived class that overrides Introspect() must also override this function so the hash
+     * changes whenever the custom introspection data changes.
+     *
+     * @param member   Identifies the @c org.alljoyn.Bus.Introspectable.GetIntrospectionHash method.
+     * @param msg      The Introspectable.GetIntrospectionHash request.
+     */
+    virtual void GetIntrospectionHash(const InterfaceDescription::Member* member, Message& msg);
+
     /**
      * This method can be overridden to provide access to the context registered in the AddMethodHandler() call.
      *
@@ -325,6 +402,30 @@ class BusObject : public MessageReceiver {
      */
     BusObject(const BusObject& other) : bus(other.bus) { }
 
+    /**
+     * Check that a property can be read by a message and get its value.
+     *
+     * @param ifaceName    The interface the property belongs to.
+     * @param propName     The property name.
+     * @param isEncrypted  True if the request was encrypted.
+     * @param val          Returns the property value.
+     *
+     * @return  ER_OK if the property was read, otherwise the status to return to the caller.
+     */
+    QStatus GetPropValue(const char* ifaceName, const char* propName, bool isEncrypted, MsgArg& val);
+
+    /**
+     * Send a signal with either MsgArg or typed arguments.
+     */
+    QStatus SendSignal(const char* destination,
+                       SessionId sessionId,
+                       const InterfaceDescription::Member& signal,
+                       const MsgArg* args,
+                       size_t numArgs,
+                       const TypedMsgArgs* typedArgs,
+                       uint16_t timeToLive,
+                       uint8_t flags);
+
     /**
      * Add the registered methods for this object to a method table.
      *
@@ -48,6 +48,7 @@ static const uint8_t PROP_ACCESS_RW    = 3; /**< Read-Write Access type */
 // @{
 static const uint8_t MEMBER_ANNOTATE_NO_REPLY   = 1; /**< No reply annotate flag */
 static const uint8_t MEMBER_ANNOTATE_DEPRECATED = 2; /**< Deprecated annotate flag */
+static const uint8_t MEMBER_ANNOTATE_LAST_VALUE = 4; /**< Only the most recent value of the signal needs to be delivered */
 // @}
 
 /**
@@ -88,7 +89,7 @@ class InterfaceDescription {
         qcc::String signature;               /**< Method call IN arguments (NULL for signals) */
         qcc::String returnSignature;         /**< Signal or method call OUT arguments */
         qcc::String argNames;                /**< Comma separated list of argument names - can be NULL */
-        uint8_t annotation;                  /**< Exclusive OR of flags MEMBER_ANNOTATE_NO_REPLY and MEMBER_ANNOTATE_DEPRECATED */
+        uint8_t annotation;                  /**< Exclusive OR of flags MEMBER_ANNOTATE_NO_REPLY, MEMBER_ANNOTATE_DEPRECATED and MEMBER_ANNOTATE_LAST_VALUE */
         qcc::String accessPerms;              /**< Required permissions to invoke this call */
 
         /** %Member constructor */
@@ -56,6 +56,10 @@ static const uint8_t ALLJOYN_FLAG_NO_REPLY_EXPECTED  = 0x01;
 static const uint8_t ALLJOYN_FLAG_AUTO_START         = 0x02;
 /** Allow messages from remote hosts (valid only in Hello message) */
 static const uint8_t ALLJOYN_FLAG_ALLOW_REMOTE_MSG   = 0x04;
+/** Body is compressed (only used on connections that negotiated body compression) */
+static const uint8_t ALLJOYN_FLAG_BODY_COMPRESSED    = 0x08;
+/** Signal carries state where only the most recent value matters, older queued instances may be discarded */
+static const uint8_t ALLJOYN_FLAG_LAST_VALUE         = 0x10;
 /** Global (bus-to-bus) broadcast */
 static const uint8_t ALLJOYN_FLAG_GLOBAL_BROADCAST   = 0x20;
 /** Header is compressed */
@@ -152,6 +156,8 @@ class HeaderFields {
  */
 class _Message;
 class BusAttachment;
+class MarshalPlan;
+class TypedMsgArgs;
 
 /**
  * Message is a reference counted (managed) version of _Message
@@ -207,6 +213,14 @@ class _Message {
      */
     bool IsGlobalBroadcast() const { return IsBroadcastSignal() && (msgHeader.flags & ALLJOYN_FLAG_GLOBAL_BROADCAST); }
 
+    /**
+     * Determine if message is a signal where only the most recent value matters. A newer instance of
+     * such a signal may replace an older one that is still waiting to be sent.
+     *
+     * @return  Return true if this is a last value signal.
+     */
+    bool IsLastValueSignal() const { return (GetType() == MESSAGE_SIGNAL) && (msgHeader.flags & ALLJOYN_FLAG_LAST_VALUE); }
+
     /**
      * Returns the flags for the message.
      * @return flags for the message
@@ -591,6 +605,7 @@ class _Message {
      * @param args        The method call argument list (can be NULL)
      * @param numArgs     The number of arguments
      * @param flags       A logical OR of the AllJoyn flags
+     * @param typedArgs   Typed arguments to marshal instead of args (can be NULL)
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
@@ -604,7 +619,8 @@ class _Message {
                     uint32_t& serial,
                     const MsgArg* args,
                     size_t numArgs,
-                    uint8_t flags);
+                    uint8_t flags,
+                    const TypedMsgArgs* typedArgs = NULL);
 
     /**
      * @internal
@@ -621,6 +637,7 @@ class _Message {
      * @param flags       A logical OR of the AllJoyn flags.
      * @param timeToLive  Time-to-live in milliseconds. Signals that cannot be sent within this time
      *                    limit are discarded. Zero indicates reliable delivery.
+     * @param typedArgs   Typed arguments to marshal instead of args (can be NULL)
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
@@ -634,7 +651,8 @@ class _Message {
                       const MsgArg* args,
                       size_t numArgs,
                       uint8_t flags,
-                      uint16_t timeToLive);
+                      uint16_t timeToLive,
+                      const TypedMsgArgs* typedArgs = NULL);
 
 
     /**
@@ -683,6 +701,68 @@ class _Message {
      */
     QStatus ReMarshal(const char* senderName, bool newSerial = false);
 
+    /**
+     * @internal
+     * Marshal the header and header fields into a new buffer with room for a body. The current
+     * buffer is not freed.
+     *
+     * @param bodyLen   Length of the body the buffer must have room for.
+     */
+    void MarshalHeader(size_t bodyLen);
+
+    /**
+     * @internal
+     * Get a message holding just the marshaled header of this message. The body is not copied,
+     * it is sent from this message.
+     *
+     * @return  A new message that the caller must delete.
+     */
+    _Message* CloneHeader() const;
+
+    /**
+     * @internal
+     * Get the header of this message compressed for a specific endpoint. The header carries the
+     * expansion inline if the remote side has not seen the compression token yet. The body is not
+     * copied, it is sent from this message.
+     *
+     * @param endpoint   Endpoint the message is about to be delivered to.
+     * @return
+     *      - A new message holding just the header that the caller must delete
+     *      - NULL if the message can be delivered as is
+     */
+    _Message* CompressForEndpoint(RemoteEndpoint& endpoint);
+
+    /**
+     * @internal
+     * Compress the message body. The compressed body is prefixed by the uncompressed length.
+     *
+     * @param argsLen   Length of the body.
+     * @param compLen   Returns the length of the compressed body.
+     * @return
+     *      - A new buffer holding the compressed body that the caller must delete
+     *      - NULL if the body is too short or doesn't compress well enough to be worth it
+     */
+    uint8_t* CompressBody(size_t argsLen, size_t& compLen) const;
+
+    /**
+     * @internal
+     * Set the #ALLJOYN_FLAG_BODY_COMPRESSED flag and the body length in a header returned by
+     * CloneHeader() or CompressForEndpoint() that is sent ahead of a compressed body.
+     *
+     * @param len       Length of the compressed body.
+     */
+    void SetCompressedBodyLen(size_t len);
+
+    /**
+     * @internal
+     * Decompress a body that was compressed by the sender and clear the #ALLJOYN_FLAG_BODY_COMPRESSED flag.
+     *
+     * @return
+     *      - #ER_OK if the body was decompressed
+     *      - #ER_BUS_BAD_COMPRESSED_BODY if the body could not be decompressed
+     */
+    QStatus DecompressBody();
+
     /// @endcond
   private:
 
@@ -790,6 +870,8 @@ class _Message {
     qcc::SocketFd* handles;      ///< Array of file/socket descriptors.
     size_t numHandles;           ///< Number of handles in the handles array
     bool encrypt;                ///< True if the message is to be encrypted
+    uint64_t rxTraceTime;        ///< When message tracing is enabled the time the message was unmarshaled
+    uint64_t routeTraceTime;     ///< When message tracing is enabled the time the message was given to the router
 
     /**
      * The header fields for this message. Which header fields are present depends on the message
@@ -806,6 +888,9 @@ class _Message {
     QStatus ParseArray(MsgArg* arg, const char*& sigPtr);
     QStatus ParseSignature(MsgArg* arg);
     QStatus ParseVariant(MsgArg* arg);
+    QStatus ParsePlannedValue(MsgArg* arg, const MarshalPlan& plan, size_t step);
+    QStatus ParsePlannedArray(MsgArg* arg, const MarshalPlan& plan, size_t step);
+    QStatus ParseFixedValue(MsgArg* arg, const MarshalPlan& plan, size_t step, const uint8_t* base);
 
     /**
      * Check that the header fields are valid. This check is automatically performed when a header
@@ -829,9 +914,12 @@ class _Message {
                            const MsgArg* args,
                            uint8_t numArgs,
                            uint8_t flags,
-                           SessionId sessionId);
+                           SessionId sessionId,
+                           const TypedMsgArgs* typedArgs = NULL);
 
     QStatus MarshalArgs(const MsgArg* arg, size_t numArgs);
+    QStatus MarshalPlannedArgs(const MsgArg* arg, size_t numArgs, const MarshalPlan& plan, size_t step);
+    QStatus MarshalFixedValue(const MsgArg* arg, const MarshalPlan& plan, size_t step, uint8_t* base);
     void MarshalHeaderFields();
     size_t ComputeHeaderLen();
 
@@ -0,0 +1,783 @@
+#ifndef _ALLJOYN_MSGARGCODEC_H
+#define _ALLJOYN_MSGARGCODEC_H
+/**
+ * @file
+ * This file defines templates for marshaling typed C++ values without building MsgArgs
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include MsgArgCodec.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <string.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * %MsgBodyWriter writes the wire encoding of message body values into a buffer. A writer without a
+ * buffer only advances its position so the same code computes the size of a message body before
+ * the buffer for the message is allocated.
+ */
+class MsgBodyWriter {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param buf         The 8 byte aligned buffer to write into or NULL to compute the size.
+     * @param endianSwap  true if the values must be byte swapped.
+     */
+    MsgBodyWriter(uint8_t* buf, bool endianSwap) : buf(buf), pos(0), endianSwap(endianSwap), status(ER_OK) { }
+
+    /**
+     * Get the number of bytes written.
+     */
+    size_t GetSize() const { return pos; }
+
+    /**
+     * Get the status of the writer. This reports errors, such as an array that is too long, that
+     * cannot be detected until the values are written.
+     */
+    QStatus GetStatus() const { return status; }
+
+    /**
+     * Pad with zeroes to an alignment boundary.
+     *
+     * @param alignment  The alignment, a power of 2 no greater than 8.
+     */
+    void Align(size_t alignment)
+    {
+        size_t pad = ((pos + alignment - 1) & ~(alignment - 1)) - pos;
+        if (buf) {
+            memset(buf + pos, 0, pad);
+        }
+        pos += pad;
+    }
+
+    /**
+     * Write a byte.
+     */
+    void Put8(uint8_t val)
+    {
+        if (buf) {
+            buf[pos] = val;
+        }
+        pos += 1;
+    }
+
+    /**
+     * Write a 16 bit value.
+     */
+    void Put16(uint16_t val)
+    {
+        Align(2);
+        if (buf) {
+            *((uint16_t*)(buf + pos)) = endianSwap ? EndianSwap16(val) : val;
+        }
+        pos += 2;
+    }
+
+    /**
+     * Write a 32 bit value.
+     */
+    void Put32(uint32_t val)
+    {
+        Align(4);
+        if (buf) {
+            *((uint32_t*)(buf + pos)) = endianSwap ? EndianSwap32(val) : val;
+        }
+        pos += 4;
+    }
+
+    /**
+     * Write a 64 bit value.
+     */
+    void Put64(uint64_t val)
+    {
+        Align(8);
+        if (buf) {
+            *((uint64_t*)(buf + pos)) = endianSwap ? EndianSwap64(val) : val;
+        }
+        pos += 8;
+    }
+
+    /**
+     * Write a string.
+     *
+     * @param str  The NUL terminated string.
+     * @param len  The length of the string not including the NUL.
+     */
+    void PutString(const char* str, size_t len)
+    {
+        Put32((uint32_t)len);
+        if (buf) {
+            memcpy(buf + pos, str, len + 1);
+        }
+        pos += len + 1;
+    }
+
+    /**
+     * Write an array of fixed size scalars. Values are copied in a single block unless they must
+     * be byte swapped.
+     *
+     * @param vals     The values.
+     * @param numVals  The number of values.
+     */
+    template <typename T>
+    void PutScalars(const T* vals, size_t numVals)
+    {
+        if (!buf) {
+            pos += numVals * sizeof(T);
+        } else if (!endianSwap || (sizeof(T) == 1)) {
+            memcpy(buf + pos, vals, numVals * sizeof(T));
+            pos += numVals * sizeof(T);
+        } else {
+            for (size_t i = 0; i < numVals; ++i) {
+                switch (sizeof(T)) {
+                case 2: Put16(*((const uint16_t*)&vals[i])); break;
+                case 4: Put32(*((const uint32_t*)&vals[i])); break;
+                case 8: Put64(*((const uint64_t*)&vals[i])); break;
+                }
+            }
+        }
+    }
+
+    /**
+     * Start an array. The length is written by EndArray() once the elements have been written.
+     *
+     * @param elemAlignment  The alignment of the array elements.
+     * @param start          [OUT] Position of the first element.
+     *
+     * @return  Position of the array length.
+     */
+    size_t BeginArray(size_t elemAlignment, size_t& start)
+    {
+        Put32(0);
+        size_t lenPos = pos - 4;
+        Align(elemAlignment);
+        start = pos;
+        return lenPos;
+    }
+
+    /**
+     * End an array writing its length.
+     *
+     * @param lenPos  The position returned by BeginArray().
+     * @param start   The position of the first element returned by BeginArray().
+     */
+    void EndArray(size_t lenPos, size_t start)
+    {
+        uint32_t len = (uint32_t)(pos - start);
+        if (len > ALLJOYN_MAX_ARRAY_LEN) {
+            status = ER_BUS_BAD_LENGTH;
+        } else if (buf) {
+            *((uint32_t*)(buf + lenPos)) = endianSwap ? EndianSwap32(len) : len;
+        }
+    }
+
+  private:
+
+    uint8_t* buf;     /**< The buffer or NULL if only the size is being computed */
+    size_t pos;       /**< Current write position */
+    bool endianSwap;  /**< true if values are byte swapped */
+    QStatus status;   /**< Error detected while writing */
+};
+
+/**
+ * %MsgArgCodec maps a C++ type to an AllJoyn type. The mapping is resolved at compile time so
+ * values are marshaled without parsing a signature and a type that has no mapping is a compile
+ * error rather than a runtime failure. Each specialization provides:
+ *
+ *   - alignment: the wire alignment of the type.
+ *   - Signature(): appends the signature of the type.
+ *   - Marshal(): writes a value.
+ *   - Get(): reads a value from a MsgArg, typically one from a received message.
+ *
+ * The types supported and their signatures are:
+ *
+ *   - uint8_t "y", bool "b", int16_t "n", uint16_t "q", int32_t "i", uint32_t "u", int64_t "x",
+ *     uint64_t "t" and double "d".
+ *   - qcc::String "s".
+ *   - std::vector<T> "aT".
+ *   - std::map<K, V> "a{KV}".
+ *   - std::pair<A, B> "(AB)" and MsgArgTuple<A, B, C, D> "(ABCD)".
+ */
+template <typename T>
+struct MsgArgCodec;
+
+/**
+ * Marshaling and getting arrays of values that are not scalars.
+ */
+template <typename T>
+struct MsgArgArrayCodec {
+    /** Write the elements of an array */
+    static void MarshalElements(MsgBodyWriter& writer, const std::vector<T>& vals)
+    {
+        for (typename std::vector<T>::const_iterator it = vals.begin(); it != vals.end(); ++it) {
+            MsgArgCodec<T>::Marshal(writer, *it);
+        }
+    }
+
+    /** Get the elements of an array */
+    static QStatus GetElements(const MsgArg& arg, std::vector<T>& vals)
+    {
+        if (arg.typeId != ALLJOYN_ARRAY) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        const MsgArg* elems = arg.v_array.GetElements();
+        vals.resize(arg.v_array.GetNumElements());
+        for (size_t i = 0; i < vals.size(); ++i) {
+            QStatus status = MsgArgCodec<T>::Get(elems[i], vals[i]);
+            if (status != ER_OK) {
+                return status;
+            }
+        }
+        return ER_OK;
+    }
+};
+
+/**
+ * Fixed size scalars. Arrays of scalars are held in a single MsgArg and are written as a block.
+ */
+#define AJN_MSGARG_SCALAR_CODEC(T, TYPE_ID, FIELD, PUT, ALIGN)                            \
+    template <>                                                                          \
+    struct MsgArgCodec<T> {                                                              \
+        static const size_t alignment = ALIGN;                                           \
+        static const AllJoynTypeId arrayTypeId = (AllJoynTypeId)((TYPE_ID << 8) | ALLJOYN_ARRAY); \
+        static void Signature(qcc::String& sig) { sig.push_back((char)TYPE_ID); }        \
+        static void Marshal(MsgBodyWriter& writer, T val) { writer.PUT(val); }           \
+        static QStatus Get(const MsgArg& arg, T& val)                                    \
+        {                                                                                \
+            if (arg.typeId != TYPE_ID) {                                                 \
+                return ER_BUS_SIGNATURE_MISMATCH;                                        \
+            }                                                                            \
+            val = arg.FIELD;                                                             \
+            return ER_OK;                                                                \
+        }                                                                                \
+        static void MarshalElements(MsgBodyWriter& writer, const std::vector<T>& vals)   \
+        {                                                                                \
+            if (!vals.empty()) {                                                         \
+                writer.PutScalars(&vals[0], vals.size());                                \
+            }                                                                            \
+        }                                                                                \
+        static QStatus GetElements(const MsgArg& arg, std::vector<T>& vals)              \
+        {                                                                                \
+            if (arg.typeId != arrayTypeId) {                                             \
+                return ER_BUS_SIGNATURE_MISMATCH;                                        \
+            }                                                                            \
+            vals.assign(arg.v_scalarArray.FIELD, arg.v_scalarArray.FIELD + arg.v_scalarArray.numElements); \
+            return ER_OK;                                                                \
+        }                                                                                \
+    }
+
+AJN_MSGARG_SCALAR_CODEC(uint8_t,  ALLJOYN_BYTE,   v_byte,   Put8,  1);
+AJN_MSGARG_SCALAR_CODEC(int16_t,  ALLJOYN_INT16,  v_int16,  Put16, 2);
+AJN_MSGARG_SCALAR_CODEC(uint16_t, ALLJOYN_UINT16, v_uint16, Put16, 2);
+AJN_MSGARG_SCALAR_CODEC(int32_t,  ALLJOYN_INT32,  v_int32,  Put32, 4);
+AJN_MSGARG_SCALAR_CODEC(uint32_t, ALLJOYN_UINT32, v_uint32, Put32, 4);
+AJN_MSGARG_SCALAR_CODEC(int64_t,  ALLJOYN_INT64,  v_int64,  Put64, 8);
+AJN_MSGARG_SCALAR_CODEC(uint64_t, ALLJOYN_UINT64, v_uint64, Put64, 8);
+
+#undef AJN_MSGARG_SCALAR_CODEC
+
+/**
+ * Booleans are 32 bits on the wire so arrays of booleans are written one element at a time.
+ */
+template <>
+struct MsgArgCodec<bool> {
+    static const size_t alignment = 4;
+    static const AllJoynTypeId arrayTypeId = ALLJOYN_BOOLEAN_ARRAY;
+    static void Signature(qcc::String& sig) { sig.push_back((char)ALLJOYN_BOOLEAN); }
+    static void Marshal(MsgBodyWriter& writer, bool val) { writer.Put32(val ? 1 : 0); }
+    static QStatus Get(const MsgArg& arg, bool& val)
+    {
+        if (arg.typeId != ALLJOYN_BOOLEAN) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        val = arg.v_bool;
+        return ER_OK;
+    }
+    static void MarshalElements(MsgBodyWriter& writer, const std::vector<bool>& vals)
+    {
+        for (std::vector<bool>::const_iterator it = vals.begin(); it != vals.end(); ++it) {
+            writer.Put32(*it ? 1 : 0);
+        }
+    }
+    static QStatus GetElements(const MsgArg& arg, std::vector<bool>& vals)
+    {
+        if (arg.typeId != arrayTypeId) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        vals.assign(arg.v_scalarArray.v_bool, arg.v_scalarArray.v_bool + arg.v_scalarArray.numElements);
+        return ER_OK;
+    }
+};
+
+/**
+ * Doubles are written through their bit pattern.
+ */
+template <>
+struct MsgArgCodec<double> {
+    static const size_t alignment = 8;
+    static const AllJoynTypeId arrayTypeId = ALLJOYN_DOUBLE_ARRAY;
+    static void Signature(qcc::String& sig) { sig.push_back((char)ALLJOYN_DOUBLE); }
+    static void Marshal(MsgBodyWriter& writer, double val)
+    {
+        uint64_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        writer.Put64(bits);
+    }
+    static QStatus Get(const MsgArg& arg, double& val)
+    {
+        if (arg.typeId != ALLJOYN_DOUBLE) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        val = arg.v_double;
+        return ER_OK;
+    }
+    static void MarshalElements(MsgBodyWriter& writer, const std::vector<double>& vals)
+    {
+        if (!vals.empty()) {
+            writer.PutScalars((const uint64_t*)&vals[0], vals.size());
+        }
+    }
+    static QStatus GetElements(const MsgArg& arg, std::vector<double>& vals)
+    {
+        if (arg.typeId != arrayTypeId) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        vals.assign(arg.v_scalarArray.v_double, arg.v_scalarArray.v_double + arg.v_scalarArray.numElements);
+        return ER_OK;
+    }
+};
+
+/**
+ * Strings
+ */
+template <>
+struct MsgArgCodec<qcc::String> : public MsgArgArrayCodec<qcc::String> {
+    static const size_t alignment = 4;
+    static void Signature(qcc::String& sig) { sig.push_back((char)ALLJOYN_STRING); }
+    static void Marshal(MsgBodyWriter& writer, const qcc::String& val) { writer.PutString(val.c_str(), val.size()); }
+    static QStatus Get(const MsgArg& arg, qcc::String& val)
+    {
+        if (arg.typeId != ALLJOYN_STRING) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        val.assign(arg.v_string.str, arg.v_string.len);
+        return ER_OK;
+    }
+};
+
+/**
+ * Arrays
+ */
+template <typename T>
+struct MsgArgCodec<std::vector<T> > : public MsgArgArrayCodec<std::vector<T> > {
+    static const size_t alignment = 4;
+    static void Signature(qcc::String& sig)
+    {
+        sig.push_back((char)ALLJOYN_ARRAY);
+        MsgArgCodec<T>::Signature(sig);
+    }
+    static void Marshal(MsgBodyWriter& writer, const std::vector<T>& val)
+    {
+        size_t start;
+        size_t lenPos = writer.BeginArray(MsgArgCodec<T>::alignment, start);
+        MsgArgCodec<T>::MarshalElements(writer, val);
+        writer.EndArray(lenPos, start);
+    }
+    static QStatus Get(const MsgArg& arg, std::vector<T>& val) { return MsgArgCodec<T>::GetElements(arg, val); }
+};
+
+/**
+ * Dictionaries
+ */
+template <typename K, typename V>
+struct MsgArgCodec<std::map<K, V> > : public MsgArgArrayCodec<std::map<K, V> > {
+    static const size_t alignment = 4;
+    static void Signature(qcc::String& sig)
+    {
+        sig.push_back((char)ALLJOYN_ARRAY);
+        sig.push_back((char)ALLJOYN_DICT_ENTRY_OPEN);
+        MsgArgCodec<K>::Signature(sig);
+        MsgArgCodec<V>::Signature(sig);
+        sig.push_back((char)ALLJOYN_DICT_ENTRY_CLOSE);
+    }
+    static void Marshal(MsgBodyWriter& writer, const std::map<K, V>& val)
+    {
+        size_t start;
+        size_t lenPos = writer.BeginArray(8, start);
+        for (typename std::map<K, V>::const_iterator it = val.begin(); it != val.end(); ++it) {
+            writer.Align(8);
+            MsgArgCodec<K>::Marshal(writer, it->first);
+            MsgArgCodec<V>::Marshal(writer, it->second);
+        }
+        writer.EndArray(lenPos, start);
+    }
+    static QStatus Get(const MsgArg& arg, std::map<K, V>& val)
+    {
+        if (arg.typeId != ALLJOYN_ARRAY) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        const MsgArg* entries = arg.v_array.GetElements();
+        val.clear();
+        for (size_t i = 0; i < arg.v_array.GetNumElements(); ++i) {
+            if (entries[i].typeId != ALLJOYN_DICT_ENTRY) {
+                return ER_BUS_SIGNATURE_MISMATCH;
+            }
+            K key;
+            QStatus status = MsgArgCodec<K>::Get(*entries[i].v_dictEntry.key, key);
+            if (status == ER_OK) {
+                status = MsgArgCodec<V>::Get(*entries[i].v_dictEntry.val, val[key]);
+            }
+            if (status != ER_OK) {
+                return status;
+            }
+        }
+        return ER_OK;
+    }
+};
+
+/**
+ * Placeholder for the unused members of a MsgArgTuple and the unused arguments of a TypedMsgArgList.
+ */
+struct MsgArgNil { };
+
+/**
+ * A struct with up to four members. Unused members have type MsgArgNil and are not marshaled.
+ */
+template <typename A, typename B = MsgArgNil, typename C = MsgArgNil, typename D = MsgArgNil>
+struct MsgArgTuple {
+    A a;   /**< First member */
+    B b;   /**< Second member */
+    C c;   /**< Third member */
+    D d;   /**< Fourth member */
+
+    /** Constructor */
+    MsgArgTuple() : a(), b(), c(), d() { }
+
+    /** Constructor */
+    MsgArgTuple(const A& a, const B& b = B(), const C& c = C(), const D& d = D()) : a(a), b(b), c(c), d(d) { }
+};
+
+/**
+ * MsgArgNil marshals as nothing.
+ */
+template <>
+struct MsgArgCodec<MsgArgNil> {
+    static void Signature(qcc::String& sig) { }
+    static void Marshal(MsgBodyWriter& writer, const MsgArgNil& val) { }
+};
+
+/**
+ * Structs
+ */
+template <typename A, typename B, typename C, typename D>
+struct MsgArgCodec<MsgArgTuple<A, B, C, D> > : public MsgArgArrayCodec<MsgArgTuple<A, B, C, D> > {
+    static const size_t alignment = 8;
+    static void Signature(qcc::String& sig)
+    {
+        sig.push_back((char)ALLJOYN_STRUCT_OPEN);
+        MsgArgCodec<A>::Signature(sig);
+        MsgArgCodec<B>::Signature(sig);
+        MsgArgCodec<C>::Signature(sig);
+        MsgArgCodec<D>::Signature(sig);
+        sig.push_back((char)ALLJOYN_STRUCT_CLOSE);
+    }
+    static void Marshal(MsgBodyWriter& writer, const MsgArgTuple<A, B, C, D>& val)
+    {
+        writer.Align(8);
+        MsgArgCodec<A>::Marshal(writer, val.a);
+        MsgArgCodec<B>::Marshal(writer, val.b);
+        MsgArgCodec<C>::Marshal(writer, val.c);
+        MsgArgCodec<D>::Marshal(writer, val.d);
+    }
+    static QStatus Get(const MsgArg& arg, MsgArgTuple<A, B, C, D>& val)
+    {
+        if ((arg.typeId != ALLJOYN_STRUCT) || (arg.v_struct.numMembers != NumMembers())) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        const MsgArg* m = arg.v_struct.members;
+        QStatus status = GetMember(m, val.a);
+        if (status == ER_OK) {
+            status = GetMember(m, val.b);
+        }
+        if (status == ER_OK) {
+            status = GetMember(m, val.c);
+        }
+        if (status == ER_OK) {
+            status = GetMember(m, val.d);
+        }
+        return status;
+    }
+  private:
+    static size_t NumMembers() { return 1 + IsMember((B*)0) + IsMember((C*)0) + IsMember((D*)0); }
+    template <typename T> static size_t IsMember(T*) { return 1; }
+    static size_t IsMember(MsgArgNil*) { return 0; }
+    template <typename T> static QStatus GetMember(const MsgArg*& m, T& val) { return MsgArgCodec<T>::Get(*m++, val); }
+    static QStatus GetMember(const MsgArg*& m, MsgArgNil& val) { return ER_OK; }
+};
+
+/**
+ * Two member structs
+ */
+template <typename A, typename B>
+struct MsgArgCodec<std::pair<A, B> > : public MsgArgArrayCodec<std::pair<A, B> > {
+    static const size_t alignment = 8;
+    static void Signature(qcc::String& sig)
+    {
+        sig.push_back((char)ALLJOYN_STRUCT_OPEN);
+        MsgArgCodec<A>::Signature(sig);
+        MsgArgCodec<B>::Signature(sig);
+        sig.push_back((char)ALLJOYN_STRUCT_CLOSE);
+    }
+    static void Marshal(MsgBodyWriter& writer, const std::pair<A, B>& val)
+    {
+        writer.Align(8);
+        MsgArgCodec<A>::Marshal(writer, val.first);
+        MsgArgCodec<B>::Marshal(writer, val.second);
+    }
+    static QStatus Get(const MsgArg& arg, std::pair<A, B>& val)
+    {
+        if ((arg.typeId != ALLJOYN_STRUCT) || (arg.v_struct.numMembers != 2)) {
+            return ER_BUS_SIGNATURE_MISMATCH;
+        }
+        QStatus status = MsgArgCodec<A>::Get(arg.v_struct.members[0], val.first);
+        if (status == ER_OK) {
+            status = MsgArgCodec<B>::Get(arg.v_struct.members[1], val.second);
+        }
+        return status;
+    }
+};
+
+/**
+ * %TypedMsgArgs is a message body made from typed C++ values. Messages built from a
+ * %TypedMsgArgs are marshaled directly from the values without building MsgArgs. Use MakeArgs()
+ * to create one.
+ */
+class TypedMsgArgs {
+  public:
+    /** Destructor */
+    virtual ~TypedMsgArgs() { }
+
+    /**
+     * Get the signature of the message body.
+     */
+    virtual qcc::String GetSignature() const = 0;
+
+    /**
+     * Write the message body.
+     *
+     * @param writer  The writer to write the body with.
+     */
+    virtual void Marshal(MsgBodyWriter& writer) const = 0;
+};
+
+/**
+ * A message body with up to four arguments. The values are referenced not copied so the list
+ * must not outlive them. Unused arguments have type MsgArgNil.
+ */
+template <typename A, typename B = MsgArgNil, typename C = MsgArgNil, typename D = MsgArgNil>
+class TypedMsgArgList : public TypedMsgArgs {
+  public:
+    /** Constructor */
+    TypedMsgArgList(const A* a, const B* b, const C* c, const D* d) : a(a), b(b), c(c), d(d) { }
+
+    qcc::String GetSignature() const
+    {
+        qcc::String sig;
+        MsgArgCodec<A>::Signature(sig);
+        MsgArgCodec<B>::Signature(sig);
+        MsgArgCodec<C>::Signature(sig);
+        MsgArgCodec<D>::Signature(sig);
+        return sig;
+    }
+
+    void Marshal(MsgBodyWriter& writer) const
+    {
+        MsgArgCodec<A>::Marshal(writer, *a);
+        MsgArgCodec<B>::Marshal(writer, *b);
+        MsgArgCodec<C>::Marshal(writer, *c);
+        MsgArgCodec<D>::Marshal(writer, *d);
+    }
+
+  private:
+    const A* a;
+    const B* b;
+    const C* c;
+    const D* d;
+};
+
+/**
+ * Make a message body from typed values. The values must remain valid until the message has been
+ * sent. This is normally done by passing the result directly to BusObject::Signal() or
+ * ProxyBusObject::MethodCall():
+ *
+ * @code
+ *     std::vector<int32_t> readings;
+ *     ...
+ *     Signal(NULL, sessionId, *sensorSignal, MakeArgs(qcc::String("temp"), readings));
+ * @endcode
+ */
+template <typename A>
+TypedMsgArgList<A> MakeArgs(const A& a)
+{
+    static const MsgArgNil nil = MsgArgNil();
+    return TypedMsgArgList<A>(&a, &nil, &nil, &nil);
+}
+
+/** @copydoc MakeArgs(const A&) */
+template <typename A, typename B>
+TypedMsgArgList<A, B> MakeArgs(const A& a, const B& b)
+{
+    static const MsgArgNil nil = MsgArgNil();
+    return TypedMsgArgList<A, B>(&a, &b, &nil, &nil);
+}
+
+/** @copydoc MakeArgs(const A&) */
+template <typename A, typename B, typename C>
+TypedMsgArgList<A, B, C> MakeArgs(const A& a, const B& b, const C& c)
+{
+    static const MsgArgNil nil = MsgArgNil();
+    return TypedMsgArgList<A, B, C>(&a, &b, &c, &nil);
+}
+
+/** @copydoc MakeArgs(const A&) */
+template <typename A, typename B, typename C, typename D>
+TypedMsgArgList<A, B, C, D> MakeArgs(const A& a, const B& b, const C& c, const D& d)
+{
+    return TypedMsgArgList<A, B, C, D>(&a, &b, &c, &d);
+}
+
+/**
+ * Get a typed value from a MsgArg. This is the type checked equivalent of MsgArg::Get().
+ *
+ * @param arg  The MsgArg.
+ * @param val  [OUT] The value.
+ *
+ * @return
+ *      - #ER_OK if the value was read.
+ *      - #ER_BUS_SIGNATURE_MISMATCH if the MsgArg does not hold a value of the expected type.
+ */
+template <typename T>
+QStatus GetTypedArg(const MsgArg& arg, T& val)
+{
+    return MsgArgCodec<T>::Get(arg, val);
+}
+
+/**
+ * Get typed values from the arguments of a message. This is the type checked equivalent of
+ * _Message::GetArgs().
+ *
+ * @param msg  The message.
+ * @param a    [OUT] The first argument.
+ *
+ * @return
+ *      - #ER_OK if the values were read.
+ *      - #ER_BUS_SIGNATURE_MISMATCH if the message does not have arguments of the expected types.
+ */
+template <typename A>
+QStatus GetTypedArgs(Message& msg, A& a)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    if (numArgs != 1) {
+        return ER_BUS_SIGNATURE_MISMATCH;
+    }
+    return MsgArgCodec<A>::Get(args[0], a);
+}
+
+/** @copydoc GetTypedArgs(Message&, A&) */
+template <typename A, typename B>
+QStatus GetTypedArgs(Message& msg, A& a, B& b)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    if (numArgs != 2) {
+        return ER_BUS_SIGNATURE_MISMATCH;
+    }
+    QStatus status = MsgArgCodec<A>::Get(args[0], a);
+    if (status == ER_OK) {
+        status = MsgArgCodec<B>::Get(args[1], b);
+    }
+    return status;
+}
+
+/** @copydoc GetTypedArgs(Message&, A&) */
+template <typename A, typename B, typename C>
+QStatus GetTypedArgs(Message& msg, A& a, B& b, C& c)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    if (numArgs != 3) {
+        return ER_BUS_SIGNATURE_MISMATCH;
+    }
+    QStatus status = MsgArgCodec<A>::Get(args[0], a);
+    if (status == ER_OK) {
+        status = MsgArgCodec<B>::Get(args[1], b);
+    }
+    if (status == ER_OK) {
+        status = MsgArgCodec<C>::Get(args[2], c);
+    }
+    return status;
+}
+
+/** @copydoc GetTypedArgs(Message&, A&) */
+template <typename A, typename B, typename C, typename D>
+QStatus GetTypedArgs(Message& msg, A& a, B& b, C& c, D& d)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    if (numArgs != 4) {
+        return ER_BUS_SIGNATURE_MISMATCH;
+    }
+    QStatus status = MsgArgCodec<A>::Get(args[0], a);
+    if (status == ER_OK) {
+        status = MsgArgCodec<B>::Get(args[1], b);
+    }
+    if (status == ER_OK) {
+        status = MsgArgCodec<C>::Get(args[2], c);
+    }
+    if (status == ER_OK) {
+        status = MsgArgCodec<D>::Get(args[3], d);
+    }
+    return status;
+}
+
+}
+
+#endif
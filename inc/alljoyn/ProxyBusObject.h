@@ -28,6 +28,7 @@
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/MessageReceiver.h>
 #include <alljoyn/MsgArg.h>
+#include <alljoyn/MsgArgCodec.h>
 #include <alljoyn/Session.h>
 
 #include <Status.h>
@@ -50,6 +51,7 @@ class BusAttachment;
 class ProxyBusObject : public MessageReceiver {
     friend class XmlHelper;
     friend class AllJoynObj;
+    friend class IntrospectionCache;
 
   public:
 
@@ -58,6 +60,11 @@ class ProxyBusObject : public MessageReceiver {
      */
     static const uint32_t DefaultCallTimeout = 25000;
 
+    /**
+     * A batch of method calls and property reads sent together, see ProxyBusObject::Batch below.
+     */
+    class Batch;
+
     /**
      * Pure virtual base class implemented by classes that wish to receive
      * ProxyBusObject related messages.
@@ -165,6 +172,33 @@ class ProxyBusObject : public MessageReceiver {
      */
     QStatus IntrospectRemoteObjectAsync(ProxyBusObject::Listener* listener, ProxyBusObject::Listener::IntrospectCB callback, void* context);
 
+    /**
+     * Enable the process-wide introspection cache. When the cache is enabled IntrospectRemoteObject()
+     * and IntrospectRemoteObjectAsync() first ask the remote object for a hash of its introspection
+     * data and only fetch and parse the introspection XML if the hash is not in the cache. The cache
+     * is shared by all proxy objects and bus attachments in the process.
+     *
+     * Remote objects that don't support the hash query are introspected as normal.
+     *
+     * @param fileName  Optional file used to keep the cache between runs. Entries are loaded from
+     *                  the file and new entries are written to it.
+     *
+     * @return
+     *      - #ER_OK if the cache was enabled.
+     *      - #ER_BUS_READ_ERROR if the cache file is corrupt, the cache is enabled but the file will
+     *        be overwritten.
+     */
+    static QStatus EnableIntrospectionCache(const char* fileName = NULL);
+
+    /**
+     * Get the number of introspections that were served from the introspection cache and the number
+     * that had to fetch the introspection XML from the remote object.
+     *
+     * @param[out] hits    Number of introspections served from the cache.
+     * @param[out] misses  Number of introspections that fetched the XML.
+     */
+    static void GetIntrospectionCacheCounters(uint32_t& hits, uint32_t& misses);
+
     /**
      * Get a property from an interface on the remote object.
      *
@@ -261,6 +295,37 @@ class ProxyBusObject : public MessageReceiver {
      */
     QStatus SetProperty(const char* iface, const char* property, const qcc::String& s) const { MsgArg arg("s", s.c_str()); return SetProperty(iface, property, arg); }
 
+    /**
+     * Enable caching of the property values of an interface. Once enabled GetProperty() and
+     * GetAllProperties() return values from the cache when they can. The cache is filled by the values
+     * read from the remote object and kept up to date by the PropertiesChanged signals the remote
+     * object emits, so caching should only be enabled for interfaces where the remote object emits
+     * PropertiesChanged whenever a property changes (see BusObject::EmitPropChanged()).
+     *
+     * Cached values are shared by all proxy objects on the same bus attachment that refer to the same
+     * bus name and object path.
+     *
+     * This call makes a blocking call to the daemon so cannot be called within AllJoyn callbacks.
+     *
+     * @param iface  Name of the interface to cache properties for.
+     *
+     * @return
+     *      - #ER_OK if caching was enabled.
+     *      - #ER_BUS_OBJECT_NO_SUCH_INTERFACE if the interface is not known.
+     *      - An error status otherwise
+     */
+    QStatus EnablePropertyCaching(const char* iface);
+
+    /**
+     * Get the number of property reads that were served from the cache and the number that had to go
+     * to the remote object. The counts are for all proxy objects that share the cache for this remote
+     * object.
+     *
+     * @param[out] hits    Number of reads served from the cache.
+     * @param[out] misses  Number of reads of cached interfaces that went to the remote object.
+     */
+    void GetPropertyCacheCounters(uint32_t& hits, uint32_t& misses) const;
+
     /**
      * Returns the interfaces implemented by this object. Note that all proxy bus objects
      * automatically inherit the "org.freedesktop.DBus.Peer" which provides the built-in "ping"
@@ -407,6 +472,28 @@ class ProxyBusObject : public MessageReceiver {
                        uint32_t timeout = DefaultCallTimeout,
                        uint8_t flags = 0) const;
 
+    /**
+     * Make a synchronous method call with typed arguments from this object. The arguments are
+     * marshaled directly from the values without building MsgArgs. Use MakeArgs() to create the
+     * arguments and GetTypedArgs() to read the reply.
+     *
+     * @param method       Method being invoked.
+     * @param args         The typed arguments for the method call
+     * @param replyMsg     The reply message received for the method call
+     * @param timeout      Timeout specified in milliseconds to wait for a reply
+     * @param flags        Logical OR of the message flags for this method call, see MethodCall() above.
+     *
+     * @return
+     *      - #ER_OK if the method call succeeded and the reply message type is #MESSAGE_METHOD_RET
+     *      - #ER_BUS_REPLY_IS_ERROR_MESSAGE if the reply message type is #MESSAGE_ERROR
+     *      - #ER_BUS_UNEXPECTED_SIGNATURE if the types of the arguments do not match the method's signature
+     */
+    QStatus MethodCall(const InterfaceDescription::Member& method,
+                       const TypedMsgArgs& args,
+                       Message& replyMsg,
+                       uint32_t timeout = DefaultCallTimeout,
+                       uint8_t flags = 0) const;
+
     /**
      * Make a synchronous method call from this object
      *
@@ -643,12 +730,36 @@ class ProxyBusObject : public MessageReceiver {
      */
     void SyncReplyHandler(Message& msg, void* context);
 
+    /**
+     * @internal
+     * Make a synchronous method call with either MsgArg or typed arguments.
+     */
+    QStatus SyncMethodCall(const InterfaceDescription::Member& method,
+                           const MsgArg* args,
+                           size_t numArgs,
+                           const TypedMsgArgs* typedArgs,
+                           Message& replyMsg,
+                           uint32_t timeout,
+                           uint8_t flags) const;
+
     /**
      * @internal
      * Introspection method_reply handler. (Internal use only)
      */
     void IntrospectMethodCB(Message& message, void* context);
 
+    /**
+     * @internal
+     * Introspection hash method_reply handler. (Internal use only)
+     */
+    void IntrospectHashCB(Message& message, void* context);
+
+    /**
+     * @internal
+     * Make an asynchronous Introspect method call.
+     */
+    QStatus IntrospectAsync(void* context);
+
     /**
      * @internal
      * Set the B2B endpoint to use for all communication with remote object.
@@ -656,6 +767,12 @@ class ProxyBusObject : public MessageReceiver {
      */
     void SetB2BEndpoint(RemoteEndpoint* b2bEp);
 
+    /**
+     * @internal
+     * Check if property caching is enabled for an interface.
+     */
+    bool IsPropertyCached(const char* iface) const;
+
     /**
      * @internal
      * Helper used to destruct and clean-up  ProxyBusObject::components member.
@@ -709,6 +826,187 @@ class ProxyBusObject : public MessageReceiver {
     bool isExiting;             /**< true iff ProxyBusObject is in the process of begin destroyed */
 };
 
+/**
+ * A %Batch collects a number of method calls and property reads on a remote object and sends them
+ * back to back without waiting for each reply. The caller can then wait for all of the replies to
+ * arrive, so a batch of N calls costs about one round trip instead of N.
+ *
+ * Property reads are coalesced into a single org.alljoyn.Bus.Properties.GetMulti call when the
+ * remote object implements that interface, otherwise each is sent as a separate
+ * org.freedesktop.DBus.Properties.Get call.
+ *
+ * The %ProxyBusObject the batch was created from must not be destroyed before the batch.
+ */
+class ProxyBusObject::Batch : public MessageReceiver {
+  public:
+
+    /**
+     * Value for Wait() to wait until all replies have arrived or timed out.
+     */
+    static const uint32_t WaitForever = static_cast<uint32_t>(-1);
+
+    /**
+     * Create an empty batch for a remote object.
+     *
+     * @param proxy  The remote object the calls will be made on.
+     */
+    Batch(const ProxyBusObject& proxy);
+
+    /**
+     * Destructor. Replies that are still outstanding are discarded.
+     */
+    ~Batch();
+
+    /**
+     * Add a method call to the batch.
+     *
+     * @param method    Method to call.
+     * @param index     Returns the index of the call in the batch.
+     * @param args      The arguments for the method call (can be NULL)
+     * @param numArgs   The number of arguments
+     * @param flags     Logical OR of the message flags for this method call, see ProxyBusObject::MethodCall().
+     *
+     * @return
+     *      - #ER_OK if the call was added.
+     *      - #ER_BUS_BATCH_ALREADY_SENT if the batch was already sent.
+     */
+    QStatus AddMethodCall(const InterfaceDescription::Member& method,
+                          size_t& index,
+                          const MsgArg* args = NULL,
+                          size_t numArgs = 0,
+                          uint8_t flags = 0);
+
+    /**
+     * Add a method call to the batch.
+     *
+     * @param ifaceName   Name of interface for method.
+     * @param methodName  Name of method.
+     * @param index       Returns the index of the call in the batch.
+     * @param args        The arguments for the method call (can be NULL)
+     * @param numArgs     The number of arguments
+     * @param flags       Logical OR of the message flags for this method call, see ProxyBusObject::MethodCall().
+     *
+     * @return
+     *      - #ER_OK if the call was added.
+     *      - #ER_BUS_NO_SUCH_INTERFACE if the remote object doesn't implement the interface.
+     *      - #ER_BUS_INTERFACE_NO_SUCH_MEMBER if the method doesn't exist.
+     *      - #ER_BUS_BATCH_ALREADY_SENT if the batch was already sent.
+     */
+    QStatus AddMethodCall(const char* ifaceName,
+                          const char* methodName,
+                          size_t& index,
+                          const MsgArg* args = NULL,
+                          size_t numArgs = 0,
+                          uint8_t flags = 0);
+
+    /**
+     * Add a property read to the batch.
+     *
+     * @param iface     Name of interface to retrieve property from.
+     * @param property  The name of the property to get.
+     * @param index     Returns the index of the property read in the batch.
+     *
+     * @return
+     *      - #ER_OK if the property read was added.
+     *      - #ER_BUS_OBJECT_NO_SUCH_INTERFACE if the interface is not known.
+     *      - #ER_BUS_BATCH_ALREADY_SENT if the batch was already sent.
+     */
+    QStatus AddGetProperty(const char* iface, const char* property, size_t& index);
+
+    /**
+     * Get the number of calls in the batch.
+     *
+     * @return  The number of method calls and property reads added.
+     */
+    size_t Size() const;
+
+    /**
+     * Send all the calls in the batch. This does not wait for the replies. A batch can only be sent once.
+     *
+     * @param timeout  Timeout specified in milliseconds to wait for each reply.
+     *
+     * @return
+     *      - #ER_OK if the calls were sent, calls that could not be sent complete with an error.
+     *      - #ER_BUS_BATCH_ALREADY_SENT if the batch was already sent.
+     */
+    QStatus Send(uint32_t timeout = DefaultCallTimeout);
+
+    /**
+     * Wait for all the replies to a batch that has been sent. Must not be called from within a
+     * message or reply handler.
+     *
+     * @param maxWaitMs  Maximum time to wait in milliseconds.
+     *
+     * @return
+     *      - #ER_OK if all the replies have arrived.
+     *      - #ER_TIMEOUT if there are still replies outstanding.
+     *      - #ER_BUS_BATCH_NOT_SENT if the batch has not been sent.
+     */
+    QStatus Wait(uint32_t maxWaitMs = WaitForever);
+
+    /**
+     * Check if all the replies have arrived.
+     *
+     * @return  true if the batch was sent and all replies have arrived.
+     */
+    bool IsComplete() const;
+
+    /**
+     * Get the reply to a method call in the batch.
+     *
+     * @param index  The index returned when the call was added.
+     * @param reply  Returns the reply message.
+     *
+     * @return
+     *      - #ER_OK if the reply was a method return.
+     *      - #ER_BUS_REPLY_IS_ERROR_MESSAGE if the reply is an error message.
+     *      - #ER_BUS_BATCH_NOT_SENT if the reply has not arrived.
+     *      - #ER_BAD_ARG_1 if the index is not a method call.
+     *      - Other error status codes if the call could not be sent.
+     */
+    QStatus GetReply(size_t index, Message& reply) const;
+
+    /**
+     * Get the value of a property read in the batch.
+     *
+     * @param index  The index returned when the property read was added.
+     * @param value  Returns the property value as a variant.
+     *
+     * @return
+     *      - #ER_OK if the property was read.
+     *      - #ER_BUS_BATCH_NOT_SENT if the reply has not arrived.
+     *      - #ER_BAD_ARG_1 if the index is not a property read.
+     *      - An error status otherwise
+     */
+    QStatus GetProperty(size_t index, MsgArg& value) const;
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    Batch(const Batch& other);
+    Batch& operator=(const Batch& other);
+
+    /**
+     * @internal
+     * Handles the replies to the calls sent for this batch.
+     *
+     * @param msg      The reply message.
+     * @param context  Index of the call that was sent.
+     */
+    void ReplyHandler(Message& msg, void* context);
+
+    /**
+     * @internal
+     * Record the result of a call that was sent.
+     */
+    void CompleteCall(size_t call, Message* msg, QStatus status);
+
+    const ProxyBusObject& proxy;   /**< The remote object */
+
+    struct Calls;
+    Calls* calls;                  /**< Calls in the batch and their replies */
+};
+
 }
 
 #endif
@@ -44,6 +44,7 @@
 #include "SASLEngine.h"
 #include "AllJoynCrypto.h"
 #include "BusInternal.h"
+#include "EndpointStats.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -1005,6 +1006,11 @@ void AllJoynPeerObj::HandleSecurityViolation(Message& msg, QStatus status)
 
     QCC_DbgTrace(("HandleSecurityViolation %s %s", QCC_StatusText(status), msg->Description().c_str()));
 
+    /*
+     * Count the violation against the endpoint the message came in on
+     */
+    EndpointStats::SecurityViolation(msg->rcvEndpointName, status);
+
     if (status == ER_BUS_MESSAGE_DECRYPTION_FAILED) {
         PeerState peerState = peerStateTable->GetPeerState(msg->GetSender());
         /*
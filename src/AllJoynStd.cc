@@ -39,6 +39,7 @@ const char* org::alljoyn::Bus::ObjectPath = "/org/alljoyn/Bus";
 const char* org::alljoyn::Bus::InterfaceName = "org.alljoyn.Bus";
 const char* org::alljoyn::Bus::WellKnownName = "org.alljoyn.Bus";
 const char* org::alljoyn::Bus::Secure = "org.alljoyn.Bus.Secure";
+const char* org::alljoyn::Bus::AnnotateLastValue = "org.alljoyn.Bus.Signal.LastValue";
 const char* org::alljoyn::Bus::Peer::ObjectPath = "/org/alljoyn/Bus/Peer";
 
 /** org.alljoyn.Daemon interface definitions */
@@ -56,6 +57,12 @@ const char* org::alljoyn::Bus::Peer::HeaderCompression::InterfaceName = "org.all
 const char* org::alljoyn::Bus::Peer::Authentication::InterfaceName = "org.alljoyn.Bus.Peer.Authentication";
 const char* org::alljoyn::Bus::Peer::Session::InterfaceName = "org.alljoyn.Bus.Peer.Session";
 
+/** org.alljoyn.Bus.Properties interface definitions */
+const char* org::alljoyn::Bus::Properties::InterfaceName = "org.alljoyn.Bus.Properties";
+
+/** org.alljoyn.Bus.Introspectable interface definitions */
+const char* org::alljoyn::Bus::Introspectable::InterfaceName = "org.alljoyn.Bus.Introspectable";
+
 
 QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
 {
@@ -158,6 +165,28 @@ QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
         ifc->AddMethod("AcceptSession", "qus"SESSIONOPTS_SIG, "b", "port,id,src,opts,accepted");
         ifc->Activate();
     }
+    {
+        /* Create the org.alljoyn.Bus.Properties interface */
+        InterfaceDescription* ifc = NULL;
+        status = bus.CreateInterface(org::alljoyn::Bus::Properties::InterfaceName, ifc);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to create %s interface", org::alljoyn::Bus::Properties::InterfaceName));
+            return status;
+        }
+        ifc->AddMethod("GetMulti", "a(ss)", "a(uv)", "props,values");
+        ifc->Activate();
+    }
+    {
+        /* Create the org.alljoyn.Bus.Introspectable interface */
+        InterfaceDescription* ifc = NULL;
+        status = bus.CreateInterface(org::alljoyn::Bus::Introspectable::InterfaceName, ifc);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to create %s interface", org::alljoyn::Bus::Introspectable::InterfaceName));
+            return status;
+        }
+        ifc->AddMethod("GetIntrospectionHash", NULL, "s", "hash");
+        ifc->Activate();
+    }
     return status;
 }
 
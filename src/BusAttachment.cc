@@ -25,8 +25,6 @@
 #include <qcc/String.h>
 #include <qcc/Timer.h>
 #include <qcc/atomic.h>
-#include <qcc/XmlElement.h>
-#include <qcc/StringSource.h>
 #include <qcc/FileStream.h>
 
 #include <assert.h>
@@ -86,7 +84,8 @@ BusAttachment::Internal::Internal(const char* appName,
     allowRemoteMessages(allowRemoteMessages),
     listenAddresses(listenAddresses ? listenAddresses : ""),
     stopLock(),
-    stopCount(0)
+    stopCount(0),
+    propertyCache(bus)
 {
     /*
      * Bus needs a pointer to this internal object.
@@ -370,6 +369,14 @@ QStatus BusAttachment::Connect(const char* connectSpec, BusEndpoint** newep)
                     trans->Disconnect(connectSpec);
                 }
             }
+
+            /* The property cache's match rule went with the previous connection */
+            if (ER_OK == status) {
+                QStatus cacheStatus = busInternal->GetPropertyCache().Connected();
+                if (ER_OK != cacheStatus) {
+                    QCC_LogError(cacheStatus, ("Property cache disabled, properties will be read from the remote objects"));
+                }
+            }
         }
     }
     if (ER_OK != status) {
@@ -520,7 +527,8 @@ void BusAttachment::WaitStopInternal()
             /* Clear peer state */
             busInternal->peerStateTable.Clear();
 
-            /* Persist keystore */
+            /* Persist keystore including any deferred changes */
+            busInternal->keyStore.SetStoreTimer(NULL);
             busInternal->keyStore.Store();
 
             isStarted = false;
@@ -673,6 +681,8 @@ QStatus BusAttachment::EnablePeerSecurity(const char* authMechanisms,
     if (authMechanisms) {
         status = busInternal->keyStore.Init(keyStoreFileName, isShared);
         if (status == ER_OK) {
+            /* Coalesce key store writes from bursts of authentications */
+            busInternal->keyStore.SetStoreTimer(&busInternal->timer);
             /* Register peer-to-peer authentication mechanisms */
             busInternal->authManager.RegisterMechanism(AuthMechSRP::Factory, AuthMechSRP::AuthName());
             busInternal->authManager.RegisterMechanism(AuthMechRSA::Factory, AuthMechRSA::AuthName());
@@ -1512,6 +1522,7 @@ void BusAttachment::Internal::RemoveDispatchListener(AlarmListener& listener)
 
 void BusAttachment::Internal::LocalEndpointDisconnected()
 {
+    propertyCache.Disconnected();
     listenersLock.Lock(MUTEX_CONTEXT);
     ListenerList::iterator it = listeners.begin();
     while (it != listeners.end()) {
@@ -1562,6 +1573,9 @@ void BusAttachment::Internal::AlarmTriggered(const Alarm& alarm, QStatus reason)
                 }
                 sessionListenersLock.Unlock(MUTEX_CONTEXT);
             } else if (0 == strcmp("NameOwnerChanged", msg->GetMemberName())) {
+                propertyCache.NameOwnerChanged(args[0].v_string.str,
+                                               (0 < args[1].v_string.len) ? args[1].v_string.str : NULL,
+                                               (0 < args[2].v_string.len) ? args[2].v_string.str : NULL);
                 listenersLock.Lock(MUTEX_CONTEXT);
                 ListenerList::iterator it = listeners.begin();
                 while (it != listeners.end()) {
@@ -1605,16 +1619,8 @@ QStatus BusAttachment::SetSessionListener(SessionId id, SessionListener* listene
 
 QStatus BusAttachment::CreateInterfacesFromXml(const char* xml)
 {
-    StringSource source(xml);
-
-    /* Parse the XML to update this ProxyBusObject instance (plus any new children and interfaces) */
-    XmlParseContext pc(source);
-    QStatus status = XmlElement::Parse(pc);
-    if (status == ER_OK) {
-        XmlHelper xmlHelper(this, "BusAttachment");
-        status = xmlHelper.AddInterfaceDefinitions(pc.GetRoot());
-    }
-    return status;
+    XmlHelper xmlHelper(this, "BusAttachment");
+    return xmlHelper.AddInterfaceDefinitions(xml);
 }
 
 bool BusAttachment::Internal::CallAcceptListeners(SessionPort sessionPort, const char* joiner, const SessionOpts& opts)
@@ -38,6 +38,7 @@
 #include "ClientRouter.h"
 #include "KeyStore.h"
 #include "PeerState.h"
+#include "PropertyCache.h"
 #include "Transport.h"
 #include "TransportList.h"
 #include "CompressionRules.h"
@@ -132,6 +133,13 @@ class BusAttachment::Internal : public MessageReceiver, public qcc::AlarmListene
      */
     void OverrideCompressionRules(CompressionRules& newRules) { compressionRules = newRules; }
 
+    /**
+     * Get the property cache shared by the proxy objects on this bus.
+     *
+     * @return The property cache.
+     */
+    PropertyCache& GetPropertyCache() { return propertyCache; }
+
     /**
      * Get the shared timer.
      */
@@ -309,6 +317,8 @@ class BusAttachment::Internal : public MessageReceiver, public qcc::AlarmListene
 
 
     qcc::Mutex sessionListenersLock;                                   /* Lock protecting sessionListners maps */
+
+    PropertyCache propertyCache;          /* Property values cached by proxy objects */
 };
 
 }
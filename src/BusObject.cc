@@ -23,13 +23,16 @@
 #include <qcc/platform.h>
 
 #include <assert.h>
+#include <string.h>
 
 #include <map>
 #include <vector>
 
+#include <qcc/Crypto.h>
 #include <qcc/Debug.h>
 #include <qcc/Util.h>
 #include <qcc/String.h>
+#include <qcc/StringUtil.h>
 #include <qcc/Mutex.h>
 #include <alljoyn/DBusStd.h>
 #include <alljoyn/AllJoynStd.h>
@@ -71,6 +74,9 @@ struct BusObject::Components {
 
     /** counter to prevent this BusObject being deleted if it is being used by another thread. */
     int32_t inUseCounter;
+
+    /** true if PropertiesChanged is emitted after a successful Properties.Set */
+    bool emitPropChangedOnSet;
 };
 
 /*
@@ -115,18 +121,30 @@ qcc::String BusObject::GetName()
 
 qcc::String BusObject::GenerateIntrospection(bool deep, size_t indent) const
 {
-    qcc::String in(indent, ' ');
+    const qcc::String in(indent, ' ');
     qcc::String xml;
+    xml.reserve(components->children.size() * (indent + 32));
 
     /* Iterate over child nodes */
     vector<BusObject*>::const_iterator iter = components->children.begin();
     while (iter != components->children.end()) {
         BusObject* child = *iter++;
-        xml += in + "<node name=\"" + child->GetName() + "\"";
+        /* Same as child->GetName() without copying the path */
+        const char* childName = child->path.c_str();
+        const char* slash = strrchr(childName, '/');
+        if (slash && (slash[1] || (slash != childName))) {
+            childName = slash + 1;
+        }
+        xml += in;
+        xml += "<node name=\"";
+        xml += childName;
         if (deep) {
-            xml += "\n" + child->GenerateIntrospection(deep, indent + 2) + in + "</node>\n";
+            xml += "\">\n";
+            xml += child->GenerateIntrospection(deep, indent + 2);
+            xml += in;
+            xml += "</node>\n";
         } else {
-            xml += "/>\n";
+            xml += "\"/>\n";
         }
     }
     if (deep || !isPlaceholder) {
@@ -139,29 +157,26 @@ qcc::String BusObject::GenerateIntrospection(bool deep, size_t indent) const
     return xml;
 }
 
-void BusObject::GetProp(const InterfaceDescription::Member* member, Message& msg)
+QStatus BusObject::GetPropValue(const char* ifaceName, const char* propName, bool isEncrypted, MsgArg& val)
 {
     QStatus status;
-    const MsgArg* iface = msg->GetArg(0);
-    const MsgArg* property = msg->GetArg(1);
-    MsgArg val = MsgArg();
 
     /* Check property exists on this interface and is readable */
-    const InterfaceDescription* ifc = LookupInterface(components->ifaces, iface->v_string.str);
+    const InterfaceDescription* ifc = LookupInterface(components->ifaces, ifaceName);
     if (ifc) {
         /*
          * If the interface is secure the message must be encrypted
          */
-        if (ifc->IsSecure() && !msg->IsEncrypted()) {
+        if (ifc->IsSecure() && !isEncrypted) {
             status = ER_BUS_MESSAGE_NOT_ENCRYPTED;
             QCC_LogError(status, ("Attempt to get a property from a secure interface"));
         } else {
-            const InterfaceDescription::Property* prop = ifc->GetProperty(property->v_string.str);
+            const InterfaceDescription::Property* prop = ifc->GetProperty(propName);
             if (prop) {
                 if (prop->access & PROP_ACCESS_READ) {
-                    status = Get(iface->v_string.str, property->v_string.str, val);
+                    status = Get(ifaceName, propName, val);
                 } else {
-                    QCC_DbgPrintf(("No read access on property %s", property->v_string.str));
+                    QCC_DbgPrintf(("No read access on property %s", propName));
                     status = ER_BUS_PROPERTY_ACCESS_DENIED;
                 }
             } else {
@@ -171,6 +186,16 @@ void BusObject::GetProp(const InterfaceDescription::Member* member, Message& msg
     } else {
         status = ER_BUS_UNKNOWN_INTERFACE;
     }
+    return status;
+}
+
+void BusObject::GetProp(const InterfaceDescription::Member* member, Message& msg)
+{
+    const MsgArg* iface = msg->GetArg(0);
+    const MsgArg* property = msg->GetArg(1);
+    MsgArg val = MsgArg();
+
+    QStatus status = GetPropValue(iface->v_string.str, property->v_string.str, msg->IsEncrypted(), val);
     QCC_DbgPrintf(("Properties.Get %s", QCC_StatusText(status)));
     if (status == ER_OK) {
         /* Properties are returned as variants */
@@ -221,6 +246,42 @@ void BusObject::SetProp(const InterfaceDescription::Member* member, Message& msg
     }
     QCC_DbgPrintf(("Properties.Set %s", QCC_StatusText(status)));
     MethodReply(msg, status);
+    if ((status == ER_OK) && components->emitPropChangedOnSet) {
+        status = EmitPropChanged(iface->v_string.str, property->v_string.str, *(val->v_variant.val), msg->GetSessionId());
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to emit PropertiesChanged for %s", property->v_string.str));
+        }
+    }
+}
+
+QStatus BusObject::EmitPropChanged(const char* ifcName, const char* propName, const MsgArg& val, SessionId sessionId)
+{
+    const InterfaceDescription* ifc = LookupInterface(components->ifaces, ifcName);
+    if (!ifc) {
+        return ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    }
+    if (!ifc->GetProperty(propName)) {
+        return ER_BUS_NO_SUCH_PROPERTY;
+    }
+    const InterfaceDescription* propIntf = bus.GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+    assert(propIntf);
+
+    MsgArg changed;
+    changed.Set("{sv}", propName, &val);
+    MsgArg args[3];
+    args[0].Set("s", ifcName);
+    args[1].Set("a{sv}", 1, &changed);
+    args[2].Set("as", 0, NULL);
+    /*
+     * Values of properties on a secure interface must not be sent in the clear
+     */
+    uint8_t flags = ifc->IsSecure() ? ALLJOYN_FLAG_ENCRYPTED : 0;
+    return Signal(NULL, sessionId, *(propIntf->GetMember("PropertiesChanged")), args, ArraySize(args), 0, flags);
+}
+
+void BusObject::SetEmitPropChangedOnSet(bool emit)
+{
+    components->emitPropChangedOnSet = emit;
 }
 
 void BusObject::GetAllProps(const InterfaceDescription::Member* member, Message& msg)
@@ -283,10 +344,56 @@ void BusObject::GetAllProps(const InterfaceDescription::Member* member, Message&
     delete [] props;
 }
 
+void BusObject::GetMultiProps(const InterfaceDescription::Member* member, Message& msg)
+{
+    const MsgArg* props = msg->GetArg(0);
+    size_t numProps = props->v_array.GetNumElements();
+    const MsgArg* elems = props->v_array.GetElements();
+    MsgArg* entries = new MsgArg[numProps];
+
+    /*
+     * Each property gets its own status so one bad property doesn't fail the whole request. Failed
+     * entries carry a dummy value because a variant cannot be empty.
+     */
+    for (size_t i = 0; i < numProps; ++i) {
+        const char* ifaceName = elems[i].v_struct.members[0].v_string.str;
+        const char* propName = elems[i].v_struct.members[1].v_string.str;
+        MsgArg* val = new MsgArg();
+        QStatus status = GetPropValue(ifaceName, propName, msg->IsEncrypted(), *val);
+        if (status != ER_OK) {
+            QCC_DbgPrintf(("Properties.GetMulti %s.%s %s", ifaceName, propName, QCC_StatusText(status)));
+            val->Set("u", 0);
+        }
+        entries[i].Set("(uv)", (uint32_t)status, val);
+    }
+    MsgArg vals;
+    vals.Set("a(uv)", numProps, entries);
+    /*
+     * Set ownership of the MsgArgs so they will be automatically freed.
+     */
+    vals.SetOwnershipFlags(MsgArg::OwnsArgs, true /*deep*/);
+    QCC_DbgPrintf(("Properties.GetMulti %u properties", (uint32_t)numProps));
+    MethodReply(msg, &vals, 1);
+}
+
+/*
+ * Wrap the introspection for an object in the document returned by Introspect()
+ */
+static qcc::String IntrospectionDocument(const qcc::String& body)
+{
+    const char* docType = org::freedesktop::DBus::Introspectable::IntrospectDocType;
+    qcc::String xml;
+    xml.reserve(strlen(docType) + body.size() + 16);
+    xml += docType;
+    xml += "<node>\n";
+    xml += body;
+    xml += "</node>\n";
+    return xml;
+}
+
 void BusObject::Introspect(const InterfaceDescription::Member* member, Message& msg)
 {
-    qcc::String xml = org::freedesktop::DBus::Introspectable::IntrospectDocType;
-    xml += "<node>\n" + GenerateIntrospection(false, 2) + "</node>\n";
+    qcc::String xml = IntrospectionDocument(GenerateIntrospection(false, 2));
     MsgArg arg("s", xml.c_str());
     QStatus status = MethodReply(msg, &arg, 1);
     if (status != ER_OK) {
@@ -294,6 +401,23 @@ void BusObject::Introspect(const InterfaceDescription::Member* member, Message&
     }
 }
 
+void BusObject::GetIntrospectionHash(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Hash exactly the same XML that Introspect() returns */
+    qcc::String xml = IntrospectionDocument(GenerateIntrospection(false, 2));
+    uint8_t digest[Crypto_SHA1::DIGEST_SIZE];
+    Crypto_SHA1 sha1;
+    sha1.Init();
+    sha1.Update((const uint8_t*)xml.data(), xml.size());
+    sha1.GetDigest(digest);
+    qcc::String hash = BytesToHexString(digest, Crypto_SHA1::DIGEST_SIZE, true /*toLower*/);
+    MsgArg arg("s", hash.c_str());
+    QStatus status = MethodReply(msg, &arg, 1);
+    if (status != ER_OK) {
+        QCC_DbgPrintf(("GetIntrospectionHash %s", QCC_StatusText(status)));
+    }
+}
+
 QStatus BusObject::AddMethodHandler(const InterfaceDescription::Member* member, MessageReceiver::MethodHandler handler, void* handlerContext)
 {
     if (!member) {
@@ -362,6 +486,11 @@ QStatus BusObject::AddInterface(const InterfaceDescription& iface)
         QCC_LogError(status, ("%s is automatically added if needed and cannot be added manually", iface.GetName()));
         goto ExitAddInterface;
     }
+    if (strcmp(iface.GetName(), org::alljoyn::Bus::Properties::InterfaceName) == 0) {
+        status = ER_BUS_IFACE_ALREADY_EXISTS;
+        QCC_LogError(status, ("%s is automatically added if needed and cannot be added manually", iface.GetName()));
+        goto ExitAddInterface;
+    }
     /* Check interface has not already been added */
     if (ImplementsInterface(iface.GetName())) {
         status = ER_BUS_IFACE_ALREADY_EXISTS;
@@ -390,6 +519,16 @@ QStatus BusObject::AddInterface(const InterfaceDescription& iface)
             QCC_LogError(status, ("Failed to add property getter/setter message receivers for %s", GetPath()));
             goto ExitAddInterface;
         }
+
+        /* Also add org::alljoyn::Bus::Properties so proxies can read several properties in one round trip */
+        const InterfaceDescription* multiIntf = bus.GetInterface(org::alljoyn::Bus::Properties::InterfaceName);
+        assert(multiIntf);
+        components->ifaces.push_back(multiIntf);
+        status = AddMethodHandler(multiIntf->GetMember("GetMulti"), static_cast<MessageReceiver::MethodHandler>(&BusObject::GetMultiProps));
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to add multiple property getter message receiver for %s", GetPath()));
+            goto ExitAddInterface;
+        }
     }
 
 ExitAddInterface:
@@ -403,10 +542,14 @@ QStatus BusObject::DoRegistration()
     const InterfaceDescription* introspectable = bus.GetInterface(org::freedesktop::DBus::Introspectable::InterfaceName);
     assert(introspectable);
     components->ifaces.push_back(introspectable);
+    const InterfaceDescription* ajIntrospectable = bus.GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+    assert(ajIntrospectable);
+    components->ifaces.push_back(ajIntrospectable);
 
     /* Add the standard method handlers */
     const MethodEntry methodEntries[] = {
-        { introspectable->GetMember("Introspect"),    static_cast<MessageReceiver::MethodHandler>(&BusObject::Introspect) }
+        { introspectable->GetMember("Introspect"),    static_cast<MessageReceiver::MethodHandler>(&BusObject::Introspect) },
+        { ajIntrospectable->GetMember("GetIntrospectionHash"), static_cast<MessageReceiver::MethodHandler>(&BusObject::GetIntrospectionHash) }
     };
 
     QStatus status = AddMethodHandlers(methodEntries, ArraySize(methodEntries));
@@ -421,6 +564,28 @@ QStatus BusObject::Signal(const char* destination,
                           size_t numArgs,
                           uint16_t timeToLive,
                           uint8_t flags)
+{
+    return SendSignal(destination, sessionId, signalMember, args, numArgs, NULL, timeToLive, flags);
+}
+
+QStatus BusObject::Signal(const char* destination,
+                          SessionId sessionId,
+                          const InterfaceDescription::Member& signalMember,
+                          const TypedMsgArgs& args,
+                          uint16_t timeToLive,
+                          uint8_t flags)
+{
+    return SendSignal(destination, sessionId, signalMember, NULL, 0, &args, timeToLive, flags);
+}
+
+QStatus BusObject::SendSignal(const char* destination,
+                              SessionId sessionId,
+                              const InterfaceDescription::Member& signalMember,
+                              const MsgArg* args,
+                              size_t numArgs,
+                              const TypedMsgArgs* typedArgs,
+                              uint16_t timeToLive,
+                              uint8_t flags)
 {
     QStatus status;
     Message msg(bus);
@@ -434,6 +599,12 @@ QStatus BusObject::Signal(const char* destination,
     if ((flags & ALLJOYN_FLAG_ENCRYPTED) && !bus.IsPeerSecurityEnabled()) {
         return ER_BUS_SECURITY_NOT_ENABLED;
     }
+    /*
+     * Signals annotated as last value let the transmit queues discard older instances of the signal.
+     */
+    if (signalMember.annotation & MEMBER_ANNOTATE_LAST_VALUE) {
+        flags |= ALLJOYN_FLAG_LAST_VALUE;
+    }
     status = msg->SignalMsg(signalMember.signature,
                             destination,
                             sessionId,
@@ -443,7 +614,8 @@ QStatus BusObject::Signal(const char* destination,
                             args,
                             numArgs,
                             flags,
-                            timeToLive);
+                            timeToLive,
+                            typedArgs);
     if (status == ER_OK) {
         status = bus.GetInternal().GetRouter().PushMessage(msg, bus.GetInternal().GetLocalEndpoint());
     }
@@ -575,6 +747,7 @@ BusObject::BusObject(BusAttachment& bus, const char* path, bool isPlaceholder) :
     isPlaceholder(isPlaceholder)
 {
     components->inUseCounter = 0;
+    components->emitPropChangedOnSet = false;
 }
 
 BusObject::~BusObject()
@@ -168,4 +168,54 @@ size_t _CompressionRules::HdrFieldHash::operator()(const HeaderFields* k) const
 
 }
 
+bool CompressionDictionary::Touch(LruList& lru, LruIndex& index, uint32_t key)
+{
+    LruIndex::iterator iter = index.find(key);
+    if (iter != index.end()) {
+        lru.splice(lru.begin(), lru, iter->second);
+        return true;
+    }
+    if (lru.size() >= maxEntries) {
+        index.erase(lru.back());
+        lru.pop_back();
+    }
+    lru.push_front(key);
+    index[key] = lru.begin();
+    return false;
+}
+
+bool CompressionDictionary::IsRepeatedHeader(const HeaderFields& hdrFields)
+{
+    Adler32 adler;
+    uint32_t hash = 0;
+    const MsgArg* field = hdrFields.field;
+    for (size_t i = 0; i < ArraySize(hdrFields.field); i++, field++) {
+        if (!HeaderFields::Compressible[i]) {
+            continue;
+        }
+        switch (field->typeId) {
+        case ALLJOYN_STRING:
+        case ALLJOYN_OBJECT_PATH:
+            hash = adler.Update((const uint8_t*)field->v_string.str, field->v_string.len + 1);
+            break;
+
+        case ALLJOYN_SIGNATURE:
+            hash = adler.Update((const uint8_t*)field->v_signature.sig, field->v_signature.len + 1);
+            break;
+
+        case ALLJOYN_UINT16:
+            hash = adler.Update((const uint8_t*)&field->v_uint16, sizeof(field->v_uint16));
+            break;
+
+        case ALLJOYN_UINT32:
+            hash = adler.Update((const uint8_t*)&field->v_uint32, sizeof(field->v_uint32));
+            break;
+
+        default:
+            break;
+        }
+    }
+    return Touch(headers, headerIndex, hash);
+}
+
 }
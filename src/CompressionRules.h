@@ -34,6 +34,7 @@
 
 #include <Status.h>
 
+#include <list>
 #include <map>
 
 #if defined(__GNUC__) && !defined(ANDROID)
@@ -141,6 +142,72 @@ class _CompressionRules {
 
 };
 
+/**
+ * A CompressionDictionary tracks the compression state of a single connection. It records which
+ * compression tokens the remote side has already been told the expansion for so that the expansion
+ * only has to be sent inline with the first message on the connection that uses a token. It also
+ * records recently sent signal headers so the sender can decide to compress headers that repeat.
+ *
+ * Both tables have a bounded size and evict the least recently used entry when full. An evicted
+ * token simply has its expansion sent inline again the next time it is used.
+ *
+ * A CompressionDictionary is not thread safe, it is only accessed from the transmit thread of the
+ * endpoint that owns it.
+ */
+class CompressionDictionary {
+
+  public:
+
+    /**
+     * Default maximum number of tokens and signal headers tracked per connection.
+     */
+    static const size_t DEFAULT_MAX_ENTRIES = 256;
+
+    /**
+     * Constructor
+     *
+     * @param maxEntries  Maximum number of tokens and of signal headers to track.
+     */
+    CompressionDictionary(size_t maxEntries = DEFAULT_MAX_ENTRIES) : maxEntries(maxEntries) { }
+
+    /**
+     * Check if the remote side knows the expansion for a token and mark the token as the most
+     * recently used. If the remote side doesn't know the token it is added to the dictionary on the
+     * assumption the caller is going to send the expansion inline.
+     *
+     * @param token  The compression token to check.
+     *
+     * @return  true if the expansion was previously sent, false if the caller must send the expansion.
+     */
+    bool CheckAndAddToken(uint32_t token) { return Touch(tokens, tokenIndex, token); }
+
+    /**
+     * Check if the compressible header fields of a signal have been sent recently on this connection.
+     * The header fields are recorded if they have not been sent recently.
+     *
+     * @param hdrFields  The header fields of a signal about to be sent.
+     *
+     * @return  true if the same header fields were sent recently.
+     */
+    bool IsRepeatedHeader(const HeaderFields& hdrFields);
+
+  private:
+
+    typedef std::list<uint32_t> LruList;
+    typedef std::map<uint32_t, LruList::iterator> LruIndex;
+
+    /**
+     * Look up a key in an LRU table, moving it to the front or adding it if not present.
+     */
+    bool Touch(LruList& lru, LruIndex& index, uint32_t key);
+
+    size_t maxEntries;     /**< Maximum number of entries in each table */
+    LruList tokens;        /**< Tokens known to the remote side, most recently used first */
+    LruIndex tokenIndex;   /**< Index into the tokens list */
+    LruList headers;       /**< Hashes of recently sent signal headers, most recently used first */
+    LruIndex headerIndex;  /**< Index into the headers list */
+};
+
 }
 
 #endif
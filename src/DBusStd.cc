@@ -125,6 +125,7 @@ QStatus org::freedesktop::DBus::CreateInterfaces(BusAttachment& bus) {
     propsIntf->AddMethod("Get",    "ss",  "v",    "interface,propname,value", 0);
     propsIntf->AddMethod("Set",    "ssv", NULL,   "interface,propname,value", 0);
     propsIntf->AddMethod("GetAll", "s",  "a{sv}", "interface,props",          0);
+    propsIntf->AddSignal("PropertiesChanged", "sa{sv}as", "interface,changed_props,invalidated_props", 0);
     propsIntf->Activate();
 
     return status;
@@ -0,0 +1,135 @@
+#ifndef _ALLJOYN_DISPATCHSNAPSHOT_H
+#define _ALLJOYN_DISPATCHSNAPSHOT_H
+/**
+ * @file
+ * This file defines a template for publishing immutable dispatch indexes to lock-free readers
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include DispatchSnapshot.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/atomic.h>
+
+namespace ajn {
+
+/**
+ * %DispatchSnapshot holds the current version of an index that is read on the message receive
+ * path without taking a lock. Writers build a new index and publish it, the index that was
+ * replaced is retired and deleted once no reader can still be using it.
+ *
+ * Readers bracket their use of the index with BeginRead() and EndRead(). Publish() must be
+ * serialized by the caller, normally by holding the lock that protects the data the index is
+ * built from.
+ */
+template <typename T>
+class DispatchSnapshot {
+  public:
+
+    /**
+     * Constructor
+     */
+    DispatchSnapshot() : current(NULL), readers(0) { }
+
+    /**
+     * Destructor, there must be no readers.
+     */
+    ~DispatchSnapshot()
+    {
+        delete current;
+        Reclaim();
+    }
+
+    /**
+     * Start using the current index.
+     *
+     * @return  The current index or NULL if none has been published. The index remains valid
+     *          until EndRead() is called.
+     */
+    const T* BeginRead()
+    {
+        /* The atomic increment orders the count before the read of the current index */
+        qcc::IncrementAndFetch(&readers);
+        return current;
+    }
+
+    /**
+     * Finish using the index returned by BeginRead().
+     */
+    void EndRead()
+    {
+        qcc::DecrementAndFetch(&readers);
+    }
+
+    /**
+     * Get the current index, for use by writers only.
+     *
+     * @return  The current index or NULL.
+     */
+    T* GetCurrent() { return current; }
+
+    /**
+     * Publish a new index replacing the current one. Retired indexes are deleted if there are
+     * no readers, otherwise they are deleted by a later call.
+     *
+     * @param index  The new index, ownership is transferred to this object.
+     */
+    void Publish(T* index)
+    {
+        T* old = current;
+        if (old) {
+            retired.push_back(old);
+        }
+        current = index;
+        /*
+         * The atomic increment orders the store above before the reader count is checked. A reader
+         * that is not counted will see the new index.
+         */
+        if (qcc::IncrementAndFetch(&readers) == 1) {
+            Reclaim();
+        }
+        qcc::DecrementAndFetch(&readers);
+    }
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    DispatchSnapshot(const DispatchSnapshot& other);
+    DispatchSnapshot& operator=(const DispatchSnapshot& other);
+
+    void Reclaim()
+    {
+        for (size_t i = 0; i < retired.size(); ++i) {
+            delete retired[i];
+        }
+        retired.clear();
+    }
+
+    T* volatile current;          /**< The current index */
+    volatile int32_t readers;     /**< Number of readers that may be using an index */
+    std::vector<T*> retired;      /**< Replaced indexes waiting to be deleted */
+};
+
+}
+
+#endif
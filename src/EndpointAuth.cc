@@ -261,6 +261,8 @@ QStatus EndpointAuth::WaitHello()
 
 static const char NegotiateUnixFd[] = "NEGOTIATE_UNIX_FD";
 static const char AgreeUnixFd[] = "AGREE_UNIX_FD";
+static const char NegotiateSharedMemory[] = "NEGOTIATE_SHARED_MEMORY";
+static const char AgreeSharedMemory[] = "AGREE_SHARED_MEMORY";
 
 qcc::String EndpointAuth::SASLCallout(SASLEngine& sasl, const qcc::String& extCmd)
 {
@@ -276,6 +278,15 @@ qcc::String EndpointAuth::SASLCallout(SASLEngine& sasl, const qcc::String& extCm
         } else if (extCmd.find(AgreeUnixFd) == 0) {
             endpoint.features.handlePassing = true;
             endpoint.processId = qcc::StringToU32(extCmd.substr(sizeof(AgreeUnixFd) - 1), 0, -1);
+            /*
+             * Shared memory is negotiated once we know the daemon is on the same device. Daemons that
+             * don't know about shared memory respond with an error and we carry on using the socket.
+             */
+            if (allowSharedMemory) {
+                rsp = NegotiateSharedMemory;
+            }
+        } else if (extCmd.find(AgreeSharedMemory) == 0) {
+            endpoint.features.sharedMemory = true;
         }
     } else {
         if (extCmd.find(NegotiateUnixFd) == 0) {
@@ -285,6 +296,9 @@ qcc::String EndpointAuth::SASLCallout(SASLEngine& sasl, const qcc::String& extCm
 #endif
             endpoint.features.handlePassing = true;
             endpoint.processId = qcc::StringToU32(extCmd.substr(sizeof(NegotiateUnixFd) - 1), 0, -1);
+        } else if ((extCmd.find(NegotiateSharedMemory) == 0) && allowSharedMemory && endpoint.features.handlePassing) {
+            rsp = AgreeSharedMemory;
+            endpoint.features.sharedMemory = true;
         }
     }
     return rsp;
@@ -302,6 +316,12 @@ QStatus EndpointAuth::Establish(const qcc::String& authMechanisms,
 
     QCC_DbgPrintf(("EndpointAuth::Establish authMechanisms=\"%s\"", authMechanisms.c_str()));
 
+    /*
+     * Shared memory is only used if both sides agree to it during the SASL conversation
+     */
+    allowSharedMemory = endpoint.features.sharedMemory && !endpoint.features.isBusToBus;
+    endpoint.features.sharedMemory = false;
+
     if (isAccepting) {
         SASLEngine sasl(bus, AuthMechanism::CHALLENGER, authMechanisms, NULL, authListener, this);
         /*
@@ -399,6 +419,12 @@ QStatus EndpointAuth::Establish(const qcc::String& authMechanisms,
 
 ExitEstablish:
 
+    /*
+     * Body compression is only used between daemons that both know how to decompress bodies.
+     */
+    if (!endpoint.features.isBusToBus || (remoteProtocolVersion < 5)) {
+        endpoint.features.bodyCompression = false;
+    }
 
     QCC_DbgPrintf(("Establish complete %s", QCC_StatusText(status)));
 
@@ -59,7 +59,8 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
         endpoint(endpoint),
         uniqueName(bus.GetInternal().GetRouter().GenerateUniqueName()),
         isAccepting(isAcceptor),
-        remoteProtocolVersion(0)
+        remoteProtocolVersion(0),
+        allowSharedMemory(false)
     { }
 
     /**
@@ -138,6 +139,7 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
 
     qcc::GUID128 remoteGUID;            ///< GUID of the remote side (when applicable)
     uint32_t remoteProtocolVersion;     ///< ALLJOYN protocol version of the remote side
+    bool allowSharedMemory;             ///< Indicates if this side is willing to use shared memory
 
     ProtectedAuthListener authListener;  ///< Authentication listener
 
@@ -0,0 +1,145 @@
+/**
+ * @file
+ * This file implements the registry of remote endpoints used for reporting their traffic counters
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <set>
+#include <vector>
+
+#include <qcc/atomic.h>
+#include <qcc/Mutex.h>
+#include <qcc/Util.h>
+
+#include "EndpointStats.h"
+#include "MessageTrace.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/* Remote endpoints whose counters are reported */
+static set<RemoteEndpoint*> statsEndpoints;
+static Mutex statsEndpointsLock;
+
+void EndpointStats::Register(RemoteEndpoint* ep)
+{
+    statsEndpointsLock.Lock(MUTEX_CONTEXT);
+    statsEndpoints.insert(ep);
+    if (MessageTrace::IsEnabled()) {
+        ep->CreateTraceHistograms();
+    }
+    statsEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
+void EndpointStats::Unregister(RemoteEndpoint* ep)
+{
+    statsEndpointsLock.Lock(MUTEX_CONTEXT);
+    statsEndpoints.erase(ep);
+    statsEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
+void EndpointStats::GetSnapshots(std::vector<Snapshot>& snapshots)
+{
+    statsEndpointsLock.Lock(MUTEX_CONTEXT);
+    snapshots.resize(statsEndpoints.size());
+    size_t i = 0;
+    for (set<RemoteEndpoint*>::iterator it = statsEndpoints.begin(); it != statsEndpoints.end(); ++it, ++i) {
+        RemoteEndpoint* ep = *it;
+        snapshots[i].name = ep->GetUniqueName();
+        snapshots[i].traffic = ep->GetTrafficStats();
+        snapshots[i].compression = ep->GetCompressionStats();
+        snapshots[i].txQueueDepth = (uint32_t)ep->GetTxQueueDepth();
+    }
+    statsEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
+const char* EndpointStats::SnapshotSignature = "(a(yutut)uuutuuu(uttuutt))";
+
+QStatus EndpointStats::ToMsgArg(const Snapshot& snapshot, MsgArg& arg)
+{
+    QStatus status = ER_OK;
+    const RemoteEndpoint::TrafficStats& t = snapshot.traffic;
+    const RemoteEndpoint::CompressionStats& c = snapshot.compression;
+    MsgArg types[RemoteEndpoint::TrafficStats::NUM_MESSAGE_TYPES];
+
+    for (size_t type = 0; (status == ER_OK) && (type < ArraySize(types)); ++type) {
+        status = types[type].Set("(yutut)", (uint8_t)type,
+                                 t.rxMessages[type], t.rxBytes[type],
+                                 t.txMessages[type], t.txBytes[type]);
+    }
+    if (status == ER_OK) {
+        status = arg.Set(SnapshotSignature, ArraySize(types), types,
+                         snapshot.txQueueDepth, t.txQueueHighWater,
+                         t.txBlocked, t.txBlockedUs,
+                         (uint32_t)t.decryptFailures, (uint32_t)t.authFailures, t.headerExpansions,
+                         c.txMessages, c.txRawBytes, c.txWireBytes, c.txIncompressible,
+                         c.rxMessages, c.rxRawBytes, c.rxWireBytes);
+    }
+    if (status == ER_OK) {
+        /* The message type array goes out of scope */
+        arg.Stabilize();
+    }
+    return status;
+}
+
+void EndpointStats::SecurityViolation(const qcc::String& rcvEndpointName, QStatus status)
+{
+    if (rcvEndpointName.empty()) {
+        return;
+    }
+    statsEndpointsLock.Lock(MUTEX_CONTEXT);
+    for (set<RemoteEndpoint*>::iterator it = statsEndpoints.begin(); it != statsEndpoints.end(); ++it) {
+        if ((*it)->GetUniqueName() == rcvEndpointName) {
+            RemoteEndpoint::TrafficStats& stats = (*it)->GetTrafficStats();
+            if (status == ER_BUS_MESSAGE_DECRYPTION_FAILED) {
+                IncrementAndFetch(&stats.decryptFailures);
+            } else {
+                IncrementAndFetch(&stats.authFailures);
+            }
+            break;
+        }
+    }
+    statsEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
+void EndpointStats::Lock()
+{
+    statsEndpointsLock.Lock(MUTEX_CONTEXT);
+}
+
+void EndpointStats::Unlock()
+{
+    statsEndpointsLock.Unlock(MUTEX_CONTEXT);
+}
+
+EndpointStats::Iterator EndpointStats::Begin()
+{
+    return statsEndpoints.begin();
+}
+
+EndpointStats::Iterator EndpointStats::End()
+{
+    return statsEndpoints.end();
+}
+
+}
@@ -0,0 +1,147 @@
+#ifndef _ALLJOYN_ENDPOINTSTATS_H
+#define _ALLJOYN_ENDPOINTSTATS_H
+/**
+ * @file
+ * This file defines the registry of remote endpoints used for reporting their traffic counters
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include EndpointStats.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <set>
+#include <vector>
+
+#include <qcc/String.h>
+
+#include <alljoyn/MsgArg.h>
+
+#include "RemoteEndpoint.h"
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * %EndpointStats keeps the set of running remote endpoints so their counters can be reported. The
+ * set has its own lock so taking a snapshot never waits on the router or name table locks.
+ */
+class EndpointStats {
+  public:
+
+    /**
+     * Copy of the counters of a remote endpoint.
+     */
+    struct Snapshot {
+        qcc::String name;                               /**< Unique name of the endpoint */
+        RemoteEndpoint::TrafficStats traffic;           /**< Traffic counters */
+        RemoteEndpoint::CompressionStats compression;   /**< Body compression counters */
+        uint32_t txQueueDepth;                          /**< Messages in the tx queue when the snapshot was taken */
+    };
+
+    /** Registered endpoint iterator */
+    typedef std::set<RemoteEndpoint*>::const_iterator Iterator;
+
+    /**
+     * Add a remote endpoint to the set whose counters are reported.
+     *
+     * @param ep  The endpoint.
+     */
+    static void Register(RemoteEndpoint* ep);
+
+    /**
+     * Remove a remote endpoint from the set whose counters are reported. The endpoint must not be
+     * freed before this returns.
+     *
+     * @param ep  The endpoint.
+     */
+    static void Unregister(RemoteEndpoint* ep);
+
+    /**
+     * Get a copy of the counters of every registered remote endpoint.
+     *
+     * @param snapshots  [OUT] The endpoint counters.
+     */
+    static void GetSnapshots(std::vector<Snapshot>& snapshots);
+
+    /**
+     * Signature of the MsgArg a snapshot is reported as. See ToMsgArg().
+     */
+    static const char* SnapshotSignature;
+
+    /**
+     * Convert a snapshot into the MsgArg reported by the debug interface. The MsgArg is a struct
+     * holding:
+     *
+     * - for each message type (type, messages received, bytes received, messages sent, bytes sent)
+     *   with messages of types that are not known counted as type 0 (MESSAGE_INVALID)
+     * - number of messages in the tx queue
+     * - tx queue high water mark
+     * - number of pushes that blocked on a full tx queue
+     * - total microseconds pushes were blocked
+     * - number of decryption failures
+     * - number of authorization failures
+     * - number of compressed headers that needed an expansion rule from the sender
+     * - body compression (tx messages, tx raw bytes, tx wire bytes, tx incompressible, rx messages,
+     *   rx raw bytes, rx wire bytes)
+     *
+     * @param snapshot  The snapshot.
+     * @param arg       [OUT] The MsgArg, its contents are stabilized.
+     *
+     * @return  ER_OK if the MsgArg was set.
+     */
+    static QStatus ToMsgArg(const Snapshot& snapshot, MsgArg& arg);
+
+    /**
+     * Count a security violation against the endpoint a message was received on.
+     *
+     * @param rcvEndpointName  Unique name of the endpoint that received the message.
+     * @param status           ER_BUS_MESSAGE_DECRYPTION_FAILED, ER_BUS_MESSAGE_NOT_ENCRYPTED or
+     *                         ER_BUS_NOT_AUTHORIZED.
+     */
+    static void SecurityViolation(const qcc::String& rcvEndpointName, QStatus status);
+
+    /**
+     * Obtain exclusive access to the set of registered endpoints. Registered endpoints are not
+     * freed while the lock is held. Must be called before using Begin() and End().
+     */
+    static void Lock();
+
+    /**
+     * Release exclusive access to the set of registered endpoints.
+     */
+    static void Unlock();
+
+    /**
+     * Return an iterator to the first registered endpoint.
+     * Caller should obtain lock before calling this method.
+     */
+    static Iterator Begin();
+
+    /**
+     * Return an iterator to the end of the registered endpoints.
+     */
+    static Iterator End();
+};
+
+}
+
+#endif
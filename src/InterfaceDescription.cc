@@ -21,6 +21,7 @@
  ******************************************************************************/
 
 #include <qcc/platform.h>
+#include <string.h>
 #include <qcc/String.h>
 #include <qcc/StringMapKey.h>
 #include <map>
@@ -37,28 +38,28 @@ using namespace qcc;
 
 namespace ajn {
 
-static qcc::String NextArg(const char*& signature, qcc::String& argNames, bool inOut, size_t indent)
+/*
+ * Append the XML for the next argument in a signature. The argument names are a comma separated list
+ * that is consumed in step with the signature.
+ */
+static void AppendArg(qcc::String& xml, const char*& signature, const char*& argNames, bool inOut, const qcc::String& in)
 {
-    qcc::String in(indent, ' ');
-    qcc::String arg = in + "<arg";
-    qcc::String argType;
     const char* start = signature;
     SignatureUtils::ParseCompleteType(signature);
-    size_t len = signature - start;
-    argType.append(start, len);
-
-    if (!argNames.empty()) {
-        size_t pos = argNames.find_first_of(',');
-        arg += " name=\"" + argNames.substr(0, pos) + "\"";
-        if (pos == qcc::String::npos) {
-            argNames.clear();
-        } else {
-            argNames.erase(0, pos + 1);
-        }
+
+    xml += in;
+    xml += "    <arg";
+    if (*argNames) {
+        const char* end = strchr(argNames, ',');
+        size_t len = end ? (end - argNames) : strlen(argNames);
+        xml += " name=\"";
+        xml.append(argNames, len);
+        xml += '"';
+        argNames += end ? len + 1 : len;
     }
-    arg += " type=\"" + argType + "\" direction=\"";
-    arg += inOut ? "in\"/>\n" : "out\"/>\n";
-    return arg;
+    xml += " type=\"";
+    xml.append(start, signature - start);
+    xml += inOut ? "\" direction=\"in\"/>\n" : "\" direction=\"out\"/>\n";
 }
 
 struct InterfaceDescription::Definitions {
@@ -114,40 +115,67 @@ InterfaceDescription& InterfaceDescription::operator=(const InterfaceDescription
 
 qcc::String InterfaceDescription::Introspect(size_t indent) const
 {
-    qcc::String in(indent, ' ');
-    const qcc::String close = "\">\n";
-    qcc::String xml = in + "<interface name=\"";
-
-    xml += name + close;
+    /*
+     * The XML is appended to a single buffer sized for a typical member so building it doesn't
+     * allocate a temporary string for every element and attribute.
+     */
+    const qcc::String in(indent, ' ');
+    qcc::String xml;
+    xml.reserve(128 * (2 + defs->members.size() + defs->properties.size()));
+
+    xml += in;
+    xml += "<interface name=\"";
+    xml += name;
+    xml += "\">\n";
     /*
      * Iterate over interface defs->members
      */
     std::map<qcc::StringMapKey, Member>::const_iterator mit = defs->members.begin();
     while (mit != defs->members.end()) {
         const Member& member = mit->second;
-        qcc::String argNames = member.argNames;
-        qcc::String mtype = (member.memberType == MESSAGE_METHOD_CALL) ? "method" : "signal";
-        xml += in + "  <" + mtype + " name=\"" + member.name + close;
+        const char* argNames = member.argNames.c_str();
+        const char* mtype = (member.memberType == MESSAGE_METHOD_CALL) ? "method" : "signal";
+        xml += in;
+        xml += "  <";
+        xml += mtype;
+        xml += " name=\"";
+        xml += member.name;
+        xml += "\">\n";
 
         /* Iterate over IN arguments */
         for (const char* sig = member.signature.c_str(); *sig;) {
             // always treat signals as direction=out
-            xml += NextArg(sig, argNames, member.memberType != MESSAGE_SIGNAL, indent + 4);
+            AppendArg(xml, sig, argNames, member.memberType != MESSAGE_SIGNAL, in);
         }
         /* Iterate over OUT arguments */
         for (const char* sig = member.returnSignature.c_str(); *sig;) {
-            xml += NextArg(sig, argNames, false, indent + 4);
+            AppendArg(xml, sig, argNames, false, in);
         }
         /*
          * Add annotations
          */
         if (member.annotation  & MEMBER_ANNOTATE_NO_REPLY) {
-            xml += in + "    <annotation name=\"" + org::freedesktop::DBus::AnnotateNoReply + "\" value=\"true\"/>\n";
+            xml += in;
+            xml += "    <annotation name=\"";
+            xml += org::freedesktop::DBus::AnnotateNoReply;
+            xml += "\" value=\"true\"/>\n";
         }
         if (member.annotation  & MEMBER_ANNOTATE_DEPRECATED) {
-            xml += in + "    <annotation name=\"" + org::freedesktop::DBus::AnnotateDeprecated + "\" value=\"true\"/>\n";
+            xml += in;
+            xml += "    <annotation name=\"";
+            xml += org::freedesktop::DBus::AnnotateDeprecated;
+            xml += "\" value=\"true\"/>\n";
+        }
+        if (member.annotation  & MEMBER_ANNOTATE_LAST_VALUE) {
+            xml += in;
+            xml += "    <annotation name=\"";
+            xml += org::alljoyn::Bus::AnnotateLastValue;
+            xml += "\" value=\"true\"/>\n";
         }
-        xml += in + "  </" + mtype + ">\n";
+        xml += in;
+        xml += "  </";
+        xml += mtype;
+        xml += ">\n";
         ++mit;
     }
     /*
@@ -156,20 +184,28 @@ qcc::String InterfaceDescription::Introspect(size_t indent) const
     map<qcc::StringMapKey, Property>::const_iterator pit = defs->properties.begin();
     while (pit != defs->properties.end()) {
         const Property& property = pit->second;
-        xml += in + "  <property name=\"" + property.name + "\" type=\"" + property.signature + "\"";
+        xml += in;
+        xml += "  <property name=\"";
+        xml += property.name;
+        xml += "\" type=\"";
+        xml += property.signature;
         if (property.access == PROP_ACCESS_READ) {
-            xml += " access=\"read\"/>\n";
+            xml += "\" access=\"read\"/>\n";
         } else if (property.access == PROP_ACCESS_WRITE) {
-            xml += " access=\"write\"/>\n";
+            xml += "\" access=\"write\"/>\n";
         } else {
-            xml += " access=\"readwrite\"/>\n";
+            xml += "\" access=\"readwrite\"/>\n";
         }
         ++pit;
     }
     if (IsSecure()) {
-        xml += in + "  <annotation name=\"" + org::alljoyn::Bus::Secure + "\" value=\"true\"/>\n";
+        xml += in;
+        xml += "  <annotation name=\"";
+        xml += org::alljoyn::Bus::Secure;
+        xml += "\" value=\"true\"/>\n";
     }
-    xml += in + "</interface>\n";
+    xml += in;
+    xml += "</interface>\n";
     return xml;
 }
 
@@ -0,0 +1,262 @@
+/**
+ * @file
+ * Implementation of the IntrospectionCache
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <map>
+
+#include <qcc/Crypto.h>
+#include <qcc/Debug.h>
+#include <qcc/FileStream.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+
+#include "IntrospectionCache.h"
+
+#include <Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+
+namespace ajn {
+
+IntrospectionCache IntrospectionCache::cache;
+
+/*
+ * Parse introspection XML into a tree of interfaces and child nodes.
+ */
+static QStatus ParseIntrospection(BusAttachment* bus, const char* xml, const char* ident, IntrospectionNode& node)
+{
+    XmlHelper xmlHelper(bus, ident);
+    return xmlHelper.ParseIntrospection(xml, node);
+}
+
+qcc::String IntrospectionCache::HashXml(const char* xml, size_t len)
+{
+    /* Must match BusObject::GetIntrospectionHash */
+    uint8_t digest[Crypto_SHA1::DIGEST_SIZE];
+    Crypto_SHA1 sha1;
+    sha1.Init();
+    sha1.Update((const uint8_t*)xml, len);
+    sha1.GetDigest(digest);
+    return BytesToHexString(digest, Crypto_SHA1::DIGEST_SIZE, true /*toLower*/);
+}
+
+qcc::String IntrospectionCache::PeerOf(const qcc::String& sender)
+{
+    /* Unique names are :<bus>.<n>, all the connections of a remote bus share one quota */
+    size_t dot = sender.find_last_of('.');
+    return (dot == String::npos) ? sender : sender.substr(0, dot);
+}
+
+IntrospectionCache& IntrospectionCache::GetCache()
+{
+    return cache;
+}
+
+IntrospectionCache::~IntrospectionCache()
+{
+    for (map<String, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        delete it->second.root;
+    }
+}
+
+QStatus IntrospectionCache::Enable(const char* fileName)
+{
+    QStatus status = ER_OK;
+    lock.Lock(MUTEX_CONTEXT);
+    if (fileName && (this->fileName != fileName)) {
+        this->fileName = fileName;
+        status = Load();
+    }
+    enabled = true;
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+bool IntrospectionCache::AddProxyObjects(const qcc::String& hash, ProxyBusObject& proxy, const char* ident, QStatus& status)
+{
+    bool hit = false;
+    lock.Lock(MUTEX_CONTEXT);
+    map<String, Entry>::iterator it = entries.find(hash);
+    if (it != entries.end()) {
+        /* Entries loaded from the cache file are parsed the first time they are used */
+        if (!it->second.root) {
+            IntrospectionNode* root = new IntrospectionNode();
+            if (ParseIntrospection(proxy.bus, it->second.xml.c_str(), ident, *root) == ER_OK) {
+                it->second.root = root;
+            } else {
+                QCC_LogError(ER_BUS_BAD_XML, ("Dropping bad cached introspection for %s", ident));
+                delete root;
+                --peerCounts[it->second.peer];
+                entries.erase(it);
+                it = entries.end();
+            }
+        }
+        if (it != entries.end()) {
+            XmlHelper xmlHelper(proxy.bus, ident);
+            status = xmlHelper.AddProxyObjects(proxy, *it->second.root);
+            hit = true;
+        }
+    }
+    if (hit) {
+        ++hits;
+    } else {
+        ++misses;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return hit;
+}
+
+QStatus IntrospectionCache::ParseXml(const qcc::String& hash, const char* xml, const qcc::String& sender, ProxyBusObject& proxy, const char* ident)
+{
+    IntrospectionNode* root = new IntrospectionNode();
+    QStatus status = ParseIntrospection(proxy.bus, xml, ident, *root);
+    if (status == ER_OK) {
+        XmlHelper xmlHelper(proxy.bus, ident);
+        status = xmlHelper.AddProxyObjects(proxy, *root);
+    }
+    /*
+     * The XML is only cached under the hash the remote object returned if it really is the hash of
+     * the XML, otherwise any peer could replace the introspection of another service.
+     */
+    if ((status == ER_OK) && (HashXml(xml, strlen(xml)) != hash)) {
+        QCC_LogError(ER_BUS_BAD_XML, ("Introspection hash from %s does not match its XML, not caching", ident));
+        delete root;
+        return status;
+    }
+    if (status == ER_OK) {
+        String peer = PeerOf(sender);
+        lock.Lock(MUTEX_CONTEXT);
+        size_t& peerCount = peerCounts[peer];
+        if ((entries.size() < MAX_ENTRIES) && (peerCount < MAX_ENTRIES_PER_PEER) && (entries.find(hash) == entries.end())) {
+            Entry& entry = entries[hash];
+            entry.xml = xml;
+            entry.peer = peer;
+            entry.root = root;
+            root = NULL;
+            ++peerCount;
+            if (!fileName.empty()) {
+                Save();
+            }
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+    delete root;
+    return status;
+}
+
+void IntrospectionCache::GetCounters(uint32_t& hits, uint32_t& misses)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    hits = this->hits;
+    misses = this->misses;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+/*
+ * The cache file holds one record for each entry, a line with the hash, the length of the XML and
+ * the remote bus that added the entry followed by the XML and a newline. Records are checked
+ * against their hash and the per-peer limit as they are loaded so an edited file cannot get around
+ * either.
+ */
+QStatus IntrospectionCache::Load()
+{
+    FileSource source(fileName);
+    if (!source.IsValid()) {
+        /* No cache file yet */
+        return ER_OK;
+    }
+    String data;
+    char buf[1024];
+    size_t actual;
+    while ((source.PullBytes(buf, sizeof(buf), actual) == ER_OK) && (actual > 0)) {
+        data.append(buf, actual);
+    }
+
+    size_t pos = 0;
+    size_t numLoaded = 0;
+    while ((pos < data.size()) && (entries.size() < MAX_ENTRIES)) {
+        size_t eol = data.find_first_of('\n', pos);
+        size_t sep = data.find_first_of(' ', pos);
+        if ((eol == String::npos) || (sep == String::npos) || (sep > eol)) {
+            break;
+        }
+        String hash = data.substr(pos, sep - pos);
+        size_t peerSep = data.find_first_of(' ', sep + 1);
+        if ((peerSep == String::npos) || (peerSep > eol)) {
+            break;
+        }
+        size_t len = StringToU32(data.substr(sep + 1, peerSep - sep - 1), 10, 0);
+        String peer = data.substr(peerSep + 1, eol - peerSep - 1);
+        pos = eol + 1;
+        if ((len == 0) || ((pos + len) >= data.size()) || (data[pos + len] != '\n')) {
+            break;
+        }
+        if (HashXml(data.data() + pos, len) != hash) {
+            QCC_DbgPrintf(("Skipping introspection cache record with a bad hash"));
+        } else if ((entries.find(hash) == entries.end()) && (peerCounts[peer] < MAX_ENTRIES_PER_PEER)) {
+            Entry& entry = entries[hash];
+            entry.xml = data.substr(pos, len);
+            entry.peer = peer;
+            ++peerCounts[peer];
+            ++numLoaded;
+        }
+        pos += len + 1;
+    }
+    if (pos < data.size()) {
+        QStatus status = ER_BUS_READ_ERROR;
+        QCC_LogError(status, ("Introspection cache file %s is corrupt", fileName.c_str()));
+        return status;
+    }
+    QCC_DbgPrintf(("Loaded %u introspection cache entries from %s", (uint32_t)numLoaded, fileName.c_str()));
+    return ER_OK;
+}
+
+QStatus IntrospectionCache::Save()
+{
+    FileSink sink(fileName, FileSink::PRIVATE);
+    if (!sink.IsValid()) {
+        QStatus status = ER_BUS_WRITE_ERROR;
+        QCC_LogError(status, ("Cannot write introspection cache file %s", fileName.c_str()));
+        return status;
+    }
+    sink.Lock(true);
+    QStatus status = ER_OK;
+    for (map<String, Entry>::iterator it = entries.begin(); (status == ER_OK) && (it != entries.end()); ++it) {
+        String record = it->first + " " + U32ToString((uint32_t)it->second.xml.size()) + " " + it->second.peer + "\n" + it->second.xml + "\n";
+        size_t sent;
+        status = sink.PushBytes(record.data(), record.size(), sent);
+        if ((status == ER_OK) && (sent != record.size())) {
+            status = ER_BUS_WRITE_ERROR;
+        }
+    }
+    sink.Unlock();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to write introspection cache file %s", fileName.c_str()));
+    }
+    return status;
+}
+
+}
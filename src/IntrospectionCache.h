@@ -0,0 +1,178 @@
+/**
+ * @file
+ * IntrospectionCache holds the parsed introspection data for remote objects so that proxy objects
+ * don't have to transfer and parse introspection XML they have seen before.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_INTROSPECTIONCACHE_H
+#define _ALLJOYN_INTROSPECTIONCACHE_H
+
+#ifndef __cplusplus
+#error Only include IntrospectionCache.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <map>
+
+#include <qcc/String.h>
+#include <qcc/Mutex.h>
+
+#include <alljoyn/ProxyBusObject.h>
+
+#include "XmlHelper.h"
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * The process-wide introspection cache. Entries are keyed by the hash a remote object returns from
+ * org.alljoyn.Bus.Introspectable.GetIntrospectionHash, this is a SHA1 hash of the introspection XML
+ * so identical objects on different peers share an entry and an entry can never be stale. The hash
+ * is checked against the XML before an entry is added so a peer cannot file its own XML under the
+ * hash of another service's introspection.
+ *
+ * Each entry holds the introspection XML and the interfaces and child nodes parsed from it. If the
+ * cache has a file the XML is written to the file when new entries are added and read back the
+ * next time the cache is enabled, the XML is only parsed when an entry is first used.
+ */
+class IntrospectionCache {
+  public:
+
+    /**
+     * Maximum number of entries, introspection data for new objects is not cached once this many
+     * entries have been added.
+     */
+    static const size_t MAX_ENTRIES = 1024;
+
+    /**
+     * Maximum number of entries added from objects on any one remote bus, stops a single peer from
+     * filling the cache.
+     */
+    static const size_t MAX_ENTRIES_PER_PEER = 64;
+
+    /**
+     * Get the process-wide cache.
+     */
+    static IntrospectionCache& GetCache();
+
+    /**
+     * Destructor
+     */
+    ~IntrospectionCache();
+
+    /**
+     * Enable the cache, optionally loading entries from a file.
+     *
+     * @param fileName  File to load entries from and save new entries to or NULL to keep the
+     *                  cache in memory only.
+     *
+     * @return
+     *      - ER_OK if the cache was enabled.
+     *      - ER_BUS_READ_ERROR if the file exists but is not a valid cache file, the cache is
+     *        enabled and the file will be overwritten when new entries are added.
+     */
+    QStatus Enable(const char* fileName);
+
+    /**
+     * Check if the cache is enabled.
+     *
+     * @return  true if the cache is enabled.
+     */
+    bool IsEnabled() const { return enabled; }
+
+    /**
+     * Add the cached interfaces and children for an introspection hash to a proxy object. Counts a
+     * hit or a miss.
+     *
+     * @param hash    The hash returned by the remote object.
+     * @param proxy   The proxy object to add the interfaces and children to.
+     * @param ident   Identifies the remote object in error messages.
+     * @param status  Returns the status of adding the interfaces and children if there was a hit.
+     *
+     * @return  true if the hash was in the cache.
+     */
+    bool AddProxyObjects(const qcc::String& hash, ProxyBusObject& proxy, const char* ident, QStatus& status);
+
+    /**
+     * Parse introspection XML, add the interfaces and children it describes to a proxy object and
+     * add them to the cache. They are only added to the cache if the hash matches the XML and the
+     * remote bus the XML came from has not already added MAX_ENTRIES_PER_PEER entries.
+     *
+     * @param hash    The hash returned by the remote object.
+     * @param xml     The introspection XML returned by the remote object.
+     * @param sender  Unique name of the remote object's bus attachment.
+     * @param proxy   The proxy object to add the interfaces and children to.
+     * @param ident   Identifies the remote object in error messages.
+     *
+     * @return  ER_OK if the XML was parsed and the interfaces and children were added.
+     */
+    QStatus ParseXml(const qcc::String& hash, const char* xml, const qcc::String& sender, ProxyBusObject& proxy, const char* ident);
+
+    /**
+     * Get the number of cache hits and misses.
+     *
+     * @param hits    Returns the number of introspections served from the cache.
+     * @param misses  Returns the number of introspections that had to fetch the XML.
+     */
+    void GetCounters(uint32_t& hits, uint32_t& misses);
+
+  private:
+
+    /* Use GetCache() */
+    IntrospectionCache() : enabled(false), hits(0), misses(0) { }
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    IntrospectionCache(const IntrospectionCache& other);
+    IntrospectionCache& operator=(const IntrospectionCache& other);
+
+    /** Read entries from the cache file, called with the lock held */
+    QStatus Load();
+
+    /** Write all entries to the cache file, called with the lock held */
+    QStatus Save();
+
+    /** Get the SHA1 hash of introspection XML as GetIntrospectionHash returns it */
+    static qcc::String HashXml(const char* xml, size_t len);
+
+    /** Get the remote bus part of a unique name, entries are counted against it */
+    static qcc::String PeerOf(const qcc::String& sender);
+
+    /** A cached introspection */
+    struct Entry {
+        Entry() : root(NULL) { }
+        qcc::String xml;          /**< The introspection XML */
+        qcc::String peer;         /**< The remote bus that added the entry */
+        IntrospectionNode* root;  /**< Parsed from the XML on first use */
+    };
+
+    static IntrospectionCache cache;          /**< The process-wide cache */
+
+    std::map<qcc::String, Entry> entries;     /**< Entries by introspection hash */
+    std::map<qcc::String, size_t> peerCounts; /**< Number of entries added by each remote bus */
+    qcc::String fileName;                     /**< The cache file or empty */
+    qcc::Mutex lock;                          /**< Protects the entries and counters */
+    volatile bool enabled;                    /**< true if the cache is enabled */
+    uint32_t hits;                            /**< Introspections served from the cache */
+    uint32_t misses;                          /**< Introspections that had to fetch the XML */
+};
+
+}
+
+#endif
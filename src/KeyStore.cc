@@ -21,6 +21,7 @@
  ******************************************************************************/
 
 #include <map>
+#include <stdio.h>
 
 #include <qcc/platform.h>
 #include <qcc/Debug.h>
@@ -34,6 +35,13 @@
 #include <qcc/StringSink.h>
 #include <qcc/Thread.h>
 
+#if defined(QCC_OS_GROUP_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <alljoyn/KeyStoreListener.h>
 
 #include "PeerState.h"
@@ -59,6 +67,157 @@ static const uint16_t LowStoreVersion = 0x0102;
  */
 static const uint16_t KeyStoreVersion = 0x0103;
 
+/*
+ * Current key store journal version we will write
+ */
+static const uint16_t KeyStoreJournalVersion = 0x0002;
+
+/*
+ * Journal record operations
+ */
+static const uint8_t JOURNAL_ADD_KEY = 1;
+static const uint8_t JOURNAL_DEL_KEY = 2;
+
+/*
+ * Sanity check on the length of the encrypted keys. Key stores for daemons that authenticate with
+ * many peers can grow well beyond the size of a single record.
+ */
+static const size_t MaxKeyStoreLen = 32 * 1024 * 1024;
+
+/*
+ * Sanity check on the length of a single journal record
+ */
+static const uint32_t MaxJournalRecordLen = 64000;
+
+/*
+ * The journal is folded into the key store once it grows beyond this size or beyond the size of
+ * the key store itself, whichever is larger.
+ */
+static const long MinCompactionSize = 16 * 1024;
+
+/*
+ * Build the nonce for encrypting a journal record. The revision is incremented for every batch of
+ * records and the sequence number for every record in a batch. Two processes sharing a key store
+ * can still write a batch with the same revision if one has not seen the other's batch yet, so each
+ * batch also has a random salt.
+ */
+static KeyBlob JournalNonce(uint32_t revision, uint32_t seq, uint32_t salt)
+{
+    uint8_t nd[13];
+    nd[0] = 'J';
+    memcpy(&nd[1], &revision, sizeof(revision));
+    memcpy(&nd[5], &seq, sizeof(seq));
+    memcpy(&nd[9], &salt, sizeof(salt));
+    return KeyBlob(nd, sizeof(nd), KeyBlob::GENERIC);
+}
+
+/*
+ * Pull exactly len bytes from a source. Returns ER_NONE if the source is exhausted and
+ * ER_BUS_CORRUPT_KEYSTORE if the source ends part way through.
+ */
+static QStatus PullExact(Source& source, void* buf, size_t len)
+{
+    size_t pulled = 0;
+    QStatus status = source.PullBytes(buf, len, pulled);
+    if ((status == ER_OK) && (pulled != len)) {
+        status = ER_BUS_CORRUPT_KEYSTORE;
+    }
+    return status;
+}
+
+/*
+ * Read-only source over the contents of a key store file. On POSIX platforms the file is memory
+ * mapped so loading a large key store doesn't go through a long sequence of small reads.
+ */
+class KeyStoreFileSource : public Source {
+  public:
+
+    KeyStoreFileSource(const qcc::String& fileName) : data(NULL), len(0), offset(0), valid(false), mapped(false)
+    {
+#if defined(QCC_OS_GROUP_POSIX)
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat st;
+            valid = true;
+            if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+                void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    data = static_cast<uint8_t*>(addr);
+                    len = st.st_size;
+                    mapped = true;
+                }
+            }
+            close(fd);
+            if (mapped) {
+                return;
+            }
+        }
+#endif
+        FILE* fp = fopen(fileName.c_str(), "rb");
+        if (fp) {
+            valid = true;
+            if ((fseek(fp, 0, SEEK_END) == 0) && (ftell(fp) > 0)) {
+                len = ftell(fp);
+                data = new uint8_t[len];
+                fseek(fp, 0, SEEK_SET);
+                len = fread(data, 1, len, fp);
+            }
+            fclose(fp);
+        }
+    }
+
+    ~KeyStoreFileSource()
+    {
+#if defined(QCC_OS_GROUP_POSIX)
+        if (mapped) {
+            munmap(data, len);
+            return;
+        }
+#endif
+        delete [] data;
+    }
+
+    QStatus PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout = Event::WAIT_FOREVER)
+    {
+        if (offset >= len) {
+            actualBytes = 0;
+            return ER_NONE;
+        }
+        actualBytes = min(reqBytes, len - offset);
+        memcpy(buf, data + offset, actualBytes);
+        offset += actualBytes;
+        return ER_OK;
+    }
+
+    bool IsValid() const { return valid; }
+
+    size_t GetSize() const { return len; }
+
+  private:
+
+    uint8_t* data;
+    size_t len;
+    size_t offset;
+    bool valid;
+    bool mapped;
+};
+
+/*
+ * Returns the size of a file or 0 if the file does not exist.
+ */
+static long FileSize(const qcc::String& fileName)
+{
+    long size = 0;
+    FILE* fp = fopen(fileName.c_str(), "rb");
+    if (fp) {
+        if (fseek(fp, 0, SEEK_END) == 0) {
+            size = ftell(fp);
+        }
+        fclose(fp);
+    }
+    return (size > 0) ? size : 0;
+}
+
 
 QStatus KeyStoreListener::PutKeys(KeyStore& keyStore, const qcc::String& source, const qcc::String& password)
 {
@@ -76,6 +235,12 @@ QStatus KeyStoreListener::GetKeys(KeyStore& keyStore, qcc::String& sink)
     return status;
 }
 
+/*
+ * The default key store listener keeps the key store in a file and records changes to the key
+ * store in an append-only journal file alongside it. Each store request appends the changed keys
+ * to the journal. Once the journal grows too large it is compacted by writing out the complete key
+ * store and discarding the journal. The key store file lock serializes access to both files.
+ */
 class DefaultKeyStoreListener : public KeyStoreListener {
 
   public:
@@ -86,24 +251,36 @@ class DefaultKeyStoreListener : public KeyStoreListener {
         } else {
             fileName = GetHomeDir() + "/.alljoyn_keystore/" + application;
         }
+        journalName = fileName + ".journal";
+        compactPending = false;
     }
 
     QStatus LoadRequest(KeyStore& keyStore) {
         QStatus status;
         /* Try to load the keystore */
         {
-            FileSource source(fileName);
-            if (source.IsValid()) {
-                source.Lock(true);
+            FileSource lockSource(fileName);
+            if (lockSource.IsValid()) {
+                lockSource.Lock(true);
+                KeyStoreFileSource source(fileName);
                 status = keyStore.Pull(source, fileName);
                 if (status == ER_OK) {
                     QCC_DbgHLPrintf(("Read key store from %s", fileName.c_str()));
+                    KeyStoreFileSource journal(journalName);
+                    if (journal.IsValid()) {
+                        bool compact;
+                        status = keyStore.PullJournal(journal, compact);
+                        if (status == ER_OK) {
+                            QCC_DbgHLPrintf(("Read %u byte key store journal from %s", journal.GetSize(), journalName.c_str()));
+                        }
+                        compactPending = compact;
+                    }
                 }
-                source.Unlock();
+                lockSource.Unlock();
                 return status;
             }
         }
-        /* Create an empty keystore */
+        /* Create an empty keystore and discard any journal left over from a previous key store */
         {
             FileSink sink(fileName, FileSink::PRIVATE);
             if (!sink.IsValid()) {
@@ -111,6 +288,7 @@ class DefaultKeyStoreListener : public KeyStoreListener {
                 QCC_LogError(status, ("Cannot initialize key store %s", fileName.c_str()));
                 return status;
             }
+            DeleteFile(journalName);
         }
         /* Load the empty keystore */
         {
@@ -133,11 +311,27 @@ class DefaultKeyStoreListener : public KeyStoreListener {
 
     QStatus StoreRequest(KeyStore& keyStore) {
         QStatus status;
+        if (!keyStore.NeedsFullStore() && !compactPending) {
+            FileSource lockSource(fileName);
+            if (lockSource.IsValid()) {
+                lockSource.Lock(true);
+                long journalSize = FileSize(journalName);
+                if (journalSize <= max(MinCompactionSize, FileSize(fileName))) {
+                    status = AppendJournal(keyStore, journalSize == 0);
+                    lockSource.Unlock();
+                    return status;
+                }
+                lockSource.Unlock();
+            }
+        }
         FileSink sink(fileName, FileSink::PRIVATE);
         if (sink.IsValid()) {
             sink.Lock(true);
             status = keyStore.Push(sink);
             if (status == ER_OK) {
+                /* The journal has been folded into the key store */
+                DeleteFile(journalName);
+                compactPending = false;
                 QCC_DbgHLPrintf(("Wrote key store to %s", fileName.c_str()));
             }
             sink.Unlock();
@@ -150,21 +344,58 @@ class DefaultKeyStoreListener : public KeyStoreListener {
 
   private:
 
+    /*
+     * Append the changes to the journal. Must be called with the key store file locked.
+     */
+    QStatus AppendJournal(KeyStore& keyStore, bool newJournal) {
+        StringSink records;
+        QStatus status = keyStore.PushJournal(records, newJournal);
+        if (status == ER_OK) {
+            const qcc::String& str = records.GetString();
+            FILE* fp = fopen(journalName.c_str(), "ab");
+            if (fp) {
+                if ((fwrite(str.data(), 1, str.size(), fp) != str.size()) || (fflush(fp) != 0)) {
+                    status = ER_BUS_WRITE_ERROR;
+                }
+                fclose(fp);
+            } else {
+                status = ER_BUS_WRITE_ERROR;
+            }
+            if (status == ER_OK) {
+                QCC_DbgHLPrintf(("Appended %u bytes to key store journal %s", str.size(), journalName.c_str()));
+            } else {
+                /* The journal may now have a torn record so fold it into the key store next time */
+                compactPending = true;
+                QCC_LogError(status, ("Cannot write key store journal %s", journalName.c_str()));
+            }
+        }
+        return status;
+    }
+
     qcc::String fileName;
 
+    qcc::String journalName;
+
+    bool compactPending;
+
 };
 
 KeyStore::KeyStore(const qcc::String& application) :
     application(application),
     storeState(UNAVAILABLE),
     keys(new KeyMap),
+    fullStoreRequired(false),
     defaultListener(NULL),
     listener(NULL),
     thisGuid(),
     keyStoreKey(NULL),
     shared(false),
     stored(NULL),
-    loaded(NULL)
+    loaded(NULL),
+    storeTimer(NULL),
+    coalesceWindow(DEFAULT_STORE_COALESCE_WINDOW),
+    lastStoreTime(0),
+    storePending(false)
 {
 }
 
@@ -220,15 +451,67 @@ QStatus KeyStore::Init(const char* fileName, bool isShared)
     }
 }
 
-QStatus KeyStore::Store()
+void KeyStore::SetStoreTimer(qcc::Timer* timer, uint32_t coalesceWindow)
 {
-    QStatus status = ER_OK;
+    lock.Lock(MUTEX_CONTEXT);
+    storeTimer = timer;
+    this->coalesceWindow = coalesceWindow;
+    /* A store deferred on a previous timer is picked up by the next call to Store() */
+    storePending = false;
+    lock.Unlock(MUTEX_CONTEXT);
+}
 
+QStatus KeyStore::Store()
+{
     /* Cannot store if never loaded */
     if (storeState == UNAVAILABLE) {
         return ER_BUS_KEYSTORE_NOT_LOADED;
     }
     /* Don't store if not modified */
+    if (storeState != MODIFIED) {
+        return ER_OK;
+    }
+    /*
+     * If the key store was written very recently defer the store so that a burst of changes,
+     * for example from a number of peers authenticating at once, is written out together.
+     */
+    lock.Lock(MUTEX_CONTEXT);
+    if (storeTimer) {
+        if (storePending) {
+            lock.Unlock(MUTEX_CONTEXT);
+            return ER_OK;
+        }
+        uint32_t elapsed = GetTimestamp() - lastStoreTime;
+        if (elapsed < coalesceWindow) {
+            Alarm alarm(coalesceWindow - elapsed, this);
+            if (storeTimer->AddAlarm(alarm) == ER_OK) {
+                QCC_DbgPrintf(("KeyStore::Store deferred for %u ms", coalesceWindow - elapsed));
+                storePending = true;
+                lock.Unlock(MUTEX_CONTEXT);
+                return ER_OK;
+            }
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return StoreInternal();
+}
+
+void KeyStore::AlarmTriggered(const Alarm& alarm, QStatus reason)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    storePending = false;
+    lock.Unlock(MUTEX_CONTEXT);
+    /* Store even if the timer is exiting so deferred changes are not lost */
+    if ((storeState == MODIFIED) && (StoreInternal() != ER_OK)) {
+        QCC_LogError(ER_BUS_WRITE_ERROR, ("Deferred key store write failed"));
+    }
+}
+
+QStatus KeyStore::StoreInternal()
+{
+    QStatus status = ER_OK;
+
+    storeLock.Lock(MUTEX_CONTEXT);
     if (storeState == MODIFIED) {
 
         lock.Lock(MUTEX_CONTEXT);
@@ -252,9 +535,11 @@ QStatus KeyStore::Store()
             stored = NULL;
             /* Done tracking deletions */
             deletions.clear();
+            lastStoreTime = GetTimestamp();
         }
         lock.Unlock(MUTEX_CONTEXT);
     }
+    storeLock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
@@ -333,6 +618,7 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
         keys->clear();
         storeState = MODIFIED;
         revision = 0;
+        fullStoreRequired = true;
         status = ER_OK;
         goto ExitPull;
     }
@@ -346,7 +632,7 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
         goto ExitPull;
     }
     /* Sanity check on the length */
-    if (len > 64000) {
+    if (len > MaxKeyStoreLen) {
         status = ER_BUS_CORRUPT_KEYSTORE;
         goto ExitPull;
     }
@@ -412,12 +698,14 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
     } else {
         storeState = LOADED;
     }
+    fullStoreRequired = false;
 
 ExitPull:
 
     if (status != ER_OK) {
         keys->clear();
         storeState = MODIFIED;
+        fullStoreRequired = true;
     }
     if (loaded) {
         loaded->SetEvent();
@@ -436,8 +724,11 @@ QStatus KeyStore::Clear()
     storeState = MODIFIED;
     revision = 0;
     deletions.clear();
+    dirty.clear();
+    fullStoreRequired = true;
     lock.Unlock(MUTEX_CONTEXT);
-    listener->StoreRequest(*this);
+    /* The revision is 0 so nothing is reloaded, the cleared key store replaces the file */
+    StoreInternal();
     return ER_OK;
 }
 
@@ -594,6 +885,8 @@ QStatus KeyStore::Push(Sink& sink)
         goto ExitPush;
     }
     storeState = LOADED;
+    fullStoreRequired = false;
+    dirty.clear();
 
 ExitPush:
 
@@ -604,6 +897,241 @@ ExitPush:
     return status;
 }
 
+QStatus KeyStore::PullJournal(Source& source, bool& compact)
+{
+    QCC_DbgPrintf(("KeyStore::PullJournal"));
+
+    compact = false;
+
+    if (storeState == UNAVAILABLE) {
+        return ER_BUS_KEYSTORE_NOT_LOADED;
+    }
+
+    lock.Lock(MUTEX_CONTEXT);
+
+    uint8_t guidBuf[qcc::GUID128::SIZE];
+    uint16_t version;
+    uint32_t baseRevision;
+    size_t count = 0;
+
+    /* An empty journal is not an error */
+    QStatus status = PullExact(source, &version, sizeof(version));
+    if (status == ER_NONE) {
+        lock.Unlock(MUTEX_CONTEXT);
+        return ER_OK;
+    }
+    if ((status == ER_OK) && (version != KeyStoreJournalVersion)) {
+        status = ER_BUS_KEYSTORE_VERSION_MISMATCH;
+        QCC_LogError(status, ("Keystore journal has wrong version expected %d got %d", KeyStoreJournalVersion, version));
+    }
+    if (status == ER_OK) {
+        status = PullExact(source, &baseRevision, sizeof(baseRevision));
+    }
+    if (status == ER_OK) {
+        status = PullExact(source, guidBuf, qcc::GUID128::SIZE);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Keystore journal header is damaged"));
+        compact = true;
+        status = ER_OK;
+        goto ExitPullJournal;
+    }
+    /*
+     * A journal that was not written against the revision we just pulled is left over from before
+     * the key store was last compacted. All of its records are already in the key store.
+     */
+    if ((baseRevision != revision) || (memcmp(guidBuf, thisGuid.GetBytes(), qcc::GUID128::SIZE) != 0)) {
+        QCC_DbgHLPrintf(("KeyStore::PullJournal ignoring stale journal (base revision %d)", baseRevision));
+        compact = true;
+        goto ExitPullJournal;
+    }
+    while (true) {
+        uint32_t recRevision;
+        uint32_t seq;
+        uint32_t salt;
+        uint32_t len;
+        status = PullExact(source, &recRevision, sizeof(recRevision));
+        if (status == ER_OK) {
+            status = PullExact(source, &seq, sizeof(seq));
+        }
+        if (status == ER_OK) {
+            status = PullExact(source, &salt, sizeof(salt));
+        }
+        if (status == ER_OK) {
+            status = PullExact(source, &len, sizeof(len));
+        }
+        if ((status == ER_OK) && ((len > MaxJournalRecordLen) || (recRevision <= baseRevision))) {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+        uint8_t* data = NULL;
+        if (status == ER_OK) {
+            data = new uint8_t[len];
+            status = PullExact(source, data, len);
+        }
+        size_t dataLen = len;
+        if (status == ER_OK) {
+            Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+            status = aes.Decrypt_CCM(data, data, dataLen, JournalNonce(recRevision, seq, salt), NULL, 0, 16);
+        }
+        if (status == ER_OK) {
+            StringSource strSource(data, dataLen);
+            uint8_t op;
+            uint32_t keyRevision;
+            size_t pulled;
+            status = strSource.PullBytes(&op, sizeof(op), pulled);
+            if (status == ER_OK) {
+                status = strSource.PullBytes(&keyRevision, sizeof(keyRevision), pulled);
+            }
+            if (status == ER_OK) {
+                status = strSource.PullBytes(guidBuf, qcc::GUID128::SIZE, pulled);
+            }
+            if (status == ER_OK) {
+                qcc::GUID128 guid;
+                guid.SetBytes(guidBuf);
+                if (op == JOURNAL_ADD_KEY) {
+                    KeyRecord keyRec;
+                    keyRec.revision = keyRevision;
+                    status = keyRec.key.Load(strSource);
+                    if (status == ER_OK) {
+                        status = strSource.PullBytes(&keyRec.accessRights, sizeof(keyRec.accessRights), pulled);
+                    }
+                    if (status == ER_OK) {
+                        (*keys)[guid] = keyRec;
+                    }
+                } else if (op == JOURNAL_DEL_KEY) {
+                    keys->erase(guid);
+                } else {
+                    status = ER_BUS_CORRUPT_KEYSTORE;
+                }
+                QCC_DbgPrintf(("KeyStore::PullJournal rev:%d op:%d GUID %s %s", recRevision, op, QCC_StatusText(status), guid.ToString().c_str()));
+            }
+        }
+        delete [] data;
+        if (status != ER_OK) {
+            break;
+        }
+        revision = max(revision, recRevision);
+        ++count;
+    }
+    if (status == ER_NONE) {
+        status = ER_OK;
+    } else {
+        /*
+         * A torn or damaged record ends the journal. This can happen if a write was interrupted so
+         * keep the changes up to that point and compact the key store on the next store.
+         */
+        QCC_LogError(status, ("Keystore journal is damaged after %u records", count));
+        compact = true;
+        status = ER_OK;
+    }
+    QCC_DbgHLPrintf(("KeyStore::PullJournal applied %u records (revision %d)", count, revision));
+    if (EraseExpiredKeys()) {
+        storeState = MODIFIED;
+    }
+
+ExitPullJournal:
+
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus KeyStore::PushJournal(Sink& sink, bool newJournal)
+{
+    size_t pushed;
+    QStatus status = ER_OK;
+
+    lock.Lock(MUTEX_CONTEXT);
+
+    if (newJournal) {
+        status = sink.PushBytes(&KeyStoreJournalVersion, sizeof(KeyStoreJournalVersion), pushed);
+        if (status == ER_OK) {
+            status = sink.PushBytes(&revision, sizeof(revision), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink.PushBytes(thisGuid.GetBytes(), qcc::GUID128::SIZE, pushed);
+        }
+    }
+    /*
+     * All records in a batch share the new revision number and salt, the sequence number within the
+     * batch keeps the encryption nonces unique.
+     */
+    ++revision;
+    uint32_t salt;
+    if (status == ER_OK) {
+        status = Crypto_GetRandomBytes((uint8_t*)&salt, sizeof(salt));
+    }
+
+    QCC_DbgHLPrintf(("KeyStore::PushJournal (revision %d) %u changed %u deleted", revision, dirty.size(), deletions.size()));
+
+    uint32_t seq = 0;
+    std::set<qcc::GUID128>::iterator it = dirty.begin();
+    std::set<qcc::GUID128>::iterator itDel = deletions.begin();
+    while ((status == ER_OK) && ((it != dirty.end()) || (itDel != deletions.end()))) {
+        StringSink strSink;
+        uint8_t op;
+        KeyMap::iterator key;
+        if (it != dirty.end()) {
+            key = keys->find(*it++);
+            /* Key may have expired since it was added */
+            if (key == keys->end()) {
+                continue;
+            }
+            op = JOURNAL_ADD_KEY;
+            strSink.PushBytes(&op, sizeof(op), pushed);
+            strSink.PushBytes(&key->second.revision, sizeof(key->second.revision), pushed);
+            strSink.PushBytes(key->first.GetBytes(), qcc::GUID128::SIZE, pushed);
+            key->second.key.Store(strSink);
+            strSink.PushBytes(&key->second.accessRights, sizeof(key->second.accessRights), pushed);
+        } else {
+            const qcc::GUID128& guid = *itDel++;
+            /* A merge may have brought back a key that was deleted */
+            if (keys->count(guid) != 0) {
+                continue;
+            }
+            uint32_t rev = revision;
+            op = JOURNAL_DEL_KEY;
+            strSink.PushBytes(&op, sizeof(op), pushed);
+            strSink.PushBytes(&rev, sizeof(rev), pushed);
+            strSink.PushBytes(guid.GetBytes(), qcc::GUID128::SIZE, pushed);
+        }
+        /*
+         * Encrypt the record
+         */
+        size_t dataLen = strSink.GetString().size();
+        uint8_t* data = new uint8_t[dataLen + 16];
+        Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+        status = aes.Encrypt_CCM(strSink.GetString().data(), data, dataLen, JournalNonce(revision, seq, salt), NULL, 0, 16);
+        uint32_t len = dataLen;
+        if (status == ER_OK) {
+            status = sink.PushBytes(&revision, sizeof(revision), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink.PushBytes(&seq, sizeof(seq), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink.PushBytes(&salt, sizeof(salt), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink.PushBytes(&len, sizeof(len), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink.PushBytes(data, len, pushed);
+        }
+        delete [] data;
+        ++seq;
+    }
+    if (status == ER_OK) {
+        storeState = LOADED;
+        dirty.clear();
+        deletions.clear();
+    }
+    if (stored) {
+        stored->SetEvent();
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
 QStatus KeyStore::GetKey(const qcc::GUID128& guid, KeyBlob& key, uint8_t accessRights[4])
 {
     if (storeState == UNAVAILABLE) {
@@ -651,6 +1179,7 @@ QStatus KeyStore::AddKey(const qcc::GUID128& guid, const KeyBlob& key, const uin
     memcpy(&keyRec.accessRights, accessRights, sizeof(accessRights));
     storeState = MODIFIED;
     deletions.erase(guid);
+    dirty.insert(guid);
     lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
@@ -665,8 +1194,10 @@ QStatus KeyStore::DelKey(const qcc::GUID128& guid)
     keys->erase(guid);
     storeState = MODIFIED;
     deletions.insert(guid);
+    dirty.erase(guid);
     lock.Unlock(MUTEX_CONTEXT);
-    listener->StoreRequest(*this);
+    /* Merge changes made by other processes before the deletion is written */
+    StoreInternal();
     return ER_OK;
 }
 
@@ -679,14 +1210,19 @@ QStatus KeyStore::SetKeyExpiration(const qcc::GUID128& guid, const Timespec& exp
     lock.Lock(MUTEX_CONTEXT);
     QCC_DbgPrintf(("KeyStore::SetExpiration %s", guid.ToString().c_str()));
     if (keys->count(guid) != 0) {
-        (*keys)[guid].key.SetExpiration(expiration);
+        KeyRecord& keyRec = (*keys)[guid];
+        keyRec.key.SetExpiration(expiration);
+        /* Like AddKey() so a reload keeps the new expiration */
+        keyRec.revision = revision + 1;
         storeState = MODIFIED;
+        dirty.insert(guid);
     } else {
         status = ER_BUS_KEY_UNAVAILABLE;
     }
     lock.Unlock(MUTEX_CONTEXT);
     if (status == ER_OK) {
-        listener->StoreRequest(*this);
+        /* Merge changes made by other processes before the change is written */
+        StoreInternal();
     }
     return status;
 }
@@ -36,6 +36,7 @@
 #include <qcc/Mutex.h>
 #include <qcc/Stream.h>
 #include <qcc/Event.h>
+#include <qcc/Timer.h>
 #include <qcc/time.h>
 
 #include <alljoyn/KeyStoreListener.h>
@@ -50,9 +51,15 @@ namespace ajn {
  * The %KeyStore class manages the storing and loading of key blobs from
  * external storage.
  */
-class KeyStore {
+class KeyStore : public qcc::AlarmListener {
   public:
 
+    /**
+     * Default time window in milliseconds over which bursts of store requests are coalesced
+     * into a single write.
+     */
+    static const uint32_t DEFAULT_STORE_COALESCE_WINDOW = 200;
+
     /**
      * KeyStore constructor
      */
@@ -74,10 +81,22 @@ class KeyStore {
     QStatus Init(const char* fileName, bool isShared);
 
     /**
-     * Requests the key store listener to store the contents of the key store
+     * Requests the key store listener to store the contents of the key store. If a store timer has
+     * been set and the key store was stored less than the coalescing window ago the store is
+     * deferred until the window expires so that a burst of changes is written out once.
      */
     QStatus Store();
 
+    /**
+     * Set a timer for deferring store requests. Without a timer every call to Store() writes the
+     * key store immediately.
+     *
+     * @param timer           The timer to schedule deferred stores on or NULL to disable coalescing.
+     *                        The timer must be stopped before the key store is destroyed.
+     * @param coalesceWindow  Minimum interval in milliseconds between two writes of the key store.
+     */
+    void SetStoreTimer(qcc::Timer* timer, uint32_t coalesceWindow = DEFAULT_STORE_COALESCE_WINDOW);
+
     /**
      * Re-read keys from the key store. This is a no-op unless the key store is shared.
      * If the key store is shared the key store is reloaded merging any changes made by
@@ -243,6 +262,44 @@ class KeyStore {
      */
     QStatus Push(qcc::Sink& sink);
 
+    /**
+     * Pull a journal of incremental key store changes from a source and apply them on top of the
+     * keys loaded by the most recent call to Pull(). A journal is only applied if it was written
+     * against the revision of the key store that was pulled, otherwise it is stale and is ignored.
+     * A truncated or corrupt record ends the replay, changes up to that record are kept.
+     *
+     * @param source   The source to read the journal from.
+     * @param compact  Returns true if the journal was stale or damaged and the key store should
+     *                 be compacted by the next store request.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PullJournal(qcc::Source& source, bool& compact);
+
+    /**
+     * Push the keys that have been added, changed, or deleted since the last push to a sink as a
+     * batch of individually encrypted journal records. This increments the key store revision
+     * just like Push() does.
+     *
+     * @param sink        The sink to write the journal records to.
+     * @param newJournal  If true the journal header is written ahead of the records. The header
+     *                    binds the journal to the current key store revision.
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PushJournal(qcc::Sink& sink, bool newJournal);
+
+    /**
+     * Indicates if the next store must write the entire key store rather than a journal of
+     * changes. This is the case if the key store was never written, failed to load, or was cleared.
+     *
+     * @return  Returns true if the complete key store must be pushed.
+     */
+    bool NeedsFullStore() { return fullStoreRequired; }
+
     /**
      * Indicates if this is a shared key store.
      *
@@ -277,6 +334,16 @@ class KeyStore {
      */
     QStatus Load();
 
+    /**
+     * Internal Store function
+     */
+    QStatus StoreInternal();
+
+    /**
+     * Timer callback for deferred store requests.
+     */
+    void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
+
     /**
      * The application that owns this key store. If the key store is shared this will be the name
      * of a suite of applications.
@@ -318,6 +385,16 @@ class KeyStore {
      */
     std::set<qcc::GUID128> deletions;
 
+    /**
+     * GUID for keys that have been added or changed since the key store was last pushed
+     */
+    std::set<qcc::GUID128> dirty;
+
+    /**
+     * Indicates the next store must push the entire key store instead of a journal
+     */
+    bool fullStoreRequired;
+
     /**
      * Default listener for handling load/store requests
      */
@@ -362,6 +439,31 @@ class KeyStore {
      * Event for synchronizing load requests
      */
     qcc::Event* loaded;
+
+    /**
+     * Timer for deferred store requests
+     */
+    qcc::Timer* storeTimer;
+
+    /**
+     * Minimum interval between two writes of the key store
+     */
+    uint32_t coalesceWindow;
+
+    /**
+     * Timestamp of the last write of the key store
+     */
+    uint32_t lastStoreTime;
+
+    /**
+     * Indicates a deferred store is scheduled on the store timer
+     */
+    bool storePending;
+
+    /**
+     * Mutex to serialize deferred stores with stores requested by the application
+     */
+    qcc::Mutex storeLock;
 };
 
 }
@@ -0,0 +1,218 @@
+/**
+ * @file
+ * Implementation of the LZCodec
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/Debug.h>
+
+#include <string.h>
+
+#include "LZCodec.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+namespace ajn {
+
+/*
+ * Shortest back reference worth encoding
+ */
+static const size_t MIN_MATCH = 4;
+
+/*
+ * Back references are encoded as a 16 bit offset
+ */
+static const size_t MAX_OFFSET = 0xFFFF;
+
+/*
+ * The hash table is indexed by the hash of the next MIN_MATCH bytes
+ */
+static const uint32_t HASH_BITS = 12;
+
+/*
+ * Value of a nibble that indicates extension bytes follow
+ */
+static const size_t RUN_MASK = 15;
+
+static inline uint32_t Read32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t Hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static inline uint8_t* PutExtension(uint8_t* op, size_t len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/*
+ * Emit a sequence of literals optionally followed by a back reference. Returns NULL if the
+ * sequence does not fit in the output buffer.
+ */
+static uint8_t* PutSequence(uint8_t* op, const uint8_t* oend, const uint8_t* lit, size_t litLen, size_t matchLen, size_t offset, bool last)
+{
+    size_t need = 1 + litLen + (litLen / 255) + 1;
+    if (!last) {
+        need += 2 + (matchLen / 255) + 1;
+    }
+    if (need > (size_t)(oend - op)) {
+        return NULL;
+    }
+    uint8_t* token = op++;
+    *token = (uint8_t)(((litLen < RUN_MASK) ? litLen : RUN_MASK) << 4);
+    if (litLen >= RUN_MASK) {
+        op = PutExtension(op, litLen - RUN_MASK);
+    }
+    memcpy(op, lit, litLen);
+    op += litLen;
+    if (!last) {
+        *op++ = (uint8_t)(offset);
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)((matchLen < RUN_MASK) ? matchLen : RUN_MASK);
+        if (matchLen >= RUN_MASK) {
+            op = PutExtension(op, matchLen - RUN_MASK);
+        }
+    }
+    return op;
+}
+
+/*
+ * Read extension bytes and add them to a length. Returns false if the input is exhausted.
+ */
+static inline bool GetExtension(const uint8_t*& ip, const uint8_t* iend, size_t& len)
+{
+    uint8_t b;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+size_t LZCodec::Compress(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstLen)
+{
+    /*
+     * Positions are stored plus one so zero means an empty slot
+     */
+    uint32_t table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* iend = src + srcLen;
+    const uint8_t* mflimit = (srcLen > MIN_MATCH) ? iend - MIN_MATCH : src;
+    uint8_t* op = dst;
+    const uint8_t* oend = dst + dstLen;
+
+    while (ip < mflimit) {
+        uint32_t seq = Read32(ip);
+        uint32_t h = Hash(seq);
+        const uint8_t* ref = table[h] ? src + table[h] - 1 : NULL;
+        table[h] = (uint32_t)(ip - src) + 1;
+        if (!ref || ((size_t)(ip - ref) > MAX_OFFSET) || (Read32(ref) != seq)) {
+            ++ip;
+            continue;
+        }
+        /*
+         * Extend the match as far as it goes
+         */
+        const uint8_t* mp = ip + MIN_MATCH;
+        const uint8_t* rp = ref + MIN_MATCH;
+        while ((mp < iend) && (*mp == *rp)) {
+            ++mp;
+            ++rp;
+        }
+        op = PutSequence(op, oend, anchor, ip - anchor, (mp - ip) - MIN_MATCH, ip - ref, false);
+        if (!op) {
+            return 0;
+        }
+        ip = mp;
+        anchor = ip;
+    }
+    op = PutSequence(op, oend, anchor, iend - anchor, 0, 0, true);
+    return op ? (op - dst) : 0;
+}
+
+QStatus LZCodec::Decompress(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstLen, size_t& outLen)
+{
+    const uint8_t* ip = src;
+    const uint8_t* iend = src + srcLen;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + dstLen;
+
+    while (true) {
+        if (ip >= iend) {
+            break;
+        }
+        uint8_t token = *ip++;
+        size_t litLen = token >> 4;
+        if ((litLen == RUN_MASK) && !GetExtension(ip, iend, litLen)) {
+            break;
+        }
+        if ((litLen > (size_t)(iend - ip)) || (litLen > (size_t)(oend - op))) {
+            break;
+        }
+        memcpy(op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+        /*
+         * The last sequence only has literals
+         */
+        if (ip == iend) {
+            outLen = op - dst;
+            return ER_OK;
+        }
+        if ((iend - ip) < 2) {
+            break;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t matchLen = token & RUN_MASK;
+        if ((matchLen == RUN_MASK) && !GetExtension(ip, iend, matchLen)) {
+            break;
+        }
+        matchLen += MIN_MATCH;
+        if ((offset == 0) || (offset > (size_t)(op - dst)) || (matchLen > (size_t)(oend - op))) {
+            break;
+        }
+        /*
+         * Matches can overlap the bytes being written so copy one byte at a time
+         */
+        const uint8_t* ref = op - offset;
+        while (matchLen--) {
+            *op++ = *ref++;
+        }
+    }
+    QCC_DbgHLPrintf(("LZCodec::Decompress malformed input at offset %u", (uint32_t)(ip - src)));
+    return ER_BUS_BAD_COMPRESSED_BODY;
+}
+
+}
@@ -0,0 +1,90 @@
+/**
+ * @file
+ * A small fast LZ77 family codec used for compressing message bodies
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_LZCODEC_H
+#define _ALLJOYN_LZCODEC_H
+
+#ifndef __cplusplus
+#error Only include LZCodec.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * The LZCodec compresses a block of bytes into a sequence of literal runs and back references into
+ * the previous 64K of data. The encoding favors speed over compression ratio, it is intended for
+ * shrinking message bodies on slow links where a few microseconds of CPU time per message is much
+ * cheaper than the time it takes to transmit the extra bytes.
+ *
+ * Each sequence starts with a token byte, the high nibble is the literal count and the low nibble is
+ * the match length less the minimum match. A nibble value of 15 is followed by extension bytes that
+ * are added to the count, a 255 extension byte means another extension byte follows. The literal
+ * bytes follow the token and then a 16 bit little endian back reference offset. The final sequence
+ * only has literals.
+ */
+class LZCodec {
+  public:
+
+    /**
+     * Get the size of the buffer needed to compress data of a given length in the worst case
+     * (incompressible data).
+     *
+     * @param len  The length of the data to compress.
+     *
+     * @return The maximum compressed size.
+     */
+    static size_t MaxCompressedLen(size_t len) { return len + (len / 255) + 16; }
+
+    /**
+     * Compress a block of data.
+     *
+     * @param src     The data to compress.
+     * @param srcLen  The length of the data to compress.
+     * @param dst     Buffer to receive the compressed data.
+     * @param dstLen  The size of the dst buffer.
+     *
+     * @return  The length of the compressed data or 0 if the compressed data didn't fit in dst.
+     */
+    static size_t Compress(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstLen);
+
+    /**
+     * Decompress a block of data. The compressed data is untrusted so every length and offset
+     * is checked against the bounds of the source and destination buffers.
+     *
+     * @param src     The compressed data.
+     * @param srcLen  The length of the compressed data.
+     * @param dst     Buffer to receive the decompressed data.
+     * @param dstLen  The size of the dst buffer.
+     * @param outLen  Returns the length of the decompressed data.
+     *
+     * @return
+     *      - ER_OK if the data was decompressed.
+     *      - ER_BUS_BAD_COMPRESSED_BODY if the compressed data is malformed or doesn't fit in dst.
+     */
+    static QStatus Decompress(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstLen, size_t& outLen);
+};
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include <qcc/platform.h>
 
 #include <list>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/GUID.h>
@@ -30,6 +31,7 @@
 #include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
 #include <qcc/atomic.h>
+#include <qcc/time.h>
 
 #include <alljoyn/DBusStd.h>
 #include <alljoyn/AllJoynStd.h>
@@ -95,6 +97,7 @@ LocalEndpoint::LocalEndpoint(BusAttachment& bus) :
     bus(bus),
     objectsLock(),
     replyMapLock(),
+    replyAlarmTime(0),
     dbusObj(NULL),
     alljoynObj(NULL),
     alljoynDebugObj(NULL),
@@ -487,61 +490,88 @@ QStatus LocalEndpoint::RegisterReplyHandler(MessageReceiver* receiver,
         status = ER_BUS_STOPPING;
         QCC_LogError(status, ("Local transport not running"));
     } else {
-        ReplyContext reply = {
+        ReplyTable::Context reply = {
             receiver,
             replyHandler,
             &method,
             secure,
-            context,
-            Alarm(timeout, this, 0, (void*)(size_t)serial)
+            context
         };
         QCC_DbgPrintf(("LocalEndpoint::RegisterReplyHandler - Adding serial=%u", serial));
+        Alarm alarm;
         replyMapLock.Lock(MUTEX_CONTEXT);
-        replyMap.insert(pair<uint32_t, ReplyContext>(serial, reply));
+        replyMap.Add(serial, reply, timeout, GetTimestamp64());
+        bool setAlarm = NextReplyAlarm(alarm);
         replyMapLock.Unlock(MUTEX_CONTEXT);
 
-        /* Set a timeout */
-        status = bus.GetInternal().GetTimer().AddAlarm(reply.alarm);
-        if (status != ER_OK) {
-            UnregisterReplyHandler(serial);
+        /* Set a timeout, adding an alarm can block so it is not done while holding replyMapLock */
+        if (setAlarm) {
+            status = AddReplyAlarm(alarm);
+            if (status != ER_OK) {
+                replyMapLock.Lock(MUTEX_CONTEXT);
+                replyMap.Remove(serial, reply);
+                replyMapLock.Unlock(MUTEX_CONTEXT);
+            }
+        }
+    }
+    return status;
+}
+
+bool LocalEndpoint::NextReplyAlarm(Alarm& alarm)
+{
+    uint64_t next = replyMap.NextTimeout();
+    /*
+     * One alarm drives all the reply timeouts. It is only replaced when an earlier timeout is
+     * added, the alarm it replaces is left to fire and is ignored. This avoids removing alarms.
+     */
+    if (!next || (replyAlarmTime && (next >= replyAlarmTime))) {
+        return false;
+    }
+    uint64_t now = GetTimestamp64();
+    uint32_t delay = (next > now) ? (uint32_t)(next - now) : 0;
+    alarm = Alarm(delay, this, 0, &replyMap);
+    replyAlarm = alarm;
+    replyAlarmTime = next;
+    return true;
+}
+
+QStatus LocalEndpoint::AddReplyAlarm(const Alarm& alarm)
+{
+    QStatus status = bus.GetInternal().GetTimer().AddAlarm(alarm);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set alarm for method reply timeouts"));
+        /* The next alarm to fire or reply handler to be registered sets a new alarm */
+        replyMapLock.Lock(MUTEX_CONTEXT);
+        if (alarm.iden(replyAlarm)) {
+            replyAlarmTime = 0;
         }
+        replyMapLock.Unlock(MUTEX_CONTEXT);
     }
     return status;
 }
 
 bool LocalEndpoint::UnregisterReplyHandler(uint32_t serial)
 {
+    ReplyTable::Context rc;
     replyMapLock.Lock(MUTEX_CONTEXT);
-    map<uint32_t, ReplyContext>::iterator iter = replyMap.find(serial);
-    if (iter != replyMap.end()) {
-        QCC_DbgPrintf(("LocalEndpoint::UnregisterReplyHandler - Removing serial=%u", serial));
-        ReplyContext rc = iter->second;
-        replyMap.erase(iter);
-        replyMapLock.Unlock(MUTEX_CONTEXT);
-        bus.GetInternal().GetTimer().RemoveAlarm(rc.alarm);
-        return true;
-    } else {
-        replyMapLock.Unlock(MUTEX_CONTEXT);
-        return false;
+    bool removed = replyMap.Remove(serial, rc);
+    replyMapLock.Unlock(MUTEX_CONTEXT);
+    if (removed) {
+        QCC_DbgPrintf(("LocalEndpoint::UnregisterReplyHandler - Removed serial=%u", serial));
     }
+    return removed;
 }
 
 QStatus LocalEndpoint::ExtendReplyHandlerTimeout(uint32_t serial, uint32_t extension)
 {
-    QStatus status;
-    replyMapLock.Lock();
-    map<uint32_t, ReplyContext>::iterator iter = replyMap.find(serial);
-    if (iter != replyMap.end()) {
+    QStatus status = ER_OK;
+    replyMapLock.Lock(MUTEX_CONTEXT);
+    if (replyMap.Extend(serial, extension)) {
         QCC_DbgPrintf(("LocalEndpoint::ExtendReplyHandlerTimeout - extending timeout for serial=%u", serial));
-        Alarm newAlarm(Timespec(iter->second.alarm.GetAlarmTime() + extension), this, 0, (void*)(size_t)serial);
-        status = bus.GetInternal().GetTimer().ReplaceAlarm(iter->second.alarm, newAlarm, false);
-        if (status == ER_OK) {
-            iter->second.alarm = newAlarm;
-        }
     } else {
         status = ER_BUS_UNKNOWN_SERIAL;
     }
-    replyMapLock.Unlock();
+    replyMapLock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
@@ -591,18 +621,7 @@ QStatus LocalEndpoint::UnregisterAllHandlers(MessageReceiver* receiver)
      * Remove any reply handlers for this receiver
      */
     replyMapLock.Lock(MUTEX_CONTEXT);
-    bool removed;
-    do {
-        removed = false;
-        for (map<uint32_t, ReplyContext>::iterator iter = replyMap.begin(); iter != replyMap.end(); ++iter) {
-            if (iter->second.object == receiver) {
-                bus.GetInternal().GetTimer().RemoveAlarm(iter->second.alarm);
-                replyMap.erase(iter);
-                removed = true;
-                break;
-            }
-        }
-    } while (removed);
+    replyMap.RemoveAll(receiver);
     replyMapLock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
@@ -612,24 +631,48 @@ void LocalEndpoint::AlarmTriggered(const Alarm& alarm, QStatus reason)
     /*
      * Alarms are used for two unrelated purposes within LocalEnpoint:
      *
-     * When context is non-NULL, the alarm indicates that a method call
-     * with serial == *context has timed out.
+     * When context is the reply map, the alarm indicates that method calls
+     * may have timed out.
      *
      * When context is NULL, the alarm indicates that the BusAttachment that this
      * LocalEndpoint is a part of is connected to a daemon and any previously
      * unregistered BusObjects should be registered
      */
-    if (NULL != alarm.GetContext()) {
-        uint32_t serial = reinterpret_cast<uintptr_t>(alarm.GetContext());
-        Message msg(bus);
-        QCC_DbgPrintf(("Timed out waiting for METHOD_REPLY with serial %d", serial));
-
+    if (alarm.GetContext() == &replyMap) {
+        vector<uint32_t> expired;
+        uint64_t now = GetTimestamp64();
+        Alarm nextAlarm;
+        bool setAlarm = false;
+        replyMapLock.Lock(MUTEX_CONTEXT);
         if (reason == ER_TIMER_EXITING) {
-            msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
+            replyMap.ExpireAll(expired);
         } else {
-            msg->ErrorMsg("org.alljoyn.Bus.Timeout", serial);
+            replyMap.Expire(now, expired);
+        }
+        /*
+         * Only the current reply alarm sets the alarm for the next timeout. An alarm that was
+         * replaced by an earlier one just expires replies.
+         */
+        if ((reason != ER_TIMER_EXITING) && (!replyAlarmTime || alarm.iden(replyAlarm))) {
+            replyAlarmTime = 0;
+            setAlarm = NextReplyAlarm(nextAlarm);
+        }
+        replyMapLock.Unlock(MUTEX_CONTEXT);
+        if (setAlarm) {
+            AddReplyAlarm(nextAlarm);
+        }
+
+        /* Timeouts are reported to the reply handlers as error replies */
+        for (size_t i = 0; i < expired.size(); ++i) {
+            Message msg(bus);
+            QCC_DbgPrintf(("Timed out waiting for METHOD_REPLY with serial %d", expired[i]));
+            if (reason == ER_TIMER_EXITING) {
+                msg->ErrorMsg("org.alljoyn.Bus.Exiting", expired[i]);
+            } else {
+                msg->ErrorMsg("org.alljoyn.Bus.Timeout", expired[i]);
+            }
+            HandleMethodReply(msg);
         }
-        HandleMethodReply(msg);
     } else {
         /* Call ObjectRegistered for any unregistered bus object */
         objectsLock.Lock(MUTEX_CONTEXT);
@@ -665,7 +708,7 @@ void LocalEndpoint::AlarmTriggered(const Alarm& alarm, QStatus reason)
  */
 class MethodCallRunnable : public Runnable {
   public:
-    MethodCallRunnable(LocalEndpoint* ep, const MethodTable::Entry* entry, Message message)
+    MethodCallRunnable(LocalEndpoint* ep, const MethodTable::Entry& entry, Message message)
         : ep(ep), entry(entry), message(message)
     {
         QCC_DbgHLPrintf(("MethodCallRunnable::MethodCallRunnable(): New closure for method call"));
@@ -679,7 +722,7 @@ class MethodCallRunnable : public Runnable {
 
   private:
     LocalEndpoint* ep;
-    const MethodTable::Entry* entry;
+    MethodTable::Entry entry;
     Message message;
 };
 
@@ -691,10 +734,12 @@ QStatus LocalEndpoint::HandleMethodCall(Message& message)
     bool isLocalSender = bus.GetInternal().GetRouter().FindEndpoint(message->GetSender()) == this;
 
     /* Look up the member */
-    const MethodTable::Entry* entry = methodTable.Find(message->GetObjectPath(),
-                                                       message->GetInterface(),
-                                                       message->GetMemberName());
-    if (entry == NULL) {
+    MethodTable::Entry entry;
+    bool found = methodTable.Find(message->GetObjectPath(),
+                                  message->GetInterface(),
+                                  message->GetMemberName(),
+                                  entry);
+    if (!found) {
         if (strcmp(message->GetInterface(), org::freedesktop::DBus::Peer::InterfaceName) == 0) {
             /*
              * Special case the Peer interface
@@ -706,16 +751,16 @@ QStatus LocalEndpoint::HandleMethodCall(Message& message)
              */
             status = Diagnose(message);
         }
-    } else if (entry->member->iface->IsSecure() && !message->IsEncrypted()) {
+    } else if (entry.member->iface->IsSecure() && !message->IsEncrypted()) {
         status = ER_BUS_MESSAGE_NOT_ENCRYPTED;
         QCC_LogError(status, ("Method call to secure interface was not encrypted"));
     } else {
-        status = message->UnmarshalArgs(entry->member->signature, entry->member->returnSignature.c_str());
+        status = message->UnmarshalArgs(entry.member->signature, entry.member->returnSignature.c_str());
     }
     if (status == ER_OK) {
         /* Call the method handler */
-        if (entry) {
-            if (bus.GetInternal().GetRouter().IsDaemon() || entry->member->accessPerms.size() == 0) {
+        if (found) {
+            if (bus.GetInternal().GetRouter().IsDaemon() || entry.member->accessPerms.size() == 0) {
                 /*
                  * We cannot make method calls coming in from the local endpoint
                  * on another thread since our code depends on using recursive
@@ -723,7 +768,7 @@ QStatus LocalEndpoint::HandleMethodCall(Message& message)
                  * creates necessary and sufficient conditions for deadlock.
                  */
                 if (isLocalSender) {
-                    entry->object->CallMethodHandler(entry->handler, entry->member, message, entry->context);
+                    entry.object->CallMethodHandler(entry.handler, entry.member, message, entry.context);
                 } else {
                     Ptr<MethodCallRunnable> runnable = NewPtr<MethodCallRunnable>(this, entry, message);
                     for (;;) {
@@ -742,7 +787,7 @@ QStatus LocalEndpoint::HandleMethodCall(Message& message)
                 }
             } else {
 #if defined(QCC_OS_ANDROID)
-                QCC_DbgPrintf(("Method(%s::%s) requires permission %s", message->GetInterface(), message->GetMemberName(), entry->member->accessPerms.c_str()));
+                QCC_DbgPrintf(("Method(%s::%s) requires permission %s", message->GetInterface(), message->GetMemberName(), entry.member->accessPerms.c_str()));
                 chkMsgListLock.Lock(MUTEX_CONTEXT);
                 PermCheckedEntry permChkEntry(message->GetSender(), message->GetObjectPath(), message->GetInterface(), message->GetMemberName());
                 std::map<PermCheckedEntry, bool>::const_iterator it = permCheckedCallMap.find(permChkEntry);
@@ -750,7 +795,7 @@ QStatus LocalEndpoint::HandleMethodCall(Message& message)
                     if (permCheckedCallMap[permChkEntry]) {
                         /* Don't multithread method calls originating locally.  See comment in similar code above */
                         if (isLocalSender) {
-                            entry->object->CallMethodHandler(entry->handler, entry->member, message, entry->context);
+                            entry.object->CallMethodHandler(entry.handler, entry.member, message, entry.context);
                         } else {
                             Ptr<MethodCallRunnable> runnable = NewPtr<MethodCallRunnable>(this, entry, message);
                             for (;;) {
@@ -782,7 +827,7 @@ QStatus LocalEndpoint::HandleMethodCall(Message& message)
                         }
                     }
                 } else {
-                    ChkPendingMsg msgInfo(message, entry, entry->member->accessPerms);
+                    ChkPendingMsg msgInfo(message, entry, entry.member->accessPerms);
                     chkPendingMsgList.push_back(msgInfo);
                     wakeEvent.SetEvent();
                 }
@@ -873,31 +918,19 @@ QStatus LocalEndpoint::HandleSignal(Message& message)
     /* Determine if the source of this message is local to the process */
     bool isLocalSender = bus.GetInternal().GetRouter().FindEndpoint(message->GetSender()) == this;
 
-    signalTable.Lock();
-
-    /* Look up the signal */
-    pair<SignalTable::const_iterator, SignalTable::const_iterator> range =
-        signalTable.Find(message->GetObjectPath(), message->GetInterface(), message->GetMemberName());
-
-    /*
-     * Quick exit if there are no handlers for this signal
-     */
-    if (range.first == range.second) {
-        signalTable.Unlock();
-        return ER_OK;
-    }
     /*
      * Build a list of all signal handlers for this signal
      */
     list<SignalTable::Entry> callList;
-    const InterfaceDescription::Member* signal = range.first->second.member;
-    do {
-        callList.push_back(range.first->second);
-    } while (++range.first != range.second);
+    signalTable.Find(message->GetObjectPath(), message->GetInterface(), message->GetMemberName(), callList);
+
     /*
-     * We have our callback list so we can unlock the signal table.
+     * Quick exit if there are no handlers for this signal
      */
-    signalTable.Unlock();
+    if (callList.empty()) {
+        return ER_OK;
+    }
+    const InterfaceDescription::Member* signal = callList.front().member;
     /*
      * Validate and unmarshal the signal
      */
@@ -996,13 +1029,11 @@ QStatus LocalEndpoint::HandleMethodReply(Message& message)
 {
     QStatus status = ER_OK;
 
+    ReplyTable::Context rc;
     replyMapLock.Lock(MUTEX_CONTEXT);
-    map<uint32_t, ReplyContext>::iterator iter = replyMap.find(message->GetReplySerial());
-    if (iter != replyMap.end()) {
-        ReplyContext rc = iter->second;
-        replyMap.erase(iter);
-        replyMapLock.Unlock(MUTEX_CONTEXT);
-        bus.GetInternal().GetTimer().RemoveAlarm(rc.alarm);
+    bool matched = replyMap.Remove(message->GetReplySerial(), rc);
+    replyMapLock.Unlock(MUTEX_CONTEXT);
+    if (matched) {
         if (rc.secure && !message->IsEncrypted()) {
             /*
              * If the response was an internally generated error response just keep that error.
@@ -1038,7 +1069,6 @@ QStatus LocalEndpoint::HandleMethodReply(Message& message)
         }
         ((rc.object)->*(rc.handler))(message, rc.context);
     } else {
-        replyMapLock.Unlock(MUTEX_CONTEXT);
         status = ER_BUS_UNMATCHED_REPLY_SERIAL;
         QCC_DbgHLPrintf(("%s does not match any current method calls: %s", message->Description().c_str(), QCC_StatusText(status)));
     }
@@ -1134,9 +1164,9 @@ void*  LocalEndpoint::PermVerifyThread::Run(void* arg)
                 AllJoynMessageType msgType = message->GetType();
                 if (msgType == MESSAGE_METHOD_CALL) {
                     if (allowed) {
-                        const MethodTable::Entry* entry = msgInfo.methodEntry;
+                        const MethodTable::Entry& entry = msgInfo.methodEntry;
                         /* Don't run on concurrency threadpool since we are separate thread anyway */
-                        entry->object->CallMethodHandler(entry->handler, entry->member, msgInfo.msg, entry->context);
+                        entry.object->CallMethodHandler(entry.handler, entry.member, msgInfo.msg, entry.context);
                     } else {
                         QCC_LogError(ER_ALLJOYN_ACCESS_PERMISSION_ERROR, ("Endpoint(%s) has no permission to call method (%s::%s)",
                                                                           message->GetSender(), message->GetInterface(), message->GetMemberName()));
@@ -47,6 +47,7 @@
 #include "CompressionRules.h"
 #include "MethodTable.h"
 #include "SignalTable.h"
+#include "ReplyTable.h"
 #include "Transport.h"
 
 #if defined(__GNUCC__) || defined (QCC_OS_DARWIN)
@@ -347,18 +348,6 @@ class LocalEndpoint : public BusEndpoint, public qcc::AlarmListener, public Mess
      */
     LocalEndpoint(const LocalEndpoint& other);
 
-    /**
-     * Type definition for a method call reply context
-     */
-    typedef struct {
-        MessageReceiver* object;                     /**< The object to receive the reply */
-        MessageReceiver::ReplyHandler handler;       /**< The receiving object's handler function */
-        const InterfaceDescription::Member* method;  /**< The method that was called */
-        bool secure;                                 /**< This wil be true if the method call was secure */
-        void* context;                               /**< The calling object's context */
-        qcc::Alarm alarm;                            /**< Alarm object for handling method call timeouts */
-    } ReplyContext;
-
     /**
      * Equality function for matching object paths
      */
@@ -370,9 +359,19 @@ class LocalEndpoint : public BusEndpoint, public qcc::AlarmListener, public Mess
     std::hash_map<const char*, BusObject*, std::hash<const char*>, PathEq> localObjects;
 
     /**
-     * Map from serial numbers for outstanding method calls to response handelers.
+     * Outstanding method calls and their timeouts by serial number.
+     */
+    ReplyTable replyMap;
+
+    /**
+     * Time from qcc::GetTimestamp64() of the earliest alarm set for replyMap timeouts, 0 if none is set.
+     */
+    uint64_t replyAlarmTime;
+
+    /**
+     * The alarm set for replyAlarmTime.
      */
-    std::map<uint32_t, ReplyContext> replyMap;
+    qcc::Alarm replyAlarm;
 
 #if defined(QCC_OS_ANDROID)
     /**
@@ -380,10 +379,10 @@ class LocalEndpoint : public BusEndpoint, public qcc::AlarmListener, public Mess
      */
     typedef struct ChkPendingMsg {
         Message msg;                                /**< The message pending for permission check */
-        const MethodTable::Entry* methodEntry;      /**< Method handler */
+        MethodTable::Entry methodEntry;             /**< Method handler */
         std::list<SignalTable::Entry> signalCallList;    /**< List of signal handlers */
         qcc::String perms;                          /**< The required permissions */
-        ChkPendingMsg(Message& msg, const MethodTable::Entry* methodEntry, const qcc::String& perms) : msg(msg), methodEntry(methodEntry), perms(perms) { }
+        ChkPendingMsg(Message& msg, const MethodTable::Entry& methodEntry, const qcc::String& perms) : msg(msg), methodEntry(methodEntry), perms(perms) { }
         ChkPendingMsg(Message& msg, std::list<SignalTable::Entry>& signalCallList, const qcc::String& perms) : msg(msg), signalCallList(signalCallList), perms(perms) { }
     } ChkPendingMsg;
 
@@ -486,6 +485,21 @@ class LocalEndpoint : public BusEndpoint, public qcc::AlarmListener, public Mess
      */
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
+    /**
+     * Check if an alarm must be set for the next reply timeout, called with replyMapLock held.
+     * The alarm is added to the timer by calling AddReplyAlarm() after replyMapLock is released.
+     *
+     * @param alarm  Returns the alarm to add.
+     *
+     * @return  true if the alarm must be added.
+     */
+    bool NextReplyAlarm(qcc::Alarm& alarm);
+
+    /**
+     * Add an alarm returned by NextReplyAlarm(), called without replyMapLock held.
+     */
+    QStatus AddReplyAlarm(const qcc::Alarm& alarm);
+
     /**
      * Inner utility method used bo RegisterBusObject.
      * Do not call this method externally.
@@ -501,9 +515,9 @@ class LocalEndpoint : public BusEndpoint, public qcc::AlarmListener, public Mess
      * bus objects with a bunch of seemingly random friends.  This is a private
      * method so we have to be friends with the closure (see immediately above).
      */
-    void DoCallMethodHandler(const MethodTable::Entry* entry, Message& message)
+    void DoCallMethodHandler(const MethodTable::Entry& entry, Message& message)
     {
-        entry->object->CallMethodHandler(entry->handler, entry->member, message, entry->context);
+        entry.object->CallMethodHandler(entry.handler, entry.member, message, entry.context);
     }
 };
 
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * This file implements signatures compiled into flat plans for marshaling and unmarshaling
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <list>
+#include <map>
+
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringMapKey.h>
+
+#include "MarshalPlan.h"
+#include "SignatureUtils.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+#define PadUp(n, i)   (((n) + (i) - 1) & ~((i) - 1))
+
+/*
+ * Enough for the signatures an application typically uses
+ */
+static const size_t MAX_CACHED_PLANS = 64;
+
+bool MarshalPlan::enabled = true;
+
+/*
+ * Plans ordered from most to least recently used, the cache holds a reference to each plan.
+ */
+class PlanCache {
+  public:
+    ~PlanCache()
+    {
+        for (list<const MarshalPlan*>::iterator it = lru.begin(); it != lru.end(); ++it) {
+            (*it)->Release();
+        }
+    }
+    map<StringMapKey, list<const MarshalPlan*>::iterator> plans;
+    list<const MarshalPlan*> lru;
+    Mutex lock;
+};
+
+static PlanCache planCache;
+
+MarshalPlan::Ref MarshalPlan::Get(const char* signature)
+{
+    if (!enabled || !signature || !*signature) {
+        return Ref();
+    }
+    Ref ref;
+    planCache.lock.Lock(MUTEX_CONTEXT);
+    map<StringMapKey, list<const MarshalPlan*>::iterator>::iterator it = planCache.plans.find(StringMapKey(signature));
+    if (it != planCache.plans.end()) {
+        planCache.lru.splice(planCache.lru.begin(), planCache.lru, it->second);
+        ref = Ref(*it->second);
+    } else {
+        MarshalPlan* plan = new MarshalPlan();
+        if (Compile(signature, *plan) == ER_OK) {
+            if (planCache.lru.size() >= MAX_CACHED_PLANS) {
+                const MarshalPlan* evict = planCache.lru.back();
+                planCache.plans.erase(StringMapKey(evict->signature));
+                planCache.lru.pop_back();
+                evict->Release();
+            }
+            plan->AddRef();
+            planCache.lru.push_front(plan);
+            planCache.plans[StringMapKey(plan->signature)] = planCache.lru.begin();
+            ref = Ref(plan);
+        } else {
+            delete plan;
+        }
+    }
+    planCache.lock.Unlock(MUTEX_CONTEXT);
+    return ref;
+}
+
+QStatus MarshalPlan::Compile(const char* signature, MarshalPlan& plan)
+{
+    QStatus status = ER_OK;
+
+    plan.signature = signature;
+    plan.steps.clear();
+    plan.numArgs = 0;
+    /*
+     * Check the nesting limits up front so compiling does not need to
+     */
+    if (!SignatureUtils::IsValidSignature(signature)) {
+        return ER_BUS_BAD_SIGNATURE;
+    }
+    const char* sigPtr = plan.signature.c_str();
+    while ((status == ER_OK) && *sigPtr) {
+        status = plan.CompileType(sigPtr, false);
+        ++plan.numArgs;
+    }
+    return status;
+}
+
+QStatus MarshalPlan::CompileType(const char*& sigPtr, bool arrayElem)
+{
+    QStatus status = ER_OK;
+    size_t index = steps.size();
+    Step step;
+
+    step.sigOffset = (uint8_t)(sigPtr - signature.c_str());
+    step.typeId = *sigPtr++;
+    step.argTypeId = (AllJoynTypeId)step.typeId;
+    step.alignment = (uint8_t)SignatureUtils::AlignmentForType(step.argTypeId);
+    steps.push_back(step);
+
+    switch (step.typeId) {
+    case ALLJOYN_BYTE:
+        step.fixedSize = 1;
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        step.fixedSize = 2;
+        break;
+
+    case ALLJOYN_BOOLEAN:
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+        step.fixedSize = 4;
+        break;
+
+    case ALLJOYN_DOUBLE:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_INT64:
+        step.fixedSize = 8;
+        break;
+
+    case ALLJOYN_OBJECT_PATH:
+    case ALLJOYN_STRING:
+    case ALLJOYN_SIGNATURE:
+    case ALLJOYN_VARIANT:
+    case ALLJOYN_HANDLE:
+        break;
+
+    case ALLJOYN_ARRAY:
+    {
+        const char* elemStart = sigPtr;
+        status = CompileType(sigPtr, true);
+        if (status == ER_OK) {
+            step.elemSig = qcc::String(elemStart, sigPtr - elemStart);
+            /*
+             * Arrays of fixed size scalars are held in a single MsgArg
+             */
+            if ((steps[index + 1].fixedSize != 0) && (steps[index + 1].typeId != ALLJOYN_STRUCT_OPEN)) {
+                step.argTypeId = (AllJoynTypeId)((steps[index + 1].typeId << 8) | ALLJOYN_ARRAY);
+            }
+        }
+    }
+    break;
+
+    case ALLJOYN_DICT_ENTRY_OPEN:
+        if (!arrayElem) {
+            status = ER_BUS_BAD_SIGNATURE;
+            break;
+        }
+        step.argTypeId = ALLJOYN_DICT_ENTRY;
+        status = CompileType(sigPtr, false);
+        if (status == ER_OK) {
+            status = CompileType(sigPtr, false);
+        }
+        if ((status == ER_OK) && (*sigPtr++ != ALLJOYN_DICT_ENTRY_CLOSE)) {
+            status = ER_BUS_BAD_SIGNATURE;
+        }
+        step.numMembers = 2;
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    {
+        step.argTypeId = ALLJOYN_STRUCT;
+        bool fixed = true;
+        while ((status == ER_OK) && (*sigPtr != ALLJOYN_STRUCT_CLOSE)) {
+            size_t member = steps.size();
+            status = CompileType(sigPtr, false);
+            ++step.numMembers;
+            fixed = fixed && (steps[member].fixedSize != 0);
+        }
+        ++sigPtr;
+        /*
+         * Lay out the members of a fixed layout struct. Structs are 8 byte aligned so the
+         * offsets are the same wherever the struct appears in a message.
+         */
+        if ((status == ER_OK) && fixed) {
+            uint32_t offset = 0;
+            for (size_t member = index + 1; member < steps.size(); member = steps[member].next) {
+                offset = PadUp(offset, (uint32_t)steps[member].alignment);
+                steps[member].offset = offset;
+                offset += steps[member].fixedSize;
+            }
+            step.fixedSize = offset;
+        }
+    }
+    break;
+
+    default:
+        status = ER_BUS_BAD_SIGNATURE;
+        break;
+    }
+    step.next = (uint16_t)steps.size();
+    steps[index] = step;
+    return status;
+}
+
+}
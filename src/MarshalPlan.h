@@ -0,0 +1,222 @@
+#ifndef _ALLJOYN_MARSHALPLAN_H
+#define _ALLJOYN_MARSHALPLAN_H
+/**
+ * @file
+ * This file defines signatures compiled into flat plans for marshaling and unmarshaling
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include MarshalPlan.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/atomic.h>
+
+#include <alljoyn/MsgArg.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * A %MarshalPlan is a message body signature compiled into a flat list of steps, one for each
+ * complete type in the signature, in the order the types appear in the signature. The members of
+ * a container immediately follow the container's step and each step records the index of the step
+ * after it so siblings can be visited without rescanning the signature.
+ *
+ * Structs made up only of fixed size scalars (and other such structs) have a fixed layout. The
+ * plan records their wire size and the offset of each member from the start of the struct so they
+ * can be marshaled and unmarshaled with a single bounds check.
+ *
+ * Plans are compiled on first use and cached by signature. The cache is bounded so a peer sending
+ * many distinct signatures cannot grow it without limit; when it is full the least recently used
+ * plan is evicted. Plans are reference counted so an evicted plan stays valid for as long as a
+ * caller holds a reference to it. Signatures that do not get a plan are handled by the
+ * interpreting marshaler.
+ */
+class MarshalPlan {
+  public:
+
+    /**
+     * A step in the plan.
+     */
+    struct Step {
+        char typeId;              /**< Signature character of the type, '(' for structs and '{' for dict entries */
+        uint8_t alignment;        /**< Wire alignment of the type */
+        uint8_t numMembers;       /**< Number of members of a struct or dict entry */
+        uint8_t sigOffset;        /**< Offset of the type in the plan's signature */
+        uint16_t next;            /**< Index of the step that follows this type and all its members */
+        AllJoynTypeId argTypeId;  /**< Type id of a MsgArg holding this type */
+        uint32_t fixedSize;       /**< Wire size if the type has a fixed layout, 0 otherwise */
+        uint32_t offset;          /**< Offset from the start of the enclosing fixed layout struct */
+        qcc::String elemSig;      /**< Element signature of an array */
+
+        Step() : typeId(0), alignment(1), numMembers(0), sigOffset(0), next(0), argTypeId(ALLJOYN_INVALID), fixedSize(0), offset(0) { }
+    };
+
+    /**
+     * A reference to a plan that keeps the plan valid while it is held.
+     */
+    class Ref {
+      public:
+        Ref() : plan(NULL) { }
+
+        Ref(const Ref& other) : plan(other.plan)
+        {
+            if (plan) {
+                plan->AddRef();
+            }
+        }
+
+        ~Ref()
+        {
+            if (plan) {
+                plan->Release();
+            }
+        }
+
+        Ref& operator=(const Ref& other)
+        {
+            if (other.plan) {
+                other.plan->AddRef();
+            }
+            if (plan) {
+                plan->Release();
+            }
+            plan = other.plan;
+            return *this;
+        }
+
+        operator const MarshalPlan*() const { return plan; }
+
+        const MarshalPlan* operator->() const { return plan; }
+
+      private:
+        friend class MarshalPlan;
+
+        /**
+         * Take a new reference to a plan.
+         */
+        explicit Ref(const MarshalPlan* p) : plan(p)
+        {
+            if (plan) {
+                plan->AddRef();
+            }
+        }
+
+        const MarshalPlan* plan;
+    };
+
+    /**
+     * Get the plan for a signature compiling it if it is not already cached. Signatures that
+     * cannot be compiled are not cached.
+     *
+     * @param signature  The signature.
+     *
+     * @return  A reference to the plan or a NULL reference if plans are disabled or the signature
+     *          is empty or invalid.
+     */
+    static Ref Get(const char* signature);
+
+    /**
+     * Enable or disable the use of plans. Plans are enabled by default. This is intended for
+     * benchmarking the plans against the interpreting marshaler.
+     *
+     * @param enable  true to use plans.
+     */
+    static void Enable(bool enable) { enabled = enable; }
+
+    /**
+     * Check if plans are enabled.
+     */
+    static bool IsEnabled() { return enabled; }
+
+    /**
+     * Compile a signature into a plan. Most callers want Get() which caches the result.
+     *
+     * @param signature  The signature.
+     * @param plan       [OUT] The compiled plan.
+     *
+     * @return
+     *      - #ER_OK if the signature was compiled.
+     *      - #ER_BUS_BAD_SIGNATURE if the signature is not valid for a message body.
+     */
+    static QStatus Compile(const char* signature, MarshalPlan& plan);
+
+    /**
+     * Get the signature this plan was compiled from.
+     */
+    const char* GetSignature() const { return signature.c_str(); }
+
+    /**
+     * Get the number of complete types in the signature.
+     */
+    size_t GetNumArgs() const { return numArgs; }
+
+    /**
+     * Get a step. The steps for the complete types of the signature start at index 0.
+     *
+     * @param index  The index of the step.
+     */
+    const Step& operator[](size_t index) const { return steps[index]; }
+
+    /**
+     * Construct an empty plan, see Compile().
+     */
+    MarshalPlan() : numArgs(0), refs(0) { }
+
+  private:
+
+    friend class PlanCache;
+
+    /**
+     * Plans are shared so they cannot be copied.
+     */
+    MarshalPlan(const MarshalPlan& other);
+    MarshalPlan& operator=(const MarshalPlan& other);
+
+    /**
+     * Compile one complete type appending its steps to the plan.
+     */
+    QStatus CompileType(const char*& sigPtr, bool arrayElem);
+
+    void AddRef() const { qcc::IncrementAndFetch(&refs); }
+
+    void Release() const
+    {
+        if (qcc::DecrementAndFetch(&refs) == 0) {
+            delete this;
+        }
+    }
+
+    static bool enabled;       /**< true if plans are used */
+
+    qcc::String signature;     /**< Signature the plan was compiled from */
+    std::vector<Step> steps;   /**< The steps of the plan */
+    size_t numArgs;            /**< Number of complete types in the signature */
+    mutable volatile int32_t refs; /**< References held by the cache and by callers */
+};
+
+}
+
+#endif
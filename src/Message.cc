@@ -309,7 +309,9 @@ _Message::_Message(BusAttachment& bus) :
     ttl(0),
     handles(NULL),
     numHandles(0),
-    encrypt(false)
+    encrypt(false),
+    rxTraceTime(0),
+    routeTraceTime(0)
 {
     msgHeader.msgType = MESSAGE_INVALID;
     msgHeader.endian = myEndian;
@@ -335,6 +337,8 @@ _Message::_Message(const _Message& other) :
     handles(other.numHandles ? new qcc::SocketFd[other.numHandles] : NULL),
     numHandles(other.numHandles),
     encrypt(other.encrypt),
+    rxTraceTime(other.rxTraceTime),
+    routeTraceTime(other.routeTraceTime),
     hdrFields(other.hdrFields)
 {
     // Copy msgBuf
@@ -389,6 +393,27 @@ QStatus _Message::ReMarshal(const char* senderName, bool newSerial)
      */
     uint8_t* _savBuf = _msgBuf;
 
+    MarshalHeader(msgHeader.bodyLen);
+    /*
+     * Copy in the body if there was one
+     */
+    if (msgHeader.bodyLen != 0) {
+        memcpy(bufPos, bodyPtr, msgHeader.bodyLen);
+    }
+    bodyPtr = bufPos;
+    bufPos += msgHeader.bodyLen;
+    bufEOD = bufPos;
+    /*
+     * Zero fill the pad at the end of the buffer
+     */
+    assert((size_t)(bufEOD - (uint8_t*)msgBuf) < bufSize);
+    memset(bufEOD, 0, (uint8_t*)msgBuf + bufSize - bufEOD);
+    delete [] _savBuf;
+    return ER_OK;
+}
+
+void _Message::MarshalHeader(size_t bodyLen)
+{
     /*
      * Compute the new header sizes
      */
@@ -397,7 +422,7 @@ QStatus _Message::ReMarshal(const char* senderName, bool newSerial)
      * Padding the end of the buffer ensures we can unmarshal a few bytes beyond the end of the
      * message reducing the places where we need to check for bufEOD when unmarshaling the body.
      */
-    bufSize = sizeof(msgHeader) + ((((msgHeader.headerLen + 7) & ~7) + msgHeader.bodyLen + 7) & ~7) + 8;
+    bufSize = sizeof(msgHeader) + ((((msgHeader.headerLen + 7) & ~7) + bodyLen + 7) & ~7) + 8;
     _msgBuf = new uint8_t[bufSize + 7];
     msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
     bufPos = (uint8_t*)msgBuf;
@@ -417,22 +442,6 @@ QStatus _Message::ReMarshal(const char* senderName, bool newSerial)
      */
     MarshalHeaderFields();
     assert(((size_t)bufPos & 7) == 0);
-    /*
-     * Copy in the body if there was one
-     */
-    if (msgHeader.bodyLen != 0) {
-        memcpy(bufPos, bodyPtr, msgHeader.bodyLen);
-    }
-    bodyPtr = bufPos;
-    bufPos += msgHeader.bodyLen;
-    bufEOD = bufPos;
-    /*
-     * Zero fill the pad at the end of the buffer
-     */
-    assert((size_t)(bufEOD - (uint8_t*)msgBuf) < bufSize);
-    memset(bufEOD, 0, (uint8_t*)msgBuf + bufSize - bufEOD);
-    delete [] _savBuf;
-    return ER_OK;
 }
 
 bool _Message::IsExpired(uint32_t* tillExpireMS) const
@@ -0,0 +1,232 @@
+/**
+ * @file
+ * This file implements the per-message latency tracing and the latency histograms it records into
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_GROUP_WINDOWS)
+#include <windows.h>
+#elif defined(QCC_OS_DARWIN)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+#include <qcc/atomic.h>
+
+#include "EndpointStats.h"
+#include "MessageTrace.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/* Latencies below this have a bucket each */
+static const uint64_t LINEAR_LIMIT = 16;
+
+/* log2 of LINEAR_LIMIT */
+static const uint32_t LINEAR_BITS = 4;
+
+/* Each power of two above LINEAR_LIMIT is split into 2^SUB_BUCKET_BITS buckets */
+static const uint32_t SUB_BUCKET_BITS = 3;
+
+size_t LatencyHistogram::BucketIndex(uint64_t us)
+{
+    if (us < LINEAR_LIMIT) {
+        return (size_t)us;
+    }
+    if (us >= ((uint64_t)1 << 40)) {
+        return NUM_BUCKETS - 1;
+    }
+    /* Find the most significant bit */
+    uint32_t msb = LINEAR_BITS;
+    for (uint32_t shift = 32; shift > 0; shift >>= 1) {
+        if ((us >> (msb + shift)) != 0) {
+            msb += shift;
+        }
+    }
+    size_t index = LINEAR_LIMIT + ((msb - LINEAR_BITS) << SUB_BUCKET_BITS) +
+                   (size_t)((us >> (msb - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1));
+    return (index < NUM_BUCKETS) ? index : (NUM_BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t bucket)
+{
+    if (bucket < LINEAR_LIMIT) {
+        return bucket;
+    }
+    size_t i = bucket - LINEAR_LIMIT;
+    uint32_t msb = LINEAR_BITS + (uint32_t)(i >> SUB_BUCKET_BITS);
+    uint64_t sub = (1 << SUB_BUCKET_BITS) + (i & ((1 << SUB_BUCKET_BITS) - 1));
+    return sub << (msb - SUB_BUCKET_BITS);
+}
+
+void LatencyHistogram::Record(uint64_t us)
+{
+    IncrementAndFetch(&counts[BucketIndex(us)]);
+}
+
+void LatencyHistogram::Reset()
+{
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] = 0;
+    }
+}
+
+uint32_t LatencyHistogram::GetTotal() const
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        total += (uint32_t)counts[i];
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::GetPercentile(uint32_t percent) const
+{
+    uint64_t total = GetTotal();
+    if (total == 0) {
+        return 0;
+    }
+    /* Rank of the percentile latency counting from 1 */
+    uint64_t rank = (total * (percent < 100 ? percent : 100) + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += (uint32_t)counts[i];
+        if (seen >= rank) {
+            return (i + 1 < NUM_BUCKETS) ? (BucketLowerBound(i + 1) - 1) : BucketLowerBound(i);
+        }
+    }
+    return BucketLowerBound(NUM_BUCKETS - 1);
+}
+
+bool MessageTrace::enabled = false;
+
+MessageTrace::Histograms MessageTrace::busHistograms;
+
+void MessageTrace::Histograms::Record(Stage s, uint64_t start, uint64_t end)
+{
+    if (start && (end >= start)) {
+        stage[s].Record(end - start);
+        busHistograms.stage[s].Record(end - start);
+    }
+}
+
+void MessageTrace::Histograms::Reset()
+{
+    for (size_t s = 0; s < NUM_STAGES; ++s) {
+        stage[s].Reset();
+    }
+}
+
+uint64_t MessageTrace::Now()
+{
+    uint64_t us;
+#if defined(QCC_OS_GROUP_WINDOWS)
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER count;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&count);
+    us = (uint64_t)((count.QuadPart / freq.QuadPart) * 1000000 + ((count.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart);
+#elif defined(QCC_OS_DARWIN)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    us = (mach_absolute_time() * timebase.numer / timebase.denom) / 1000;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+    /* 0 means not timestamped */
+    return us ? us : 1;
+}
+
+void MessageTrace::Enable(bool enable)
+{
+    /* Endpoints registered after this point allocate their histograms when they register */
+    EndpointStats::Lock();
+    if (enable) {
+        for (EndpointStats::Iterator it = EndpointStats::Begin(); it != EndpointStats::End(); ++it) {
+            (*it)->CreateTraceHistograms();
+        }
+    }
+    enabled = enable;
+    EndpointStats::Unlock();
+}
+
+void MessageTrace::GetEndpointHistograms(std::vector<EndpointHistograms>& endpoints)
+{
+    EndpointStats::Lock();
+    endpoints.clear();
+    for (EndpointStats::Iterator it = EndpointStats::Begin(); it != EndpointStats::End(); ++it) {
+        endpoints.push_back(EndpointHistograms());
+        endpoints.back().name = (*it)->GetUniqueName();
+        if ((*it)->GetTraceHistograms()) {
+            endpoints.back().histograms = *(*it)->GetTraceHistograms();
+        }
+    }
+    EndpointStats::Unlock();
+}
+
+void MessageTrace::Reset()
+{
+    EndpointStats::Lock();
+    for (EndpointStats::Iterator it = EndpointStats::Begin(); it != EndpointStats::End(); ++it) {
+        if ((*it)->GetTraceHistograms()) {
+            (*it)->GetTraceHistograms()->Reset();
+        }
+    }
+    busHistograms.Reset();
+    EndpointStats::Unlock();
+}
+
+const char* MessageTrace::StageText(Stage s)
+{
+    switch (s) {
+    case RECEIVE:
+        return "receive";
+
+    case ROUTE:
+        return "route";
+
+    case TX_QUEUE:
+        return "tx queue";
+
+    case DELIVER:
+        return "deliver";
+
+    case TOTAL:
+        return "total";
+
+    default:
+        return "unknown";
+    }
+}
+
+}
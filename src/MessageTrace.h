@@ -0,0 +1,216 @@
+#ifndef _ALLJOYN_MESSAGETRACE_H
+#define _ALLJOYN_MESSAGETRACE_H
+/**
+ * @file
+ * This file defines the per-message latency tracing and the latency histograms it records into
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include MessageTrace.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+
+namespace ajn {
+
+/**
+ * %LatencyHistogram counts latencies in microseconds in log-linear buckets in the manner of an HDR
+ * histogram. Latencies below 16us have a bucket each, above that every power of two is split into
+ * 8 buckets so a bucket is never wider than 1/8 of its lower bound. Latencies of 2^27us (about 134
+ * seconds) and more are all counted in the last bucket.
+ *
+ * Recording uses atomic increments only so any number of threads can record into the same
+ * histogram without a lock. Readers see a consistent count per bucket but not necessarily across
+ * buckets while recording is in progress.
+ */
+class LatencyHistogram {
+  public:
+
+    /** Number of buckets */
+    static const size_t NUM_BUCKETS = 200;
+
+    /**
+     * Constructor
+     */
+    LatencyHistogram() { Reset(); }
+
+    /**
+     * Count a latency.
+     *
+     * @param us  The latency in microseconds.
+     */
+    void Record(uint64_t us);
+
+    /**
+     * Clear all the counts. Latencies recorded while a reset is in progress may or may not be kept.
+     */
+    void Reset();
+
+    /**
+     * Get the number of latencies counted in a bucket.
+     *
+     * @param bucket  The bucket index.
+     */
+    uint32_t GetCount(size_t bucket) const { return (uint32_t)counts[bucket]; }
+
+    /**
+     * Get the total number of latencies counted.
+     */
+    uint32_t GetTotal() const;
+
+    /**
+     * Get the latency at a percentile. The result is the upper bound of the bucket the percentile
+     * falls in.
+     *
+     * @param percent  The percentile from 0 to 100.
+     *
+     * @return  The latency in microseconds or 0 if the histogram is empty.
+     */
+    uint64_t GetPercentile(uint32_t percent) const;
+
+    /**
+     * Get the bucket a latency is counted in.
+     *
+     * @param us  The latency in microseconds.
+     */
+    static size_t BucketIndex(uint64_t us);
+
+    /**
+     * Get the smallest latency counted in a bucket.
+     *
+     * @param bucket  The bucket index.
+     *
+     * @return  The lower bound of the bucket in microseconds.
+     */
+    static uint64_t BucketLowerBound(size_t bucket);
+
+  private:
+
+    int32_t counts[NUM_BUCKETS];    /**< Number of latencies in each bucket (atomically incremented) */
+};
+
+/**
+ * %MessageTrace timestamps the stages of a message's life in the daemon and records the time spent
+ * in each stage into latency histograms. There is a set of histograms for each remote endpoint and
+ * one for the whole bus. All stages are counted against the endpoint the message is sent on.
+ *
+ * Tracing is disabled by default. While disabled the cost at each trace point is a test of
+ * IsEnabled(). The histograms of an endpoint are only allocated once tracing has been enabled and
+ * keep their counts when tracing is disabled again.
+ */
+class MessageTrace {
+  public:
+
+    /**
+     * The stages of a message's life.
+     */
+    typedef enum {
+        RECEIVE = 0,    /**< From unmarshaling in the receive thread to the router */
+        ROUTE = 1,      /**< From the router to the transmit queue of the destination endpoint */
+        TX_QUEUE = 2,   /**< Waiting in the transmit queue, including waiting for room in a full queue */
+        DELIVER = 3,    /**< Marshaling and writing the message to the destination endpoint */
+        TOTAL = 4,      /**< From unmarshaling to the end of delivery */
+        NUM_STAGES = 5
+    } Stage;
+
+    /**
+     * A latency histogram for each stage.
+     */
+    struct Histograms {
+        LatencyHistogram stage[NUM_STAGES];     /**< Histograms indexed by stage */
+
+        /**
+         * Record a stage latency in these histograms and in the histograms for the whole bus.
+         *
+         * @param s      The stage.
+         * @param start  Time the stage started or 0 if the message was not timestamped.
+         * @param end    Time the stage ended.
+         */
+        void Record(Stage s, uint64_t start, uint64_t end);
+
+        /**
+         * Clear all the histograms.
+         */
+        void Reset();
+    };
+
+    /**
+     * Histograms of a remote endpoint.
+     */
+    struct EndpointHistograms {
+        qcc::String name;           /**< Unique name of the endpoint */
+        Histograms histograms;      /**< Copy of the endpoint's histograms */
+    };
+
+    /**
+     * Check if tracing is enabled. Trace points must test this before taking timestamps.
+     */
+    static bool IsEnabled() { return enabled; }
+
+    /**
+     * Enable or disable tracing.
+     *
+     * @param enable  true to enable tracing.
+     */
+    static void Enable(bool enable);
+
+    /**
+     * Get a monotonic timestamp for tracing.
+     *
+     * @return  The time in microseconds since an arbitrary point, never 0.
+     */
+    static uint64_t Now();
+
+    /**
+     * Get the histograms for the whole bus.
+     */
+    static Histograms& GetBusHistograms() { return busHistograms; }
+
+    /**
+     * Get a copy of the histograms of every remote endpoint registered with EndpointStats.
+     *
+     * @param endpoints  [OUT] The endpoint histograms.
+     */
+    static void GetEndpointHistograms(std::vector<EndpointHistograms>& endpoints);
+
+    /**
+     * Clear the histograms of the bus and of every remote endpoint.
+     */
+    static void Reset();
+
+    /**
+     * Get the name of a stage.
+     *
+     * @param s  The stage.
+     */
+    static const char* StageText(Stage s);
+
+  private:
+
+    static bool enabled;                /**< true if tracing is enabled */
+    static Histograms busHistograms;    /**< Histograms for the whole bus */
+};
+
+}
+
+#endif
@@ -33,11 +33,14 @@
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/Message.h>
 #include <alljoyn/MsgArg.h>
+#include <alljoyn/MsgArgCodec.h>
 
 #include "LocalTransport.h"
 #include "PeerState.h"
 #include "KeyStore.h"
 #include "CompressionRules.h"
+#include "LZCodec.h"
+#include "MarshalPlan.h"
 #include "BusUtil.h"
 #include "AllJoynCrypto.h"
 #include "AllJoynPeerObj.h"
@@ -102,6 +105,11 @@ namespace ajn {
  */
 #define ROUNDUP8(n)  (((n) + 7) & ~7)
 
+/*
+ * Message bodies shorter than this are not worth compressing
+ */
+static const size_t MIN_COMPRESS_BODY_LEN = 256;
+
 static inline QStatus CheckedArraySize(size_t sz, uint32_t& len)
 {
     if (sz > ALLJOYN_MAX_ARRAY_LEN) {
@@ -448,6 +456,175 @@ QStatus _Message::MarshalArgs(const MsgArg* arg, size_t numArgs)
     return status;
 }
 
+/*
+ * Marshal a member of a fixed layout struct. The caller has already zeroed the pad bytes.
+ */
+QStatus _Message::MarshalFixedValue(const MsgArg* arg, const MarshalPlan& plan, size_t step, uint8_t* base)
+{
+    const MarshalPlan::Step& s = plan[step];
+    uint8_t* pos = base + s.offset;
+
+    if (arg->typeId != s.argTypeId) {
+        return ER_BUS_BAD_VALUE;
+    }
+    switch (s.typeId) {
+    case ALLJOYN_BYTE:
+        *pos = arg->v_byte;
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        *((uint16_t*)pos) = endianSwap ? EndianSwap16(arg->v_uint16) : arg->v_uint16;
+        break;
+
+    case ALLJOYN_BOOLEAN:
+        *((uint32_t*)pos) = arg->v_bool ? (endianSwap ? EndianSwap32(1) : 1) : 0;
+        break;
+
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+        *((uint32_t*)pos) = endianSwap ? EndianSwap32(arg->v_uint32) : arg->v_uint32;
+        break;
+
+    case ALLJOYN_DOUBLE:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_INT64:
+        *((uint64_t*)pos) = endianSwap ? EndianSwap64(arg->v_uint64) : arg->v_uint64;
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    {
+        if ((arg->v_struct.numMembers != s.numMembers) || !arg->v_struct.members) {
+            return ER_BUS_BAD_VALUE;
+        }
+        size_t member = step + 1;
+        for (size_t i = 0; i < s.numMembers; ++i) {
+            QStatus status = MarshalFixedValue(&arg->v_struct.members[i], plan, member, pos);
+            if (status != ER_OK) {
+                return status;
+            }
+            member = plan[member].next;
+        }
+    }
+    break;
+
+    default:
+        return ER_BUS_BAD_VALUE_TYPE;
+    }
+    return ER_OK;
+}
+
+/*
+ * Marshal values following a compiled plan. The plan takes the place of building and comparing the
+ * signature of every array element. Basic types and arrays of scalars are marshaled by
+ * MarshalArgs() once their type has been checked against the plan.
+ */
+QStatus _Message::MarshalPlannedArgs(const MsgArg* arg, size_t numArgs, const MarshalPlan& plan, size_t step)
+{
+    QStatus status = ER_OK;
+    uint32_t len;
+
+    while (numArgs--) {
+        if (!arg) {
+            status = ER_BUS_BAD_VALUE;
+            break;
+        }
+        const MarshalPlan::Step& s = plan[step];
+        switch (s.typeId) {
+        case ALLJOYN_STRUCT_OPEN:
+            if ((arg->typeId != ALLJOYN_STRUCT) || (arg->v_struct.numMembers != s.numMembers)) {
+                status = ER_BUS_BAD_VALUE;
+                break;
+            }
+            MarshalPad(8);
+            if (s.fixedSize) {
+                /*
+                 * The buffer was sized from the values so a value that does not match the plan
+                 * could be shorter than the struct.
+                 */
+                if ((bufPos + s.fixedSize) > ((uint8_t*)msgBuf + bufSize)) {
+                    status = ER_BUS_BAD_VALUE;
+                    break;
+                }
+                memset(bufPos, 0, s.fixedSize);
+                status = MarshalFixedValue(arg, plan, step, bufPos - s.offset);
+                bufPos += s.fixedSize;
+            } else {
+                status = MarshalPlannedArgs(arg->v_struct.members, arg->v_struct.numMembers, plan, step + 1);
+            }
+            break;
+
+        case ALLJOYN_DICT_ENTRY_OPEN:
+            if (arg->typeId != ALLJOYN_DICT_ENTRY) {
+                status = ER_BUS_BAD_VALUE;
+                break;
+            }
+            MarshalPad(8);
+            status = MarshalPlannedArgs(arg->v_dictEntry.key, 1, plan, step + 1);
+            if (status == ER_OK) {
+                status = MarshalPlannedArgs(arg->v_dictEntry.val, 1, plan, plan[step + 1].next);
+            }
+            break;
+
+        case ALLJOYN_ARRAY:
+            if (arg->typeId == ALLJOYN_ARRAY) {
+                if (!arg->v_array.elemSig || (s.elemSig != arg->v_array.elemSig)) {
+                    status = ER_BUS_BAD_VALUE;
+                    break;
+                }
+                if ((arg->v_array.numElements > 0) && !arg->v_array.elements) {
+                    status = ER_BUS_BAD_VALUE;
+                    break;
+                }
+                MarshalPad(4);
+                uint8_t* lenPos = bufPos;
+                bufPos += 4;
+                /* Length does not include padding for first element, so pad to 8 byte boundary if required. */
+                if (plan[step + 1].alignment == 8) {
+                    MarshalPad(8);
+                }
+                uint8_t* elemPos = bufPos;
+                for (size_t i = 0; (status == ER_OK) && (i < arg->v_array.numElements); i++) {
+                    status = MarshalPlannedArgs(&arg->v_array.elements[i], 1, plan, step + 1);
+                    if (status == ER_BUS_BAD_VALUE) {
+                        QCC_LogError(status, ("Array element[%d] does not have expected signature \"%s\"", i, arg->v_array.GetElemSig()));
+                    }
+                }
+                if (status == ER_OK) {
+                    status = CheckedArraySize(bufPos - elemPos, len);
+                }
+                if (status == ER_OK) {
+                    /* Patch in length */
+                    uint8_t* tmpPos = bufPos;
+                    bufPos = lenPos;
+                    if (endianSwap) {
+                        MarshalReversed(&len, 4);
+                    } else {
+                        Marshal4(len);
+                    }
+                    bufPos = tmpPos;
+                }
+                break;
+            }
+
+        /* Falling through */
+        default:
+            if (arg->typeId != s.argTypeId) {
+                status = ER_BUS_BAD_VALUE;
+            } else {
+                status = MarshalArgs(arg, 1);
+            }
+            break;
+        }
+        if (status != ER_OK) {
+            break;
+        }
+        step = s.next;
+        ++arg;
+    }
+    return status;
+}
+
 QStatus _Message::Deliver(RemoteEndpoint& endpoint)
 {
     QStatus status = ER_OK;
@@ -491,7 +668,47 @@ QStatus _Message::Deliver(RemoteEndpoint& endpoint)
         }
     }
     /*
-     * Push the message to the endpoint sink (only push handles in the first chunk)
+     * The header may need to be compressed differently on this connection. Only the header is
+     * rewritten, the body is always sent from this message.
+     */
+    _Message* wireHdr = NULL;
+    uint8_t* body = bodyPtr;
+    size_t bodyLen = bufEOD - bodyPtr;
+    uint8_t* compBody = NULL;
+    if (status == ER_OK) {
+        wireHdr = CompressForEndpoint(endpoint);
+        /*
+         * Large bodies are compressed on connections that negotiated body compression and the far
+         * end of the connection decompresses them. Encrypted bodies don't compress and are only
+         * decrypted by the final destination, which may be beyond the far end of this connection.
+         */
+        if (endpoint.GetFeatures().bodyCompression && !handles && !(msgHeader.flags & (ALLJOYN_FLAG_ENCRYPTED | ALLJOYN_FLAG_BODY_COMPRESSED))) {
+            size_t compLen;
+            compBody = CompressBody(msgHeader.bodyLen, compLen);
+            if (compBody) {
+                if (!wireHdr) {
+                    wireHdr = CloneHeader();
+                }
+                wireHdr->SetCompressedBodyLen(compLen);
+                body = compBody;
+                bodyLen = compLen;
+                QCC_DbgHLPrintf(("Compressed body of %s to %u bytes", Description().c_str(), compLen));
+                RemoteEndpoint::CompressionStats& stats = endpoint.GetCompressionStats();
+                ++stats.txMessages;
+                stats.txRawBytes += msgHeader.bodyLen;
+                stats.txWireBytes += compLen;
+            } else if (msgHeader.bodyLen >= MIN_COMPRESS_BODY_LEN) {
+                ++endpoint.GetCompressionStats().txIncompressible;
+            }
+        }
+        if (wireHdr) {
+            buf = reinterpret_cast<uint8_t*>(wireHdr->msgBuf);
+            len = wireHdr->bufEOD - buf;
+        }
+    }
+    /*
+     * Push the message to the endpoint sink (only push handles in the first chunk). A header
+     * rewritten for this connection is pushed first followed by the body.
      */
     if (status == ER_OK) {
         if (handles) {
@@ -508,6 +725,15 @@ QStatus _Message::Deliver(RemoteEndpoint& endpoint)
         buf += pushed;
         status = sink.PushBytes(buf, len, pushed);
     }
+    if (wireHdr) {
+        while ((status == ER_OK) && bodyLen) {
+            status = sink.PushBytes(body, bodyLen, pushed);
+            bodyLen -= pushed;
+            body += pushed;
+        }
+        delete wireHdr;
+    }
+    delete [] compBody;
     if (status == ER_OK) {
         QCC_DbgHLPrintf(("Deliver message %s to %s", Description().c_str(), endpoint.GetUniqueName().c_str()));
         QCC_DbgPrintf(("%s", ToString().c_str()));
@@ -517,6 +743,132 @@ QStatus _Message::Deliver(RemoteEndpoint& endpoint)
     return status;
 }
 
+uint8_t* _Message::CompressBody(size_t argsLen, size_t& compLen) const
+{
+    if (argsLen < MIN_COMPRESS_BODY_LEN) {
+        return NULL;
+    }
+    /*
+     * Give up early if compression isn't going to save at least an eighth of the body.
+     */
+    size_t maxLen = argsLen - (argsLen / 8);
+    uint8_t* body = new uint8_t[maxLen];
+    size_t len = LZCodec::Compress(bodyPtr, argsLen, body + sizeof(uint32_t), maxLen - sizeof(uint32_t));
+    if (len == 0) {
+        QCC_DbgPrintf(("Body of %s is not compressible", Description().c_str()));
+        delete [] body;
+        return NULL;
+    }
+    /*
+     * Uncompressed length is always little endian
+     */
+    body[0] = (uint8_t)(argsLen);
+    body[1] = (uint8_t)(argsLen >> 8);
+    body[2] = (uint8_t)(argsLen >> 16);
+    body[3] = (uint8_t)(argsLen >> 24);
+    compLen = len + sizeof(uint32_t);
+    return body;
+}
+
+void _Message::SetCompressedBodyLen(size_t len)
+{
+    assert(len < msgHeader.bodyLen);
+    msgHeader.bodyLen = static_cast<uint32_t>(len);
+    msgHeader.flags |= ALLJOYN_FLAG_BODY_COMPRESSED;
+    /*
+     * Update the marshaled header
+     */
+    MessageHeader* hdr = (MessageHeader*)msgBuf;
+    hdr->flags |= ALLJOYN_FLAG_BODY_COMPRESSED;
+    hdr->bodyLen = endianSwap ? EndianSwap32(msgHeader.bodyLen) : msgHeader.bodyLen;
+}
+
+_Message* _Message::CloneHeader() const
+{
+    size_t hdrLen = bodyPtr - reinterpret_cast<uint8_t*>(msgBuf);
+    _Message* hdrMsg = new _Message(*bus);
+    hdrMsg->endianSwap = endianSwap;
+    hdrMsg->msgHeader = msgHeader;
+    hdrMsg->bufSize = hdrLen;
+    hdrMsg->_msgBuf = new uint8_t[hdrLen + 7];
+    hdrMsg->msgBuf = (uint64_t*)((uintptr_t)(hdrMsg->_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
+    memcpy(hdrMsg->msgBuf, msgBuf, hdrLen);
+    hdrMsg->bufPos = reinterpret_cast<uint8_t*>(hdrMsg->msgBuf) + hdrLen;
+    hdrMsg->bodyPtr = hdrMsg->bufPos;
+    hdrMsg->bufEOD = hdrMsg->bufPos;
+    return hdrMsg;
+}
+
+_Message* _Message::CompressForEndpoint(RemoteEndpoint& endpoint)
+{
+    /*
+     * Encrypted messages authenticate the header as it was marshaled by the sender so they must be
+     * sent as is. Messages with handles never leave the device so there is nothing to gain.
+     */
+    if ((msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) || handles) {
+        return NULL;
+    }
+    /*
+     * Older peers don't understand inline expansions and request them via GetExpansion instead.
+     */
+    if (endpoint.GetRemoteProtocolVersion() < 4) {
+        return NULL;
+    }
+    CompressionDictionary& dictionary = endpoint.GetCompressionDictionary();
+    uint32_t token = 0;
+    bool compress = false;
+    if (msgHeader.flags & ALLJOYN_FLAG_COMPRESSED) {
+        /*
+         * The token field is marked invalid once a received header has been expanded but the value is retained.
+         */
+        token = hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].v_uint32;
+    } else if ((msgHeader.msgType == MESSAGE_SIGNAL) && endpoint.GetFeatures().isBusToBus) {
+        /*
+         * Signals whose headers repeat on a bus-to-bus link are compressed even if the sender
+         * didn't ask for it. Remote daemons that speak protocol version 4 or later learn the
+         * expansion from the first message so this never costs a round trip.
+         */
+        if (dictionary.IsRepeatedHeader(hdrFields)) {
+            token = bus->GetInternal().GetCompressionRules()->GetToken(hdrFields);
+            compress = true;
+        }
+    }
+    if (!token) {
+        return NULL;
+    }
+    bool inlineExpansion = !dictionary.CheckAndAddToken(token);
+    if (!compress && !inlineExpansion) {
+        return NULL;
+    }
+    /*
+     * The wire flags may differ from the in-memory flags so take them from the marshaled header.
+     */
+    uint8_t wireFlags = reinterpret_cast<MessageHeader*>(msgBuf)->flags | ALLJOYN_FLAG_COMPRESSED;
+    _Message* wireHdr = new _Message(*bus);
+    wireHdr->endianSwap = endianSwap;
+    wireHdr->msgHeader = msgHeader;
+    wireHdr->hdrFields = hdrFields;
+    wireHdr->hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].Clear();
+    wireHdr->hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].v_uint32 = token;
+    wireHdr->hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_UINT32;
+    /*
+     * The first message that uses a token on a connection carries the compressible header fields
+     * along with the token so the receiver can add the expansion rule without asking for it.
+     */
+    if (inlineExpansion) {
+        wireHdr->msgHeader.flags &= ~ALLJOYN_FLAG_COMPRESSED;
+    } else {
+        wireHdr->msgHeader.flags |= ALLJOYN_FLAG_COMPRESSED;
+    }
+    wireHdr->MarshalHeader(0);
+    wireHdr->bodyPtr = wireHdr->bufPos;
+    wireHdr->bufEOD = wireHdr->bufPos;
+    reinterpret_cast<MessageHeader*>(wireHdr->msgBuf)->flags = wireFlags;
+    QCC_DbgHLPrintf(("Sending %s with %s compression token %u to %s", Description().c_str(), inlineExpansion ? "inline" : "known",
+                     token, endpoint.GetUniqueName().c_str()));
+    return wireHdr;
+}
+
 
 /*
  * Map from our enumeration type to the wire protocol values
@@ -697,16 +1049,33 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
                                  const MsgArg* args,
                                  uint8_t numArgs,
                                  uint8_t flags,
-                                 uint32_t sessionId)
+                                 uint32_t sessionId,
+                                 const TypedMsgArgs* typedArgs)
 {
     char signature[256];
+    MarshalPlan::Ref plan;
     QStatus status = ER_OK;
-    size_t argsLen = (numArgs == 0) ? 0 : SignatureUtils::GetSize(args, numArgs);
+    size_t argsLen = 0;
     size_t hdrLen = 0;
 
     if (!bus->IsStarted()) {
         return ER_BUS_BUS_NOT_STARTED;
     }
+    /*
+     * Typed args are sized by marshaling them without a buffer
+     */
+    if (typedArgs) {
+        MsgBodyWriter sizer(NULL, false);
+        typedArgs->Marshal(sizer);
+        status = sizer.GetStatus();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("MarshalMessage typed args too long"));
+            return status;
+        }
+        argsLen = sizer.GetSize();
+    } else if (numArgs > 0) {
+        argsLen = SignatureUtils::GetSize(args, numArgs);
+    }
     /*
      * Check if endianess needs to be swapped.
      */
@@ -770,7 +1139,19 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      * If there are arguments build the signature
      */
     hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].Clear();
-    if (numArgs > 0) {
+    if (typedArgs) {
+        qcc::String typedSig = typedArgs->GetSignature();
+        if (typedSig.size() >= sizeof(signature)) {
+            status = ER_BUS_BAD_SIGNATURE;
+            goto ExitMarshalMessage;
+        }
+        memcpy(signature, typedSig.c_str(), typedSig.size() + 1);
+        if (!typedSig.empty()) {
+            hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].typeId = ALLJOYN_SIGNATURE;
+            hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].v_signature.sig = signature;
+            hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].v_signature.len = (uint8_t)typedSig.size();
+        }
+    } else if (numArgs > 0) {
         size_t sigLen = 0;
         status = SignatureUtils::MakeSignature(args, numArgs, signature, sigLen);
         if (status != ER_OK) {
@@ -863,7 +1244,18 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      * Marshal the message body
      */
     bodyPtr = bufPos;
-    status = MarshalArgs(args, numArgs);
+    if (typedArgs) {
+        MsgBodyWriter writer(bufPos, endianSwap);
+        typedArgs->Marshal(writer);
+        bufPos += writer.GetSize();
+    } else {
+        plan = MarshalPlan::Get(signature);
+        if (plan) {
+            status = MarshalPlannedArgs(args, numArgs, *plan, 0);
+        } else {
+            status = MarshalArgs(args, numArgs);
+        }
+    }
     if (status != ER_OK) {
         goto ExitMarshalMessage;
     }
@@ -1002,7 +1394,8 @@ QStatus _Message::CallMsg(const qcc::String& signature,
                           uint32_t& serial,
                           const MsgArg* args,
                           size_t numArgs,
-                          uint8_t flags)
+                          uint8_t flags,
+                          const TypedMsgArgs* typedArgs)
 {
     QStatus status;
 
@@ -1054,7 +1447,7 @@ QStatus _Message::CallMsg(const qcc::String& signature,
     /*
      * Build method call message
      */
-    status = MarshalMessage(signature, destination, MESSAGE_METHOD_CALL, args, numArgs, flags, sessionId);
+    status = MarshalMessage(signature, destination, MESSAGE_METHOD_CALL, args, numArgs, flags, sessionId, typedArgs);
     if (status == ER_OK) {
         /*
          * Return the serial number for this message
@@ -1076,14 +1469,15 @@ QStatus _Message::SignalMsg(const qcc::String& signature,
                             const MsgArg* args,
                             size_t numArgs,
                             uint8_t flags,
-                            uint16_t timeToLive)
+                            uint16_t timeToLive,
+                            const TypedMsgArgs* typedArgs)
 {
     QStatus status;
 
     /*
-     * Validate flags - ENCRYPTED, COMPRESSED, and ALLJOYN_FLAG_GLOBAL_BROADCAST are the flags applicable to signals
+     * Validate flags - ENCRYPTED, COMPRESSED, GLOBAL_BROADCAST and LAST_VALUE are the flags applicable to signals
      */
-    if (flags & ~(ALLJOYN_FLAG_ENCRYPTED | ALLJOYN_FLAG_COMPRESSED | ALLJOYN_FLAG_GLOBAL_BROADCAST)) {
+    if (flags & ~(ALLJOYN_FLAG_ENCRYPTED | ALLJOYN_FLAG_COMPRESSED | ALLJOYN_FLAG_GLOBAL_BROADCAST | ALLJOYN_FLAG_LAST_VALUE)) {
         return ER_BUS_BAD_HDR_FLAGS;
     }
     /*
@@ -1135,7 +1529,7 @@ QStatus _Message::SignalMsg(const qcc::String& signature,
     /*
      * Build signal message
      */
-    status = MarshalMessage(signature, destination, MESSAGE_SIGNAL, args, numArgs, flags, sessionId);
+    status = MarshalMessage(signature, destination, MESSAGE_SIGNAL, args, numArgs, flags, sessionId, typedArgs);
 
 ExitSignalMsg:
     return status;
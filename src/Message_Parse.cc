@@ -37,6 +37,8 @@
 #include "LocalTransport.h"
 #include "PeerState.h"
 #include "CompressionRules.h"
+#include "LZCodec.h"
+#include "MarshalPlan.h"
 #include "BusUtil.h"
 #include "AllJoynCrypto.h"
 #include "AllJoynPeerObj.h"
@@ -549,14 +551,307 @@ QStatus _Message::ParseValue(MsgArg* arg, const char*& sigPtr, bool arrayElem)
     return status;
 }
 
+/*
+ * Parse a member of a fixed layout struct. The caller has already checked the whole struct is
+ * within the buffer.
+ */
+QStatus _Message::ParseFixedValue(MsgArg* arg, const MarshalPlan& plan, size_t step, const uint8_t* base)
+{
+    const MarshalPlan::Step& s = plan[step];
+    const uint8_t* pos = base + s.offset;
+
+    switch (s.typeId) {
+    case ALLJOYN_BYTE:
+        arg->v_byte = *pos;
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        arg->v_uint16 = endianSwap ? EndianSwap16(*((uint16_t*)pos)) : *((uint16_t*)pos);
+        break;
+
+    case ALLJOYN_BOOLEAN:
+    {
+        uint32_t v = endianSwap ? EndianSwap32(*((uint32_t*)pos)) : *((uint32_t*)pos);
+        if (v > 1) {
+            return ER_BUS_BAD_VALUE;
+        }
+        arg->v_bool = (v == 1);
+    }
+    break;
+
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+        arg->v_uint32 = endianSwap ? EndianSwap32(*((uint32_t*)pos)) : *((uint32_t*)pos);
+        break;
+
+    case ALLJOYN_DOUBLE:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_INT64:
+        arg->v_uint64 = endianSwap ? EndianSwap64(*((uint64_t*)pos)) : *((uint64_t*)pos);
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    {
+        arg->typeId = ALLJOYN_STRUCT;
+        arg->v_struct.numMembers = s.numMembers;
+        arg->v_struct.members = new MsgArg[s.numMembers];
+        arg->flags |= MsgArg::OwnsArgs;
+        size_t member = step + 1;
+        for (size_t i = 0; i < s.numMembers; ++i) {
+            QStatus status = ParseFixedValue(&arg->v_struct.members[i], plan, member, pos);
+            if (status != ER_OK) {
+                arg->v_struct.numMembers = i;
+                return status;
+            }
+            member = plan[member].next;
+        }
+    }
+    break;
+
+    default:
+        return ER_BUS_BAD_VALUE_TYPE;
+    }
+    arg->typeId = s.argTypeId;
+    return ER_OK;
+}
+
+/*
+ * Parse an array of structs, dict entries, or other non-scalar types
+ */
+QStatus _Message::ParsePlannedArray(MsgArg* arg, const MarshalPlan& plan, size_t step)
+{
+    QStatus status = ER_OK;
+    const MarshalPlan::Step& elem = plan[step + 1];
+    uint32_t len;
+
+    arg->typeId = ALLJOYN_ARRAY;
+    bufPos = AlignPtr(bufPos, 4);
+    if (endianSwap) {
+        len = EndianSwap32(*((uint32_t*)bufPos));
+    } else {
+        len = *((uint32_t*)bufPos);
+    }
+    bufPos += 4;
+    if ((len > ALLJOYN_MAX_ARRAY_LEN) || ((len + bufPos) > bufEOD)) {
+        status = ER_BUS_BAD_LENGTH;
+        QCC_LogError(status, ("Array length %ld at pos:%ld is too big", len, bufPos - bodyPtr - 4));
+        arg->typeId = ALLJOYN_INVALID;
+        return status;
+    }
+    /*
+     * The array length in bytes does not include the pad bytes between the length and the start
+     * of the first element.
+     */
+    if (elem.alignment == 8) {
+        bufPos = AlignPtr(bufPos, 8);
+    }
+    size_t numElements = 0;
+    MsgArg* elements = NULL;
+    if (len > 0) {
+        uint8_t* endOfArray = bufPos + len;
+        size_t capacity = 8;
+        /*
+         * Elements with a fixed layout are 8 byte aligned structs so the number of elements is
+         * known from the length.
+         */
+        if (elem.fixedSize) {
+            size_t stride = (elem.fixedSize + 7) & ~7;
+            capacity = (len + stride - elem.fixedSize) / stride;
+            if (capacity == 0) {
+                capacity = 1;
+            }
+        }
+        elements = new MsgArg[capacity];
+        while (bufPos < endOfArray) {
+            if (numElements == capacity) {
+                capacity *= 2;
+                MsgArg* bigger = new MsgArg[capacity];
+                memcpy(bigger, elements, numElements * sizeof(MsgArg));
+                /*
+                 * Clear the flags to prevent the destructor from freeing anything other
+                 * than the MsgArgs.
+                 */
+                for (size_t i = 0; i < numElements; i++) {
+                    elements[i].flags = 0;
+                }
+                delete [] elements;
+                elements = bigger;
+            }
+            status = ParsePlannedValue(&elements[numElements++], plan, step + 1);
+            if (status != ER_OK) {
+                break;
+            }
+        }
+    }
+    if (status == ER_OK) {
+        arg->v_array.SetElements(plan[step].elemSig.c_str(), numElements, elements);
+        arg->flags |= MsgArg::OwnsArgs;
+    } else {
+        delete [] elements;
+        arg->typeId = ALLJOYN_INVALID;
+    }
+    return status;
+}
+
+/*
+ * Parse a value following a compiled plan rather than the signature. Basic types and arrays of
+ * scalars are parsed by ParseValue() which is already direct for these types.
+ */
+QStatus _Message::ParsePlannedValue(MsgArg* arg, const MarshalPlan& plan, size_t step)
+{
+    QStatus status = ER_OK;
+    const MarshalPlan::Step& s = plan[step];
+
+    switch (s.typeId) {
+    case ALLJOYN_STRUCT_OPEN:
+        arg->Clear();
+        bufPos = AlignPtr(bufPos, 8);
+        if (s.fixedSize) {
+            if ((bufPos + s.fixedSize) > bufEOD) {
+                status = ER_BUS_BAD_SIGNATURE;
+            } else {
+                status = ParseFixedValue(arg, plan, step, bufPos - s.offset);
+                bufPos += s.fixedSize;
+            }
+        } else {
+            arg->typeId = ALLJOYN_STRUCT;
+            arg->v_struct.numMembers = s.numMembers;
+            arg->v_struct.members = new MsgArg[s.numMembers];
+            arg->flags |= MsgArg::OwnsArgs;
+            size_t member = step + 1;
+            for (size_t i = 0; i < s.numMembers; ++i) {
+                status = ParsePlannedValue(&arg->v_struct.members[i], plan, member);
+                if (status != ER_OK) {
+                    arg->v_struct.numMembers = i;
+                    break;
+                }
+                member = plan[member].next;
+            }
+        }
+        break;
+
+    case ALLJOYN_DICT_ENTRY_OPEN:
+        arg->Clear();
+        bufPos = AlignPtr(bufPos, 8);
+        arg->typeId = ALLJOYN_DICT_ENTRY;
+        arg->v_dictEntry.key = new MsgArg();
+        arg->v_dictEntry.val = new MsgArg();
+        arg->flags |= MsgArg::OwnsArgs;
+        status = ParsePlannedValue(arg->v_dictEntry.key, plan, step + 1);
+        if (status == ER_OK) {
+            status = ParsePlannedValue(arg->v_dictEntry.val, plan, plan[step + 1].next);
+        }
+        break;
+
+    case ALLJOYN_ARRAY:
+        if (s.argTypeId == ALLJOYN_ARRAY) {
+            arg->Clear();
+            status = ParsePlannedArray(arg, plan, step);
+            break;
+        }
+
+    /* Falling through */
+    default:
+    {
+        const char* sigPtr = plan.GetSignature() + s.sigOffset;
+        return ParseValue(arg, sigPtr);
+    }
+    }
+    /*
+     * Check we are not running of the end of the buffer
+     */
+    if ((status == ER_OK) && (bufPos > bufEOD)) {
+        status = ER_BUS_BAD_SIGNATURE;
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Message arg parse error at or near %ld", bufPos - bodyPtr));
+    }
+    return status;
+}
+
 /*
  * The wildcard signature ("*") is used by test programs and for debugging.
  */
 static const char* WildCardSignature = "*";
 
+static inline void RelocatePtr(const char*& ptr, const uint8_t* oldBuf, size_t len, const uint8_t* newBuf)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(ptr);
+    if ((p >= oldBuf) && (p < (oldBuf + len))) {
+        ptr = reinterpret_cast<const char*>(newBuf + (p - oldBuf));
+    }
+}
+
+QStatus _Message::DecompressBody()
+{
+    QStatus status = ER_BUS_BAD_COMPRESSED_BODY;
+
+    if (msgHeader.bodyLen < sizeof(uint32_t)) {
+        QCC_LogError(status, ("Compressed body is too short"));
+        return status;
+    }
+    /*
+     * Uncompressed length is always little endian
+     */
+    size_t len = (size_t)bodyPtr[0] | ((size_t)bodyPtr[1] << 8) | ((size_t)bodyPtr[2] << 16) | ((size_t)bodyPtr[3] << 24);
+    if (len > ALLJOYN_MAX_PACKET_LEN) {
+        QCC_LogError(status, ("Uncompressed body length %u is invalid", len));
+        return status;
+    }
+    size_t hdrLen = bodyPtr - (uint8_t*)msgBuf;
+    size_t newBufSize = hdrLen + ((len + 7) & ~7) + sizeof(uint64_t);
+    uint8_t* _newBuf = new uint8_t[newBufSize + 7];
+    uint8_t* newBuf = (uint8_t*)((uintptr_t)(_newBuf + 7) & ~7); /* Align to 8 byte boundary */
+    uint8_t* newBody = newBuf + hdrLen;
+    size_t outLen = 0;
+    status = LZCodec::Decompress(bodyPtr + sizeof(uint32_t), msgHeader.bodyLen - sizeof(uint32_t), newBody, len, outLen);
+    if ((status == ER_OK) && (outLen != len)) {
+        status = ER_BUS_BAD_COMPRESSED_BODY;
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to decompress body of %s", Description().c_str()));
+        delete [] _newBuf;
+        return status;
+    }
+    memcpy(newBuf, msgBuf, hdrLen);
+    /*
+     * The unmarshaled header fields point into the old buffer
+     */
+    for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
+        MsgArg& field = hdrFields.field[id];
+        if ((field.typeId == ALLJOYN_STRING) || (field.typeId == ALLJOYN_OBJECT_PATH)) {
+            RelocatePtr(field.v_string.str, (uint8_t*)msgBuf, hdrLen, newBuf);
+        } else if (field.typeId == ALLJOYN_SIGNATURE) {
+            RelocatePtr(field.v_signature.sig, (uint8_t*)msgBuf, hdrLen, newBuf);
+        }
+    }
+    delete [] _msgBuf;
+    _msgBuf = _newBuf;
+    msgBuf = (uint64_t*)newBuf;
+    bufSize = newBufSize;
+    bodyPtr = newBody;
+    bufEOD = bodyPtr + len;
+    /*
+     * Zero fill the pad at the end of the buffer
+     */
+    memset(bufEOD, 0, newBuf + bufSize - bufEOD);
+    msgHeader.bodyLen = static_cast<uint32_t>(len);
+    msgHeader.flags &= ~ALLJOYN_FLAG_BODY_COMPRESSED;
+    /*
+     * Update the marshaled header so the message can be forwarded as is
+     */
+    MessageHeader* hdr = (MessageHeader*)msgBuf;
+    hdr->flags &= ~ALLJOYN_FLAG_BODY_COMPRESSED;
+    hdr->bodyLen = endianSwap ? EndianSwap32(msgHeader.bodyLen) : msgHeader.bodyLen;
+    QCC_DbgPrintf(("Decompressed body of %s to %u bytes", Description().c_str(), len));
+    return ER_OK;
+}
+
 QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char* expectedReplySignature)
 {
     const char* sig = GetSignature();
+    MarshalPlan::Ref plan;
     QStatus status = ER_OK;
 
     if (!bus->IsStarted()) {
@@ -614,17 +909,30 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
     /*
      * Calculate how many arguments there are
      */
-    numMsgArgs = SignatureUtils::CountCompleteTypes(sig);
+    plan = MarshalPlan::Get(sig);
+    numMsgArgs = plan ? (uint8_t)plan->GetNumArgs() : SignatureUtils::CountCompleteTypes(sig);
     msgArgs = new MsgArg[numMsgArgs];
     /*
      * Unmarshal the body values
      */
     bufPos = bodyPtr;
-    for (uint8_t i = 0; i < numMsgArgs; i++) {
-        status = ParseValue(&msgArgs[i], sig);
-        if (status != ER_OK) {
-            numMsgArgs = i;
-            goto ExitUnmarshalArgs;
+    if (plan) {
+        size_t step = 0;
+        for (uint8_t i = 0; i < numMsgArgs; i++) {
+            status = ParsePlannedValue(&msgArgs[i], *plan, step);
+            if (status != ER_OK) {
+                numMsgArgs = i;
+                goto ExitUnmarshalArgs;
+            }
+            step = (*plan)[step].next;
+        }
+    } else {
+        for (uint8_t i = 0; i < numMsgArgs; i++) {
+            status = ParseValue(&msgArgs[i], sig);
+            if (status != ER_OK) {
+                numMsgArgs = i;
+                goto ExitUnmarshalArgs;
+            }
         }
     }
     if ((bufPos - bodyPtr) != static_cast<ptrdiff_t>(msgHeader.bodyLen)) {
@@ -800,6 +1108,20 @@ static const AllJoynFieldType FieldTypeMapping[] = {
 };
 
 
+/*
+ * Check if any of the header fields that are omitted from a compressed header are present
+ */
+static bool HasCompressibleFields(const HeaderFields& hdrFields)
+{
+    for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
+        if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId != ALLJOYN_INVALID)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
 /*
  * Perform consistency checks on the header
  */
@@ -1034,6 +1356,27 @@ QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool ped
      */
     bufPos = AlignPtr(bufPos, 8);
     bodyPtr = bufPos;
+    /*
+     * Bodies are compressed by the sender on this connection only. Encrypted bodies are never
+     * compressed because only the final destination can decrypt them.
+     */
+    if (msgHeader.flags & ALLJOYN_FLAG_BODY_COMPRESSED) {
+        uint32_t wireLen = msgHeader.bodyLen;
+        if (msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) {
+            status = ER_BUS_BAD_COMPRESSED_BODY;
+            QCC_LogError(status, ("Encrypted message %s has a compressed body", Description().c_str()));
+            goto ExitUnmarshal;
+        }
+        status = DecompressBody();
+        if (status != ER_OK) {
+            goto ExitUnmarshal;
+        }
+        bufPos = bodyPtr;
+        RemoteEndpoint::CompressionStats& stats = endpoint.GetCompressionStats();
+        ++stats.rxMessages;
+        stats.rxRawBytes += msgHeader.bodyLen;
+        stats.rxWireBytes += wireLen;
+    }
     /*
      * If header is compressed try to expand it
      */
@@ -1045,20 +1388,35 @@ QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool ped
             goto ExitUnmarshal;
         }
         const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-        if (!expFields) {
+        if (expFields) {
+            /*
+             * Expand the compressed fields. Don't overwrite headers we received in the message.
+             */
+            for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
+                if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
+                    hdrFields.field[id] = expFields->field[id];
+                }
+            }
+            hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_INVALID;
+        } else if (HasCompressibleFields(hdrFields)) {
+            /*
+             * A compressed header never carries the compressible fields so the sender included the
+             * expansion along with the token the first time it used the token on this connection.
+             * Learn the expansion then rewrite the message in the compressed form so that it can
+             * be forwarded without the inline fields.
+             */
+            QCC_DbgPrintf(("Learned inline expansion for token %u", token));
+            bus->GetInternal().GetCompressionRules()->AddExpansion(hdrFields, token);
+            status = ReMarshal(NULL);
+            if (status != ER_OK) {
+                goto ExitUnmarshal;
+            }
+            hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_INVALID;
+        } else {
             QCC_DbgPrintf(("No expansion for token %u", token));
             status = ER_BUS_CANNOT_EXPAND_MESSAGE;
             goto ExitUnmarshal;
         }
-        /*
-         * Expand the compressed fields. Don't overwrite headers we received in the message.
-         */
-        for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
-            if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
-                hdrFields.field[id] = expFields->field[id];
-            }
-        }
-        hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_INVALID;
     }
     /*
      * Check the validity of the message header
@@ -23,6 +23,8 @@
 
 #include <qcc/platform.h>
 
+#include <string.h>
+
 #include "MethodTable.h"
 
 /** @internal */
@@ -33,18 +35,50 @@ using namespace std;
 
 namespace ajn {
 
+MethodTable::Index::Index(size_t numSlots) : slots(numSlots), mask(numSlots - 1)
+{
+    for (size_t i = 0; i < numSlots; ++i) {
+        slots[i].entry = NULL;
+    }
+}
+
+MethodTable::Index::~Index()
+{
+    for (size_t i = 0; i < removed.size(); ++i) {
+        delete removed[i];
+    }
+}
+
 MethodTable::~MethodTable()
 {
     lock.Lock(MUTEX_CONTEXT);
     std::hash_map<Key, Entry*, Hash, Equal>::iterator iter = hashTable.begin();
     while (iter != hashTable.end()) {
-        delete iter->second;
+        /* The key refers to the entry's strings so the entry is deleted after it is erased */
+        Entry* entry = iter->second;
         hashTable.erase(iter);
+        delete entry;
         iter = hashTable.begin();
     }
+    for (size_t i = 0; i < removed.size(); ++i) {
+        delete removed[i];
+    }
+    removed.clear();
     lock.Unlock(MUTEX_CONTEXT);
 }
 
+void MethodTable::Insert(Entry* entry, bool anyIface)
+{
+    /* The key refers to the entry's own strings so it stays valid as long as the entry */
+    Key key(entry->objPathStr.c_str(), anyIface ? NULL : entry->ifaceStr.c_str(), entry->methodStr.c_str());
+    std::hash_map<Key, Entry*, Hash, Equal>::iterator iter = hashTable.find(key);
+    if (iter != hashTable.end()) {
+        removed.push_back(iter->second);
+        hashTable.erase(iter);
+    }
+    hashTable.insert(std::pair<const Key, Entry*>(key, entry));
+}
+
 void MethodTable::Add(BusObject* object,
                       MessageReceiver::MethodHandler func,
                       const InterfaceDescription::Member* member,
@@ -52,55 +86,112 @@ void MethodTable::Add(BusObject* object,
 {
     Entry* entry = new Entry(object, func, member, context);
     lock.Lock(MUTEX_CONTEXT);
-    hashTable[Key(object->GetPath(), entry->ifaceStr.empty() ? NULL : entry->ifaceStr.c_str(), member->name.c_str())] = entry;
+    Insert(entry, entry->ifaceStr.empty());
 
     /* Method calls don't require an interface so we need to add an entry with a NULL interface */
     if (!entry->ifaceStr.empty()) {
-        hashTable[Key(object->GetPath(), NULL, member->name.c_str())] = new Entry(*entry);
+        Insert(new Entry(*entry), true);
+    }
+    if (!deferPublish) {
+        Publish();
     }
     lock.Unlock(MUTEX_CONTEXT);
 }
 
-const MethodTable::Entry* MethodTable::Find(const char* objectPath,
-                                            const char* iface,
-                                            const char* methodName)
+void MethodTable::Publish()
+{
+    /* Size the index for a load factor of at most one half so probe sequences stay short */
+    size_t numSlots = 8;
+    while (numSlots < (2 * hashTable.size())) {
+        numSlots <<= 1;
+    }
+    Index* newIndex = new Index(numSlots);
+    Hash hash;
+    std::hash_map<Key, Entry*, Hash, Equal>::const_iterator iter;
+    for (iter = hashTable.begin(); iter != hashTable.end(); ++iter) {
+        size_t h = hash(iter->first);
+        size_t i = h & newIndex->mask;
+        while (newIndex->slots[i].entry) {
+            i = (i + 1) & newIndex->mask;
+        }
+        newIndex->slots[i].hash = h;
+        newIndex->slots[i].anyIface = (iter->first.iface == NULL);
+        newIndex->slots[i].entry = iter->second;
+    }
+    /*
+     * Readers of the current index may still be using entries that have been removed from the hash
+     * table so they are deleted with that index.
+     */
+    Index* oldIndex = index.GetCurrent();
+    if (oldIndex) {
+        oldIndex->removed.insert(oldIndex->removed.end(), removed.begin(), removed.end());
+    } else {
+        for (size_t i = 0; i < removed.size(); ++i) {
+            delete removed[i];
+        }
+    }
+    removed.clear();
+    index.Publish(newIndex);
+}
+
+bool MethodTable::Find(const char* objectPath,
+                       const char* iface,
+                       const char* methodName,
+                       Entry& entry)
 {
-    const Entry* entry = NULL;
     Key key(objectPath, iface, methodName);
-    lock.Lock(MUTEX_CONTEXT);
-    std::hash_map<Key, Entry*, Hash, Equal>::iterator iter = hashTable.find(key);
-    if (iter != hashTable.end()) {
-        entry = iter->second;
+    size_t h = Hash()(key);
+    bool found = false;
+
+    const Index* current = index.BeginRead();
+    if (current) {
+        for (size_t i = h & current->mask; current->slots[i].entry; i = (i + 1) & current->mask) {
+            const Index::Slot& slot = current->slots[i];
+            if ((slot.hash == h) && (slot.anyIface == (key.iface == NULL)) &&
+                (strcmp(slot.entry->methodStr.c_str(), methodName) == 0) &&
+                (strcmp(slot.entry->objPathStr.c_str(), objectPath) == 0) &&
+                (slot.anyIface || (strcmp(slot.entry->ifaceStr.c_str(), key.iface) == 0))) {
+                /* Copy the entry before ending the read, after that it may be reclaimed */
+                entry = *slot.entry;
+                found = true;
+                break;
+            }
+        }
     }
-    lock.Unlock(MUTEX_CONTEXT);
-    return entry;
+    index.EndRead();
+    return found;
 }
 
 void MethodTable::RemoveAll(BusObject* object)
 {
     std::hash_map<Key, Entry*, Hash, Equal>::iterator iter;
     /*
-     * Iterate over all entries deleting all entries that reference the object
+     * Iterate over all entries removing all entries that reference the object
      */
     lock.Lock(MUTEX_CONTEXT);
     iter = hashTable.begin();
     while (iter != hashTable.end()) {
         if (iter->second->object == object) {
-            Entry* deleteMe = iter->second;
+            removed.push_back(iter->second);
             hashTable.erase(iter);
-            delete deleteMe;
             iter = hashTable.begin();
         } else {
             ++iter;
         }
     }
+    Publish();
     lock.Unlock(MUTEX_CONTEXT);
 }
 
 void MethodTable::AddAll(BusObject* object)
 {
+    /* Publish the index once for all of the object's methods */
+    lock.Lock(MUTEX_CONTEXT);
+    deferPublish = true;
     object->InstallMethods(*this);
+    deferPublish = false;
+    Publish();
+    lock.Unlock(MUTEX_CONTEXT);
 }
 
 }
-
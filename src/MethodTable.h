@@ -34,6 +34,8 @@
 
 #include <Status.h>
 
+#include "DispatchSnapshot.h"
+
 #if defined(__GNUC__) && !defined(ANDROID)
 #include <ext/hash_map>
 namespace std {
@@ -47,6 +49,9 @@ namespace ajn {
 
 /**
  * %MethodTable is a hash table that maps object paths to BusObject instances.
+ *
+ * Lookups use an immutable index that is rebuilt when objects are added or removed, so finding the
+ * handler for a method call takes no lock and makes no allocations.
  */
 class MethodTable {
 
@@ -63,21 +68,27 @@ class MethodTable {
               MessageReceiver::MethodHandler handler,
               const InterfaceDescription::Member* member,
               void* context)
-            : object(object), handler(handler), member(member), context(context), ifaceStr(member->iface->GetName()), methodStr(member->name) { }
+            : object(object), handler(handler), member(member), context(context), objPathStr(object->GetPath()), ifaceStr(member->iface->GetName()), methodStr(member->name) { }
 
         /**
          * Construct an empty Entry.
          */
-        Entry(void) : object(NULL), handler(), ifaceStr(), methodStr() { }
+        Entry(void) : object(NULL), handler(), member(NULL), context(NULL), objPathStr(), ifaceStr(), methodStr() { }
 
         BusObject* object;                             /**<  BusObject instance*/
         MessageReceiver::MethodHandler handler;        /**<  Handler for method */
         const InterfaceDescription::Member* member;    /**<  Member that handler implements  */
         void* context;                                 /**<  Optional context provided when handler was registered */
+        qcc::String objPathStr;                        /**<  Object path string */
         qcc::String ifaceStr;                          /**<  Interface string */
         qcc::String methodStr;                         /**<  Method string */
     };
 
+    /**
+     * Constructor
+     */
+    MethodTable() : deferPublish(false) { }
+
     /**
      * Destructor
      */
@@ -96,16 +107,20 @@ class MethodTable {
              void* context = NULL);
 
     /**
-     * Find an Entry based on set of criteria.
+     * Find an Entry based on set of criteria. This does not take the method table lock.
+     *
+     * The entry is copied because the one in the table can be deleted as soon as the lookup
+     * finishes if the object is unregistered concurrently.
      *
      * @param objectPath   The object path.
      * @param iface        The interface.
      * @param methodName   The method name.
+     * @param[out] entry   Returns a copy of the entry that matches objectPath, interface and method.
      * @return
-     *      - Entry that matches objectPath, interface and method
-     *      - NULL if not found
+     *      - true if a matching entry was found
+     *      - false if not found
      */
-    const Entry* Find(const char* objectPath, const char* iface, const char* methodName);
+    bool Find(const char* objectPath, const char* iface, const char* methodName, Entry& entry);
 
     /**
      * Remove all hash entries related to the specified object.
@@ -174,8 +189,46 @@ class MethodTable {
         }
     };
 
+    /**
+     * Open addressed index of the hash table used for lookups
+     */
+    struct Index {
+        /** An index slot, a slot with a NULL entry is empty */
+        struct Slot {
+            size_t hash;             /**< Hash of the key */
+            bool anyIface;           /**< true if the key has no interface */
+            const Entry* entry;      /**< The entry for the key */
+        };
+
+        Index(size_t numSlots);
+        ~Index();
+
+        std::vector<Slot> slots;       /**< Number of slots is a power of 2 */
+        size_t mask;                   /**< Number of slots - 1 */
+        std::vector<Entry*> removed;   /**< Entries removed from the hash table after this index was built */
+    };
+
+    /**
+     * Add an entry to the hash table replacing any entry with the same key, called with the lock held
+     */
+    void Insert(Entry* entry, bool anyIface);
+
+    /**
+     * Rebuild the index from the hash table, called with the lock held
+     */
+    void Publish();
+
     /** The hash table */
     std::hash_map<Key, Entry*, Hash, Equal> hashTable;
+
+    /** Entries removed from the hash table since the index was last published */
+    std::vector<Entry*> removed;
+
+    /** true while AddAll() is adding an object's methods */
+    bool deferPublish;
+
+    /** The current index */
+    DispatchSnapshot<Index> index;
 };
 
 }
@@ -0,0 +1,325 @@
+/**
+ * @file
+ * Implementation of the PropertyCache
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <map>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/Mutex.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/DBusStd.h>
+
+#include "PropertyCache.h"
+
+#include <Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+
+namespace ajn {
+
+PropertyCache::PropertyCache(BusAttachment& bus) : bus(bus), handlerRegistered(false), matchAdded(false), addingMatch(false)
+{
+}
+
+PropertyCache::~PropertyCache()
+{
+    if (handlerRegistered) {
+        bus.UnregisterAllHandlers(this);
+    }
+}
+
+QStatus PropertyCache::Enable()
+{
+    QStatus status = ER_OK;
+
+    lock.Lock(MUTEX_CONTEXT);
+    if (!handlerRegistered) {
+        const InterfaceDescription* propIntf = bus.GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+        if (propIntf) {
+            status = bus.RegisterSignalHandler(this,
+                                               static_cast<MessageReceiver::SignalHandler>(&PropertyCache::PropertiesChangedHandler),
+                                               propIntf->GetMember("PropertiesChanged"),
+                                               NULL);
+        } else {
+            status = ER_BUS_NO_SUCH_INTERFACE;
+        }
+        handlerRegistered = (status == ER_OK);
+    }
+    bool addMatch = (status == ER_OK) && !matchAdded && !addingMatch;
+    if (addMatch) {
+        addingMatch = true;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+
+    /*
+     * The match rule is added without holding the lock because it is a blocking call to the daemon.
+     */
+    if (addMatch) {
+        status = bus.AddMatch("type='signal',interface='org.freedesktop.DBus.Properties',member='PropertiesChanged'");
+        lock.Lock(MUTEX_CONTEXT);
+        addingMatch = false;
+        if (status == ER_OK) {
+            /*
+             * Signals sent before the rule was added were missed so nothing read before now
+             * can be trusted.
+             */
+            Flush();
+            matchAdded = true;
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+    return status;
+}
+
+QStatus PropertyCache::Connected()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    bool wasEnabled = handlerRegistered;
+    lock.Unlock(MUTEX_CONTEXT);
+    return wasEnabled ? Enable() : ER_OK;
+}
+
+void PropertyCache::Flush()
+{
+    for (map<ObjectKey, Object>::iterator it = objects.begin(); it != objects.end(); ++it) {
+        it->second.ifaces.clear();
+        it->second.owner.clear();
+        ++it->second.generation;
+    }
+}
+
+uint32_t PropertyCache::GetGeneration(const qcc::String& busName, const qcc::String& path)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    uint32_t generation = objects[ObjectKey(busName, path)].generation;
+    lock.Unlock(MUTEX_CONTEXT);
+    return generation;
+}
+
+PropertyCache::Object& PropertyCache::GetObject(const qcc::String& busName, const qcc::String& path, Message& reply)
+{
+    Object& obj = objects[ObjectKey(busName, path)];
+    /*
+     * Values from a previous owner of the bus name are stale
+     */
+    if (obj.owner != reply->GetSender()) {
+        obj.ifaces.clear();
+        obj.owner = reply->GetSender();
+    }
+    return obj;
+}
+
+bool PropertyCache::GetProperty(const qcc::String& busName, const qcc::String& path, const char* iface, const char* property, MsgArg& value)
+{
+    bool hit = false;
+    lock.Lock(MUTEX_CONTEXT);
+    Object& obj = objects[ObjectKey(busName, path)];
+    map<String, Interface>::iterator ifc = obj.ifaces.find(iface);
+    if (matchAdded && (ifc != obj.ifaces.end())) {
+        map<String, MsgArg>::iterator it = ifc->second.values.find(property);
+        if (it != ifc->second.values.end()) {
+            value = it->second;
+            hit = true;
+        }
+    }
+    if (hit) {
+        ++obj.hits;
+    } else {
+        ++obj.misses;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return hit;
+}
+
+bool PropertyCache::GetAllProperties(const qcc::String& busName, const qcc::String& path, const char* iface, MsgArg& values)
+{
+    bool hit = false;
+    lock.Lock(MUTEX_CONTEXT);
+    Object& obj = objects[ObjectKey(busName, path)];
+    map<String, Interface>::iterator ifc = obj.ifaces.find(iface);
+    if (matchAdded && (ifc != obj.ifaces.end()) && ifc->second.complete) {
+        size_t numProps = ifc->second.values.size();
+        MsgArg* dict = new MsgArg[numProps];
+        MsgArg* entry = dict;
+        for (map<String, MsgArg>::iterator it = ifc->second.values.begin(); it != ifc->second.values.end(); ++it) {
+            /* The cached values are variants, the dictionary entries need the values they hold */
+            entry->Set("{sv}", it->first.c_str(), it->second.v_variant.val);
+            entry++;
+        }
+        MsgArg all;
+        all.Set("a{sv}", numProps, dict);
+        /*
+         * Assignment makes a deep copy so the returned values don't refer to the cache
+         */
+        values = all;
+        all.Clear();
+        delete [] dict;
+        hit = true;
+        ++obj.hits;
+    } else {
+        ++obj.misses;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return hit;
+}
+
+void PropertyCache::SetProperty(const qcc::String& busName, const qcc::String& path, Message& reply, const char* iface, const char* property, uint32_t generation)
+{
+    const MsgArg* value = reply->GetArg(0);
+    if (value) {
+        lock.Lock(MUTEX_CONTEXT);
+        Object& obj = objects[ObjectKey(busName, path)];
+        if (matchAdded && (obj.generation == generation)) {
+            GetObject(busName, path, reply).ifaces[iface].values[property] = *value;
+        } else {
+            QCC_DbgPrintf(("Dropping stale value for %s.%s from %s", iface, property, reply->GetSender()));
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+}
+
+void PropertyCache::SetAllProperties(const qcc::String& busName, const qcc::String& path, Message& reply, const char* iface, uint32_t generation)
+{
+    const MsgArg* dict = reply->GetArg(0);
+    if (!dict || (dict->typeId != ALLJOYN_ARRAY)) {
+        return;
+    }
+    size_t numEntries = dict->v_array.GetNumElements();
+    const MsgArg* entries = dict->v_array.GetElements();
+
+    lock.Lock(MUTEX_CONTEXT);
+    Object& obj = objects[ObjectKey(busName, path)];
+    if (!matchAdded || (obj.generation != generation)) {
+        QCC_DbgPrintf(("Dropping stale values for %s from %s", iface, reply->GetSender()));
+        lock.Unlock(MUTEX_CONTEXT);
+        return;
+    }
+    Interface& ifc = GetObject(busName, path, reply).ifaces[iface];
+    ifc.values.clear();
+    for (size_t i = 0; i < numEntries; ++i) {
+        ifc.values[entries[i].v_dictEntry.key->v_string.str] = *(entries[i].v_dictEntry.val);
+    }
+    ifc.complete = true;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void PropertyCache::Invalidate(const qcc::String& busName, const qcc::String& path, const char* iface, const char* property)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    map<ObjectKey, Object>::iterator obj = objects.find(ObjectKey(busName, path));
+    if (obj != objects.end()) {
+        ++obj->second.generation;
+        map<String, Interface>::iterator ifc = obj->second.ifaces.find(iface);
+        if (ifc != obj->second.ifaces.end()) {
+            ifc->second.values.erase(property);
+            ifc->second.complete = false;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void PropertyCache::GetCounters(const qcc::String& busName, const qcc::String& path, uint32_t& hits, uint32_t& misses)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    map<ObjectKey, Object>::iterator obj = objects.find(ObjectKey(busName, path));
+    if (obj != objects.end()) {
+        hits = obj->second.hits;
+        misses = obj->second.misses;
+    } else {
+        hits = 0;
+        misses = 0;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void PropertyCache::NameOwnerChanged(const char* busName, const char* previousOwner, const char* newOwner)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    for (map<ObjectKey, Object>::iterator it = objects.begin(); it != objects.end(); ++it) {
+        if ((it->first.first == busName) || (previousOwner && (it->second.owner == previousOwner))) {
+            QCC_DbgPrintf(("Dropping cached properties for %s %s", it->first.first.c_str(), it->first.second.c_str()));
+            it->second.ifaces.clear();
+            it->second.owner.clear();
+            ++it->second.generation;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void PropertyCache::Disconnected()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    Flush();
+    matchAdded = false;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+void PropertyCache::PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+{
+    const char* iface;
+    size_t numChanged;
+    const MsgArg* changed;
+    size_t numInvalidated;
+    const MsgArg* invalidated;
+
+    QStatus status = msg->GetArgs("sa{sv}as", &iface, &numChanged, &changed, &numInvalidated, &invalidated);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Bad PropertiesChanged signal from %s", msg->GetSender()));
+        return;
+    }
+    String sender = msg->GetSender();
+
+    lock.Lock(MUTEX_CONTEXT);
+    for (map<ObjectKey, Object>::iterator it = objects.begin(); it != objects.end(); ++it) {
+        if (it->first.second != srcPath) {
+            continue;
+        }
+        /*
+         * The signal comes from the unique name, proxies may have used a well-known name. An object
+         * with no owner yet may be waiting for its first reply from this sender.
+         */
+        if ((it->second.owner != sender) && (it->first.first != sender) && !it->second.owner.empty()) {
+            continue;
+        }
+        /* A Get or GetAll reply that is still on its way may hold values older than these */
+        ++it->second.generation;
+        map<String, Interface>::iterator ifc = it->second.ifaces.find(iface);
+        if (ifc == it->second.ifaces.end()) {
+            continue;
+        }
+        for (size_t i = 0; i < numChanged; ++i) {
+            ifc->second.values[changed[i].v_dictEntry.key->v_string.str] = *(changed[i].v_dictEntry.val);
+        }
+        for (size_t i = 0; i < numInvalidated; ++i) {
+            ifc->second.values.erase(invalidated[i].v_string.str);
+            ifc->second.complete = false;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+}
@@ -0,0 +1,234 @@
+/**
+ * @file
+ * PropertyCache holds property values read by proxy objects so that repeated reads of values that
+ * rarely change do not have to go to the remote object.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_PROPERTYCACHE_H
+#define _ALLJOYN_PROPERTYCACHE_H
+
+#ifndef __cplusplus
+#error Only include PropertyCache.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <map>
+
+#include <qcc/String.h>
+#include <qcc/Mutex.h>
+
+#include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MessageReceiver.h>
+#include <alljoyn/MsgArg.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/** @internal Forward references */
+class BusAttachment;
+
+/**
+ * The property cache for a bus attachment. Values are kept per remote object, identified by the bus
+ * name and object path the proxy objects use, so all proxies for the same remote object share the
+ * cached values.
+ *
+ * Cached values are updated or invalidated by the org.freedesktop.DBus.Properties.PropertiesChanged
+ * signal from the remote object and are dropped when the bus name changes owner. A remote object
+ * that doesn't emit PropertiesChanged will have stale values in the cache so caching must only be
+ * enabled for interfaces where the remote object is known to emit the signal.
+ */
+class PropertyCache : public MessageReceiver {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param bus  The bus attachment that owns the cache.
+     */
+    PropertyCache(BusAttachment& bus);
+
+    /**
+     * Destructor
+     */
+    ~PropertyCache();
+
+    /**
+     * Start listening for PropertiesChanged signals. Called the first time a proxy object enables
+     * caching, this makes a blocking call to the daemon the first time it is called on a connection.
+     * The cache misses until the daemon has added the match rule.
+     *
+     * @return ER_OK if the cache is listening for PropertiesChanged signals.
+     */
+    QStatus Enable();
+
+    /**
+     * Get the generation of the cached values for a remote object. The generation changes whenever
+     * a value may have been changed by the remote object, it is read before a Get or GetAll call
+     * so a reply that crossed with a PropertiesChanged signal doesn't overwrite the newer value.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     *
+     * @return  The generation to pass to SetProperty() or SetAllProperties().
+     */
+    uint32_t GetGeneration(const qcc::String& busName, const qcc::String& path);
+
+    /**
+     * Look up a cached property value, counts a hit or a miss for the remote object.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     * @param iface     The interface the property belongs to.
+     * @param property  The property name.
+     * @param value     Returns the property value as a variant.
+     *
+     * @return  true if the value was in the cache.
+     */
+    bool GetProperty(const qcc::String& busName, const qcc::String& path, const char* iface, const char* property, MsgArg& value);
+
+    /**
+     * Look up all the cached property values for an interface, this only succeeds if the values
+     * were populated by a GetAll call. Counts a hit or a miss for the remote object.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     * @param iface     The interface to get the properties for.
+     * @param values    Returns the property values as an a{sv}.
+     *
+     * @return  true if all the values were in the cache.
+     */
+    bool GetAllProperties(const qcc::String& busName, const qcc::String& path, const char* iface, MsgArg& values);
+
+    /**
+     * Add a property value read from a remote object.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     * @param reply       The Properties.Get reply.
+     * @param iface       The interface the property belongs to.
+     * @param property    The property name.
+     * @param generation  The generation read before the call was made, the value is dropped if
+     *                    the cached values have changed since.
+     */
+    void SetProperty(const qcc::String& busName, const qcc::String& path, Message& reply, const char* iface, const char* property, uint32_t generation);
+
+    /**
+     * Add all the property values for an interface read from a remote object.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     * @param reply       The Properties.GetAll reply.
+     * @param iface       The interface the properties belong to.
+     * @param generation  The generation read before the call was made, the values are dropped if
+     *                    the cached values have changed since.
+     */
+    void SetAllProperties(const qcc::String& busName, const qcc::String& path, Message& reply, const char* iface, uint32_t generation);
+
+    /**
+     * Drop a cached property value.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     * @param iface     The interface the property belongs to.
+     * @param property  The property name.
+     */
+    void Invalidate(const qcc::String& busName, const qcc::String& path, const char* iface, const char* property);
+
+    /**
+     * Get the number of cache hits and misses for a remote object.
+     *
+     * @param busName   The bus name used to reach the remote object.
+     * @param path      The object path of the remote object.
+     * @param hits      Returns the number of reads served from the cache.
+     * @param misses    Returns the number of reads that had to go to the remote object.
+     */
+    void GetCounters(const qcc::String& busName, const qcc::String& path, uint32_t& hits, uint32_t& misses);
+
+    /**
+     * Called when a bus name changes owner, drops the values for objects reached through that name.
+     *
+     * @param busName        The bus name that changed owner.
+     * @param previousOwner  The previous owner or NULL.
+     * @param newOwner       The new owner or NULL.
+     */
+    void NameOwnerChanged(const char* busName, const char* previousOwner, const char* newOwner);
+
+    /**
+     * Called when the bus attachment disconnects, drops all cached values. The match rule is gone
+     * with the connection so the cache misses until Connected() adds it again.
+     */
+    void Disconnected();
+
+    /**
+     * Called when the bus attachment connects, adds the match rule again if caching was enabled
+     * on an earlier connection. This makes a blocking call to the daemon.
+     *
+     * @return ER_OK if the match rule was added or was not needed.
+     */
+    QStatus Connected();
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    PropertyCache(const PropertyCache& other);
+    PropertyCache& operator=(const PropertyCache& other);
+
+    /**
+     * Handler for the PropertiesChanged signal.
+     */
+    void PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg);
+
+    /** Cached values for one interface */
+    struct Interface {
+        Interface() : complete(false) { }
+        std::map<qcc::String, MsgArg> values;  /**< Property values as variants */
+        bool complete;                         /**< true if values has all of the interface's properties */
+    };
+
+    /** Cached values for one remote object */
+    struct Object {
+        Object() : generation(0), hits(0), misses(0) { }
+        qcc::String owner;                             /**< Unique name of the sender of the cached values */
+        std::map<qcc::String, Interface> ifaces;       /**< Cached values by interface name */
+        uint32_t generation;                           /**< Changed whenever the remote values may have changed */
+        uint32_t hits;                                 /**< Reads served from the cache */
+        uint32_t misses;                               /**< Reads that went to the remote object */
+    };
+
+    /** Remote objects are identified by bus name and object path */
+    typedef std::pair<qcc::String, qcc::String> ObjectKey;
+
+    Object& GetObject(const qcc::String& busName, const qcc::String& path, Message& reply);
+
+    /** Drop all cached values and start a new generation for every object, called with the lock held */
+    void Flush();
+
+    BusAttachment& bus;                       /**< The bus attachment that owns the cache */
+    std::map<ObjectKey, Object> objects;      /**< The cached values */
+    qcc::Mutex lock;                          /**< Protects the cached values and flags */
+    bool handlerRegistered;                   /**< true if the PropertiesChanged handler is registered */
+    bool matchAdded;                          /**< true if the match rule was added on this connection */
+    bool addingMatch;                         /**< true while a call to add the match rule is in progress */
+};
+
+}
+
+#endif
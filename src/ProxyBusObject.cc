@@ -25,16 +25,16 @@
 #include <assert.h>
 #include <vector>
 #include <map>
+#include <set>
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
-#include <qcc/StringSource.h>
-#include <qcc/XmlElement.h>
 #include <qcc/Util.h>
 #include <qcc/Event.h>
 #include <qcc/Mutex.h>
 
 #include <alljoyn/BusAttachment.h>
+#include <alljoyn/AllJoynStd.h>
 #include <alljoyn/DBusStd.h>
 #include <alljoyn/Message.h>
 #include <alljoyn/ProxyBusObject.h>
@@ -44,6 +44,7 @@
 #include "LocalTransport.h"
 #include "AllJoynPeerObj.h"
 #include "BusInternal.h"
+#include "IntrospectionCache.h"
 #include "XmlHelper.h"
 
 #include <Status.h>
@@ -68,6 +69,9 @@ struct ProxyBusObject::Components {
 
     /** List of threads that are waiting in sync method calls */
     vector<Thread*> waitingThreads;
+
+    /** Interfaces that have property caching enabled */
+    set<qcc::String> cachedIfaces;
 };
 
 QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value) const
@@ -81,6 +85,13 @@ QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value) const
         if (valueIface->IsSecure()) {
             flags |= ALLJOYN_FLAG_ENCRYPTED;
         }
+        bool cached = IsPropertyCached(iface);
+        PropertyCache& cache = bus->GetInternal().GetPropertyCache();
+        if (cached && cache.GetAllProperties(serviceName, path, iface, value)) {
+            return ER_OK;
+        }
+        /* Values that change while the call is in progress must not be overwritten by the reply */
+        uint32_t generation = cached ? cache.GetGeneration(serviceName, path) : 0;
         Message reply(*bus);
         MsgArg arg = MsgArg("s", iface);
         const InterfaceDescription* propIface = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
@@ -95,6 +106,9 @@ QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value) const
                                 flags);
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
+                if (cached) {
+                    cache.SetAllProperties(serviceName, path, reply, iface, generation);
+                }
             }
         }
     }
@@ -112,6 +126,13 @@ QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, Msg
         if (valueIface->IsSecure()) {
             flags |= ALLJOYN_FLAG_ENCRYPTED;
         }
+        bool cached = IsPropertyCached(iface);
+        PropertyCache& cache = bus->GetInternal().GetPropertyCache();
+        if (cached && cache.GetProperty(serviceName, path, iface, property, value)) {
+            return ER_OK;
+        }
+        /* A value that changes while the call is in progress must not be overwritten by the reply */
+        uint32_t generation = cached ? cache.GetGeneration(serviceName, path) : 0;
         Message reply(*bus);
         MsgArg inArgs[2];
         size_t numArgs = ArraySize(inArgs);
@@ -128,6 +149,9 @@ QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, Msg
                                 flags);
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
+                if (cached) {
+                    cache.SetProperty(serviceName, path, reply, iface, property, generation);
+                }
             }
         }
     }
@@ -159,11 +183,45 @@ QStatus ProxyBusObject::SetProperty(const char* iface, const char* property, Msg
                                 reply,
                                 DefaultCallTimeout,
                                 flags);
+            /*
+             * The remote object may not store exactly the value that was set so drop the cached
+             * value, the PropertiesChanged signal will put the actual value back.
+             */
+            if ((ER_OK == status) && IsPropertyCached(iface)) {
+                bus->GetInternal().GetPropertyCache().Invalidate(serviceName, path, iface, property);
+            }
         }
     }
     return status;
 }
 
+QStatus ProxyBusObject::EnablePropertyCaching(const char* iface)
+{
+    if (!bus->GetInterface(iface)) {
+        return ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    }
+    QStatus status = bus->GetInternal().GetPropertyCache().Enable();
+    if (status == ER_OK) {
+        lock->Lock(MUTEX_CONTEXT);
+        components->cachedIfaces.insert(iface);
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+    return status;
+}
+
+bool ProxyBusObject::IsPropertyCached(const char* iface) const
+{
+    lock->Lock(MUTEX_CONTEXT);
+    bool cached = components->cachedIfaces.find(iface) != components->cachedIfaces.end();
+    lock->Unlock(MUTEX_CONTEXT);
+    return cached;
+}
+
+void ProxyBusObject::GetPropertyCacheCounters(uint32_t& hits, uint32_t& misses) const
+{
+    bus->GetInternal().GetPropertyCache().GetCounters(serviceName, path, hits, misses);
+}
+
 size_t ProxyBusObject::GetInterfaces(const InterfaceDescription** ifaces, size_t numIfaces) const
 {
     lock->Lock(MUTEX_CONTEXT);
@@ -489,6 +547,26 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                                    Message& replyMsg,
                                    uint32_t timeout,
                                    uint8_t flags) const
+{
+    return SyncMethodCall(method, args, numArgs, NULL, replyMsg, timeout, flags);
+}
+
+QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
+                                   const TypedMsgArgs& args,
+                                   Message& replyMsg,
+                                   uint32_t timeout,
+                                   uint8_t flags) const
+{
+    return SyncMethodCall(method, NULL, 0, &args, replyMsg, timeout, flags);
+}
+
+QStatus ProxyBusObject::SyncMethodCall(const InterfaceDescription::Member& method,
+                                       const MsgArg* args,
+                                       size_t numArgs,
+                                       const TypedMsgArgs* typedArgs,
+                                       Message& replyMsg,
+                                       uint32_t timeout,
+                                       uint8_t flags) const
 {
     QStatus status;
     uint32_t serial;
@@ -536,7 +614,8 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                           serial,
                           args,
                           numArgs,
-                          flags);
+                          flags,
+                          typedArgs);
     if (status != ER_OK) {
         goto MethodCallExit;
     }
@@ -687,11 +766,43 @@ QStatus ProxyBusObject::IntrospectRemoteObject()
         AddInterface(*introIntf);
     }
 
+    /*
+     * If the introspection cache is enabled ask the remote object for the hash of its introspection
+     * data, there is no need to fetch and parse the XML if the hash is in the cache. Remote objects
+     * that don't support the hash query are introspected as normal.
+     */
+    QStatus status;
+    qcc::String hash;
+    IntrospectionCache& cache = IntrospectionCache::GetCache();
+    if (cache.IsEnabled()) {
+        const InterfaceDescription* hashIntf = GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+        if (!hashIntf) {
+            hashIntf = bus->GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+            assert(hashIntf);
+            AddInterface(*hashIntf);
+        }
+        Message hashReply(*bus);
+        const InterfaceDescription::Member* hashMember = hashIntf->GetMember("GetIntrospectionHash");
+        assert(hashMember);
+        status = MethodCall(*hashMember, NULL, 0, hashReply, DefaultCallTimeout);
+        if (ER_OK == status) {
+            hash = hashReply->GetArg(0)->v_string.str;
+            qcc::String ident = hashReply->GetSender();
+            ident += " : ";
+            ident += hashReply->GetObjectPath();
+            if (cache.AddProxyObjects(hash, *this, ident.c_str(), status)) {
+                return status;
+            }
+        } else {
+            QCC_DbgPrintf(("No introspection hash for %s %s", serviceName.c_str(), path.c_str()));
+        }
+    }
+
     /* Attempt to retrieve introspection from the remote object using sync call */
     Message reply(*bus);
     const InterfaceDescription::Member* introMember = introIntf->GetMember("Introspect");
     assert(introMember);
-    QStatus status = MethodCall(*introMember, NULL, 0, reply, DefaultCallTimeout);
+    status = MethodCall(*introMember, NULL, 0, reply, DefaultCallTimeout);
 
     /* Parse the XML reply */
     if (ER_OK == status) {
@@ -699,7 +810,11 @@ QStatus ProxyBusObject::IntrospectRemoteObject()
         qcc::String ident = reply->GetSender();
         ident += " : ";
         ident += reply->GetObjectPath();
-        status = ParseXml(reply->GetArg(0)->v_string.str, ident.c_str());
+        if (hash.empty()) {
+            status = ParseXml(reply->GetArg(0)->v_string.str, ident.c_str());
+        } else {
+            status = cache.ParseXml(hash, reply->GetArg(0)->v_string.str, reply->GetSender(), *this, ident.c_str());
+        }
     }
     return status;
 }
@@ -709,6 +824,7 @@ struct _IntrospectMethodCBContext {
     ProxyBusObject::Listener* listener;
     ProxyBusObject::Listener::IntrospectCB callback;
     void* context;
+    qcc::String hash;
     _IntrospectMethodCBContext(ProxyBusObject* obj, ProxyBusObject::Listener* listener, ProxyBusObject::Listener::IntrospectCB callback, void* context)
         : obj(obj), listener(listener), callback(callback), context(context) { }
 };
@@ -725,21 +841,74 @@ QStatus ProxyBusObject::IntrospectRemoteObjectAsync(ProxyBusObject::Listener* li
         AddInterface(*introIntf);
     }
 
+    QStatus status;
+    _IntrospectMethodCBContext* ctx = new _IntrospectMethodCBContext(this, listener, callback, context);
+    if (IntrospectionCache::GetCache().IsEnabled()) {
+        /* Ask for the introspection hash first, IntrospectHashCB falls back to Introspect on a miss */
+        const InterfaceDescription* hashIntf = GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+        if (!hashIntf) {
+            hashIntf = bus->GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+            assert(hashIntf);
+            AddInterface(*hashIntf);
+        }
+        const InterfaceDescription::Member* hashMember = hashIntf->GetMember("GetIntrospectionHash");
+        assert(hashMember);
+        status = MethodCallAsync(*hashMember,
+                                 this,
+                                 static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::IntrospectHashCB),
+                                 NULL,
+                                 0,
+                                 reinterpret_cast<void*>(ctx),
+                                 5000);
+    } else {
+        status = IntrospectAsync(ctx);
+    }
+    if (ER_OK != status) {
+        delete ctx;
+    }
+    return status;
+}
+
+QStatus ProxyBusObject::IntrospectAsync(void* context)
+{
     /* Attempt to retrieve introspection from the remote object using async call */
+    const InterfaceDescription* introIntf = GetInterface(org::freedesktop::DBus::Introspectable::InterfaceName);
+    assert(introIntf);
     const InterfaceDescription::Member* introMember = introIntf->GetMember("Introspect");
     assert(introMember);
-    _IntrospectMethodCBContext* ctx = new _IntrospectMethodCBContext(this, listener, callback, context);
-    QStatus status = MethodCallAsync(*introMember,
-                                     this,
-                                     static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::IntrospectMethodCB),
-                                     NULL,
-                                     0,
-                                     reinterpret_cast<void*>(ctx),
-                                     5000);
+    return MethodCallAsync(*introMember,
+                           this,
+                           static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::IntrospectMethodCB),
+                           NULL,
+                           0,
+                           context,
+                           5000);
+}
+
+void ProxyBusObject::IntrospectHashCB(Message& msg, void* context)
+{
+    _IntrospectMethodCBContext* ctx = reinterpret_cast<_IntrospectMethodCBContext*>(context);
+    QStatus status;
+
+    if (msg->GetType() == MESSAGE_METHOD_RET) {
+        ctx->hash = msg->GetArg(0)->v_string.str;
+        qcc::String ident = msg->GetSender();
+        ident += " : ";
+        ident += msg->GetObjectPath();
+        if (IntrospectionCache::GetCache().AddProxyObjects(ctx->hash, *this, ident.c_str(), status)) {
+            (ctx->listener->*ctx->callback)(status, ctx->obj, ctx->context);
+            delete ctx;
+            return;
+        }
+    } else {
+        QCC_DbgPrintf(("No introspection hash for %s %s", serviceName.c_str(), path.c_str()));
+    }
+    /* Not in the cache or the remote object doesn't support the hash query */
+    status = IntrospectAsync(ctx);
     if (ER_OK != status) {
+        (ctx->listener->*ctx->callback)(status, ctx->obj, ctx->context);
         delete ctx;
     }
-    return status;
 }
 
 void ProxyBusObject::IntrospectMethodCB(Message& msg, void* context)
@@ -754,7 +923,11 @@ void ProxyBusObject::IntrospectMethodCB(Message& msg, void* context)
         qcc::String ident = msg->GetSender();
         ident += " : ";
         ident += msg->GetObjectPath();
-        status = ParseXml(msg->GetArg(0)->v_string.str, ident.c_str());
+        if (ctx->hash.empty()) {
+            status = ParseXml(msg->GetArg(0)->v_string.str, ident.c_str());
+        } else {
+            status = IntrospectionCache::GetCache().ParseXml(ctx->hash, msg->GetArg(0)->v_string.str, msg->GetSender(), *this, ident.c_str());
+        }
     } else if ((msg->GetType() == MESSAGE_ERROR) && (::strcmp("org.freedesktop.DBus.Error.ServiceUnknown", msg->GetErrorName()) == 0)) {
         status = ER_BUS_NO_SUCH_SERVICE;
     } else {
@@ -766,18 +939,21 @@ void ProxyBusObject::IntrospectMethodCB(Message& msg, void* context)
     delete ctx;
 }
 
-QStatus ProxyBusObject::ParseXml(const char* xml, const char* ident)
+QStatus ProxyBusObject::EnableIntrospectionCache(const char* fileName)
+{
+    return IntrospectionCache::GetCache().Enable(fileName);
+}
+
+void ProxyBusObject::GetIntrospectionCacheCounters(uint32_t& hits, uint32_t& misses)
 {
-    StringSource source(xml);
+    IntrospectionCache::GetCache().GetCounters(hits, misses);
+}
 
+QStatus ProxyBusObject::ParseXml(const char* xml, const char* ident)
+{
     /* Parse the XML to update this ProxyBusObject instance (plus any new children and interfaces) */
-    XmlParseContext pc(source);
-    QStatus status = XmlElement::Parse(pc);
-    if (status == ER_OK) {
-        XmlHelper xmlHelper(bus, ident ? ident : path.c_str());
-        status = xmlHelper.AddProxyObjects(*this, pc.GetRoot());
-    }
-    return status;
+    XmlHelper xmlHelper(bus, ident ? ident : path.c_str());
+    return xmlHelper.AddProxyObjects(*this, xml);
 }
 
 ProxyBusObject::~ProxyBusObject()
@@ -888,4 +1064,302 @@ void ProxyBusObject::SetB2BEndpoint(RemoteEndpoint* b2bEp)
     this->b2bEp = b2bEp;
 }
 
+/*
+ * Slot value for requests that are not part of a coalesced property read
+ */
+static const size_t NO_SLOT = static_cast<size_t>(-1);
+
+struct ProxyBusObject::Batch::Calls {
+
+    /** A method call or property read added to the batch */
+    struct Request {
+        Request(BusAttachment& bus) : method(NULL), flags(0), isSecure(false), slot(NO_SLOT), status(ER_OK), done(false), reply(bus) { }
+
+        const InterfaceDescription::Member* method;  /**< Method to call or NULL for a property read */
+        vector<MsgArg> args;                         /**< Copy of the method call arguments */
+        uint8_t flags;                               /**< Method call flags */
+        qcc::String iface;                           /**< Interface of a property read */
+        qcc::String property;                        /**< Name of a property read */
+        bool isSecure;                               /**< True if the property interface is secure */
+        size_t slot;                                 /**< Position in a GetMulti reply */
+        QStatus status;                              /**< Completion status */
+        bool done;                                   /**< True when the reply has arrived */
+        Message reply;                               /**< The reply message */
+    };
+
+    Calls() : sent(false), outstanding(0) { }
+
+    /** The requests in the order they were added */
+    vector<Request> requests;
+
+    /** The requests carried by each method call that was sent */
+    vector<vector<size_t> > sentCalls;
+
+    bool sent;           /**< True once Send() has been called */
+    size_t outstanding;  /**< Number of sent method calls that have not completed */
+    Mutex lock;          /**< Protects the requests and outstanding count */
+    Event done;          /**< Set when all the sent method calls have completed */
+};
+
+ProxyBusObject::Batch::Batch(const ProxyBusObject& proxy) : proxy(proxy), calls(new Calls)
+{
+}
+
+ProxyBusObject::Batch::~Batch()
+{
+    /* Discard any replies that are still outstanding */
+    if (proxy.bus) {
+        proxy.bus->UnregisterAllHandlers(this);
+    }
+    delete calls;
+}
+
+QStatus ProxyBusObject::Batch::AddMethodCall(const InterfaceDescription::Member& method,
+                                             size_t& index,
+                                             const MsgArg* args,
+                                             size_t numArgs,
+                                             uint8_t flags)
+{
+    QStatus status = ER_OK;
+    calls->lock.Lock(MUTEX_CONTEXT);
+    if (calls->sent) {
+        status = ER_BUS_BATCH_ALREADY_SENT;
+    } else {
+        Calls::Request req(*proxy.bus);
+        req.method = &method;
+        req.args.assign(args, args + numArgs);
+        req.flags = flags;
+        index = calls->requests.size();
+        calls->requests.push_back(req);
+    }
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus ProxyBusObject::Batch::AddMethodCall(const char* ifaceName,
+                                             const char* methodName,
+                                             size_t& index,
+                                             const MsgArg* args,
+                                             size_t numArgs,
+                                             uint8_t flags)
+{
+    const InterfaceDescription* iface = proxy.GetInterface(ifaceName);
+    if (!iface) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+    const InterfaceDescription::Member* member = iface->GetMember(methodName);
+    if (!member) {
+        return ER_BUS_INTERFACE_NO_SUCH_MEMBER;
+    }
+    return AddMethodCall(*member, index, args, numArgs, flags);
+}
+
+QStatus ProxyBusObject::Batch::AddGetProperty(const char* iface, const char* property, size_t& index)
+{
+    const InterfaceDescription* valueIface = proxy.bus->GetInterface(iface);
+    if (!valueIface) {
+        return ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    }
+    QStatus status = ER_OK;
+    calls->lock.Lock(MUTEX_CONTEXT);
+    if (calls->sent) {
+        status = ER_BUS_BATCH_ALREADY_SENT;
+    } else {
+        Calls::Request req(*proxy.bus);
+        req.iface = iface;
+        req.property = property;
+        req.isSecure = valueIface->IsSecure();
+        index = calls->requests.size();
+        calls->requests.push_back(req);
+    }
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+size_t ProxyBusObject::Batch::Size() const
+{
+    calls->lock.Lock(MUTEX_CONTEXT);
+    size_t size = calls->requests.size();
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    return size;
+}
+
+QStatus ProxyBusObject::Batch::Send(uint32_t timeout)
+{
+    calls->lock.Lock(MUTEX_CONTEXT);
+    if (calls->sent) {
+        calls->lock.Unlock(MUTEX_CONTEXT);
+        return ER_BUS_BATCH_ALREADY_SENT;
+    }
+    calls->sent = true;
+    /*
+     * Each method call is sent on its own. Property reads are coalesced into a single GetMulti call
+     * if there is more than one and the remote object supports it.
+     */
+    vector<size_t> props;
+    for (size_t i = 0; i < calls->requests.size(); ++i) {
+        if (calls->requests[i].method) {
+            calls->sentCalls.push_back(vector<size_t>(1, i));
+        } else {
+            props.push_back(i);
+        }
+    }
+    if ((props.size() > 1) && proxy.ImplementsInterface(org::alljoyn::Bus::Properties::InterfaceName)) {
+        for (size_t i = 0; i < props.size(); ++i) {
+            calls->requests[props[i]].slot = i;
+        }
+        calls->sentCalls.push_back(props);
+    } else {
+        for (size_t i = 0; i < props.size(); ++i) {
+            calls->sentCalls.push_back(vector<size_t>(1, props[i]));
+        }
+    }
+    calls->outstanding = calls->sentCalls.size();
+    if (calls->outstanding == 0) {
+        calls->done.SetEvent();
+    }
+    calls->lock.Unlock(MUTEX_CONTEXT);
+
+    /*
+     * The requests and sent calls don't change from here on so can be read without holding the
+     * lock while the calls are being pushed.
+     */
+    const InterfaceDescription* propIface = proxy.bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+    const InterfaceDescription* multiIface = proxy.bus->GetInterface(org::alljoyn::Bus::Properties::InterfaceName);
+    MessageReceiver::ReplyHandler handler = static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::Batch::ReplyHandler);
+    for (size_t c = 0; c < calls->sentCalls.size(); ++c) {
+        const vector<size_t>& reqs = calls->sentCalls[c];
+        const Calls::Request& req = calls->requests[reqs[0]];
+        void* context = reinterpret_cast<void*>(c);
+        QStatus status;
+        if (req.method) {
+            status = proxy.MethodCallAsync(*req.method, this, handler, req.args.empty() ? NULL : &req.args[0], req.args.size(), context, timeout, req.flags);
+        } else if (req.slot != NO_SLOT) {
+            uint8_t flags = 0;
+            MsgArg* entries = new MsgArg[reqs.size()];
+            for (size_t i = 0; i < reqs.size(); ++i) {
+                const Calls::Request& prop = calls->requests[reqs[i]];
+                entries[i].Set("(ss)", prop.iface.c_str(), prop.property.c_str());
+                if (prop.isSecure) {
+                    flags |= ALLJOYN_FLAG_ENCRYPTED;
+                }
+            }
+            MsgArg inArg("a(ss)", reqs.size(), entries);
+            status = proxy.MethodCallAsync(*(multiIface->GetMember("GetMulti")), this, handler, &inArg, 1, context, timeout, flags);
+            delete [] entries;
+        } else if (propIface == NULL) {
+            status = ER_BUS_NO_SUCH_INTERFACE;
+        } else {
+            uint8_t flags = req.isSecure ? ALLJOYN_FLAG_ENCRYPTED : 0;
+            MsgArg inArgs[2];
+            size_t numArgs = ArraySize(inArgs);
+            MsgArg::Set(inArgs, numArgs, "ss", req.iface.c_str(), req.property.c_str());
+            status = proxy.MethodCallAsync(*(propIface->GetMember("Get")), this, handler, inArgs, numArgs, context, timeout, flags);
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to send call %u of batch for %s", (uint32_t)c, proxy.path.c_str()));
+            CompleteCall(c, NULL, status);
+        }
+    }
+    return ER_OK;
+}
+
+QStatus ProxyBusObject::Batch::Wait(uint32_t maxWaitMs)
+{
+    calls->lock.Lock(MUTEX_CONTEXT);
+    bool sent = calls->sent;
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    if (!sent) {
+        return ER_BUS_BATCH_NOT_SENT;
+    }
+    if (!Thread::GetThread()->CanBlock(proxy.bus)) {
+        QCC_LogError(ER_BUS_BLOCKING_CALL_NOT_ALLOWED, ("Waiting for a batch from inside a handler is not allowed"));
+        return ER_BUS_BLOCKING_CALL_NOT_ALLOWED;
+    }
+    return Event::Wait(calls->done, maxWaitMs);
+}
+
+bool ProxyBusObject::Batch::IsComplete() const
+{
+    calls->lock.Lock(MUTEX_CONTEXT);
+    bool complete = calls->sent && (calls->outstanding == 0);
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    return complete;
+}
+
+QStatus ProxyBusObject::Batch::GetReply(size_t index, Message& reply) const
+{
+    QStatus status;
+    calls->lock.Lock(MUTEX_CONTEXT);
+    if ((index >= calls->requests.size()) || !calls->requests[index].method) {
+        status = ER_BAD_ARG_1;
+    } else if (!calls->requests[index].done) {
+        status = ER_BUS_BATCH_NOT_SENT;
+    } else {
+        reply = calls->requests[index].reply;
+        status = calls->requests[index].status;
+    }
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus ProxyBusObject::Batch::GetProperty(size_t index, MsgArg& value) const
+{
+    QStatus status;
+    calls->lock.Lock(MUTEX_CONTEXT);
+    if ((index >= calls->requests.size()) || calls->requests[index].method) {
+        status = ER_BAD_ARG_1;
+    } else if (!calls->requests[index].done) {
+        status = ER_BUS_BATCH_NOT_SENT;
+    } else if (calls->requests[index].status != ER_OK) {
+        status = calls->requests[index].status;
+    } else {
+        Calls::Request& req = calls->requests[index];
+        const MsgArg* arg = req.reply->GetArg(0);
+        if (!arg) {
+            status = ER_BUS_BAD_VALUE;
+        } else if (req.slot == NO_SLOT) {
+            value = *arg;
+            status = ER_OK;
+        } else if ((arg->typeId != ALLJOYN_ARRAY) || (req.slot >= arg->v_array.GetNumElements())) {
+            status = ER_BUS_BAD_VALUE;
+        } else {
+            /* Each entry in the GetMulti reply is a status and a value */
+            const MsgArg& entry = arg->v_array.GetElements()[req.slot];
+            status = static_cast<QStatus>(entry.v_struct.members[0].v_uint32);
+            if (status == ER_OK) {
+                value = entry.v_struct.members[1];
+            }
+        }
+    }
+    calls->lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+void ProxyBusObject::Batch::ReplyHandler(Message& msg, void* context)
+{
+    CompleteCall(reinterpret_cast<size_t>(context), &msg, ER_OK);
+}
+
+void ProxyBusObject::Batch::CompleteCall(size_t call, Message* msg, QStatus status)
+{
+    calls->lock.Lock(MUTEX_CONTEXT);
+    const vector<size_t>& reqs = calls->sentCalls[call];
+    for (size_t i = 0; i < reqs.size(); ++i) {
+        Calls::Request& req = calls->requests[reqs[i]];
+        if (msg) {
+            req.reply = *msg;
+            req.status = ((*msg)->GetType() == MESSAGE_ERROR) ? ER_BUS_REPLY_IS_ERROR_MESSAGE : ER_OK;
+        } else {
+            req.reply->ErrorMsg(status, 0);
+            req.status = status;
+        }
+        req.done = true;
+    }
+    if (--calls->outstanding == 0) {
+        calls->done.SetEvent();
+    }
+    calls->lock.Unlock(MUTEX_CONTEXT);
+}
+
 }
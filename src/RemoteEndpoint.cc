@@ -28,6 +28,7 @@
 #include <qcc/Thread.h>
 #include <qcc/SocketStream.h>
 #include <qcc/atomic.h>
+#include <qcc/time.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/AllJoynStd.h>
@@ -37,10 +38,8 @@
 #include "LocalTransport.h"
 #include "AllJoynPeerObj.h"
 #include "BusInternal.h"
-
-#ifndef NDEBUG
-#include <qcc/time.h>
-#endif
+#include "EndpointStats.h"
+#include "MessageTrace.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -71,7 +70,9 @@ RemoteEndpoint::RemoteEndpoint(BusAttachment& bus,
     rxThread(bus, (qcc::String(incoming ? "rx-srv-" : "rx-cli-") + threadName + "-" + U32ToString(threadCount)).c_str(), incoming),
     txThread(bus, (qcc::String(incoming ? "tx-srv-" : "tx-cli-") + threadName + "-" + U32ToString(threadCount)).c_str(), txQueue, txWaitQueue, txQueueLock),
     connSpec(connectSpec),
+    transportName(threadName),
     incoming(incoming),
+    traceHistograms(NULL),
     processId(-1),
     refCount(0),
     isSocket(isSocket),
@@ -92,6 +93,10 @@ RemoteEndpoint::~RemoteEndpoint()
 
     /* Wait for thread to shutdown */
     Join();
+
+    EndpointStats::Unregister(this);
+
+    delete traceHistograms;
 }
 
 QStatus RemoteEndpoint::SetLinkTimeout(uint32_t idleTimeout, uint32_t probeTimeout, uint32_t maxIdleProbes)
@@ -135,6 +140,9 @@ QStatus RemoteEndpoint::Start()
     if (ER_OK == status) {
         status = router.RegisterEndpoint(*this, false);
     }
+    if (ER_OK == status) {
+        EndpointStats::Register(this);
+    }
 
     /* Start the Rx thread */
     if (ER_OK == status) {
@@ -153,6 +161,7 @@ QStatus RemoteEndpoint::Start()
             rxThread.Join();
         }
         router.UnregisterEndpoint(*this);
+        EndpointStats::Unregister(this);
         QCC_LogError(status, ("AllJoynRemoteEndoint::Start failed"));
     }
 
@@ -168,11 +177,13 @@ QStatus RemoteEndpoint::Stop(void)
 {
     QCC_DbgPrintf(("RemoteEndpoint::Stop(%s) called\n", GetUniqueName().c_str()));
 
-    /* Alert any threads that are on the wait queue */
+    /* Alert any threads that are on the wait queues */
     txQueueLock.Lock(MUTEX_CONTEXT);
-    deque<Thread*>::iterator it = txWaitQueue.begin();
-    while (it != txWaitQueue.end()) {
-        (*it++)->Alert(ENDPOINT_IS_DEAD_ALERTCODE);
+    for (size_t lane = 0; lane < TxLaneQueue::NUM_LANES; ++lane) {
+        list<Thread*>::iterator it = txWaitQueue[lane].begin();
+        while (it != txWaitQueue[lane].end()) {
+            (*it++)->Alert(ENDPOINT_IS_DEAD_ALERTCODE);
+        }
     }
     txQueueLock.Unlock(MUTEX_CONTEXT);
 
@@ -197,7 +208,7 @@ QStatus RemoteEndpoint::StopAfterTxEmpty(uint32_t maxWaitMs)
     /* Wait for txqueue to empty before triggering stop */
     txQueueLock.Lock(MUTEX_CONTEXT);
     while (true) {
-        if (txQueue.empty() || (maxWaitMs && (qcc::GetTimestamp() > (startTime + maxWaitMs)))) {
+        if ((txQueue.Size() == 0) || (maxWaitMs && (qcc::GetTimestamp() > (startTime + maxWaitMs)))) {
             status = Stop();
             break;
         } else {
@@ -242,10 +253,13 @@ void RemoteEndpoint::ThreadExit(Thread* thread)
     } else {
         /* This is notification of a txQueue waiter has died. Remove him */
         txQueueLock.Lock(MUTEX_CONTEXT);
-        deque<Thread*>::iterator it = find(txWaitQueue.begin(), txWaitQueue.end(), thread);
-        if (it != txWaitQueue.end()) {
-            (*it)->RemoveAuxListener(this);
-            txWaitQueue.erase(it);
+        for (size_t lane = 0; lane < TxLaneQueue::NUM_LANES; ++lane) {
+            list<Thread*>::iterator it = find(txWaitQueue[lane].begin(), txWaitQueue[lane].end(), thread);
+            if (it != txWaitQueue[lane].end()) {
+                (*it)->RemoveAuxListener(this);
+                txWaitQueue[lane].erase(it);
+                break;
+            }
         }
         txQueueLock.Unlock(MUTEX_CONTEXT);
         return;
@@ -253,6 +267,21 @@ void RemoteEndpoint::ThreadExit(Thread* thread)
 
     /* Unregister endpoint when both rx and tx exit */
     if (2 == IncrementAndFetch(&exitCount)) {
+        if (compressionStats.txMessages || compressionStats.rxMessages) {
+            QCC_DbgHLPrintf(("Endpoint %s body compression tx %u msgs %u%% rx %u msgs %u%%", GetUniqueName().c_str(),
+                             compressionStats.txMessages, compressionStats.TxRatio(),
+                             compressionStats.rxMessages, compressionStats.RxRatio()));
+        }
+        for (size_t lane = 0; lane < TxLaneQueue::NUM_LANES; ++lane) {
+            TxLaneQueue::LaneStats stats;
+            txQueue.GetStats((TxLaneQueue::Lane)lane, stats);
+            if (stats.sent) {
+                QCC_DbgHLPrintf(("Endpoint %s tx %s lane %u msgs wait avg %u us max %u us coalesced %u", GetUniqueName().c_str(),
+                                 TxLaneQueue::LaneText((TxLaneQueue::Lane)lane), stats.sent,
+                                 (uint32_t)stats.AverageWaitUs(), (uint32_t)stats.maxWaitUs, stats.coalesced));
+            }
+        }
+        EndpointStats::Unregister(this);
         /* De-register this remote endpoint */
         bus.GetInternal().GetRouter().UnregisterEndpoint(*this);
         if (NULL != listener) {
@@ -272,6 +301,21 @@ static inline bool IsControlMessage(Message& msg)
     return false;
 }
 
+static inline TxLaneQueue::Lane TxLane(Message& msg)
+{
+    switch (msg->GetType()) {
+    case MESSAGE_METHOD_RET:
+    case MESSAGE_ERROR:
+        return TxLaneQueue::REPLY;
+
+    case MESSAGE_METHOD_CALL:
+        return IsControlMessage(msg) ? TxLaneQueue::CONTROL : TxLaneQueue::METHOD_CALL;
+
+    default:
+        return IsControlMessage(msg) ? TxLaneQueue::CONTROL : TxLaneQueue::SIGNAL;
+    }
+}
+
 void* RemoteEndpoint::RxThread::Run(void* arg)
 {
     QStatus status = ER_OK;
@@ -289,6 +333,10 @@ void* RemoteEndpoint::RxThread::Run(void* arg)
             status = msg->Unmarshal(*ep, (validateSender && !bus2bus));
             switch (status) {
             case ER_OK :
+                if (MessageTrace::IsEnabled()) {
+                    msg->rxTraceTime = MessageTrace::Now();
+                }
+                ep->trafficStats.CountRx((uint8_t)msg->GetType(), msg->bufEOD - reinterpret_cast<uint8_t*>(msg->msgBuf));
                 ep->idleTimeoutCount = 0;
                 bool isAck;
                 if (ep->IsProbeMsg(msg, isAck)) {
@@ -327,6 +375,7 @@ void* RemoteEndpoint::RxThread::Run(void* arg)
                  * The message could not be expanded so pass it the peer object to request the expansion
                  * rule from the endpoint that sent it.
                  */
+                ++ep->trafficStats.headerExpansions;
                 status = bus.GetInternal().GetLocalEndpoint().GetPeerObj()->RequestHeaderExpansion(msg, ep);
                 if ((status != ER_OK) && router.IsDaemon()) {
                     QCC_LogError(status, ("Discarding %s", msg->Description().c_str()));
@@ -408,15 +457,18 @@ void* RemoteEndpoint::TxThread::Run(void* arg)
             stopEvent.ResetEvent();
             status = ER_OK;
             queueLock.Lock(MUTEX_CONTEXT);
-            while ((status == ER_OK) && !queue.empty() && !IsStopping()) {
+            while ((status == ER_OK) && (queue.Size() > 0) && !IsStopping()) {
 
                 /* Get next message */
-                Message msg = queue.back();
-
-                /* Alert next thread on wait queue */
-                if (0 < waitQueue.size()) {
-                    Thread* wakeMe = waitQueue.back();
-                    waitQueue.pop_back();
+                TxLaneQueue::Lane lane;
+                uint64_t sendTime = MessageTrace::Now();
+                Message msg = *queue.Pop(sendTime, lane);
+                uint64_t queuedTime = queue.GetQueuedTime();
+
+                /* Alert next thread waiting on the lane the message was taken from */
+                if (!waitQueues[lane].empty()) {
+                    Thread* wakeMe = waitQueues[lane].back();
+                    waitQueues[lane].pop_back();
                     status = wakeMe->Alert();
                     if (ER_OK != status) {
                         QCC_LogError(status, ("Failed to alert thread blocked on full tx queue"));
@@ -426,8 +478,10 @@ void* RemoteEndpoint::TxThread::Run(void* arg)
 
                 /* Deliver message */
                 status = msg->Deliver(*ep);
-                /* Report authorization failure as a security violation */
-                if (status == ER_BUS_NOT_AUTHORIZED) {
+                if (status == ER_OK) {
+                    ep->trafficStats.CountTx((uint8_t)msg->GetType(), msg->bufEOD - reinterpret_cast<uint8_t*>(msg->msgBuf));
+                } else if (status == ER_BUS_NOT_AUTHORIZED) {
+                    /* Report authorization failure as a security violation, this also counts it against the endpoint that received the message */
                     bus.GetInternal().GetLocalEndpoint().GetPeerObj()->HandleSecurityViolation(msg, status);
                     /*
                      * Clear the error after reporting the security violation otherwise we will exit
@@ -435,21 +489,29 @@ void* RemoteEndpoint::TxThread::Run(void* arg)
                      */
                     status = ER_OK;
                 }
+                if (MessageTrace::IsEnabled() && ep->traceHistograms) {
+                    uint64_t sentTime = MessageTrace::Now();
+                    ep->traceHistograms->Record(MessageTrace::TX_QUEUE, queuedTime, sendTime);
+                    ep->traceHistograms->Record(MessageTrace::DELIVER, sendTime, sentTime);
+                    ep->traceHistograms->Record(MessageTrace::TOTAL, msg->rxTraceTime, sentTime);
+                }
                 queueLock.Lock(MUTEX_CONTEXT);
-                queue.pop_back();
+                queue.Done();
             }
             queueLock.Unlock(MUTEX_CONTEXT);
         }
     }
     /* Wake any thread waiting on tx queue availability */
     queueLock.Lock(MUTEX_CONTEXT);
-    while (0 < waitQueue.size()) {
-        Thread* wakeMe = waitQueue.back();
-        QStatus status = wakeMe->Alert();
-        if (ER_OK != status) {
-            QCC_LogError(status, ("Failed to clear tx wait queue"));
+    for (size_t lane = 0; lane < TxLaneQueue::NUM_LANES; ++lane) {
+        while (!waitQueues[lane].empty()) {
+            Thread* wakeMe = waitQueues[lane].back();
+            QStatus status = wakeMe->Alert();
+            if (ER_OK != status) {
+                QCC_LogError(status, ("Failed to clear tx wait queue"));
+            }
+            waitQueues[lane].pop_back();
         }
-        waitQueue.pop_back();
     }
     queueLock.Unlock(MUTEX_CONTEXT);
 
@@ -462,8 +524,35 @@ void* RemoteEndpoint::TxThread::Run(void* arg)
     return (void*) status;
 }
 
+size_t RemoteEndpoint::GetTxQueueDepth()
+{
+    txQueueLock.Lock(MUTEX_CONTEXT);
+    size_t depth = txQueue.Size();
+    txQueueLock.Unlock(MUTEX_CONTEXT);
+    return depth;
+}
+
+void RemoteEndpoint::CreateTraceHistograms()
+{
+    /*
+     * Most endpoints are never traced so the histograms are not allocated until tracing is
+     * enabled. Once allocated they are kept until the endpoint is freed.
+     */
+    if (!traceHistograms) {
+        traceHistograms = new MessageTrace::Histograms();
+    }
+}
+
+void RemoteEndpoint::GetTxLaneStats(TxLaneQueue::Lane lane, TxLaneQueue::LaneStats& stats)
+{
+    txQueueLock.Lock(MUTEX_CONTEXT);
+    txQueue.GetStats(lane, stats);
+    txQueueLock.Unlock(MUTEX_CONTEXT);
+}
+
 QStatus RemoteEndpoint::PushMessage(Message& msg)
 {
+    /* Each lane is bounded separately so that a backlog of signals cannot block control traffic */
     static const size_t MAX_TX_QUEUE_SIZE = 30;
 
     QStatus status = ER_OK;
@@ -476,33 +565,33 @@ QStatus RemoteEndpoint::PushMessage(Message& msg)
     if (rxThread.IsStopping() || txThread.IsStopping()) {
         return ER_BUS_ENDPOINT_CLOSING;
     }
+    TxLaneQueue::Lane lane = TxLane(msg);
+    uint64_t pushTime = MessageTrace::Now();
+    if (MessageTrace::IsEnabled() && traceHistograms) {
+        traceHistograms->Record(MessageTrace::RECEIVE, msg->rxTraceTime, msg->routeTraceTime);
+        traceHistograms->Record(MessageTrace::ROUTE, msg->routeTraceTime, pushTime);
+    }
     IncrementAndFetch(&numWaiters);
     txQueueLock.Lock(MUTEX_CONTEXT);
-    size_t count = txQueue.size();
-    bool wasEmpty = (count == 0);
-    if (MAX_TX_QUEUE_SIZE > count) {
-        txQueue.push_front(msg);
+    bool wasEmpty = (txQueue.Size() == 0);
+    /* A newer last value signal replaces an older instance that has not been sent yet */
+    if (msg->IsLastValueSignal()) {
+        txQueue.Coalesce(msg, lane);
+    }
+    if (MAX_TX_QUEUE_SIZE > txQueue.Size(lane)) {
+        txQueue.Push(msg, lane, msg->GetSender(), pushTime);
     } else {
+        ++trafficStats.txBlocked;
         while (true) {
             /* Remove a queue entry whose TTLs is expired if possible */
-            deque<Message>::iterator it = txQueue.begin();
             uint32_t maxWait = 20 * 1000;
-            while (it != txQueue.end()) {
-                uint32_t expMs;
-                if ((*it)->IsExpired(&expMs)) {
-                    txQueue.erase(it);
-                    break;
-                } else {
-                    ++it;
-                }
-                maxWait = (std::min)(maxWait, expMs);
-            }
-            if (txQueue.size() < MAX_TX_QUEUE_SIZE) {
+            txQueue.RemoveExpired(lane, maxWait);
+            if (txQueue.Size(lane) < MAX_TX_QUEUE_SIZE) {
                 /* Check queue wasn't drained while we were waiting */
-                if (txQueue.size() == 0) {
+                if (txQueue.Size() == 0) {
                     wasEmpty = true;
                 }
-                txQueue.push_front(msg);
+                txQueue.Push(msg, lane, msg->GetSender(), pushTime);
                 status = ER_OK;
                 break;
             } else {
@@ -511,7 +600,7 @@ QStatus RemoteEndpoint::PushMessage(Message& msg)
                 assert(thread);
 
                 thread->AddAuxListener(this);
-                txWaitQueue.push_front(thread);
+                txWaitQueue[lane].push_front(thread);
                 txQueueLock.Unlock(MUTEX_CONTEXT);
                 status = Event::Wait(Event::neverSet, maxWait);
                 txQueueLock.Lock(MUTEX_CONTEXT);
@@ -525,9 +614,9 @@ QStatus RemoteEndpoint::PushMessage(Message& msg)
                 }
                 /* Remove thread from wait queue. */
                 thread->RemoveAuxListener(this);
-                deque<Thread*>::iterator eit = find(txWaitQueue.begin(), txWaitQueue.end(), thread);
-                if (eit != txWaitQueue.end()) {
-                    txWaitQueue.erase(eit);
+                list<Thread*>::iterator eit = find(txWaitQueue[lane].begin(), txWaitQueue[lane].end(), thread);
+                if (eit != txWaitQueue[lane].end()) {
+                    txWaitQueue[lane].erase(eit);
                 }
 
                 if ((ER_OK != status) && (ER_ALERTED_THREAD != status) && (ER_TIMEOUT != status)) {
@@ -536,6 +625,10 @@ QStatus RemoteEndpoint::PushMessage(Message& msg)
 
             }
         }
+        trafficStats.txBlockedUs += MessageTrace::Now() - pushTime;
+    }
+    if (txQueue.Size() > trafficStats.txQueueHighWater) {
+        trafficStats.txQueueHighWater = (uint32_t)txQueue.Size();
     }
     txQueueLock.Unlock(MUTEX_CONTEXT);
 
@@ -549,7 +642,7 @@ QStatus RemoteEndpoint::PushMessage(Message& msg)
     static uint32_t lastTime = 0;
     uint32_t now = GetTimestamp();
     if ((now - lastTime) > 1000) {
-        QCC_DbgPrintf(("Tx queue size (%s - %x) = %d", txThread.GetName(), txThread.GetHandle(), count));
+        QCC_DbgPrintf(("Tx queue size (%s - %x) = %u", txThread.GetName(), txThread.GetHandle(), (unsigned int)txQueue.Size()));
         lastTime = now;
     }
 #undef QCC_MODULE
@@ -23,7 +23,7 @@
 
 #include <qcc/platform.h>
 
-#include <deque>
+#include <list>
 
 #include <qcc/atomic.h>
 #include <qcc/String.h>
@@ -33,7 +33,10 @@
 #include <qcc/Thread.h>
 
 #include "BusEndpoint.h"
+#include "CompressionRules.h"
 #include "EndpointAuth.h"
+#include "MessageTrace.h"
+#include "TxLaneQueue.h"
 
 #include <Status.h>
 
@@ -56,7 +59,7 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
 
       public:
 
-        Features() : isBusToBus(false), allowRemote(false), handlePassing(false)
+        Features() : isBusToBus(false), allowRemote(false), handlePassing(false), bodyCompression(false), sharedMemory(false)
         { }
 
         bool isBusToBus;       /**< When initiating connection this is an input value indicating if this is a bus-to-bus connection.
@@ -69,6 +72,103 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
         bool handlePassing;    /**< Indicates if support for handle passing is enabled for this the endpoint. This is only
                                     enabled for endpoints that connect applications on the same device. */
 
+        bool bodyCompression;  /**< When establishing a connection this is an input value indicating if large message bodies
+                                    sent on this connection should be compressed. Once the connection is established this is
+                                    only true if the connection is bus-to-bus and the remote daemon can decompress bodies. */
+
+        bool sharedMemory;     /**< When establishing a connection this is an input value indicating if this side is willing to
+                                    move the connection onto shared memory. Once the connection is established this is only true if
+                                    both sides agreed to it. */
+
+    };
+
+    /**
+     * RemoteEndpoint::CompressionStats type. Records how well message bodies compress on this endpoint.
+     * The tx counters are only written by the tx thread and the rx counters by the rx thread.
+     */
+    class CompressionStats {
+
+      public:
+
+        CompressionStats() : txMessages(0), txRawBytes(0), txWireBytes(0), txIncompressible(0), rxMessages(0), rxRawBytes(0), rxWireBytes(0)
+        { }
+
+        uint32_t txMessages;    /**< Number of messages sent with a compressed body */
+        uint64_t txRawBytes;    /**< Total uncompressed length of those bodies */
+        uint64_t txWireBytes;   /**< Total compressed length of those bodies */
+        uint32_t txIncompressible; /**< Number of bodies sent uncompressed because compressing did not make them smaller */
+        uint32_t rxMessages;    /**< Number of messages received with a compressed body */
+        uint64_t rxRawBytes;    /**< Total uncompressed length of those bodies */
+        uint64_t rxWireBytes;   /**< Total compressed length of those bodies */
+
+        /**
+         * Get the size of compressed bodies sent as a percentage of their uncompressed size.
+         */
+        uint32_t TxRatio() const { return txRawBytes ? (uint32_t)((100 * txWireBytes) / txRawBytes) : 100; }
+
+        /**
+         * Get the size of compressed bodies received as a percentage of their uncompressed size.
+         */
+        uint32_t RxRatio() const { return rxRawBytes ? (uint32_t)((100 * rxWireBytes) / rxRawBytes) : 100; }
+    };
+
+    /**
+     * RemoteEndpoint::TrafficStats type. Counts the traffic and resource use of this endpoint. The
+     * rx counters are only written by the rx thread, the tx counters by the tx thread and the queue
+     * counters while holding the tx queue lock so they can be read at any time without a lock. The
+     * security failure counters are written by whichever thread reports the violation so they are
+     * atomically incremented. On 32 bit platforms a 64 bit counter read while it is being written
+     * may be off.
+     */
+    class TrafficStats {
+
+      public:
+
+        /** Size of the per message type arrays, indexed by AllJoynMessageType with unknown types at MESSAGE_INVALID */
+        static const size_t NUM_MESSAGE_TYPES = MESSAGE_SIGNAL + 1;
+
+        TrafficStats() : txQueueHighWater(0), txBlocked(0), txBlockedUs(0), decryptFailures(0), authFailures(0), headerExpansions(0)
+        {
+            for (size_t i = 0; i < NUM_MESSAGE_TYPES; ++i) {
+                rxMessages[i] = 0;
+                rxBytes[i] = 0;
+                txMessages[i] = 0;
+                txBytes[i] = 0;
+            }
+        }
+
+        /**
+         * Get the index of the counters for a message type. The type comes off the wire so types
+         * this version does not know about are counted with MESSAGE_INVALID.
+         */
+        static size_t TypeIndex(uint8_t type) { return (type < NUM_MESSAGE_TYPES) ? type : (size_t)MESSAGE_INVALID; }
+
+        /** Count a message received */
+        void CountRx(uint8_t type, size_t bytes)
+        {
+            size_t i = TypeIndex(type);
+            ++rxMessages[i];
+            rxBytes[i] += bytes;
+        }
+
+        /** Count a message sent */
+        void CountTx(uint8_t type, size_t bytes)
+        {
+            size_t i = TypeIndex(type);
+            ++txMessages[i];
+            txBytes[i] += bytes;
+        }
+
+        uint32_t rxMessages[NUM_MESSAGE_TYPES]; /**< Number of messages received of each type */
+        uint64_t rxBytes[NUM_MESSAGE_TYPES];    /**< Marshaled bytes received for each message type */
+        uint32_t txMessages[NUM_MESSAGE_TYPES]; /**< Number of messages sent of each type */
+        uint64_t txBytes[NUM_MESSAGE_TYPES];    /**< Marshaled bytes sent for each message type */
+        uint32_t txQueueHighWater;              /**< Largest number of messages that were in the tx queue */
+        uint32_t txBlocked;                     /**< Number of pushes that had to wait for room in the tx queue */
+        uint64_t txBlockedUs;                   /**< Total microseconds pushes spent waiting for room in the tx queue */
+        int32_t decryptFailures;                /**< Messages received that could not be decrypted (atomically incremented) */
+        int32_t authFailures;                   /**< Messages not authorized or not encrypted as required (atomically incremented) */
+        uint32_t headerExpansions;              /**< Compressed headers that needed an expansion rule from the sender */
     };
 
     /**
@@ -96,7 +196,7 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
      * @param incoming       true iff this is an incoming connection.
      * @param connectSpec    AllJoyn connection specification for this endpoint.
      * @param stream         Socket Stream used to communicate with media.
-     * @param type           Base name for thread.
+     * @param type           Base name for thread, this is the name of the transport.
      * @param isSocket       true iff stream is actually a socketStream.
      */
     RemoteEndpoint(BusAttachment& bus,
@@ -234,6 +334,42 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
      */
     const qcc::String& GetConnectSpec() const { return connSpec; }
 
+    /**
+     * Get the name of the transport that created this endpoint.
+     *
+     * @return The transport name, e.g. "tcp".
+     */
+    const qcc::String& GetTransportName() const { return transportName; }
+
+    /**
+     * Get the number of messages waiting to be sent on this endpoint.
+     *
+     * @return The number of queued messages.
+     */
+    size_t GetTxQueueDepth();
+
+    /**
+     * Get the depth and wait time statistics of one of the transmit queue lanes.
+     *
+     * @param lane   The transmit lane.
+     * @param stats  [OUT] The statistics for the lane.
+     */
+    void GetTxLaneStats(TxLaneQueue::Lane lane, TxLaneQueue::LaneStats& stats);
+
+    /**
+     * Get the message latency histograms for this endpoint. They are only recorded into while
+     * message tracing is enabled.
+     *
+     * @return  The histograms or NULL if message tracing has never been enabled for this endpoint.
+     */
+    MessageTrace::Histograms* GetTraceHistograms() { return traceHistograms; }
+
+    /**
+     * Allocate the message latency histograms for this endpoint if they have not been allocated
+     * already. Must be called with the EndpointStats lock held.
+     */
+    void CreateTraceHistograms();
+
     /**
      * Return the user id of the endpoint.
      *
@@ -313,6 +449,28 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
      */
     Features& GetFeatures() { return features; }
 
+    /**
+     * Get the header compression state for this endpoint. This must only be called from the
+     * transmit thread of the endpoint.
+     *
+     * @return   Returns the header compression state for this endpoint.
+     */
+    CompressionDictionary& GetCompressionDictionary() { return compressionDictionary; }
+
+    /**
+     * Get the body compression statistics for this endpoint.
+     *
+     * @return   Returns the body compression statistics for this endpoint.
+     */
+    CompressionStats& GetCompressionStats() { return compressionStats; }
+
+    /**
+     * Get the traffic counters for this endpoint.
+     *
+     * @return  The traffic counters.
+     */
+    TrafficStats& GetTrafficStats() { return trafficStats; }
+
     /**
      * Increment the reference count for this remote endpoint.
      * RemoteEndpoints are stopped when the number of references reaches zero.
@@ -407,18 +565,18 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
       public:
         TxThread(BusAttachment& bus,
                  const char* name,
-                 std::deque<Message>& queue,
-                 std::deque<Thread*>& waitQueue,
+                 TxLaneQueue& queue,
+                 std::list<Thread*>* waitQueues,
                  qcc::Mutex& queueLock)
-            : qcc::Thread(name), bus(bus), queue(queue), waitQueue(waitQueue), queueLock(queueLock) { }
+            : qcc::Thread(name), bus(bus), queue(queue), waitQueues(waitQueues), queueLock(queueLock) { }
 
       protected:
         qcc::ThreadReturn STDCALL Run(void* arg);
 
       private:
         BusAttachment& bus;
-        std::deque<Message>& queue;
-        std::deque<Thread*>& waitQueue;
+        TxLaneQueue& queue;
+        std::list<Thread*>* waitQueues;    /**< One wait queue per transmit lane */
         qcc::Mutex& queueLock;
     };
 
@@ -434,8 +592,8 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
     qcc::Stream* stream;                     /**< Stream for this endpoint or NULL if uninitialized */
     EndpointAuth auth;                       /**< Endpoint AllJoynAuthentication */
 
-    std::deque<Message> txQueue;             /**< Transmit message queue */
-    std::deque<qcc::Thread*> txWaitQueue;    /**< Threads waiting for txQueue to become not-full */
+    TxLaneQueue txQueue;                     /**< Transmit message queue */
+    std::list<qcc::Thread*> txWaitQueue[TxLaneQueue::NUM_LANES]; /**< Threads waiting for a txQueue lane to become not-full */
     qcc::Mutex txQueueLock;                  /**< Transmit message queue mutex */
     int32_t exitCount;                       /**< Number of sub-threads (rx and tx) that have exited (atomically incremented) */
 
@@ -445,9 +603,14 @@ class RemoteEndpoint : public BusEndpoint, public qcc::ThreadListener {
     EndpointListener* listener;              /**< Listener for thread exit notifications */
 
     qcc::String connSpec;                    /**< Connection specification for out-going connections */
+    qcc::String transportName;               /**< Name of the transport that created this endpoint */
     bool incoming;                           /**< Indicates if connection is incoming (true) or outgoing (false) */
 
     Features features;                       /**< Requested and negotiated features of this endpoint */
+    CompressionDictionary compressionDictionary; /**< Header compression tokens known to the remote side of this endpoint */
+    CompressionStats compressionStats;       /**< Body compression statistics for this endpoint */
+    TrafficStats trafficStats;               /**< Traffic and resource counters for this endpoint */
+    MessageTrace::Histograms* traceHistograms; /**< Message latency histograms for messages sent on this endpoint */
     uint32_t processId;                      /**< Process id of the process at the remote end of this endpoint */
     int32_t refCount;                        /**< Number of active users of this remote endpoint */
     bool isSocket;                           /**< True iff this endpoint contains a SockStream as its 'stream' member */
@@ -0,0 +1,208 @@
+/**
+ * @file
+ * Implementation of the table of outstanding method calls and their reply timeouts
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include "ReplyTable.h"
+
+/** @internal */
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+
+namespace ajn {
+
+const uint32_t ReplyTable::TICK_MS;
+const uint32_t ReplyTable::NUM_WHEEL_SLOTS;
+const uint32_t ReplyTable::NIL;
+
+/** Initial number of index slots, must be a power of 2 */
+static const uint32_t INITIAL_INDEX_SIZE = 64;
+
+/** Log2 of INITIAL_INDEX_SIZE */
+static const uint32_t INITIAL_INDEX_BITS = 6;
+
+uint32_t ReplyTable::Home(uint32_t serial) const
+{
+    /* Fibonacci hashing spreads sequential serial numbers evenly over the index */
+    return (serial * 0x9E3779B9) >> indexShift;
+}
+
+ReplyTable::ReplyTable() :
+    freeList(NIL),
+    index(INITIAL_INDEX_SIZE, NIL),
+    indexMask(INITIAL_INDEX_SIZE - 1),
+    indexShift(32 - INITIAL_INDEX_BITS),
+    timeouts(TICK_MS, NUM_WHEEL_SLOTS),
+    numCalls(0)
+{
+}
+
+uint32_t ReplyTable::FindSlot(uint32_t serial) const
+{
+    for (uint32_t slot = Home(serial); index[slot] != NIL; slot = (slot + 1) & indexMask) {
+        if (records[index[slot]].serial == serial) {
+            return slot;
+        }
+    }
+    return NIL;
+}
+
+void ReplyTable::RemoveSlot(uint32_t slot)
+{
+    index[slot] = NIL;
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & indexMask; index[next] != NIL; next = (next + 1) & indexMask) {
+        uint32_t home = Home(records[index[next]].serial);
+        /* The entry stays put if its home slot is cyclically in (hole, next] */
+        bool stays = (hole <= next) ? ((hole < home) && (home <= next)) : ((hole < home) || (home <= next));
+        if (!stays) {
+            index[hole] = index[next];
+            index[next] = NIL;
+            hole = next;
+        }
+    }
+}
+
+void ReplyTable::Grow()
+{
+    vector<uint32_t> oldIndex(index.size() * 2, NIL);
+    oldIndex.swap(index);
+    indexMask = index.size() - 1;
+    --indexShift;
+    for (size_t i = 0; i < oldIndex.size(); ++i) {
+        if (oldIndex[i] != NIL) {
+            uint32_t slot = Home(records[oldIndex[i]].serial);
+            while (index[slot] != NIL) {
+                slot = (slot + 1) & indexMask;
+            }
+            index[slot] = oldIndex[i];
+        }
+    }
+}
+
+void ReplyTable::Free(uint32_t slot)
+{
+    uint32_t rec = index[slot];
+    if (records[rec].timeout != NIL) {
+        timeouts.Remove(records[rec].timeout);
+    }
+    RemoveSlot(slot);
+    records[rec].context.object = NULL;
+    records[rec].next = freeList;
+    freeList = rec;
+    --numCalls;
+}
+
+bool ReplyTable::Add(uint32_t serial, const Context& context, uint32_t timeout, uint64_t now)
+{
+    if (FindSlot(serial) != NIL) {
+        return false;
+    }
+    /* Keep the index at most half full */
+    if ((numCalls + 1) * 2 > index.size()) {
+        Grow();
+    }
+    uint32_t rec;
+    if (freeList != NIL) {
+        rec = freeList;
+        freeList = records[rec].next;
+    } else {
+        rec = records.size();
+        records.push_back(Record());
+    }
+    Record& r = records[rec];
+    r.serial = serial;
+    r.context = context;
+    r.timeout = timeouts.Add(rec, now + timeout, now);
+
+    uint32_t slot = Home(serial);
+    while (index[slot] != NIL) {
+        slot = (slot + 1) & indexMask;
+    }
+    index[slot] = rec;
+    ++numCalls;
+    return true;
+}
+
+bool ReplyTable::Remove(uint32_t serial, Context& context)
+{
+    uint32_t slot = FindSlot(serial);
+    if (slot == NIL) {
+        return false;
+    }
+    context = records[index[slot]].context;
+    Free(slot);
+    return true;
+}
+
+void ReplyTable::RemoveAll(MessageReceiver* object)
+{
+    /* Removing shifts index entries so collect the serial numbers first */
+    vector<uint32_t> serials;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if ((index[i] != NIL) && (records[index[i]].context.object == object)) {
+            serials.push_back(records[index[i]].serial);
+        }
+    }
+    for (size_t i = 0; i < serials.size(); ++i) {
+        Free(FindSlot(serials[i]));
+    }
+}
+
+bool ReplyTable::Extend(uint32_t serial, uint32_t extension)
+{
+    uint32_t slot = FindSlot(serial);
+    if ((slot == NIL) || (records[index[slot]].timeout == NIL)) {
+        return false;
+    }
+    uint32_t timer = records[index[slot]].timeout;
+    timeouts.Reschedule(timer, timeouts.GetDue(timer) + extension);
+    return true;
+}
+
+void ReplyTable::Expire(uint64_t now, vector<uint32_t>& expired)
+{
+    /* The wheel returns record numbers, replace them with the serial numbers */
+    size_t first = expired.size();
+    timeouts.Expire(now, expired);
+    for (size_t i = first; i < expired.size(); ++i) {
+        Record& r = records[expired[i]];
+        r.timeout = NIL;
+        expired[i] = r.serial;
+    }
+}
+
+void ReplyTable::ExpireAll(vector<uint32_t>& expired)
+{
+    for (size_t i = 0; i < index.size(); ++i) {
+        if ((index[i] != NIL) && (records[index[i]].timeout != NIL)) {
+            Record& r = records[index[i]];
+            timeouts.Remove(r.timeout);
+            r.timeout = NIL;
+            expired.push_back(r.serial);
+        }
+    }
+}
+
+}
@@ -0,0 +1,188 @@
+#ifndef _ALLJOYN_REPLYTABLE_H
+#define _ALLJOYN_REPLYTABLE_H
+/**
+ * @file
+ * This file defines the table of outstanding method calls and their reply timeouts
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include ReplyTable.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/MessageReceiver.h>
+
+#include "TimingWheel.h"
+
+namespace ajn {
+
+/**
+ * %ReplyTable tracks the method calls that are waiting for a reply and when each of them times out.
+ *
+ * Calls are found by serial number in an open addressed hash table. Serial numbers are allocated
+ * sequentially and are spread over the table by Fibonacci hashing so that probe sequences stay short
+ * and removing a call never has to walk a long run of occupied slots.
+ *
+ * Timeouts are kept in a TimingWheel with slots of TICK_MS milliseconds. Adding, extending and
+ * removing a timeout are constant time operations. A single timer alarm set for NextTimeout() is
+ * all the owner needs to drive the wheel.
+ *
+ * The table is not thread safe, the owner must serialize access.
+ */
+class ReplyTable {
+  public:
+
+    /**
+     * Milliseconds covered by each slot of the timing wheel, timeouts are reported up to this late.
+     */
+    static const uint32_t TICK_MS = 10;
+
+    /**
+     * Number of slots in the timing wheel, must be a power of 2.
+     */
+    static const uint32_t NUM_WHEEL_SLOTS = 1024;
+
+    /**
+     * The context for an outstanding method call
+     */
+    struct Context {
+        MessageReceiver* object;                     /**< The object to receive the reply */
+        MessageReceiver::ReplyHandler handler;       /**< The receiving object's handler function */
+        const InterfaceDescription::Member* method;  /**< The method that was called */
+        bool secure;                                 /**< This wil be true if the method call was secure */
+        void* context;                               /**< The calling object's context */
+    };
+
+    /**
+     * Constructor
+     */
+    ReplyTable();
+
+    /**
+     * Add a method call.
+     *
+     * @param serial   The serial number of the method call.
+     * @param context  The context for the reply.
+     * @param timeout  Milliseconds from now when the call times out.
+     * @param now      The current time in milliseconds from qcc::GetTimestamp64().
+     *
+     * @return  false if there is already a call with this serial number.
+     */
+    bool Add(uint32_t serial, const Context& context, uint32_t timeout, uint64_t now);
+
+    /**
+     * Remove a method call.
+     *
+     * @param serial   The serial number of the method call.
+     * @param context  Returns the context for the reply.
+     *
+     * @return  true if the call was found and removed.
+     */
+    bool Remove(uint32_t serial, Context& context);
+
+    /**
+     * Remove all the method calls for a receiver.
+     *
+     * @param object  The object receiving the replies.
+     */
+    void RemoveAll(MessageReceiver* object);
+
+    /**
+     * Extend the timeout for a method call.
+     *
+     * @param serial     The serial number of the method call.
+     * @param extension  Milliseconds to add to the timeout.
+     *
+     * @return  false if there is no call with this serial number or the call has timed out.
+     */
+    bool Extend(uint32_t serial, uint32_t extension);
+
+    /**
+     * Collect the method calls that have timed out. The calls stay in the table so the timeout is
+     * reported by removing them in the same way as a reply.
+     *
+     * @param now      The current time in milliseconds from qcc::GetTimestamp64().
+     * @param expired  Returns the serial numbers of the calls that timed out.
+     */
+    void Expire(uint64_t now, std::vector<uint32_t>& expired);
+
+    /**
+     * Collect all the method calls that have not timed out as though they had.
+     *
+     * @param expired  Returns the serial numbers of the calls.
+     */
+    void ExpireAll(std::vector<uint32_t>& expired);
+
+    /**
+     * Get the time of the next wheel slot with a timeout in it.
+     *
+     * @return  The time in milliseconds from qcc::GetTimestamp64() or 0 if there are no timeouts.
+     */
+    uint64_t NextTimeout() const { return timeouts.NextDue(); }
+
+    /**
+     * Get the number of method calls in the table.
+     *
+     * @return  The number of method calls.
+     */
+    size_t Size() const { return numCalls; }
+
+  private:
+
+    static const uint32_t NIL = 0xFFFFFFFF;
+
+    /** A method call, records are reused through a free list */
+    struct Record {
+        uint32_t serial;      /**< Serial number of the method call */
+        Context context;      /**< The context for the reply */
+        uint32_t timeout;     /**< The call's timer in the wheel or NIL if it has timed out */
+        uint32_t next;        /**< Next record in the free list or NIL */
+    };
+
+    /** Get the index slot where the search for a serial number starts */
+    uint32_t Home(uint32_t serial) const;
+
+    /** Find the index slot for a serial number or NIL */
+    uint32_t FindSlot(uint32_t serial) const;
+
+    /** Remove the record in an index slot, shifting back following entries so no tombstones are needed */
+    void RemoveSlot(uint32_t slot);
+
+    /** Double the size of the index */
+    void Grow();
+
+    /** Remove a record from the index and wheel and free it */
+    void Free(uint32_t slot);
+
+    std::vector<Record> records;      /**< Method call records */
+    uint32_t freeList;                /**< First free record or NIL */
+    std::vector<uint32_t> index;      /**< Record numbers indexed by serial number, NIL is an empty slot */
+    uint32_t indexMask;               /**< Number of index slots - 1 */
+    uint32_t indexShift;              /**< 32 - log2 of the number of index slots */
+    TimingWheel<uint32_t> timeouts;   /**< Record numbers by timeout */
+    size_t numCalls;                  /**< Number of method calls in the table */
+};
+
+}
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * SharedMemoryStream is a Stream that carries the bytes for a local client connection through a pair of
+ * shared memory ring buffers instead of through the unix socket.
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_SHAREDMEMORYSTREAM_H
+#define _ALLJOYN_SHAREDMEMORYSTREAM_H
+
+#ifndef __cplusplus
+#error Only include SharedMemoryStream.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+#include <qcc/Stream.h>
+
+#include <Status.h>
+
+namespace ajn {
+
+/**
+ * A SharedMemoryStream connects a client and the local daemon through two single producer single
+ * consumer ring buffers, one for each direction, in a memory region the client creates and passes to
+ * the daemon over the unix socket once the connection has been authenticated. Each side only ever
+ * writes its own ring index so no locks are needed.
+ *
+ * A reader that finds its ring empty spins for a while before going to sleep on an eventfd, the writer
+ * only signals the eventfd if the reader said it is sleeping. The number of spins adapts to the
+ * traffic, it grows when spinning finds data and shrinks when the reader has to sleep anyway.
+ *
+ * The unix socket stays open for the life of the connection. It is used to detect that the other side
+ * has gone away and to pass file descriptors that accompany a message, these are tagged with the ring
+ * position where the message starts.
+ */
+class SharedMemoryStream : public qcc::Stream {
+  public:
+
+    /**
+     * Size of each ring buffer, must be a power of two.
+     */
+    static const uint32_t RING_SIZE = 256 * 1024;
+
+    /**
+     * Check if shared memory streams are supported on this platform.
+     *
+     * @return  true if shared memory streams are supported.
+     */
+    static bool IsSupported();
+
+    /**
+     * Called by the client after the connection has been established to create the shared memory
+     * and pass it to the daemon. If the shared memory cannot be created the daemon is told to carry
+     * on using the socket.
+     *
+     * @param sock       The connected unix socket.
+     * @param shmStream  Returns the new stream.
+     *
+     * @return
+     *      - ER_OK if the stream was created.
+     *      - An error status otherwise, the socket is still usable unless sending to it failed.
+     */
+    static QStatus Connect(qcc::SocketFd sock, SharedMemoryStream*& shmStream);
+
+    /**
+     * Called by the daemon after the connection has been established to receive the shared memory
+     * from the client.
+     *
+     * @param sock       The connected unix socket.
+     * @param timeout    How long to wait for the client.
+     * @param shmStream  Returns the new stream or NULL if the client is going to carry on using the
+     *                   socket.
+     *
+     * @return
+     *      - ER_OK if the shared memory was accepted or the client declined to use it.
+     *      - An error status otherwise, the connection should be dropped.
+     */
+    static QStatus Accept(qcc::SocketFd sock, uint32_t timeout, SharedMemoryStream*& shmStream);
+
+    /**
+     * Destructor. The socket is not closed, it belongs to the endpoint.
+     */
+    virtual ~SharedMemoryStream();
+
+    /**
+     * Pull bytes from the receive ring.
+     *
+     * @param buf          Buffer to store pulled bytes
+     * @param reqBytes     Number of bytes requested to be pulled from source.
+     * @param actualBytes  [OUT] Actual number of bytes retrieved from source.
+     * @param timeout      Timeout in milliseconds.
+     * @return   ER_OK if successful. ER_SOCK_OTHER_END_CLOSED if the other side has gone away.
+     */
+    QStatus PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Pull bytes and any file descriptors that were pushed with the bytes at the current ring position.
+     *
+     * @param buf          Buffer to store pulled bytes
+     * @param reqBytes     Number of bytes requested to be pulled from source.
+     * @param actualBytes  [OUT] Actual number of bytes retrieved from source.
+     * @param fdList       Array to receive file descriptors.
+     * @param numFds       [IN,OUT] On IN the size of fdList on OUT number of files descriptors pulled.
+     * @param timeout      Timeout in milliseconds.
+     * @return   ER_OK if successful. ER_SOCK_OTHER_END_CLOSED if the other side has gone away.
+     */
+    QStatus PullBytesAndFds(void* buf, size_t reqBytes, size_t& actualBytes, qcc::SocketFd* fdList, size_t& numFds,
+                            uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Push bytes into the send ring.
+     *
+     * @param buf          Buffer containing bytes to push
+     * @param numBytes     Number of bytes from buf to send to sink.
+     * @param numSent      [OUT] Number of bytes actually consumed by sink.
+     * @return   ER_OK if successful. ER_TIMEOUT if the ring stayed full for longer than the send timeout.
+     */
+    QStatus PushBytes(const void* buf, size_t numBytes, size_t& numSent);
+
+    /**
+     * Push bytes accompanied by one or more file descriptors. The file descriptors are sent on the
+     * socket before the bytes are written to the ring.
+     *
+     * @param buf       Buffer containing bytes to push
+     * @param numBytes  Number of bytes from buf to send to sink, must be at least 1.
+     * @param numSent   [OUT] Number of bytes actually consumed by sink.
+     * @param fdList    Array of file descriptors to push.
+     * @param numFds    Number of files descriptors, must be at least 1.
+     * @param pid       Process id required on some platforms.
+     *
+     * @return  ER_OK or an error.
+     */
+    QStatus PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, qcc::SocketFd* fdList, size_t numFds,
+                            uint32_t pid = -1);
+
+    /**
+     * Get the Event indicating that data is available.
+     *
+     * @return Event that is set when data is available.
+     */
+    qcc::Event& GetSourceEvent() { return *sourceEvent; }
+
+    /**
+     * Get the Event indicating that sink can accept data.
+     *
+     * @return Event set when there is space in the send ring.
+     */
+    qcc::Event& GetSinkEvent() { return *sinkEvent; }
+
+    /**
+     * Set the send timeout for this sink.
+     *
+     * @param sendTimeout   Send timeout in ms.
+     */
+    void SetSendTimeout(uint32_t sendTimeout) { this->sendTimeout = sendTimeout; }
+
+  private:
+
+    /**
+     * Ring indices and wakeup flags. The indices run freely and are masked to index the ring.
+     */
+    struct RingControl;
+
+    /**
+     * Local view of one ring
+     */
+    struct Ring {
+        RingControl* ctrl;     /**< Shared ring indices */
+        uint8_t* data;         /**< Shared ring data */
+        int dataFd;            /**< eventfd the producer signals when data is written */
+        int spaceFd;           /**< eventfd the consumer signals when space is freed */
+        uint32_t pos;          /**< Private copy of the index this side owns */
+        uint32_t spinLimit;    /**< How long to spin before sleeping */
+    };
+
+    /* Private constructor, use Connect() or Accept() */
+    SharedMemoryStream(qcc::SocketFd sock, int memFd, uint8_t* mem, int* eventFds, bool isClient);
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    SharedMemoryStream(const SharedMemoryStream& other);
+    SharedMemoryStream& operator=(const SharedMemoryStream& other);
+
+    QStatus Init();
+    QStatus WaitRing(Ring& ring, bool isConsumer, uint32_t timeout, uint32_t& avail);
+    size_t ReadRing(void* buf, size_t reqBytes, uint32_t avail);
+    size_t WriteRing(const void* buf, size_t numBytes, uint32_t avail);
+    bool PeerClosed();
+
+    qcc::SocketFd sock;        /**< The unix socket, not owned */
+    int memFd;                 /**< The shared memory file descriptor */
+    uint8_t* mem;              /**< Mapping of the shared memory */
+    Ring rxRing;               /**< Ring this side consumes */
+    Ring txRing;               /**< Ring this side produces */
+    int sourceFd;              /**< epoll fd for the rx ring data eventfd and the socket */
+    int sinkFd;                /**< epoll fd for the tx ring space eventfd and the socket */
+    qcc::Event* sourceEvent;   /**< Event set when there is data to read or the other side has gone away */
+    qcc::Event* sinkEvent;     /**< Event set when there is space to write or the other side has gone away */
+    uint32_t sendTimeout;      /**< Send timeout in ms */
+    uint32_t maxSpin;          /**< Upper bound for the adaptive spin limits */
+};
+
+}
+
+#endif
@@ -26,6 +26,8 @@
 #include <qcc/String.h>
 
 #include <list>
+#include <map>
+#include <string.h>
 
 #include "SignalTable.h"
 
@@ -49,6 +51,7 @@ void SignalTable::Add(MessageReceiver* receiver,
     Key key(sourcePath, member->iface->GetName(), member->name);
     lock.Lock(MUTEX_CONTEXT);
     hashTable.insert(pair<const Key, Entry>(key, entry));
+    Publish();
     lock.Unlock(MUTEX_CONTEXT);
 }
 
@@ -58,8 +61,8 @@ void SignalTable::Remove(MessageReceiver* receiver,
                          const char* sourcePath)
 {
     Key key(sourcePath, member->iface->GetName(), member->name.c_str());
-    iterator iter;
-    pair<iterator, iterator> range;
+    hash_multimap<Key, Entry, Hash, Equal>::iterator iter;
+    pair<hash_multimap<Key, Entry, Hash, Equal>::iterator, hash_multimap<Key, Entry, Hash, Equal>::iterator> range;
 
     lock.Lock(MUTEX_CONTEXT);
     range = hashTable.equal_range(key);
@@ -67,6 +70,7 @@ void SignalTable::Remove(MessageReceiver* receiver,
     while (iter != range.second) {
         if ((iter->second.object == receiver) && (iter->second.handler == handler)) {
             hashTable.erase(iter);
+            Publish();
             break;
         } else {
             ++iter;
@@ -78,27 +82,88 @@ void SignalTable::Remove(MessageReceiver* receiver,
 void SignalTable::RemoveAll(MessageReceiver* receiver)
 {
     bool removed;
+    bool changed = false;
     lock.Lock(MUTEX_CONTEXT);
     do {
         removed = false;
-        for (iterator iter = hashTable.begin(); iter != hashTable.end(); ++iter) {
+        for (hash_multimap<Key, Entry, Hash, Equal>::iterator iter = hashTable.begin(); iter != hashTable.end(); ++iter) {
             if (iter->second.object == receiver) {
                 hashTable.erase(iter);
                 removed = true;
+                changed = true;
                 break;
             }
         }
     } while (removed);
+    if (changed) {
+        Publish();
+    }
     lock.Unlock(MUTEX_CONTEXT);
 }
 
-pair<SignalTable::const_iterator, SignalTable::const_iterator> SignalTable::Find(const char* sourcePath,
-                                                                                 const char* iface,
-                                                                                 const char* signalName)
+void SignalTable::Publish()
 {
-    Key key(sourcePath, iface, signalName);
-    return hashTable.equal_range(key);
+    /* Group the handlers by interface and signal name, each group goes in one slot */
+    map<pair<qcc::String, qcc::String>, vector<Index::Handler> > groups;
+    for (hash_multimap<Key, Entry, Hash, Equal>::const_iterator iter = hashTable.begin(); iter != hashTable.end(); ++iter) {
+        Index::Handler handler;
+        handler.entry = iter->second;
+        handler.sourcePath = iter->first.sourcePath.c_str();
+        groups[pair<qcc::String, qcc::String>(iter->first.iface.c_str(), iter->first.signalName.c_str())].push_back(handler);
+    }
+
+    /* Size the index for a load factor of at most one half so probe sequences stay short */
+    size_t numSlots = 8;
+    while (numSlots < (2 * groups.size())) {
+        numSlots <<= 1;
+    }
+    Index* newIndex = new Index(numSlots);
+    newIndex->handlers.reserve(hashTable.size());
+    Hash hash;
+    map<pair<qcc::String, qcc::String>, vector<Index::Handler> >::const_iterator git;
+    for (git = groups.begin(); git != groups.end(); ++git) {
+        size_t h = hash(Key("", git->first.first.c_str(), git->first.second.c_str()));
+        size_t i = h & newIndex->mask;
+        while (newIndex->slots[i].count) {
+            i = (i + 1) & newIndex->mask;
+        }
+        Index::Slot& slot = newIndex->slots[i];
+        slot.hash = h;
+        slot.iface = git->first.first;
+        slot.signalName = git->first.second;
+        slot.first = newIndex->handlers.size();
+        slot.count = git->second.size();
+        newIndex->handlers.insert(newIndex->handlers.end(), git->second.begin(), git->second.end());
+    }
+    index.Publish(newIndex);
 }
 
+void SignalTable::Find(const char* sourcePath,
+                       const char* iface,
+                       const char* signalName,
+                       list<Entry>& matches)
+{
+    sourcePath = sourcePath ? sourcePath : "";
+    iface = iface ? iface : "";
+    size_t h = Hash()(Key(sourcePath, iface, signalName));
+
+    const Index* current = index.BeginRead();
+    if (current) {
+        for (size_t i = h & current->mask; current->slots[i].count; i = (i + 1) & current->mask) {
+            const Index::Slot& slot = current->slots[i];
+            if ((slot.hash == h) && (strcmp(slot.signalName.c_str(), signalName) == 0) && (strcmp(slot.iface.c_str(), iface) == 0)) {
+                /* A handler with no source path matches signals from any source */
+                for (size_t j = slot.first; j < (slot.first + slot.count); ++j) {
+                    const Index::Handler& handler = current->handlers[j];
+                    if (handler.sourcePath.empty() || !*sourcePath || (strcmp(handler.sourcePath.c_str(), sourcePath) == 0)) {
+                        matches.push_back(handler.entry);
+                    }
+                }
+                break;
+            }
+        }
+    }
+    index.EndRead();
 }
 
+}
@@ -28,6 +28,7 @@
 #include <qcc/platform.h>
 #include <qcc/StringMapKey.h>
 
+#include <list>
 #include <vector>
 
 #include <qcc/String.h>
@@ -39,6 +40,8 @@
 
 #include <Status.h>
 
+#include "DispatchSnapshot.h"
+
 #if defined(__GNUC__) && !defined(ANDROID)
 #include <ext/hash_map>
 namespace std {
@@ -52,6 +55,9 @@ namespace ajn {
 
 /**
  * %SignalTable is a multimap that maps interface/signalname and/or source path to SignalHandler instances.
+ *
+ * Lookups use an immutable index that is rebuilt when handlers are added or removed, so finding the
+ * handlers for a signal takes no lock and makes no string allocations.
  */
 class SignalTable {
 
@@ -131,16 +137,6 @@ class SignalTable {
         }
     };
 
-    /**
-     * Table iterator
-     */
-    typedef std::hash_multimap<Key, Entry, Hash, Equal>::iterator iterator;
-
-    /**
-     * Const table iterator
-     */
-    typedef std::hash_multimap<Key, Entry, Hash, Equal>::const_iterator const_iterator;
-
     /**
      * Add an entry to the signal hash table.
      *
@@ -175,33 +171,58 @@ class SignalTable {
     void RemoveAll(MessageReceiver* receiver);
 
     /**
-     * Find Entries based on set of criteria.
-     * Signal table lock should be held until iterators are no longer in use.
+     * Find Entries based on set of criteria. This does not take the signal table lock.
      *
      * @param sourcePath   The object path of the signal sender.
-     * @param iface    The interface.
+     * @param iface        The interface.
      * @param signalName   The signal name.
-     *
-     * @return   Iterator range of entries with matching criteria.
+     * @param matches      Returns the entries with matching criteria.
      */
-    std::pair<const_iterator, const_iterator> Find(const char* sourcePath, const char* iface, const char* signalName);
+    void Find(const char* sourcePath, const char* iface, const char* signalName, std::list<Entry>& matches);
+
+  private:
+
+    qcc::Mutex lock; /**< Lock protecting the signal table */
 
     /**
-     * Get the lock that protects the signal table.
+     * Open addressed index of the hash table used for lookups. All the handlers for an
+     * interface/signalname are in one slot.
      */
-    void Lock(void) { lock.Lock(MUTEX_CONTEXT); }
+    struct Index {
+        /** A handler and the source path it was registered for */
+        struct Handler {
+            Entry entry;               /**< The handler */
+            qcc::String sourcePath;    /**< Signal originator or empty for all signal originators */
+        };
+
+        /** An index slot, a slot with no handlers is empty */
+        struct Slot {
+            Slot() : hash(0), first(0), count(0) { }
+
+            size_t hash;               /**< Hash of the interface and signal name */
+            qcc::String iface;         /**< The interface name */
+            qcc::String signalName;    /**< The signal name */
+            size_t first;              /**< Index of the first handler */
+            size_t count;              /**< Number of handlers */
+        };
+
+        Index(size_t numSlots) : slots(numSlots), mask(numSlots - 1) { }
+
+        std::vector<Slot> slots;         /**< Number of slots is a power of 2 */
+        size_t mask;                     /**< Number of slots - 1 */
+        std::vector<Handler> handlers;   /**< Handlers grouped by slot */
+    };
 
     /**
-     * Release the lock that protects the signal table.
+     * Rebuild the index from the hash table, called with the lock held
      */
-    void Unlock(void) { lock.Unlock(MUTEX_CONTEXT); }
-
-  private:
-
-    qcc::Mutex lock; /**< Lock protecting the signal table */
+    void Publish();
 
     /**  The hash table */
     std::hash_multimap<Key, Entry, Hash, Equal> hashTable;
+
+    /** The current index */
+    DispatchSnapshot<Index> index;
 };
 
 }
@@ -0,0 +1,262 @@
+#ifndef _ALLJOYN_TIMINGWHEEL_H
+#define _ALLJOYN_TIMINGWHEEL_H
+/**
+ * @file
+ * This file defines a hashed timing wheel for tracking large numbers of timeouts
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include TimingWheel.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+namespace ajn {
+
+/**
+ * %TimingWheel is a hashed timing wheel. Each slot covers a tick of a fixed number of milliseconds
+ * and holds the timers that are due in that tick on this or a later turn of the wheel, in the order
+ * they were added. Adding, rescheduling and removing a timer are constant time operations and the
+ * owner drives the wheel by calling Expire() at or after NextDue().
+ *
+ * Timers are referred to by handles that stay valid until the timer is removed or expires. Timer
+ * storage is reused through a free list so a busy wheel does not allocate.
+ *
+ * The wheel is not thread safe, the owner must serialize access.
+ *
+ * @tparam T  The value returned for a timer when it expires.
+ */
+template <typename T>
+class TimingWheel {
+  public:
+
+    /**
+     * The handle of no timer.
+     */
+    static const uint32_t NIL = 0xFFFFFFFF;
+
+    /**
+     * Constructor
+     *
+     * @param tickMs    Milliseconds covered by each slot, timers expire up to this late.
+     * @param numSlots  Number of slots, must be a power of 2.
+     */
+    TimingWheel(uint32_t tickMs, uint32_t numSlots) :
+        tickMs(tickMs ? tickMs : 1),
+        slotMask(numSlots - 1),
+        freeList(NIL),
+        heads(numSlots, NIL),
+        tails(numSlots, NIL),
+        currentTick(0),
+        numTimers(0)
+    {
+    }
+
+    /**
+     * Add a timer.
+     *
+     * @param value  The value returned by Expire() for the timer.
+     * @param due    Time in milliseconds when the timer expires.
+     * @param now    The current time in milliseconds.
+     *
+     * @return  The handle of the timer.
+     */
+    uint32_t Add(const T& value, uint64_t due, uint64_t now)
+    {
+        uint32_t timer;
+        if (freeList != NIL) {
+            timer = freeList;
+            freeList = nodes[timer].next;
+        } else {
+            timer = nodes.size();
+            nodes.push_back(Node());
+        }
+        nodes[timer].value = value;
+        nodes[timer].due = due;
+
+        /* An empty wheel starts turning from now */
+        if (numTimers == 0) {
+            currentTick = now / tickMs;
+        }
+        Link(timer);
+        return timer;
+    }
+
+    /**
+     * Remove a timer that has not expired.
+     *
+     * @param timer  The handle of the timer.
+     */
+    void Remove(uint32_t timer)
+    {
+        Unlink(timer);
+        nodes[timer].value = T();
+        nodes[timer].next = freeList;
+        freeList = timer;
+    }
+
+    /**
+     * Change when a timer that has not expired is due. The handle stays the same.
+     *
+     * @param timer  The handle of the timer.
+     * @param due    Time in milliseconds when the timer expires.
+     */
+    void Reschedule(uint32_t timer, uint64_t due)
+    {
+        Unlink(timer);
+        nodes[timer].due = due;
+        Link(timer);
+    }
+
+    /**
+     * Get when a timer is due.
+     *
+     * @param timer  The handle of the timer.
+     *
+     * @return  Time in milliseconds when the timer expires.
+     */
+    uint64_t GetDue(uint32_t timer) const { return nodes[timer].due; }
+
+    /**
+     * Remove the timers that are due at or before now. The handles of the expired timers are no
+     * longer valid.
+     *
+     * @param now      The current time in milliseconds.
+     * @param expired  Returns the values of the expired timers, earliest tick first.
+     */
+    void Expire(uint64_t now, std::vector<T>& expired)
+    {
+        uint64_t nowTick = now / tickMs;
+        if (nowTick < currentTick) {
+            return;
+        }
+        /* Visiting every slot once is enough however long it has been */
+        uint64_t lastTick = nowTick;
+        if ((nowTick - currentTick) > slotMask) {
+            lastTick = currentTick + slotMask;
+        }
+        for (uint64_t tick = currentTick; (tick <= lastTick) && (numTimers > 0); ++tick) {
+            uint32_t timer = heads[(uint32_t)tick & slotMask];
+            while (timer != NIL) {
+                uint32_t next = nodes[timer].next;
+                /* Timers for a later turn of the wheel stay where they are */
+                if (nodes[timer].due <= now) {
+                    expired.push_back(nodes[timer].value);
+                    Remove(timer);
+                }
+                timer = next;
+            }
+        }
+        currentTick = nowTick;
+    }
+
+    /**
+     * Get the time the next timer is due. This is exact unless all the timers in the next occupied
+     * slot are for a later turn of the wheel, then it is the end of that slot and the owner is woken
+     * once for nothing.
+     *
+     * @return  The time in milliseconds or 0 if there are no timers.
+     */
+    uint64_t NextDue() const
+    {
+        if (numTimers == 0) {
+            return 0;
+        }
+        for (uint64_t tick = currentTick;; ++tick) {
+            uint32_t timer = heads[(uint32_t)tick & slotMask];
+            if (timer != NIL) {
+                uint64_t next = (tick + 1) * tickMs;
+                for (; timer != NIL; timer = nodes[timer].next) {
+                    if (nodes[timer].due < next) {
+                        next = nodes[timer].due;
+                    }
+                }
+                return next;
+            }
+        }
+    }
+
+    /**
+     * Get the number of timers in the wheel.
+     *
+     * @return  The number of timers.
+     */
+    size_t Size() const { return numTimers; }
+
+  private:
+
+    /** A timer, nodes are reused through a free list */
+    struct Node {
+        T value;              /**< Value returned when the timer expires */
+        uint64_t due;         /**< Time in milliseconds when the timer expires */
+        uint32_t prev;        /**< Previous timer in the slot or NIL */
+        uint32_t next;        /**< Next timer in the slot, or the free list, or NIL */
+    };
+
+    /** Add a timer to the end of the slot for its due time */
+    void Link(uint32_t timer)
+    {
+        uint32_t slot = (uint32_t)(nodes[timer].due / tickMs) & slotMask;
+        nodes[timer].prev = tails[slot];
+        nodes[timer].next = NIL;
+        if (tails[slot] != NIL) {
+            nodes[tails[slot]].next = timer;
+        } else {
+            heads[slot] = timer;
+        }
+        tails[slot] = timer;
+        ++numTimers;
+    }
+
+    /** Remove a timer from its slot */
+    void Unlink(uint32_t timer)
+    {
+        Node& n = nodes[timer];
+        uint32_t slot = (uint32_t)(n.due / tickMs) & slotMask;
+        if (n.prev != NIL) {
+            nodes[n.prev].next = n.next;
+        } else {
+            heads[slot] = n.next;
+        }
+        if (n.next != NIL) {
+            nodes[n.next].prev = n.prev;
+        } else {
+            tails[slot] = n.prev;
+        }
+        --numTimers;
+    }
+
+    const uint32_t tickMs;            /**< Milliseconds covered by each slot */
+    const uint32_t slotMask;          /**< Number of slots - 1 */
+    std::vector<Node> nodes;          /**< Timer storage */
+    uint32_t freeList;                /**< First free node or NIL */
+    std::vector<uint32_t> heads;      /**< First timer in each slot or NIL */
+    std::vector<uint32_t> tails;      /**< Last timer in each slot or NIL */
+    uint64_t currentTick;             /**< Earliest tick that may have a due timer */
+    size_t numTimers;                 /**< Number of timers in the wheel */
+};
+
+template <typename T>
+const uint32_t TimingWheel<T>::NIL;
+
+}
+
+#endif
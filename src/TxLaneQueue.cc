@@ -0,0 +1,199 @@
+/**
+ * @file
+ * This file implements the prioritized transmit queue of a remote endpoint
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#include "TxLaneQueue.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+
+namespace ajn {
+
+const uint32_t TxLaneQueue::LANE_WEIGHTS[NUM_LANES] = { 8, 4, 2, 1 };
+
+TxLaneQueue::TxLaneQueue() : queued(0), nextSeq(0)
+{
+    for (size_t i = 0; i < NUM_LANES; ++i) {
+        credits[i] = LANE_WEIGHTS[i];
+        stats[i].depth = 0;
+        stats[i].sent = 0;
+        stats[i].totalWaitUs = 0;
+        stats[i].maxWaitUs = 0;
+        stats[i].coalesced = 0;
+    }
+}
+
+void TxLaneQueue::Push(const Message& msg, Lane lane, const char* sender, uint64_t now)
+{
+    assert(lane < NUM_LANES);
+    lanes[lane].push_back(Entry(msg, sender ? sender : "", nextSeq++, now));
+    ++stats[lane].depth;
+    ++queued;
+}
+
+/* Compare header fields that may be absent */
+static inline bool SameField(const char* a, const char* b)
+{
+    return ::strcmp(a ? a : "", b ? b : "") == 0;
+}
+
+bool TxLaneQueue::Coalesce(const Message& msg, Lane lane)
+{
+    assert(msg->IsLastValueSignal());
+    list<Entry>& q = lanes[lane];
+    /* Search from the back, a superseded signal is most likely to be one of the recent ones */
+    for (list<Entry>::reverse_iterator it = q.rbegin(); it != q.rend(); ++it) {
+        const Message& old = it->msg;
+        if (old->IsLastValueSignal() &&
+            (old->GetSessionId() == msg->GetSessionId()) &&
+            SameField(old->GetMemberName(), msg->GetMemberName()) &&
+            SameField(old->GetInterface(), msg->GetInterface()) &&
+            SameField(old->GetObjectPath(), msg->GetObjectPath()) &&
+            SameField(old->GetSender(), msg->GetSender()) &&
+            SameField(old->GetDestination(), msg->GetDestination())) {
+            q.erase(--(it.base()));
+            --stats[lane].depth;
+            --queued;
+            ++stats[lane].coalesced;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TxLaneQueue::RemoveExpired(Lane lane, uint32_t& maxWait)
+{
+    list<Entry>& q = lanes[lane];
+    for (list<Entry>::iterator it = q.begin(); it != q.end(); ++it) {
+        uint32_t expMs;
+        if (it->msg->IsExpired(&expMs)) {
+            q.erase(it);
+            --stats[lane].depth;
+            --queued;
+            return true;
+        }
+        maxWait = (std::min)(maxWait, expMs);
+    }
+    return false;
+}
+
+TxLaneQueue::Lane TxLaneQueue::NextLane()
+{
+    if (queued == 0) {
+        return NUM_LANES;
+    }
+    /*
+     * Serve the highest priority lane that has messages and credit left in this round. When every
+     * lane with messages has used its credit the round is over and all credits are restored.
+     */
+    for (int round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < NUM_LANES; ++i) {
+            if (!lanes[i].empty() && (credits[i] > 0)) {
+                return (Lane)i;
+            }
+        }
+        for (size_t i = 0; i < NUM_LANES; ++i) {
+            credits[i] = LANE_WEIGHTS[i];
+        }
+    }
+    assert(false);
+    return NUM_LANES;
+}
+
+Message* TxLaneQueue::Pop(uint64_t now, Lane& fromLane)
+{
+    assert(inFlight.empty());
+
+    Lane lane = NextLane();
+    if (lane == NUM_LANES) {
+        return NULL;
+    }
+    --credits[lane];
+
+    /*
+     * Look for an earlier message from the same sender in the other lanes. Only the first message
+     * from the sender in each lane needs checking since each lane is in queue order.
+     */
+    fromLane = lane;
+    list<Entry>::iterator from = lanes[lane].begin();
+    for (size_t i = 0; i < NUM_LANES; ++i) {
+        if (i == (size_t)lane) {
+            continue;
+        }
+        for (list<Entry>::iterator it = lanes[i].begin(); (it != lanes[i].end()) && (it->seq < from->seq); ++it) {
+            if (::strcmp(it->sender, from->sender) == 0) {
+                fromLane = (Lane)i;
+                from = it;
+                break;
+            }
+        }
+    }
+
+    uint64_t waitUs = (now > from->queuedAt) ? (now - from->queuedAt) : 0;
+    LaneStats& s = stats[fromLane];
+    ++s.sent;
+    s.totalWaitUs += waitUs;
+    s.maxWaitUs = (std::max)(s.maxWaitUs, waitUs);
+
+    /* Move the entry without copying it */
+    inFlight.splice(inFlight.end(), lanes[fromLane], from);
+    --s.depth;
+    --queued;
+    return &inFlight.front().msg;
+}
+
+void TxLaneQueue::Done()
+{
+    assert(!inFlight.empty());
+    inFlight.pop_front();
+}
+
+void TxLaneQueue::GetStats(Lane lane, LaneStats& laneStats) const
+{
+    laneStats = stats[lane];
+}
+
+const char* TxLaneQueue::LaneText(Lane lane)
+{
+    switch (lane) {
+    case CONTROL:
+        return "control";
+
+    case REPLY:
+        return "reply";
+
+    case METHOD_CALL:
+        return "method call";
+
+    case SIGNAL:
+        return "signal";
+
+    default:
+        return "unknown";
+    }
+}
+
+}
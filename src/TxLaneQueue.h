@@ -0,0 +1,200 @@
+#ifndef _ALLJOYN_TXLANEQUEUE_H
+#define _ALLJOYN_TXLANEQUEUE_H
+/**
+ * @file
+ * This file defines the prioritized transmit queue of a remote endpoint
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include TxLaneQueue.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <list>
+
+#include <alljoyn/Message.h>
+
+namespace ajn {
+
+/**
+ * %TxLaneQueue holds the messages waiting to be sent on a remote endpoint in one FIFO lane per
+ * message priority so that daemon control traffic and replies are not stuck behind bulk signals.
+ *
+ * Lanes are served by weighted round robin. Each lane may send up to its weight in messages per
+ * round so higher priority lanes go first but lower priority lanes are never starved.
+ *
+ * Messages from the same sender always leave in the order they were queued whatever their lanes.
+ * Receivers check serial numbers per sender and applications rely on the order of their own
+ * messages, so a lane can only overtake messages from other senders. If the next message of the
+ * lane being served has an earlier message from the same sender waiting in another lane, that
+ * earlier message is sent first.
+ *
+ * The queue is not thread safe, the owner must serialize access.
+ */
+class TxLaneQueue {
+  public:
+
+    /**
+     * Transmit lanes in priority order.
+     */
+    typedef enum {
+        CONTROL = 0,        /**< Messages for the bus controllers (org.freedesktop.DBus, org.alljoyn.Daemon) */
+        REPLY = 1,          /**< Method replies and errors */
+        METHOD_CALL = 2,    /**< Method calls */
+        SIGNAL = 3,         /**< Signals */
+        NUM_LANES = 4
+    } Lane;
+
+    /**
+     * Number of messages each lane may send per scheduling round.
+     */
+    static const uint32_t LANE_WEIGHTS[NUM_LANES];
+
+    /**
+     * Depth and wait time statistics for a lane.
+     */
+    struct LaneStats {
+        size_t depth;           /**< Number of messages waiting in the lane */
+        uint32_t sent;          /**< Number of messages taken from the lane for sending */
+        uint64_t totalWaitUs;   /**< Total microseconds those messages waited in the lane */
+        uint64_t maxWaitUs;     /**< Longest time in microseconds a message waited in the lane */
+        uint32_t coalesced;     /**< Number of last value signals discarded because a newer one was queued */
+
+        /**
+         * Get the average time a message waited in the lane.
+         */
+        uint64_t AverageWaitUs() const { return sent ? (totalWaitUs / sent) : 0; }
+    };
+
+    /**
+     * Constructor
+     */
+    TxLaneQueue();
+
+    /**
+     * Get the number of messages in the queue including a message that is being sent.
+     */
+    size_t Size() const { return queued + inFlight.size(); }
+
+    /**
+     * Get the number of messages waiting in a lane.
+     *
+     * @param lane  The lane.
+     */
+    size_t Size(Lane lane) const { return stats[lane].depth; }
+
+    /**
+     * Add a message to the back of a lane.
+     *
+     * @param msg     The message.
+     * @param lane    The lane the message belongs in.
+     * @param sender  Sender of the message, must remain valid while the message is queued.
+     * @param now     Current time in microseconds.
+     */
+    void Push(const Message& msg, Lane lane, const char* sender, uint64_t now);
+
+    /**
+     * Remove a queued last value signal that is superseded by a newer message. The queued signal is
+     * superseded if it has the same sender, destination, session, object path, interface and
+     * member. The newer message is not queued by this call, it goes to the back of the lane with
+     * Push() so the sender's messages stay in order.
+     *
+     * @param msg   The newer message, must be a last value signal.
+     * @param lane  The lane the message belongs in.
+     *
+     * @return  true if a superseded message was removed.
+     */
+    bool Coalesce(const Message& msg, Lane lane);
+
+    /**
+     * Remove the first message in a lane whose time to live has expired.
+     *
+     * @param lane     The lane.
+     * @param maxWait  [IN/OUT] Reduced to the time until the next message in the lane expires if
+     *                 that is sooner.
+     *
+     * @return  true if an expired message was removed.
+     */
+    bool RemoveExpired(Lane lane, uint32_t& maxWait);
+
+    /**
+     * Take the next message to send. The message counts toward Size() until Done() is called.
+     * Only one message can be taken at a time.
+     *
+     * @param now   Current time in microseconds.
+     * @param lane  [OUT] The lane the message was taken from.
+     *
+     * @return  The message or NULL if the queue is empty. The pointer is valid until Done() is called.
+     */
+    Message* Pop(uint64_t now, Lane& lane);
+
+    /**
+     * Release the message returned by Pop() once it has been sent.
+     */
+    void Done();
+
+    /**
+     * Get the time the message returned by Pop() was queued.
+     *
+     * @return  The time in microseconds that was passed to Push().
+     */
+    uint64_t GetQueuedTime() const { return inFlight.front().queuedAt; }
+
+    /**
+     * Get the statistics for a lane.
+     *
+     * @param lane   The lane.
+     * @param stats  [OUT] The statistics.
+     */
+    void GetStats(Lane lane, LaneStats& stats) const;
+
+    /**
+     * Get the name of a lane for logging.
+     *
+     * @param lane  The lane.
+     */
+    static const char* LaneText(Lane lane);
+
+  private:
+
+    /** A queued message */
+    struct Entry {
+        Message msg;            /**< The message */
+        const char* sender;     /**< Sender of the message */
+        uint64_t seq;           /**< Order in which messages were queued */
+        uint64_t queuedAt;      /**< Time the message was queued */
+        Entry(const Message& msg, const char* sender, uint64_t seq, uint64_t queuedAt) :
+            msg(msg), sender(sender), seq(seq), queuedAt(queuedAt) { }
+    };
+
+    /** Choose the lane to serve next or return NUM_LANES if all lanes are empty */
+    Lane NextLane();
+
+    std::list<Entry> lanes[NUM_LANES];      /**< Queued messages */
+    int32_t credits[NUM_LANES];             /**< Messages each lane may still send this round */
+    LaneStats stats[NUM_LANES];             /**< Per lane statistics */
+    std::list<Entry> inFlight;              /**< The message returned by Pop() */
+    size_t queued;                          /**< Total number of messages in the lanes */
+    uint64_t nextSeq;                       /**< Sequence number for the next message queued */
+};
+
+}
+
+#endif
@@ -22,11 +22,14 @@
 
 #include <qcc/platform.h>
 
-#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
-#include <qcc/XmlElement.h>
+#include <qcc/Util.h>
 
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/BusAttachment.h>
@@ -48,202 +51,542 @@ using namespace std;
 
 namespace ajn {
 
-QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
+IntrospectionNode::~IntrospectionNode()
 {
-    QStatus status = ER_OK;
+    for (size_t i = 0; i < ifaces.size(); ++i) {
+        delete ifaces[i];
+    }
+    for (size_t i = 0; i < children.size(); ++i) {
+        delete children[i];
+    }
+}
+
+/*
+ * Streaming scanner for introspection XML. The XML is copied into a buffer owned by the scanner and
+ * element names and attribute values are NUL terminated in place so they stay valid for the life of
+ * the scanner. Processing instructions, comments, declarations and character data are skipped.
+ */
+class XmlScanner {
+  public:
 
-    assert(elem->GetName() == "interface");
+    /** Events returned by Next() */
+    enum Event {
+        START_ELEMENT,  /**< Start of an element, the name and attributes are available */
+        END_ELEMENT,    /**< End of an element, the name is available */
+        END_DOCUMENT,   /**< There are no more elements */
+        MALFORMED       /**< The XML is not well formed */
+    };
 
-    qcc::String ifName = elem->GetAttribute("name");
-    if (!IsLegalInterfaceName(ifName.c_str())) {
-        status = ER_BUS_BAD_INTERFACE_NAME;
-        QCC_LogError(status, ("Invalid interface name \"%s\" in XML introspection data for %s", ifName.c_str(), ident));
-        return status;
+    XmlScanner(const char* xml) : name(NULL), numAttrs(0), pendingEnd(false)
+    {
+        size_t len = ::strlen(xml);
+        buf = new char[len + 1];
+        ::memcpy(buf, xml, len + 1);
+        pos = buf;
     }
 
-    /* Get "secure" annotation */
-    // TODO Think problem is here
-    bool secure = false;
-    vector<XmlElement*>::const_iterator ifIt = elem->GetChildren().begin();
-    while (ifIt != elem->GetChildren().end()) {
-        const XmlElement* ifChildElem = *ifIt++;
-        qcc::String ifChildName = ifChildElem->GetName();
-        if ((ifChildName == "annotation") && (ifChildElem->GetAttribute("name") == org::alljoyn::Bus::Secure)) {
-            secure = (ifChildElem->GetAttribute("value") == "true");
-            break;
+    ~XmlScanner() { delete [] buf; }
+
+    /**
+     * Scan to the next element start or end. An empty element tag is reported as a start followed
+     * by an end.
+     */
+    Event Next();
+
+    /** Name of the element just scanned */
+    const char* GetName() const { return name; }
+
+    /** Value of an attribute of the element just started or "" if the attribute is not present */
+    const char* GetAttribute(const char* attrName) const
+    {
+        for (size_t i = 0; i < numAttrs; ++i) {
+            if (::strcmp(attrs[i].name, attrName) == 0) {
+                return attrs[i].value;
+            }
         }
+        return "";
     }
 
-    /* Create a new interface */
-    InterfaceDescription intf(ifName.c_str(), secure);
-
-    /* Iterate over <method>, <signal> and <property> elements */
-    ifIt = elem->GetChildren().begin();
-    while ((ER_OK == status) && (ifIt != elem->GetChildren().end())) {
-        const XmlElement* ifChildElem = *ifIt++;
-        const qcc::String& ifChildName = ifChildElem->GetName();
-        const qcc::String& memberName = ifChildElem->GetAttribute("name");
-        if ((ifChildName == "method") || (ifChildName == "signal")) {
-            if (IsLegalMemberName(memberName.c_str())) {
-
-                bool isMethod = (ifChildName == "method");
-                bool isSignal = (ifChildName == "signal");
-                bool isFirstArg = true;
-                qcc::String inSig;
-                qcc::String outSig;
-                qcc::String argList;
-                uint8_t annotations = 0;
-
-                /* Iterate over member children */
-                const vector<XmlElement*>& argChildren = ifChildElem->GetChildren();
-                vector<XmlElement*>::const_iterator argIt = argChildren.begin();
-                while ((ER_OK == status) && (argIt != argChildren.end())) {
-                    const XmlElement* argElem = *argIt++;
-                    if (argElem->GetName() == "arg") {
-                        if (!isFirstArg) {
-                            argList += ',';
-                        }
-                        isFirstArg = false;
-                        const qcc::String& typeAtt = argElem->GetAttribute("type");
-
-                        if (typeAtt.empty()) {
-                            status = ER_BUS_BAD_XML;
-                            QCC_LogError(status, ("Malformed <arg> tag (bad attributes)"));
-                            break;
-                        }
-
-                        argList += argElem->GetAttribute("name");
-                        if (isSignal || (argElem->GetAttribute("direction") == "in")) {
-                            inSig += typeAtt;
-                        } else {
-                            outSig += typeAtt;
-                        }
-                    } else if (argElem->GetName() == "annotation") {
-                        const qcc::String& nameAtt = argElem->GetAttribute("name");
-                        const qcc::String& valueAtt = argElem->GetAttribute("value");
-
-                        if (nameAtt == org::freedesktop::DBus::AnnotateDeprecated && valueAtt == "true") {
-                            annotations |= MEMBER_ANNOTATE_DEPRECATED;
-                        } else if (nameAtt == org::freedesktop::DBus::AnnotateNoReply && valueAtt == "true") {
-                            annotations |= MEMBER_ANNOTATE_NO_REPLY;
-                        }
-                    }
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    XmlScanner(const XmlScanner& other);
+    XmlScanner& operator=(const XmlScanner& other);
+
+    /** Introspection elements have at most three attributes, any beyond this are ignored */
+    static const size_t MAX_ATTRIBUTES = 8;
+
+    struct Attribute {
+        const char* name;
+        const char* value;
+    };
+
+    static bool IsSpace(char c) { return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r'); }
+    static bool IsNameEnd(char c) { return IsSpace(c) || (c == '/') || (c == '>') || (c == '=') || (c == 0); }
+    static void DecodeEntities(char* str);
+
+    void SkipSpace() { while (IsSpace(*pos)) { ++pos; } }
+
+    bool SkipPast(const char* delim)
+    {
+        char* end = ::strstr(pos, delim);
+        if (end) {
+            pos = end + ::strlen(delim);
+        }
+        return end != NULL;
+    }
+
+    char* buf;                         /**< Copy of the XML */
+    char* pos;                         /**< Current scan position */
+    const char* name;                  /**< Name of the current element */
+    Attribute attrs[MAX_ATTRIBUTES];   /**< Attributes of the current element */
+    size_t numAttrs;                   /**< Number of attributes of the current element */
+    bool pendingEnd;                   /**< The current element was an empty element tag */
+};
+
+void XmlScanner::DecodeEntities(char* str)
+{
+    static const struct {
+        const char* entity;
+        size_t len;
+        char c;
+    } entities[] = {
+        { "&lt;", 4, '<' }, { "&gt;", 4, '>' }, { "&amp;", 5, '&' }, { "&quot;", 6, '"' }, { "&apos;", 6, '\'' }
+    };
+
+    char* in = ::strchr(str, '&');
+    if (!in) {
+        return;
+    }
+    char* out = in;
+    while (*in) {
+        if (*in == '&') {
+            size_t i;
+            for (i = 0; i < ArraySize(entities); ++i) {
+                if (::strncmp(in, entities[i].entity, entities[i].len) == 0) {
+                    break;
                 }
+            }
+            if (i < ArraySize(entities)) {
+                *out++ = entities[i].c;
+                in += entities[i].len;
+                continue;
+            }
+            /* Character references, introspection data is ASCII so only those are decoded */
+            if (in[1] == '#') {
+                char* end;
+                unsigned long c = (in[2] == 'x') ? ::strtoul(in + 3, &end, 16) : ::strtoul(in + 2, &end, 10);
+                if ((*end == ';') && (c > 0) && (c < 0x80)) {
+                    *out++ = (char)c;
+                    in = end + 1;
+                    continue;
+                }
+            }
+        }
+        *out++ = *in++;
+    }
+    *out = 0;
+}
 
-                /* Add the member */
-                if ((ER_OK == status) && (isMethod || isSignal)) {
-                    status = intf.AddMember(isMethod ? MESSAGE_METHOD_CALL : MESSAGE_SIGNAL,
-                                            memberName.c_str(),
-                                            inSig.c_str(),
-                                            outSig.c_str(),
-                                            argList.c_str(),
-                                            annotations);
+XmlScanner::Event XmlScanner::Next()
+{
+    if (pendingEnd) {
+        pendingEnd = false;
+        numAttrs = 0;
+        return END_ELEMENT;
+    }
+    for (;;) {
+        /* Skip character data */
+        while (*pos && (*pos != '<')) {
+            ++pos;
+        }
+        if (!*pos) {
+            return END_DOCUMENT;
+        }
+        ++pos;
+        if (*pos == '?') {
+            if (!SkipPast("?>")) {
+                return MALFORMED;
+            }
+        } else if (::strncmp(pos, "!--", 3) == 0) {
+            if (!SkipPast("-->")) {
+                return MALFORMED;
+            }
+        } else if (*pos == '!') {
+            /* DOCTYPE and other declarations, these may have an internal subset in brackets */
+            int depth = 0;
+            while (*pos && ((*pos != '>') || (depth > 0))) {
+                if (*pos == '[') {
+                    ++depth;
+                } else if (*pos == ']') {
+                    --depth;
+                }
+                ++pos;
+            }
+            if (!*pos) {
+                return MALFORMED;
+            }
+            ++pos;
+        } else if (*pos == '/') {
+            name = ++pos;
+            while (!IsNameEnd(*pos)) {
+                ++pos;
+            }
+            char* nameEnd = pos;
+            SkipSpace();
+            if ((nameEnd == name) || (*pos != '>')) {
+                return MALFORMED;
+            }
+            *nameEnd = 0;
+            ++pos;
+            numAttrs = 0;
+            return END_ELEMENT;
+        } else {
+            name = pos;
+            while (!IsNameEnd(*pos)) {
+                ++pos;
+            }
+            if (pos == name) {
+                return MALFORMED;
+            }
+            char* nameEnd = pos;
+            numAttrs = 0;
+            for (;;) {
+                SkipSpace();
+                if (*pos == '>') {
+                    ++pos;
+                    break;
                 }
+                if ((pos[0] == '/') && (pos[1] == '>')) {
+                    pendingEnd = true;
+                    pos += 2;
+                    break;
+                }
+                char* attrName = pos;
+                while (!IsNameEnd(*pos)) {
+                    ++pos;
+                }
+                char* attrNameEnd = pos;
+                SkipSpace();
+                if ((attrNameEnd == attrName) || (*pos != '=')) {
+                    return MALFORMED;
+                }
+                ++pos;
+                SkipSpace();
+                char quote = *pos;
+                if ((quote != '"') && (quote != '\'')) {
+                    return MALFORMED;
+                }
+                char* value = ++pos;
+                while (*pos && (*pos != quote)) {
+                    ++pos;
+                }
+                if (!*pos) {
+                    return MALFORMED;
+                }
+                /* Terminate in place, the characters overwritten have already been scanned */
+                *pos++ = 0;
+                *attrNameEnd = 0;
+                DecodeEntities(value);
+                if (numAttrs < MAX_ATTRIBUTES) {
+                    attrs[numAttrs].name = attrName;
+                    attrs[numAttrs].value = value;
+                    ++numAttrs;
+                }
+            }
+            *nameEnd = 0;
+            return START_ELEMENT;
+        }
+    }
+}
+
+/** The kinds of element the introspection parser tracks */
+enum IntrospectionElementType {
+    NODE_ELEMENT,
+    INTERFACE_ELEMENT,
+    MEMBER_ELEMENT,
+    PROPERTY_ELEMENT,
+    OTHER_ELEMENT
+};
+
+/** An element that has been started but not ended */
+struct OpenElement {
+    IntrospectionElementType type;   /**< The kind of element */
+    const char* name;                /**< The element name, points into the scanner buffer */
+    IntrospectionNode* node;         /**< The node for a <node> element */
+};
+
+QStatus XmlHelper::AddInterfaceDefinitions(const char* xml)
+{
+    IntrospectionNode node;
+    QStatus status = Parse(xml, node, true);
+    if (ER_OK == status) {
+        status = AddNode(node, NULL);
+    }
+    return status;
+}
+
+QStatus XmlHelper::AddProxyObjects(ProxyBusObject& parent, const char* xml)
+{
+    IntrospectionNode node;
+    QStatus status = Parse(xml, node, false);
+    if (ER_OK == status) {
+        status = AddNode(node, &parent);
+    }
+    return status;
+}
+
+QStatus XmlHelper::Parse(const char* xml, IntrospectionNode& root, bool allowInterfaceRoot)
+{
+    QStatus status = ER_OK;
+    XmlScanner scanner(xml);
+    vector<OpenElement> stack;
+    bool sawRoot = false;
+
+    /* The interface and member being parsed, the strings are reused to avoid reallocating them */
+    InterfaceDescription* intf = NULL;
+    bool isMethod = false;
+    bool isFirstArg = true;
+    qcc::String memberName;
+    qcc::String inSig;
+    qcc::String outSig;
+    qcc::String argList;
+    uint8_t annotations = 0;
+
+    while (ER_OK == status) {
+        XmlScanner::Event event = scanner.Next();
+        if (event == XmlScanner::END_DOCUMENT) {
+            if (!sawRoot || !stack.empty()) {
+                status = ER_BUS_BAD_XML;
+                QCC_LogError(status, ("Incomplete introspection data for %s", ident));
+            }
+            break;
+        }
+        if (event == XmlScanner::MALFORMED) {
+            status = ER_BUS_BAD_XML;
+            QCC_LogError(status, ("Malformed introspection data for %s", ident));
+            break;
+        }
+        const char* elemName = scanner.GetName();
+
+        if (event == XmlScanner::END_ELEMENT) {
+            if (stack.empty() || (::strcmp(stack.back().name, elemName) != 0)) {
+                status = ER_BUS_BAD_XML;
+                QCC_LogError(status, ("Unexpected end tag </%s> in introspection data for %s", elemName, ident));
+                break;
+            }
+            if (stack.back().type == MEMBER_ELEMENT) {
+                /* Add the member now all its arguments and annotations are known */
+                status = intf->AddMember(isMethod ? MESSAGE_METHOD_CALL : MESSAGE_SIGNAL,
+                                         memberName.c_str(),
+                                         inSig.c_str(),
+                                         outSig.c_str(),
+                                         argList.c_str(),
+                                         annotations);
+            } else if (stack.back().type == INTERFACE_ELEMENT) {
+                intf = NULL;
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        OpenElement elem;
+        elem.type = OTHER_ELEMENT;
+        elem.name = elemName;
+        elem.node = NULL;
+        IntrospectionElementType parentType = stack.empty() ? OTHER_ELEMENT : stack.back().type;
+        IntrospectionNode* parentNode = stack.empty() ? NULL : stack.back().node;
+
+        if (stack.empty()) {
+            if (sawRoot) {
+                status = ER_BUS_BAD_XML;
+                QCC_LogError(status, ("Multiple root elements in introspection data for %s", ident));
+                break;
+            }
+            sawRoot = true;
+            if (::strcmp(elemName, "node") == 0) {
+                elem.type = NODE_ELEMENT;
+                elem.node = &root;
+            } else if (allowInterfaceRoot && (::strcmp(elemName, "interface") == 0)) {
+                parentType = NODE_ELEMENT;
+                parentNode = &root;
             } else {
-                status = ER_BUS_BAD_MEMBER_NAME;
-                QCC_LogError(status, ("Illegal member name \"%s\" introspection data for %s", memberName.c_str(), ident));
-            }
-        } else if (ifChildName == "property") {
-            const qcc::String& sig = ifChildElem->GetAttribute("type");
-            const qcc::String& accessStr = ifChildElem->GetAttribute("access");
-            if (!SignatureUtils::IsCompleteType(sig.c_str())) {
-                status = ER_BUS_BAD_SIGNATURE;
-                QCC_LogError(status, ("Invalid signature for property %s in introspection data from %s", memberName.c_str(), ident));
-            } else if (memberName.empty()) {
-                status = ER_BUS_BAD_BUS_NAME;
-                QCC_LogError(status, ("Invalid name attribute for property in introspection data from %s", ident));
+                status = ER_BUS_BAD_XML;
+                QCC_LogError(status, ("Unexpected root element <%s> in introspection data for %s", elemName, ident));
+                break;
+            }
+        }
+
+        if (parentType == NODE_ELEMENT) {
+            if (::strcmp(elemName, "interface") == 0) {
+                const char* ifName = scanner.GetAttribute("name");
+                if (!IsLegalInterfaceName(ifName)) {
+                    status = ER_BUS_BAD_INTERFACE_NAME;
+                    QCC_LogError(status, ("Invalid interface name \"%s\" in XML introspection data for %s", ifName, ident));
+                    break;
+                }
+                /* The secure annotation can come after the members so is applied when it is seen */
+                intf = new InterfaceDescription(ifName, false);
+                parentNode->ifaces.push_back(intf);
+                elem.type = INTERFACE_ELEMENT;
+            } else if (::strcmp(elemName, "node") == 0) {
+                IntrospectionNode* child = new IntrospectionNode();
+                child->name = scanner.GetAttribute("name");
+                parentNode->children.push_back(child);
+                elem.type = NODE_ELEMENT;
+                elem.node = child;
+            }
+        } else if (parentType == INTERFACE_ELEMENT) {
+            const char* attrName = scanner.GetAttribute("name");
+            if ((::strcmp(elemName, "method") == 0) || (::strcmp(elemName, "signal") == 0)) {
+                if (!IsLegalMemberName(attrName)) {
+                    status = ER_BUS_BAD_MEMBER_NAME;
+                    QCC_LogError(status, ("Illegal member name \"%s\" introspection data for %s", attrName, ident));
+                    break;
+                }
+                isMethod = (elemName[0] == 'm');
+                isFirstArg = true;
+                memberName = attrName;
+                inSig.clear();
+                outSig.clear();
+                argList.clear();
+                annotations = 0;
+                elem.type = MEMBER_ELEMENT;
+            } else if (::strcmp(elemName, "property") == 0) {
+                const char* sig = scanner.GetAttribute("type");
+                const char* accessStr = scanner.GetAttribute("access");
+                if (!SignatureUtils::IsCompleteType(sig)) {
+                    status = ER_BUS_BAD_SIGNATURE;
+                    QCC_LogError(status, ("Invalid signature for property %s in introspection data from %s", attrName, ident));
+                } else if (!*attrName) {
+                    status = ER_BUS_BAD_BUS_NAME;
+                    QCC_LogError(status, ("Invalid name attribute for property in introspection data from %s", ident));
+                } else {
+                    uint8_t access = 0;
+                    if (::strcmp(accessStr, "read") == 0) access = PROP_ACCESS_READ;
+                    if (::strcmp(accessStr, "write") == 0) access = PROP_ACCESS_WRITE;
+                    if (::strcmp(accessStr, "readwrite") == 0) access = PROP_ACCESS_RW;
+                    status = intf->AddProperty(attrName, sig, access);
+                }
+                elem.type = PROPERTY_ELEMENT;
+            } else if (::strcmp(elemName, "annotation") == 0) {
+                if (::strcmp(attrName, org::alljoyn::Bus::Secure) == 0) {
+                    intf->secure = (::strcmp(scanner.GetAttribute("value"), "true") == 0);
+                }
             } else {
-                uint8_t access = 0;
-                if (accessStr == "read") access = PROP_ACCESS_READ;
-                if (accessStr == "write") access = PROP_ACCESS_WRITE;
-                if (accessStr == "readwrite") access = PROP_ACCESS_RW;
-                status = intf.AddProperty(memberName.c_str(), sig.c_str(), access);
+                status = ER_FAIL;
+                QCC_LogError(status, ("Unknown element \"%s\" found in introspection data from %s", elemName, ident));
+                break;
+            }
+        } else if (parentType == MEMBER_ELEMENT) {
+            if (::strcmp(elemName, "arg") == 0) {
+                const char* typeAtt = scanner.GetAttribute("type");
+                if (!*typeAtt) {
+                    status = ER_BUS_BAD_XML;
+                    QCC_LogError(status, ("Malformed <arg> tag (bad attributes)"));
+                    break;
+                }
+                if (!isFirstArg) {
+                    argList += ',';
+                }
+                isFirstArg = false;
+                argList += scanner.GetAttribute("name");
+                if (!isMethod || (::strcmp(scanner.GetAttribute("direction"), "in") == 0)) {
+                    inSig += typeAtt;
+                } else {
+                    outSig += typeAtt;
+                }
+            } else if (::strcmp(elemName, "annotation") == 0) {
+                const char* nameAtt = scanner.GetAttribute("name");
+                bool isTrue = (::strcmp(scanner.GetAttribute("value"), "true") == 0);
+                if (isTrue && (::strcmp(nameAtt, org::freedesktop::DBus::AnnotateDeprecated) == 0)) {
+                    annotations |= MEMBER_ANNOTATE_DEPRECATED;
+                } else if (isTrue && (::strcmp(nameAtt, org::freedesktop::DBus::AnnotateNoReply) == 0)) {
+                    annotations |= MEMBER_ANNOTATE_NO_REPLY;
+                } else if (isTrue && (::strcmp(nameAtt, org::alljoyn::Bus::AnnotateLastValue) == 0)) {
+                    annotations |= MEMBER_ANNOTATE_LAST_VALUE;
+                }
             }
-        } else if (ifChildName != "annotation") {
-            status = ER_FAIL;
-            QCC_LogError(status, ("Unknown element \"%s\" found in introspection data from %s", ifChildName.c_str(), ident));
-            break;
         }
+        stack.push_back(elem);
     }
+    return status;
+}
+
+QStatus XmlHelper::AddInterface(const InterfaceDescription& intf, ProxyBusObject* obj)
+{
     /* Add the interface with all its methods, signals and properties */
+    InterfaceDescription* newIntf = NULL;
+    QStatus status = bus->CreateInterface(intf.GetName(), newIntf);
     if (ER_OK == status) {
-        InterfaceDescription* newIntf = NULL;
-        status = bus->CreateInterface(intf.GetName(), newIntf);
-        if (ER_OK == status) {
-            /* Assign new interface */
-            *newIntf = intf;
-            newIntf->Activate();
-            if (obj) {
-                obj->AddInterface(*newIntf);
-            }
-        } else if (ER_BUS_IFACE_ALREADY_EXISTS == status) {
-            /* Make sure definition matches existing one */
-            const InterfaceDescription* existingIntf = bus->GetInterface(intf.GetName());
-            if (existingIntf) {
-                if (*existingIntf == intf) {
-                    if (obj) {
-                        obj->AddInterface(*existingIntf);
-                    }
-                    status = ER_OK;
-                } else {
-                    status = ER_BUS_INTERFACE_MISMATCH;
-                    QCC_LogError(status, ("XML interface does not match existing definition for \"%s\"", intf.GetName()));
+        /* Assign new interface */
+        *newIntf = intf;
+        newIntf->Activate();
+        if (obj) {
+            obj->AddInterface(*newIntf);
+        }
+    } else if (ER_BUS_IFACE_ALREADY_EXISTS == status) {
+        /* Make sure definition matches existing one */
+        const InterfaceDescription* existingIntf = bus->GetInterface(intf.GetName());
+        if (existingIntf) {
+            if (*existingIntf == intf) {
+                if (obj) {
+                    obj->AddInterface(*existingIntf);
                 }
+                status = ER_OK;
             } else {
-                status = ER_FAIL;
-                QCC_LogError(status, ("Failed to retrieve existing interface \"%s\"", intf.GetName()));
+                status = ER_BUS_INTERFACE_MISMATCH;
+                QCC_LogError(status, ("XML interface does not match existing definition for \"%s\"", intf.GetName()));
             }
         } else {
-            QCC_LogError(status, ("Failed to create new inteface \"%s\"", intf.GetName()));
+            status = ER_FAIL;
+            QCC_LogError(status, ("Failed to retrieve existing interface \"%s\"", intf.GetName()));
         }
+    } else {
+        QCC_LogError(status, ("Failed to create new inteface \"%s\"", intf.GetName()));
     }
     return status;
 }
 
-QStatus XmlHelper::ParseNode(const XmlElement* root, ProxyBusObject* obj)
+QStatus XmlHelper::AddNode(const IntrospectionNode& node, ProxyBusObject* obj)
 {
     QStatus status = ER_OK;
 
-    assert(root->GetName() == "node");
-
-    /* Iterate over <interface> and <node> elements */
-    const vector<XmlElement*>& rootChildren = root->GetChildren();
-    vector<XmlElement*>::const_iterator it = rootChildren.begin();
-    while ((ER_OK == status) && (it != rootChildren.end())) {
-        const XmlElement* elem = *it++;
-        const qcc::String& elemName = elem->GetName();
-        if (elemName == "interface") {
-            status = ParseInterface(elem, obj);
-        } else if (elemName == "node") {
-            if (obj) {
-                const qcc::String& relativePath = elem->GetAttribute("name");
-                qcc::String childObjPath = obj->GetPath();
-                if (0 || childObjPath.size() > 1) {
-                    childObjPath += '/';
-                }
-                childObjPath += relativePath;
-                if (!relativePath.empty() & IsLegalObjectPath(childObjPath.c_str())) {
-                    /* Check for existing child with the same name. Use this child if found, otherwise create a new one */
-                    ProxyBusObject* childObj = obj->GetChild(relativePath.c_str());
-                    if (childObj) {
-                        status = ParseNode(elem, childObj);
-                    } else {
-                        ProxyBusObject newChild(*bus, obj->GetServiceName().c_str(), childObjPath.c_str(), obj->sessionId);
-                        status = ParseNode(elem, &newChild);
-                        if (ER_OK == status) {
-                            obj->AddChild(newChild);
-                        }
-                    }
-                    if (ER_OK != status) {
-                        QCC_LogError(status, ("Failed to parse child object %s in introspection data for %s", childObjPath.c_str(), ident));
-                    }
+    vector<InterfaceDescription*>::const_iterator ifIt = node.ifaces.begin();
+    while ((ER_OK == status) && (ifIt != node.ifaces.end())) {
+        status = AddInterface(**ifIt++, obj);
+    }
+    vector<IntrospectionNode*>::const_iterator it = node.children.begin();
+    while ((ER_OK == status) && (it != node.children.end())) {
+        const IntrospectionNode* child = *it++;
+        if (obj) {
+            const qcc::String& relativePath = child->name;
+            qcc::String childObjPath = obj->GetPath();
+            if (childObjPath.size() > 1) {
+                childObjPath += '/';
+            }
+            childObjPath += relativePath;
+            if (!relativePath.empty() && IsLegalObjectPath(childObjPath.c_str())) {
+                /* Check for existing child with the same name. Use this child if found, otherwise create a new one */
+                ProxyBusObject* childObj = obj->GetChild(relativePath.c_str());
+                if (childObj) {
+                    status = AddNode(*child, childObj);
                 } else {
-                    status = ER_FAIL;
-                    QCC_LogError(status, ("Illegal child object name \"%s\" specified in introspection for %s", relativePath.c_str(), ident));
+                    ProxyBusObject newChild(*bus, obj->GetServiceName().c_str(), childObjPath.c_str(), obj->sessionId);
+                    status = AddNode(*child, &newChild);
+                    if (ER_OK == status) {
+                        obj->AddChild(newChild);
+                    }
+                }
+                if (ER_OK != status) {
+                    QCC_LogError(status, ("Failed to parse child object %s in introspection data for %s", childObjPath.c_str(), ident));
                 }
             } else {
-                status = ParseNode(elem, NULL);
+                status = ER_FAIL;
+                QCC_LogError(status, ("Illegal child object name \"%s\" specified in introspection for %s", relativePath.c_str(), ident));
             }
+        } else {
+            status = AddNode(*child, NULL);
         }
     }
     return status;
@@ -3,7 +3,7 @@
 /**
  * @file
  *
- * This file defines a class for traversing introspection XML.
+ * This file defines a class for parsing introspection XML.
  *
  */
 
@@ -28,8 +28,10 @@
 #endif
 
 #include <qcc/platform.h>
+
+#include <vector>
+
 #include <qcc/String.h>
-#include <qcc/XmlElement.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/ProxyBusObject.h>
@@ -40,7 +42,34 @@
 namespace ajn {
 
 /**
- * XmlHelper is a utility class for traversing introspection XML.
+ * The interfaces and child nodes described by a <node> element in introspection XML. A tree of
+ * these can be added to proxy objects any number of times without parsing the XML again.
+ */
+class IntrospectionNode {
+  public:
+
+    IntrospectionNode() { }
+
+    ~IntrospectionNode();
+
+    qcc::String name;                            /**< Relative path of a child node */
+    std::vector<InterfaceDescription*> ifaces;   /**< Interfaces described for the node */
+    std::vector<IntrospectionNode*> children;    /**< Child nodes */
+
+  private:
+
+    /* Copy constructor and assignment operator are private and not implemented */
+    IntrospectionNode(const IntrospectionNode& other);
+    IntrospectionNode& operator=(const IntrospectionNode& other);
+};
+
+/**
+ * XmlHelper is a utility class for parsing introspection XML.
+ *
+ * The XML is parsed in a single pass by a streaming parser that builds the interface descriptions
+ * as the elements are scanned, there is no intermediate document tree. The parser copies the XML
+ * into one buffer and terminates names and attribute values in place so parsing a large document
+ * only makes a handful of allocations beyond the interfaces themselves.
  */
 class XmlHelper {
   public:
@@ -48,47 +77,62 @@ class XmlHelper {
     XmlHelper(BusAttachment* bus, const char* ident) : bus(bus), ident(ident) { }
 
     /**
-     * Traverse the XML tree adding all interfaces to the bus. Nodes are ignored.
+     * Parse introspection XML adding all interfaces to the bus. Nodes are ignored.
      *
-     * @param root  The root can be an <interface> or <node> element.
+     * @param xml  The root can be an <interface> or <node> element.
      *
      * @return #ER_OK if the XML was well formed and the interfaces were added.
      *         #ER_BUS_BAD_XML if the XML was not as expected.
      *         #Other errors indicating the interfaces were not succesfully added.
      */
-    QStatus AddInterfaceDefinitions(const qcc::XmlElement* root) {
-        if (root) {
-            if (root->GetName() == "interface") {
-                return ParseInterface(root, NULL);
-            } else if (root->GetName() == "node") {
-                return ParseNode(root, NULL);
-            }
-        }
-        return ER_BUS_BAD_XML;
-    }
+    QStatus AddInterfaceDefinitions(const char* xml);
 
     /**
-     * Traverse the XML tree recursively adding all nodes as children of a parent proxy object.
+     * Parse introspection XML recursively adding all nodes as children of a parent proxy object.
      *
      * @param parent  The parent proxy object to add the children too.
-     * @param root    The root must be a <node> element.
+     * @param xml     The root must be a <node> element.
      *
      * @return #ER_OK if the XML was well formed and the children were added.
      *         #ER_BUS_BAD_XML if the XML was not as expected.
      *         #Other errors indicating the children were not succesfully added.
      */
-    QStatus AddProxyObjects(ProxyBusObject& parent, const qcc::XmlElement* root) {
-        if (root && (root->GetName() == "node")) {
-            return ParseNode(root, &parent);
-        } else {
-            return ER_BUS_BAD_XML;
-        }
+    QStatus AddProxyObjects(ProxyBusObject& parent, const char* xml);
+
+    /**
+     * Parse introspection XML building a tree of the interfaces and child nodes it describes.
+     * Nothing is added to the bus.
+     *
+     * @param xml   The root must be a <node> element.
+     * @param node  Returns the interfaces and children described by the root.
+     *
+     * @return #ER_OK if the XML was well formed.
+     *         #ER_BUS_BAD_XML if the XML was not as expected.
+     *         #Other errors indicating the interfaces were not valid.
+     */
+    QStatus ParseIntrospection(const char* xml, IntrospectionNode& node) {
+        return Parse(xml, node, false);
+    }
+
+    /**
+     * Add the interfaces and children from a tree built by ParseIntrospection() to a parent
+     * proxy object.
+     *
+     * @param parent  The parent proxy object to add the interfaces and children to.
+     * @param node    The root of the tree.
+     *
+     * @return #ER_OK if the interfaces and children were added.
+     *         #Other errors indicating the interfaces or children were not succesfully added.
+     */
+    QStatus AddProxyObjects(ProxyBusObject& parent, const IntrospectionNode& node) {
+        return AddNode(node, &parent);
     }
 
   private:
 
-    QStatus ParseNode(const qcc::XmlElement* elem, ProxyBusObject* obj);
-    QStatus ParseInterface(const qcc::XmlElement* elem, ProxyBusObject* obj);
+    QStatus Parse(const char* xml, IntrospectionNode& node, bool allowInterfaceRoot);
+    QStatus AddNode(const IntrospectionNode& node, ProxyBusObject* obj);
+    QStatus AddInterface(const InterfaceDescription& intf, ProxyBusObject* obj);
 
     BusAttachment* bus;
     const char* ident;
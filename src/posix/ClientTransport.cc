@@ -41,6 +41,7 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "ClientTransport.h"
+#include "SharedMemoryStream.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -62,12 +63,24 @@ class ClientEndpoint : public RemoteEndpoint {
         userId(-1),
         groupId(-1),
         processId(-1),
-        stream(sock)
+        stream(sock),
+        shmStream(NULL)
     {
     }
 
     /* Destructor */
-    virtual ~ClientEndpoint() { }
+    virtual ~ClientEndpoint() { delete shmStream; }
+
+    /**
+     * Move the endpoint onto shared memory. The socket stays open to detect the daemon going away.
+     *
+     * @param shmStream   The shared memory stream, this endpoint takes ownership of it.
+     */
+    void SetSharedMemoryStream(SharedMemoryStream* shmStream)
+    {
+        this->shmStream = shmStream;
+        SetStream(shmStream);
+    }
 
     /**
      * Set the user id of the endpoint.
@@ -124,6 +137,7 @@ class ClientEndpoint : public RemoteEndpoint {
     uint32_t groupId;
     uint32_t processId;
     SocketStream stream;
+    SharedMemoryStream* shmStream;
 };
 
 QStatus ClientTransport::NormalizeTransportSpec(const char* inSpec, qcc::String& outSpec, map<qcc::String, qcc::String>& argMap) const
@@ -267,16 +281,31 @@ QStatus ClientTransport::Connect(const char* connectArgs, const SessionOpts& opt
         if (m_stopping) {
             status = ER_BUS_TRANSPORT_NOT_STARTED;
         } else {
-            m_endpoint = new ClientEndpoint(m_bus, false, normSpec, sockFd);
+            ClientEndpoint* ep = new ClientEndpoint(m_bus, false, normSpec, sockFd);
+            m_endpoint = ep;
 
             /* Initialized the features for this endpoint */
             m_endpoint->GetFeatures().isBusToBus = false;
             m_endpoint->GetFeatures().allowRemote = m_bus.GetInternal().AllowRemoteMessages();
             m_endpoint->GetFeatures().handlePassing = true;
+            m_endpoint->GetFeatures().sharedMemory = SharedMemoryStream::IsSupported();
 
             qcc::String authName;
             qcc::String redirection;
             status = m_endpoint->Establish("EXTERNAL", authName, redirection);
+            if ((status == ER_OK) && m_endpoint->GetFeatures().sharedMemory) {
+                /*
+                 * The daemon agreed to use shared memory and is waiting for us to send it. If we
+                 * can't create it the daemon is told to carry on using the socket.
+                 */
+                SharedMemoryStream* shmStream;
+                QStatus shmStatus = SharedMemoryStream::Connect(sockFd, shmStream);
+                if (shmStatus == ER_OK) {
+                    ep->SetSharedMemoryStream(shmStream);
+                } else {
+                    QCC_LogError(shmStatus, ("ClientTransport::Connect(): Shared memory not available, using socket"));
+                }
+            }
             if (status == ER_OK) {
                 m_endpoint->SetListener(this);
                 status = m_endpoint->Start();
@@ -0,0 +1,652 @@
+/**
+ * @file
+ * Implementation of the SharedMemoryStream for Linux
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include "SharedMemoryStream.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+/*
+ * Older C libraries don't define everything the kernel supports
+ */
+#ifndef POLLRDHUP
+#define POLLRDHUP 0x2000
+#endif
+#ifndef EPOLLRDHUP
+#define EPOLLRDHUP 0x2000
+#endif
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+const uint32_t SharedMemoryStream::RING_SIZE;
+
+/*
+ * Each ring is preceded by a page holding its control block
+ */
+static const uint32_t CTRL_SIZE = 4096;
+
+/*
+ * Total size of the shared memory, the client to daemon ring followed by the daemon to client ring
+ */
+static const size_t SHM_SIZE = 2 * (CTRL_SIZE + SharedMemoryStream::RING_SIZE);
+
+static const uint32_t RING_MASK = SharedMemoryStream::RING_SIZE - 1;
+
+/*
+ * Sent by the client to tell the daemon what to expect, zero means carry on using the socket
+ */
+static const uint8_t SHM_VERSION = 1;
+
+/*
+ * The shared memory followed by the data and space eventfds for each ring
+ */
+static const size_t NUM_SHM_FDS = 5;
+
+/*
+ * Bounds for the adaptive spin limit
+ */
+static const uint32_t MIN_SPIN = 16;
+static const uint32_t MAX_SPIN = 4096;
+
+/*
+ * The indices are on separate cache lines from each other and from the wakeup flags so the
+ * producer and consumer don't keep stealing the same line from each other.
+ */
+struct SharedMemoryStream::RingControl {
+    volatile uint32_t head;              /**< Written by the producer */
+    uint8_t pad0[60];
+    volatile uint32_t tail;              /**< Written by the consumer */
+    uint8_t pad1[60];
+    volatile uint32_t consumerWaiting;   /**< Set by the consumer before it sleeps, cleared by the producer */
+    uint8_t pad2[60];
+    volatile uint32_t producerWaiting;   /**< Set by the producer before it sleeps, cleared by the consumer */
+};
+
+static inline void CpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__ ("pause" ::: "memory");
+#else
+    __asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+static inline void SignalEventFd(int fd)
+{
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) != sizeof(one)) {
+        QCC_DbgHLPrintf(("SharedMemoryStream eventfd write failed: %s", strerror(errno)));
+    }
+}
+
+static inline void ResetEventFd(int fd)
+{
+    uint64_t val;
+    /* The eventfd is non-blocking so this just fails if it wasn't signalled */
+    if (read(fd, &val, sizeof(val)) < 0) {
+        return;
+    }
+}
+
+/*
+ * An epoll fd that is readable when the eventfd is signalled or the other side of the socket has gone away.
+ */
+static int CreateWaitFd(int eventFd, SocketFd sock)
+{
+    int epollFd = epoll_create(2);
+    if (epollFd < 0) {
+        return -1;
+    }
+    fcntl(epollFd, F_SETFD, FD_CLOEXEC);
+    struct epoll_event ev;
+    ::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = eventFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &ev) == 0) {
+        /* Only hangups, descriptors waiting to be read on the socket must not wake us up */
+        ev.events = EPOLLRDHUP;
+        ev.data.fd = sock;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, sock, &ev) == 0) {
+            return epollFd;
+        }
+    }
+    close(epollFd);
+    return -1;
+}
+
+/*
+ * Check that a descriptor from the client is an eventfd. Anything else, a pipe or a socket for
+ * example, could block the endpoint threads when they signal or reset it.
+ */
+static bool IsEventFd(int fd)
+{
+    char path[32];
+    char target[32];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    ssize_t len = readlink(path, target, sizeof(target) - 1);
+    if (len < 0) {
+        return false;
+    }
+    target[len] = '\0';
+    return strcmp(target, "anon_inode:[eventfd]") == 0;
+}
+
+static void CloseFds(int* fds, size_t numFds)
+{
+    for (size_t i = 0; i < numFds; ++i) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+bool SharedMemoryStream::IsSupported()
+{
+#if defined(__NR_memfd_create)
+    return true;
+#else
+    return false;
+#endif
+}
+
+SharedMemoryStream::SharedMemoryStream(SocketFd sock, int memFd, uint8_t* mem, int* eventFds, bool isClient) :
+    sock(sock),
+    memFd(memFd),
+    mem(mem),
+    sourceFd(-1),
+    sinkFd(-1),
+    sourceEvent(&Event::neverSet),
+    sinkEvent(&Event::alwaysSet),
+    sendTimeout(Event::WAIT_FOREVER),
+    maxSpin((sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MAX_SPIN : 0)
+{
+    Ring* toDaemon = isClient ? &txRing : &rxRing;
+    Ring* toClient = isClient ? &rxRing : &txRing;
+
+    toDaemon->ctrl = reinterpret_cast<RingControl*>(mem);
+    toDaemon->data = mem + CTRL_SIZE;
+    toDaemon->dataFd = eventFds[0];
+    toDaemon->spaceFd = eventFds[1];
+
+    toClient->ctrl = reinterpret_cast<RingControl*>(mem + CTRL_SIZE + RING_SIZE);
+    toClient->data = mem + 2 * CTRL_SIZE + RING_SIZE;
+    toClient->dataFd = eventFds[2];
+    toClient->spaceFd = eventFds[3];
+
+    rxRing.pos = 0;
+    txRing.pos = 0;
+    /* There is no point spinning on a single core, the other side can't run while we spin */
+    rxRing.spinLimit = maxSpin ? MIN_SPIN : 0;
+    txRing.spinLimit = maxSpin ? MIN_SPIN : 0;
+}
+
+SharedMemoryStream::~SharedMemoryStream()
+{
+    if (sourceEvent != &Event::neverSet) {
+        delete sourceEvent;
+        sourceEvent = &Event::neverSet;
+    }
+    if (sinkEvent != &Event::alwaysSet) {
+        delete sinkEvent;
+        sinkEvent = &Event::alwaysSet;
+    }
+    int fds[] = { sourceFd, sinkFd, rxRing.dataFd, rxRing.spaceFd, txRing.dataFd, txRing.spaceFd, memFd };
+    CloseFds(fds, ArraySize(fds));
+    munmap(mem, SHM_SIZE);
+}
+
+QStatus SharedMemoryStream::Init()
+{
+    sourceFd = CreateWaitFd(rxRing.dataFd, sock);
+    sinkFd = CreateWaitFd(txRing.spaceFd, sock);
+    if ((sourceFd < 0) || (sinkFd < 0)) {
+        QCC_LogError(ER_OS_ERROR, ("SharedMemoryStream epoll setup failed: %s", strerror(errno)));
+        return ER_OS_ERROR;
+    }
+    sourceEvent = new Event(sourceFd, Event::IO_READ, false);
+    sinkEvent = new Event(sinkFd, Event::IO_READ, false);
+    return ER_OK;
+}
+
+QStatus SharedMemoryStream::Connect(SocketFd sock, SharedMemoryStream*& shmStream)
+{
+    QStatus status = ER_OK;
+    int fds[NUM_SHM_FDS];
+    uint8_t* mem = NULL;
+
+    shmStream = NULL;
+    for (size_t i = 0; i < NUM_SHM_FDS; ++i) {
+        fds[i] = -1;
+    }
+#if defined(__NR_memfd_create)
+    /*
+     * The memory is sealed so the daemon can be sure it won't be truncated under its feet
+     */
+    fds[0] = syscall(__NR_memfd_create, "alljoyn-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if ((fds[0] < 0) || (ftruncate(fds[0], SHM_SIZE) != 0) ||
+        (fcntl(fds[0], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)) {
+        status = ER_OS_ERROR;
+    }
+#else
+    status = ER_NOT_IMPLEMENTED;
+#endif
+    if (status == ER_OK) {
+        void* addr = mmap(NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+        if (addr == MAP_FAILED) {
+            status = ER_OS_ERROR;
+        } else {
+            mem = reinterpret_cast<uint8_t*>(addr);
+        }
+    }
+    for (size_t i = 1; (status == ER_OK) && (i < NUM_SHM_FDS); ++i) {
+        fds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fds[i] < 0) {
+            status = ER_OS_ERROR;
+        }
+    }
+    if (status == ER_OK) {
+        shmStream = new SharedMemoryStream(sock, fds[0], mem, &fds[1], true);
+        /*
+         * The RX threads on both sides start out waiting on the source event so the first message
+         * in each direction must signal.
+         */
+        shmStream->rxRing.ctrl->consumerWaiting = 1;
+        shmStream->txRing.ctrl->consumerWaiting = 1;
+        status = shmStream->Init();
+    } else {
+        QCC_LogError(status, ("SharedMemoryStream could not create shared memory: %s", strerror(errno)));
+    }
+
+    /*
+     * Let the daemon know if it should switch over
+     */
+    uint8_t version = (status == ER_OK) ? SHM_VERSION : 0;
+    size_t sent = 0;
+    QStatus sendStatus;
+    if (status == ER_OK) {
+        sendStatus = SendWithFds(sock, &version, sizeof(version), sent, fds, NUM_SHM_FDS, GetPid());
+    } else {
+        sendStatus = Send(sock, &version, sizeof(version), sent);
+    }
+    if ((sendStatus == ER_OK) && (sent != sizeof(version))) {
+        sendStatus = ER_WRITE_ERROR;
+    }
+    if (status == ER_OK) {
+        status = sendStatus;
+    }
+
+    if (status != ER_OK) {
+        if (shmStream) {
+            delete shmStream;
+            shmStream = NULL;
+        } else {
+            if (mem) {
+                munmap(mem, SHM_SIZE);
+            }
+            CloseFds(fds, NUM_SHM_FDS);
+        }
+    }
+    return status;
+}
+
+QStatus SharedMemoryStream::Accept(SocketFd sock, uint32_t timeout, SharedMemoryStream*& shmStream)
+{
+    QStatus status;
+    uint8_t version = 0;
+    SocketFd fds[NUM_SHM_FDS];
+    size_t numFds = 0;
+    size_t recvd = 0;
+    uint8_t* mem = NULL;
+
+    shmStream = NULL;
+    while (true) {
+        status = RecvWithFds(sock, &version, sizeof(version), recvd, fds, NUM_SHM_FDS, numFds);
+        if (status == ER_WOULDBLOCK) {
+            qcc::Event event(sock, qcc::Event::IO_READ, false);
+            status = Event::Wait(event, timeout);
+            if (status == ER_OK) {
+                continue;
+            }
+            QCC_LogError(status, ("SharedMemoryStream timed out waiting for client"));
+        }
+        break;
+    }
+    if ((status == ER_OK) && (recvd != sizeof(version))) {
+        status = ER_SOCK_OTHER_END_CLOSED;
+    }
+    if (status != ER_OK) {
+        CloseFds(fds, numFds);
+        return status;
+    }
+    /*
+     * The client could not set up shared memory
+     */
+    if ((version == 0) && (numFds == 0)) {
+        QCC_DbgHLPrintf(("SharedMemoryStream declined by client"));
+        return ER_OK;
+    }
+    if ((version != SHM_VERSION) || (numFds != NUM_SHM_FDS)) {
+        status = ER_BUS_ESTABLISH_FAILED;
+        QCC_LogError(status, ("SharedMemoryStream unexpected version %u with %u fds", version, (uint32_t)numFds));
+    }
+    /*
+     * Don't trust the client, the memory must be the right size and must not be able to shrink
+     */
+    if (status == ER_OK) {
+        struct stat st;
+        int seals = fcntl(fds[0], F_GET_SEALS);
+        if ((fstat(fds[0], &st) != 0) || (st.st_size != (off_t)SHM_SIZE) || (seals < 0) || !(seals & F_SEAL_SHRINK)) {
+            status = ER_BUS_ESTABLISH_FAILED;
+            QCC_LogError(status, ("SharedMemoryStream shared memory from client is not usable"));
+        }
+    }
+    /*
+     * Nor the eventfds, the client created them non-blocking but it could have cleared the flag
+     * since so set it again.
+     */
+    for (size_t i = 1; (status == ER_OK) && (i < NUM_SHM_FDS); ++i) {
+        int flags = fcntl(fds[i], F_GETFL);
+        if (!IsEventFd(fds[i]) || (flags < 0) || (fcntl(fds[i], F_SETFL, flags | O_NONBLOCK) != 0)) {
+            status = ER_BUS_ESTABLISH_FAILED;
+            QCC_LogError(status, ("SharedMemoryStream wakeup descriptor %u from client is not an eventfd", (uint32_t)i));
+        } else {
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    if (status == ER_OK) {
+        void* addr = mmap(NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+        if (addr == MAP_FAILED) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("SharedMemoryStream mmap failed: %s", strerror(errno)));
+        } else {
+            mem = reinterpret_cast<uint8_t*>(addr);
+        }
+    }
+    if (status == ER_OK) {
+        shmStream = new SharedMemoryStream(sock, fds[0], mem, &fds[1], false);
+        status = shmStream->Init();
+        if (status != ER_OK) {
+            delete shmStream;
+            shmStream = NULL;
+        }
+    } else {
+        if (mem) {
+            munmap(mem, SHM_SIZE);
+        }
+        CloseFds(fds, numFds);
+    }
+    return status;
+}
+
+bool SharedMemoryStream::PeerClosed()
+{
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLRDHUP;
+    pfd.revents = 0;
+    return (poll(&pfd, 1, 0) > 0) && (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR));
+}
+
+/*
+ * Wait until the consumer has data to read or the producer has space to write.
+ *
+ * Before sleeping the waiter resets its eventfd, sets its waiting flag and looks at the ring once more.
+ * The other side publishes its index before it looks at the flag so one of the two is certain to see
+ * the other. If the last look finds the ring is ready the eventfd is set again so the source event
+ * always reflects data left in the ring.
+ */
+QStatus SharedMemoryStream::WaitRing(Ring& ring, bool isConsumer, uint32_t timeout, uint32_t& avail)
+{
+    RingControl* ctrl = ring.ctrl;
+    volatile uint32_t* waiting = isConsumer ? &ctrl->consumerWaiting : &ctrl->producerWaiting;
+    int eventFd = isConsumer ? ring.dataFd : ring.spaceFd;
+    qcc::Event& event = isConsumer ? *sourceEvent : *sinkEvent;
+    uint32_t startTime = GetTimestamp();
+    uint32_t spins = 0;
+    bool slept = false;
+
+    while (true) {
+        uint32_t used = isConsumer ? (ctrl->head - ring.pos) : (ring.pos - ctrl->tail);
+        if (used > RING_SIZE) {
+            QCC_LogError(ER_BUS_BAD_LENGTH, ("SharedMemoryStream ring indices are corrupt"));
+            return ER_BUS_BAD_LENGTH;
+        }
+        avail = isConsumer ? used : (RING_SIZE - used);
+        if (avail) {
+            if (!slept && spins && (ring.spinLimit < maxSpin)) {
+                ring.spinLimit <<= 1;
+            }
+            /* Don't touch the ring until the index has been read */
+            __sync_synchronize();
+            return ER_OK;
+        }
+        if (!slept && (spins < ring.spinLimit)) {
+            ++spins;
+            CpuRelax();
+            continue;
+        }
+        ResetEventFd(eventFd);
+        *waiting = 1;
+        __sync_synchronize();
+        uint32_t ready = isConsumer ? (ctrl->head - ring.pos) : (RING_SIZE - (ring.pos - ctrl->tail));
+        if (ready) {
+            SignalEventFd(eventFd);
+            continue;
+        }
+        if (PeerClosed()) {
+            return ER_SOCK_OTHER_END_CLOSED;
+        }
+        if (!slept && (ring.spinLimit > MIN_SPIN)) {
+            ring.spinLimit >>= 1;
+        }
+        uint32_t waitMs = Event::WAIT_FOREVER;
+        if (timeout != Event::WAIT_FOREVER) {
+            uint32_t elapsed = GetTimestamp() - startTime;
+            if (elapsed >= timeout) {
+                return ER_TIMEOUT;
+            }
+            waitMs = timeout - elapsed;
+        }
+        QStatus status = Event::Wait(event, waitMs);
+        if (status != ER_OK) {
+            return status;
+        }
+        slept = true;
+    }
+}
+
+size_t SharedMemoryStream::ReadRing(void* buf, size_t reqBytes, uint32_t avail)
+{
+    size_t len = (std::min)(reqBytes, (size_t)avail);
+    uint32_t idx = rxRing.pos & RING_MASK;
+    size_t first = (std::min)(len, (size_t)(RING_SIZE - idx));
+    ::memcpy(buf, rxRing.data + idx, first);
+    ::memcpy((uint8_t*)buf + first, rxRing.data, len - first);
+    rxRing.pos += len;
+    /* Finish reading before handing the space back to the producer */
+    __sync_synchronize();
+    rxRing.ctrl->tail = rxRing.pos;
+    __sync_synchronize();
+    if (rxRing.ctrl->producerWaiting && __sync_bool_compare_and_swap(&rxRing.ctrl->producerWaiting, 1, 0)) {
+        SignalEventFd(rxRing.spaceFd);
+    }
+    return len;
+}
+
+size_t SharedMemoryStream::WriteRing(const void* buf, size_t numBytes, uint32_t avail)
+{
+    size_t len = (std::min)(numBytes, (size_t)avail);
+    uint32_t idx = txRing.pos & RING_MASK;
+    size_t first = (std::min)(len, (size_t)(RING_SIZE - idx));
+    ::memcpy(txRing.data + idx, buf, first);
+    ::memcpy(txRing.data, (const uint8_t*)buf + first, len - first);
+    txRing.pos += len;
+    /* Finish writing before publishing the data to the consumer */
+    __sync_synchronize();
+    txRing.ctrl->head = txRing.pos;
+    __sync_synchronize();
+    if (txRing.ctrl->consumerWaiting && __sync_bool_compare_and_swap(&txRing.ctrl->consumerWaiting, 1, 0)) {
+        SignalEventFd(txRing.dataFd);
+    }
+    return len;
+}
+
+QStatus SharedMemoryStream::PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout)
+{
+    actualBytes = 0;
+    if (reqBytes == 0) {
+        return ER_OK;
+    }
+    uint32_t avail;
+    QStatus status = WaitRing(rxRing, true, timeout, avail);
+    if (status == ER_OK) {
+        actualBytes = ReadRing(buf, reqBytes, avail);
+    }
+    return status;
+}
+
+QStatus SharedMemoryStream::PullBytesAndFds(void* buf, size_t reqBytes, size_t& actualBytes, SocketFd* fdList, size_t& numFds, uint32_t timeout)
+{
+    size_t maxFds = numFds;
+    uint32_t avail;
+
+    actualBytes = 0;
+    numFds = 0;
+    QStatus status = WaitRing(rxRing, true, timeout, avail);
+    /*
+     * Descriptors are sent before the bytes they go with so if there are any for the current position
+     * they are already waiting on the socket.
+     */
+    while (status == ER_OK) {
+        uint32_t tag;
+        ssize_t ret = recv(sock, &tag, sizeof(tag), MSG_PEEK | MSG_DONTWAIT);
+        if ((ret != sizeof(tag)) || ((int32_t)(tag - rxRing.pos) > 0)) {
+            break;
+        }
+        size_t recvd;
+        size_t n = 0;
+        status = RecvWithFds(sock, &tag, sizeof(tag), recvd, fdList, maxFds, n);
+        if (status != ER_OK) {
+            break;
+        }
+        if (tag == rxRing.pos) {
+            numFds = n;
+            break;
+        }
+        /* Stale descriptors for bytes that have already been read */
+        CloseFds(fdList, n);
+    }
+    if (status == ER_OK) {
+        actualBytes = ReadRing(buf, reqBytes, avail);
+    }
+    return status;
+}
+
+QStatus SharedMemoryStream::PushBytes(const void* buf, size_t numBytes, size_t& numSent)
+{
+    numSent = 0;
+    if (numBytes == 0) {
+        return ER_OK;
+    }
+    uint32_t avail;
+    QStatus status = WaitRing(txRing, false, sendTimeout, avail);
+    if (status == ER_OK) {
+        numSent = WriteRing(buf, numBytes, avail);
+    }
+    return status;
+}
+
+QStatus SharedMemoryStream::PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, SocketFd* fdList, size_t numFds, uint32_t pid)
+{
+    if (numBytes == 0) {
+        return ER_BAD_ARG_2;
+    }
+    if (numFds == 0) {
+        return ER_BAD_ARG_5;
+    }
+    /*
+     * Tag the descriptors with the ring position the bytes are going to be written at
+     */
+    uint32_t tag = txRing.pos;
+    size_t sent = 0;
+    QStatus status;
+    while (true) {
+        status = SendWithFds(sock, &tag, sizeof(tag), sent, fdList, numFds, pid);
+        if (status == ER_WOULDBLOCK) {
+            qcc::Event event(sock, qcc::Event::IO_WRITE, false);
+            status = Event::Wait(event, sendTimeout);
+            if (status == ER_OK) {
+                continue;
+            }
+        }
+        break;
+    }
+    if ((status == ER_OK) && (sent != sizeof(tag))) {
+        status = ER_WRITE_ERROR;
+    }
+    if (status == ER_OK) {
+        status = PushBytes(buf, numBytes, numSent);
+    } else {
+        QCC_LogError(status, ("SharedMemoryStream failed to send handles"));
+    }
+    return status;
+}
+
+}
@@ -0,0 +1,266 @@
+/**
+ * @file
+ *
+ * Benchmark comparing the compiled marshal plans and typed args against the interpreting marshaler
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArgCodec.h>
+#include <alljoyn/version.h>
+
+#include <Status.h>
+
+/* Private files included for benchmarking */
+#include <MarshalPlan.h>
+#include <RemoteEndpoint.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static BusAttachment* gBus;
+
+class BenchMessage : public _Message {
+  public:
+
+    BenchMessage() : _Message(*gBus) { };
+
+    QStatus Signal(const MsgArg* argList, size_t numArgs)
+    {
+        qcc::String sig = MsgArg::Signature(argList, numArgs);
+        return SignalMsg(sig, NULL, 0, "/bench", "org.alljoyn.bench", "Bench", argList, numArgs, 0, 0);
+    }
+
+    QStatus Signal(const TypedMsgArgs& typedArgs)
+    {
+        return SignalMsg(typedArgs.GetSignature(), NULL, 0, "/bench", "org.alljoyn.bench", "Bench", NULL, 0, 0, 0, &typedArgs);
+    }
+
+    QStatus UnmarshalBody() { return UnmarshalArgs("*"); }
+
+    QStatus Unmarshal(RemoteEndpoint& ep) { return _Message::Unmarshal(ep, true); }
+
+    QStatus Deliver(RemoteEndpoint& ep) { return _Message::Deliver(ep); }
+};
+
+struct Timing {
+    uint32_t marshal;
+    uint32_t unmarshal;
+};
+
+/*
+ * Time marshaling and unmarshaling an arg list or typed args. Unmarshaling includes reading the
+ * message from the pipe so both are measured against the same baseline.
+ */
+static QStatus TimeArgs(const MsgArg* argList, size_t numArgs, const TypedMsgArgs* typedArgs, uint32_t iterations, Timing& timing)
+{
+    QStatus status = ER_OK;
+    Pipe stream;
+    RemoteEndpoint ep(*gBus, false, "", &stream, "bench", false);
+
+    timing.marshal = 0;
+    timing.unmarshal = 0;
+    for (uint32_t i = 0; (status == ER_OK) && (i < iterations); ++i) {
+        BenchMessage msg;
+        uint32_t start = GetTimestamp();
+        status = typedArgs ? msg.Signal(*typedArgs) : msg.Signal(argList, numArgs);
+        timing.marshal += GetTimestamp() - start;
+        if (status == ER_OK) {
+            status = msg.Deliver(ep);
+        }
+        if (status == ER_OK) {
+            BenchMessage rcv;
+            start = GetTimestamp();
+            status = rcv.Unmarshal(ep);
+            if (status == ER_OK) {
+                status = rcv.UnmarshalBody();
+            }
+            timing.unmarshal += GetTimestamp() - start;
+        }
+    }
+    return status;
+}
+
+static void usage(void)
+{
+    printf("Usage: marshalbench [-n <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h              = Print this help message\n");
+    printf("   -n <iterations> = Number of times each arg list is marshaled (default 10000)\n");
+}
+
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t iterations = 10000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    /* Parse command line args */
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-n", argv[i])) {
+            ++i;
+            if (i == argc) {
+                printf("option %s requires a parameter\n", argv[i - 1]);
+                usage();
+                exit(1);
+            }
+            iterations = StringToU32(argv[i], 10, 0);
+            if (iterations == 0) {
+                printf("invalid iteration count %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    gBus = new BusAttachment("marshalbench");
+    gBus->Start();
+
+    /*
+     * Arg lists with the signatures that show up most often on a bus
+     */
+    int32_t ints[64];
+    for (size_t i = 0; i < ArraySize(ints); ++i) {
+        ints[i] = (int32_t)i;
+    }
+    const char* strs[] = { "org.alljoyn.Bus", "org.freedesktop.DBus", "org.alljoyn.About", "org.alljoyn.Bench" };
+
+    MsgArg s("s", "org.alljoyn.bench.SomeName");
+
+    MsgArg us[2];
+    us[0].Set("u", 42);
+    us[1].Set("s", ":1.42");
+
+    MsgArg iiii("(iiii)", 1, 2, 3, 4);
+
+    MsgArg ai("ai", ArraySize(ints), ints);
+
+    MsgArg as("as", ArraySize(strs), strs);
+
+    MsgArg structs[16];
+    for (size_t i = 0; i < ArraySize(structs); ++i) {
+        structs[i].Set("(iyd)", (int32_t)i, (uint8_t)i, 1.5 * i);
+    }
+    MsgArg aiyd("a(iyd)", ArraySize(structs), structs);
+
+    MsgArg vals[4];
+    MsgArg entries[4];
+    vals[0].Set("u", 1);
+    vals[1].Set("s", "bench");
+    vals[2].Set("b", true);
+    vals[3].Set("ai", 8, ints);
+    for (size_t i = 0; i < ArraySize(entries); ++i) {
+        entries[i].Set("{sv}", strs[i], &vals[i]);
+    }
+    MsgArg asv("a{sv}", ArraySize(entries), entries);
+
+    /*
+     * The same values as typed args. Variants have no typed equivalent.
+     */
+    qcc::String sVal("org.alljoyn.bench.SomeName");
+    uint32_t uVal = 42;
+    qcc::String nameVal(":1.42");
+    MsgArgTuple<int32_t, int32_t, int32_t, int32_t> iiiiVal(1, 2, 3, 4);
+    std::vector<int32_t> aiVal(ints, ints + ArraySize(ints));
+    std::vector<qcc::String> asVal(strs, strs + ArraySize(strs));
+    std::vector<MsgArgTuple<int32_t, uint8_t, double> > aiydVal;
+    for (size_t i = 0; i < ArraySize(structs); ++i) {
+        aiydVal.push_back(MsgArgTuple<int32_t, uint8_t, double>((int32_t)i, (uint8_t)i, 1.5 * i));
+    }
+    TypedMsgArgList<qcc::String> sTyped = MakeArgs(sVal);
+    TypedMsgArgList<uint32_t, qcc::String> usTyped = MakeArgs(uVal, nameVal);
+    TypedMsgArgList<MsgArgTuple<int32_t, int32_t, int32_t, int32_t> > iiiiTyped = MakeArgs(iiiiVal);
+    TypedMsgArgList<std::vector<int32_t> > aiTyped = MakeArgs(aiVal);
+    TypedMsgArgList<std::vector<qcc::String> > asTyped = MakeArgs(asVal);
+    TypedMsgArgList<std::vector<MsgArgTuple<int32_t, uint8_t, double> > > aiydTyped = MakeArgs(aiydVal);
+
+    struct {
+        const char* name;
+        const MsgArg* args;
+        size_t numArgs;
+        const TypedMsgArgs* typedArgs;
+    } cases[] = {
+        { "s",      &s,    1, &sTyped },
+        { "us",     us,    2, &usTyped },
+        { "(iiii)", &iiii, 1, &iiiiTyped },
+        { "ai",     &ai,   1, &aiTyped },
+        { "as",     &as,   1, &asTyped },
+        { "a(iyd)", &aiyd, 1, &aiydTyped },
+        { "a{sv}",  &asv,  1, NULL }
+    };
+
+    printf("%u iterations, times in ms\n", iterations);
+    printf("%-10s %10s %10s %10s %10s %10s %8s\n", "signature", "marshal", "planned", "typed", "unmarshal", "planned", "speedup");
+    for (size_t i = 0; (status == ER_OK) && (i < ArraySize(cases)); ++i) {
+        Timing interp;
+        Timing planned;
+        Timing typed;
+        MarshalPlan::Enable(false);
+        status = TimeArgs(cases[i].args, cases[i].numArgs, NULL, iterations, interp);
+        MarshalPlan::Enable(true);
+        if (status == ER_OK) {
+            status = TimeArgs(cases[i].args, cases[i].numArgs, NULL, iterations, planned);
+        }
+        typed.marshal = 0;
+        if ((status == ER_OK) && cases[i].typedArgs) {
+            status = TimeArgs(NULL, 0, cases[i].typedArgs, iterations, typed);
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Benchmark of \"%s\" failed", cases[i].name));
+            break;
+        }
+        uint32_t before = interp.marshal + interp.unmarshal;
+        uint32_t after = planned.marshal + planned.unmarshal;
+        printf("%-10s %10u %10u %10s %10u %10u %7.2fx\n", cases[i].name,
+               interp.marshal, planned.marshal, cases[i].typedArgs ? U32ToString(typed.marshal).c_str() : "-",
+               interp.unmarshal, planned.unmarshal, after ? (double)before / after : 0.0);
+    }
+
+    delete gBus;
+
+    printf("\n %s\n", (status == ER_OK) ? "PASSED" : "FAILED");
+
+    return (int) status;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file
+ *
+ * Benchmark reporting the resident memory of the daemon for each connected client
+ */
+
+/******************************************************************************
+ *
+ *
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/version.h>
+
+#include <Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+/*
+ * Find the pid of the first process named alljoyn-daemon.
+ */
+static uint32_t FindDaemonPid()
+{
+    uint32_t pid = 0;
+    DIR* dir = opendir("/proc");
+    if (dir) {
+        struct dirent* entry;
+        while (!pid && ((entry = readdir(dir)) != NULL)) {
+            uint32_t p = StringToU32(entry->d_name, 10, 0);
+            if (p) {
+                char comm[64] = { 0 };
+                qcc::String path = qcc::String("/proc/") + entry->d_name + "/comm";
+                FILE* f = fopen(path.c_str(), "r");
+                if (f) {
+                    if (fgets(comm, sizeof(comm), f) && (strncmp(comm, "alljoyn-daemon", 14) == 0)) {
+                        pid = p;
+                    }
+                    fclose(f);
+                }
+            }
+        }
+        closedir(dir);
+    }
+    return pid;
+}
+
+/*
+ * Get the resident set size of a process in bytes or 0 if it cannot be read.
+ */
+static uint64_t GetRss(uint32_t pid)
+{
+    uint64_t rss = 0;
+    char line[128];
+    qcc::String path = "/proc/" + U32ToString(pid) + "/status";
+    FILE* f = fopen(path.c_str(), "r");
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "VmRSS:", 6) == 0) {
+                rss = 1024 * (uint64_t)strtoul(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(f);
+    }
+    return rss;
+}
+
+static void usage(void)
+{
+    printf("Usage: rssbench [-h] [-p <pid>] [-n <clients>] [-s <step>] [-d <ms>] [-r]\n\n");
+    printf("Options:\n");
+    printf("   -h           = Print this help message\n");
+    printf("   -p <pid>     = Process id of the daemon (default is to look for alljoyn-daemon)\n");
+    printf("   -n <clients> = Number of clients to connect (default 100)\n");
+    printf("   -s <step>    = Number of clients to connect between measurements (default 10)\n");
+    printf("   -d <ms>      = Number of ms to let the daemon settle before each measurement (default 500)\n");
+    printf("   -r           = Each client also requests a well-known name\n");
+    printf("\n");
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t pid = 0;
+    uint32_t numClients = 100;
+    uint32_t step = 10;
+    uint32_t settleMs = 500;
+    bool requestName = false;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    /* Install SIGINT handler */
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-p", argv[i])) || (0 == strcmp("-n", argv[i])) ||
+                   (0 == strcmp("-s", argv[i])) || (0 == strcmp("-d", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            uint32_t val = StringToU32(argv[i + 1], 0, 0);
+            switch (argv[i][1]) {
+            case 'p':
+                pid = val;
+                break;
+
+            case 'n':
+                numClients = val;
+                break;
+
+            case 's':
+                step = val ? val : 1;
+                break;
+
+            case 'd':
+                settleMs = val;
+                break;
+            }
+            ++i;
+        } else if (0 == strcmp("-r", argv[i])) {
+            requestName = true;
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    if (!pid) {
+        pid = FindDaemonPid();
+    }
+    uint64_t baseRss = GetRss(pid);
+    if (!baseRss) {
+        printf("Cannot read the resident memory of the daemon, use -p to give its process id\n");
+        exit(1);
+    }
+
+    /* Get env vars */
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String clientArgs = env->Find("BUS_ADDRESS", "unix:abstract=alljoyn");
+
+    printf("%10s %12s %14s\n", "clients", "rss (kB)", "bytes/client");
+    printf("%10u %12u %14s\n", 0, (uint32_t)(baseRss / 1024), "-");
+
+    vector<BusAttachment*> clients;
+    while (!g_interrupt && (status == ER_OK) && (clients.size() < numClients)) {
+        for (uint32_t n = 0; (status == ER_OK) && (n < step) && (clients.size() < numClients); ++n) {
+            BusAttachment* bus = new BusAttachment("rssbench", false);
+            clients.push_back(bus);
+            status = bus->Start();
+            if (status == ER_OK) {
+                status = bus->Connect(clientArgs.c_str());
+            }
+            if ((status == ER_OK) && requestName) {
+                qcc::String name = "org.alljoyn.rssbench.c" + U32ToString((uint32_t)clients.size());
+                status = bus->RequestName(name.c_str(), DBUS_NAME_FLAG_DO_NOT_QUEUE);
+            }
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Failed to connect client %u", (uint32_t)clients.size()));
+            }
+        }
+        if (status == ER_OK) {
+            qcc::Sleep(settleMs);
+            uint64_t rss = GetRss(pid);
+            int64_t perClient = ((int64_t)rss - (int64_t)baseRss) / (int64_t)clients.size();
+            printf("%10u %12u %14d\n", (uint32_t)clients.size(), (uint32_t)(rss / 1024), (int32_t)perClient);
+        }
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        delete clients[i];
+    }
+
+    printf("rssbench exiting with status %d (%s)\n", status, QCC_StatusText(status));
+    return (int) status;
+}
@@ -188,3 +188,32 @@ TEST(CompressionTest, Compression) {
         ASSERT_EQ(sig, msg2.GetMemberName()) << "FAILD 6." << 1;
     }
 }
+
+TEST(CompressionTest, Dictionary) {
+    CompressionDictionary dict(4);
+
+    /* A token is unknown the first time it is used on a connection */
+    ASSERT_FALSE(dict.CheckAndAddToken(1));
+    ASSERT_TRUE(dict.CheckAndAddToken(1));
+
+    for (uint32_t tok = 2; tok <= 4; ++tok) {
+        ASSERT_FALSE(dict.CheckAndAddToken(tok));
+    }
+    /* Touch token 1 so token 2 is the least recently used */
+    ASSERT_TRUE(dict.CheckAndAddToken(1));
+    ASSERT_FALSE(dict.CheckAndAddToken(5));
+    ASSERT_TRUE(dict.CheckAndAddToken(1));
+    ASSERT_FALSE(dict.CheckAndAddToken(2)) << "Expected least recently used token to be evicted";
+
+    HeaderFields hdr1;
+    HeaderFields hdr2;
+    hdr1.field[ALLJOYN_HDR_FIELD_PATH].Set("o", "/foo/bar");
+    hdr1.field[ALLJOYN_HDR_FIELD_MEMBER].Set("s", "test");
+    hdr2.field[ALLJOYN_HDR_FIELD_PATH].Set("o", "/foo/bar");
+    hdr2.field[ALLJOYN_HDR_FIELD_MEMBER].Set("s", "other");
+
+    ASSERT_FALSE(dict.IsRepeatedHeader(hdr1));
+    ASSERT_TRUE(dict.IsRepeatedHeader(hdr1));
+    ASSERT_FALSE(dict.IsRepeatedHeader(hdr2));
+    ASSERT_TRUE(dict.IsRepeatedHeader(hdr1));
+}
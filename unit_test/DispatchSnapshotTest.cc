@@ -0,0 +1,241 @@
+/**
+ * @file
+ *
+ * This file tests the lock-free dispatch snapshots and the method table index built on them
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/InterfaceDescription.h>
+
+#include <Status.h>
+
+/* Private files included for unit testing */
+#include <DispatchSnapshot.h>
+#include <MethodTable.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+/* Index type that counts how many instances are alive */
+struct CountedIndex {
+    CountedIndex(int value) : value(value) { ++live; }
+    ~CountedIndex() { --live; }
+    int value;
+    static int live;
+};
+
+int CountedIndex::live = 0;
+
+TEST(DispatchSnapshotTest, PublishAndRead) {
+    {
+        DispatchSnapshot<CountedIndex> snapshot;
+        EXPECT_TRUE(snapshot.BeginRead() == NULL);
+        snapshot.EndRead();
+
+        snapshot.Publish(new CountedIndex(1));
+        snapshot.Publish(new CountedIndex(2));
+        /* With no readers the replaced index is deleted straight away */
+        EXPECT_EQ(1, CountedIndex::live);
+        const CountedIndex* index = snapshot.BeginRead();
+        ASSERT_TRUE(index != NULL);
+        EXPECT_EQ(2, index->value);
+        snapshot.EndRead();
+    }
+    EXPECT_EQ(0, CountedIndex::live);
+}
+
+TEST(DispatchSnapshotTest, ReclaimWhileReading) {
+    {
+        DispatchSnapshot<CountedIndex> snapshot;
+        snapshot.Publish(new CountedIndex(1));
+
+        const CountedIndex* reading = snapshot.BeginRead();
+        ASSERT_TRUE(reading != NULL);
+        snapshot.Publish(new CountedIndex(2));
+        snapshot.Publish(new CountedIndex(3));
+        /* The index being read and the one replaced after it must survive until the read ends */
+        EXPECT_EQ(3, CountedIndex::live);
+        EXPECT_EQ(1, reading->value);
+
+        /* A new reader sees the latest index */
+        const CountedIndex* latest = snapshot.BeginRead();
+        EXPECT_EQ(3, latest->value);
+        snapshot.EndRead();
+        snapshot.EndRead();
+
+        /* The next publish with no readers reclaims everything retired */
+        snapshot.Publish(new CountedIndex(4));
+        EXPECT_EQ(1, CountedIndex::live);
+    }
+    EXPECT_EQ(0, CountedIndex::live);
+}
+
+class MethodTableObject : public BusObject {
+  public:
+    MethodTableObject(BusAttachment& bus, const char* path) : BusObject(bus, path) { }
+
+    void Handler1(const InterfaceDescription::Member* member, Message& msg) { }
+    void Handler2(const InterfaceDescription::Member* member, Message& msg) { }
+};
+
+/* Must match MethodTable::Hash so tests can choose which keys collide */
+static size_t KeyHash(const char* objPath, const char* iface, const char* methodName)
+{
+    size_t hash = 37;
+    for (const char* p = methodName; *p; ++p) {
+        hash = *p + hash * 11;
+    }
+    for (const char* p = objPath; *p; ++p) {
+        hash = *p + hash * 5;
+    }
+    if (iface) {
+        for (const char* p = iface; *p; ++p) {
+            hash += *p * 7;
+        }
+    }
+    return hash;
+}
+
+class MethodTableTest : public testing::Test {
+  public:
+    MethodTableTest() : bus("MethodTableTest", false), object(bus, "/method/table") { }
+
+    /* Create an interface with a single method */
+    const InterfaceDescription::Member* AddInterface(const char* ifaceName, const char* methodName)
+    {
+        InterfaceDescription* iface = NULL;
+        EXPECT_EQ(ER_OK, bus.CreateInterface(ifaceName, iface));
+        if (!iface) {
+            return NULL;
+        }
+        EXPECT_EQ(ER_OK, iface->AddMethod(methodName, "", "", NULL));
+        iface->Activate();
+        return iface->GetMember(methodName);
+    }
+
+    BusAttachment bus;
+    MethodTableObject object;
+};
+
+TEST_F(MethodTableTest, Collisions) {
+    /* The interface only adds to the hash so interfaces that are anagrams collide */
+    const char* ifaces[] = { "org.test.abc", "org.test.bca", "org.test.cab" };
+    ASSERT_EQ(KeyHash(object.GetPath(), ifaces[0], "Run"), KeyHash(object.GetPath(), ifaces[1], "Run"));
+
+    MethodTable table;
+    for (size_t i = 0; i < ArraySize(ifaces); ++i) {
+        const InterfaceDescription::Member* member = AddInterface(ifaces[i], "Run");
+        ASSERT_TRUE(member != NULL);
+        table.Add(&object, static_cast<MessageReceiver::MethodHandler>(&MethodTableObject::Handler1), member, (void*)i);
+    }
+    for (size_t i = 0; i < ArraySize(ifaces); ++i) {
+        MethodTable::Entry entry;
+        ASSERT_TRUE(table.Find(object.GetPath(), ifaces[i], "Run", entry));
+        EXPECT_STREQ(ifaces[i], entry.ifaceStr.c_str());
+        EXPECT_EQ((void*)i, entry.context);
+    }
+    MethodTable::Entry entry;
+    EXPECT_FALSE(table.Find(object.GetPath(), "org.test.acb", "Run", entry));
+    EXPECT_FALSE(table.Find(object.GetPath(), ifaces[0], "Walk", entry));
+    EXPECT_FALSE(table.Find("/method", ifaces[0], "Run", entry));
+}
+
+TEST_F(MethodTableTest, AnyInterface) {
+    MethodTable table;
+    const InterfaceDescription::Member* member = AddInterface("org.test.any", "Ping");
+    ASSERT_TRUE(member != NULL);
+    table.Add(&object, static_cast<MessageReceiver::MethodHandler>(&MethodTableObject::Handler1), member);
+
+    /* Method calls need not name the interface, a NULL or empty interface finds the method */
+    MethodTable::Entry entry;
+    ASSERT_TRUE(table.Find(object.GetPath(), NULL, "Ping", entry));
+    EXPECT_STREQ("org.test.any", entry.ifaceStr.c_str());
+    ASSERT_TRUE(table.Find(object.GetPath(), "", "Ping", entry));
+    EXPECT_EQ(member, entry.member);
+    ASSERT_TRUE(table.Find(object.GetPath(), "org.test.any", "Ping", entry));
+    EXPECT_FALSE(table.Find(object.GetPath(), "org.test.other", "Ping", entry));
+
+    /* The last method added with the same name is the one found without an interface */
+    const InterfaceDescription::Member* other = AddInterface("org.test.other", "Ping");
+    ASSERT_TRUE(other != NULL);
+    table.Add(&object, static_cast<MessageReceiver::MethodHandler>(&MethodTableObject::Handler2), other);
+    ASSERT_TRUE(table.Find(object.GetPath(), NULL, "Ping", entry));
+    EXPECT_EQ(other, entry.member);
+    ASSERT_TRUE(table.Find(object.GetPath(), "org.test.any", "Ping", entry));
+    EXPECT_EQ(member, entry.member);
+}
+
+TEST_F(MethodTableTest, WrapAround) {
+    /*
+     * Three colliding interfaces plus the entry without an interface give an index of 8 slots.
+     * Choose a method name whose collisions start in the last slot so the probes wrap around.
+     */
+    const char* ifaces[] = { "org.test.xyz", "org.test.yzx", "org.test.zxy" };
+    qcc::String methodName;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        qcc::String name = "Method" + qcc::U32ToString(i);
+        if ((KeyHash(object.GetPath(), ifaces[0], name.c_str()) & 7) == 7) {
+            methodName = name;
+            break;
+        }
+    }
+    ASSERT_FALSE(methodName.empty());
+
+    MethodTable table;
+    for (size_t i = 0; i < ArraySize(ifaces); ++i) {
+        const InterfaceDescription::Member* member = AddInterface(ifaces[i], methodName.c_str());
+        ASSERT_TRUE(member != NULL);
+        table.Add(&object, static_cast<MessageReceiver::MethodHandler>(&MethodTableObject::Handler1), member, (void*)i);
+    }
+    for (size_t i = 0; i < ArraySize(ifaces); ++i) {
+        MethodTable::Entry entry;
+        ASSERT_TRUE(table.Find(object.GetPath(), ifaces[i], methodName.c_str(), entry));
+        EXPECT_EQ((void*)i, entry.context);
+    }
+    MethodTable::Entry entry;
+    EXPECT_TRUE(table.Find(object.GetPath(), NULL, methodName.c_str(), entry));
+    /* A miss has to probe through the wrapped run to reach an empty slot */
+    EXPECT_FALSE(table.Find(object.GetPath(), "org.test.xzy", methodName.c_str(), entry));
+}
+
+TEST_F(MethodTableTest, EntryOutlivesRemove) {
+    MethodTable table;
+    const InterfaceDescription::Member* member = AddInterface("org.test.remove", "Gone");
+    ASSERT_TRUE(member != NULL);
+    table.Add(&object, static_cast<MessageReceiver::MethodHandler>(&MethodTableObject::Handler1), member);
+
+    MethodTable::Entry entry;
+    ASSERT_TRUE(table.Find(object.GetPath(), "org.test.remove", "Gone", entry));
+
+    /* Removing the object reclaims the table's entries, the copy found before must be unaffected */
+    table.RemoveAll(&object);
+    MethodTable::Entry after;
+    EXPECT_FALSE(table.Find(object.GetPath(), "org.test.remove", "Gone", after));
+    EXPECT_EQ(&object, entry.object);
+    EXPECT_EQ(member, entry.member);
+    EXPECT_STREQ("Gone", entry.methodStr.c_str());
+    EXPECT_STREQ(object.GetPath(), entry.objPathStr.c_str());
+}
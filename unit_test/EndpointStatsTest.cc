@@ -0,0 +1,158 @@
+/**
+ * @file
+ *
+ * This file tests the per-endpoint traffic counters
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+
+/* Private files included for unit testing */
+#include <EndpointStats.h>
+#include <RemoteEndpoint.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+class StatsMessage : public _Message {
+  public:
+    StatsMessage(BusAttachment& bus) : _Message(bus) { }
+
+    QStatus Signal()
+    {
+        MsgArg arg("u", 42);
+        return SignalMsg("u", NULL, 0, "/stats", "org.alljoyn.stats", "Stats", &arg, 1, 0, 0);
+    }
+
+    QStatus Deliver(RemoteEndpoint& ep) { return _Message::Deliver(ep); }
+
+    QStatus Unmarshal(RemoteEndpoint& ep) { return _Message::Unmarshal(ep, false); }
+};
+
+TEST(EndpointStatsTest, UnknownTypes) {
+    RemoteEndpoint::TrafficStats stats;
+    stats.CountRx(MESSAGE_SIGNAL, 10);
+    stats.CountTx(MESSAGE_METHOD_CALL, 20);
+    /* Types from the wire that are not known are counted as MESSAGE_INVALID */
+    stats.CountRx(0, 1);
+    stats.CountRx(5, 2);
+    stats.CountRx(255, 4);
+    stats.CountTx(200, 8);
+
+    EXPECT_EQ(1U, stats.rxMessages[MESSAGE_SIGNAL]);
+    EXPECT_EQ(10U, stats.rxBytes[MESSAGE_SIGNAL]);
+    EXPECT_EQ(1U, stats.txMessages[MESSAGE_METHOD_CALL]);
+    EXPECT_EQ(3U, stats.rxMessages[MESSAGE_INVALID]);
+    EXPECT_EQ(7U, stats.rxBytes[MESSAGE_INVALID]);
+    EXPECT_EQ(1U, stats.txMessages[MESSAGE_INVALID]);
+    EXPECT_EQ(8U, stats.txBytes[MESSAGE_INVALID]);
+    /* Nothing past the arrays was touched */
+    EXPECT_EQ(0U, stats.txQueueHighWater);
+    EXPECT_EQ(0U, stats.txBlocked);
+    EXPECT_EQ(0U, stats.headerExpansions);
+}
+
+TEST(EndpointStatsTest, ReceiveUnknownType) {
+    BusAttachment bus("EndpointStatsTest");
+    ASSERT_EQ(ER_OK, bus.Start());
+    qcc::Pipe stream;
+    RemoteEndpoint ep(bus, false, "", &stream, "dummy", false);
+
+    StatsMessage out(bus);
+    ASSERT_EQ(ER_OK, out.Signal());
+    ASSERT_EQ(ER_OK, out.Deliver(ep));
+
+    /* Rewrite the message type in the fixed header to one no version knows about */
+    uint8_t buf[256];
+    size_t len = 0;
+    ASSERT_EQ(ER_OK, stream.PullBytes(buf, sizeof(buf), len));
+    buf[1] = 0xEE;
+    size_t sent;
+    ASSERT_EQ(ER_OK, stream.PushBytes(buf, len, sent));
+
+    /* The header checks let unknown types through so the counters must not trust the type */
+    StatsMessage in(bus);
+    ASSERT_EQ(ER_OK, in.Unmarshal(ep));
+    EXPECT_EQ(0xEE, (int)in.GetType());
+    ep.GetTrafficStats().CountRx((uint8_t)in.GetType(), len);
+    EXPECT_EQ(1U, ep.GetTrafficStats().rxMessages[MESSAGE_INVALID]);
+    EXPECT_EQ((uint64_t)len, ep.GetTrafficStats().rxBytes[MESSAGE_INVALID]);
+
+    bus.Stop();
+    bus.Join();
+}
+
+TEST(EndpointStatsTest, SnapshotLayout) {
+    EndpointStats::Snapshot snapshot;
+    snapshot.name = ":1.1";
+    snapshot.txQueueDepth = 3;
+    snapshot.traffic.CountRx(MESSAGE_METHOD_RET, 100);
+    snapshot.traffic.CountRx(9, 50);
+    snapshot.traffic.txQueueHighWater = 7;
+    snapshot.traffic.authFailures = 2;
+    snapshot.compression.txMessages = 5;
+
+    MsgArg arg;
+    ASSERT_EQ(ER_OK, EndpointStats::ToMsgArg(snapshot, arg));
+    EXPECT_STREQ(EndpointStats::SnapshotSignature, arg.Signature().c_str());
+
+    size_t numTypes;
+    MsgArg* types;
+    uint32_t depth, highWater, blocked, decryptFailures, authFailures, expansions;
+    uint64_t blockedUs;
+    MsgArg* compression;
+    ASSERT_EQ(ER_OK, arg.Get("(a(yutut)uuutuuu*)", &numTypes, &types, &depth, &highWater, &blocked, &blockedUs,
+                             &decryptFailures, &authFailures, &expansions, &compression));
+    ASSERT_EQ(RemoteEndpoint::TrafficStats::NUM_MESSAGE_TYPES, numTypes);
+    EXPECT_EQ(3U, depth);
+    EXPECT_EQ(7U, highWater);
+    EXPECT_EQ(2U, authFailures);
+
+    for (size_t i = 0; i < numTypes; ++i) {
+        uint8_t type;
+        uint32_t rxMessages, txMessages;
+        uint64_t rxBytes, txBytes;
+        ASSERT_EQ(ER_OK, types[i].Get("(yutut)", &type, &rxMessages, &rxBytes, &txMessages, &txBytes));
+        EXPECT_EQ(i, (size_t)type);
+        if (type == MESSAGE_METHOD_RET) {
+            EXPECT_EQ(1U, rxMessages);
+            EXPECT_EQ(100U, rxBytes);
+        } else if (type == MESSAGE_INVALID) {
+            EXPECT_EQ(1U, rxMessages);
+            EXPECT_EQ(50U, rxBytes);
+        } else {
+            EXPECT_EQ(0U, rxMessages);
+        }
+    }
+
+    uint32_t txCompressed;
+    uint64_t dummy64;
+    uint32_t dummy32;
+    ASSERT_EQ(ER_OK, compression->Get("(uttuutt)", &txCompressed, &dummy64, &dummy64, &dummy32, &dummy32, &dummy64, &dummy64));
+    EXPECT_EQ(5U, txCompressed);
+}
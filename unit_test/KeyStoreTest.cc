@@ -229,3 +229,135 @@ TEST(KeyStoreTest, keystore_store_load_merge) {
     DeleteFile("keystore_test");
 }
 
+
+TEST(KeyStoreTest, keystore_journal) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guids[100];
+    QStatus status = ER_OK;
+    KeyBlob key;
+
+    /*
+     * Changes after the initial store are appended to the journal
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+        keyStore.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid1, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid2, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to append to keystore journal";
+
+        status = keyStore.DelKey(guid1);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to delete guid1";
+    }
+
+    /*
+     * Journal is replayed on load
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " guid1 was not deleted";
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+
+        /* Grow the journal until it gets compacted */
+        for (size_t i = 0; i < ArraySize(guids); ++i) {
+            key.Rand(620, KeyBlob::GENERIC);
+            keyStore.AddKey(guids[i], key);
+            status = keyStore.Store();
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+        }
+    }
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+
+        for (size_t i = 0; i < ArraySize(guids); ++i) {
+            status = keyStore.GetKey(guids[i], key);
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load key " << i;
+            ASSERT_EQ(620U, key.GetSize()) << "Key " << i << " has the wrong size";
+        }
+        keyStore.Clear();
+    }
+}
+
+TEST(KeyStoreTest, keystore_journal_shared) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+    Timespec expiration(GetTimestamp64() + 3600000, TIME_ABSOLUTE);
+
+    {
+        KeyStore keyStore1("keystore_journal_shared_test");
+        keyStore1.Init(NULL, true);
+        keyStore1.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore1.AddKey(guid1, key);
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore1.AddKey(guid3, key);
+        status = keyStore1.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        KeyStore keyStore2("keystore_journal_shared_test");
+        keyStore2.Init(NULL, true);
+
+        /* Both key stores are at the same revision, the second one journals a change first */
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore2.AddKey(guid2, key);
+        status = keyStore2.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to append to keystore journal";
+
+        /* The first one has not seen that change, deleting a key must not lose it */
+        status = keyStore1.DelKey(guid1);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to delete guid1";
+
+        status = keyStore1.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " DelKey did not merge guid2";
+
+        /* Nor must changing an expiration */
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore2.AddKey(guid1, key);
+        status = keyStore2.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to append to keystore journal";
+
+        status = keyStore1.SetKeyExpiration(guid3, expiration);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to set guid3 expiration";
+    }
+
+    {
+        KeyStore keyStore("keystore_journal_shared_test");
+        keyStore.Init(NULL, true);
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load re-added guid1";
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid2";
+
+        Timespec loaded;
+        status = keyStore.GetKeyExpiration(guid3, loaded);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+        ASSERT_GT(1000, abs((long)(loaded.GetAbsoluteMillis() - expiration.GetAbsoluteMillis()))) << "guid3 expiration was lost";
+        keyStore.Clear();
+    }
+    DeleteFile("keystore_journal_shared_test");
+}
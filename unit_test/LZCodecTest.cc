@@ -0,0 +1,190 @@
+/**
+ * @file
+ *
+ * This file tests the LZ codec used for message body compression
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+
+#include <string.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+
+#include <Status.h>
+
+/* Private files included for unit testing */
+#include <LZCodec.h>
+#include <RemoteEndpoint.h>
+
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace ajn;
+
+/* Deterministic pseudo random bytes so failures are reproducible */
+static void FillRandom(uint8_t* buf, size_t len)
+{
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < len; ++i) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void RoundTrip(const uint8_t* data, size_t len, bool expectSmaller)
+{
+    uint8_t* comp = new uint8_t[LZCodec::MaxCompressedLen(len)];
+    uint8_t* decomp = new uint8_t[len + 1];
+
+    size_t compLen = LZCodec::Compress(data, len, comp, LZCodec::MaxCompressedLen(len));
+    ASSERT_NE(0U, compLen);
+    if (expectSmaller) {
+        ASSERT_LT(compLen, len);
+    }
+    size_t outLen = 0;
+    QStatus status = LZCodec::Decompress(comp, compLen, decomp, len, outLen);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ(len, outLen);
+    ASSERT_EQ(0, memcmp(data, decomp, len));
+
+    delete [] comp;
+    delete [] decomp;
+}
+
+TEST(LZCodecTest, round_trip) {
+    /* Empty and tiny inputs */
+    RoundTrip((const uint8_t*)"", 0, false);
+    RoundTrip((const uint8_t*)"abc", 3, false);
+
+    /* Introspection XML is very repetitive */
+    qcc::String xml;
+    for (int i = 0; i < 100; ++i) {
+        xml += "<method name=\"Method\"><arg name=\"in\" type=\"s\" direction=\"in\"/></method>\n";
+    }
+    RoundTrip((const uint8_t*)xml.data(), xml.size(), true);
+
+    /* Long runs exercise the length extension bytes and overlapping matches */
+    uint8_t run[70000];
+    memset(run, 0x55, sizeof(run));
+    RoundTrip(run, sizeof(run), true);
+
+    /* Random data doesn't compress but must still round trip */
+    uint8_t rnd[4096];
+    FillRandom(rnd, sizeof(rnd));
+    RoundTrip(rnd, sizeof(rnd), false);
+}
+
+TEST(LZCodecTest, compress_overflow) {
+    uint8_t rnd[1024];
+    uint8_t comp[512];
+    FillRandom(rnd, sizeof(rnd));
+    /* Incompressible data doesn't fit in a smaller buffer */
+    ASSERT_EQ(0U, LZCodec::Compress(rnd, sizeof(rnd), comp, sizeof(comp)));
+}
+
+TEST(LZCodecTest, malformed_input) {
+    qcc::String text;
+    for (int i = 0; i < 50; ++i) {
+        text += "org.alljoyn.Bus.Peer.Authentication ";
+    }
+    size_t maxLen = LZCodec::MaxCompressedLen(text.size());
+    uint8_t* comp = new uint8_t[maxLen];
+    uint8_t* decomp = new uint8_t[text.size()];
+    size_t compLen = LZCodec::Compress((const uint8_t*)text.data(), text.size(), comp, maxLen);
+    ASSERT_NE(0U, compLen);
+    size_t outLen;
+
+    /* Truncated input */
+    ASSERT_EQ(ER_BUS_BAD_COMPRESSED_BODY, LZCodec::Decompress(comp, compLen - 1, decomp, text.size(), outLen));
+
+    /* Output buffer too small */
+    ASSERT_EQ(ER_BUS_BAD_COMPRESSED_BODY, LZCodec::Decompress(comp, compLen, decomp, text.size() - 1, outLen));
+
+    /* Back reference before the start of the output */
+    uint8_t bad[] = { 0x10, 'a', 0x10, 0x00, 0x00 };
+    ASSERT_EQ(ER_BUS_BAD_COMPRESSED_BODY, LZCodec::Decompress(bad, sizeof(bad), decomp, text.size(), outLen));
+
+    delete [] comp;
+    delete [] decomp;
+}
+
+class BodyMessage : public _Message {
+  public:
+    BodyMessage(BusAttachment& bus) : _Message(bus) { }
+
+    QStatus Signal(const char* text)
+    {
+        MsgArg arg("s", text);
+        return SignalMsg("s", NULL, 0, "/compression", "org.alljoyn.compression", "Body", &arg, 1, 0, 0);
+    }
+
+    QStatus Deliver(RemoteEndpoint& ep) { return _Message::Deliver(ep); }
+
+    QStatus Unmarshal(RemoteEndpoint& ep) { return _Message::Unmarshal(ep, false); }
+
+    QStatus UnmarshalArgs(const char* signature) { return _Message::UnmarshalArgs(signature); }
+};
+
+TEST(LZCodecTest, message_body) {
+    BusAttachment bus("LZCodecTest");
+    ASSERT_EQ(ER_OK, bus.Start());
+    qcc::Pipe stream;
+    RemoteEndpoint ep(bus, false, "", &stream, "dummy", false);
+    ep.GetFeatures().bodyCompression = true;
+
+    qcc::String text;
+    for (int i = 0; i < 50; ++i) {
+        text += "org.alljoyn.Bus.Peer.Authentication ";
+    }
+    BodyMessage out(bus);
+    ASSERT_EQ(ER_OK, out.Signal(text.c_str()));
+    ASSERT_EQ(ER_OK, out.Deliver(ep));
+
+    /* The body is compressed for this connection only */
+    uint8_t buf[4096];
+    size_t len = 0;
+    ASSERT_EQ(ER_OK, stream.PullBytes(buf, sizeof(buf), len));
+    ASSERT_LT(len, text.size());
+    EXPECT_TRUE(buf[2] & ALLJOYN_FLAG_BODY_COMPRESSED);
+    EXPECT_FALSE(out.GetFlags() & ALLJOYN_FLAG_BODY_COMPRESSED);
+
+    /* The far end of the connection decompresses it */
+    size_t sent;
+    ASSERT_EQ(ER_OK, stream.PushBytes(buf, len, sent));
+    BodyMessage in(bus);
+    ASSERT_EQ(ER_OK, in.Unmarshal(ep));
+    EXPECT_FALSE(in.GetFlags() & ALLJOYN_FLAG_BODY_COMPRESSED);
+    ASSERT_EQ(ER_OK, in.UnmarshalArgs("s"));
+    const char* received;
+    ASSERT_EQ(ER_OK, in.GetArg(0)->Get("s", &received));
+    EXPECT_STREQ(text.c_str(), received);
+
+    /* Only the final destination can decrypt a body so an encrypted body is never compressed */
+    buf[2] |= ALLJOYN_FLAG_ENCRYPTED;
+    ASSERT_EQ(ER_OK, stream.PushBytes(buf, len, sent));
+    BodyMessage encrypted(bus);
+    EXPECT_EQ(ER_BUS_BAD_COMPRESSED_BODY, encrypted.Unmarshal(ep));
+
+    bus.Stop();
+    bus.Join();
+}
@@ -0,0 +1,376 @@
+/**
+ * @file
+ *
+ * This file tests compiling signatures into marshal plans
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+
+/* Private files included for unit testing */
+#include <MarshalPlan.h>
+#include <RemoteEndpoint.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+TEST(MarshalPlanTest, Siblings) {
+    MarshalPlan plan;
+    ASSERT_EQ(ER_OK, MarshalPlan::Compile("sa{sv}i", plan));
+    EXPECT_EQ(3U, plan.GetNumArgs());
+    /* s, a, {, s, v, i */
+    EXPECT_EQ(1U, plan[0].next);
+    EXPECT_EQ(ALLJOYN_ARRAY, plan[1].argTypeId);
+    EXPECT_STREQ("{sv}", plan[1].elemSig.c_str());
+    EXPECT_EQ(5U, plan[1].next);
+    EXPECT_EQ(ALLJOYN_DICT_ENTRY, plan[2].argTypeId);
+    EXPECT_EQ(2U, plan[2].numMembers);
+    EXPECT_EQ(4U, plan[3].next);
+    EXPECT_EQ(ALLJOYN_INT32, plan[5].argTypeId);
+    EXPECT_EQ(6U, plan[5].next);
+    EXPECT_EQ(6, plan[5].sigOffset);
+}
+
+TEST(MarshalPlanTest, FixedLayout) {
+    MarshalPlan plan;
+    ASSERT_EQ(ER_OK, MarshalPlan::Compile("(y(nq)bd)", plan));
+    /* y at 0, (nq) at 8, b at 12, d at 16 */
+    EXPECT_EQ(24U, plan[0].fixedSize);
+    EXPECT_EQ(0U, plan[1].offset);
+    EXPECT_EQ(8U, plan[2].offset);
+    EXPECT_EQ(4U, plan[2].fixedSize);
+    EXPECT_EQ(0U, plan[3].offset);
+    EXPECT_EQ(2U, plan[4].offset);
+    EXPECT_EQ(12U, plan[5].offset);
+    EXPECT_EQ(16U, plan[6].offset);
+
+    /* Strings, variants and handles do not have a fixed layout */
+    ASSERT_EQ(ER_OK, MarshalPlan::Compile("(is)(iv)(ih)", plan));
+    EXPECT_EQ(0U, plan[0].fixedSize);
+    EXPECT_EQ(0U, plan[3].fixedSize);
+    EXPECT_EQ(0U, plan[6].fixedSize);
+}
+
+TEST(MarshalPlanTest, Arrays) {
+    MarshalPlan plan;
+    ASSERT_EQ(ER_OK, MarshalPlan::Compile("aiaba(ii)aai", plan));
+    /* Arrays of scalars are held in a single MsgArg */
+    EXPECT_EQ(ALLJOYN_INT32_ARRAY, plan[0].argTypeId);
+    EXPECT_EQ(ALLJOYN_BOOLEAN_ARRAY, plan[2].argTypeId);
+    /* Arrays of structs are not */
+    EXPECT_EQ(ALLJOYN_ARRAY, plan[4].argTypeId);
+    EXPECT_EQ(8U, plan[5].fixedSize);
+    EXPECT_EQ(ALLJOYN_ARRAY, plan[8].argTypeId);
+    EXPECT_STREQ("ai", plan[8].elemSig.c_str());
+    EXPECT_EQ(ALLJOYN_INT32_ARRAY, plan[9].argTypeId);
+}
+
+TEST(MarshalPlanTest, BadSignatures) {
+    MarshalPlan plan;
+    EXPECT_EQ(ER_BUS_BAD_SIGNATURE, MarshalPlan::Compile("{sv}", plan));
+    EXPECT_EQ(ER_BUS_BAD_SIGNATURE, MarshalPlan::Compile("(ii", plan));
+    EXPECT_EQ(ER_BUS_BAD_SIGNATURE, MarshalPlan::Compile("a", plan));
+    EXPECT_EQ(ER_BUS_BAD_SIGNATURE, MarshalPlan::Compile("*", plan));
+}
+
+TEST(MarshalPlanTest, Cache) {
+    MarshalPlan::Ref plan = MarshalPlan::Get("a(ssu)");
+    ASSERT_TRUE(plan != NULL);
+    EXPECT_EQ(plan, MarshalPlan::Get("a(ssu)"));
+    EXPECT_TRUE(MarshalPlan::Get("{sv}") == NULL);
+    EXPECT_TRUE(MarshalPlan::Get("") == NULL);
+
+    MarshalPlan::Enable(false);
+    EXPECT_TRUE(MarshalPlan::Get("a(ssu)") == NULL);
+    MarshalPlan::Enable(true);
+}
+
+TEST(MarshalPlanTest, Eviction) {
+    MarshalPlan::Ref held = MarshalPlan::Get("a(sst)");
+    ASSERT_TRUE(held != NULL);
+    const MarshalPlan* recent = MarshalPlan::Get("a(ssx)");
+
+    /* Enough distinct signatures to cycle the cache, touching the recent plan as we go */
+    qcc::String sig;
+    for (size_t i = 0; i < 200; ++i) {
+        sig += 'i';
+        EXPECT_TRUE(MarshalPlan::Get(sig.c_str()) != NULL);
+        EXPECT_EQ(recent, MarshalPlan::Get("a(ssx)"));
+    }
+
+    /* The held plan was evicted but is still usable, a new plan is compiled for its signature */
+    EXPECT_STREQ("a(sst)", held->GetSignature());
+    EXPECT_EQ(ALLJOYN_ARRAY, (*held)[0].argTypeId);
+    MarshalPlan::Ref again = MarshalPlan::Get("a(sst)");
+    ASSERT_TRUE(again != NULL);
+    EXPECT_NE(held, again);
+    EXPECT_STREQ("a(sst)", again->GetSignature());
+}
+
+TEST(MarshalPlanTest, FailuresNotCached) {
+    /* Invalid signatures do not take cache slots from valid ones */
+    MarshalPlan::Ref plan = MarshalPlan::Get("a(ssb)");
+    ASSERT_TRUE(plan != NULL);
+    qcc::String sig;
+    for (size_t i = 0; i < 200; ++i) {
+        sig += '(';
+        EXPECT_TRUE(MarshalPlan::Get(sig.c_str()) == NULL);
+    }
+    EXPECT_EQ(plan, MarshalPlan::Get("a(ssb)"));
+}
+
+class PlanMessage : public _Message {
+  public:
+    PlanMessage(BusAttachment& bus) : _Message(bus) { }
+
+    QStatus Signal(const char* signature, const MsgArg* args, size_t numArgs)
+    {
+        return SignalMsg(signature, NULL, 0, "/plan", "org.alljoyn.plan", "Plan", args, numArgs, 0, 0);
+    }
+
+    QStatus Deliver(RemoteEndpoint& ep) { return _Message::Deliver(ep); }
+
+    QStatus Unmarshal(RemoteEndpoint& ep) { return _Message::Unmarshal(ep, false); }
+
+    QStatus UnmarshalArgs(const char* signature) { return _Message::UnmarshalArgs(signature); }
+};
+
+/*
+ * Marshals and unmarshals message bodies with and without plans over a pipe
+ */
+class MarshalPlanMessageTest : public testing::Test {
+  public:
+    MarshalPlanMessageTest() : bus("MarshalPlanMessageTest"), ep(bus, false, "", &stream, "dummy", false) { }
+
+    virtual void SetUp()
+    {
+        ASSERT_EQ(ER_OK, bus.Start());
+    }
+
+    virtual void TearDown()
+    {
+        MarshalPlan::Enable(true);
+        /* Back to the native endianness */
+        _Message::SetEndianess(0);
+        bus.Stop();
+        bus.Join();
+    }
+
+    /* Marshal a signal returning the bytes sent */
+    QStatus Marshal(const char* signature, const MsgArg* args, size_t numArgs, bool planned, qcc::String& wire)
+    {
+        MarshalPlan::Enable(planned);
+        PlanMessage msg(bus);
+        QStatus status = msg.Signal(signature, args, numArgs);
+        if (status == ER_OK) {
+            status = msg.Deliver(ep);
+        }
+        MarshalPlan::Enable(true);
+        wire.clear();
+        if (status == ER_OK) {
+            uint8_t buf[4096];
+            size_t len = 0;
+            status = stream.PullBytes(buf, sizeof(buf), len);
+            wire.append((const char*)buf, len);
+        }
+        return status;
+    }
+
+    /* Unmarshal the bytes of a signal */
+    QStatus Unmarshal(const qcc::String& wire, const char* signature, bool planned, PlanMessage& msg)
+    {
+        size_t sent;
+        QStatus status = stream.PushBytes(wire.data(), wire.size(), sent);
+        if (status == ER_OK) {
+            status = msg.Unmarshal(ep);
+        }
+        if (status == ER_OK) {
+            MarshalPlan::Enable(planned);
+            status = msg.UnmarshalArgs(signature);
+            MarshalPlan::Enable(true);
+        }
+        return status;
+    }
+
+    /* Offset of the body in the bytes of a message */
+    static size_t BodyOffset(const qcc::String& wire)
+    {
+        const uint8_t* hdr = (const uint8_t*)wire.data();
+        uint32_t fieldsLen = (hdr[0] == 'l') ?
+                             (hdr[12] | (hdr[13] << 8) | (hdr[14] << 16) | (hdr[15] << 24)) :
+                             (hdr[15] | (hdr[14] << 8) | (hdr[13] << 16) | (hdr[12] << 24));
+        return 16 + ((fieldsLen + 7) & ~7);
+    }
+
+    /* Shorten the body length in the header of a message and drop the end of the body */
+    static void Truncate(qcc::String& wire, uint32_t drop)
+    {
+        uint8_t* hdr = (uint8_t*)wire.data();
+        uint32_t bodyLen = (uint32_t)(wire.size() - BodyOffset(wire)) - drop;
+        for (size_t i = 0; i < 4; ++i) {
+            hdr[4 + ((hdr[0] == 'l') ? i : 3 - i)] = (uint8_t)(bodyLen >> (8 * i));
+        }
+        wire.resize(wire.size() - drop);
+    }
+
+    /*
+     * Check the planned and interpreting marshalers produce the same bytes and that each
+     * unmarshaler recovers the arguments from the bytes of either.
+     */
+    void RoundTrip(const char* signature, const MsgArg* args, size_t numArgs)
+    {
+        qcc::String planned, interpreted;
+        ASSERT_EQ(ER_OK, Marshal(signature, args, numArgs, true, planned));
+        ASSERT_EQ(ER_OK, Marshal(signature, args, numArgs, false, interpreted));
+        ASSERT_GT(planned.size(), BodyOffset(planned));
+        EXPECT_EQ(planned.size() - BodyOffset(planned), interpreted.size() - BodyOffset(interpreted));
+        EXPECT_TRUE(planned.substr(BodyOffset(planned)) == interpreted.substr(BodyOffset(interpreted))) << signature;
+
+        const qcc::String* wires[] = { &planned, &interpreted };
+        for (size_t w = 0; w < 2; ++w) {
+            for (int p = 0; p < 2; ++p) {
+                PlanMessage msg(bus);
+                ASSERT_EQ(ER_OK, Unmarshal(*wires[w], signature, p == 0, msg)) << signature;
+                size_t numOut;
+                const MsgArg* out;
+                msg.GetArgs(numOut, out);
+                ASSERT_EQ(numArgs, numOut);
+                for (size_t i = 0; i < numArgs; ++i) {
+                    MsgArg expected(args[i]);
+                    EXPECT_TRUE(expected == out[i]) << signature << " arg " << i;
+                }
+            }
+        }
+    }
+
+    /* Check both unmarshalers reject the same damaged body */
+    void Reject(const qcc::String& wire, const char* signature)
+    {
+        PlanMessage planned(bus);
+        QStatus plannedStatus = Unmarshal(wire, signature, true, planned);
+        PlanMessage interpreted(bus);
+        QStatus interpretedStatus = Unmarshal(wire, signature, false, interpreted);
+        EXPECT_NE(ER_OK, plannedStatus) << signature;
+        EXPECT_NE(ER_OK, interpretedStatus) << signature;
+    }
+
+    /* Round trip every test body */
+    void RoundTripAll()
+    {
+        MsgArg fixed("(y(nq)bd)", 0xA5, -1234, 0xBEEF, true, 3.25);
+        RoundTrip("(y(nq)bd)", &fixed, 1);
+
+        MsgArg structs[3];
+        structs[0].Set("(iyd)", -1, 1, 0.5);
+        structs[1].Set("(iyd)", 2, 255, -2.0);
+        structs[2].Set("(iyd)", 0x7FFFFFFF, 0, 1e100);
+        MsgArg structArray("a(iyd)", (size_t)3, structs);
+        RoundTrip("a(iyd)", &structArray, 1);
+
+        MsgArg empty("a(iyd)", (size_t)0, (MsgArg*)NULL);
+        RoundTrip("a(iyd)", &empty, 1);
+
+        MsgArg name("s", "plan");
+        MsgArg count("u", 7);
+        MsgArg flags("ab", (size_t)0, (bool*)NULL);
+        MsgArg entries[3];
+        entries[0].Set("{sv}", "name", &name);
+        entries[1].Set("{sv}", "count", &count);
+        entries[2].Set("{sv}", "flags", &flags);
+        MsgArg dict("a{sv}", (size_t)3, entries);
+        RoundTrip("a{sv}", &dict, 1);
+
+        int32_t row0[] = { 1, 2, 3 };
+        int32_t row2[] = { -4 };
+        MsgArg rows[3];
+        rows[0].Set("ai", (size_t)3, row0);
+        rows[1].Set("ai", (size_t)0, (int32_t*)NULL);
+        rows[2].Set("ai", (size_t)1, row2);
+        MsgArg matrix("aai", (size_t)3, rows);
+        RoundTrip("aai", &matrix, 1);
+
+        MsgArg several[3];
+        several[0].Set("y", 9);
+        several[1].Set("(y(nq)bd)", 1, 2, 3, false, 4.0);
+        several[2].Set("aai", (size_t)3, rows);
+        RoundTrip("y(y(nq)bd)aai", several, 3);
+    }
+
+    BusAttachment bus;
+    qcc::Pipe stream;
+    RemoteEndpoint ep;
+};
+
+TEST_F(MarshalPlanMessageTest, RoundTrip) {
+    RoundTripAll();
+}
+
+TEST_F(MarshalPlanMessageTest, RoundTripSwapped) {
+    /* Send with the opposite of the native endianness so every value is swapped */
+    uint16_t probe = 1;
+    bool little = (*(uint8_t*)&probe == 1);
+    _Message::SetEndianess(little ? ALLJOYN_BIG_ENDIAN : ALLJOYN_LITTLE_ENDIAN);
+    RoundTripAll();
+}
+
+TEST_F(MarshalPlanMessageTest, Truncated) {
+    MsgArg fixed("(y(nq)bd)", 1, 2, 3, true, 4.0);
+    qcc::String wire;
+    ASSERT_EQ(ER_OK, Marshal("(y(nq)bd)", &fixed, 1, true, wire));
+    Truncate(wire, 4);
+    Reject(wire, "(y(nq)bd)");
+
+    int32_t row[] = { 1, 2, 3, 4 };
+    MsgArg rows[2];
+    rows[0].Set("ai", (size_t)4, row);
+    rows[1].Set("ai", (size_t)4, row);
+    MsgArg matrix("aai", (size_t)2, rows);
+    ASSERT_EQ(ER_OK, Marshal("aai", &matrix, 1, true, wire));
+    Truncate(wire, 8);
+    Reject(wire, "aai");
+}
+
+TEST_F(MarshalPlanMessageTest, OutOfRange) {
+    MsgArg structs[2];
+    structs[0].Set("(iyd)", 1, 2, 3.0);
+    structs[1].Set("(iyd)", 4, 5, 6.0);
+    MsgArg structArray("a(iyd)", (size_t)2, structs);
+    qcc::String wire;
+    ASSERT_EQ(ER_OK, Marshal("a(iyd)", &structArray, 1, true, wire));
+    /* Array length runs past the end of the body */
+    uint8_t* len = (uint8_t*)wire.data() + BodyOffset(wire);
+    len[0] = len[1] = len[2] = len[3] = 0x7F;
+    Reject(wire, "a(iyd)");
+
+    MsgArg fixed("(y(nq)bd)", 1, 2, 3, true, 4.0);
+    ASSERT_EQ(ER_OK, Marshal("(y(nq)bd)", &fixed, 1, true, wire));
+    /* A boolean that is neither 0 nor 1 */
+    uint8_t* b = (uint8_t*)wire.data() + BodyOffset(wire) + 12;
+    b[0] = b[3] = 2;
+    Reject(wire, "(y(nq)bd)");
+}
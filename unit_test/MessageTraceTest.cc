@@ -0,0 +1,89 @@
+/**
+ * @file
+ *
+ * This file tests the latency histograms of message tracing
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+/* Private files included for unit testing */
+#include <MessageTrace.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+TEST(MessageTraceTest, BucketBounds) {
+    /* Small latencies have a bucket each */
+    for (uint64_t us = 0; us < 16; ++us) {
+        EXPECT_EQ(us, LatencyHistogram::BucketIndex(us));
+        EXPECT_EQ(us, LatencyHistogram::BucketLowerBound(us));
+    }
+    /* Every bucket starts where the previous one ended */
+    for (size_t b = 1; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+        uint64_t lower = LatencyHistogram::BucketLowerBound(b);
+        EXPECT_GT(lower, LatencyHistogram::BucketLowerBound(b - 1));
+        EXPECT_EQ(b, LatencyHistogram::BucketIndex(lower));
+        EXPECT_EQ(b - 1, LatencyHistogram::BucketIndex(lower - 1));
+    }
+    /* Huge latencies go in the last bucket */
+    EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketIndex((uint64_t)1 << 50));
+    EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketIndex((uint64_t)-1));
+}
+
+TEST(MessageTraceTest, Percentiles) {
+    LatencyHistogram h;
+    EXPECT_EQ((uint64_t)0, h.GetPercentile(50));
+
+    for (uint64_t us = 1; us <= 100; ++us) {
+        h.Record(us * 100);
+    }
+    EXPECT_EQ((uint32_t)100, h.GetTotal());
+
+    /* A percentile is within 1/8 above the exact value */
+    uint64_t p50 = h.GetPercentile(50);
+    EXPECT_GE(p50, (uint64_t)5000);
+    EXPECT_LE(p50, (uint64_t)5000 + 5000 / 8);
+    uint64_t p99 = h.GetPercentile(99);
+    EXPECT_GE(p99, (uint64_t)9900);
+    EXPECT_LE(p99, (uint64_t)9900 + 9900 / 8);
+
+    h.Reset();
+    EXPECT_EQ((uint32_t)0, h.GetTotal());
+}
+
+TEST(MessageTraceTest, StageRecording) {
+    MessageTrace::Histograms histograms;
+    uint32_t busCount = MessageTrace::GetBusHistograms().stage[MessageTrace::ROUTE].GetTotal();
+
+    /* Messages that were not timestamped are not counted */
+    histograms.Record(MessageTrace::ROUTE, 0, 10);
+    histograms.Record(MessageTrace::ROUTE, 20, 10);
+    EXPECT_EQ((uint32_t)0, histograms.stage[MessageTrace::ROUTE].GetTotal());
+
+    histograms.Record(MessageTrace::ROUTE, 10, 15);
+    EXPECT_EQ((uint32_t)1, histograms.stage[MessageTrace::ROUTE].GetCount(5));
+    EXPECT_EQ((uint32_t)0, histograms.stage[MessageTrace::DELIVER].GetTotal());
+    EXPECT_EQ(busCount + 1, MessageTrace::GetBusHistograms().stage[MessageTrace::ROUTE].GetTotal());
+
+    uint64_t t1 = MessageTrace::Now();
+    uint64_t t2 = MessageTrace::Now();
+    EXPECT_NE((uint64_t)0, t1);
+    EXPECT_GE(t2, t1);
+}
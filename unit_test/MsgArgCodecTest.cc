@@ -0,0 +1,151 @@
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <map>
+#include <vector>
+
+#include <qcc/String.h>
+
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/MsgArgCodec.h>
+#include <Status.h>
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace ajn;
+using namespace std;
+
+template <typename T>
+static qcc::String SignatureOf()
+{
+    qcc::String sig;
+    MsgArgCodec<T>::Signature(sig);
+    return sig;
+}
+
+TEST(MsgArgCodecTest, Signatures) {
+    EXPECT_STREQ("y", SignatureOf<uint8_t>().c_str());
+    EXPECT_STREQ("b", SignatureOf<bool>().c_str());
+    EXPECT_STREQ("x", SignatureOf<int64_t>().c_str());
+    EXPECT_STREQ("d", SignatureOf<double>().c_str());
+    EXPECT_STREQ("s", SignatureOf<qcc::String>().c_str());
+    EXPECT_STREQ("aai", SignatureOf<vector<vector<int32_t> > >().c_str());
+    EXPECT_STREQ("a{sas}", (SignatureOf<map<qcc::String, vector<qcc::String> > >().c_str()));
+    EXPECT_STREQ("(qd)", (SignatureOf<pair<uint16_t, double> >().c_str()));
+    EXPECT_STREQ("a(iys)", (SignatureOf<vector<MsgArgTuple<int32_t, uint8_t, qcc::String> > >().c_str()));
+
+    uint32_t u = 0;
+    qcc::String s;
+    EXPECT_STREQ("us", MakeArgs(u, s).GetSignature().c_str());
+}
+
+TEST(MsgArgCodecTest, WireFormat) {
+    uint8_t y = 1;
+    qcc::String s("ab");
+    vector<int32_t> ai;
+    ai.push_back(1);
+    ai.push_back(2);
+    TypedMsgArgList<uint8_t, qcc::String, vector<int32_t> > args = MakeArgs(y, s, ai);
+
+    MsgBodyWriter sizer(NULL, false);
+    args.Marshal(sizer);
+    ASSERT_EQ(24U, sizer.GetSize());
+
+    uint64_t buf[3];
+    MsgBodyWriter writer((uint8_t*)buf, false);
+    args.Marshal(writer);
+    ASSERT_EQ(ER_OK, writer.GetStatus());
+    ASSERT_EQ(24U, writer.GetSize());
+    const uint8_t* p = (const uint8_t*)buf;
+    EXPECT_EQ(1, p[0]);
+    EXPECT_EQ(0, p[1]);
+    EXPECT_EQ(2U, *(const uint32_t*)(p + 4));
+    EXPECT_STREQ("ab", (const char*)(p + 8));
+    EXPECT_EQ(8U, *(const uint32_t*)(p + 12));
+    EXPECT_EQ(1, *(const int32_t*)(p + 16));
+    EXPECT_EQ(2, *(const int32_t*)(p + 20));
+}
+
+TEST(MsgArgCodecTest, Dictionary) {
+    map<qcc::String, int32_t> dict;
+    dict["k"] = 5;
+
+    uint64_t buf[3];
+    MsgBodyWriter writer((uint8_t*)buf, false);
+    MsgArgCodec<map<qcc::String, int32_t> >::Marshal(writer, dict);
+    ASSERT_EQ(20U, writer.GetSize());
+    const uint8_t* p = (const uint8_t*)buf;
+    /* Array length does not include the padding before the first entry */
+    EXPECT_EQ(12U, *(const uint32_t*)p);
+    EXPECT_EQ(1U, *(const uint32_t*)(p + 8));
+    EXPECT_STREQ("k", (const char*)(p + 12));
+    EXPECT_EQ(5, *(const int32_t*)(p + 16));
+}
+
+TEST(MsgArgCodecTest, EndianSwap) {
+    vector<uint16_t> aq;
+    aq.push_back(0x0102);
+    aq.push_back(0x0304);
+    uint64_t native[2];
+    uint64_t swapped[2];
+    MsgBodyWriter nativeWriter((uint8_t*)native, false);
+    MsgBodyWriter swapWriter((uint8_t*)swapped, true);
+    MsgArgCodec<vector<uint16_t> >::Marshal(nativeWriter, aq);
+    MsgArgCodec<vector<uint16_t> >::Marshal(swapWriter, aq);
+    ASSERT_EQ(8U, swapWriter.GetSize());
+    const uint8_t* n = (const uint8_t*)native;
+    const uint8_t* s = (const uint8_t*)swapped;
+    /* 32 bit length */
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(n[i], s[3 - i]);
+    }
+    /* 16 bit elements */
+    for (size_t i = 4; i < 8; i += 2) {
+        EXPECT_EQ(n[i], s[i + 1]);
+        EXPECT_EQ(n[i + 1], s[i]);
+    }
+}
+
+TEST(MsgArgCodecTest, Get) {
+    int32_t ints[] = { 3, 4, 5 };
+    MsgArg arg("ai", ArraySize(ints), ints);
+    vector<int32_t> ai;
+    ASSERT_EQ(ER_OK, GetTypedArg(arg, ai));
+    ASSERT_EQ(3U, ai.size());
+    EXPECT_EQ(5, ai[2]);
+
+    qcc::String s;
+    EXPECT_EQ(ER_BUS_SIGNATURE_MISMATCH, GetTypedArg(arg, s));
+
+    MsgArg st("(us)", 7, "seven");
+    MsgArgTuple<uint32_t, qcc::String> tuple;
+    ASSERT_EQ(ER_OK, GetTypedArg(st, tuple));
+    EXPECT_EQ(7U, tuple.a);
+    EXPECT_STREQ("seven", tuple.b.c_str());
+    MsgArgTuple<uint32_t, qcc::String, bool> tooMany;
+    EXPECT_EQ(ER_BUS_SIGNATURE_MISMATCH, GetTypedArg(st, tooMany));
+
+    MsgArg entries[2];
+    entries[0].Set("{sb}", "on", true);
+    entries[1].Set("{sb}", "off", false);
+    MsgArg dictArg("a{sb}", ArraySize(entries), entries);
+    map<qcc::String, bool> dict;
+    ASSERT_EQ(ER_OK, GetTypedArg(dictArg, dict));
+    ASSERT_EQ(2U, dict.size());
+    EXPECT_TRUE(dict["on"]);
+    EXPECT_FALSE(dict["off"]);
+}
@@ -24,6 +24,9 @@
 #include "ServiceTestObject.h"
 #include "ajTestCommon.h"
 
+#include <qcc/StringSource.h>
+#include <qcc/StringUtil.h>
+#include <qcc/XmlElement.h>
 #include <qcc/time.h>
 /* Header files included for Google Test Framework */
 #include <gtest/gtest.h>
@@ -405,6 +408,105 @@ TEST(PerfTest, Properties_SettingReadOnlyProperty) {
     EXPECT_STREQ(QCC_StatusText(ER_BUS_PROPERTY_ACCESS_DENIED), errMsg.c_str());
 }
 
+TEST(PerfTest, Batch_MethodCalls) {
+    ASSERT_EQ(ER_OK, ServiceSetup());
+    ClientSetup testclient(ajn::getConnectArg().c_str());
+
+    BusAttachment* test_msgBus = testclient.getClientMsgBus();
+
+    ProxyBusObject remoteObj(*test_msgBus, testclient.getClientWellknownName(), testclient.getClientObjectPath(), 0);
+    QStatus status = remoteObj.IntrospectRemoteObject();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject::Batch batch(remoteObj);
+    ASSERT_EQ(ER_BUS_BATCH_NOT_SENT, batch.Wait(0));
+    MsgArg pingStr[20];
+    size_t index[20];
+    for (size_t i = 0; i < ArraySize(pingStr); ++i) {
+        String text = "Ping " + U32ToString((uint32_t)i);
+        pingStr[i].Set("s", text.c_str());
+        pingStr[i].Stabilize();
+        status = batch.AddMethodCall(testclient.getClientInterfaceName(), "my_ping", index[i], &pingStr[i], 1);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+    size_t badIndex;
+    EXPECT_EQ(ER_BUS_INTERFACE_NO_SUCH_MEMBER, batch.AddMethodCall(testclient.getClientInterfaceName(), "no_such_method", badIndex));
+    EXPECT_EQ(ArraySize(pingStr), batch.Size());
+
+    status = batch.Send(5000);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(ER_BUS_BATCH_ALREADY_SENT, batch.Send(5000));
+    EXPECT_EQ(ER_BUS_BATCH_ALREADY_SENT, batch.AddMethodCall(testclient.getClientInterfaceName(), "my_ping", badIndex, &pingStr[0], 1));
+
+    status = batch.Wait(10000);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_TRUE(batch.IsComplete());
+
+    /* Replies are matched to the calls regardless of the order they arrive in */
+    for (size_t i = 0; i < ArraySize(pingStr); ++i) {
+        Message reply(*test_msgBus);
+        status = batch.GetReply(index[i], reply);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        String text = "Ping " + U32ToString((uint32_t)i);
+        EXPECT_STREQ(text.c_str(), reply->GetArg(0)->v_string.str);
+    }
+}
+
+TEST(PerfTest, Batch_GetProperties) {
+    ASSERT_EQ(ER_OK, ServiceSetup());
+    ClientSetup testclient(ajn::getConnectArg().c_str());
+
+    BusAttachment* test_msgBus = testclient.getClientMsgBus();
+
+    ProxyBusObject remoteObj(*test_msgBus, testclient.getClientWellknownName(), testclient.getClientObjectPath(), 0);
+    QStatus status = remoteObj.IntrospectRemoteObject();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    /* Property reads are only coalesced if the remote object supports it */
+    EXPECT_TRUE(remoteObj.ImplementsInterface(ajn::org::alljoyn::Bus::Properties::InterfaceName));
+
+    MsgArg intVal("i", 1234);
+    status = remoteObj.SetProperty(testclient.getClientValuesInterfaceName(), "int_val", intVal);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    MsgArg strVal("s", "batched");
+    status = remoteObj.SetProperty(testclient.getClientValuesInterfaceName(), "str_val", strVal);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject::Batch batch(remoteObj);
+    size_t intIndex, strIndex, badIndex, pingIndex;
+    ASSERT_EQ(ER_OK, batch.AddGetProperty(testclient.getClientValuesInterfaceName(), "int_val", intIndex));
+    ASSERT_EQ(ER_OK, batch.AddGetProperty(testclient.getClientValuesInterfaceName(), "no_such_prop", badIndex));
+    ASSERT_EQ(ER_OK, batch.AddGetProperty(testclient.getClientValuesInterfaceName(), "str_val", strIndex));
+    MsgArg pingStr("s", "Mixed");
+    ASSERT_EQ(ER_OK, batch.AddMethodCall(testclient.getClientInterfaceName(), "my_ping", pingIndex, &pingStr, 1));
+
+    status = batch.Send();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = batch.Wait(10000);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    MsgArg value;
+    status = batch.GetProperty(intIndex, value);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    int32_t i;
+    ASSERT_EQ(ER_OK, value.Get("i", &i));
+    EXPECT_EQ(1234, i);
+
+    status = batch.GetProperty(strIndex, value);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    const char* str;
+    ASSERT_EQ(ER_OK, value.Get("s", &str));
+    EXPECT_STREQ("batched", str);
+
+    /* A bad property only fails its own entry */
+    EXPECT_EQ(ER_BUS_NO_SUCH_PROPERTY, batch.GetProperty(badIndex, value));
+
+    Message reply(*test_msgBus);
+    EXPECT_EQ(ER_OK, batch.GetReply(pingIndex, reply));
+    EXPECT_STREQ("Mixed", reply->GetArg(0)->v_string.str);
+    EXPECT_EQ(ER_BAD_ARG_1, batch.GetReply(intIndex, reply));
+    EXPECT_EQ(ER_BAD_ARG_1, batch.GetProperty(pingIndex, value));
+}
+
 TEST(PerfTest, Signals_With_Two_Parameters) {
     ASSERT_EQ(ER_OK, ServiceSetup());
     ClientSetup testclient(ajn::getConnectArg().c_str());
@@ -0,0 +1,246 @@
+/**
+ * @file
+ *
+ * This file tests the property cache shared by proxy objects
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/ProxyBusObject.h>
+
+#include <Status.h>
+
+/* Private files included for unit testing */
+#include <BusInternal.h>
+#include <PropertyCache.h>
+
+#include <gtest/gtest.h>
+
+#include "ajTestCommon.h"
+
+using namespace ajn;
+
+static const char* INTERFACE_NAME = "org.alljoyn.test.PropertyCacheTest";
+static const char* OBJECT_NAME =    "org.alljoyn.test.PropertyCacheTest";
+static const char* OBJECT_PATH =    "/org/alljoyn/test/PropertyCacheTest";
+
+/* Service object that reports every successful Set with PropertiesChanged */
+class PropertyCacheTestObject : public BusObject {
+  public:
+    PropertyCacheTestObject(BusAttachment& bus, const char* path) : BusObject(bus, path), intVal(0)
+    {
+        SetEmitPropChangedOnSet(true);
+    }
+
+    QStatus SetUp(const InterfaceDescription& iface)
+    {
+        return AddInterface(iface);
+    }
+
+    QStatus Get(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        if (strcmp("int_val", propName) != 0) {
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+        return val.Set("i", intVal);
+    }
+
+    QStatus Set(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        if (strcmp("int_val", propName) != 0) {
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+        return val.Get("i", &intVal);
+    }
+
+    int32_t intVal;
+};
+
+class PropertyCacheTest : public testing::Test {
+  public:
+    PropertyCacheTest() :
+        serviceBus("PropertyCacheTestService", false),
+        clientBus("PropertyCacheTestClient", false),
+        serviceObj(serviceBus, OBJECT_PATH)
+    { }
+
+    virtual void SetUp()
+    {
+        ASSERT_EQ(ER_OK, serviceBus.Start());
+        ASSERT_EQ(ER_OK, serviceBus.Connect(getConnectArg().c_str()));
+        InterfaceDescription* iface = NULL;
+        ASSERT_EQ(ER_OK, serviceBus.CreateInterface(INTERFACE_NAME, iface));
+        ASSERT_EQ(ER_OK, iface->AddProperty("int_val", "i", PROP_ACCESS_RW));
+        iface->Activate();
+        ASSERT_EQ(ER_OK, serviceObj.SetUp(*iface));
+        ASSERT_EQ(ER_OK, serviceBus.RegisterBusObject(serviceObj));
+        ASSERT_EQ(ER_OK, serviceBus.RequestName(OBJECT_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE));
+
+        ASSERT_EQ(ER_OK, clientBus.Start());
+        ASSERT_EQ(ER_OK, clientBus.Connect(getConnectArg().c_str()));
+    }
+
+    virtual void TearDown()
+    {
+        clientBus.Stop();
+        clientBus.Join();
+        serviceBus.UnregisterBusObject(serviceObj);
+        serviceBus.Stop();
+        serviceBus.Join();
+    }
+
+    /* Set the property with a method call that bypasses the cache */
+    QStatus RemoteSet(ProxyBusObject& proxy, int32_t value)
+    {
+        Message reply(clientBus);
+        MsgArg newVal("i", value);
+        MsgArg inArgs[3];
+        size_t numArgs = ArraySize(inArgs);
+        MsgArg::Set(inArgs, numArgs, "ssv", INTERFACE_NAME, "int_val", &newVal);
+        const InterfaceDescription* propIface = clientBus.GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+        return proxy.MethodCall(*(propIface->GetMember("Set")), inArgs, numArgs, reply, 5000, 0);
+    }
+
+    /* Read the property through the proxy until it has the expected value or 2 seconds have passed */
+    int32_t WaitForValue(ProxyBusObject& proxy, int32_t expected)
+    {
+        int32_t val = 0;
+        for (int n = 0; n < 200; ++n) {
+            MsgArg value;
+            EXPECT_EQ(ER_OK, proxy.GetProperty(INTERFACE_NAME, "int_val", value));
+            EXPECT_EQ(ER_OK, value.Get("i", &val));
+            if (val == expected) {
+                break;
+            }
+            qcc::Sleep(10);
+        }
+        return val;
+    }
+
+    BusAttachment serviceBus;
+    BusAttachment clientBus;
+    PropertyCacheTestObject serviceObj;
+};
+
+TEST_F(PropertyCacheTest, HitsAndUpdates) {
+    ProxyBusObject remoteObj(clientBus, OBJECT_NAME, OBJECT_PATH, 0);
+    ASSERT_EQ(ER_OK, remoteObj.IntrospectRemoteObject());
+    ASSERT_EQ(ER_OK, remoteObj.EnablePropertyCaching(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, remoteObj.SetProperty(INTERFACE_NAME, "int_val", (int32_t)10));
+
+    uint32_t hits, misses;
+    remoteObj.GetPropertyCacheCounters(hits, misses);
+    uint32_t startHits = hits;
+    uint32_t startMisses = misses;
+
+    /* First read goes to the remote object, the second comes from the cache */
+    MsgArg value;
+    int32_t i;
+    ASSERT_EQ(ER_OK, remoteObj.GetProperty(INTERFACE_NAME, "int_val", value));
+    ASSERT_EQ(ER_OK, value.Get("i", &i));
+    EXPECT_EQ(10, i);
+    ASSERT_EQ(ER_OK, remoteObj.GetProperty(INTERFACE_NAME, "int_val", value));
+    ASSERT_EQ(ER_OK, value.Get("i", &i));
+    EXPECT_EQ(10, i);
+    remoteObj.GetPropertyCacheCounters(hits, misses);
+    EXPECT_EQ(startHits + 1, hits);
+    EXPECT_EQ(startMisses + 1, misses);
+
+    /* Another proxy for the same object shares the cached values */
+    ProxyBusObject otherObj(clientBus, OBJECT_NAME, OBJECT_PATH, 0);
+    ASSERT_EQ(ER_OK, otherObj.IntrospectRemoteObject());
+    ASSERT_EQ(ER_OK, otherObj.EnablePropertyCaching(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, otherObj.GetProperty(INTERFACE_NAME, "int_val", value));
+    ASSERT_EQ(ER_OK, value.Get("i", &i));
+    EXPECT_EQ(10, i);
+    otherObj.GetPropertyCacheCounters(hits, misses);
+    EXPECT_EQ(startHits + 2, hits);
+    EXPECT_EQ(startMisses + 1, misses);
+
+    /* A Set that bypasses the cache is picked up from the PropertiesChanged signal */
+    ASSERT_EQ(ER_OK, RemoteSet(remoteObj, 30));
+    EXPECT_EQ(30, WaitForValue(remoteObj, 30));
+    remoteObj.GetPropertyCacheCounters(hits, misses);
+    EXPECT_EQ(startMisses + 1, misses);
+}
+
+TEST_F(PropertyCacheTest, StaleReplyDropped) {
+    ProxyBusObject remoteObj(clientBus, OBJECT_NAME, OBJECT_PATH, 0);
+    ASSERT_EQ(ER_OK, remoteObj.IntrospectRemoteObject());
+    ASSERT_EQ(ER_OK, remoteObj.EnablePropertyCaching(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, RemoteSet(remoteObj, 1));
+
+    PropertyCache& cache = clientBus.GetInternal().GetPropertyCache();
+    uint32_t generation = cache.GetGeneration(OBJECT_NAME, OBJECT_PATH);
+
+    /* Read the value without the cache so the reply can be applied later */
+    Message reply(clientBus);
+    MsgArg inArgs[2];
+    size_t numArgs = ArraySize(inArgs);
+    MsgArg::Set(inArgs, numArgs, "ss", INTERFACE_NAME, "int_val");
+    const InterfaceDescription* propIface = clientBus.GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+    ASSERT_EQ(ER_OK, remoteObj.MethodCall(*(propIface->GetMember("Get")), inArgs, numArgs, reply, 5000, 0));
+
+    /* The value changes and the PropertiesChanged signal arrives before the reply is cached */
+    ASSERT_EQ(ER_OK, RemoteSet(remoteObj, 2));
+    for (int n = 0; (n < 200) && (cache.GetGeneration(OBJECT_NAME, OBJECT_PATH) == generation); ++n) {
+        qcc::Sleep(10);
+    }
+    ASSERT_NE(generation, cache.GetGeneration(OBJECT_NAME, OBJECT_PATH));
+
+    /* The reply is older than the signal so it must not be cached */
+    cache.SetProperty(OBJECT_NAME, OBJECT_PATH, reply, INTERFACE_NAME, "int_val", generation);
+    MsgArg value;
+    EXPECT_FALSE(cache.GetProperty(OBJECT_NAME, OBJECT_PATH, INTERFACE_NAME, "int_val", value));
+
+    /* Reads through the proxy see the new value */
+    int32_t i;
+    ASSERT_EQ(ER_OK, remoteObj.GetProperty(INTERFACE_NAME, "int_val", value));
+    ASSERT_EQ(ER_OK, value.Get("i", &i));
+    EXPECT_EQ(2, i);
+    EXPECT_TRUE(cache.GetProperty(OBJECT_NAME, OBJECT_PATH, INTERFACE_NAME, "int_val", value));
+}
+
+TEST_F(PropertyCacheTest, Reconnect) {
+    ProxyBusObject remoteObj(clientBus, OBJECT_NAME, OBJECT_PATH, 0);
+    ASSERT_EQ(ER_OK, remoteObj.IntrospectRemoteObject());
+    ASSERT_EQ(ER_OK, remoteObj.EnablePropertyCaching(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, RemoteSet(remoteObj, 5));
+    EXPECT_EQ(5, WaitForValue(remoteObj, 5));
+
+    ASSERT_EQ(ER_OK, clientBus.Disconnect(getConnectArg().c_str()));
+    for (int n = 0; (n < 200) && clientBus.IsConnected(); ++n) {
+        qcc::Sleep(10);
+    }
+    ASSERT_FALSE(clientBus.IsConnected());
+    ASSERT_EQ(ER_OK, clientBus.Connect(getConnectArg().c_str()));
+
+    /* The value is read again after the reconnect and cached */
+    EXPECT_EQ(5, WaitForValue(remoteObj, 5));
+
+    /* The match rule is back so the cached value follows changes made by others */
+    ASSERT_EQ(ER_OK, RemoteSet(remoteObj, 6));
+    EXPECT_EQ(6, WaitForValue(remoteObj, 6));
+}
@@ -0,0 +1,173 @@
+/**
+ * @file
+ *
+ * This file tests the table of outstanding method calls and reply timeouts
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/Util.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <Status.h>
+
+/* Private files included for unit testing */
+#include <ReplyTable.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+static ReplyTable::Context MakeContext(MessageReceiver* object, void* context)
+{
+    ReplyTable::Context ctx = { object, NULL, NULL, false, context };
+    return ctx;
+}
+
+TEST(ReplyTableTest, AddRemove) {
+    ReplyTable table;
+    ReplyTable::Context ctx;
+    const uint64_t now = 1000000;
+
+    for (uint32_t serial = 1; serial <= 1000; ++serial) {
+        ASSERT_TRUE(table.Add(serial, MakeContext(NULL, (void*)(size_t)serial), 25000, now));
+    }
+    EXPECT_FALSE(table.Add(500, MakeContext(NULL, NULL), 25000, now));
+    EXPECT_EQ(1000U, table.Size());
+
+    /* Remove every other call then check the rest are still found */
+    for (uint32_t serial = 1; serial <= 1000; serial += 2) {
+        ASSERT_TRUE(table.Remove(serial, ctx));
+        EXPECT_EQ((void*)(size_t)serial, ctx.context);
+    }
+    EXPECT_FALSE(table.Remove(1, ctx));
+    for (uint32_t serial = 2; serial <= 1000; serial += 2) {
+        ASSERT_TRUE(table.Remove(serial, ctx));
+        EXPECT_EQ((void*)(size_t)serial, ctx.context);
+    }
+    EXPECT_EQ(0U, table.Size());
+    EXPECT_EQ(0U, table.NextTimeout());
+}
+
+TEST(ReplyTableTest, SerialWrap) {
+    ReplyTable table;
+    ReplyTable::Context ctx;
+
+    /* Serial numbers around the ends of the serial number space */
+    uint32_t serials[] = { 0xFFFFFFF0, 0xFFFFFFFF, 0x3F, 0x7F, 0xBF, 0xFF, 0x40, 0x80 };
+    for (size_t i = 0; i < ArraySize(serials); ++i) {
+        ASSERT_TRUE(table.Add(serials[i], MakeContext(NULL, NULL), 1000, 0));
+    }
+    ASSERT_TRUE(table.Remove(0x3F, ctx));
+    ASSERT_TRUE(table.Remove(0xFFFFFFFF, ctx));
+    for (size_t i = 0; i < ArraySize(serials); ++i) {
+        if ((serials[i] != 0x3F) && (serials[i] != 0xFFFFFFFF)) {
+            EXPECT_TRUE(table.Remove(serials[i], ctx)) << "serial " << serials[i];
+        }
+    }
+    EXPECT_EQ(0U, table.Size());
+}
+
+TEST(ReplyTableTest, Timeouts) {
+    ReplyTable table;
+    std::vector<uint32_t> expired;
+    const uint64_t now = 50000;
+
+    ASSERT_TRUE(table.Add(1, MakeContext(NULL, NULL), 100, now));
+    ASSERT_TRUE(table.Add(2, MakeContext(NULL, NULL), 35, now));
+    /* Further than one turn of the wheel */
+    ASSERT_TRUE(table.Add(3, MakeContext(NULL, NULL), ReplyTable::TICK_MS * ReplyTable::NUM_WHEEL_SLOTS + 35, now));
+    EXPECT_EQ(now + 35, table.NextTimeout());
+
+    table.Expire(now + 34, expired);
+    EXPECT_TRUE(expired.empty());
+    table.Expire(now + 35, expired);
+    ASSERT_EQ(1U, expired.size());
+    EXPECT_EQ(2U, expired[0]);
+    expired.clear();
+
+    /* Expired calls stay in the table until they are removed */
+    EXPECT_EQ(3U, table.Size());
+    EXPECT_FALSE(table.Extend(2, 1000));
+
+    EXPECT_TRUE(table.Extend(1, 200));
+    table.Expire(now + 200, expired);
+    EXPECT_TRUE(expired.empty());
+    table.Expire(now + 300, expired);
+    ASSERT_EQ(1U, expired.size());
+    EXPECT_EQ(1U, expired[0]);
+    expired.clear();
+
+    /* The slot for call 3 comes round again before it times out */
+    table.Expire(now + ReplyTable::TICK_MS * ReplyTable::NUM_WHEEL_SLOTS, expired);
+    EXPECT_TRUE(expired.empty());
+    EXPECT_NE(0U, table.NextTimeout());
+    table.Expire(now + ReplyTable::TICK_MS * ReplyTable::NUM_WHEEL_SLOTS + 35, expired);
+    ASSERT_EQ(1U, expired.size());
+    EXPECT_EQ(3U, expired[0]);
+    EXPECT_EQ(0U, table.NextTimeout());
+}
+
+TEST(ReplyTableTest, RemoveAllAndExpireAll) {
+    ReplyTable table;
+    ReplyTable::Context ctx;
+    std::vector<uint32_t> expired;
+    MessageReceiver* a = reinterpret_cast<MessageReceiver*>(0x1000);
+    MessageReceiver* b = reinterpret_cast<MessageReceiver*>(0x2000);
+
+    for (uint32_t serial = 1; serial <= 300; ++serial) {
+        ASSERT_TRUE(table.Add(serial, MakeContext((serial % 3) ? a : b, NULL), 1000 + serial, 0));
+    }
+    table.RemoveAll(a);
+    EXPECT_EQ(100U, table.Size());
+    for (uint32_t serial = 1; serial <= 300; ++serial) {
+        EXPECT_EQ((serial % 3) == 0, table.Extend(serial, 0));
+    }
+    table.ExpireAll(expired);
+    EXPECT_EQ(100U, expired.size());
+    EXPECT_EQ(0U, table.NextTimeout());
+    for (size_t i = 0; i < expired.size(); ++i) {
+        EXPECT_TRUE(table.Remove(expired[i], ctx));
+        EXPECT_EQ(b, ctx.object);
+    }
+}
+
+TEST(ReplyTableTest, ManyOutstandingCalls) {
+    ReplyTable table;
+    ReplyTable::Context ctx;
+    std::vector<uint32_t> expired;
+    const uint32_t numCalls = 100000;
+
+    /* Fan out calls with staggered timeouts, half of them are answered before they time out */
+    for (uint32_t serial = 1; serial <= numCalls; ++serial) {
+        ASSERT_TRUE(table.Add(serial, MakeContext(NULL, NULL), 1000 + (serial % 5000), serial / 100));
+    }
+    for (uint32_t serial = 2; serial <= numCalls; serial += 2) {
+        ASSERT_TRUE(table.Remove(serial, ctx));
+    }
+    for (uint64_t now = 0; table.NextTimeout(); now = table.NextTimeout()) {
+        table.Expire(now, expired);
+    }
+    EXPECT_EQ(numCalls / 2, expired.size());
+    std::sort(expired.begin(), expired.end());
+    for (size_t i = 0; i < expired.size(); ++i) {
+        ASSERT_EQ(2 * i + 1, expired[i]);
+    }
+}
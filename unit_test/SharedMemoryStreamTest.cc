@@ -0,0 +1,325 @@
+/**
+ * @file
+ *
+ * This file tests the shared memory rings local client connections can be switched over to
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#include <vector>
+
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+#include <qcc/Util.h>
+
+#include <Status.h>
+
+/* Private files included for unit testing */
+#include <SharedMemoryStream.h>
+
+#include <gtest/gtest.h>
+
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+using namespace qcc;
+using namespace ajn;
+
+/* Must match the layout in SharedMemoryStream.cc, a control page ahead of each ring */
+static const size_t SHM_SIZE = 2 * (4096 + SharedMemoryStream::RING_SIZE);
+
+/* The memory and four eventfds SharedMemoryStream::Connect() passes to the daemon */
+static const size_t NUM_SHM_FDS = 5;
+
+static int CreateMemFd(bool seal)
+{
+    int fd = syscall(__NR_memfd_create, "alljoyn-shm-test", MFD_ALLOW_SEALING);
+    if ((fd >= 0) && (ftruncate(fd, SHM_SIZE) == 0) && seal) {
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+    }
+    return fd;
+}
+
+static void CloseFds(int* fds, size_t numFds)
+{
+    for (size_t i = 0; i < numFds; ++i) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+class SharedMemoryStreamTest : public testing::Test {
+  public:
+    SharedMemoryStreamTest() : client(NULL), daemon(NULL) { }
+
+    virtual void SetUp()
+    {
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, socks));
+    }
+
+    virtual void TearDown()
+    {
+        delete client;
+        delete daemon;
+        CloseFds(socks, ArraySize(socks));
+    }
+
+    void Connect()
+    {
+        QStatus status = SharedMemoryStream::Connect(socks[0], client);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = SharedMemoryStream::Accept(socks[1], 1000, daemon);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        ASSERT_TRUE(client != NULL);
+        ASSERT_TRUE(daemon != NULL);
+    }
+
+    /* Send what Connect() sends but with the descriptors given and let the daemon side accept it */
+    QStatus AcceptFds(int* fds, size_t numFds)
+    {
+        uint8_t version = 1;
+        size_t sent;
+        QStatus status = SendWithFds(socks[0], &version, sizeof(version), sent, fds, numFds, GetPid());
+        if (status == ER_OK) {
+            status = SharedMemoryStream::Accept(socks[1], 1000, daemon);
+        }
+        CloseFds(fds, numFds);
+        return status;
+    }
+
+    int socks[2];
+    SharedMemoryStream* client;
+    SharedMemoryStream* daemon;
+};
+
+/* Push all of buf, the ring must have room for it */
+static void Push(SharedMemoryStream* stream, const uint8_t* buf, size_t len)
+{
+    size_t total = 0;
+    while (total < len) {
+        size_t sent;
+        ASSERT_EQ(ER_OK, stream->PushBytes(buf + total, len - total, sent));
+        total += sent;
+    }
+}
+
+static void Pull(SharedMemoryStream* stream, uint8_t* buf, size_t len)
+{
+    size_t total = 0;
+    while (total < len) {
+        size_t pulled;
+        ASSERT_EQ(ER_OK, stream->PullBytes(buf + total, len - total, pulled, 1000));
+        total += pulled;
+    }
+}
+
+TEST_F(SharedMemoryStreamTest, RingWraparound) {
+    Connect();
+
+    /* Chunks that don't divide the ring size end up straddling the end of the ring */
+    const size_t chunk = 100003;
+    std::vector<uint8_t> out(3 * SharedMemoryStream::RING_SIZE + chunk);
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = (uint8_t)((i * 7) ^ (i >> 8));
+    }
+    std::vector<uint8_t> in(out.size());
+    for (size_t pos = 0; pos < out.size(); pos += chunk) {
+        size_t len = (std::min)(chunk, out.size() - pos);
+        Push(client, &out[pos], len);
+        Pull(daemon, &in[pos], len);
+    }
+    ASSERT_TRUE(in == out) << "Data was corrupted going round the client to daemon ring";
+
+    for (size_t pos = 0; pos < out.size(); pos += chunk) {
+        size_t len = (std::min)(chunk, out.size() - pos);
+        Push(daemon, &out[pos], len);
+        Pull(client, &in[pos], len);
+    }
+    ASSERT_TRUE(in == out) << "Data was corrupted going round the daemon to client ring";
+}
+
+TEST_F(SharedMemoryStreamTest, ConsumerWakeup) {
+    Connect();
+    uint8_t buf[4] = { 1, 2, 3, 4 };
+    size_t actual;
+
+    ASSERT_EQ(ER_TIMEOUT, Event::Wait(daemon->GetSourceEvent(), 0)) << "Source event set with nothing to read";
+    Push(client, buf, sizeof(buf));
+    ASSERT_EQ(ER_OK, Event::Wait(daemon->GetSourceEvent(), 1000)) << "First message did not wake the daemon";
+    Pull(daemon, buf, sizeof(buf));
+
+    /* The daemon goes to sleep on an empty ring and the next write must wake it */
+    ASSERT_EQ(ER_TIMEOUT, daemon->PullBytes(buf, sizeof(buf), actual, 10));
+    ASSERT_EQ(ER_TIMEOUT, Event::Wait(daemon->GetSourceEvent(), 0)) << "Source event still set after the ring was emptied";
+    Push(client, buf, sizeof(buf));
+    ASSERT_EQ(ER_OK, Event::Wait(daemon->GetSourceEvent(), 1000)) << "Write did not wake the sleeping daemon";
+    Pull(daemon, buf, sizeof(buf));
+}
+
+TEST_F(SharedMemoryStreamTest, ProducerWakeup) {
+    Connect();
+    std::vector<uint8_t> buf(SharedMemoryStream::RING_SIZE);
+    size_t sent;
+
+    Push(client, &buf[0], buf.size());
+    client->SetSendTimeout(10);
+    ASSERT_EQ(ER_TIMEOUT, client->PushBytes(&buf[0], 1, sent)) << "Pushed into a full ring";
+    ASSERT_EQ(ER_TIMEOUT, Event::Wait(client->GetSinkEvent(), 0)) << "Sink event set with the ring full";
+
+    /* Reading from the full ring must wake the sleeping writer */
+    Pull(daemon, &buf[0], 1000);
+    ASSERT_EQ(ER_OK, Event::Wait(client->GetSinkEvent(), 1000)) << "Read did not wake the sleeping client";
+    ASSERT_EQ(ER_OK, client->PushBytes(&buf[0], 1000, sent));
+    ASSERT_EQ(1000U, sent);
+}
+
+TEST_F(SharedMemoryStreamTest, FdPassing) {
+    Connect();
+    int pipeFds[2];
+    ASSERT_EQ(0, pipe(pipeFds));
+
+    /* The descriptor must come out with the second message, not the first */
+    uint8_t first[4] = { 'a', 'b', 'c', 'd' };
+    uint8_t second[4] = { 'e', 'f', 'g', 'h' };
+    size_t sent;
+    Push(client, first, sizeof(first));
+    ASSERT_EQ(ER_OK, client->PushBytesAndFds(second, sizeof(second), sent, &pipeFds[1], 1));
+    ASSERT_EQ(sizeof(second), sent);
+
+    uint8_t buf[4];
+    SocketFd fds[4];
+    size_t numFds = ArraySize(fds);
+    size_t actual;
+    ASSERT_EQ(ER_OK, daemon->PullBytesAndFds(buf, sizeof(buf), actual, fds, numFds, 1000));
+    ASSERT_EQ(sizeof(first), actual);
+    ASSERT_EQ(0, memcmp(buf, first, sizeof(first)));
+    ASSERT_EQ(0U, numFds) << "Descriptor delivered with the wrong message";
+
+    numFds = ArraySize(fds);
+    ASSERT_EQ(ER_OK, daemon->PullBytesAndFds(buf, sizeof(buf), actual, fds, numFds, 1000));
+    ASSERT_EQ(sizeof(second), actual);
+    ASSERT_EQ(0, memcmp(buf, second, sizeof(second)));
+    ASSERT_EQ(1U, numFds);
+
+    /* The received descriptor is the write end of the pipe */
+    char c = 'x';
+    ASSERT_EQ(1, write(fds[0], &c, 1));
+    c = 0;
+    ASSERT_EQ(1, read(pipeFds[0], &c, 1));
+    ASSERT_EQ('x', c);
+    close(fds[0]);
+    CloseFds(pipeFds, ArraySize(pipeFds));
+}
+
+TEST_F(SharedMemoryStreamTest, DeclinedFallsBackToSocket) {
+    /* What Connect() sends when it cannot create the shared memory */
+    uint8_t version = 0;
+    size_t sent;
+    ASSERT_EQ(ER_OK, Send(socks[0], &version, sizeof(version), sent));
+    QStatus status = SharedMemoryStream::Accept(socks[1], 1000, daemon);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_TRUE(daemon == NULL);
+
+    /* The connection carries on over the socket */
+    const char hello[] = "hello";
+    char buf[sizeof(hello)];
+    ASSERT_EQ((ssize_t)sizeof(hello), send(socks[0], hello, sizeof(hello), 0));
+    ASSERT_EQ((ssize_t)sizeof(hello), recv(socks[1], buf, sizeof(buf), MSG_WAITALL));
+    ASSERT_EQ(0, memcmp(buf, hello, sizeof(hello)));
+}
+
+TEST_F(SharedMemoryStreamTest, RejectsPipeForEventFd) {
+    int fds[NUM_SHM_FDS];
+    int pipeFds[2];
+    ASSERT_EQ(0, pipe(pipeFds));
+    fds[0] = CreateMemFd(true);
+    fds[1] = eventfd(0, EFD_NONBLOCK);
+    fds[2] = eventfd(0, EFD_NONBLOCK);
+    fds[3] = pipeFds[0];
+    fds[4] = eventfd(0, EFD_NONBLOCK);
+    close(pipeFds[1]);
+    ASSERT_EQ(ER_BUS_ESTABLISH_FAILED, AcceptFds(fds, NUM_SHM_FDS));
+    ASSERT_TRUE(daemon == NULL);
+}
+
+TEST_F(SharedMemoryStreamTest, RejectsSocketForEventFd) {
+    int fds[NUM_SHM_FDS];
+    int pair[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+    fds[0] = CreateMemFd(true);
+    fds[1] = pair[0];
+    fds[2] = eventfd(0, EFD_NONBLOCK);
+    fds[3] = eventfd(0, EFD_NONBLOCK);
+    fds[4] = eventfd(0, EFD_NONBLOCK);
+    close(pair[1]);
+    ASSERT_EQ(ER_BUS_ESTABLISH_FAILED, AcceptFds(fds, NUM_SHM_FDS));
+    ASSERT_TRUE(daemon == NULL);
+}
+
+TEST_F(SharedMemoryStreamTest, RejectsUnsealedMemory) {
+    int fds[NUM_SHM_FDS];
+    fds[0] = CreateMemFd(false);
+    for (size_t i = 1; i < NUM_SHM_FDS; ++i) {
+        fds[i] = eventfd(0, EFD_NONBLOCK);
+    }
+    ASSERT_EQ(ER_BUS_ESTABLISH_FAILED, AcceptFds(fds, NUM_SHM_FDS));
+    ASSERT_TRUE(daemon == NULL);
+}
+
+TEST_F(SharedMemoryStreamTest, RejectsMissingFds) {
+    int fds[2];
+    fds[0] = CreateMemFd(true);
+    fds[1] = eventfd(0, EFD_NONBLOCK);
+    ASSERT_EQ(ER_BUS_ESTABLISH_FAILED, AcceptFds(fds, ArraySize(fds)));
+    ASSERT_TRUE(daemon == NULL);
+}
+
+TEST_F(SharedMemoryStreamTest, BlockingEventFdsMadeNonBlocking) {
+    int fds[NUM_SHM_FDS];
+    fds[0] = CreateMemFd(true);
+    for (size_t i = 1; i < NUM_SHM_FDS; ++i) {
+        fds[i] = eventfd(0, 0);
+    }
+    /* Keep a descriptor for the same eventfd to look at its flags after the daemon side has it */
+    int probe = dup(fds[2]);
+    QStatus status = AcceptFds(fds, NUM_SHM_FDS);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_TRUE(daemon != NULL);
+    ASSERT_TRUE((fcntl(probe, F_GETFL) & O_NONBLOCK) != 0) << "Blocking eventfd from the client was used as is";
+    close(probe);
+}
+
+#endif
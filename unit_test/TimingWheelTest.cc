@@ -0,0 +1,107 @@
+/**
+ * @file
+ *
+ * This file tests the hashed timing wheel
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+/* Private files included for unit testing */
+#include <TimingWheel.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+TEST(TimingWheelTest, ExpireInOrder) {
+    TimingWheel<int> wheel(10, 8);
+    std::vector<int> expired;
+
+    /* Timers in the same slot expire in the order they were added */
+    wheel.Add(1, 1005, 1000);
+    wheel.Add(2, 1001, 1000);
+    wheel.Add(3, 1030, 1000);
+    EXPECT_EQ(3U, wheel.Size());
+    EXPECT_EQ(1001U, wheel.NextDue());
+
+    wheel.Expire(1004, expired);
+    ASSERT_EQ(1U, expired.size());
+    EXPECT_EQ(2, expired[0]);
+
+    wheel.Expire(1029, expired);
+    ASSERT_EQ(2U, expired.size());
+    EXPECT_EQ(1, expired[1]);
+    EXPECT_EQ(1030U, wheel.NextDue());
+
+    wheel.Expire(1030, expired);
+    ASSERT_EQ(3U, expired.size());
+    EXPECT_EQ(3, expired[2]);
+    EXPECT_EQ(0U, wheel.Size());
+    EXPECT_EQ(0U, wheel.NextDue());
+}
+
+TEST(TimingWheelTest, LaterTurns) {
+    TimingWheel<int> wheel(10, 8);
+    std::vector<int> expired;
+
+    /* 1165 shares a slot with 1005 but is two turns of the wheel later */
+    wheel.Add(1, 1165, 1000);
+    wheel.Add(2, 1005, 1000);
+    wheel.Expire(1010, expired);
+    ASSERT_EQ(1U, expired.size());
+    EXPECT_EQ(2, expired[0]);
+
+    /* The owner is woken once at the end of the slot for nothing */
+    EXPECT_EQ(1090U, wheel.NextDue());
+    wheel.Expire(1100, expired);
+    EXPECT_EQ(1U, expired.size());
+
+    /* A gap longer than a turn of the wheel still finds the timer */
+    wheel.Expire(5000, expired);
+    ASSERT_EQ(2U, expired.size());
+    EXPECT_EQ(1, expired[1]);
+}
+
+TEST(TimingWheelTest, RemoveAndReschedule) {
+    TimingWheel<int> wheel(10, 8);
+    std::vector<int> expired;
+
+    uint32_t t1 = wheel.Add(1, 1010, 1000);
+    uint32_t t2 = wheel.Add(2, 1010, 1000);
+    uint32_t t3 = wheel.Add(3, 1010, 1000);
+    wheel.Remove(t2);
+    wheel.Reschedule(t1, 1040);
+    EXPECT_EQ(1040U, wheel.GetDue(t1));
+    EXPECT_EQ(2U, wheel.Size());
+
+    wheel.Expire(1020, expired);
+    ASSERT_EQ(1U, expired.size());
+    EXPECT_EQ(3, expired[0]);
+
+    /* Removed and expired timers are reused */
+    uint32_t t4 = wheel.Add(4, 1050, 1020);
+    EXPECT_TRUE((t4 == t2) || (t4 == t3));
+
+    wheel.Expire(1050, expired);
+    ASSERT_EQ(3U, expired.size());
+    EXPECT_EQ(1, expired[1]);
+    EXPECT_EQ(4, expired[2]);
+}
@@ -0,0 +1,234 @@
+/**
+ * @file
+ *
+ * This file tests the prioritized transmit queue of remote endpoints
+ */
+
+/******************************************************************************
+ * Copyright 2012, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+
+#include <vector>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+
+#include <Status.h>
+
+/* Private files included for unit testing */
+#include <TxLaneQueue.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+/* Pop the next message and return its index in msgs or -1 */
+static int PopIndex(TxLaneQueue& queue, std::vector<Message>& msgs, uint64_t now, TxLaneQueue::Lane& lane)
+{
+    Message* msg = queue.Pop(now, lane);
+    if (!msg) {
+        return -1;
+    }
+    int index = -1;
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        if (*msg == msgs[i]) {
+            index = (int)i;
+            break;
+        }
+    }
+    queue.Done();
+    return index;
+}
+
+TEST(TxLaneQueueTest, ControlOvertakesSignals) {
+    BusAttachment bus("TxLaneQueueTest", false);
+    TxLaneQueue queue;
+    std::vector<Message> msgs;
+    TxLaneQueue::Lane lane;
+
+    for (size_t i = 0; i < 20; ++i) {
+        msgs.push_back(Message(bus));
+        queue.Push(msgs.back(), TxLaneQueue::SIGNAL, ":app.1", 0);
+    }
+    msgs.push_back(Message(bus));
+    queue.Push(msgs.back(), TxLaneQueue::CONTROL, ":daemon.1", 0);
+    EXPECT_EQ(21U, queue.Size());
+    EXPECT_EQ(20U, queue.Size(TxLaneQueue::SIGNAL));
+
+    /* The control message from another sender goes first */
+    EXPECT_EQ(20, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(TxLaneQueue::CONTROL, lane);
+
+    /* Then the signals in the order they were queued */
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i, PopIndex(queue, msgs, 0, lane));
+        EXPECT_EQ(TxLaneQueue::SIGNAL, lane);
+    }
+    EXPECT_EQ(-1, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(0U, queue.Size());
+}
+
+TEST(TxLaneQueueTest, WeightedRoundRobin) {
+    BusAttachment bus("TxLaneQueueTest", false);
+    TxLaneQueue queue;
+    std::vector<Message> msgs;
+    TxLaneQueue::Lane lane;
+    const size_t perLane = 64;
+
+    /* Every message has its own sender so only the lane weights decide the order */
+    std::vector<qcc::String> senders;
+    for (size_t i = 0; i < perLane * TxLaneQueue::NUM_LANES; ++i) {
+        senders.push_back(qcc::String(":sender.") + qcc::U32ToString((uint32_t)i));
+    }
+    for (size_t i = 0; i < perLane; ++i) {
+        for (size_t l = 0; l < TxLaneQueue::NUM_LANES; ++l) {
+            msgs.push_back(Message(bus));
+            queue.Push(msgs.back(), (TxLaneQueue::Lane)(TxLaneQueue::NUM_LANES - 1 - l), senders[msgs.size() - 1].c_str(), 0);
+        }
+    }
+
+    /* One full round sends each lane's weight in messages */
+    uint32_t total = 0;
+    for (size_t l = 0; l < TxLaneQueue::NUM_LANES; ++l) {
+        total += TxLaneQueue::LANE_WEIGHTS[l];
+    }
+    uint32_t count[TxLaneQueue::NUM_LANES] = { 0 };
+    for (uint32_t i = 0; i < total; ++i) {
+        ASSERT_NE(-1, PopIndex(queue, msgs, 0, lane));
+        ++count[lane];
+    }
+    for (size_t l = 0; l < TxLaneQueue::NUM_LANES; ++l) {
+        EXPECT_EQ(TxLaneQueue::LANE_WEIGHTS[l], count[l]);
+    }
+
+    /* Nothing is lost when lanes run dry */
+    size_t left = queue.Size();
+    for (size_t i = 0; i < left; ++i) {
+        ASSERT_NE(-1, PopIndex(queue, msgs, 0, lane));
+    }
+    EXPECT_EQ(-1, PopIndex(queue, msgs, 0, lane));
+}
+
+TEST(TxLaneQueueTest, SenderOrderPreserved) {
+    BusAttachment bus("TxLaneQueueTest", false);
+    TxLaneQueue queue;
+    std::vector<Message> msgs;
+    TxLaneQueue::Lane lane;
+
+    /* A signal then a method call from the same sender must not be reordered */
+    msgs.push_back(Message(bus));
+    queue.Push(msgs.back(), TxLaneQueue::SIGNAL, ":app.1", 0);
+    msgs.push_back(Message(bus));
+    queue.Push(msgs.back(), TxLaneQueue::SIGNAL, ":app.2", 0);
+    msgs.push_back(Message(bus));
+    queue.Push(msgs.back(), TxLaneQueue::METHOD_CALL, ":app.1", 0);
+    msgs.push_back(Message(bus));
+    queue.Push(msgs.back(), TxLaneQueue::REPLY, ":app.3", 0);
+
+    EXPECT_EQ(3, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(TxLaneQueue::REPLY, lane);
+    EXPECT_EQ(0, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(TxLaneQueue::SIGNAL, lane);
+    EXPECT_EQ(2, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(TxLaneQueue::METHOD_CALL, lane);
+    EXPECT_EQ(1, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(-1, PopIndex(queue, msgs, 0, lane));
+}
+
+TEST(TxLaneQueueTest, Stats) {
+    BusAttachment bus("TxLaneQueueTest", false);
+    TxLaneQueue queue;
+    std::vector<Message> msgs;
+    TxLaneQueue::Lane lane;
+    TxLaneQueue::LaneStats stats;
+
+    for (uint64_t t = 0; t < 4; ++t) {
+        msgs.push_back(Message(bus));
+        queue.Push(msgs.back(), TxLaneQueue::SIGNAL, ":app.1", 1000 + t * 10);
+    }
+    queue.GetStats(TxLaneQueue::SIGNAL, stats);
+    EXPECT_EQ(4U, stats.depth);
+    EXPECT_EQ(0U, stats.sent);
+
+    /* Waits are 100, 90, 80 and 70 us */
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ((int)i, PopIndex(queue, msgs, 1100, lane));
+    }
+    queue.GetStats(TxLaneQueue::SIGNAL, stats);
+    EXPECT_EQ(0U, stats.depth);
+    EXPECT_EQ(4U, stats.sent);
+    EXPECT_EQ(340U, stats.totalWaitUs);
+    EXPECT_EQ(100U, stats.maxWaitUs);
+    EXPECT_EQ(85U, stats.AverageWaitUs());
+
+    queue.GetStats(TxLaneQueue::CONTROL, stats);
+    EXPECT_EQ(0U, stats.sent);
+    EXPECT_EQ(0U, stats.AverageWaitUs());
+}
+
+static Message MakeSignal(BusAttachment& bus, const char* path, const char* member, SessionId session, uint8_t flags)
+{
+    Message msg(bus);
+    QStatus status = msg->SignalMsg("", NULL, session, path, "org.alljoyn.test.TxLaneQueue", member, NULL, 0, flags, 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    return msg;
+}
+
+TEST(TxLaneQueueTest, LastValueCoalescing) {
+    BusAttachment bus("TxLaneQueueTest", false);
+    TxLaneQueue queue;
+    std::vector<Message> msgs;
+    TxLaneQueue::Lane lane;
+    TxLaneQueue::LaneStats stats;
+
+    ASSERT_EQ(ER_OK, bus.Start());
+
+    /* 0 and 1 are superseded by 4, 2 is a different member, 3 is a different session */
+    msgs.push_back(MakeSignal(bus, "/level", "Level", 1, ALLJOYN_FLAG_LAST_VALUE));
+    msgs.push_back(MakeSignal(bus, "/level", "Level", 1, ALLJOYN_FLAG_LAST_VALUE));
+    msgs.push_back(MakeSignal(bus, "/level", "Alarm", 1, ALLJOYN_FLAG_LAST_VALUE));
+    msgs.push_back(MakeSignal(bus, "/level", "Level", 2, ALLJOYN_FLAG_LAST_VALUE));
+    msgs.push_back(MakeSignal(bus, "/level", "Level", 1, ALLJOYN_FLAG_LAST_VALUE));
+    /* A signal without the flag is never coalesced */
+    msgs.push_back(MakeSignal(bus, "/event", "Event", 1, 0));
+    msgs.push_back(MakeSignal(bus, "/event", "Event", 1, 0));
+
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        EXPECT_EQ(msgs[i]->IsLastValueSignal(), i < 5);
+        if (msgs[i]->IsLastValueSignal()) {
+            EXPECT_EQ(i == 1 || i == 4, queue.Coalesce(msgs[i], TxLaneQueue::SIGNAL)) << "  message " << i;
+        }
+        queue.Push(msgs[i], TxLaneQueue::SIGNAL, msgs[i]->GetSender(), 0);
+    }
+    EXPECT_EQ(5U, queue.Size());
+
+    /* The newest value goes at the back so the sender's messages stay in order */
+    EXPECT_EQ(2, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(3, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(4, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(5, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(6, PopIndex(queue, msgs, 0, lane));
+    EXPECT_EQ(-1, PopIndex(queue, msgs, 0, lane));
+
+    queue.GetStats(TxLaneQueue::SIGNAL, stats);
+    EXPECT_EQ(2U, stats.coalesced);
+
+    bus.Stop();
+    bus.Join();
+}